@@ -31,6 +31,10 @@ class ScatteringLUTNode : public vanadium::graphics::FramegraphNode {
 
 	virtual void recreateSwapchainResources(vanadium::graphics::FramegraphContext* context, uint32_t width, uint32_t height) {}
 
+	virtual vanadium::graphics::FramegraphQueue preferredQueue() const {
+		return vanadium::graphics::FramegraphQueue::AsyncCompute;
+	}
+
 	virtual void destroy(vanadium::graphics::FramegraphContext* context);
 
 	vanadium::graphics::FramegraphImageHandle transmittanceLUTHandle() { return m_transmittanceLUTHandle; }
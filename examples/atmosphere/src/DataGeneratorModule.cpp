@@ -211,10 +211,11 @@ DataGenerator::DataGenerator(vanadium::graphics::GraphicsSubsystem& subsystem,
 		vanadium::graphics::allocationInfosForPipeline(subsystem.context().pipelineLibrary,
 													   vanadium::graphics::PipelineType::Graphics, m_planetPipelineID));
 
-	VkDescriptorBufferInfo info = { .buffer = subsystem.context().resourceAllocator->nativeBufferHandle(
-										subsystem.context().transferManager->dstBufferHandle(m_sceneDataTransfer)),
-									.offset = 0,
-									.range = VK_WHOLE_SIZE };
+	auto* resourceAllocator = subsystem.context().resourceAllocator;
+	auto sceneDataBuffer = subsystem.context().transferManager->dstBufferHandle(m_sceneDataTransfer);
+	VkDescriptorBufferInfo info = { .buffer = resourceAllocator->nativeBufferHandle(sceneDataBuffer),
+									.offset = resourceAllocator->bufferOffset(sceneDataBuffer),
+									.range = sizeof(CameraSceneData) };
 
 	VkDescriptorImageInfo imageInfo = { .imageView = view, .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
 	VkDescriptorImageInfo seaMaskImageInfo = { .imageView = seaMaskView,
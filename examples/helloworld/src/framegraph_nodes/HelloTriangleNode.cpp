@@ -107,9 +107,10 @@ void HelloTriangleNode::recordCommands(FramegraphContext* context, VkCommandBuff
 
 	vkCmdSetViewport(targetCommandBuffer, 0, 1, &viewport);
 
-	VkDeviceSize offset = 0;
-	VkBuffer nativeBuffer = context->renderContext().resourceAllocator->nativeBufferHandle(
-		m_bufferUpdater->vertexBufferHandle(context->renderContext()));
+	// Both depend on the frame index, the data of each frame may live at a different offset
+	auto vertexBuffer = m_bufferUpdater->vertexBufferHandle(context->renderContext());
+	VkDeviceSize offset = context->renderContext().resourceAllocator->bufferOffset(vertexBuffer);
+	VkBuffer nativeBuffer = context->renderContext().resourceAllocator->nativeBufferHandle(vertexBuffer);
 	vkCmdBindVertexBuffers(targetCommandBuffer, 0, 1, &nativeBuffer, &offset);
 
 	vkCmdDraw(targetCommandBuffer, 3, 1, 0, 0);
@@ -11,6 +11,12 @@ namespace vanadium::graphics {
 	struct DeviceCapabilities {
 		bool memoryBudget;
 		bool memoryPriority;
+		// VK_KHR_dedicated_allocation and VK_KHR_get_memory_requirements2
+		bool dedicatedAllocation;
+		// VK_KHR_timeline_semaphore with the timelineSemaphore feature enabled
+		bool timelineSemaphore;
+		// VK_KHR_synchronization2 with the synchronization2 feature enabled
+		bool synchronization2;
 	};
 
 	class DeviceContext {
@@ -28,6 +34,18 @@ namespace vanadium::graphics {
 
 		uint32_t asyncTransferQueueFamilyIndex() const { return m_asyncTransferQueueFamilyIndex; }
 		VkQueue asyncTransferQueue() { return m_asyncTransferQueue; }
+		// The async transfer queue is in its own queue family and can execute in parallel to the graphics queue
+		bool hasDedicatedTransferQueue() const {
+			return m_asyncTransferQueueFamilyIndex != m_graphicsQueueFamilyIndex;
+		}
+
+		uint32_t asyncComputeQueueFamilyIndex() const { return m_asyncComputeQueueFamilyIndex; }
+		VkQueue asyncComputeQueue() { return m_asyncComputeQueue; }
+		// The async compute queue is in its own queue family and can execute in parallel to the graphics queue. It may
+		// be the same queue as the async transfer queue.
+		bool hasDedicatedComputeQueue() const {
+			return m_asyncComputeQueueFamilyIndex != m_graphicsQueueFamilyIndex;
+		}
 
 		DeviceCapabilities deviceCapabilities() const { return m_capabilities; }
 		const VkPhysicalDeviceProperties& properties() const { return m_properties; }
@@ -48,9 +66,12 @@ namespace vanadium::graphics {
 		uint32_t m_asyncTransferQueueFamilyIndex;
 		VkQueue m_asyncTransferQueue;
 
+		uint32_t m_asyncComputeQueueFamilyIndex;
+		VkQueue m_asyncComputeQueue;
+
 		VkDebugUtilsMessengerEXT m_debugMessenger;
 
-		DeviceCapabilities m_capabilities;
+		DeviceCapabilities m_capabilities = {};
 
 		std::vector<VkFence> m_frameCompletionFences;
 	};
@@ -33,8 +33,12 @@ namespace vanadium::graphics {
 		std::vector<SubpassSignature> subpassSignatures;
 		std::vector<AttachmentPassSignature> attachmentDescriptionSignatures;
 		std::vector<VkSubpassDependency> subpassDependencies;
+		// Pipelines are created for this subpass. Nodes merged into one render pass share everything else.
+		uint32_t subpassIndex = 0;
 
 		bool operator==(const RenderPassSignature& other) const {
+			if (subpassIndex != other.subpassIndex)
+				return false;
 			for (auto& dependency : subpassDependencies) {
 				if (std::find_if(other.subpassDependencies.begin(), other.subpassDependencies.end(),
 								 [dependency](const auto& otherDependency) {
@@ -117,6 +121,11 @@ namespace robin_hood {
 								hash<decltype(dependency.dstSubpass)>()(dependency.dstSubpass),
 								hash<decltype(dependency.dependencyFlags)>()(dependency.dependencyFlags));
 			}
+			// Signatures of the first subpass hash like signatures from before subpasses were merged
+			if (object.subpassIndex != 0) {
+				return hashCombine(subpassHash, descriptionHash, dependencyHash,
+								   hash<decltype(object.subpassIndex)>()(object.subpassIndex));
+			}
 			return hashCombine(subpassHash, descriptionHash, dependencyHash);
 		}
 	};
@@ -5,6 +5,11 @@
 #include <robin_hood.h>
 
 #include <graphics/framegraph/QueueBarrierGenerator.hpp>
+#include <graphics/util/FramegraphResize.hpp>
+#include <graphics/util/RecordingSegments.hpp>
+#include <graphics/util/RenderPassMerging.hpp>
+#include <graphics/util/TransientAliasing.hpp>
+#include <util/WorkerPool.hpp>
 
 namespace vanadium::graphics {
 
@@ -32,6 +37,8 @@ namespace vanadium::graphics {
 		bool isImported = false;
 		FramegraphBufferCreationParameters creationParameters;
 		BufferResourceHandle resourceHandle = ~0U;
+		// Shares memory with other transient buffers that aren't in use at the same time
+		bool isAliased = false;
 
 		VkBufferUsageFlags usageFlags;
 	};
@@ -55,12 +62,53 @@ namespace vanadium::graphics {
 		FramegraphImageCreationParameters creationParameters;
 		VkImageUsageFlags usage;
 		ImageResourceHandle resourceHandle = ~0U;
+		// Shares memory with other transient images that aren't in use at the same time
+		bool isAliased = false;
 	};
 
 	using FramegraphImageHandle = SlotmapHandle;
 
+	struct FramegraphRasterAttachment {
+		// The target image if no value
+		std::optional<FramegraphImageHandle> image;
+		// Index of the view among the views the node declared for the image
+		size_t viewIndex = 0;
+		VkAttachmentLoadOp loadOp;
+		VkAttachmentStoreOp storeOp;
+		// Has to be the layout of the node's declared access to the image
+		VkImageLayout layout;
+		VkClearValue clearValue = {};
+	};
+
+	// Nodes declaring a raster pass don't begin a render pass themselves. The framegraph begins one before recording
+	// the node, and merges consecutive raster passes sharing attachments into subpasses of the same render pass.
+	struct FramegraphRasterPassInfo {
+		std::vector<FramegraphRasterAttachment> colorAttachments;
+		std::optional<FramegraphRasterAttachment> depthStencilAttachment;
+		std::vector<FramegraphRasterAttachment> inputAttachments;
+	};
+
+	// A render pass the framegraph begins for one or more raster passes
+	struct FramegraphRenderPass {
+		VkRenderPass renderPass = VK_NULL_HANDLE;
+		RenderPassSignature signature;
+		// One framebuffer per target image if the target image is an attachment
+		std::vector<VkFramebuffer> framebuffers;
+		bool usesTarget = false;
+		VkExtent2D extent;
+		std::vector<VkClearValue> clearValues;
+		size_t lastNodeIndex;
+	};
+
 	struct FramegraphNodeInfo {
 		FramegraphNode* node;
+		// Disabled nodes are culled, but keep their declared resources
+		bool isEnabled = true;
+
+		std::optional<FramegraphRasterPassInfo> rasterPass;
+		// The render pass of the raster pass if the node isn't culled
+		size_t renderPassIndex = ~0ULL;
+		uint32_t subpassIndex = 0;
 
 		robin_hood::unordered_map<FramegraphImageHandle, std::vector<ImageResourceViewInfo>> resourceViewInfos;
 		std::vector<ImageResourceViewInfo> swapchainResourceViewInfos;
@@ -75,8 +123,41 @@ namespace vanadium::graphics {
 		robin_hood::unordered_map<FramegraphImageHandle, std::vector<VkImageView>> resourceImageViews;
 	};
 
+	// Command pools of one recording thread, per queue. Pools of queues that aren't used are null.
+	struct FramegraphRecordingPools {
+		VkCommandPool commandPools[framegraphQueueCount][frameInFlightCount] = {};
+		std::vector<VkCommandBuffer> commandBuffers[framegraphQueueCount][frameInFlightCount];
+		size_t usedCommandBufferCounts[framegraphQueueCount][frameInFlightCount] = {};
+	};
+
+	struct TimelineSemaphoreSignal {
+		VkSemaphore semaphore;
+		uint64_t value;
+	};
+
+	// Command buffers of one batch of the queue schedule, which need to be submitted in order
+	struct FramegraphSubmission {
+		FramegraphQueue queue;
+		std::vector<VkCommandBuffer> commandBuffers;
+		// Waits for batches on other queues
+		std::vector<TimelineSemaphoreWait> waits;
+		std::optional<TimelineSemaphoreSignal> signal;
+	};
+
+	// Results of compiling the graph that are reused when the graph returns to a previous state
+	struct FramegraphCompilation {
+		FramegraphDependencyInfo dependencyInfo;
+		std::vector<RecordingSegment> recordingSegments;
+		std::vector<size_t> segmentBatchIndices;
+		std::array<size_t, framegraphQueueCount> firstQueueSegmentIndices;
+		size_t lastGraphicsSegmentIndex;
+		std::vector<size_t> parallelSegmentIndices;
+	};
+
 	class FramegraphContext {
 	  public:
+		static constexpr uint32_t maxRecordingThreadCount = 8;
+
 		FramegraphContext() {}
 
 		void create(const RenderContext& context);
@@ -89,6 +170,9 @@ namespace vanadium::graphics {
 		template <std::derived_from<FramegraphNode> T> void insertExistingNode(FramegraphNode* insertAfter, T* node);
 
 		void removeNode(FramegraphNode* node);
+		// Toggles a node without removing it. The compilations of the last few node states are cached, so toggling
+		// back and forth doesn't compile the graph again.
+		void setNodeEnabled(FramegraphNode* node, bool enabled);
 
 		FramegraphBufferHandle declareTransientBuffer(FramegraphNode* creator,
 													  const FramegraphBufferCreationParameters& parameters,
@@ -109,6 +193,13 @@ namespace vanadium::graphics {
 
 		void declareReferencedSwapchainImage(FramegraphNode* user, const FramegraphNodeImageUsage& usage);
 
+		// Attachments have to be transient images or the target image the node declared its usage of
+		void declareRasterPass(FramegraphNode* node, const FramegraphRasterPassInfo& info);
+		// The render pass the node records its raster pass in, and its signature for the node's subpass. Valid from
+		// afterResourceInit on, until resources are initialized again.
+		VkRenderPass renderPass(FramegraphNode* node) const;
+		RenderPassSignature renderPassSignature(FramegraphNode* node) const;
+
 		void invalidateBuffer(FramegraphBufferHandle handle, BufferResourceHandle newHandle);
 		void invalidateImage(FramegraphImageHandle handle, ImageResourceHandle newHandle);
 
@@ -132,31 +223,141 @@ namespace vanadium::graphics {
 
 		VkImageUsageFlags targetImageUsageFlags() const { return m_targetImageUsageFlags; }
 
-		VkCommandBuffer recordFrame(uint32_t frameIndex);
+		// The frame's submissions. The acquire of the target image has to be waited for before the first graphics
+		// submission, and the last graphics submission finishes the frame.
+		const std::vector<FramegraphSubmission>& recordFrame(uint32_t frameIndex);
+		// If set, the submission of the last recorded frame's uploads has to signal this, so that submissions on
+		// other queues can wait for the uploads
+		std::optional<TimelineSemaphoreSignal> uploadSignal() const { return m_uploadSignal; }
+		// Waits until the async submissions of the frame that last used this frame index finished. The frame
+		// completion fence only covers the graphics queue.
+		void waitForAsyncSubmissions(uint32_t frameIndex);
 
 		void handleSwapchainResize(uint32_t width, uint32_t height);
 		bool swapchainDirtyFlag() const { return m_swapchainDirtyFlag; }
 		void clearSwapchainDirtyFlag() { m_swapchainDirtyFlag = false; }
 
+		// Memory that transient resources would need on top of the current usage if they didn't alias each other
+		VkDeviceSize transientMemorySaved() const { return m_transientMemorySaved; }
+
 		void destroy();
 
 	  private:
+		// m_nodes.size() if the node doesn't exist
+		size_t findNodeIndex(FramegraphNode* node) const;
+		void updateNodeIndices();
+
+		VkBufferCreateInfo bufferCreateInfo(FramegraphBufferHandle handle);
+		VkImageCreateInfo imageCreateInfo(FramegraphImageHandle handle);
 		void createBuffer(FramegraphBufferHandle handle);
 		void createImage(FramegraphImageHandle handle);
 
+		// Creates transient resources whose lifetimes don't overlap in shared memory. Resources are only recreated if
+		// a resource is missing or the lifetimes or memory requirements changed since the last call. Returns whether
+		// resources were recreated.
+		bool createTransientResources();
+		std::vector<ResourceAlias> createAliasedBuffers(const std::vector<FramegraphBufferHandle>& handles,
+														const std::vector<TransientResourceRequirements>& requirements);
+		std::vector<ResourceAlias> createAliasedImages(const std::vector<FramegraphImageHandle>& handles,
+													   const std::vector<TransientResourceRequirements>& requirements);
+		void destroyAliasingBlocks();
+
+		// Culls nodes whose results don't reach the swapchain image or an imported resource, and assigns the
+		// remaining nodes to queues. Only called when nodes or resource usages changed.
+		void cullNodes();
+		bool canUseAsyncCompute() const;
+		bool isNodeCulled(size_t nodeIndex) const {
+			return nodeIndex < m_isNodeCulled.size() && m_isNodeCulled[nodeIndex];
+		}
+
+		// Merges the raster passes of nodes that aren't culled into render passes
+		void planRenderPasses();
+		RasterNodeUsage rasterNodeUsage(size_t nodeIndex, const NodeResourceUsage& usage) const;
+		// Creates the planned render passes and their framebuffers. The previous ones are destroyed once the frames
+		// in flight finished using them.
+		void createRenderPasses();
+		// Keeps the render passes the resize didn't change, and only rebuilds the framebuffers the actions name
+		void resizeRenderPasses(std::vector<FramegraphRenderPass>& appliedRenderPasses,
+								const FramegraphResizeActions& actions);
+		FramegraphRenderPass createRenderPass(const MergedRenderPass& plan);
+		void createFramebuffers(FramegraphRenderPass& renderPass, const MergedRenderPass& plan);
+		// The node and declaration each attachment of the plan's render pass takes its view and clear value from
+		std::vector<std::pair<size_t, FramegraphRasterAttachment>> attachmentSources(
+			const MergedRenderPass& plan) const;
+		bool usesTargetExtent(const MergedRenderPass& plan) const;
+		// Render passes without a render pass handle only retire their framebuffers
+		void destroyRenderPasses(std::vector<FramegraphRenderPass>& renderPasses);
+		uint64_t rasterAttachmentResource(const FramegraphRasterAttachment& attachment) const;
+		VkImageView rasterAttachmentView(size_t nodeIndex, const FramegraphRasterAttachment& attachment,
+										 uint32_t targetImageIndex);
+		void beginRenderPass(VkCommandBuffer commandBuffer, const FramegraphRenderPass& renderPass);
+
 		// initResources handles initialization when usage etc. is known
 		void initResources();
+		void requestNodeViews();
+		// Everything the dependency info and recording segments depend on
+		CompilationKey compilationKey() const;
+		// Restores the results for the current compilation key from the cache if possible
 		void updateDependencyInfo();
 		void updateBarriers();
 
+		// Views are requested before recording starts, because requesting them can create them
+		void updateNodeContexts(uint32_t frameIndex);
+		VkCommandBuffer acquireCommandBuffer(FramegraphQueue queue, uint32_t poolIndex, uint32_t frameIndex);
+		void recordSegment(size_t segmentIndex, uint32_t poolIndex, uint32_t frameIndex);
+		void recordBarriers(VkCommandBuffer commandBuffer, const PipelineBarrierBatch& batch);
+		// Creates an event for every split barrier and resets the events the frame index used last time. The frame
+		// that used them has finished at this point.
+		void updateSplitBarrierEvents(uint32_t frameIndex);
+		void recordSplitBarrierSet(VkCommandBuffer commandBuffer, size_t splitBarrierIndex, uint32_t frameIndex);
+		void recordSplitBarrierWait(VkCommandBuffer commandBuffer, size_t splitBarrierIndex, uint32_t frameIndex);
+		void updateSubmissions(uint32_t frameIndex);
+
 		RenderContext m_context;
 
 		QueueBarrierGenerator m_barrierGenerator;
 
-		VkCommandPool m_frameCommandPools[frameInFlightCount];
-		VkCommandBuffer m_frameCommandBuffers[frameInFlightCount];
+		WorkerPool m_recordingWorkers;
+		// One entry per worker thread, the last one belongs to the thread calling recordFrame
+		std::vector<FramegraphRecordingPools> m_recordingPools;
+
+		// Segments never span multiple batches of the queue schedule
+		std::vector<RecordingSegment> m_recordingSegments;
+		std::vector<size_t> m_segmentBatchIndices;
+		// The graphics queue transitions the target image in the first and last of its segments, every queue waits
+		// for the previous frame's accesses in its first segment
+		std::array<size_t, framegraphQueueCount> m_firstQueueSegmentIndices = {};
+		size_t m_lastGraphicsSegmentIndex = 0;
+		std::vector<size_t> m_parallelSegmentIndices;
+		std::vector<FramegraphNodeContext> m_nodeContexts;
+		// One command buffer per segment
+		std::vector<VkCommandBuffer> m_frameCommandBuffers;
+		std::vector<FramegraphSubmission> m_frameSubmissions;
+
+		// One timeline per queue, every batch signals the next value of its queue
+		std::array<VkSemaphore, framegraphQueueCount> m_queueSemaphores = {};
+		std::array<uint64_t, framegraphQueueCount> m_queueSemaphoreValues = {};
+		uint64_t m_frameAsyncComputeValues[frameInFlightCount] = {};
+		std::optional<TimelineSemaphoreSignal> m_uploadSignal;
+
+		// Events of the split barriers per frame in flight, indexed like the split barriers
+		std::vector<VkEvent> m_splitBarrierEvents[frameInFlightCount];
+		size_t m_usedSplitBarrierEventCounts[frameInFlightCount] = {};
+		std::vector<MergedRenderPass> m_renderPassPlans;
+		std::vector<FramegraphRenderPass> m_renderPasses;
+		// Destroyed when the frame index is recorded again
+		std::vector<FramegraphRenderPass> m_retiredRenderPasses[frameInFlightCount];
+		uint32_t m_recordingFrameIndex = 0;
+
+		// Ownership transfers crossing frames can only be acquired once a frame with the current schedule released
+		bool m_hasReleasedOwnership = false;
 
 		std::vector<FramegraphNodeInfo> m_nodes;
+		robin_hood::unordered_map<FramegraphNode*, size_t> m_nodeIndices;
+
+		CompilationCache<FramegraphCompilation> m_compilationCache;
+		// Key of the applied compilation
+		CompilationKey m_compilationKey;
 
 		Slotmap<FramegraphBufferResource> m_buffers;
 		Slotmap<FramegraphImageResource> m_images;
@@ -164,6 +365,20 @@ namespace vanadium::graphics {
 		std::vector<FramegraphBufferHandle> m_transientBuffers;
 		std::vector<FramegraphImageHandle> m_transientImages;
 
+		std::vector<bool> m_isNodeCulled;
+
+		// Inputs of the last aliasing plan, only resources used by nodes that aren't culled are created
+		std::vector<FramegraphBufferHandle> m_activeBuffers;
+		std::vector<FramegraphImageHandle> m_activeImages;
+		std::vector<TransientResourceRequirements> m_aliasedBufferRequirements;
+		std::vector<TransientResourceRequirements> m_aliasedImageRequirements;
+		// Images sized like the target are recreated on resize, even if their memory requirements stay the same
+		VkExtent2D m_transientTargetExtent = {};
+
+		std::vector<BlockHandle> m_bufferAliasingBlocks;
+		std::vector<BlockHandle> m_imageAliasingBlocks;
+		VkDeviceSize m_transientMemorySaved = 0;
+
 		bool m_resourceDirtyFlag = false;
 		bool m_swapchainDirtyFlag = false;
 
@@ -175,8 +390,7 @@ namespace vanadium::graphics {
 																						  Args... constructorArgs) {
 		decltype(m_nodes)::iterator nodeIterator = m_nodes.begin();
 		if (insertAfter) {
-			nodeIterator = std::find_if(m_nodes.begin(), m_nodes.end(),
-										[insertAfter](const auto& info) { return info.node == insertAfter; });
+			nodeIterator = m_nodes.begin() + findNodeIndex(insertAfter);
 			if (nodeIterator == m_nodes.end()) {
 				logError("Trying to insert after nonexistent node {}!", static_cast<void*>(insertAfter));
 				return nullptr;
@@ -189,6 +403,7 @@ namespace vanadium::graphics {
 		} else {
 			m_nodes.insert(nodeIterator, { .node = new T(constructorArgs...) });
 		}
+		updateNodeIndices();
 		m_barrierGenerator.insertNodeBeforeIndex(nodeIndex);
 		// FramegraphNode might not be defined at this point, but T will contain all of its methods
 		reinterpret_cast<T*>(m_nodes[nodeIndex].node)->create(this);
@@ -200,8 +415,7 @@ namespace vanadium::graphics {
 	inline void FramegraphContext::insertExistingNode(FramegraphNode* insertAfter, T* node) {
 		decltype(m_nodes)::iterator nodeIterator = m_nodes.begin();
 		if (insertAfter) {
-			nodeIterator = std::find_if(m_nodes.begin(), m_nodes.end(),
-										[insertAfter](const auto& info) { return info.node == insertAfter; });
+			nodeIterator = m_nodes.begin() + findNodeIndex(insertAfter);
 			if (nodeIterator == m_nodes.end()) {
 				logError("Trying to insert after nonexistent node {}!", static_cast<void*>(insertAfter));
 				return;
@@ -214,6 +428,7 @@ namespace vanadium::graphics {
 		} else {
 			m_nodes.insert(nodeIterator, { .node = node });
 		}
+		updateNodeIndices();
 		m_barrierGenerator.insertNodeBeforeIndex(nodeIndex);
 		m_resourceDirtyFlag = true;
 	}
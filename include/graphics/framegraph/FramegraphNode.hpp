@@ -14,6 +14,16 @@ namespace vanadium::graphics {
 		virtual void recordCommands(FramegraphContext* context, VkCommandBuffer targetCommandBuffer,
 									const FramegraphNodeContext& nodeContext) = 0;
 
+		// Nodes returning true record into a primary command buffer of their own on a worker thread, while other nodes
+		// are recorded. recordCommands may then only read the context and node state, and must not declare or
+		// recreate resources.
+		virtual bool recordsInParallel() const { return false; }
+
+		// Nodes preferring the async compute queue may only record compute and transfer commands, and run in parallel
+		// to graphics nodes they don't share resources with. They run on the graphics queue if the device has no
+		// separate compute queue family or no timeline semaphores, or if they access the swapchain image.
+		virtual FramegraphQueue preferredQueue() const { return FramegraphQueue::Graphics; }
+
 		virtual void recreateSwapchainResources(FramegraphContext* context, uint32_t width, uint32_t height) {}
 
 		virtual void destroy(FramegraphContext* context) = 0;
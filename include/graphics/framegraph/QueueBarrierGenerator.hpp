@@ -1,10 +1,16 @@
 #pragma once
 
 #define VK_NO_PROTOTYPES
+#include <array>
 #include <optional>
 #include <robin_hood.h>
 #include <vector>
 #include <vulkan/vulkan.h>
+#include <graphics/util/CompilationCache.hpp>
+#include <graphics/util/NodeCulling.hpp>
+#include <graphics/util/PipelineBarrierBatch.hpp>
+#include <graphics/util/QueueScheduling.hpp>
+#include <graphics/util/SplitBarriers.hpp>
 #include <util/Slotmap.hpp>
 
 namespace vanadium::graphics {
@@ -56,6 +62,14 @@ namespace vanadium::graphics {
 		VkImageLayout afterLayout;
 		// If no value, the barrier refers to the target surface
 		std::optional<SlotmapHandle> image;
+
+		// Queue family ownership transfers have different queues
+		FramegraphQueue srcQueue = FramegraphQueue::Graphics;
+		FramegraphQueue dstQueue = FramegraphQueue::Graphics;
+		// The ownership was released at the end of the previous frame
+		bool crossesFrame = false;
+		// beforeLayout is replaced by the layout the image has at frame start
+		bool isFrameStart = false;
 	};
 
 	struct NodeBufferSubresourceAccess {
@@ -95,16 +109,50 @@ namespace vanadium::graphics {
 		VkDeviceSize offset;
 		VkDeviceSize size;
 		SlotmapHandle buffer;
+
+		// Queue family ownership transfers have different queues
+		FramegraphQueue srcQueue = FramegraphQueue::Graphics;
+		FramegraphQueue dstQueue = FramegraphQueue::Graphics;
+		// The ownership was released at the end of the previous frame
+		bool crossesFrame = false;
 	};
 
 	struct NodeBarrierInfo {
 		std::vector<ImageFramegraphBarrier> imageBarriers;
 		std::vector<BufferFramegraphBarrier> bufferBarriers;
 
-		std::vector<VkImageMemoryBarrier> vulkanImageBarriers;
-		std::vector<VkBufferMemoryBarrier> vulkanBufferBarriers;
-		VkPipelineStageFlags srcStages;
-		VkPipelineStageFlags dstStages;
+		PipelineBarrierBatch vulkanBarriers;
+
+		// Recorded before the node, on the node's queue. Used when the previous access happened on another queue.
+		std::vector<ImageFramegraphBarrier> acquireImageBarriers;
+		std::vector<BufferFramegraphBarrier> acquireBufferBarriers;
+
+		PipelineBarrierBatch vulkanAcquireBarriers;
+
+		// Split barriers whose event is set after the node, and split barriers waited for before the node
+		std::vector<size_t> setSplitBarrierIndices;
+		std::vector<size_t> waitSplitBarrierIndices;
+	};
+
+	// Barriers from srcNodeIndex to a distant dstNodeIndex on the same queue. An event is set after the source node
+	// and waited for before the destination node, so the nodes in between don't wait for the source node.
+	struct SplitFramegraphBarrier {
+		size_t srcNodeIndex;
+		size_t dstNodeIndex;
+		std::vector<ImageFramegraphBarrier> imageBarriers;
+		std::vector<BufferFramegraphBarrier> bufferBarriers;
+
+		// Setting and waiting for the event use the same barriers
+		PipelineBarrierBatch vulkanBarriers;
+	};
+
+	// Results of generateDependencyInfo, which can be restored as long as the accesses, culled nodes, queues and
+	// aliases are the same
+	struct FramegraphDependencyInfo {
+		std::vector<NodeBarrierInfo> nodeBarrierInfos;
+		std::vector<ImageFramegraphBarrier> frameStartImageBarriers;
+		std::vector<SplitFramegraphBarrier> splitBarriers;
+		QueueSchedule queueSchedule;
 	};
 
 	struct BufferAccessMatch {
@@ -122,6 +170,23 @@ namespace vanadium::graphics {
 		VkImageSubresourceRange range;
 	};
 
+	struct ResourceLifetime {
+		size_t firstNodeIndex;
+		size_t lastNodeIndex;
+	};
+
+	// previous and next share memory, and previous is only used before next is used for the first time
+	struct ResourceAlias {
+		SlotmapHandle previous;
+		SlotmapHandle next;
+	};
+
+	// Consecutive nodes recorded as the subpasses of one render pass. Nodes in between are culled.
+	struct MergedNodeRange {
+		size_t firstNodeIndex;
+		size_t lastNodeIndex;
+	};
+
 	using BufferHandleRetriever = VkBuffer (FramegraphContext::*)(SlotmapHandle handle);
 	using ImageHandleRetriever = VkImage (FramegraphContext::*)(SlotmapHandle handle);
 
@@ -139,18 +204,77 @@ namespace vanadium::graphics {
 		std::vector<SlotmapHandle> unusedBuffers() const;
 		std::vector<SlotmapHandle> unusedImages() const;
 
+		// Which resources each node reads and writes. Writing resources that aren't transient is an external effect.
+		std::vector<NodeResourceUsage> nodeResourceUsages(const std::vector<SlotmapHandle>& transientBuffers,
+														  const std::vector<SlotmapHandle>& transientImages) const;
+		bool accessesTarget(size_t nodeIndex) const;
+		// Accesses of culled nodes are ignored by all following functions
+		void setCulledNodes(const std::vector<bool>& isNodeCulled);
+
+		// Nodes that aren't on the graphics queue are recorded into separate submissions. Nodes accessing the target
+		// surface must be on the graphics queue.
+		void setNodeQueues(const std::vector<FramegraphQueue>& nodeQueues,
+						   const std::array<uint32_t, framegraphQueueCount>& queueFamilyIndices);
+		FramegraphQueue nodeQueue(size_t nodeIndex) const {
+			return nodeIndex < m_nodeQueues.size() ? m_nodeQueues[nodeIndex] : FramegraphQueue::Graphics;
+		}
+		bool usesAsyncQueues() const;
+		// Batches and semaphore waits of the last generateDependencyInfo call
+		const QueueSchedule& queueSchedule() const { return m_queueSchedule; }
+
+		// The first and last node accessing the resource, if any node accesses it. Resources accessed outside of the
+		// graphics queue are in use during the entire frame, so they never alias.
+		std::optional<ResourceLifetime> bufferLifetime(SlotmapHandle buffer) const;
+		std::optional<ResourceLifetime> imageLifetime(SlotmapHandle image) const;
+
+		// Replaces the aliased resources. The first access of a resource waits for the last accesses of all
+		// resources it aliases, images are transitioned from the undefined layout there instead of at frame start.
+		void setAliases(const std::vector<ResourceAlias>& bufferAliases,
+						const std::vector<ResourceAlias>& imageAliases);
+		bool hasAliases() const { return !m_bufferAliasPredecessors.empty() || !m_imageAliasPredecessors.empty(); }
+
+		// Barriers between nodes of a range are replaced by the subpass dependencies of the render pass, other
+		// barriers are recorded before the render pass begins or after it ends. Resources accessed in a range are in
+		// use during the entire range.
+		void setMergedNodeRanges(const std::vector<MergedNodeRange>& ranges) { m_mergedNodeRanges = ranges; }
+
 		void generateDependencyInfo();
+		FramegraphDependencyInfo dependencyInfo() const;
+		void restoreDependencyInfo(const FramegraphDependencyInfo& info);
+
+		// Adds all declared accesses and aliases, in an order that doesn't depend on the order of declaration
+		void addToCompilationKey(CompilationKey& key) const;
 
+		// With synchronization2, node barriers keep the stages of each barrier instead of merging them
+		void setUsesSynchronization2(bool usesSynchronization2) { m_usesSynchronization2 = usesSynchronization2; }
+
+		// If ownership wasn't released by the previous frame, acquires of the previous frame's releases are replaced
+		// by barriers without ownership transfer
 		void generateBarrierInfo(BufferHandleRetriever bufferHandleRetriever,
 								 ImageHandleRetriever imageHandleRetriever, FramegraphContext* context,
-								 VkImage currentTargetImageHandle);
-
-		size_t bufferBarrierCount(size_t nodeIndex) const;
-		const std::vector<VkBufferMemoryBarrier>& bufferBarriers(size_t nodeIndex) const;
-		size_t imageBarrierCount(size_t nodeIndex) const;
-		const std::vector<VkImageMemoryBarrier>& imageBarriers(size_t nodeIndex) const;
-		VkPipelineStageFlags srcStages(size_t nodeIndex) const;
-		VkPipelineStageFlags dstStages(size_t nodeIndex) const;
+								 VkImage currentTargetImageHandle, bool hasReleasedOwnership);
+
+		// Recorded after the node
+		const PipelineBarrierBatch& barriers(size_t nodeIndex) const {
+			return m_nodeBarrierInfos[nodeIndex].vulkanBarriers;
+		}
+		// Recorded before the node
+		const PipelineBarrierBatch& acquireBarriers(size_t nodeIndex) const {
+			return m_nodeBarrierInfos[nodeIndex].vulkanAcquireBarriers;
+		}
+
+		// Each split barrier needs its own event, because the barriers of setting an event and waiting for it have to
+		// match
+		size_t splitBarrierCount() const { return m_splitBarriers.size(); }
+		const PipelineBarrierBatch& splitBarriers(size_t splitBarrierIndex) const {
+			return m_splitBarriers[splitBarrierIndex].vulkanBarriers;
+		}
+		const std::vector<size_t>& setSplitBarrierIndices(size_t nodeIndex) const {
+			return m_nodeBarrierInfos[nodeIndex].setSplitBarrierIndices;
+		}
+		const std::vector<size_t>& waitSplitBarrierIndices(size_t nodeIndex) const {
+			return m_nodeBarrierInfos[nodeIndex].waitSplitBarrierIndices;
+		}
 
 		size_t frameStartBarrierCount() const { return m_frameStartImageBarriers.size(); }
 		const std::vector<VkImageMemoryBarrier>& frameStartBarriers() const { return m_vulkanFrameStartImageBarriers; }
@@ -169,17 +293,73 @@ namespace vanadium::graphics {
 		std::optional<ImageAccessMatch> findLastModification(const std::vector<ImageSubresourceAccess>& modifications,
 															 const ImageSubresourceAccess& read);
 
+		// Barriers for the first accesses of aliased resources, placed after the last node using any resource that
+		// previously occupied the memory. Return false if no predecessor is accessed by any node.
+		bool emitAliasingBarrier(SlotmapHandle buffer, const BufferSubresourceAccess& access);
+		bool emitAliasingBarrier(SlotmapHandle image, const ImageSubresourceAccess& access);
+
 		void emitBarrier(SlotmapHandle buffer, const BufferAccessMatch& match,
 						 const BufferSubresourceAccess& write, const BufferSubresourceAccess& read);
 		void emitBarrier(std::optional<SlotmapHandle> image, const ImageAccessMatch& match,
 						 const ImageSubresourceAccess& write, const ImageSubresourceAccess& read);
 
+		// Copies the accesses of nodes that aren't culled
+		void updateActiveAccessInfos();
+
+		// The next node after nodeIndex on the same queue, or the node count if there is none
+		size_t nextNodeOnQueue(size_t nodeIndex) const;
+
+		ResourceLifetime extendOverMergedRanges(ResourceLifetime lifetime) const;
+		// Removes barriers between nodes of the same merged range, and moves barriers from inside a range to its
+		// ends. Called before barriers are split or moved towards their destination.
+		void removeSubpassBarriers();
+		// Moves the queue ownership transfers of nodes inside a merged range to its ends
+		void moveTransfersOutOfMergedRanges();
+
+		// Moves barriers whose destination is far enough away from the node writing the resource into split barriers
+		void splitDistantBarriers();
+
+		// Barriers between nodes on different queues are replaced by the ownership transfers of the queue schedule,
+		// the submission waits for the other queue make the memory available
+		void generateQueueTransfers();
+		void emitOwnershipTransfer(SlotmapHandle buffer, const BufferAccessInfo& info,
+								   const QueueOwnershipTransfer& transfer);
+		void emitOwnershipTransfer(SlotmapHandle image, const ImageAccessInfo& info,
+								   const QueueOwnershipTransfer& transfer);
+
+		VkImageLayout frameStartLayout(const ImageFramegraphBarrier& barrier);
+		void convertBarrier(const BufferFramegraphBarrier& barrier, BufferHandleRetriever bufferHandleRetriever,
+							FramegraphContext* context, bool hasReleasedOwnership, PipelineBarrierBatch& batch);
+		void convertBarrier(const ImageFramegraphBarrier& barrier, ImageHandleRetriever imageHandleRetriever,
+							FramegraphContext* context, VkImage currentTargetImage, bool hasReleasedOwnership,
+							PipelineBarrierBatch& batch);
+
+		// All declared accesses
 		robin_hood::unordered_map<SlotmapHandle, BufferAccessInfo> m_bufferAccessInfos;
 
 		robin_hood::unordered_map<SlotmapHandle, ImageAccessInfo> m_imageAccessInfos;
 		ImageAccessInfo m_targetAccessInfo;
 
+		// Accesses of nodes that aren't culled, resources only accessed by culled nodes are missing
+		std::vector<bool> m_isNodeCulled;
+		robin_hood::unordered_map<SlotmapHandle, BufferAccessInfo> m_activeBufferAccessInfos;
+		robin_hood::unordered_map<SlotmapHandle, ImageAccessInfo> m_activeImageAccessInfos;
+		ImageAccessInfo m_activeTargetAccessInfo;
+
+		// For each aliased resource, the resources that used its memory before
+		robin_hood::unordered_map<SlotmapHandle, std::vector<SlotmapHandle>> m_bufferAliasPredecessors;
+		robin_hood::unordered_map<SlotmapHandle, std::vector<SlotmapHandle>> m_imageAliasPredecessors;
+
 		std::vector<NodeBarrierInfo> m_nodeBarrierInfos;
+		std::vector<SplitFramegraphBarrier> m_splitBarriers;
+		bool m_usesSynchronization2 = false;
+
+		std::vector<MergedNodeRange> m_mergedNodeRanges;
+
+		std::vector<FramegraphQueue> m_nodeQueues;
+		std::array<uint32_t, framegraphQueueCount> m_queueFamilyIndices = {};
+		// Starts with the single graphics batch of a framegraph without nodes
+		QueueSchedule m_queueSchedule = planQueueSchedule({}, {});
 
 		std::vector<ImageFramegraphBarrier> m_frameStartImageBarriers;
 		std::vector<VkImageMemoryBarrier> m_vulkanFrameStartImageBarriers;
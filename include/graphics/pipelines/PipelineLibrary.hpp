@@ -2,16 +2,30 @@
 
 #include <Log.hpp>
 #include <graphics/DeviceContext.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <graphics/RenderPassSignature.hpp>
+#include <graphics/pipelines/PipelineObjectCache.hpp>
+#include <graphics/util/LazyCreationTable.hpp>
+#include <graphics/util/PipelineCacheFile.hpp>
+#include <graphics/util/PipelineUsageLog.hpp>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <util/MappedFile.hpp>
+#include <util/WorkerPool.hpp>
 
 namespace vanadium::graphics {
 
 #include <tools/vcp/include/VCPFormat.hpp>
 
-	constexpr uint32_t pipelineFileVersion = 5;
-
 	struct DescriptorSetLayoutInfo {
 		VkDescriptorSetLayout layout;
 		std::vector<VkDescriptorSetLayoutBinding> bindingInfos;
@@ -22,76 +36,109 @@ namespace vanadium::graphics {
 		std::vector<VkShaderModule> shaderModules;
 		std::vector<uint32_t> setLayoutIndices;
 		std::vector<VkPushConstantRange> pushConstantRanges;
+		// Shared by all instances of the archetype, and with archetypes of the same layout
+		VkPipelineLayout layout;
 	};
 
+	// Map entries and data point into the library file
 	struct PipelineLibraryStageSpecialization {
-		PipelineLibraryStageSpecialization() {}
-		PipelineLibraryStageSpecialization(const PipelineLibraryStageSpecialization& other) = delete;
-		PipelineLibraryStageSpecialization& operator=(const PipelineLibraryStageSpecialization& other) = delete;
-		PipelineLibraryStageSpecialization(PipelineLibraryStageSpecialization&& other) = default;
-		PipelineLibraryStageSpecialization& operator=(PipelineLibraryStageSpecialization&& other) = delete;
-		~PipelineLibraryStageSpecialization() {
-			if(specializationData)
-				delete[] specializationData;
-		}
-
 		VkShaderStageFlagBits stage;
 		VkSpecializationInfo specializationInfo;
-		std::vector<VkSpecializationMapEntry> mapEntries;
-		char* specializationData = nullptr;
 	};
 
-
+	// Arrays of the pipeline state point into the library file. Shader stages point to the specializations, which keep
+	// their address when the instance is moved.
 	struct PipelineLibraryGraphicsInstance {
 		PipelineLibraryGraphicsInstance() {}
 		PipelineLibraryGraphicsInstance(const PipelineLibraryGraphicsInstance& other) = delete;
 		PipelineLibraryGraphicsInstance& operator=(const PipelineLibraryGraphicsInstance& other) = delete;
-		PipelineLibraryGraphicsInstance(PipelineLibraryGraphicsInstance&& other);
+		PipelineLibraryGraphicsInstance(PipelineLibraryGraphicsInstance&& other) = default;
 		PipelineLibraryGraphicsInstance& operator=(PipelineLibraryGraphicsInstance&& other) = delete;
 
 		uint32_t archetypeID;
-		std::string name;
+		std::string_view name;
 		std::vector<VkPipelineShaderStageCreateInfo> shaderStageCreateInfos;
 		std::vector<PipelineLibraryStageSpecialization> stageSpecializations;
-		std::vector<VkVertexInputAttributeDescription> attribDescriptions;
-		std::vector<VkVertexInputBindingDescription> bindingDescriptions;
 		VkPipelineVertexInputStateCreateInfo vertexInputConfig;
 		VkPipelineInputAssemblyStateCreateInfo inputAssemblyConfig;
 		VkPipelineRasterizationStateCreateInfo rasterizationConfig;
 		VkPipelineMultisampleStateCreateInfo multisampleConfig;
 		VkPipelineDepthStencilStateCreateInfo depthStencilConfig;
 		VkPipelineColorBlendStateCreateInfo colorBlendConfig;
-		std::vector<VkPipelineColorBlendAttachmentState> colorAttachmentBlendConfigs;
 		VkPipelineDynamicStateCreateInfo dynamicStateConfig;
-		std::vector<VkDynamicState> dynamicStates;
 		VkPipelineViewportStateCreateInfo viewportConfig;
-		std::vector<VkViewport> viewports;
-		std::vector<VkRect2D> scissorRects;
-		VkGraphicsPipelineCreateInfo pipelineCreateInfo;
+	};
 
-		robin_hood::unordered_map<RenderPassSignature, VkPipeline> pipelines;
+	using GraphicsPipelineTable =
+		LazyCreationTable<RenderPassSignature, VkPipeline, robin_hood::hash<RenderPassSignature>>;
+
+	struct GraphicsPipelinePrecompilation {
+		uint32_t instanceID;
+		RenderPassSignature signature;
+	};
+
+	enum class PipelineCreationMode {
+		// Graphics pipelines are created on first lookup. Pipelines recorded in the usage log of the last session are
+		// precompiled by a background thread once a render pass with their signature is available.
+		Lazy,
+		// createForPass creates all pipelines it is given
+		Eager
 	};
 
 	struct PipelineLibraryComputeInstance {
 		uint32_t archetypeID;
-		std::string name;
+		std::string_view name;
 		VkPipeline pipeline;
-		VkPipelineLayout layout;
+	};
+
+	// Shader code in the library file without an identical module in the object cache, turned into a shader module
+	// once all archetypes were read
+	struct PipelineLibraryShaderModuleCreation {
+		ShaderModuleKey key;
+		VkShaderModuleCreateInfo createInfo;
+		VkShaderModule module;
+	};
+
+	struct PipelineLibraryShaderModuleUse {
+		uint32_t archetypeID;
+		uint32_t moduleIndex;
+		uint32_t creationIndex;
+	};
+
+	struct PipelineLibraryComputeCreation {
+		uint32_t instanceID;
+		VkComputePipelineCreateInfo createInfo;
+		std::optional<PipelineLibraryStageSpecialization> specialization;
 	};
 
 	class PipelineLibrary {
 	  public:
-		PipelineLibrary() {}
+		static constexpr uint32_t maxCompilationThreadCount = 16;
 
-		void create(const std::string_view& libraryFileName, DeviceContext* deviceContext);
+		PipelineLibrary() {}
 
+		// The library file is memory-mapped and used in place until destroy(), files of the older stream format are
+		// converted in memory. Shader modules and compute pipelines are created in parallel. If usage is recorded, the
+		// graphics pipelines looked up in this session are written to a usage log next to the library file on
+		// destroy(). Libraries created with the same object cache share identical layouts, samplers and shader
+		// modules, which must be destroyed before the cache. Without one, the library uses a cache of its own.
+		void create(const std::string_view& libraryFileName, DeviceContext* deviceContext,
+					PipelineCreationMode creationMode = PipelineCreationMode::Lazy, bool recordsUsage = true,
+					PipelineObjectCache* objectCache = nullptr);
+
+		// Makes the render pass available for creating pipelines with the signature. Render passes with the same
+		// signature are compatible, so registering a recreated render pass keeps existing pipelines valid. In eager
+		// mode, the missing pipelines are created in parallel. Must not be called from multiple threads at once.
 		void createForPass(const RenderPassSignature& signature, VkRenderPass pass,
 						   const std::vector<uint32_t>& pipelineIDs);
-
-		// these methods are essentially const but the user can modify state using the pipeline handles
-		VkPipeline graphicsPipeline(uint32_t id, const RenderPassSignature& signature) {
-			return m_graphicsInstances[id].pipelines[signature];
-		}
+		// Must be called before a render pass registered with createForPass is destroyed, unless its signatures were
+		// registered with another pass since. Waits for pipelines being created with the pass and drops the
+		// precompilations queued for it.
+		void removePass(VkRenderPass pass);
+
+		// Creates the pipeline on the calling thread if no other thread created it yet. Safe to call from multiple
+		// threads. These methods are essentially const but the user can modify state using the pipeline handles.
+		VkPipeline graphicsPipeline(uint32_t id, const RenderPassSignature& signature);
 		VkPipeline computePipeline(uint32_t id) { return m_computeInstances[id].pipeline; }
 
 		const DescriptorSetLayoutInfo& graphicsPipelineSet(uint32_t id, uint32_t setIndex) {
@@ -99,7 +146,7 @@ namespace vanadium::graphics {
 		}
 		std::vector<DescriptorSetLayoutInfo> graphicsPipelineSets(uint32_t id);
 		VkPipelineLayout graphicsPipelineLayout(uint32_t id) {
-			return m_graphicsInstances[id].pipelineCreateInfo.layout;
+			return m_archetypes[m_graphicsInstances[id].archetypeID].layout;
 		}
 		const std::vector<VkPushConstantRange>& graphicsPipelinePushConstantRanges(uint32_t id) const {
 			return m_archetypes[m_graphicsInstances[id].archetypeID].pushConstantRanges;
@@ -109,7 +156,7 @@ namespace vanadium::graphics {
 		}
 		std::vector<DescriptorSetLayoutInfo> computePipelineSets(uint32_t id);
 		VkPipelineLayout computePipelineLayout(uint32_t id) {
-			return m_computeInstances[id].layout;
+			return m_archetypes[m_computeInstances[id].archetypeID].layout;
 		}
 		const std::vector<VkPushConstantRange>& computePipelinePushConstantRanges(uint32_t id) const {
 			return m_archetypes[m_computeInstances[id].archetypeID].pushConstantRanges;
@@ -118,24 +165,87 @@ namespace vanadium::graphics {
 		std::string_view graphicsPipelineName(uint32_t id) const { return m_graphicsInstances[id].name; }
 		std::string_view computePipelineName(uint32_t id) const { return m_computeInstances[id].name; }
 
-		uint32_t findGraphicsPipeline(const std::string_view& name);
-		uint32_t findComputePipeline(const std::string_view& name);
+		// Return ~0U if there is no pipeline with the name
+		uint32_t findGraphicsPipeline(const std::string_view& name) const;
+		uint32_t findComputePipeline(const std::string_view& name) const;
+
+		// Writes the pipeline cache to the file next to the pipeline library. Also called by destroy().
+		void savePipelineCache();
 
 		void destroy();
 
 	  private:
 		DeviceContext* m_deviceContext;
-		std::ifstream m_fileStream;
-
-		void createGraphicsPipeline();
-		void createComputePipeline();
+		// Shared with the keys of shader modules in the object cache, which compare the code in place
+		std::shared_ptr<MappedFile> m_libraryFile;
+		// Only used for files of the older stream format
+		std::shared_ptr<std::vector<char>> m_convertedLibrary;
+		VCPLibraryView m_libraryView;
+
+		// Returns whether pipelines are created with a warm pipeline cache
+		bool createPipelineCache();
+		PipelineCacheDeviceInfo pipelineCacheDeviceInfo() const;
+
+		void createSetLayouts();
+		void createArchetypes();
+		void createGraphicsInstances();
+		void createComputeInstances();
+		PipelineLibraryStageSpecialization stageSpecialization(const VCPStageSpecializationEntry& entry) const;
+		void createShaderModules();
+		void createComputePipelines();
+
+		// Callers hold m_renderPassMutex in shared mode while the pipeline is created, so that the pass can't be
+		// removed meanwhile
+		VkPipeline buildGraphicsPipeline(uint32_t id, const RenderPassSignature& signature, VkRenderPass pass);
+		void loadUsageLog(const std::string& fileName);
+		void writeUsageLog();
+		void precompilationLoop();
+		void stopPrecompilation();
+
+		VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
+		std::string m_pipelineCacheFileName;
+		bool m_isPipelineCacheWarm = false;
+		// Total time spent in createForPass, to compare startup with a warm and a cold pipeline cache
+		double m_passPipelineCreationMilliseconds = 0.0;
 
 		std::vector<PipelineLibraryArchetype> m_archetypes;
 		std::vector<PipelineLibraryGraphicsInstance> m_graphicsInstances;
 		std::vector<PipelineLibraryComputeInstance> m_computeInstances;
 
+		// Every handle in the archetypes, set layouts and immutable samplers holds one reference to its object
+		PipelineObjectCache* m_objectCache;
+		PipelineObjectCache m_ownedObjectCache;
 		std::vector<DescriptorSetLayoutInfo> m_descriptorSetLayouts;
 		std::vector<VkSampler> m_immutableSamplers;
+
+		WorkerPool m_compilationWorkers;
+		// Only used while the library is created
+		std::vector<PipelineLibraryShaderModuleCreation> m_shaderModuleCreations;
+		std::vector<PipelineLibraryShaderModuleUse> m_shaderModuleUses;
+		std::vector<PipelineLibraryComputeCreation> m_computeCreations;
+
+		PipelineCreationMode m_creationMode = PipelineCreationMode::Lazy;
+		// One table per graphics instance, so that lookups of different instances don't contend
+		std::vector<std::unique_ptr<GraphicsPipelineTable>> m_graphicsPipelines;
+		std::atomic<uint32_t> m_onDemandPipelineCount = 0;
+		std::atomic<uint32_t> m_precompiledPipelineCount = 0;
+
+		// Held in shared mode while pipelines are created, so replacing or removing a pass waits for its users
+		std::shared_mutex m_renderPassMutex;
+		robin_hood::unordered_map<RenderPassSignature, VkRenderPass> m_renderPasses;
+
+		// Empty if usage isn't recorded
+		std::string m_usageLogFileName;
+		// Instances used in the last session, by signature hash
+		robin_hood::unordered_map<uint64_t, std::vector<uint32_t>> m_loggedUsage;
+
+		// The precompilation thread is the only thread dispatching to m_compilationWorkers once the library is
+		// created in lazy mode
+		std::thread m_precompilationThread;
+		std::mutex m_precompilationMutex;
+		std::condition_variable m_precompilationCondition;
+		std::vector<GraphicsPipelinePrecompilation> m_precompilationQueue;
+		bool m_isStoppingPrecompilation = false;
 	};
 
 } // namespace vanadium::graphics
\ No newline at end of file
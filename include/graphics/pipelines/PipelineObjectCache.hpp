@@ -0,0 +1,63 @@
+#pragma once
+
+#include <graphics/DeviceContext.hpp>
+#include <graphics/util/PipelineObjectKeys.hpp>
+#include <graphics/util/SharedObjectTable.hpp>
+#include <atomic>
+#include <optional>
+#include <string>
+
+namespace vanadium::graphics {
+
+	struct PipelineObjectCounts {
+		size_t samplerCount;
+		size_t descriptorSetLayoutCount;
+		size_t pipelineLayoutCount;
+		size_t shaderModuleCount;
+	};
+
+	// Samplers, set layouts, pipeline layouts and shader modules shared by pipeline libraries. Objects are looked up
+	// by structural key and created only if no identical object exists, so pipelines with the same layout also use the
+	// same handle and don't need their descriptor sets rebound when switching between them. Every acquired object is
+	// released once, the last release destroys it. Safe to use from multiple threads.
+	class PipelineObjectCache {
+	  public:
+		PipelineObjectCache() {}
+		PipelineObjectCache(const PipelineObjectCache& other) = delete;
+		PipelineObjectCache& operator=(const PipelineObjectCache& other) = delete;
+
+		void create(DeviceContext* deviceContext);
+
+		VkSampler acquireSampler(const VkSamplerCreateInfo& createInfo);
+		VkDescriptorSetLayout acquireDescriptorSetLayout(const VkDescriptorSetLayoutCreateInfo& createInfo);
+		VkPipelineLayout acquirePipelineLayout(const VkPipelineLayoutCreateInfo& createInfo);
+		// Shader modules are created in parallel without holding the lock, so looking them up and adding them are
+		// separate steps
+		std::optional<VkShaderModule> acquireShaderModule(const ShaderModuleKey& key);
+		// Returns the module to use, which is an identical module added meanwhile if there is one. The key has to own
+		// its code.
+		VkShaderModule addShaderModule(const ShaderModuleKey& key, VkShaderModule module);
+
+		void releaseSampler(VkSampler sampler);
+		void releaseDescriptorSetLayout(VkDescriptorSetLayout layout);
+		void releasePipelineLayout(VkPipelineLayout layout);
+		void releaseShaderModule(VkShaderModule module);
+
+		PipelineObjectCounts objectCounts() const;
+
+		// All libraries using the cache must be destroyed before
+		void destroy();
+
+	  private:
+		// Objects are shared by pipelines of different names, so they get neutral names of their own
+		template <typename T> void nameObject(VkObjectType type, T handle, const char* typeName);
+
+		DeviceContext* m_deviceContext;
+		std::atomic<uint32_t> m_namedObjectCount = 0;
+
+		SharedObjectTable<std::string, VkSampler> m_samplers;
+		SharedObjectTable<std::string, VkDescriptorSetLayout> m_descriptorSetLayouts;
+		SharedObjectTable<std::string, VkPipelineLayout> m_pipelineLayouts;
+		SharedObjectTable<ShaderModuleKey, VkShaderModule, ShaderModuleKeyHash> m_shaderModules;
+	};
+} // namespace vanadium::graphics
@@ -0,0 +1,28 @@
+#pragma once
+
+#define VK_NO_PROTOTYPES
+#include <array>
+#include <vulkan/vulkan.h>
+
+namespace vanadium::graphics {
+
+	// Priorities that allocations are rounded to. Blocks are only shared by allocations of the same priority, so
+	// allowing arbitrary values would split memory into many sparsely used blocks.
+	constexpr std::array<float, 5> memoryPriorityLevels = { 0.0f, 0.25f, 0.5f, 0.75f, 1.0f };
+	// The priority of allocations that don't specify one, as defined by VK_EXT_memory_priority
+	constexpr float defaultMemoryPriority = 0.5f;
+
+	struct DedicatedAllocationQuery {
+		VkDeviceSize size;
+		// As reported by VkMemoryDedicatedRequirementsKHR, false if VK_KHR_dedicated_allocation is unavailable
+		bool prefersDedicatedAllocation;
+		bool requiresDedicatedAllocation;
+	};
+
+	// Whether a resource should get its own VkDeviceMemory instead of being placed in a block shared with other
+	// resources. Resources larger than half a block would leave most of a new block unused.
+	bool shouldUseDedicatedAllocation(const DedicatedAllocationQuery& query, VkDeviceSize blockSize);
+
+	// Clamps priority to [0, 1] and rounds it to the nearest of memoryPriorityLevels.
+	float quantizeMemoryPriority(float priority);
+} // namespace vanadium::graphics
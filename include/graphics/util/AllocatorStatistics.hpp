@@ -0,0 +1,56 @@
+#pragma once
+
+#include <graphics/util/RangeAllocator.hpp>
+#include <string>
+#include <vector>
+
+namespace vanadium::graphics {
+
+	// Usage of a single memory block, or the sum of the usage of multiple blocks.
+	struct MemoryUsageStatistics {
+		size_t blockCount = 0;
+		size_t allocationCount = 0;
+		size_t freeRangeCount = 0;
+		VkDeviceSize size = 0;
+		VkDeviceSize usedSize = 0;
+		VkDeviceSize largestFreeRange = 0;
+
+		// 0 if all free memory is in one range, approaching 1 the more the free memory is split into small ranges.
+		// For the sum of multiple blocks, free memory in different blocks counts as split.
+		float fragmentation() const;
+
+		MemoryUsageStatistics& operator+=(const MemoryUsageStatistics& other);
+	};
+
+	struct HeapStatistics {
+		// What is left of the heap budget after subtracting all allocated blocks
+		VkDeviceSize remainingBudget;
+		MemoryUsageStatistics usage;
+	};
+
+	struct MemoryTypeStatistics {
+		uint32_t heapIndex;
+		VkMemoryPropertyFlags properties;
+		MemoryUsageStatistics usage;
+
+		std::vector<MemoryUsageStatistics> bufferBlocks;
+		std::vector<MemoryUsageStatistics> imageBlocks;
+	};
+
+	struct AllocatorStatistics {
+		MemoryUsageStatistics total;
+		// Heap usage includes custom blocks, memory type usage doesn't.
+		std::vector<HeapStatistics> heaps;
+		std::vector<MemoryTypeStatistics> memoryTypes;
+
+		std::vector<MemoryUsageStatistics> customBufferBlocks;
+		std::vector<MemoryUsageStatistics> customImageBlocks;
+	};
+
+	MemoryUsageStatistics blockStatistics(const RangeAllocator& freeRanges, VkDeviceSize blockSize,
+										  size_t allocationCount);
+
+	// Serializes the statistics to JSON, with every block on its own line so that dumps of different frames can be
+	// compared with a line-based diff.
+	std::string statisticsToJSON(const AllocatorStatistics& statistics);
+} // namespace vanadium::graphics
@@ -0,0 +1,16 @@
+#pragma once
+
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+
+namespace vanadium::graphics {
+
+	// The alignment of offsets into a shared buffer so that sub-allocations can be bound to descriptors and flushed
+	// with the given usage. nonCoherentAtomSize should be 1 for host-coherent memory.
+	VkDeviceSize subAllocationAlignment(VkBufferUsageFlags usage, const VkPhysicalDeviceLimits& limits,
+										VkDeviceSize nonCoherentAtomSize);
+
+	// Per-frame sub-allocations place the data for all frames in flight one after another, each one starting at an
+	// aligned offset.
+	VkDeviceSize subAllocationFrameStride(VkDeviceSize size, VkDeviceSize alignment);
+} // namespace vanadium::graphics
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace vanadium::graphics {
+
+	// Describes everything a compilation result depends on as a sequence of values. Values have to be added in the
+	// same order every time, so equal inputs give equal keys.
+	class CompilationKey {
+	  public:
+		void add(uint64_t value) {
+			m_values.push_back(value);
+			// splitmix64 finalizer, so that small differences change the whole hash
+			uint64_t mixed = value + 0x9E3779B97F4A7C15ULL + m_hash;
+			mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBULL;
+			m_hash = mixed ^ (mixed >> 31);
+		}
+
+		uint64_t hash() const { return m_hash; }
+		bool operator==(const CompilationKey& other) const {
+			return m_hash == other.m_hash && m_values == other.m_values;
+		}
+
+	  private:
+		std::vector<uint64_t> m_values;
+		uint64_t m_hash = 0;
+	};
+
+	// Keeps the results of the most recently used keys. Keys are compared by hash first and by all values on a hash
+	// match, so hash collisions never return a wrong result.
+	template <typename T> class CompilationCache {
+	  public:
+		explicit CompilationCache(size_t capacity = 8) : m_capacity(capacity) {}
+
+		// Hits make the entry the most recently used one
+		std::optional<T> find(const CompilationKey& key) {
+			for (auto iterator = m_entries.begin(); iterator != m_entries.end(); ++iterator) {
+				if (iterator->first == key) {
+					m_entries.splice(m_entries.begin(), m_entries, iterator);
+					++m_hitCount;
+					return m_entries.front().second;
+				}
+			}
+			++m_missCount;
+			return std::nullopt;
+		}
+
+		// Replaces an existing result for the key, and evicts the least recently used entry if the cache is full
+		void insert(const CompilationKey& key, T result) {
+			for (auto iterator = m_entries.begin(); iterator != m_entries.end(); ++iterator) {
+				if (iterator->first == key) {
+					m_entries.erase(iterator);
+					break;
+				}
+			}
+			m_entries.emplace_front(key, std::move(result));
+			if (m_entries.size() > m_capacity) {
+				m_entries.pop_back();
+			}
+		}
+
+		void clear() { m_entries.clear(); }
+
+		size_t size() const { return m_entries.size(); }
+		size_t hitCount() const { return m_hitCount; }
+		size_t missCount() const { return m_missCount; }
+
+	  private:
+		size_t m_capacity;
+		// Most recently used first. The cache only holds a few entries, so a linear search is fast enough.
+		std::list<std::pair<CompilationKey, T>> m_entries;
+
+		size_t m_hitCount = 0;
+		size_t m_missCount = 0;
+	};
+} // namespace vanadium::graphics
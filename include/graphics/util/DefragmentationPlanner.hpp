@@ -0,0 +1,55 @@
+#pragma once
+
+#include <graphics/util/RangeAllocator.hpp>
+#include <util/Slotmap.hpp>
+#include <vector>
+
+namespace vanadium::graphics {
+
+	struct DefragmentationAllocation {
+		// Identifies the allocation in the planned moves, the planner doesn't interpret it.
+		SlotmapHandle resourceHandle;
+		MemoryRange allocationRange;
+		VkDeviceSize alignment;
+		VkDeviceSize size;
+	};
+
+	struct DefragmentationMove {
+		SlotmapHandle resourceHandle;
+		SlotmapHandle srcBlockHandle;
+		SlotmapHandle dstBlockHandle;
+		MemoryRange srcAllocationRange;
+		RangeAllocationResult dstAllocation;
+		VkDeviceSize size;
+	};
+
+	// Plans moves of allocations out of sparsely used blocks into the free space of densely used blocks, so that the
+	// sparse blocks become empty and can be freed.
+	// Destination ranges are allocated in the blocks' RangeAllocators directly. Source ranges stay allocated, they
+	// need to be freed by the caller once the copies have finished executing.
+	class DefragmentationPlanner {
+	  public:
+		void addBlock(SlotmapHandle blockHandle, RangeAllocator* freeRanges, VkDeviceSize blockSize);
+		// Only movable allocations are added. Blocks whose used space isn't entirely covered by movable allocations
+		// can't be emptied and are only used as destinations.
+		void addAllocation(SlotmapHandle blockHandle, const DefragmentationAllocation& allocation);
+
+		// Plans moves until moving the next allocation would exceed maxBytesToMove. Allocations are only moved out of
+		// blocks whose allocations all fit into the free space of other blocks.
+		std::vector<DefragmentationMove> planMoves(VkDeviceSize maxBytesToMove);
+
+	  private:
+		struct Block {
+			SlotmapHandle handle;
+			RangeAllocator* freeRanges;
+			VkDeviceSize size;
+			VkDeviceSize movableSize = 0;
+			std::vector<DefragmentationAllocation> allocations;
+		};
+
+		// Frees the destination ranges of moves starting at firstMove and removes these moves
+		void releaseDestinations(std::vector<DefragmentationMove>& moves, size_t firstMove);
+
+		std::vector<Block> m_blocks;
+	};
+} // namespace vanadium::graphics
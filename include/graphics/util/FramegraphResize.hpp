@@ -0,0 +1,28 @@
+#pragma once
+
+#include <graphics/util/CompilationCache.hpp>
+#include <graphics/util/RenderPassMerging.hpp>
+
+namespace vanadium::graphics {
+
+	// What the framegraph rebuilds after the target was resized, indexed like the render pass plans for the new size
+	struct FramegraphResizeActions {
+		// The applied compilation doesn't match the resized graph, so transient resources are placed again and the
+		// compilation is restored from the cache or compiled
+		bool updatesCompilation = false;
+		// Nodes have to be initialized again if a render pass they record in is recreated
+		std::vector<bool> recreatesRenderPass;
+		std::vector<bool> recreatesFramebuffers;
+	};
+
+	// Whether both plans result in the same render pass object. The extent only matters for the framebuffers.
+	bool haveSameRenderPass(const MergedRenderPass& first, const MergedRenderPass& second);
+
+	// Render passes are kept if their plan didn't change other than in its extent. Framebuffers are rebuilt if their
+	// render pass is recreated, one of their attachments is the target image or sized like it, or the compilation
+	// changed, because transient images may then be placed again.
+	FramegraphResizeActions planFramegraphResize(const CompilationKey& appliedKey, const CompilationKey& resizedKey,
+												 const std::vector<MergedRenderPass>& appliedPlans,
+												 const std::vector<MergedRenderPass>& resizedPlans,
+												 const std::vector<bool>& usesTargetExtent);
+} // namespace vanadium::graphics
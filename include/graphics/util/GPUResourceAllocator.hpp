@@ -1,8 +1,15 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <graphics/DeviceContext.hpp>
+#include <graphics/util/AllocationPlacement.hpp>
+#include <graphics/util/AllocatorStatistics.hpp>
+#include <graphics/util/BufferSubAllocation.hpp>
+#include <graphics/util/DefragmentationPlanner.hpp>
 #include <graphics/util/RangeAllocator.hpp>
+#include <mutex>
+#include <util/ConcurrentSlotmap.hpp>
 #include <util/MemoryLiterals.hpp>
 #include <util/Slotmap.hpp>
 #include <shared_mutex>
@@ -16,8 +23,7 @@ namespace vanadium::graphics {
 	};
 
 	struct MemoryBlock {
-		std::vector<MemoryRange> freeBlocksSizeSorted;
-		std::vector<MemoryRange> freeBlocksOffsetSorted;
+		RangeAllocator freeRanges;
 
 		MemoryCapabilities capabilities;
 
@@ -26,9 +32,18 @@ namespace vanadium::graphics {
 
 		VkDeviceMemory memoryHandle;
 		void* mappedPointer;
+
+		uint32_t typeIndex;
+		size_t allocationCount = 0;
+
+		// Only allocations with the same priority share a block
+		float priority = defaultMemoryPriority;
+		// Dedicated blocks hold exactly one resource and are freed as soon as it is destroyed
+		bool isDedicated = false;
 	};
 
 	using BlockHandle = SlotmapHandle;
+	using BufferSubAllocationPoolHandle = SlotmapHandle;
 
 	struct MemoryType {
 		VkMemoryPropertyFlags properties;
@@ -48,6 +63,18 @@ namespace vanadium::graphics {
 
 		VkBuffer buffers[frameInFlightCount];
 		void* mappedData[frameInFlightCount];
+
+		// Recreating the buffer is needed when moving it during defragmentation
+		VkBufferCreateInfo createInfo;
+		bool isMovable = false;
+
+		// For sub-allocated buffers, the pool the buffer was allocated from and where the data for each frame starts
+		// in the pool's buffer. allocationRange is relative to the pool's buffer.
+		BufferSubAllocationPoolHandle subAllocationPool = ~0U;
+		VkDeviceSize bufferOffsets[frameInFlightCount] = {};
+
+		// Bound at a fixed offset of an aliasing block, the range wasn't allocated from the block
+		bool isAliased = false;
 	};
 
 	struct ImageResourceViewInfo {
@@ -101,6 +128,9 @@ namespace vanadium::graphics {
 		uint32_t arrayLayerCount;
 	};
 
+	using BufferResourceHandle = SlotmapHandle;
+	using ImageResourceHandle = SlotmapHandle;
+
 	struct ImageAllocation {
 		ImageResourceInfo resourceInfo;
 		robin_hood::unordered_map<ImageResourceViewInfo, VkImageView> views;
@@ -110,9 +140,37 @@ namespace vanadium::graphics {
 		VkDeviceSize alignmentMargin;
 		MemoryRange allocationRange;
 		VkImage image;
+
+		// Recreating the image is needed when moving it during defragmentation
+		VkImageCreateInfo createInfo;
+		bool isMovable = false;
+		VkImageLayout frameEndLayout;
+
+		// Bound at a fixed offset of an aliasing block, the range wasn't allocated from the block
+		bool isAliased = false;
+	};
+
+	// A large buffer that small buffers with the same usage and memory requirements are carved out of.
+	struct BufferSubAllocationPool {
+		BufferResourceHandle buffer;
+		VkBufferUsageFlags usage;
+		MemoryCapabilities required;
+		MemoryCapabilities preferred;
+		bool createMapped;
+
+		VkDeviceSize alignment;
+		RangeAllocator freeRanges;
+	};
+
+	struct PendingBufferMove {
+		BufferResourceHandle handle;
+		BufferAllocation newAllocation;
+	};
+
+	struct PendingImageMove {
+		ImageResourceHandle handle;
+		ImageAllocation newAllocation;
 	};
-	using BufferResourceHandle = SlotmapHandle;
-	using ImageResourceHandle = SlotmapHandle;
 
 	class GPUResourceAllocator {
 	  public:
@@ -125,33 +183,76 @@ namespace vanadium::graphics {
 		BlockHandle createBufferBlock(size_t size, MemoryCapabilities required, MemoryCapabilities preferred,
 									  bool createMapped);
 		BlockHandle createImageBlock(size_t size, MemoryCapabilities required, MemoryCapabilities preferred);
+		// Creates a block that resources are bound to at offsets chosen by the caller, using createAliasedBuffer or
+		// createAliasedImage. Resources may overlap if they are never in use at the same time. The block's memory
+		// type is one of memoryTypeBits. Returns ~0U if no such memory type exists or the allocation failed.
+		BlockHandle createAliasingBlock(VkDeviceSize size, uint32_t memoryTypeBits, MemoryCapabilities required,
+										MemoryCapabilities preferred, bool isImageBlock);
+
+		// The memory requirements of resources created with these parameters. A resource is created temporarily to
+		// query them.
+		VkMemoryRequirements queryBufferMemoryRequirements(const VkBufferCreateInfo& bufferCreateInfo);
+		VkMemoryRequirements queryImageMemoryRequirements(const VkImageCreateInfo& imageCreateInfo);
 
 		// createMapped doesn't force mapping, specify hostVisible in required capabilities to require mappable
-		// allocations
+		// allocations.
+		// priority is passed to VK_EXT_memory_priority if it is supported. Memory with a lower priority is evicted
+		// first when the device runs out of memory. It is rounded to one of memoryPriorityLevels.
 		BufferResourceHandle createBuffer(const VkBufferCreateInfo& bufferCreateInfo, MemoryCapabilities required,
-										  MemoryCapabilities preferred, bool createMapped);
+										  MemoryCapabilities preferred, bool createMapped,
+										  float priority = defaultMemoryPriority);
 		// createMapped doesn't force mapping, specify hostVisible in required capabilities to require mappable
-		// allocations
+		// allocations. If the driver wants dedicated memory for the buffer, the frames share one VkBuffer at
+		// different bufferOffsets.
 		BufferResourceHandle createPerFrameBuffer(const VkBufferCreateInfo& bufferCreateInfo,
 												  MemoryCapabilities required, MemoryCapabilities preferred,
-												  bool createMapped);
+												  bool createMapped, float priority = defaultMemoryPriority);
 		BufferResourceHandle createBuffer(const VkBufferCreateInfo& bufferCreateInfo, BlockHandle block,
 										  bool createMapped);
+		// Binds a new buffer at offset in an aliasing buffer block. The contents of aliased resources are undefined
+		// when they are first used after another resource used the same memory.
+		BufferResourceHandle createAliasedBuffer(const VkBufferCreateInfo& bufferCreateInfo, BlockHandle block,
+												 VkDeviceSize offset);
+
+		// Creates a buffer that shares its VkBuffer with other small buffers of the same usage and capabilities.
+		// nativeBufferHandle returns the shared buffer, the buffer's data starts at bufferOffset in it.
+		// Buffers too large for sub-allocation get their own VkBuffer with a bufferOffset of 0.
+		BufferResourceHandle createSubAllocatedBuffer(const VkBufferCreateInfo& bufferCreateInfo,
+													  MemoryCapabilities required, MemoryCapabilities preferred,
+													  bool createMapped);
+		// Like createSubAllocatedBuffer, but the data of each frame in flight lives at a separate offset of the
+		// shared buffer instead of in separate VkBuffers.
+		BufferResourceHandle createPerFrameSubAllocatedBuffer(const VkBufferCreateInfo& bufferCreateInfo,
+															  MemoryCapabilities required,
+															  MemoryCapabilities preferred, bool createMapped);
 
 		MemoryCapabilities bufferMemoryCapabilities(BufferResourceHandle handle);
 		VkDeviceMemory nativeMemoryHandle(BufferResourceHandle handle);
+		// allocationRange, nativeBufferHandle, bufferOffset, mappedBufferData, nativeImageHandle and
+		// imageResourceInfo are wait-free and never block on resource creation or destruction on other threads.
+		// They must not be called concurrently with setFrameIndex or with destroying the resource's handle.
 		MemoryRange allocationRange(BufferResourceHandle handle);
 		VkBuffer nativeBufferHandle(BufferResourceHandle handle);
+		// The offset of the buffer's data in the native buffer. Always 0 unless the buffer is sub-allocated or a
+		// per-frame buffer that the driver wants dedicated memory for.
+		VkDeviceSize bufferOffset(BufferResourceHandle handle);
 		void* mappedBufferData(BufferResourceHandle handle);
+		// The buffer is freed once the current frame has finished. The handle stays valid until the next
+		// setFrameIndex call, so destroying only takes a short lock that doesn't block creation.
 		void destroyBuffer(BufferResourceHandle handle);
 		void destroyBufferImmediately(BufferResourceHandle handle);
 
+		// Render targets should use a high priority so that they stay resident, see createBuffer for details.
 		ImageResourceHandle createImage(const VkImageCreateInfo& imageCreateInfo, MemoryCapabilities required,
-										MemoryCapabilities preferred);
+										MemoryCapabilities preferred, float priority = defaultMemoryPriority);
 		ImageResourceHandle createImage(const VkImageCreateInfo& imageCreateInfo, BlockHandle block);
+		// Binds a new image at offset in an aliasing image block, see createAliasedBuffer
+		ImageResourceHandle createAliasedImage(const VkImageCreateInfo& imageCreateInfo, BlockHandle block,
+											   VkDeviceSize offset);
 		VkImage nativeImageHandle(ImageResourceHandle handle);
 		const ImageResourceInfo& imageResourceInfo(ImageResourceHandle handle);
 		VkImageView requestImageView(ImageResourceHandle handle, const ImageResourceViewInfo& info);
+		// See destroyBuffer
 		void destroyImage(ImageResourceHandle handle);
 		void destroyImageImmediately(ImageResourceHandle handle);
 
@@ -160,35 +261,108 @@ namespace vanadium::graphics {
 		// not threadsafe
 		void destroy();
 
+		// Allows defragmentation to move the buffer to a different memory location. Moving creates a new VkBuffer, so
+		// nativeBufferHandle has to be queried again every frame instead of being cached. Only buffers that aren't
+		// per-frame, mapped or in custom blocks and that have transfer source and destination usage can be moved.
+		void setBufferMovable(BufferResourceHandle handle, bool movable);
+		// Allows defragmentation to move the image to a different memory location. Moving creates a new VkImage and
+		// destroys all views of the old image, so these have to be queried again every frame instead of being cached.
+		// Only images that aren't in custom blocks and that have transfer source and destination usage can be moved.
+		// frameEndLayout is the layout the image is in when the defragmentation commands are executed, the moved
+		// image is transitioned back to it.
+		void setImageMovable(ImageResourceHandle handle, bool movable, VkImageLayout frameEndLayout);
+
+		// Moves movable allocations out of sparsely used blocks so that these blocks can be freed, copying no more
+		// than maxBytesToMove bytes. Resources with dedicated allocations are never moved.
+		// The copies are recorded into commandBuffer, which must be submitted in the current frame and execute after
+		// all other commands of the frame that access movable resources.
+		// The handles of moved resources refer to the new resources after the next setFrameIndex call, the old
+		// resources are freed once the current frame has finished. Returns the number of bytes moved.
+		VkDeviceSize recordDefragmentation(VkCommandBuffer commandBuffer, VkDeviceSize maxBytesToMove);
+
 		void setFrameIndex(uint32_t frameIndex);
 		void updateMemoryBudget();
 
+		// Takes a snapshot of the memory usage. The storage of statistics is reused, so taking a snapshot every frame
+		// doesn't allocate once the number of blocks stays constant.
+		void statistics(AllocatorStatistics& statistics);
+
 	  private:
 		static constexpr VkDeviceSize m_blockSize = 32_MiB;
 		static constexpr VkDeviceSize m_bufferBlockFreeThreshold = 64_MiB;
 		static constexpr VkDeviceSize m_imageBlockFreeThreshold = 128_MiB;
+		static constexpr VkDeviceSize m_subAllocationPoolSize = 4_MiB;
+		// Larger buffers don't profit much from sharing a VkBuffer and would waste pool space
+		static constexpr VkDeviceSize m_maxSubAllocationSize = 64_KiB;
+
+		BufferResourceHandle createBufferUnsynchronized(const VkBufferCreateInfo& bufferCreateInfo,
+														MemoryCapabilities required, MemoryCapabilities preferred,
+														bool createMapped, float priority);
+		// Allocates and binds memory for an already created buffer
+		BufferResourceHandle allocateBufferMemoryUnsynchronized(const VkBufferCreateInfo& bufferCreateInfo,
+																VkBuffer buffer,
+																const VkMemoryRequirements& requirements,
+																bool dedicated, MemoryCapabilities required,
+																MemoryCapabilities preferred, bool createMapped,
+																float priority);
+		BufferResourceHandle createPerFrameBufferUnsynchronized(const VkBufferCreateInfo& bufferCreateInfo,
+																MemoryCapabilities required,
+																MemoryCapabilities preferred, bool createMapped,
+																float priority);
+		// VK_KHR_dedicated_allocation binds memory to a single buffer. If the driver asks for it, the data of each
+		// frame in flight lives at a separate offset of one buffer with its own memory.
+		BufferResourceHandle createPerFrameDedicatedBufferUnsynchronized(const VkBufferCreateInfo& bufferCreateInfo,
+																		 MemoryCapabilities required,
+																		 MemoryCapabilities preferred,
+																		 bool createMapped, float priority);
+		BufferResourceHandle createSubAllocation(const VkBufferCreateInfo& bufferCreateInfo,
+												 MemoryCapabilities required, MemoryCapabilities preferred,
+												 bool createMapped, bool perFrame);
 
 		void destroyBufferImmediatelyUnsynchronized(const BufferAllocation& handle);
 		void destroyImageImmediatelyUnsynchronized(const ImageAllocation& handle);
 
 		void flushFreeList();
+		// Moves the resources destroyed since the last call into the free lists of the current frame
+		void retirePendingDestructions();
+		void applyPendingMoves();
+
+		// Plans moves of the movable resources of one memory type, creates and binds the destination resources and
+		// adds them to the pending moves. Returns the number of bytes moved.
+		// Only blocks of the given priority are considered, so that moves don't change the priority of resources.
+		VkDeviceSize planBufferMoves(uint32_t typeIndex, float priority, VkDeviceSize maxBytesToMove);
+		VkDeviceSize planImageMoves(uint32_t typeIndex, float priority, VkDeviceSize maxBytesToMove);
+
+		// Queries the memory requirements and, if VK_KHR_dedicated_allocation is supported, whether the driver wants
+		// a dedicated allocation for the resource.
+		DedicatedAllocationQuery bufferMemoryRequirements(VkBuffer buffer, VkMemoryRequirements& requirements);
+		DedicatedAllocationQuery imageMemoryRequirements(VkImage image, VkMemoryRequirements& requirements);
 
 		uint32_t bestTypeIndex(VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred,
 							   VkMemoryRequirements requirements, bool createMapped);
 		bool isTypeBigEnough(uint32_t typeIndex, VkDeviceSize size, bool createMapped);
 		std::optional<AllocationResult> allocate(uint32_t typeIndex, VkDeviceSize alignment, VkDeviceSize size,
-												 bool createMapped);
-		std::optional<AllocationResult> allocateImage(uint32_t typeIndex, VkDeviceSize alignment, VkDeviceSize size);
+												 bool createMapped, float priority);
+		std::optional<AllocationResult> allocateImage(uint32_t typeIndex, VkDeviceSize alignment, VkDeviceSize size,
+													  float priority);
+		// Allocates a block holding only one resource. If buffer or image is not VK_NULL_HANDLE, the memory is
+		// allocated for this resource using VK_KHR_dedicated_allocation, and the block is an image block if image is
+		// given.
+		std::optional<AllocationResult> allocateDedicated(uint32_t typeIndex, VkDeviceSize size, bool createMapped,
+														  float priority, VkBuffer buffer, VkImage image);
 		std::optional<AllocationResult> allocateInBlock(BlockHandle blockHandle, MemoryBlock& block,
 														VkDeviceSize alignment, VkDeviceSize size, bool createMapped);
 		void freeInBlock(MemoryBlock& block, VkDeviceSize offset, VkDeviceSize size);
 
-		bool allocateBlock(uint32_t typeIndex, VkDeviceSize size, bool createMapped, bool createImageBlock);
-		bool allocateCustomBlock(uint32_t typeIndex, VkDeviceSize size, bool createMapped, bool createImageBlock);
+		bool allocateBlock(uint32_t typeIndex, VkDeviceSize size, bool createMapped, bool createImageBlock,
+						   float priority);
+		BlockHandle allocateCustomBlock(uint32_t typeIndex, VkDeviceSize size, bool createMapped,
+										bool createImageBlock);
 
 		DeviceContext* m_context = nullptr;
 
-		uint32_t m_currentFrameIndex = 0;
+		// Read without holding m_accessMutex when resolving handles
+		std::atomic<uint32_t> m_currentFrameIndex = 0;
 
 		VkDeviceSize m_bufferImageGranularity;
 
@@ -198,14 +372,27 @@ namespace vanadium::graphics {
 		Slotmap<MemoryBlock> m_customBufferBlocks;
 		Slotmap<MemoryBlock> m_customImageBlocks;
 
-		Slotmap<BufferAllocation> m_buffers;
-		Slotmap<ImageAllocation> m_images;
+		// Allocations are only added or removed while holding m_accessMutex exclusively, but can be looked up without
+		// holding it
+		ConcurrentSlotmap<BufferAllocation> m_buffers;
+		Slotmap<BufferSubAllocationPool> m_bufferSubAllocationPools;
+		ConcurrentSlotmap<ImageAllocation> m_images;
 
 		std::vector<std::vector<BufferAllocation>> m_bufferFreeList;
 		std::vector<std::vector<ImageAllocation>> m_imageFreeList;
 		std::vector<std::vector<MemoryBlock>> m_blockFreeList;
 
+		// Moves recorded by recordDefragmentation in m_defragmentationFrameIndex, applied in the next setFrameIndex
+		std::vector<PendingBufferMove> m_pendingBufferMoves;
+		std::vector<PendingImageMove> m_pendingImageMoves;
+		uint32_t m_defragmentationFrameIndex = 0;
+
 		std::shared_mutex m_accessMutex;
+
+		// Guards only the pending destructions, so that destroying resources doesn't wait for m_accessMutex
+		std::mutex m_destructionMutex;
+		std::vector<BufferResourceHandle> m_pendingBufferDestructions;
+		std::vector<ImageResourceHandle> m_pendingImageDestructions;
 	};
 
 } // namespace vanadium::graphics
\ No newline at end of file
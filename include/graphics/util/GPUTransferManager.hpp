@@ -3,19 +3,21 @@
 #include <graphics/DeviceContext.hpp>
 #include <graphics/util/GPUResourceAllocator.hpp>
 #include <graphics/util/RangeAllocator.hpp>
+#include <graphics/util/StagingRing.hpp>
+#include <graphics/util/TransferBatching.hpp>
+#include <graphics/util/TransferQueuePolicy.hpp>
 #include <util/MemoryLiterals.hpp>
 #include <util/Slotmap.hpp>
+#include <optional>
 #include <shared_mutex>
 
 namespace vanadium::graphics {
 
 	struct StagingBuffer {
 		BufferResourceHandle buffer;
-		VkDeviceSize maxAllocatableSize;
 		VkDeviceSize originalSize;
 
-		std::vector<MemoryRange> freeRangesOffsetSorted;
-		std::vector<MemoryRange> freeRangesSizeSorted;
+		RangeAllocator freeRanges;
 	};
 
 	using StagingBufferHandle = SlotmapHandle;
@@ -25,10 +27,20 @@ namespace vanadium::graphics {
 		RangeAllocationResult allocationResult;
 	};
 
+	struct StagingCopy {
+		uint32_t segmentIndex;
+		VkBufferCopy region;
+	};
+
 	struct GPUTransfer {
 		BufferResourceHandle dstBuffer;
-		std::vector<StagingBufferAllocation> stagingBuffers;
-		std::vector<bool> hasNewData;
+		// Copies from the staging ring, recorded by the next recordTransfers call for each frame index
+		std::vector<std::vector<StagingCopy>> stagingCopies;
+		// Ranges of each frame's destination buffer that are outdated, only used for host-visible destinations
+		std::vector<std::vector<MemoryRange>> dirtyRanges;
+		// Latest contents of host-visible destinations. Outdated ranges are copied from here, because callers only
+		// provide the range they update.
+		std::vector<unsigned char> hostData;
 		bool needsStagingBuffer;
 		VkDeviceSize bufferSize;
 
@@ -88,16 +100,27 @@ namespace vanadium::graphics {
 
 	using AsyncImageTransferHandle = SlotmapHandle;
 
+	struct TimelineSemaphoreWait {
+		VkSemaphore semaphore;
+		uint64_t value;
+		VkPipelineStageFlags dstStageFlags;
+	};
+
 	class GPUTransferManager {
 	  public:
 		GPUTransferManager() {}
 
 		void create(DeviceContext* context, GPUResourceAllocator* allocator);
 
-		// Creates a GPU transfer. This automatically allocates one destination buffer per frame in flight and
-		// corresponding staging buffers, if the destination buffer cannot be allocated in host-visible VRAM.
+		// Creates a GPU transfer. This automatically allocates one destination buffer per frame in flight. If the
+		// destination buffer cannot be allocated in host-visible VRAM, new data is uploaded through the staging ring.
 		GPUTransferHandle createTransfer(VkDeviceSize transferBufferSize, VkBufferUsageFlags usageFlags,
 										 VkPipelineStageFlags usageStageFlags, VkAccessFlags usageAccessFlags);
+		// Like createTransfer, but small destination buffers share their VkBuffer with other transfers. Descriptors
+		// and bindings must use the allocator's bufferOffset, which differs between frames in flight.
+		GPUTransferHandle createSubAllocatedTransfer(VkDeviceSize transferBufferSize, VkBufferUsageFlags usageFlags,
+													 VkPipelineStageFlags usageStageFlags,
+													 VkAccessFlags usageAccessFlags);
 
 		void destroyTransfer(GPUTransferHandle handle);
 
@@ -112,6 +135,9 @@ namespace vanadium::graphics {
 														  VkPipelineStageFlags usageStageFlags,
 														  VkAccessFlags usageAccessFlags);
 
+		// Large uploads to buffers that aren't host-visible are copied on the dedicated transfer queue if the device
+		// has one. The destination buffer must not be in use by frames in flight, and only the uploaded range is
+		// transferred to the graphics queue family.
 		void submitOneTimeTransfer(VkDeviceSize transferBufferSize, BufferResourceHandle handle, const void* data,
 								   VkPipelineStageFlags usageStageFlags, VkAccessFlags usageAccessFlags);
 
@@ -122,9 +148,18 @@ namespace vanadium::graphics {
 
 		BufferResourceHandle dstBufferHandle(GPUTransferHandle handle);
 
+		// frameIndex must be the index of the next frame that is recorded, the staging area for the data is only valid
+		// until that frame has finished.
 		void updateTransferData(GPUTransferHandle transfer, uint32_t frameIndex, const void* data);
+		// Only updates [offset; offset + size) of the buffer. data points to the start of the buffer's contents, but
+		// only the updated range of it is read.
+		void updateTransferData(GPUTransferHandle transfer, uint32_t frameIndex, const void* data, VkDeviceSize offset,
+								VkDeviceSize size);
 
 		VkCommandBuffer recordTransfers(uint32_t frameIndex);
+		// The semaphore wait the graphics submission of the last recorded frame needs to add, if some of its uploads
+		// were submitted to the transfer queue.
+		std::optional<TimelineSemaphoreWait> transferQueueWait() const { return m_transferQueueWait; }
 
 		void destroy();
 		void tryCleanupStagingBuffers();
@@ -138,7 +173,21 @@ namespace vanadium::graphics {
 		StagingBufferAllocation allocateStagingBufferArea(VkDeviceSize size);
 
 	  private:
+		GPUTransferHandle createTransferUnsynchronized(VkDeviceSize transferBufferSize, VkBufferUsageFlags usageFlags,
+													   VkPipelineStageFlags usageStageFlags,
+													   VkAccessFlags usageAccessFlags, bool subAllocate);
+		// Allocates an area for this frame's uploads in the staging ring, creating a buffer for new ring segments.
+		StagingRingAllocation allocateStagingRingArea(VkDeviceSize size);
+		// Copies data to a staging ring area and flushes it if the segment isn't host-coherent.
+		void writeStagingRingArea(const StagingRingAllocation& allocation, const void* data, VkDeviceSize size);
+		// Records the copies of the plan to the transfer queue command buffer of this frame and submits it. The copy
+		// plan's barriers are turned into release barriers, the matching acquire barriers are returned.
+		std::vector<VkBufferMemoryBarrier> submitTransferQueueCopies(uint32_t frameIndex, BufferCopyPlan& copyPlan);
+
 		constexpr static size_t m_minStagingBlockSize = 32_MiB;
+		constexpr static size_t m_stagingRingSegmentSize = 4_MiB;
+		// Spilled segments that weren't used for this many frames are freed again
+		constexpr static uint64_t m_stagingRingMaxIdleFrames = 60;
 
 		DeviceContext* m_context;
 		GPUResourceAllocator* m_resourceAllocator;
@@ -151,6 +200,15 @@ namespace vanadium::graphics {
 		VkCommandBuffer m_transferCommandBuffers[frameInFlightCount];
 		VkCommandPool m_transferCommandPools[frameInFlightCount];
 
+		TransferQueuePolicy m_transferQueuePolicy;
+		// Command buffers executed on the async transfer queue for uploads of each frame. They are only created if
+		// the policy can use the transfer queue.
+		VkCommandBuffer m_transferQueueCommandBuffers[frameInFlightCount] = {};
+		VkCommandPool m_transferQueueCommandPools[frameInFlightCount] = {};
+		VkSemaphore m_transferQueueSemaphore = VK_NULL_HANDLE;
+		uint64_t m_transferQueueSemaphoreValue = 0;
+		std::optional<TimelineSemaphoreWait> m_transferQueueWait;
+
 		Slotmap<GPUTransfer> m_continuousTransfers;
 		std::vector<GPUTransfer> m_oneTimeTransfers;
 		std::vector<GPUImageTransfer> m_imageTransfers;
@@ -172,8 +230,15 @@ namespace vanadium::graphics {
 
 		Slotmap<StagingBuffer> m_stagingBuffers;
 
-		// An array of free staging buffers for each frame in flight.
-		std::vector<std::vector<StagingBufferAllocation>> m_stagingBufferAllocationFreeList;
+		// Staging memory for continuous and one-time transfers. Uploads are bump-allocated and reclaimed as a whole
+		// once the frame that copied them has finished.
+		StagingRing m_stagingRing;
+		// One buffer per ring segment, ~0U for released segments
+		std::vector<BufferResourceHandle> m_stagingRingBuffers;
+		// Values of the staging ring's completion timeline, one per recorded frame
+		uint64_t m_stagingRingFrameValue = 0;
+		// The value of the last frame recorded with each frame index. It is complete once the frame's fence signals.
+		uint64_t m_stagingRingFrameValues[frameInFlightCount] = {};
 
 		std::shared_mutex m_accessMutex;
 	};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace vanadium::graphics {
+
+	enum class LazyCreationState { Missing, Creating, Ready };
+
+	// Objects created on first lookup, or ahead of time by a background thread. Each object is created exactly once,
+	// by the first thread asking for it, and other threads asking for it meanwhile wait for that thread. Creation
+	// runs without holding the lock, so different objects can be created in parallel.
+	template <typename Key, typename Value, typename Hash = std::hash<Key>> class LazyCreationTable {
+	  public:
+		// Returns the object, creating it on the calling thread if no thread created it yet. Marks the object as used.
+		template <typename F> Value getOrCreate(const Key& key, F&& create) {
+			{
+				auto lock = std::shared_lock<std::shared_mutex>(m_mutex);
+				auto iterator = m_entries.find(key);
+				if (iterator != m_entries.end() && iterator->second.state == LazyCreationState::Ready &&
+					iterator->second.isUsed) {
+					return iterator->second.value;
+				}
+			}
+
+			auto lock = std::unique_lock<std::shared_mutex>(m_mutex);
+			auto& entry = m_entries[key];
+			if (entry.state == LazyCreationState::Missing) {
+				entry.state = LazyCreationState::Creating;
+				lock.unlock();
+				Value value = create();
+				lock.lock();
+				finishCreation(key, value);
+			} else {
+				m_creationFinishCondition.wait(lock, [this, &key]() {
+					return m_entries[key].state == LazyCreationState::Ready;
+				});
+			}
+			// References into the map aren't stable while the lock isn't held
+			auto& readyEntry = m_entries[key];
+			readyEntry.isUsed = true;
+			return readyEntry.value;
+		}
+
+		// Creates the object unless another thread created it or is creating it, without marking it as used. Returns
+		// whether the calling thread created the object.
+		template <typename F> bool tryCreate(const Key& key, F&& create) {
+			auto lock = std::unique_lock<std::shared_mutex>(m_mutex);
+			auto& entry = m_entries[key];
+			if (entry.state != LazyCreationState::Missing) {
+				return false;
+			}
+			entry.state = LazyCreationState::Creating;
+			lock.unlock();
+			Value value = create();
+			lock.lock();
+			finishCreation(key, value);
+			return true;
+		}
+
+		LazyCreationState state(const Key& key) const {
+			auto lock = std::shared_lock<std::shared_mutex>(m_mutex);
+			auto iterator = m_entries.find(key);
+			return iterator == m_entries.end() ? LazyCreationState::Missing : iterator->second.state;
+		}
+
+		// Keys of all objects returned by getOrCreate, in no particular order
+		std::vector<Key> usedKeys() const {
+			auto lock = std::shared_lock<std::shared_mutex>(m_mutex);
+			std::vector<Key> keys;
+			for (auto& [key, entry] : m_entries) {
+				if (entry.isUsed) {
+					keys.push_back(key);
+				}
+			}
+			return keys;
+		}
+
+		// Must not be called while objects are created
+		template <typename F> void forEachReady(F&& function) const {
+			auto lock = std::shared_lock<std::shared_mutex>(m_mutex);
+			for (auto& [key, entry] : m_entries) {
+				if (entry.state == LazyCreationState::Ready) {
+					function(key, entry.value);
+				}
+			}
+		}
+
+		void clear() {
+			auto lock = std::unique_lock<std::shared_mutex>(m_mutex);
+			m_entries.clear();
+		}
+
+	  private:
+		struct Entry {
+			LazyCreationState state = LazyCreationState::Missing;
+			bool isUsed = false;
+			Value value = {};
+		};
+
+		void finishCreation(const Key& key, const Value& value) {
+			auto& entry = m_entries[key];
+			entry.value = value;
+			entry.state = LazyCreationState::Ready;
+			m_creationFinishCondition.notify_all();
+		}
+
+		mutable std::shared_mutex m_mutex;
+		std::condition_variable_any m_creationFinishCondition;
+		std::unordered_map<Key, Entry, Hash> m_entries;
+	};
+} // namespace vanadium::graphics
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vanadium::graphics {
+
+	// Resource identifiers only need to be unique across all resources of the graph
+	struct NodeResourceUsage {
+		std::vector<uint64_t> readResources;
+		std::vector<uint64_t> writtenResources;
+		// Writes the swapchain image, an imported resource or something else outside of the graph
+		bool hasExternalEffects = false;
+	};
+
+	// Walks the dependencies backwards from nodes with external effects and returns true for every node whose
+	// results never reach one of them. A node reading a resource depends on all nodes writing it, regardless of their
+	// order, since writes late in the frame can be read early in the next frame. Nodes that don't write any resource
+	// have effects the graph doesn't know about and are never culled.
+	std::vector<bool> findCulledNodes(const std::vector<NodeResourceUsage>& nodes);
+} // namespace vanadium::graphics
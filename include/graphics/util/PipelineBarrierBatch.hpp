@@ -0,0 +1,48 @@
+#pragma once
+
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+#include <vector>
+
+namespace vanadium::graphics {
+
+	// Barriers recorded with a single pipeline barrier command. Without VK_KHR_synchronization2, all barriers share
+	// one source and destination stage mask, so each barrier also waits for the stages of all other barriers. With
+	// synchronization2, every barrier keeps its own stages.
+	class PipelineBarrierBatch {
+	  public:
+		// Removes all barriers and selects the form they are stored in
+		void reset(bool usesSynchronization2);
+
+		void addBufferBarrier(const VkBufferMemoryBarrier& barrier, VkPipelineStageFlags srcStageFlags,
+							  VkPipelineStageFlags dstStageFlags);
+		void addImageBarrier(const VkImageMemoryBarrier& barrier, VkPipelineStageFlags srcStageFlags,
+							 VkPipelineStageFlags dstStageFlags);
+
+		bool usesSynchronization2() const { return m_usesSynchronization2; }
+		bool empty() const;
+
+		// Only filled without synchronization2
+		const std::vector<VkBufferMemoryBarrier>& bufferBarriers() const { return m_bufferBarriers; }
+		const std::vector<VkImageMemoryBarrier>& imageBarriers() const { return m_imageBarriers; }
+		VkPipelineStageFlags srcStageFlags() const { return m_srcStageFlags; }
+		VkPipelineStageFlags dstStageFlags() const { return m_dstStageFlags; }
+
+		// Only filled with synchronization2
+		const std::vector<VkBufferMemoryBarrier2KHR>& bufferBarriers2() const { return m_bufferBarriers2; }
+		const std::vector<VkImageMemoryBarrier2KHR>& imageBarriers2() const { return m_imageBarriers2; }
+		// Points to the barriers of the batch, adding barriers invalidates it
+		VkDependencyInfoKHR dependencyInfo() const;
+
+	  private:
+		bool m_usesSynchronization2 = false;
+
+		std::vector<VkBufferMemoryBarrier> m_bufferBarriers;
+		std::vector<VkImageMemoryBarrier> m_imageBarriers;
+		VkPipelineStageFlags m_srcStageFlags = 0;
+		VkPipelineStageFlags m_dstStageFlags = 0;
+
+		std::vector<VkBufferMemoryBarrier2KHR> m_bufferBarriers2;
+		std::vector<VkImageMemoryBarrier2KHR> m_imageBarriers2;
+	};
+} // namespace vanadium::graphics
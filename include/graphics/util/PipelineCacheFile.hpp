@@ -0,0 +1,36 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vanadium::graphics {
+
+	constexpr uint32_t pipelineCacheFileMagic = 0x43435056; // "VPCC"
+	constexpr uint32_t pipelineCacheFileVersion = 1;
+
+	// The parts of the device properties pipeline cache data is only valid for
+	struct PipelineCacheDeviceInfo {
+		uint32_t vendorID;
+		uint32_t deviceID;
+		uint32_t driverVersion;
+		std::array<uint8_t, 16> pipelineCacheUUID;
+	};
+
+	// Prepends a header with the device info and a checksum of the data, since drivers don't necessarily check the
+	// data they are given for corruption
+	std::vector<char> serializePipelineCache(const PipelineCacheDeviceInfo& deviceInfo,
+											 const std::vector<char>& cacheData);
+
+	// Returns the cache data if the file was written for the same device and driver, and neither the file header,
+	// the checksum nor the Vulkan pipeline cache header inside the data indicate otherwise
+	std::optional<std::vector<char>> deserializePipelineCache(const PipelineCacheDeviceInfo& deviceInfo,
+															  const char* fileData, size_t fileSize);
+
+	// Writes to a temporary file next to the target and renames it, so that the file is never partially written if
+	// the application exits while writing
+	bool writeFileAtomically(const std::string& fileName, const std::vector<char>& data);
+} // namespace vanadium::graphics
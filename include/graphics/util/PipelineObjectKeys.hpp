@@ -0,0 +1,38 @@
+#pragma once
+
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace vanadium::graphics {
+
+	// Structural keys of the objects shared between pipelines. Two create infos have the same key if they create
+	// interchangeable objects. Objects referenced by the create info (immutable samplers, set layouts) are compared by
+	// handle, so they must be shared themselves for their users to be shared. pNext chains aren't part of the keys.
+
+	std::string samplerKey(const VkSamplerCreateInfo& createInfo);
+	// Bindings are compared regardless of their order
+	std::string descriptorSetLayoutKey(const VkDescriptorSetLayoutCreateInfo& createInfo);
+	std::string pipelineLayoutKey(const VkPipelineLayoutCreateInfo& createInfo);
+
+	// Shader code is too large to copy into a key. Keys hash the code and only compare it in place if the hashes
+	// match, so the code has to stay valid while the key is in use. codeOwner keeps it alive in caches.
+	struct ShaderModuleKey {
+		VkShaderModuleCreateFlags flags;
+		size_t codeSize;
+		uint64_t codeHash;
+		const uint32_t* pCode;
+		std::shared_ptr<const void> codeOwner;
+
+		bool operator==(const ShaderModuleKey& other) const;
+	};
+
+	struct ShaderModuleKeyHash {
+		size_t operator()(const ShaderModuleKey& key) const { return static_cast<size_t>(key.codeHash); }
+	};
+
+	ShaderModuleKey shaderModuleKey(const VkShaderModuleCreateInfo& createInfo,
+									std::shared_ptr<const void> codeOwner = {});
+} // namespace vanadium::graphics
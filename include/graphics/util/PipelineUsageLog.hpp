@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vanadium::graphics {
+
+	constexpr std::string_view pipelineUsageLogHeader = "vanadium-pipeline-usage 1";
+
+	// Instances are identified by name, since IDs change when the pipeline library is rebuilt. Render pass signatures
+	// are identified by their hash, which only depends on formats, sample counts and dependencies.
+	struct PipelineUsageEntry {
+		std::string instanceName;
+		uint64_t signatureHash;
+
+		bool operator==(const PipelineUsageEntry& other) const = default;
+	};
+
+	// One entry per line, as hexadecimal signature hash followed by the instance name, which may contain spaces
+	std::string serializePipelineUsage(const std::vector<PipelineUsageEntry>& entries);
+
+	// Skips malformed lines, and returns no entries if the header doesn't match
+	std::vector<PipelineUsageEntry> parsePipelineUsage(std::string_view text);
+} // namespace vanadium::graphics
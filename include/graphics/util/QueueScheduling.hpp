@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vanadium::graphics {
+
+	enum class FramegraphQueue : uint32_t { Graphics, AsyncCompute };
+	constexpr size_t framegraphQueueCount = 2;
+
+	struct QueueScheduledResource {
+		// Nodes accessing the resource, in execution order
+		std::vector<size_t> accessingNodeIndices;
+		// The first access of a frame uses what the previous frame left in the resource
+		bool preservesContents;
+	};
+
+	// Consecutive nodes running on the same queue, submitted together
+	struct QueueSubmissionBatch {
+		FramegraphQueue queue;
+		size_t firstNodeIndex;
+		size_t nodeCount;
+	};
+
+	// dst has to wait for src to finish. If crossesFrame is set, src is the batch of the previous frame.
+	struct QueueBatchDependency {
+		size_t srcBatchIndex;
+		size_t dstBatchIndex;
+		bool crossesFrame;
+
+		bool operator==(const QueueBatchDependency& other) const = default;
+	};
+
+	// The queue of srcNodeIndex releases the resource after the node, the queue of dstNodeIndex acquires it before.
+	// If crossesFrame is set, the release happens in the previous frame.
+	struct QueueOwnershipTransfer {
+		size_t resourceIndex;
+		size_t srcNodeIndex;
+		size_t dstNodeIndex;
+		bool crossesFrame;
+	};
+
+	struct QueueSchedule {
+		// Cover all nodes in order. At least one batch runs on the graphics queue.
+		std::vector<QueueSubmissionBatch> batches;
+		std::vector<QueueBatchDependency> dependencies;
+		std::vector<QueueOwnershipTransfer> ownershipTransfers;
+
+		size_t batchIndex(size_t nodeIndex) const;
+	};
+
+	// Splits the nodes into batches per queue and finds the semaphore waits and ownership transfers needed where
+	// consecutive accesses of a resource happen on different queues. The last access of a frame and the first access
+	// of the next frame count as consecutive as well. Every queue is assumed to be in a different queue family.
+	QueueSchedule planQueueSchedule(const std::vector<FramegraphQueue>& nodeQueues,
+									const std::vector<QueueScheduledResource>& resources);
+} // namespace vanadium::graphics
@@ -2,8 +2,9 @@
 
 #define VK_NO_PROTOTYPES
 #include <vulkan/vulkan.h>
-#include <vector>
+#include <map>
 #include <optional>
+#include <set>
 
 namespace vanadium::graphics {
 	struct MemoryRange {
@@ -19,11 +20,45 @@ namespace vanadium::graphics {
 	VkDeviceSize roundUpAligned(VkDeviceSize n, VkDeviceSize alignment);
 	VkDeviceSize alignmentMargin(VkDeviceSize n, VkDeviceSize alignment);
 
-	std::optional<RangeAllocationResult> allocateFromRanges(std::vector<MemoryRange>& gapsOffsetSorted,
-															std::vector<MemoryRange>& gapsSizeSorted,
-															VkDeviceSize alignment, VkDeviceSize size);
+	// Manages the free ranges of a linear memory area (e.g. a memory block or a staging buffer).
+	// Allocations are served from the smallest free range that fits (best fit), and freed ranges are merged with
+	// adjacent free ranges. Both operations take O(log n) time for n free ranges.
+	class RangeAllocator {
+	  public:
+		RangeAllocator() {}
+		// Creates an allocator where [offset; offset + size) is free.
+		RangeAllocator(VkDeviceSize offset, VkDeviceSize size);
 
-	void freeToRanges(std::vector<MemoryRange>& gapsOffsetSorted, std::vector<MemoryRange>& gapsSizeSorted,
-					  VkDeviceSize offset, VkDeviceSize size);
-	void mergeFreeAreas(std::vector<MemoryRange>& gapsOffsetSorted, std::vector<MemoryRange>& gapsSizeSorted);
+		// The returned allocation range includes the margin needed to align the usable range, and must be passed to
+		// free() once the allocation isn't used anymore.
+		std::optional<RangeAllocationResult> allocate(VkDeviceSize alignment, VkDeviceSize size);
+		void free(VkDeviceSize offset, VkDeviceSize size);
+
+		// The size of the largest free range. Allocations with this size are guaranteed to succeed if they don't
+		// need any alignment margin.
+		VkDeviceSize maxAllocatableSize() const;
+		VkDeviceSize freeSize() const { return m_freeSize; }
+		size_t freeRangeCount() const { return m_offsetSortedRanges.size(); }
+
+		const std::map<VkDeviceSize, VkDeviceSize>& offsetSortedRanges() const { return m_offsetSortedRanges; }
+
+	  private:
+		// How many free ranges to consider for best-fit before falling back to the smallest range that fits
+		// regardless of alignment. Bounds the allocation time for ranges that are too small due to alignment.
+		static constexpr size_t m_maxBestFitCandidates = 8;
+
+		struct SizeComparator {
+			bool operator()(const MemoryRange& one, const MemoryRange& other) const {
+				return one.size < other.size || (one.size == other.size && one.offset < other.offset);
+			}
+		};
+
+		void insertRange(VkDeviceSize offset, VkDeviceSize size);
+		void eraseRange(std::map<VkDeviceSize, VkDeviceSize>::iterator offsetIterator);
+
+		// offset -> size
+		std::map<VkDeviceSize, VkDeviceSize> m_offsetSortedRanges;
+		std::set<MemoryRange, SizeComparator> m_sizeSortedRanges;
+		VkDeviceSize m_freeSize = 0;
+	};
 } // namespace vanadium::graphics
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace vanadium::graphics {
+
+	// A range of framegraph nodes that is recorded into one primary command buffer
+	struct RecordingSegment {
+		size_t firstNodeIndex;
+		size_t nodeCount;
+		// Recorded on a worker thread instead of the thread recording the frame
+		bool isParallel;
+	};
+
+	// Splits the nodes into segments. Every node recording in parallel gets a segment of its own, consecutive other
+	// nodes share one. Submitting the segments' command buffers in order executes the nodes in order.
+	// At least one segment is returned, so commands at the start and end of the frame always have a command buffer.
+	std::vector<RecordingSegment> planRecordingSegments(const std::vector<bool>& recordsInParallel);
+} // namespace vanadium::graphics
@@ -0,0 +1,81 @@
+#pragma once
+
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace vanadium::graphics {
+
+	// Resource identifiers only need to be unique across all resources of the graph
+	struct RasterAttachmentUsage {
+		uint64_t resource;
+		VkFormat format;
+		VkSampleCountFlagBits sampleCount;
+		VkAttachmentLoadOp loadOp;
+		VkAttachmentStoreOp storeOp;
+		// Layout while the node renders
+		VkImageLayout layout;
+	};
+
+	struct RasterNodeUsage {
+		// Nodes that aren't raster nodes don't render with a render pass the framegraph begins
+		bool isRaster = false;
+		// Nodes recording on their own thread get a render pass of their own
+		bool canMerge = true;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		std::vector<RasterAttachmentUsage> colorAttachments;
+		std::optional<RasterAttachmentUsage> depthStencilAttachment;
+		// Read with subpassLoad. Attachments of earlier subpasses stay in tile memory, other input attachments are
+		// loaded when the render pass begins.
+		std::vector<RasterAttachmentUsage> inputAttachments;
+		// Resources accessed other than as attachments
+		std::vector<uint64_t> readResources;
+		std::vector<uint64_t> writtenResources;
+	};
+
+	// The load operation and initial layout come from the first subpass using the attachment, the store operation and
+	// final layout from the last one
+	struct MergedAttachment {
+		uint64_t resource;
+		VkFormat format;
+		VkSampleCountFlagBits sampleCount;
+		VkAttachmentLoadOp loadOp;
+		VkAttachmentStoreOp storeOp;
+		VkImageLayout initialLayout;
+		VkImageLayout finalLayout;
+	};
+
+	struct MergedSubpass {
+		size_t nodeIndex;
+		std::vector<VkAttachmentReference> colorAttachments;
+		VkAttachmentReference depthStencilAttachment = { .attachment = VK_ATTACHMENT_UNUSED,
+														 .layout = VK_IMAGE_LAYOUT_UNDEFINED };
+		std::vector<VkAttachmentReference> inputAttachments;
+		// Attachments used before and after this subpass, but not by it
+		std::vector<uint32_t> preserveAttachments;
+	};
+
+	struct MergedRenderPass {
+		uint32_t width;
+		uint32_t height;
+		std::vector<MergedAttachment> attachments;
+		// In node order
+		std::vector<MergedSubpass> subpasses;
+	};
+
+	// Plans one render pass for every raster node that isn't culled, in node order. A raster node becomes the next
+	// subpass of the previous node's render pass if
+	// - no node that isn't culled runs in between
+	// - both nodes can merge, and render with the same extent and sample count
+	// - it uses an attachment of the render pass, as attachment or input attachment
+	// - it doesn't clear attachments of the render pass
+	// - no resource it accesses other than as attachment is accessed by the render pass in a conflicting way, and its
+	//   new attachments aren't accessed by the render pass at all
+	// Dependencies between subpasses then only involve attachments, so subpass dependencies can replace barriers.
+	std::vector<MergedRenderPass> planRenderPassMerges(const std::vector<RasterNodeUsage>& nodes,
+													   const std::vector<bool>& isNodeCulled);
+} // namespace vanadium::graphics
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+namespace vanadium::graphics {
+
+	// Reference-counted objects identified by a structural key, so that identical objects are created once and shared
+	// by all users. Each acquire or add is balanced by one release, and the object is destroyed with its last
+	// reference. Values must be unique, like Vulkan handles, since objects are released by value.
+	template <typename Key, typename Value, typename Hash = std::hash<Key>> class SharedObjectTable {
+	  public:
+		// Adds a reference to the object with the key and returns it, or returns nothing if there is no such object
+		std::optional<Value> acquire(const Key& key) {
+			auto lock = std::unique_lock<std::mutex>(m_mutex);
+			auto iterator = m_entries.find(key);
+			if (iterator == m_entries.end()) {
+				return std::nullopt;
+			}
+			++iterator->second.referenceCount;
+			return iterator->second.value;
+		}
+
+		// Like acquire, but creates the object if there is none. Creation holds the lock, so it should be cheap.
+		template <typename F> Value acquireOrCreate(const Key& key, F&& create) {
+			auto lock = std::unique_lock<std::mutex>(m_mutex);
+			auto iterator = m_entries.find(key);
+			if (iterator == m_entries.end()) {
+				iterator = m_entries.emplace(key, Entry{ .value = create(), .referenceCount = 0 }).first;
+				m_keys[iterator->second.value] = &iterator->first;
+			}
+			++iterator->second.referenceCount;
+			return iterator->second.value;
+		}
+
+		// Adds an object created without holding the lock, with one reference. If another thread added an object with
+		// the same key meanwhile, the reference goes to that object instead, and value is passed to destroy.
+		template <typename F> Value add(const Key& key, Value value, F&& destroy) {
+			auto lock = std::unique_lock<std::mutex>(m_mutex);
+			auto [iterator, wasInserted] = m_entries.emplace(key, Entry{ .value = value, .referenceCount = 0 });
+			if (wasInserted) {
+				m_keys[value] = &iterator->first;
+			} else {
+				destroy(value);
+			}
+			++iterator->second.referenceCount;
+			return iterator->second.value;
+		}
+
+		// Removes a reference and destroys the object if it was the last one. Returns whether the object was
+		// destroyed, values that aren't in the table are ignored.
+		template <typename F> bool release(const Value& value, F&& destroy) {
+			auto lock = std::unique_lock<std::mutex>(m_mutex);
+			auto keyIterator = m_keys.find(value);
+			if (keyIterator == m_keys.end()) {
+				return false;
+			}
+			auto iterator = m_entries.find(*keyIterator->second);
+			if (--iterator->second.referenceCount > 0) {
+				return false;
+			}
+			destroy(iterator->second.value);
+			m_keys.erase(keyIterator);
+			m_entries.erase(iterator);
+			return true;
+		}
+
+		uint32_t referenceCount(const Value& value) const {
+			auto lock = std::unique_lock<std::mutex>(m_mutex);
+			auto keyIterator = m_keys.find(value);
+			return keyIterator == m_keys.end() ? 0 : m_entries.find(*keyIterator->second)->second.referenceCount;
+		}
+
+		// Number of distinct objects
+		size_t size() const {
+			auto lock = std::unique_lock<std::mutex>(m_mutex);
+			return m_entries.size();
+		}
+
+		// Destroys all objects, regardless of their references
+		template <typename F> void clear(F&& destroy) {
+			auto lock = std::unique_lock<std::mutex>(m_mutex);
+			for (auto& [key, entry] : m_entries) {
+				destroy(entry.value);
+			}
+			m_entries.clear();
+			m_keys.clear();
+		}
+
+	  private:
+		struct Entry {
+			Value value;
+			uint32_t referenceCount;
+		};
+
+		mutable std::mutex m_mutex;
+		std::unordered_map<Key, Entry, Hash> m_entries;
+		// Keys of unordered_map elements keep their address when the map is rehashed
+		std::unordered_map<Value, const Key*> m_keys;
+	};
+} // namespace vanadium::graphics
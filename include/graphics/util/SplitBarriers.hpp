@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <graphics/util/QueueScheduling.hpp>
+
+namespace vanadium::graphics {
+
+	// A barrier between the node writing a resource and the first node using the result
+	struct SplitBarrierCandidate {
+		size_t srcNodeIndex;
+		size_t dstNodeIndex;
+	};
+
+	// Returns true for every barrier that should be split into an event set after the source node and a wait before
+	// the destination node, so the nodes in between don't wait for the source. Barriers are split if at least
+	// minIndependentNodeCount nodes that aren't culled run in between. All nodes from the source to the destination
+	// have to be on the same queue, so the event is set and waited for within one submission.
+	std::vector<bool> selectSplitBarriers(const std::vector<SplitBarrierCandidate>& candidates,
+										  const std::vector<FramegraphQueue>& nodeQueues,
+										  const std::vector<bool>& isNodeCulled, size_t minIndependentNodeCount);
+} // namespace vanadium::graphics
@@ -0,0 +1,87 @@
+#pragma once
+
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+#include <deque>
+#include <vector>
+
+namespace vanadium::graphics {
+
+	struct StagingRingAllocation {
+		// Index of the ring segment the allocation was placed in. Segments with allocations in flight aren't released,
+		// so the index stays valid until the allocation is reclaimed.
+		uint32_t segmentIndex;
+		VkDeviceSize offset;
+	};
+
+	// Hands out staging memory for uploads that are consumed by one frame's transfer commands.
+	// Allocations are bump-allocated from ring segments and cannot be freed individually. Instead, all allocations
+	// made before a call to closeFrame are reclaimed together once the completion value passed to closeFrame is
+	// reached. Completion values form a timeline that must increase with every closed frame, e.g. a frame counter
+	// or the value of a timeline semaphore.
+	// If no segment has enough space left, a new segment is added, so the ring grows to the peak amount of staging
+	// memory that is in flight at once. Segments that are empty again can be released with releaseIdleSegments. The
+	// ring only manages offsets, the memory backing the segments is owned by the user.
+	class StagingRing {
+	  public:
+		StagingRing() {}
+		explicit StagingRing(VkDeviceSize segmentSize);
+
+		// Allocations larger than the segment size get a new segment of their own size.
+		StagingRingAllocation allocate(VkDeviceSize size, VkDeviceSize alignment);
+
+		// Ends the current frame. Its allocations are reclaimed by a call to reclaim with completedValue >= value.
+		void closeFrame(uint64_t completionValue);
+		// Reclaims the allocations of all closed frames whose completion value is <= completedValue.
+		void reclaim(uint64_t completedValue);
+		// Releases empty segments that are larger than the segment size, and empty segments that weren't allocated
+		// from in the last maxIdleFrames closed frames. One segment of the regular size is always kept. Returns the
+		// indices of the released segments, whose memory can be freed. New segments reuse released indices.
+		std::vector<uint32_t> releaseIdleSegments(uint64_t maxIdleFrames);
+
+		// Includes released segments
+		size_t segmentCount() const { return m_segments.size(); }
+		bool isSegmentReleased(uint32_t segmentIndex) const { return m_segments[segmentIndex].isReleased; }
+		VkDeviceSize segmentSize(uint32_t segmentIndex) const { return m_segments[segmentIndex].size; }
+		// Bytes that can't be allocated in a segment until frames are reclaimed, including alignment and wrap-around
+		// padding.
+		VkDeviceSize usedSize(uint32_t segmentIndex) const { return m_segments[segmentIndex].usedSize; }
+		size_t pendingFrameCount() const { return m_pendingFrames.size(); }
+
+	  private:
+		struct Segment {
+			VkDeviceSize size;
+			// Offset where the next allocation starts
+			VkDeviceSize head = 0;
+			// Start of the oldest allocation that wasn't reclaimed yet
+			VkDeviceSize tail = 0;
+			VkDeviceSize usedSize = 0;
+			// Number of closed frames when the segment was last allocated from
+			uint64_t lastUsedFrame = 0;
+			bool isReleased = false;
+		};
+
+		struct SegmentUsage {
+			uint32_t segmentIndex;
+			VkDeviceSize usedSize;
+			// The segment's head at the time the frame was closed, becomes the new tail once the frame is reclaimed
+			VkDeviceSize head;
+		};
+
+		struct PendingFrame {
+			uint64_t completionValue;
+			std::vector<SegmentUsage> segmentUsages;
+		};
+
+		bool tryAllocate(uint32_t segmentIndex, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+
+		VkDeviceSize m_segmentSize = 0;
+		std::vector<Segment> m_segments;
+
+		// Bytes used in each segment by the frame that isn't closed yet
+		std::vector<VkDeviceSize> m_currentFrameUsedSizes;
+		// Sorted by completion value, oldest frame first
+		std::deque<PendingFrame> m_pendingFrames;
+		uint64_t m_closedFrameCount = 0;
+	};
+} // namespace vanadium::graphics
@@ -0,0 +1,51 @@
+#pragma once
+
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+#include <graphics/util/RangeAllocator.hpp>
+#include <vector>
+
+namespace vanadium::graphics {
+
+	struct BufferCopyRequest {
+		VkBuffer srcBuffer;
+		VkBuffer dstBuffer;
+		VkBufferCopy region;
+
+		VkPipelineStageFlags dstUsageStageFlags;
+		VkAccessFlags dstUsageAccessFlags;
+	};
+
+	// All regions copied from one buffer to another, recorded with a single vkCmdCopyBuffer
+	struct BufferCopyBatch {
+		VkBuffer srcBuffer;
+		VkBuffer dstBuffer;
+		std::vector<VkBufferCopy> regions;
+	};
+
+	struct BufferCopyPlan {
+		std::vector<BufferCopyBatch> copies;
+		// One barrier per destination buffer, covering all ranges copied to it
+		std::vector<VkBufferMemoryBarrier> barriers;
+		// Usage stages of all destination buffers, the destination stage mask for barriers
+		VkPipelineStageFlags dstStageFlags = 0;
+	};
+
+	// Merges copy requests into one multi-region copy per source/destination buffer pair. Adjacent regions are
+	// merged into one region, and if requests write overlapping destination ranges, the later one wins.
+	// Batches and barriers are ordered by the first request that uses them, regions are sorted by destination offset.
+	BufferCopyPlan planBufferCopies(const std::vector<BufferCopyRequest>& requests);
+
+	// Adds a range to a list of disjoint ranges sorted by offset, merging it with overlapping or adjacent ranges.
+	void addDirtyRange(std::vector<MemoryRange>& ranges, MemoryRange newRange);
+
+	struct ImageTransferSourceScope {
+		VkPipelineStageFlags stageFlags;
+		VkAccessFlags accessFlags;
+	};
+
+	// The source scope of the barrier transitioning an image from srcLayout to the transfer destination layout.
+	// Images in the undefined layout have no contents to preserve, so the transition doesn't need to wait for any
+	// previous commands.
+	ImageTransferSourceScope imageTransferSourceScope(VkImageLayout srcLayout);
+} // namespace vanadium::graphics
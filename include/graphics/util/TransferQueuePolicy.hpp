@@ -0,0 +1,46 @@
+#pragma once
+
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+#include <util/MemoryLiterals.hpp>
+
+namespace vanadium::graphics {
+
+	enum class UploadQueue { Graphics, Transfer };
+
+	struct TransferQueueCapabilities {
+		// The transfer queue is in a different queue family than the graphics queue, so it can run in parallel
+		bool hasDedicatedTransferQueue;
+		// The graphics submission waits for transfer queue uploads with a timeline semaphore
+		bool timelineSemaphores;
+	};
+
+	struct UploadDescription {
+		VkDeviceSize size;
+		// The destination is read by frames that may still be executing on the graphics queue. Writing it from
+		// another queue would need to wait for these frames, which serializes both queues again.
+		bool isReadByFramesInFlight;
+	};
+
+	// Decides which queue executes an upload that is recorded with the per-frame transfers.
+	// Uploads on the transfer queue need a separate submission, a semaphore wait in the graphics submission and
+	// queue family ownership transfers, so only large uploads profit from running in parallel to rendering.
+	class TransferQueuePolicy {
+	  public:
+		static constexpr VkDeviceSize defaultMinTransferQueueUploadSize = 1_MiB;
+
+		TransferQueuePolicy() {}
+		TransferQueuePolicy(const TransferQueueCapabilities& capabilities,
+							VkDeviceSize minTransferQueueUploadSize = defaultMinTransferQueueUploadSize);
+
+		UploadQueue chooseQueue(const UploadDescription& upload) const;
+
+		bool canUseTransferQueue() const {
+			return m_capabilities.hasDedicatedTransferQueue && m_capabilities.timelineSemaphores;
+		}
+
+	  private:
+		TransferQueueCapabilities m_capabilities = {};
+		VkDeviceSize m_minTransferQueueUploadSize = defaultMinTransferQueueUploadSize;
+	};
+} // namespace vanadium::graphics
@@ -0,0 +1,56 @@
+#pragma once
+
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+#include <vector>
+
+namespace vanadium::graphics {
+
+	struct TransientResourceRequirements {
+		// The resource is in use from the first to the last node using it, both included
+		size_t firstNodeIndex;
+		size_t lastNodeIndex;
+
+		VkDeviceSize size;
+		VkDeviceSize alignment;
+		uint32_t memoryTypeBits;
+
+		bool operator==(const TransientResourceRequirements& other) const = default;
+	};
+
+	struct AliasingBlock {
+		VkDeviceSize size;
+		// Memory types all resources placed in the block can be bound to
+		uint32_t memoryTypeBits;
+	};
+
+	struct AliasedResourcePlacement {
+		uint32_t blockIndex;
+		VkDeviceSize offset;
+	};
+
+	// Two resources whose memory overlaps. previous is last used before next is first used, so the first use of next
+	// has to wait for the last use of previous.
+	struct AliasedResourcePair {
+		uint32_t previous;
+		uint32_t next;
+	};
+
+	struct TransientAliasingPlan {
+		std::vector<AliasingBlock> blocks;
+		// One placement per resource, in the order the resources were passed in
+		std::vector<AliasedResourcePlacement> placements;
+		std::vector<AliasedResourcePair> aliases;
+
+		// Memory needed if every resource had its own allocation
+		VkDeviceSize unaliasedSize = 0;
+		VkDeviceSize aliasedSize = 0;
+
+		VkDeviceSize savedSize() const { return unaliasedSize - aliasedSize; }
+	};
+
+	// Packs resources whose lifetimes don't overlap into shared memory blocks. Resources are placed from the largest
+	// to the smallest one, each at the lowest offset of the first compatible block where it doesn't overlap a resource
+	// that is in use at the same time. Resources that don't fit anywhere get a new block.
+	TransientAliasingPlan planTransientAliasing(const std::vector<TransientResourceRequirements>& resources);
+} // namespace vanadium::graphics
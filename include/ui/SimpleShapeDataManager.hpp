@@ -88,7 +88,7 @@ namespace vanadium::ui {
 	template <typename T> void SimpleShapeDataManager<T>::allocateBuffer(const graphics::RenderContext& context) {
 		++m_bufferRevisionCount;
 		m_shapeData.reserve(m_maxShapeDataCapacity);
-		m_shapeDataTransfer = context.transferManager->createTransfer(
+		m_shapeDataTransfer = context.transferManager->createSubAllocatedTransfer(
 			m_maxShapeDataCapacity * sizeof(T), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
 			VK_ACCESS_SHADER_READ_BIT);
 	}
@@ -156,13 +156,16 @@ namespace vanadium::ui {
 		if (m_lastDataUpdateFrameIndex == ~0U)
 			return;
 
-		context.transferManager->updateTransferData(m_shapeDataTransfer, frameIndex, m_shapeDataBuffer.data());
+		// Only the shapes that exist need to be uploaded, the rest of the capacity is unused
+		context.transferManager->updateTransferData(m_shapeDataTransfer, frameIndex, m_shapeDataBuffer.data(), 0,
+													m_shapeDataBuffer.size() * sizeof(T));
 
 		if (m_bufferRevisionCount > m_descriptorSetRevisionCount[frameIndex]) {
-			VkDescriptorBufferInfo bufferInfo = { .buffer = context.resourceAllocator->nativeBufferHandle(
-													  context.transferManager->dstBufferHandle(m_shapeDataTransfer)),
-												  .offset = 0,
-												  .range = VK_WHOLE_SIZE };
+			// The buffer may be sub-allocated from a larger one, so VK_WHOLE_SIZE can't be used
+			auto dstBuffer = context.transferManager->dstBufferHandle(m_shapeDataTransfer);
+			VkDescriptorBufferInfo bufferInfo = { .buffer = context.resourceAllocator->nativeBufferHandle(dstBuffer),
+												  .offset = context.resourceAllocator->bufferOffset(dstBuffer),
+												  .range = m_maxShapeDataCapacity * sizeof(T) };
 			VkWriteDescriptorSet writeDescriptorSet = { .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
 														.dstSet = m_shapeDataSets[frameIndex],
 														.dstBinding = 0,
@@ -0,0 +1,305 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <util/Slotmap.hpp>
+
+namespace vanadium {
+
+	/**
+	 *  \brief A slotmap whose elements can be looked up while other threads add or remove elements.
+	 *
+	 *  Handles have the same layout as handles of Slotmap. Elements are stored in fixed-size chunks that are never
+	 *  moved or freed before the slotmap is destroyed, so looking up an element is wait-free: it neither takes a lock
+	 *  nor retries. Adding, removing and iterating elements must be synchronized externally, only one thread may
+	 *  modify the slotmap at a time.
+	 *
+	 *  A lookup only returns consistent data if the element isn't removed or assigned to while it is being read,
+	 *  handles must not be used concurrently with removing their element.
+	 */
+	template <typename T, uint32_t ChunkSize = 1024, uint32_t MaxChunkCount = 1024> class ConcurrentSlotmap {
+		static_assert(ChunkSize > 0 && MaxChunkCount > 0);
+		static_assert(static_cast<uint64_t>(ChunkSize) * MaxChunkCount < ~0U, "Slot indices need to fit in 32 bits!");
+
+		struct Slot {
+			// Incremented when the element is removed, so handles to removed elements never match
+			std::atomic<uint32_t> generation = 0;
+			bool isOccupied = false;
+			uint32_t nextFreeSlot;
+			T element;
+		};
+
+		struct Chunk {
+			std::array<Slot, ChunkSize> slots;
+		};
+
+	  public:
+		class iterator {
+		  public:
+			using value_type = T;
+			using difference_type = ptrdiff_t;
+			using reference = T&;
+			using pointer = T*;
+
+			iterator() {}
+			iterator(ConcurrentSlotmap* slotmap, uint32_t slotIndex) : slotmap(slotmap), slotIndex(slotIndex) {}
+
+			iterator& operator++() {
+				slotIndex = slotmap->nextOccupiedSlot(slotIndex + 1);
+				return *this;
+			}
+			iterator operator++(int32_t) {
+				iterator returnValue = *this;
+				++*this;
+				return returnValue;
+			}
+
+			bool operator==(const iterator& other) const { return slotIndex == other.slotIndex; }
+			bool operator!=(const iterator& other) const { return slotIndex != other.slotIndex; }
+
+			reference operator*() const { return slotmap->slot(slotIndex).element; }
+			pointer operator->() const { return &slotmap->slot(slotIndex).element; }
+
+		  private:
+			friend class ConcurrentSlotmap;
+
+			ConcurrentSlotmap* slotmap = nullptr;
+			uint32_t slotIndex = 0;
+		};
+
+		ConcurrentSlotmap() {
+			for (auto& chunk : m_chunks) {
+				chunk.store(nullptr, std::memory_order_relaxed);
+			}
+		}
+		ConcurrentSlotmap(const ConcurrentSlotmap&) = delete;
+		ConcurrentSlotmap& operator=(const ConcurrentSlotmap&) = delete;
+		~ConcurrentSlotmap() {
+			for (auto& chunk : m_chunks) {
+				delete chunk.load(std::memory_order_relaxed);
+			}
+		}
+
+		/**
+		 * \brief Adds an element to the slotmap. Not threadsafe with respect to other modifications.
+		 *
+		 * \param newElement The element that should be added to the slotmap.
+		 * \returns The handle of the new element.
+		 */
+		inline SlotmapHandle addElement(const T& newElement);
+
+		/**
+		 * \brief Adds an element to the slotmap. Not threadsafe with respect to other modifications.
+		 *
+		 * \param newElement The element that should be added to the slotmap.
+		 * \returns The handle of the new element.
+		 */
+		inline SlotmapHandle addElement(T&& newElement);
+
+		/**
+		 * \brief Gets the element that belongs to the specified handle. Wait-free.
+		 *
+		 * \param handle The specified handle.
+		 * \returns The element belonging to the specified handle. If "handle" is invalid or refers to an element that
+		 * was removed, an assert will trigger
+		 */
+		inline T& elementAt(SlotmapHandle handle);
+
+		/**
+		 * \brief Gets the element that belongs to the specified handle. Wait-free.
+		 *
+		 * \param handle The specified handle.
+		 * \returns The element belonging to the specified handle. If "handle" is invalid or refers to an element that
+		 * was removed, an assert will trigger
+		 */
+		inline const T& elementAt(SlotmapHandle handle) const;
+
+		/**
+		 * \brief Checks whether a handle refers to an element that is currently part of the slotmap. Wait-free.
+		 *
+		 * \param handle The handle to check.
+		 * \returns false if the handle is invalid or its element was removed, true otherwise.
+		 */
+		inline bool contains(SlotmapHandle handle) const;
+
+		/**
+		 * \brief Removes the element specified by its handle. Not threadsafe with respect to other modifications.
+		 *
+		 * The element is replaced by a default-constructed one, so that resources it owns are released. If the
+		 * handle is invalid or its element was already removed, nothing happens.
+		 *
+		 * \param handle The handle of the element to remove.
+		 */
+		inline void removeElement(SlotmapHandle handle);
+
+		inline T& operator[](SlotmapHandle handle) { return elementAt(handle); }
+
+		inline const T& operator[](SlotmapHandle handle) const { return elementAt(handle); }
+
+		/**
+		 * \brief Removes all elements of the slotmap. Chunks are kept for later additions.
+		 *
+		 * All handles that were handed out before clearing become invalid.
+		 */
+		inline void clear();
+
+		/**
+		 * \brief Gets the number of elements in the slotmap.
+		 *
+		 * \returns The number of elements in the slotmap. 0 if there are none.
+		 */
+		inline size_t size() const { return m_size; }
+
+		/**
+		 * \returns An iterator of the first element. Iterating takes time proportional to the number of slots ever
+		 * used, not to the number of elements.
+		 */
+		inline iterator begin() { return iterator(this, nextOccupiedSlot(0)); }
+
+		/**
+		 * \returns An iterator of the end of the elements.
+		 */
+		inline iterator end() { return iterator(this, m_slotCount); }
+
+		/**
+		 * \returns The handle of the specified iterator.
+		 */
+		inline SlotmapHandle handle(const iterator& handleIterator) const;
+
+	  private:
+		static constexpr uint32_t m_invalidIndex = ~0U;
+
+		static constexpr uint32_t slotIndex(SlotmapHandle handle) { return static_cast<uint32_t>(handle); }
+		static constexpr uint32_t slotGeneration(SlotmapHandle handle) { return static_cast<uint32_t>(handle >> 32); }
+		static constexpr SlotmapHandle makeHandle(uint32_t index, uint32_t generation) {
+			return static_cast<SlotmapHandle>(generation) << 32 | index;
+		}
+
+		inline Slot& slot(uint32_t index) const {
+			return m_chunks[index / ChunkSize].load(std::memory_order_acquire)->slots[index % ChunkSize];
+		}
+
+		inline uint32_t nextOccupiedSlot(uint32_t index) const;
+
+		// Takes a slot out of the free list or creates a new one, allocating a new chunk if necessary.
+		inline uint32_t occupySlot();
+
+		// Chunks are published with release semantics, so that readers on other threads see initialized slots
+		std::array<std::atomic<Chunk*>, MaxChunkCount> m_chunks;
+
+		// Number of slots that were ever used, all of them are in allocated chunks.
+		uint32_t m_slotCount = 0;
+		size_t m_size = 0;
+		// Free slots are reused in FIFO order, like in Slotmap
+		uint32_t m_freeSlotHead = m_invalidIndex;
+		uint32_t m_freeSlotTail = m_invalidIndex;
+	};
+
+	template <typename T, uint32_t ChunkSize, uint32_t MaxChunkCount>
+	inline uint32_t ConcurrentSlotmap<T, ChunkSize, MaxChunkCount>::occupySlot() {
+		uint32_t index;
+		if (m_freeSlotHead == m_invalidIndex) {
+			index = m_slotCount;
+			assert(index / ChunkSize < MaxChunkCount);
+			if (index % ChunkSize == 0) {
+				m_chunks[index / ChunkSize].store(new Chunk(), std::memory_order_release);
+			}
+			++m_slotCount;
+		} else {
+			index = m_freeSlotHead;
+			m_freeSlotHead = slot(index).nextFreeSlot;
+			if (m_freeSlotHead == m_invalidIndex)
+				m_freeSlotTail = m_invalidIndex;
+		}
+		slot(index).isOccupied = true;
+		++m_size;
+		return index;
+	}
+
+	template <typename T, uint32_t ChunkSize, uint32_t MaxChunkCount>
+	inline SlotmapHandle ConcurrentSlotmap<T, ChunkSize, MaxChunkCount>::addElement(const T& newElement) {
+		uint32_t index = occupySlot();
+		auto& newSlot = slot(index);
+		newSlot.element = newElement;
+		return makeHandle(index, newSlot.generation.load(std::memory_order_relaxed));
+	}
+
+	template <typename T, uint32_t ChunkSize, uint32_t MaxChunkCount>
+	inline SlotmapHandle ConcurrentSlotmap<T, ChunkSize, MaxChunkCount>::addElement(T&& newElement) {
+		uint32_t index = occupySlot();
+		auto& newSlot = slot(index);
+		newSlot.element = std::move(newElement);
+		return makeHandle(index, newSlot.generation.load(std::memory_order_relaxed));
+	}
+
+	template <typename T, uint32_t ChunkSize, uint32_t MaxChunkCount>
+	inline bool ConcurrentSlotmap<T, ChunkSize, MaxChunkCount>::contains(SlotmapHandle handle) const {
+		uint32_t index = slotIndex(handle);
+		if (index / ChunkSize >= MaxChunkCount)
+			return false;
+		Chunk* chunk = m_chunks[index / ChunkSize].load(std::memory_order_acquire);
+		// Generations of free slots are always incremented on removal, so they can never match a handed-out handle.
+		return chunk &&
+			   chunk->slots[index % ChunkSize].generation.load(std::memory_order_acquire) == slotGeneration(handle);
+	}
+
+	template <typename T, uint32_t ChunkSize, uint32_t MaxChunkCount>
+	inline T& ConcurrentSlotmap<T, ChunkSize, MaxChunkCount>::elementAt(SlotmapHandle handle) {
+		assert(contains(handle));
+		return slot(slotIndex(handle)).element;
+	}
+
+	template <typename T, uint32_t ChunkSize, uint32_t MaxChunkCount>
+	inline const T& ConcurrentSlotmap<T, ChunkSize, MaxChunkCount>::elementAt(SlotmapHandle handle) const {
+		assert(contains(handle));
+		return slot(slotIndex(handle)).element;
+	}
+
+	template <typename T, uint32_t ChunkSize, uint32_t MaxChunkCount>
+	inline void ConcurrentSlotmap<T, ChunkSize, MaxChunkCount>::removeElement(SlotmapHandle handle) {
+		if (!contains(handle))
+			return;
+
+		uint32_t index = slotIndex(handle);
+		auto& removedSlot = slot(index);
+		removedSlot.generation.fetch_add(1, std::memory_order_release);
+		removedSlot.isOccupied = false;
+		removedSlot.element = T();
+		--m_size;
+
+		removedSlot.nextFreeSlot = m_invalidIndex;
+		if (m_freeSlotTail == m_invalidIndex) {
+			m_freeSlotHead = index;
+		} else {
+			slot(m_freeSlotTail).nextFreeSlot = index;
+		}
+		m_freeSlotTail = index;
+	}
+
+	template <typename T, uint32_t ChunkSize, uint32_t MaxChunkCount>
+	inline void ConcurrentSlotmap<T, ChunkSize, MaxChunkCount>::clear() {
+		for (uint32_t i = 0; i < m_slotCount; ++i) {
+			auto& currentSlot = slot(i);
+			if (currentSlot.isOccupied) {
+				removeElement(makeHandle(i, currentSlot.generation.load(std::memory_order_relaxed)));
+			}
+		}
+	}
+
+	template <typename T, uint32_t ChunkSize, uint32_t MaxChunkCount>
+	inline SlotmapHandle ConcurrentSlotmap<T, ChunkSize, MaxChunkCount>::handle(const iterator& handleIterator) const {
+		return makeHandle(handleIterator.slotIndex,
+						  slot(handleIterator.slotIndex).generation.load(std::memory_order_relaxed));
+	}
+
+	template <typename T, uint32_t ChunkSize, uint32_t MaxChunkCount>
+	inline uint32_t ConcurrentSlotmap<T, ChunkSize, MaxChunkCount>::nextOccupiedSlot(uint32_t index) const {
+		while (index < m_slotCount && !slot(index).isOccupied) {
+			++index;
+		}
+		return index;
+	}
+
+} // namespace vanadium
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vanadium {
+
+	/**
+	 *  \brief A read-only view of a whole file, backed by the page cache instead of a copy.
+	 *
+	 *  The mapping starts at a page boundary, so data aligned within the file is aligned in memory as well. Pages are
+	 *  only read from disk when they are first accessed.
+	 */
+	class MappedFile {
+	  public:
+		MappedFile() {}
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile() { close(); }
+
+		// Returns false if the file doesn't exist or can't be mapped. Empty files can't be mapped.
+		bool open(const char* name) {
+			close();
+#ifdef _WIN32
+			m_file = CreateFileA(name, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+								 nullptr);
+			if (m_file == INVALID_HANDLE_VALUE) {
+				return false;
+			}
+			LARGE_INTEGER fileSize;
+			if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart == 0) {
+				close();
+				return false;
+			}
+			m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (!m_mapping) {
+				close();
+				return false;
+			}
+			m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+			if (!m_data) {
+				close();
+				return false;
+			}
+			m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+			int file = ::open(name, O_RDONLY);
+			if (file == -1) {
+				return false;
+			}
+			struct stat fileStatus;
+			if (fstat(file, &fileStatus) == -1 || fileStatus.st_size == 0) {
+				::close(file);
+				return false;
+			}
+			void* data = mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+			// The mapping keeps its own reference to the file
+			::close(file);
+			if (data == MAP_FAILED) {
+				return false;
+			}
+			m_data = static_cast<const char*>(data);
+			m_size = static_cast<size_t>(fileStatus.st_size);
+#endif
+			return true;
+		}
+
+		void close() {
+#ifdef _WIN32
+			if (m_data) {
+				UnmapViewOfFile(m_data);
+			}
+			if (m_mapping) {
+				CloseHandle(m_mapping);
+			}
+			if (m_file != INVALID_HANDLE_VALUE) {
+				CloseHandle(m_file);
+			}
+			m_mapping = nullptr;
+			m_file = INVALID_HANDLE_VALUE;
+#else
+			if (m_data) {
+				munmap(const_cast<char*>(m_data), m_size);
+			}
+#endif
+			m_data = nullptr;
+			m_size = 0;
+		}
+
+		bool isOpen() const { return m_data != nullptr; }
+		const char* data() const { return m_data; }
+		size_t size() const { return m_size; }
+
+	  private:
+		const char* m_data = nullptr;
+		size_t m_size = 0;
+#ifdef _WIN32
+		HANDLE m_file = INVALID_HANDLE_VALUE;
+		HANDLE m_mapping = nullptr;
+#endif
+	};
+
+} // namespace vanadium
@@ -2,15 +2,24 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <iterator>
 #include <vector>
 
 namespace vanadium {
 
+	// The lower 32 bits of a handle contain the slot index, the upper 32 bits contain the generation of the slot at
+	// the time the handle was created. Removing an element increments the generation of its slot, so handles to
+	// removed elements never alias elements that are added into the same slot later.
 	using SlotmapHandle = size_t;
+	static_assert(sizeof(SlotmapHandle) >= sizeof(uint64_t), "SlotmapHandle needs to be able to hold 64 bits!");
 
 	/**
 	 *  \brief A slotmap memory structure whose elements can be accessed by unique identifiers.
+	 *
+	 *  Elements are stored contiguously. Adding, removing and looking up elements are O(1) operations. Removing an
+	 *  element moves the last element into its place, so iterators and pointers to elements are invalidated by
+	 *  removals.
 	 */
 	template <typename T> class Slotmap {
 	  public:
@@ -166,7 +175,8 @@ namespace vanadium {
 		 * \brief Gets the element that belongs to the specified handle.
 		 *
 		 * \param handle The specified handle.
-		 * \returns The element belonging to the specified handle. If "handle" is invalid, an assert will trigger
+		 * \returns The element belonging to the specified handle. If "handle" is invalid or refers to an element that
+		 * was removed, an assert will trigger
 		 */
 		inline T& elementAt(SlotmapHandle handle);
 
@@ -174,14 +184,24 @@ namespace vanadium {
 		 * \brief Gets the element that belongs to the specified handle.
 		 *
 		 * \param handle The specified handle.
-		 * \returns The element belonging to the specified handle. If "handle" is invalid, an assert will trigger
+		 * \returns The element belonging to the specified handle. If "handle" is invalid or refers to an element that
+		 * was removed, an assert will trigger
 		 */
 		inline const T& elementAt(SlotmapHandle handle) const;
 
+		/**
+		 * \brief Checks whether a handle refers to an element that is currently part of the slotmap.
+		 *
+		 * \param handle The handle to check.
+		 * \returns false if the handle is invalid or its element was removed, true otherwise.
+		 */
+		inline bool contains(SlotmapHandle handle) const;
+
 		/**
 		 * \brief Removes the element specified by its handle.
 		 *
-		 * Removes the element specified by its handle. If the handle is invalid, nothing happens.
+		 * Removes the element specified by its handle. If the handle is invalid or its element was already removed,
+		 * nothing happens.
 		 *
 		 * \param handle The handle of the element to remove.
 		 */
@@ -193,9 +213,26 @@ namespace vanadium {
 
 		/**
 		 * \brief Wipes all elements of the slotmap.
+		 *
+		 * All handles that were handed out before clearing become invalid.
 		 */
 		inline void clear();
 
+		/**
+		 * \brief Reserves storage for the specified number of elements, so that adding elements up to that number
+		 * does not need to reallocate.
+		 *
+		 * \param capacity The number of elements to reserve storage for.
+		 */
+		inline void reserve(size_t capacity);
+
+		/**
+		 * \brief Releases storage of elements that is not in use anymore.
+		 *
+		 * Slots are kept alive to preserve their generations, only their unused capacity is released.
+		 */
+		inline void shrinkToFit();
+
 		/**
 		 * \brief Gets the number of elements in the slotmap.
 		 *
@@ -203,6 +240,11 @@ namespace vanadium {
 		 */
 		inline size_t size() const;
 
+		/**
+		 * \returns The number of elements the slotmap can hold without reallocating.
+		 */
+		inline size_t capacity() const;
+
 		/**
 		 * \returns An iterator of the begin of the elements.
 		 */
@@ -224,12 +266,14 @@ namespace vanadium {
 		inline const_iterator cend() const;
 
 		/**
-		 * \returns An iterator of the element with the specified handle.
+		 * \returns An iterator of the element with the specified handle, or end() if the handle is invalid or its
+		 * element was removed.
 		 */
 		inline iterator find(SlotmapHandle handle);
 
 		/**
-		 * \returns An iterator of the element with the specified handle.
+		 * \returns An iterator of the element with the specified handle, or cend() if the handle is invalid or its
+		 * element was removed.
 		 */
 		inline const_iterator find(SlotmapHandle handle) const;
 
@@ -239,92 +283,104 @@ namespace vanadium {
 		inline SlotmapHandle handle(const iterator& handleIterator);
 
 	  private:
-		// All elements.
-		std::vector<T> elements;
-		std::vector<size_t> keys;
-		std::vector<size_t> eraseMap;
-		size_t freeKeyHead = 0;
-		size_t freeKeyTail = 0;
-	};
+		static constexpr uint32_t m_invalidIndex = ~0U;
 
-	template <typename T> inline SlotmapHandle Slotmap<T>::addElement(const T& newElement) {
-		if (keys.size() == 0)
-			keys.push_back(0);
-		elements.push_back(newElement);
-		eraseMap.push_back(freeKeyHead);
-		if (freeKeyHead == freeKeyTail) {
-			size_t newFreeSlotIndex = keys.size();
-
-			keys.push_back(newFreeSlotIndex);
+		struct Slot {
+			// If the slot is occupied, the index of the element. Otherwise, the index of the next free slot.
+			uint32_t index;
+			uint32_t generation;
+		};
 
-			keys[freeKeyTail] = newFreeSlotIndex;
-			freeKeyTail = newFreeSlotIndex;
+		static constexpr uint32_t slotIndex(SlotmapHandle handle) { return static_cast<uint32_t>(handle); }
+		static constexpr uint32_t slotGeneration(SlotmapHandle handle) { return static_cast<uint32_t>(handle >> 32); }
+		static constexpr SlotmapHandle makeHandle(uint32_t index, uint32_t generation) {
+			return static_cast<SlotmapHandle>(generation) << 32 | index;
 		}
-		size_t nextFreeIndex = keys[freeKeyHead];
-
-		keys[freeKeyHead] = elements.size() - 1;
-
-		size_t returnIndex = freeKeyHead;
-		freeKeyHead = nextFreeIndex;
-
-		return returnIndex;
-	}
 
-	template <typename T> inline SlotmapHandle Slotmap<T>::addElement(T&& newElement) {
-		if (keys.size() == 0)
-			keys.push_back(0);
-		elements.push_back(std::forward<T>(newElement));
-		eraseMap.push_back(freeKeyHead);
-		if (freeKeyHead == freeKeyTail) {
-			size_t newFreeSlotIndex = keys.size();
+		// Takes a slot out of the free list (or creates a new one) and makes it refer to the last element.
+		inline SlotmapHandle occupySlotForLastElement();
 
-			keys.push_back(newFreeSlotIndex);
+		// All elements.
+		std::vector<T> elements;
+		// Slot index for each element, used to update slots when elements are moved around.
+		std::vector<uint32_t> eraseMap;
+		std::vector<Slot> slots;
+		// Free slots are reused in FIFO order, so a slot's generation takes as long as possible to be reused.
+		uint32_t freeSlotHead = m_invalidIndex;
+		uint32_t freeSlotTail = m_invalidIndex;
+	};
 
-			keys[freeKeyTail] = newFreeSlotIndex;
-			freeKeyTail = newFreeSlotIndex;
+	template <typename T> inline SlotmapHandle Slotmap<T>::occupySlotForLastElement() {
+		uint32_t elementIndex = static_cast<uint32_t>(elements.size() - 1);
+		uint32_t newSlotIndex;
+		if (freeSlotHead == m_invalidIndex) {
+			newSlotIndex = static_cast<uint32_t>(slots.size());
+			assert(newSlotIndex != m_invalidIndex);
+			slots.push_back({ .index = elementIndex, .generation = 0 });
+		} else {
+			newSlotIndex = freeSlotHead;
+			freeSlotHead = slots[newSlotIndex].index;
+			if (freeSlotHead == m_invalidIndex)
+				freeSlotTail = m_invalidIndex;
+			slots[newSlotIndex].index = elementIndex;
 		}
-		size_t nextFreeIndex = keys[freeKeyHead];
+		eraseMap.push_back(newSlotIndex);
+		return makeHandle(newSlotIndex, slots[newSlotIndex].generation);
+	}
 
-		keys[freeKeyHead] = elements.size() - 1;
+	template <typename T> inline SlotmapHandle Slotmap<T>::addElement(const T& newElement) {
+		elements.push_back(newElement);
+		return occupySlotForLastElement();
+	}
 
-		size_t returnIndex = freeKeyHead;
-		freeKeyHead = nextFreeIndex;
+	template <typename T> inline SlotmapHandle Slotmap<T>::addElement(T&& newElement) {
+		elements.push_back(std::move(newElement));
+		return occupySlotForLastElement();
+	}
 
-		return returnIndex;
+	template <typename T> inline bool Slotmap<T>::contains(SlotmapHandle handle) const {
+		uint32_t index = slotIndex(handle);
+		// Generations of free slots are always incremented on removal, so they can never match a handed-out handle.
+		return index < slots.size() && slots[index].generation == slotGeneration(handle);
 	}
 
 	template <typename T> inline T& Slotmap<T>::elementAt(SlotmapHandle handle) {
-		assert(keys.size() > handle);
-		assert(eraseMap[keys[handle]] == handle);
-		return elements[keys[handle]];
+		assert(contains(handle));
+		return elements[slots[slotIndex(handle)].index];
 	}
 
 	template <typename T> inline const T& Slotmap<T>::elementAt(SlotmapHandle handle) const {
-		assert(keys.size() > handle);
-		assert(eraseMap[keys[handle]] == handle);
-		return elements[keys[handle]];
+		assert(contains(handle));
+		return elements[slots[slotIndex(handle)].index];
 	}
 
 	template <typename T> inline void Slotmap<T>::removeElement(SlotmapHandle handle) {
-		assert(keys.size() > handle);
-
-		size_t eraseElementIndex = keys[handle];
-
-		// Move last element in, update erase table
-		elements[eraseElementIndex] = std::move(elements[elements.size() - 1]);
-		eraseMap[eraseElementIndex] = eraseMap[elements.size() - 1];
-
-		// Update key index of what was the last element
-		keys[eraseMap[eraseElementIndex]] = eraseElementIndex;
-
-		// Update erase table/element std::vector sizes
-		elements.erase(elements.begin() + (elements.size() - 1));
-		eraseMap.erase(eraseMap.begin() + (eraseMap.size() - 1));
-
-		// Update free list nodes
-		keys[freeKeyTail] = handle;
-		keys[handle] = handle;
-		freeKeyTail = handle;
+		if (!contains(handle))
+			return;
+
+		uint32_t removedSlotIndex = slotIndex(handle);
+		uint32_t eraseElementIndex = slots[removedSlotIndex].index;
+		uint32_t lastElementIndex = static_cast<uint32_t>(elements.size() - 1);
+
+		// Move last element in, update erase table and the slot of what was the last element
+		if (eraseElementIndex != lastElementIndex) {
+			elements[eraseElementIndex] = std::move(elements[lastElementIndex]);
+			eraseMap[eraseElementIndex] = eraseMap[lastElementIndex];
+			slots[eraseMap[eraseElementIndex]].index = eraseElementIndex;
+		}
+		elements.pop_back();
+		eraseMap.pop_back();
+
+		// Invalidate all handles to the removed element and append the slot to the free list
+		auto& removedSlot = slots[removedSlotIndex];
+		++removedSlot.generation;
+		removedSlot.index = m_invalidIndex;
+		if (freeSlotTail == m_invalidIndex) {
+			freeSlotHead = removedSlotIndex;
+		} else {
+			slots[freeSlotTail].index = removedSlotIndex;
+		}
+		freeSlotTail = removedSlotIndex;
 	}
 
 	template <typename T> inline T& Slotmap<T>::operator[](SlotmapHandle handle) { return elementAt(handle); }
@@ -334,15 +390,35 @@ namespace vanadium {
 	}
 
 	template <typename T> inline void Slotmap<T>::clear() {
+		for (auto slot : eraseMap) {
+			++slots[slot].generation;
+		}
 		elements.clear();
-		keys.clear();
 		eraseMap.clear();
-		freeKeyHead = 0;
-		freeKeyTail = 0;
+
+		freeSlotHead = slots.empty() ? m_invalidIndex : 0;
+		freeSlotTail = slots.empty() ? m_invalidIndex : static_cast<uint32_t>(slots.size() - 1);
+		for (uint32_t i = 0; i < slots.size(); ++i) {
+			slots[i].index = i + 1 < slots.size() ? i + 1 : m_invalidIndex;
+		}
+	}
+
+	template <typename T> inline void Slotmap<T>::reserve(size_t capacity) {
+		elements.reserve(capacity);
+		eraseMap.reserve(capacity);
+		slots.reserve(capacity);
+	}
+
+	template <typename T> inline void Slotmap<T>::shrinkToFit() {
+		elements.shrink_to_fit();
+		eraseMap.shrink_to_fit();
+		slots.shrink_to_fit();
 	}
 
 	template <typename T> inline size_t Slotmap<T>::size() const { return elements.size(); }
 
+	template <typename T> inline size_t Slotmap<T>::capacity() const { return elements.capacity(); }
+
 	template <typename T> inline typename Slotmap<T>::iterator Slotmap<T>::begin() { return iterator(elements.data()); }
 
 	template <typename T> inline typename Slotmap<T>::iterator Slotmap<T>::end() {
@@ -358,19 +434,20 @@ namespace vanadium {
 	}
 
 	template <typename T> inline typename Slotmap<T>::iterator Slotmap<T>::find(SlotmapHandle handle) {
-		if (handle >= keys.size())
+		if (!contains(handle))
 			return iterator(elements.data() + elements.size());
-		return iterator(elements.data() + keys[handle]);
+		return iterator(elements.data() + slots[slotIndex(handle)].index);
 	}
 
 	template <typename T> inline typename Slotmap<T>::const_iterator Slotmap<T>::find(SlotmapHandle handle) const {
-		if (handle >= keys.size())
+		if (!contains(handle))
 			return const_iterator(elements.data() + elements.size());
-		return const_iterator(elements.data() + keys[handle]);
+		return const_iterator(elements.data() + slots[slotIndex(handle)].index);
 	}
 
 	template <typename T> inline SlotmapHandle Slotmap<T>::handle(const Slotmap<T>::iterator& handleIterator) {
-		return { eraseMap[static_cast<T*>(handleIterator) - elements.data()] };
+		uint32_t index = eraseMap[static_cast<T*>(handleIterator) - elements.data()];
+		return makeHandle(index, slots[index].generation);
 	}
 
 } // namespace vanadium
\ No newline at end of file
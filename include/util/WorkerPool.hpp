@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vanadium {
+
+	/**
+	 *  \brief A fixed set of threads that run batches of indexed jobs.
+	 *
+	 *  dispatch starts a batch and returns immediately, so the calling thread can do other work until it calls wait.
+	 *  Each job receives the index of the worker thread running it, jobs running on the same thread never overlap.
+	 *  This allows jobs to use per-thread resources like command pools without locking. Only one batch can be in
+	 *  flight, and only one thread may dispatch and wait.
+	 */
+	class WorkerPool {
+	  public:
+		using Job = std::function<void(size_t jobIndex, uint32_t threadIndex)>;
+
+		WorkerPool() {}
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+		~WorkerPool() { destroy(); }
+
+		void create(uint32_t threadCount) {
+			for (uint32_t i = 0; i < threadCount; ++i) {
+				m_threads.emplace_back([this, i]() { workerLoop(i); });
+			}
+		}
+
+		uint32_t threadCount() const { return static_cast<uint32_t>(m_threads.size()); }
+
+		// Runs job for every index in [0, jobCount). Without worker threads, the jobs run on the calling thread with
+		// thread index 0.
+		void dispatch(size_t jobCount, Job job) {
+			if (m_threads.empty()) {
+				for (size_t i = 0; i < jobCount; ++i) {
+					job(i, 0);
+				}
+				return;
+			}
+			auto lock = std::unique_lock<std::mutex>(m_mutex);
+			m_job = std::move(job);
+			m_jobCount = jobCount;
+			m_nextJobIndex.store(0, std::memory_order_relaxed);
+			m_busyThreadCount = threadCount();
+			++m_batchIndex;
+			m_batchStartCondition.notify_all();
+		}
+
+		// Blocks until all jobs of the last batch finished
+		void wait() {
+			auto lock = std::unique_lock<std::mutex>(m_mutex);
+			m_batchFinishCondition.wait(lock, [this]() { return m_busyThreadCount == 0; });
+			m_job = {};
+		}
+
+		void destroy() {
+			{
+				auto lock = std::unique_lock<std::mutex>(m_mutex);
+				m_isStopping = true;
+				m_batchStartCondition.notify_all();
+			}
+			for (auto& thread : m_threads) {
+				thread.join();
+			}
+			m_threads.clear();
+			m_isStopping = false;
+		}
+
+	  private:
+		void workerLoop(uint32_t threadIndex) {
+			uint64_t lastBatchIndex = 0;
+			while (true) {
+				{
+					auto lock = std::unique_lock<std::mutex>(m_mutex);
+					m_batchStartCondition.wait(
+						lock, [this, lastBatchIndex]() { return m_isStopping || m_batchIndex != lastBatchIndex; });
+					if (m_isStopping) {
+						return;
+					}
+					lastBatchIndex = m_batchIndex;
+				}
+
+				size_t jobIndex;
+				while ((jobIndex = m_nextJobIndex.fetch_add(1, std::memory_order_relaxed)) < m_jobCount) {
+					m_job(jobIndex, threadIndex);
+				}
+
+				auto lock = std::unique_lock<std::mutex>(m_mutex);
+				if (--m_busyThreadCount == 0) {
+					m_batchFinishCondition.notify_one();
+				}
+			}
+		}
+
+		std::vector<std::thread> m_threads;
+
+		std::mutex m_mutex;
+		std::condition_variable m_batchStartCondition;
+		std::condition_variable m_batchFinishCondition;
+
+		// Written by the dispatching thread while holding m_mutex, workers read them after observing the new batch
+		Job m_job;
+		size_t m_jobCount = 0;
+		std::atomic<size_t> m_nextJobIndex = 0;
+		uint32_t m_busyThreadCount = 0;
+		uint64_t m_batchIndex = 0;
+		bool m_isStopping = false;
+	};
+
+} // namespace vanadium
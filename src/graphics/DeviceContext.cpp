@@ -1,5 +1,6 @@
 #include <Debug.hpp>
 #include <Log.hpp>
+#include <algorithm>
 #include <cstring>
 #include <graphics/DeviceContext.hpp>
 #include <graphics/helper/EnumerationHelper.hpp>
@@ -97,6 +98,7 @@ namespace vanadium::graphics {
 		uint32_t chosenGraphicsQueueFamilyIndex = -1U;
 
 		uint32_t chosenTransferQueueFamilyIndex = -1U;
+		uint32_t chosenComputeQueueFamilyIndex = -1U;
 		for (auto& device : physicalDevices) {
 			uint32_t propertyCount = 0;
 			vkGetPhysicalDeviceQueueFamilyProperties(device, &propertyCount, nullptr);
@@ -105,6 +107,7 @@ namespace vanadium::graphics {
 
 			uint32_t unrelatedGraphicsFlags = -1U;
 			uint32_t unrelatedTransferFlags = -1U;
+			uint32_t unrelatedComputeFlags = -1U;
 
 			uint32_t queueFamilyIndex = 0;
 			for (auto& properties : queueFamilyProperties) {
@@ -112,6 +115,8 @@ namespace vanadium::graphics {
 					std::popcount(properties.queueFlags & ~(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT));
 				uint32_t currentUnrelatedTransferFlags =
 					std::popcount(properties.queueFlags & ~(VK_QUEUE_TRANSFER_BIT));
+				uint32_t currentUnrelatedComputeFlags =
+					std::popcount(properties.queueFlags & ~(VK_QUEUE_COMPUTE_BIT));
 
 				if ((properties.queueFlags & VK_QUEUE_GRAPHICS_BIT) &&
 					windowSurface.supportsPresent(device, queueFamilyIndex) &&
@@ -124,6 +129,12 @@ namespace vanadium::graphics {
 					chosenTransferQueueFamilyIndex = queueFamilyIndex;
 					unrelatedTransferFlags = currentUnrelatedTransferFlags;
 				}
+				// Compute queues in the graphics family can't run in parallel to it on most hardware
+				if ((properties.queueFlags & VK_QUEUE_COMPUTE_BIT) &&
+					!(properties.queueFlags & VK_QUEUE_GRAPHICS_BIT) && currentUnrelatedComputeFlags < unrelatedComputeFlags) {
+					chosenComputeQueueFamilyIndex = queueFamilyIndex;
+					unrelatedComputeFlags = currentUnrelatedComputeFlags;
+				}
 
 				++queueFamilyIndex;
 			}
@@ -132,6 +143,9 @@ namespace vanadium::graphics {
 					(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) {
 					logWarning("DeviceContext: Didn't find a transfer-only queue family, using a general purpose one.");
 				}
+				if (chosenComputeQueueFamilyIndex == -1U) {
+					chosenComputeQueueFamilyIndex = chosenGraphicsQueueFamilyIndex;
+				}
 
 				chosenDevice = device;
 				break;
@@ -145,6 +159,8 @@ namespace vanadium::graphics {
 		m_physicalDevice = chosenDevice.value();
 
 		std::vector<const char*> deviceExtensionNames = { "VK_KHR_swapchain" };
+		bool hasMemoryRequirements2 = false;
+		bool hasDedicatedAllocation = false;
 
 		std::vector<VkExtensionProperties> availableDeviceExtensions =
 			enumerate<VkPhysicalDevice, VkExtensionProperties, const char*>(m_physicalDevice, nullptr,
@@ -159,22 +175,84 @@ namespace vanadium::graphics {
 				deviceExtensionNames.push_back(VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME);
 				m_capabilities.memoryPriority = true;
 			}
+			if (!strcmp(extension.extensionName, VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME)) {
+				hasMemoryRequirements2 = true;
+			}
+			if (!strcmp(extension.extensionName, VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME)) {
+				hasDedicatedAllocation = true;
+			}
+			if (!strcmp(extension.extensionName, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) {
+				deviceExtensionNames.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+				m_capabilities.timelineSemaphore = true;
+			}
+			if (!strcmp(extension.extensionName, VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME)) {
+				deviceExtensionNames.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+				m_capabilities.synchronization2 = true;
+			}
+		}
+		if (hasMemoryRequirements2 && hasDedicatedAllocation) {
+			deviceExtensionNames.push_back(VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME);
+			deviceExtensionNames.push_back(VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME);
+			m_capabilities.dedicatedAllocation = true;
 		}
 
+		// The extensions alone don't allow specifying priorities, creating timeline semaphores or recording
+		// synchronization2 barriers, the features have to be enabled as well
+		void* featureChain = nullptr;
+		VkPhysicalDeviceMemoryPriorityFeaturesEXT memoryPriorityFeatures = {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PRIORITY_FEATURES_EXT
+		};
+		VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures = {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR
+		};
+		VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features = {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR
+		};
+		if (m_capabilities.memoryPriority) {
+			memoryPriorityFeatures.pNext = featureChain;
+			featureChain = &memoryPriorityFeatures;
+		}
+		if (m_capabilities.timelineSemaphore) {
+			timelineSemaphoreFeatures.pNext = featureChain;
+			featureChain = &timelineSemaphoreFeatures;
+		}
+		if (m_capabilities.synchronization2) {
+			synchronization2Features.pNext = featureChain;
+			featureChain = &synchronization2Features;
+		}
+		if (featureChain && vkGetPhysicalDeviceFeatures2KHR) {
+			VkPhysicalDeviceFeatures2KHR features2 = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR,
+													   .pNext = featureChain };
+			vkGetPhysicalDeviceFeatures2KHR(m_physicalDevice, &features2);
+		}
+		m_capabilities.memoryPriority = memoryPriorityFeatures.memoryPriority;
+		m_capabilities.timelineSemaphore = timelineSemaphoreFeatures.timelineSemaphore;
+		m_capabilities.synchronization2 = synchronization2Features.synchronization2;
+
 		float graphicsPriority = 1.0f;
 		float transferPriority = 0.2f;
-		VkDeviceQueueCreateInfo queueCreateInfos[2] = { { .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-														  .queueFamilyIndex = chosenGraphicsQueueFamilyIndex,
-														  .queueCount = 1,
-														  .pQueuePriorities = &graphicsPriority },
-														{ .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-														  .queueFamilyIndex = chosenTransferQueueFamilyIndex,
-														  .queueCount = 1,
-														  .pQueuePriorities = &transferPriority } };
+		float computePriority = 1.0f;
+		// Queues in the same family share the first queue of the family
+		std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+		auto addQueueCreateInfo = [&queueCreateInfos](uint32_t queueFamilyIndex, const float* priority) {
+			if (std::none_of(queueCreateInfos.begin(), queueCreateInfos.end(), [queueFamilyIndex](const auto& info) {
+					return info.queueFamilyIndex == queueFamilyIndex;
+				})) {
+				queueCreateInfos.push_back({ .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+											 .queueFamilyIndex = queueFamilyIndex,
+											 .queueCount = 1,
+											 .pQueuePriorities = priority });
+			}
+		};
+		addQueueCreateInfo(chosenGraphicsQueueFamilyIndex, &graphicsPriority);
+		addQueueCreateInfo(chosenComputeQueueFamilyIndex, &computePriority);
+		addQueueCreateInfo(chosenTransferQueueFamilyIndex, &transferPriority);
 
 		VkDeviceCreateInfo deviceCreateInfo = { .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-												.queueCreateInfoCount = 2,
-												.pQueueCreateInfos = queueCreateInfos,
+												.pNext = featureChain,
+												.queueCreateInfoCount =
+													static_cast<uint32_t>(queueCreateInfos.size()),
+												.pQueueCreateInfos = queueCreateInfos.data(),
 												.enabledExtensionCount =
 													static_cast<uint32_t>(deviceExtensionNames.size()),
 												.ppEnabledExtensionNames = deviceExtensionNames.data() };
@@ -188,6 +266,8 @@ namespace vanadium::graphics {
 		m_graphicsQueueFamilyIndex = chosenGraphicsQueueFamilyIndex;
 		vkGetDeviceQueue(m_device, chosenTransferQueueFamilyIndex, 0, &m_asyncTransferQueue);
 		m_asyncTransferQueueFamilyIndex = chosenTransferQueueFamilyIndex;
+		vkGetDeviceQueue(m_device, chosenComputeQueueFamilyIndex, 0, &m_asyncComputeQueue);
+		m_asyncComputeQueueFamilyIndex = chosenComputeQueueFamilyIndex;
 
 		vkGetPhysicalDeviceProperties(m_physicalDevice, &m_properties);
 
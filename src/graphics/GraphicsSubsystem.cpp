@@ -1,8 +1,55 @@
+#include <algorithm>
 #include <graphics/GraphicsSubsystem.hpp>
 #include <volk.h>
 
 namespace vanadium::graphics {
 
+	namespace {
+		// Collects the semaphores of one vkQueueSubmit. Values of binary semaphores are ignored.
+		struct QueueSubmission {
+			std::vector<VkCommandBuffer> commandBuffers;
+			std::vector<VkSemaphore> waitSemaphores;
+			std::vector<VkPipelineStageFlags> waitStageFlags;
+			std::vector<uint64_t> waitValues;
+			std::vector<VkSemaphore> signalSemaphores;
+			std::vector<uint64_t> signalValues;
+			bool usesTimelineSemaphores = false;
+
+			void addWait(VkSemaphore semaphore, VkPipelineStageFlags stageFlags, uint64_t value, bool isTimeline) {
+				waitSemaphores.push_back(semaphore);
+				waitStageFlags.push_back(stageFlags);
+				waitValues.push_back(value);
+				usesTimelineSemaphores |= isTimeline;
+			}
+
+			void addSignal(VkSemaphore semaphore, uint64_t value, bool isTimeline) {
+				signalSemaphores.push_back(semaphore);
+				signalValues.push_back(value);
+				usesTimelineSemaphores |= isTimeline;
+			}
+
+			void submit(VkQueue queue, VkFence fence) const {
+				VkTimelineSemaphoreSubmitInfoKHR timelineSubmitInfo = {
+					.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
+					.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size()),
+					.pWaitSemaphoreValues = waitValues.data(),
+					.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size()),
+					.pSignalSemaphoreValues = signalValues.data()
+				};
+				VkSubmitInfo submitInfo = { .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+											.pNext = usesTimelineSemaphores ? &timelineSubmitInfo : nullptr,
+											.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size()),
+											.pWaitSemaphores = waitSemaphores.data(),
+											.pWaitDstStageMask = waitStageFlags.data(),
+											.commandBufferCount = static_cast<uint32_t>(commandBuffers.size()),
+											.pCommandBuffers = commandBuffers.data(),
+											.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size()),
+											.pSignalSemaphores = signalSemaphores.data() };
+				vkQueueSubmit(queue, 1, &submitInfo, fence);
+			}
+		};
+	} // namespace
+
 	GraphicsSubsystem::GraphicsSubsystem(const std::string_view& appName,
 										 const std::string_view& pipelineLibraryFileName, uint32_t appVersion,
 										 windowing::WindowInterface& interface)
@@ -39,6 +86,8 @@ namespace vanadium::graphics {
 
 		vkWaitForFences(m_deviceContext.device(), 1, &m_deviceContext.frameCompletionFence(m_frameIndex), VK_TRUE,
 						UINT64_MAX);
+		// The fence only covers the graphics queue
+		m_framegraphContext.waitForAsyncSubmissions(m_frameIndex);
 		m_resourceAllocator.setFrameIndex(m_frameIndex);
 
 		if (m_surface.swapchainDirtyFlag() || m_framegraphContext.swapchainDirtyFlag()) {
@@ -58,22 +107,67 @@ namespace vanadium::graphics {
 
 			m_renderTargetSurface.setTargetImageIndex(imageIndex);
 
-			VkCommandBuffer graphicsCommandBuffer = m_framegraphContext.recordFrame(m_frameIndex);
-
-			VkCommandBuffer commandBuffers[2] = { m_transferManager.recordTransfers(m_frameIndex),
-												  graphicsCommandBuffer };
-
-			VkPipelineStageFlags waitFlags = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-			VkSubmitInfo submitInfo = { .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-										.waitSemaphoreCount = 1,
-										.pWaitSemaphores = &m_surface.acquireSemaphore(m_frameIndex),
-										.pWaitDstStageMask = &waitFlags,
-										.commandBufferCount = 2,
-										.pCommandBuffers = commandBuffers,
-										.signalSemaphoreCount = 1,
-										.pSignalSemaphores = &m_surface.presentSemaphore(m_frameIndex) };
-			vkQueueSubmit(m_deviceContext.graphicsQueue(), 1, &submitInfo,
-						  m_deviceContext.frameCompletionFence(m_frameIndex));
+			// Nodes queue uploads while they record, so the transfers are recorded afterwards but still submitted first
+			auto& submissions = m_framegraphContext.recordFrame(m_frameIndex);
+			VkCommandBuffer transferCommandBuffer = m_transferManager.recordTransfers(m_frameIndex);
+			auto uploadSignal = m_framegraphContext.uploadSignal();
+			// Uploads on the transfer queue only need to finish before the stages that use them
+			auto transferQueueWait = m_transferManager.transferQueueWait();
+
+			// With async compute, the uploads get a submission of their own so compute batches can wait for them
+			if (uploadSignal.has_value()) {
+				QueueSubmission uploadSubmission;
+				uploadSubmission.commandBuffers.push_back(transferCommandBuffer);
+				if (transferQueueWait.has_value()) {
+					uploadSubmission.addWait(transferQueueWait->semaphore, transferQueueWait->dstStageFlags,
+											 transferQueueWait->value, true);
+				}
+				uploadSubmission.addSignal(uploadSignal->semaphore, uploadSignal->value, true);
+				uploadSubmission.submit(m_deviceContext.graphicsQueue(), VK_NULL_HANDLE);
+			}
+
+			size_t firstGraphicsSubmissionIndex = submissions.size();
+			size_t lastGraphicsSubmissionIndex = 0;
+			for (size_t i = 0; i < submissions.size(); ++i) {
+				if (submissions[i].queue == FramegraphQueue::Graphics) {
+					firstGraphicsSubmissionIndex = std::min(firstGraphicsSubmissionIndex, i);
+					lastGraphicsSubmissionIndex = i;
+				}
+			}
+
+			for (size_t i = 0; i < submissions.size(); ++i) {
+				auto& submission = submissions[i];
+				QueueSubmission queueSubmission;
+				if (i == firstGraphicsSubmissionIndex) {
+					queueSubmission.addWait(m_surface.acquireSemaphore(m_frameIndex), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+											0, false);
+					if (!uploadSignal.has_value()) {
+						queueSubmission.commandBuffers.push_back(transferCommandBuffer);
+						if (transferQueueWait.has_value()) {
+							queueSubmission.addWait(transferQueueWait->semaphore, transferQueueWait->dstStageFlags,
+													transferQueueWait->value, true);
+						}
+					}
+				}
+				queueSubmission.commandBuffers.insert(queueSubmission.commandBuffers.end(), submission.commandBuffers.begin(),
+													  submission.commandBuffers.end());
+				for (auto& wait : submission.waits) {
+					queueSubmission.addWait(wait.semaphore, wait.dstStageFlags, wait.value, true);
+				}
+				if (submission.signal.has_value()) {
+					queueSubmission.addSignal(submission.signal->semaphore, submission.signal->value, true);
+				}
+
+				VkFence fence = VK_NULL_HANDLE;
+				if (i == lastGraphicsSubmissionIndex) {
+					queueSubmission.addSignal(m_surface.presentSemaphore(m_frameIndex), 0, false);
+					fence = m_deviceContext.frameCompletionFence(m_frameIndex);
+				}
+				queueSubmission.submit(submission.queue == FramegraphQueue::Graphics
+										   ? m_deviceContext.graphicsQueue()
+										   : m_deviceContext.asyncComputeQueue(),
+									   fence);
+			}
 
 			m_surface.tryPresent(m_deviceContext.graphicsQueue(), imageIndex, m_frameIndex);
 
@@ -1,5 +1,6 @@
 #include <Debug.hpp>
 #include <cstdio>
+#include <functional>
 #include <graphics/framegraph/FramegraphContext.hpp>
 #include <graphics/framegraph/FramegraphNode.hpp>
 #include <graphics/helper/DebugHelper.hpp>
@@ -37,33 +38,80 @@ template <typename T, T fullRangeValue> bool isCompletelyContained(T offset1, T
 }
 
 namespace vanadium::graphics {
+	namespace {
+		TransientResourceRequirements transientRequirements(const ResourceLifetime& lifetime,
+															const VkMemoryRequirements& memoryRequirements) {
+			return { .firstNodeIndex = lifetime.firstNodeIndex,
+					 .lastNodeIndex = lifetime.lastNodeIndex,
+					 .size = memoryRequirements.size,
+					 .alignment = memoryRequirements.alignment,
+					 .memoryTypeBits = memoryRequirements.memoryTypeBits };
+		}
+
+		bool hasStencilAspect(VkFormat format) {
+			return format == VK_FORMAT_S8_UINT || format == VK_FORMAT_D16_UNORM_S8_UINT ||
+				   format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+		}
+	} // namespace
+
 	void FramegraphContext::create(const RenderContext& context) {
 		m_context = context;
+		m_barrierGenerator.setUsesSynchronization2(m_context.deviceContext->deviceCapabilities().synchronization2);
+
+		uint32_t queueFamilyIndices[framegraphQueueCount] = {
+			m_context.deviceContext->graphicsQueueFamilyIndex(),
+			m_context.deviceContext->asyncComputeQueueFamilyIndex()
+		};
+		size_t usedQueueCount = canUseAsyncCompute() ? framegraphQueueCount : 1;
+
+		// The thread calling recordFrame records as well, so it isn't counted
+		uint32_t hardwareThreadCount = std::max(std::thread::hardware_concurrency(), 2U);
+		m_recordingWorkers.create(std::min(hardwareThreadCount - 1, maxRecordingThreadCount));
+
+		m_recordingSegments = planRecordingSegments({});
+		m_segmentBatchIndices = { 0 };
+		m_recordingPools.resize(m_recordingWorkers.threadCount() + 1);
+		for (auto& pools : m_recordingPools) {
+			for (size_t queueIndex = 0; queueIndex < usedQueueCount; ++queueIndex) {
+				VkCommandPoolCreateInfo poolCreateInfo = { .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+														   .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+														   .queueFamilyIndex = queueFamilyIndices[queueIndex] };
+				for (size_t i = 0; i < frameInFlightCount; ++i) {
+					verifyResult(vkCreateCommandPool(m_context.deviceContext->device(), &poolCreateInfo, nullptr,
+													 &pools.commandPools[queueIndex][i]));
+				}
+			}
+		}
 
-		VkCommandPoolCreateInfo poolCreateInfo = { .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-												   .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
-												   .queueFamilyIndex =
-													   m_context.deviceContext->graphicsQueueFamilyIndex() };
-
-		for (size_t i = 0; i < frameInFlightCount; ++i) {
-			verifyResult(vkCreateCommandPool(m_context.deviceContext->device(), &poolCreateInfo, nullptr,
-											 &m_frameCommandPools[i]));
-			VkCommandBufferAllocateInfo allocateInfo = { .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-														 .commandPool = m_frameCommandPools[i],
-														 .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-														 .commandBufferCount = 1 };
-			verifyResult(
-				vkAllocateCommandBuffers(m_context.deviceContext->device(), &allocateInfo, &m_frameCommandBuffers[i]));
+		if (canUseAsyncCompute()) {
+			VkSemaphoreTypeCreateInfoKHR semaphoreTypeCreateInfo = {
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR,
+				.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR,
+				.initialValue = 0
+			};
+			VkSemaphoreCreateInfo semaphoreCreateInfo = { .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+														  .pNext = &semaphoreTypeCreateInfo };
+			for (auto& semaphore : m_queueSemaphores) {
+				verifyResult(
+					vkCreateSemaphore(m_context.deviceContext->device(), &semaphoreCreateInfo, nullptr, &semaphore));
+			}
 		}
 	}
 
+	bool FramegraphContext::canUseAsyncCompute() const {
+		return m_context.deviceContext->hasDedicatedComputeQueue() &&
+			   m_context.deviceContext->deviceCapabilities().timelineSemaphore;
+	}
+
 	void FramegraphContext::removeNode(FramegraphNode* node) {
-		auto nodeIterator =
-			std::find_if(m_nodes.begin(), m_nodes.end(), [node](const auto& info) { return info.node == node; });
+		auto nodeIterator = m_nodes.begin() + findNodeIndex(node);
 		if (nodeIterator == m_nodes.end()) {
 			logError("Trying to delete nonexistent node {}!", static_cast<void*>(node));
+			return;
 		}
 		m_barrierGenerator.removeNodeIndex(nodeIterator - m_nodes.begin());
+		m_nodes.erase(nodeIterator);
+		updateNodeIndices();
 		auto unusedBuffers = m_barrierGenerator.unusedBuffers();
 		for (auto& buffer : unusedBuffers) {
 			m_context.resourceAllocator->destroyBuffer(m_buffers[buffer].resourceHandle);
@@ -75,7 +123,7 @@ namespace vanadium::graphics {
 		}
 		auto unusedImages = m_barrierGenerator.unusedImages();
 		for (auto& image : unusedImages) {
-			m_context.resourceAllocator->destroyBuffer(m_images[image].resourceHandle);
+			m_context.resourceAllocator->destroyImage(m_images[image].resourceHandle);
 			m_images.removeElement(image);
 			auto iterator = std::find(m_transientImages.begin(), m_transientImages.end(), image);
 			if (iterator != m_transientImages.end()) {
@@ -85,17 +133,58 @@ namespace vanadium::graphics {
 		m_resourceDirtyFlag = true;
 	}
 
-	void FramegraphContext::initResources() {
-		for (auto handle : m_transientBuffers) {
-			if (m_buffers[handle].resourceHandle == ~0U)
-				createBuffer(handle);
+	void FramegraphContext::setNodeEnabled(FramegraphNode* node, bool enabled) {
+		size_t index = findNodeIndex(node);
+		if (index == m_nodes.size()) {
+			logError("Trying to toggle nonexistent node {}!", static_cast<void*>(node));
+			return;
 		}
-		for (auto handle : m_transientImages) {
-			if (m_images[handle].resourceHandle == ~0U)
-				createImage(handle);
+		if (m_nodes[index].isEnabled != enabled) {
+			m_nodes[index].isEnabled = enabled;
+			m_resourceDirtyFlag = true;
 		}
+	}
 
-		for (auto& node : m_nodes) {
+	size_t FramegraphContext::findNodeIndex(FramegraphNode* node) const {
+		auto iterator = m_nodeIndices.find(node);
+		return iterator == m_nodeIndices.end() ? m_nodes.size() : iterator->second;
+	}
+
+	void FramegraphContext::updateNodeIndices() {
+		m_nodeIndices.clear();
+		for (size_t index = 0; index < m_nodes.size(); ++index) {
+			m_nodeIndices[m_nodes[index].node] = index;
+		}
+	}
+
+	void FramegraphContext::initResources() {
+		cullNodes();
+		// Resources of merged nodes can't alias each other, so render passes are planned before resources are placed
+		planRenderPasses();
+		createTransientResources();
+		createRenderPasses();
+		requestNodeViews();
+
+		for (size_t nodeIndex = 0; nodeIndex < m_nodes.size(); ++nodeIndex) {
+			if (isNodeCulled(nodeIndex)) {
+				continue;
+			}
+			auto& node = m_nodes[nodeIndex];
+			if (m_context.targetSurface->currentImageCount() > 0)
+				node.node->recreateSwapchainResources(this, m_context.targetSurface->properties().width,
+													  m_context.targetSurface->properties().height);
+			node.node->afterResourceInit(this);
+		}
+
+		updateDependencyInfo();
+	}
+
+	void FramegraphContext::requestNodeViews() {
+		for (size_t nodeIndex = 0; nodeIndex < m_nodes.size(); ++nodeIndex) {
+			if (isNodeCulled(nodeIndex)) {
+				continue;
+			}
+			auto& node = m_nodes[nodeIndex];
 			for (auto& infos : node.resourceViewInfos) {
 				for (auto& info : infos.second) {
 					m_context.resourceAllocator->requestImageView(m_images[infos.first].resourceHandle, info);
@@ -104,13 +193,7 @@ namespace vanadium::graphics {
 			for (auto& info : node.swapchainResourceViewInfos) {
 				m_context.targetSurface->addRequestedView(info);
 			}
-			if (m_context.targetSurface->currentImageCount() > 0)
-				node.node->recreateSwapchainResources(this, m_context.targetSurface->properties().width,
-													  m_context.targetSurface->properties().height);
-			node.node->afterResourceInit(this);
 		}
-
-		updateDependencyInfo();
 	}
 
 	FramegraphBufferHandle FramegraphContext::declareTransientBuffer(
@@ -120,8 +203,7 @@ namespace vanadium::graphics {
 			m_buffers.addElement(FramegraphBufferResource{ .creationParameters = parameters });
 		m_transientBuffers.push_back(handle);
 
-		auto nodeIterator =
-			std::find_if(m_nodes.begin(), m_nodes.end(), [creator](const auto& info) { return info.node == creator; });
+		auto nodeIterator = m_nodes.begin() + findNodeIndex(creator);
 		if (nodeIterator == m_nodes.end()) {
 			printf("invalid node as creator!\n");
 			return ~0U;
@@ -146,8 +228,7 @@ namespace vanadium::graphics {
 		FramegraphImageHandle handle = m_images.addElement(FramegraphImageResource{ .creationParameters = parameters });
 		m_transientImages.push_back(handle);
 
-		auto nodeIterator =
-			std::find_if(m_nodes.begin(), m_nodes.end(), [creator](const auto& info) { return info.node == creator; });
+		auto nodeIterator = m_nodes.begin() + findNodeIndex(creator);
 		if (nodeIterator == m_nodes.end()) {
 			printf("invalid node as creator!\n");
 			return ~0U;
@@ -171,8 +252,7 @@ namespace vanadium::graphics {
 		FramegraphBufferHandle bufferHandle =
 			m_buffers.addElement(FramegraphBufferResource{ .isImported = true, .resourceHandle = handle });
 
-		auto nodeIterator =
-			std::find_if(m_nodes.begin(), m_nodes.end(), [creator](const auto& info) { return info.node == creator; });
+		auto nodeIterator = m_nodes.begin() + findNodeIndex(creator);
 		if (nodeIterator == m_nodes.end()) {
 			printf("invalid node as creator!\n");
 			return ~0U;
@@ -196,8 +276,7 @@ namespace vanadium::graphics {
 		FramegraphImageHandle imageHandle =
 			m_images.addElement(FramegraphImageResource{ .isImported = true, .resourceHandle = handle });
 
-		auto nodeIterator =
-			std::find_if(m_nodes.begin(), m_nodes.end(), [creator](const auto& info) { return info.node == creator; });
+		auto nodeIterator = m_nodes.begin() + findNodeIndex(creator);
 		if (nodeIterator == m_nodes.end()) {
 			printf("invalid node as creator!\n");
 			return ~0U;
@@ -216,8 +295,7 @@ namespace vanadium::graphics {
 
 	void FramegraphContext::declareReferencedBuffer(FramegraphNode* user, FramegraphBufferHandle handle,
 													const FramegraphNodeBufferUsage& usage) {
-		auto nodeIterator =
-			std::find_if(m_nodes.begin(), m_nodes.end(), [user](const auto& info) { return info.node == user; });
+		auto nodeIterator = m_nodes.begin() + findNodeIndex(user);
 		if (nodeIterator == m_nodes.end()) {
 			printf("invalid node for dependency!\n");
 			return;
@@ -243,8 +321,7 @@ namespace vanadium::graphics {
 	void FramegraphContext::declareReferencedImage(FramegraphNode* user, FramegraphImageHandle handle,
 												   const FramegraphNodeImageUsage& usage) {
 
-		auto nodeIterator =
-			std::find_if(m_nodes.begin(), m_nodes.end(), [user](const auto& info) { return info.node == user; });
+		auto nodeIterator = m_nodes.begin() + findNodeIndex(user);
 		if (nodeIterator == m_nodes.end()) {
 			printf("invalid node for dependency!\n");
 			return;
@@ -277,8 +354,7 @@ namespace vanadium::graphics {
 
 	void FramegraphContext::declareReferencedSwapchainImage(FramegraphNode* user,
 															const FramegraphNodeImageUsage& usage) {
-		auto nodeIterator =
-			std::find_if(m_nodes.begin(), m_nodes.end(), [user](const auto& info) { return info.node == user; });
+		auto nodeIterator = m_nodes.begin() + findNodeIndex(user);
 		if (nodeIterator == m_nodes.end()) {
 			printf("invalid node for dependency!\n");
 			return;
@@ -299,6 +375,61 @@ namespace vanadium::graphics {
 		}
 	}
 
+	void FramegraphContext::declareRasterPass(FramegraphNode* node, const FramegraphRasterPassInfo& info) {
+		size_t nodeIndex = findNodeIndex(node);
+		if (nodeIndex == m_nodes.size()) {
+			logError("Trying to declare raster pass of nonexistent node {}!", static_cast<void*>(node));
+			return;
+		}
+		auto& nodeInfo = m_nodes[nodeIndex];
+		auto isValidAttachment = [this, &nodeInfo](const FramegraphRasterAttachment& attachment) {
+			if (!attachment.image.has_value()) {
+				return attachment.viewIndex < nodeInfo.swapchainResourceViewInfos.size();
+			}
+			auto viewInfos = nodeInfo.resourceViewInfos.find(attachment.image.value());
+			return std::find(m_transientImages.begin(), m_transientImages.end(), attachment.image.value()) !=
+					   m_transientImages.end() &&
+				   viewInfos != nodeInfo.resourceViewInfos.end() && attachment.viewIndex < viewInfos->second.size();
+		};
+
+		bool isValid = !info.colorAttachments.empty() || info.depthStencilAttachment.has_value();
+		for (auto& attachment : info.colorAttachments) {
+			isValid &= isValidAttachment(attachment);
+		}
+		if (info.depthStencilAttachment.has_value()) {
+			isValid &= isValidAttachment(info.depthStencilAttachment.value());
+		}
+		for (auto& attachment : info.inputAttachments) {
+			isValid &= isValidAttachment(attachment);
+		}
+		if (!isValid) {
+			logError("Raster pass of node {} needs attachments on declared views of transient images or the target "
+					 "image!",
+					 node->name());
+			return;
+		}
+		nodeInfo.rasterPass = info;
+		m_resourceDirtyFlag = true;
+	}
+
+	VkRenderPass FramegraphContext::renderPass(FramegraphNode* node) const {
+		size_t nodeIndex = findNodeIndex(node);
+		if (nodeIndex == m_nodes.size() || m_nodes[nodeIndex].renderPassIndex >= m_renderPasses.size()) {
+			return VK_NULL_HANDLE;
+		}
+		return m_renderPasses[m_nodes[nodeIndex].renderPassIndex].renderPass;
+	}
+
+	RenderPassSignature FramegraphContext::renderPassSignature(FramegraphNode* node) const {
+		size_t nodeIndex = findNodeIndex(node);
+		if (nodeIndex == m_nodes.size() || m_nodes[nodeIndex].renderPassIndex >= m_renderPasses.size()) {
+			return {};
+		}
+		auto signature = m_renderPasses[m_nodes[nodeIndex].renderPassIndex].signature;
+		signature.subpassIndex = m_nodes[nodeIndex].subpassIndex;
+		return signature;
+	}
+
 	void FramegraphContext::invalidateBuffer(FramegraphBufferHandle handle, BufferResourceHandle newHandle) {
 		m_buffers[handle].resourceHandle = newHandle;
 	}
@@ -331,6 +462,11 @@ namespace vanadium::graphics {
 			}
 		}
 		m_buffers[handle].creationParameters = parameters;
+		// The resource leaves its aliasing block until the next time transient resources are placed
+		if (m_buffers[handle].isAliased) {
+			m_context.resourceAllocator->destroyBuffer(m_buffers[handle].resourceHandle);
+			m_buffers[handle].isAliased = false;
+		}
 		createBuffer(handle);
 	}
 
@@ -342,6 +478,10 @@ namespace vanadium::graphics {
 			}
 		}
 		m_images[handle].creationParameters = parameters;
+		if (m_images[handle].isAliased) {
+			m_context.resourceAllocator->destroyImage(m_images[handle].resourceHandle);
+			m_images[handle].isAliased = false;
+		}
 		createImage(handle);
 	}
 
@@ -364,8 +504,7 @@ namespace vanadium::graphics {
 	}
 
 	VkImageView FramegraphContext::imageView(FramegraphNode* node, FramegraphImageHandle handle, size_t index) {
-		auto nodeIterator =
-			std::find_if(m_nodes.begin(), m_nodes.end(), [node](const auto& info) { return info.node == node; });
+		auto nodeIterator = m_nodes.begin() + findNodeIndex(node);
 		if (nodeIterator == m_nodes.end()) {
 			printf("invalid node for dependency!\n");
 			return VK_NULL_HANDLE;
@@ -375,8 +514,7 @@ namespace vanadium::graphics {
 	}
 
 	VkImageView FramegraphContext::targetImageView(FramegraphNode* node, uint32_t index) {
-		auto nodeIterator =
-			std::find_if(m_nodes.begin(), m_nodes.end(), [node](const auto& info) { return info.node == node; });
+		auto nodeIterator = m_nodes.begin() + findNodeIndex(node);
 		if (nodeIterator == m_nodes.end()) {
 			printf("getting image view of unknown node!\n");
 			return VK_NULL_HANDLE;
@@ -397,45 +535,136 @@ namespace vanadium::graphics {
 		return m_images[handle].usage;
 	}
 
-	VkCommandBuffer FramegraphContext::recordFrame(uint32_t frameIndex) {
+	const std::vector<FramegraphSubmission>& FramegraphContext::recordFrame(uint32_t frameIndex) {
+		// Render passes retired when this frame index was recorded last were only used by frames that finished now
+		m_recordingFrameIndex = frameIndex;
+		destroyRenderPasses(m_retiredRenderPasses[frameIndex]);
 		if (m_resourceDirtyFlag) {
 			initResources();
-			updateDependencyInfo();
 			m_resourceDirtyFlag = false;
 		}
 		updateBarriers();
+		updateSplitBarrierEvents(frameIndex);
 
-		vkResetCommandPool(m_context.deviceContext->device(), m_frameCommandPools[frameIndex], 0);
-
-		VkCommandBuffer frameCommandBuffer = m_frameCommandBuffers[frameIndex];
-		VkCommandBufferBeginInfo beginInfo = { .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-											   .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT };
-		verifyResult(vkBeginCommandBuffer(frameCommandBuffer, &beginInfo));
+		for (auto& pools : m_recordingPools) {
+			for (size_t queueIndex = 0; queueIndex < framegraphQueueCount; ++queueIndex) {
+				if (pools.commandPools[queueIndex][frameIndex]) {
+					vkResetCommandPool(m_context.deviceContext->device(), pools.commandPools[queueIndex][frameIndex],
+									   0);
+				}
+				pools.usedCommandBufferCounts[queueIndex][frameIndex] = 0;
+			}
+		}
+		updateNodeContexts(frameIndex);
+
+		// Parallel segments are recorded while the calling thread records the others
+		m_frameCommandBuffers.resize(m_recordingSegments.size());
+		m_recordingWorkers.dispatch(m_parallelSegmentIndices.size(),
+									[this, frameIndex](size_t jobIndex, uint32_t threadIndex) {
+										recordSegment(m_parallelSegmentIndices[jobIndex], threadIndex, frameIndex);
+									});
+		uint32_t callingThreadPoolIndex = m_recordingWorkers.threadCount();
+		for (size_t i = 0; i < m_recordingSegments.size(); ++i) {
+			if (!m_recordingSegments[i].isParallel) {
+				recordSegment(i, callingThreadPoolIndex, frameIndex);
+			}
+		}
+		m_recordingWorkers.wait();
 
-		size_t nodeIndex = 0;
+		updateSubmissions(frameIndex);
+		m_hasReleasedOwnership = true;
+		return m_frameSubmissions;
+	}
 
-		FramegraphNodeContext nodeContext = { .frameIndex = frameIndex, .targetSurface = m_context.targetSurface };
+	void FramegraphContext::updateSubmissions(uint32_t frameIndex) {
+		auto& schedule = m_barrierGenerator.queueSchedule();
+		m_frameSubmissions.resize(schedule.batches.size());
+		for (size_t batchIndex = 0; batchIndex < schedule.batches.size(); ++batchIndex) {
+			auto& submission = m_frameSubmissions[batchIndex];
+			submission.queue = schedule.batches[batchIndex].queue;
+			submission.commandBuffers.clear();
+			submission.waits.clear();
+			submission.signal = std::nullopt;
+		}
+		for (size_t segmentIndex = 0; segmentIndex < m_recordingSegments.size(); ++segmentIndex) {
+			m_frameSubmissions[m_segmentBatchIndices[segmentIndex]].commandBuffers.push_back(
+				m_frameCommandBuffers[segmentIndex]);
+		}
 
-		if (m_barrierGenerator.frameStartBarrierCount()) {
-			VkMemoryBarrier memoryBarrier = { .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
-											  .srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT,
-											  .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT };
+		m_uploadSignal = std::nullopt;
+		if (!m_barrierGenerator.usesAsyncQueues()) {
+			return;
+		}
 
-			vkCmdPipelineBarrier(frameCommandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-								 VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &memoryBarrier, 0, nullptr,
-								 static_cast<uint32_t>(m_barrierGenerator.frameStartBarrierCount()),
-								 m_barrierGenerator.frameStartBarriers().data());
+		// Waits for the previous frame use the last value its batches signaled, which stays valid when the
+		// schedule changes
+		auto previousFrameValues = m_queueSemaphoreValues;
+		auto& graphicsValue = m_queueSemaphoreValues[static_cast<size_t>(FramegraphQueue::Graphics)];
+		m_uploadSignal = TimelineSemaphoreSignal{ .semaphore = m_queueSemaphores[0], .value = ++graphicsValue };
+		for (auto& submission : m_frameSubmissions) {
+			size_t queueIndex = static_cast<size_t>(submission.queue);
+			submission.signal = TimelineSemaphoreSignal{ .semaphore = m_queueSemaphores[queueIndex],
+														 .value = ++m_queueSemaphoreValues[queueIndex] };
 		}
 
-		for (auto& node : m_nodes) {
-			if constexpr (vanadiumGPUDebug) {
-				VkDebugUtilsLabelEXT label = { .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
-											   .pLabelName = node.node->name().c_str() };
-				vkCmdBeginDebugUtilsLabelEXT(frameCommandBuffer, &label);
+		for (auto& dependency : schedule.dependencies) {
+			size_t srcQueueIndex = static_cast<size_t>(schedule.batches[dependency.srcBatchIndex].queue);
+			uint64_t value = dependency.crossesFrame ? previousFrameValues[srcQueueIndex]
+													 : m_frameSubmissions[dependency.srcBatchIndex].signal->value;
+			if (value == 0) {
+				continue;
 			}
+			auto& waits = m_frameSubmissions[dependency.dstBatchIndex].waits;
+			auto waitIterator = std::find_if(waits.begin(), waits.end(), [this, srcQueueIndex](const auto& wait) {
+				return wait.semaphore == m_queueSemaphores[srcQueueIndex];
+			});
+			if (waitIterator == waits.end()) {
+				waits.push_back({ .semaphore = m_queueSemaphores[srcQueueIndex],
+								  .value = value,
+								  .dstStageFlags = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT });
+			} else {
+				waitIterator->value = std::max(waitIterator->value, value);
+			}
+		}
+
+		// Later submissions to the same queue are in the scope of the wait as well
+		auto firstAsyncSubmission =
+			std::find_if(m_frameSubmissions.begin(), m_frameSubmissions.end(),
+						 [](const auto& submission) { return submission.queue != FramegraphQueue::Graphics; });
+		if (firstAsyncSubmission != m_frameSubmissions.end()) {
+			firstAsyncSubmission->waits.push_back({ .semaphore = m_uploadSignal->semaphore,
+													.value = m_uploadSignal->value,
+													.dstStageFlags = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT });
+		}
+		m_frameAsyncComputeValues[frameIndex] =
+			m_queueSemaphoreValues[static_cast<size_t>(FramegraphQueue::AsyncCompute)];
+	}
+
+	void FramegraphContext::waitForAsyncSubmissions(uint32_t frameIndex) {
+		size_t computeQueueIndex = static_cast<size_t>(FramegraphQueue::AsyncCompute);
+		if (!m_queueSemaphores[computeQueueIndex] || !m_frameAsyncComputeValues[frameIndex]) {
+			return;
+		}
+		VkSemaphoreWaitInfoKHR waitInfo = { .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR,
+											.semaphoreCount = 1,
+											.pSemaphores = &m_queueSemaphores[computeQueueIndex],
+											.pValues = &m_frameAsyncComputeValues[frameIndex] };
+		verifyResult(vkWaitSemaphoresKHR(m_context.deviceContext->device(), &waitInfo, UINT64_MAX));
+	}
+
+	void FramegraphContext::updateNodeContexts(uint32_t frameIndex) {
+		m_nodeContexts.resize(m_nodes.size());
+		for (size_t nodeIndex = 0; nodeIndex < m_nodes.size(); ++nodeIndex) {
+			auto& node = m_nodes[nodeIndex];
+			auto& nodeContext = m_nodeContexts[nodeIndex];
+			nodeContext.frameIndex = frameIndex;
+			nodeContext.targetSurface = m_context.targetSurface;
 
 			nodeContext.resourceImageViews.clear();
 			nodeContext.targetImageViews.clear();
+			if (isNodeCulled(nodeIndex)) {
+				continue;
+			}
 			for (auto& viewInfos : node.resourceViewInfos) {
 				std::vector<VkImageView> views;
 				views.reserve(viewInfos.second.size());
@@ -451,83 +680,276 @@ namespace vanadium::graphics {
 				for (auto& info : node.swapchainResourceViewInfos)
 					nodeContext.targetImageViews.push_back(m_context.targetSurface->currentTargetView(info));
 			}
+		}
+	}
+
+	VkCommandBuffer FramegraphContext::acquireCommandBuffer(FramegraphQueue queue, uint32_t poolIndex,
+															uint32_t frameIndex) {
+		size_t queueIndex = static_cast<size_t>(queue);
+		auto& pools = m_recordingPools[poolIndex];
+		auto& commandBuffers = pools.commandBuffers[queueIndex][frameIndex];
+		auto& usedCommandBufferCount = pools.usedCommandBufferCounts[queueIndex][frameIndex];
+		if (usedCommandBufferCount == commandBuffers.size()) {
+			VkCommandBufferAllocateInfo allocateInfo = { .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+														 .commandPool = pools.commandPools[queueIndex][frameIndex],
+														 .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+														 .commandBufferCount = 1 };
+			VkCommandBuffer commandBuffer;
+			verifyResult(vkAllocateCommandBuffers(m_context.deviceContext->device(), &allocateInfo, &commandBuffer));
+			commandBuffers.push_back(commandBuffer);
+		}
+		return commandBuffers[usedCommandBufferCount++];
+	}
+
+	void FramegraphContext::recordSegment(size_t segmentIndex, uint32_t poolIndex, uint32_t frameIndex) {
+		auto& segment = m_recordingSegments[segmentIndex];
+		FramegraphQueue queue = m_barrierGenerator.queueSchedule().batches[m_segmentBatchIndices[segmentIndex]].queue;
+		VkCommandBuffer commandBuffer = acquireCommandBuffer(queue, poolIndex, frameIndex);
+		VkCommandBufferBeginInfo beginInfo = { .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+											   .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT };
+		verifyResult(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+
+		// Aliased resources wait for the previous frame's uses of their memory here as well. Queues other than the
+		// graphics queue have no frame start barriers, but their previous frame's accesses aren't waited for otherwise.
+		bool isFirstQueueSegment = m_firstQueueSegmentIndices[static_cast<size_t>(queue)] == segmentIndex;
+		bool isGraphicsQueue = queue == FramegraphQueue::Graphics;
+		if (isFirstQueueSegment && (!isGraphicsQueue || m_barrierGenerator.frameStartBarrierCount() ||
+									m_barrierGenerator.hasAliases())) {
+			VkMemoryBarrier memoryBarrier = { .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+											  .srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT,
+											  .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT };
 
-			node.node->recordCommands(this, frameCommandBuffer, nodeContext);
+			uint32_t frameStartBarrierCount =
+				isGraphicsQueue ? static_cast<uint32_t>(m_barrierGenerator.frameStartBarrierCount()) : 0;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+								 0, 1, &memoryBarrier, 0, nullptr, frameStartBarrierCount,
+								 m_barrierGenerator.frameStartBarriers().data());
+		}
 
-			if (m_barrierGenerator.bufferBarrierCount(nodeIndex) || m_barrierGenerator.imageBarrierCount(nodeIndex)) {
-				vkCmdPipelineBarrier(frameCommandBuffer, m_barrierGenerator.srcStages(nodeIndex),
-									 m_barrierGenerator.dstStages(nodeIndex), 0, 0, nullptr,
-									 static_cast<uint32_t>(m_barrierGenerator.bufferBarrierCount(nodeIndex)),
-									 m_barrierGenerator.bufferBarriers(nodeIndex).data(),
-									 static_cast<uint32_t>(m_barrierGenerator.imageBarrierCount(nodeIndex)),
-									 m_barrierGenerator.imageBarriers(nodeIndex).data());
+		// Barriers are recorded after the node writing the resource, so they also order command buffers of
+		// different segments
+		size_t endNodeIndex = segment.firstNodeIndex + segment.nodeCount;
+		for (size_t nodeIndex = segment.firstNodeIndex; nodeIndex < endNodeIndex; ++nodeIndex) {
+			auto& node = m_nodes[nodeIndex];
+			if constexpr (vanadiumGPUDebug) {
+				VkDebugUtilsLabelEXT label = { .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
+											   .pLabelName = node.node->name().c_str() };
+				vkCmdBeginDebugUtilsLabelEXT(commandBuffer, &label);
+			}
+
+			for (auto splitBarrierIndex : m_barrierGenerator.waitSplitBarrierIndices(nodeIndex)) {
+				recordSplitBarrierWait(commandBuffer, splitBarrierIndex, frameIndex);
+			}
+			// Resources last accessed on another queue are acquired after the submission's semaphore waits
+			recordBarriers(commandBuffer, m_barrierGenerator.acquireBarriers(nodeIndex));
+
+			// Barriers of culled nodes are still recorded, they may have been moved there from earlier nodes
+			if (!isNodeCulled(nodeIndex)) {
+				// Merged nodes continue the render pass of the previous node, their barriers are recorded outside
+				bool usesRenderPass = node.renderPassIndex < m_renderPasses.size();
+				if (usesRenderPass && node.subpassIndex == 0) {
+					beginRenderPass(commandBuffer, m_renderPasses[node.renderPassIndex]);
+				} else if (usesRenderPass) {
+					vkCmdNextSubpass(commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+				}
+				node.node->recordCommands(this, commandBuffer, m_nodeContexts[nodeIndex]);
+				if (usesRenderPass && m_renderPasses[node.renderPassIndex].lastNodeIndex == nodeIndex) {
+					vkCmdEndRenderPass(commandBuffer);
+				}
+			}
+
+			recordBarriers(commandBuffer, m_barrierGenerator.barriers(nodeIndex));
+			// The nodes until the destination of the split barriers don't wait for this node
+			for (auto splitBarrierIndex : m_barrierGenerator.setSplitBarrierIndices(nodeIndex)) {
+				recordSplitBarrierSet(commandBuffer, splitBarrierIndex, frameIndex);
 			}
 
 			if constexpr (vanadiumGPUDebug) {
-				vkCmdEndDebugUtilsLabelEXT(frameCommandBuffer);
+				vkCmdEndDebugUtilsLabelEXT(commandBuffer);
 			}
+		}
 
-			nodeContext.resourceImageViews.clear();
-			++nodeIndex;
+		if (segmentIndex == m_lastGraphicsSegmentIndex) {
+			VkImageLayout lastSwapchainImageLayout = m_barrierGenerator.lastTargetImageLayout();
+			VkImageSubresourceRange accessRange = m_barrierGenerator.lastTargetAccessRange();
+
+			VkImageMemoryBarrier transitionBarrier = { .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+													   .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+													   .dstAccessMask = 0,
+													   .oldLayout = lastSwapchainImageLayout,
+													   .newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+													   .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+													   .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+													   .image = m_context.targetSurface->currentTargetImage(),
+													   .subresourceRange = accessRange };
+
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+								 VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1,
+								 &transitionBarrier);
 		}
 
-		VkImageLayout lastSwapchainImageLayout = m_barrierGenerator.lastTargetImageLayout();
-		VkImageSubresourceRange accessRange = m_barrierGenerator.lastTargetAccessRange();
+		verifyResult(vkEndCommandBuffer(commandBuffer));
+		m_frameCommandBuffers[segmentIndex] = commandBuffer;
+	}
 
-		VkImageMemoryBarrier transitionBarrier = { .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-												   .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
-												   .dstAccessMask = 0,
-												   .oldLayout = lastSwapchainImageLayout,
-												   .newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-												   .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-												   .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-												   .image = m_context.targetSurface->currentTargetImage(),
-												   .subresourceRange = accessRange };
+	void FramegraphContext::beginRenderPass(VkCommandBuffer commandBuffer, const FramegraphRenderPass& renderPass) {
+		size_t framebufferIndex = renderPass.usesTarget ? m_context.targetSurface->currentTargetIndex() : 0;
+		VkRenderPassBeginInfo beginInfo = { .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+											.renderPass = renderPass.renderPass,
+											.framebuffer = renderPass.framebuffers[framebufferIndex],
+											.renderArea = { .extent = renderPass.extent },
+											.clearValueCount = static_cast<uint32_t>(renderPass.clearValues.size()),
+											.pClearValues = renderPass.clearValues.data() };
+		vkCmdBeginRenderPass(commandBuffer, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+	}
 
-		vkCmdPipelineBarrier(frameCommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-							 VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &transitionBarrier);
+	void FramegraphContext::recordBarriers(VkCommandBuffer commandBuffer, const PipelineBarrierBatch& batch) {
+		if (batch.empty()) {
+			return;
+		}
+		if (batch.usesSynchronization2()) {
+			VkDependencyInfoKHR dependencyInfo = batch.dependencyInfo();
+			vkCmdPipelineBarrier2KHR(commandBuffer, &dependencyInfo);
+		} else {
+			vkCmdPipelineBarrier(commandBuffer, batch.srcStageFlags(), batch.dstStageFlags(), 0, 0, nullptr,
+								 static_cast<uint32_t>(batch.bufferBarriers().size()), batch.bufferBarriers().data(),
+								 static_cast<uint32_t>(batch.imageBarriers().size()), batch.imageBarriers().data());
+		}
+	}
 
-		verifyResult(vkEndCommandBuffer(frameCommandBuffer));
-		return frameCommandBuffer;
+	void FramegraphContext::updateSplitBarrierEvents(uint32_t frameIndex) {
+		auto& events = m_splitBarrierEvents[frameIndex];
+		for (size_t i = 0; i < m_usedSplitBarrierEventCounts[frameIndex]; ++i) {
+			verifyResult(vkResetEvent(m_context.deviceContext->device(), events[i]));
+		}
+
+		VkEventCreateInfo eventCreateInfo = { .sType = VK_STRUCTURE_TYPE_EVENT_CREATE_INFO };
+		while (events.size() < m_barrierGenerator.splitBarrierCount()) {
+			VkEvent event;
+			verifyResult(vkCreateEvent(m_context.deviceContext->device(), &eventCreateInfo, nullptr, &event));
+			events.push_back(event);
+		}
+		m_usedSplitBarrierEventCounts[frameIndex] = m_barrierGenerator.splitBarrierCount();
+	}
+
+	// With synchronization2, the barriers are already known when setting the event, so the driver can start them
+	// before the wait
+	void FramegraphContext::recordSplitBarrierSet(VkCommandBuffer commandBuffer, size_t splitBarrierIndex,
+												  uint32_t frameIndex) {
+		auto& batch = m_barrierGenerator.splitBarriers(splitBarrierIndex);
+		VkEvent event = m_splitBarrierEvents[frameIndex][splitBarrierIndex];
+		if (batch.usesSynchronization2()) {
+			VkDependencyInfoKHR dependencyInfo = batch.dependencyInfo();
+			vkCmdSetEvent2KHR(commandBuffer, event, &dependencyInfo);
+		} else {
+			vkCmdSetEvent(commandBuffer, event, batch.srcStageFlags());
+		}
+	}
+
+	void FramegraphContext::recordSplitBarrierWait(VkCommandBuffer commandBuffer, size_t splitBarrierIndex,
+												   uint32_t frameIndex) {
+		auto& batch = m_barrierGenerator.splitBarriers(splitBarrierIndex);
+		VkEvent event = m_splitBarrierEvents[frameIndex][splitBarrierIndex];
+		if (batch.usesSynchronization2()) {
+			VkDependencyInfoKHR dependencyInfo = batch.dependencyInfo();
+			vkCmdWaitEvents2KHR(commandBuffer, 1, &event, &dependencyInfo);
+		} else {
+			vkCmdWaitEvents(commandBuffer, 1, &event, batch.srcStageFlags(), batch.dstStageFlags(), 0, nullptr,
+							static_cast<uint32_t>(batch.bufferBarriers().size()), batch.bufferBarriers().data(),
+							static_cast<uint32_t>(batch.imageBarriers().size()), batch.imageBarriers().data());
+		}
 	}
 
 	void FramegraphContext::handleSwapchainResize(uint32_t width, uint32_t height) {
+		// initResources calls recreateSwapchainResources for all nodes, no need to do it again
 		if (m_resourceDirtyFlag) {
 			initResources();
 			m_resourceDirtyFlag = false;
-		} else { // initResources calls recreateSwapchainResources for all nodes, no need to do it again
-			for (auto& node : m_nodes) {
-				node.node->recreateSwapchainResources(this, width, height);
+			return;
+		}
+
+		// Culling and queue assignment don't depend on the target extent, render areas and merges can
+		auto appliedPlans = std::move(m_renderPassPlans);
+		planRenderPasses();
+		std::vector<bool> planUsesTargetExtent;
+		planUsesTargetExtent.reserve(m_renderPassPlans.size());
+		for (auto& plan : m_renderPassPlans) {
+			planUsesTargetExtent.push_back(usesTargetExtent(plan));
+		}
+		auto actions = planFramegraphResize(m_compilationKey, compilationKey(), appliedPlans, m_renderPassPlans,
+											planUsesTargetExtent);
+
+		// The requirements of transient resources are part of the compilation key, so they only change on a miss
+		bool hasRecreatedResources = actions.updatesCompilation && createTransientResources();
+		auto appliedRenderPasses = std::move(m_renderPasses);
+		resizeRenderPasses(appliedRenderPasses, actions);
+		if (hasRecreatedResources) {
+			requestNodeViews();
+		}
+
+		bool reinitializesNodes =
+			hasRecreatedResources || std::find(actions.recreatesRenderPass.begin(), actions.recreatesRenderPass.end(),
+											   true) != actions.recreatesRenderPass.end();
+		for (size_t nodeIndex = 0; nodeIndex < m_nodes.size(); ++nodeIndex) {
+			if (isNodeCulled(nodeIndex)) {
+				continue;
+			}
+			m_nodes[nodeIndex].node->recreateSwapchainResources(this, width, height);
+			if (reinitializesNodes) {
+				m_nodes[nodeIndex].node->afterResourceInit(this);
 			}
 		}
-		updateDependencyInfo();
+
+		if (actions.updatesCompilation) {
+			updateDependencyInfo();
+		}
 	}
 
 	void FramegraphContext::destroy() {
-		for (auto& commandPool : m_frameCommandPools) {
-			vkDestroyCommandPool(m_context.deviceContext->device(), commandPool, nullptr);
+		m_recordingWorkers.destroy();
+		for (auto& pools : m_recordingPools) {
+			for (auto& queueCommandPools : pools.commandPools) {
+				for (auto& commandPool : queueCommandPools) {
+					vkDestroyCommandPool(m_context.deviceContext->device(), commandPool, nullptr);
+				}
+			}
+		}
+		m_recordingPools.clear();
+		for (size_t i = 0; i < frameInFlightCount; ++i) {
+			for (auto& event : m_splitBarrierEvents[i]) {
+				vkDestroyEvent(m_context.deviceContext->device(), event, nullptr);
+			}
+			m_splitBarrierEvents[i].clear();
+			m_usedSplitBarrierEventCounts[i] = 0;
+			destroyRenderPasses(m_retiredRenderPasses[i]);
+		}
+		destroyRenderPasses(m_renderPasses);
+		for (auto& semaphore : m_queueSemaphores) {
+			vkDestroySemaphore(m_context.deviceContext->device(), semaphore, nullptr);
+			semaphore = VK_NULL_HANDLE;
 		}
 		for (auto& node : m_nodes) {
 			node.node->destroy(this);
 			delete node.node;
 		}
 		m_nodes.clear();
+		m_nodeIndices.clear();
+		m_compilationCache.clear();
+		destroyAliasingBlocks();
 	}
 
-	void FramegraphContext::createBuffer(FramegraphBufferHandle handle) {
+	VkBufferCreateInfo FramegraphContext::bufferCreateInfo(FramegraphBufferHandle handle) {
 		auto& parameters = m_buffers[handle].creationParameters;
 		auto usage = m_buffers[handle].usageFlags;
 
-		VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-										  .flags = parameters.flags,
-										  .size = parameters.size,
-										  .usage = usage,
-										  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
-		m_buffers[handle].resourceHandle =
-			m_context.resourceAllocator->createBuffer(createInfo, {}, { .deviceLocal = true }, false);
+		return { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+				 .flags = parameters.flags,
+				 .size = parameters.size,
+				 .usage = usage,
+				 .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
 	}
 
-	void FramegraphContext::createImage(FramegraphImageHandle handle) {
+	VkImageCreateInfo FramegraphContext::imageCreateInfo(FramegraphImageHandle handle) {
 		auto& parameters = m_images[handle].creationParameters;
 		auto usage = m_images[handle].usage;
 
@@ -546,18 +968,642 @@ namespace vanadium::graphics {
 			createInfo.extent.width = m_context.targetSurface->properties().width;
 			createInfo.extent.height = m_context.targetSurface->properties().height;
 		}
+		return createInfo;
+	}
+
+	void FramegraphContext::createBuffer(FramegraphBufferHandle handle) {
+		m_buffers[handle].resourceHandle =
+			m_context.resourceAllocator->createBuffer(bufferCreateInfo(handle), {}, { .deviceLocal = true }, false);
+		m_buffers[handle].isAliased = false;
+	}
+
+	void FramegraphContext::createImage(FramegraphImageHandle handle) {
 		m_images[handle].resourceHandle =
-			m_context.resourceAllocator->createImage(createInfo, {}, { .deviceLocal = true });
+			m_context.resourceAllocator->createImage(imageCreateInfo(handle), {}, { .deviceLocal = true });
+		m_images[handle].isAliased = false;
+	}
+
+	bool FramegraphContext::createTransientResources() {
+		// Resources only used by culled nodes aren't created
+		bool hasMissingResources = false;
+		std::vector<FramegraphBufferHandle> activeBuffers;
+		std::vector<TransientResourceRequirements> bufferRequirements;
+		for (auto handle : m_transientBuffers) {
+			auto lifetime = m_barrierGenerator.bufferLifetime(handle);
+			if (!lifetime.has_value()) {
+				continue;
+			}
+			hasMissingResources |= m_buffers[handle].resourceHandle == ~0U;
+			activeBuffers.push_back(handle);
+			bufferRequirements.push_back(transientRequirements(
+				lifetime.value(),
+				m_context.resourceAllocator->queryBufferMemoryRequirements(bufferCreateInfo(handle))));
+		}
+
+		// Linear images can't share memory with optimal images without respecting bufferImageGranularity
+		std::vector<FramegraphImageHandle> activeImages;
+		std::vector<FramegraphImageHandle> aliasedImages;
+		std::vector<TransientResourceRequirements> imageRequirements;
+		for (auto handle : m_transientImages) {
+			auto lifetime = m_barrierGenerator.imageLifetime(handle);
+			if (!lifetime.has_value()) {
+				continue;
+			}
+			hasMissingResources |= m_images[handle].resourceHandle == ~0U;
+			activeImages.push_back(handle);
+			if (m_images[handle].creationParameters.tiling != VK_IMAGE_TILING_OPTIMAL) {
+				continue;
+			}
+			aliasedImages.push_back(handle);
+			imageRequirements.push_back(transientRequirements(
+				lifetime.value(), m_context.resourceAllocator->queryImageMemoryRequirements(imageCreateInfo(handle))));
+		}
+
+		bool hasTargetSizedImages = std::any_of(activeImages.begin(), activeImages.end(), [this](auto handle) {
+			return m_images[handle].creationParameters.useTargetImageExtent;
+		});
+		VkExtent2D targetExtent = { .width = m_context.targetSurface->properties().width,
+									.height = m_context.targetSurface->properties().height };
+		bool hasTargetExtentChanged = hasTargetSizedImages && (targetExtent.width != m_transientTargetExtent.width ||
+															   targetExtent.height != m_transientTargetExtent.height);
+		if (!hasMissingResources && !hasTargetExtentChanged && m_activeBuffers == activeBuffers &&
+			m_activeImages == activeImages && m_aliasedBufferRequirements == bufferRequirements &&
+			m_aliasedImageRequirements == imageRequirements) {
+			return false;
+		}
+
+		for (auto handle : m_transientBuffers) {
+			if (m_buffers[handle].resourceHandle != ~0U) {
+				m_context.resourceAllocator->destroyBuffer(m_buffers[handle].resourceHandle);
+				m_buffers[handle].resourceHandle = ~0U;
+			}
+		}
+		for (auto handle : m_transientImages) {
+			if (m_images[handle].resourceHandle != ~0U) {
+				m_context.resourceAllocator->destroyImage(m_images[handle].resourceHandle);
+				m_images[handle].resourceHandle = ~0U;
+			}
+		}
+		destroyAliasingBlocks();
+
+		auto bufferAliases = createAliasedBuffers(activeBuffers, bufferRequirements);
+		auto imageAliases = createAliasedImages(aliasedImages, imageRequirements);
+		for (auto handle : activeImages) {
+			if (m_images[handle].resourceHandle == ~0U)
+				createImage(handle);
+		}
+		m_barrierGenerator.setAliases(bufferAliases, imageAliases);
+
+		m_activeBuffers = std::move(activeBuffers);
+		m_activeImages = std::move(activeImages);
+		m_aliasedBufferRequirements = std::move(bufferRequirements);
+		m_aliasedImageRequirements = std::move(imageRequirements);
+		m_transientTargetExtent = targetExtent;
+		logInfo("Aliasing transient framegraph resources saves {} bytes of memory.", m_transientMemorySaved);
+		return true;
+	}
+
+	std::vector<ResourceAlias> FramegraphContext::createAliasedBuffers(
+		const std::vector<FramegraphBufferHandle>& handles,
+		const std::vector<TransientResourceRequirements>& requirements) {
+		auto plan = planTransientAliasing(requirements);
+		for (auto& block : plan.blocks) {
+			m_bufferAliasingBlocks.push_back(m_context.resourceAllocator->createAliasingBlock(
+				block.size, block.memoryTypeBits, {}, { .deviceLocal = true }, false));
+		}
+
+		// Resources that couldn't be placed in their block get their own memory and don't alias anything
+		for (size_t i = 0; i < handles.size(); ++i) {
+			auto handle = handles[i];
+			BlockHandle block = m_bufferAliasingBlocks[plan.placements[i].blockIndex];
+			if (block != ~0U) {
+				m_buffers[handle].resourceHandle = m_context.resourceAllocator->createAliasedBuffer(
+					bufferCreateInfo(handle), block, plan.placements[i].offset);
+			}
+			if (m_buffers[handle].resourceHandle == ~0U) {
+				createBuffer(handle);
+			} else {
+				m_buffers[handle].isAliased = true;
+			}
+		}
+
+		std::vector<ResourceAlias> aliases;
+		for (auto& alias : plan.aliases) {
+			auto previous = handles[alias.previous];
+			auto next = handles[alias.next];
+			if (m_buffers[previous].isAliased && m_buffers[next].isAliased) {
+				aliases.push_back({ .previous = previous, .next = next });
+			}
+		}
+		m_transientMemorySaved = plan.savedSize();
+		return aliases;
+	}
+
+	std::vector<ResourceAlias> FramegraphContext::createAliasedImages(
+		const std::vector<FramegraphImageHandle>& handles,
+		const std::vector<TransientResourceRequirements>& requirements) {
+		auto plan = planTransientAliasing(requirements);
+		for (auto& block : plan.blocks) {
+			m_imageAliasingBlocks.push_back(m_context.resourceAllocator->createAliasingBlock(
+				block.size, block.memoryTypeBits, {}, { .deviceLocal = true }, true));
+		}
+
+		for (size_t i = 0; i < handles.size(); ++i) {
+			auto handle = handles[i];
+			BlockHandle block = m_imageAliasingBlocks[plan.placements[i].blockIndex];
+			if (block != ~0U) {
+				m_images[handle].resourceHandle = m_context.resourceAllocator->createAliasedImage(
+					imageCreateInfo(handle), block, plan.placements[i].offset);
+			}
+			if (m_images[handle].resourceHandle == ~0U) {
+				createImage(handle);
+			} else {
+				m_images[handle].isAliased = true;
+			}
+		}
+
+		std::vector<ResourceAlias> aliases;
+		for (auto& alias : plan.aliases) {
+			auto previous = handles[alias.previous];
+			auto next = handles[alias.next];
+			if (m_images[previous].isAliased && m_images[next].isAliased) {
+				aliases.push_back({ .previous = previous, .next = next });
+			}
+		}
+		m_transientMemorySaved += plan.savedSize();
+		return aliases;
+	}
+
+	void FramegraphContext::destroyAliasingBlocks() {
+		for (auto block : m_bufferAliasingBlocks) {
+			if (block != ~0U)
+				m_context.resourceAllocator->destroyBufferBlock(block);
+		}
+		for (auto block : m_imageAliasingBlocks) {
+			if (block != ~0U)
+				m_context.resourceAllocator->destroyImageBlock(block);
+		}
+		m_bufferAliasingBlocks.clear();
+		m_imageAliasingBlocks.clear();
+		m_transientMemorySaved = 0;
+	}
+
+	CompilationKey FramegraphContext::compilationKey() const {
+		CompilationKey key;
+		key.add(m_nodes.size());
+		for (auto& info : m_nodes) {
+			key.add(info.isEnabled);
+			key.add(static_cast<uint64_t>(info.node->preferredQueue()));
+			key.add(info.node->recordsInParallel());
+		}
+		m_barrierGenerator.addToCompilationKey(key);
+
+		key.add(m_transientBuffers.size());
+		for (auto handle : m_transientBuffers) {
+			auto& buffer = m_buffers[handle];
+			key.add(handle);
+			key.add(buffer.creationParameters.size);
+			key.add(buffer.creationParameters.flags);
+			key.add(buffer.usageFlags);
+		}
+		bool usesTargetImageExtent = false;
+		key.add(m_transientImages.size());
+		for (auto handle : m_transientImages) {
+			auto& image = m_images[handle];
+			auto& parameters = image.creationParameters;
+			key.add(handle);
+			key.add(parameters.flags);
+			key.add(parameters.imageType);
+			key.add(parameters.format);
+			key.add(parameters.extent.width);
+			key.add(parameters.extent.height);
+			key.add(parameters.extent.depth);
+			key.add(parameters.mipLevels);
+			key.add(parameters.arrayLayers);
+			key.add(parameters.samples);
+			key.add(parameters.tiling);
+			key.add(parameters.useTargetImageExtent);
+			key.add(image.usage);
+			usesTargetImageExtent |= parameters.useTargetImageExtent;
+		}
+		// The target extent changes memory requirements and with them the aliasing of transient resources
+		if (usesTargetImageExtent) {
+			key.add(m_context.targetSurface->properties().width);
+			key.add(m_context.targetSurface->properties().height);
+		}
+		return key;
+	}
+
+	void FramegraphContext::cullNodes() {
+		m_barrierGenerator.create(m_nodes.size());
+		// Disabled nodes are culled, and don't keep the nodes producing their inputs alive
+		auto usages = m_barrierGenerator.nodeResourceUsages(m_transientBuffers, m_transientImages);
+		for (size_t nodeIndex = 0; nodeIndex < m_nodes.size(); ++nodeIndex) {
+			if (!m_nodes[nodeIndex].isEnabled) {
+				usages[nodeIndex] = {};
+			}
+		}
+		m_isNodeCulled = findCulledNodes(usages);
+		for (size_t nodeIndex = 0; nodeIndex < m_nodes.size(); ++nodeIndex) {
+			if (!m_nodes[nodeIndex].isEnabled) {
+				m_isNodeCulled[nodeIndex] = true;
+			}
+		}
+		m_barrierGenerator.setCulledNodes(m_isNodeCulled);
+
+		// Culled nodes stay on the queue of the previous node, so they don't split batches
+		std::vector<FramegraphQueue> nodeQueues;
+		nodeQueues.reserve(m_nodes.size());
+		for (size_t nodeIndex = 0; nodeIndex < m_nodes.size(); ++nodeIndex) {
+			FramegraphQueue queue = FramegraphQueue::Graphics;
+			if (isNodeCulled(nodeIndex)) {
+				queue = nodeQueues.empty() ? FramegraphQueue::Graphics : nodeQueues.back();
+			} else if (canUseAsyncCompute() && !m_barrierGenerator.accessesTarget(nodeIndex)) {
+				queue = m_nodes[nodeIndex].node->preferredQueue();
+			}
+			nodeQueues.push_back(queue);
+		}
+		m_barrierGenerator.setNodeQueues(nodeQueues, { m_context.deviceContext->graphicsQueueFamilyIndex(),
+													   m_context.deviceContext->asyncComputeQueueFamilyIndex() });
+	}
+
+	void FramegraphContext::planRenderPasses() {
+		auto usages = m_barrierGenerator.nodeResourceUsages(m_transientBuffers, m_transientImages);
+		std::vector<RasterNodeUsage> rasterUsages(m_nodes.size());
+		for (size_t nodeIndex = 0; nodeIndex < m_nodes.size(); ++nodeIndex) {
+			auto& node = m_nodes[nodeIndex];
+			node.renderPassIndex = ~0ULL;
+			node.subpassIndex = 0;
+			// Render passes can only be recorded on the graphics queue
+			if (node.rasterPass.has_value() && !isNodeCulled(nodeIndex) &&
+				m_barrierGenerator.nodeQueue(nodeIndex) == FramegraphQueue::Graphics) {
+				rasterUsages[nodeIndex] = rasterNodeUsage(nodeIndex, usages[nodeIndex]);
+			}
+		}
+
+		m_renderPassPlans = planRenderPassMerges(rasterUsages, m_isNodeCulled);
+		std::vector<MergedNodeRange> mergedRanges;
+		for (size_t renderPassIndex = 0; renderPassIndex < m_renderPassPlans.size(); ++renderPassIndex) {
+			auto& subpasses = m_renderPassPlans[renderPassIndex].subpasses;
+			for (uint32_t subpassIndex = 0; subpassIndex < subpasses.size(); ++subpassIndex) {
+				m_nodes[subpasses[subpassIndex].nodeIndex].renderPassIndex = renderPassIndex;
+				m_nodes[subpasses[subpassIndex].nodeIndex].subpassIndex = subpassIndex;
+			}
+			if (subpasses.size() > 1) {
+				mergedRanges.push_back(
+					{ .firstNodeIndex = subpasses.front().nodeIndex, .lastNodeIndex = subpasses.back().nodeIndex });
+			}
+		}
+		m_barrierGenerator.setMergedNodeRanges(mergedRanges);
+	}
+
+	RasterNodeUsage FramegraphContext::rasterNodeUsage(size_t nodeIndex, const NodeResourceUsage& usage) const {
+		auto& node = m_nodes[nodeIndex];
+		auto& targetProperties = m_context.targetSurface->properties();
+		RasterNodeUsage rasterUsage = { .isRaster = true,
+										.canMerge = !node.node->recordsInParallel(),
+										.width = ~0U,
+										.height = ~0U };
+
+		// The render area covers the smallest attachment
+		std::vector<uint64_t> attachmentResources;
+		auto attachmentUsage = [&](const FramegraphRasterAttachment& attachment) {
+			RasterAttachmentUsage result = { .resource = rasterAttachmentResource(attachment),
+											 .format = targetProperties.format,
+											 .sampleCount = VK_SAMPLE_COUNT_1_BIT,
+											 .loadOp = attachment.loadOp,
+											 .storeOp = attachment.storeOp,
+											 .layout = attachment.layout };
+			VkExtent2D extent = { .width = targetProperties.width, .height = targetProperties.height };
+			if (attachment.image.has_value()) {
+				auto& parameters = m_images[attachment.image.value()].creationParameters;
+				result.format = parameters.format;
+				result.sampleCount = parameters.samples;
+				if (!parameters.useTargetImageExtent) {
+					extent = { .width = parameters.extent.width, .height = parameters.extent.height };
+				}
+			}
+			rasterUsage.width = std::min(rasterUsage.width, extent.width);
+			rasterUsage.height = std::min(rasterUsage.height, extent.height);
+			attachmentResources.push_back(result.resource);
+			return result;
+		};
+		for (auto& attachment : node.rasterPass->colorAttachments) {
+			rasterUsage.colorAttachments.push_back(attachmentUsage(attachment));
+		}
+		if (node.rasterPass->depthStencilAttachment.has_value()) {
+			rasterUsage.depthStencilAttachment = attachmentUsage(node.rasterPass->depthStencilAttachment.value());
+		}
+		for (auto& attachment : node.rasterPass->inputAttachments) {
+			rasterUsage.inputAttachments.push_back(attachmentUsage(attachment));
+		}
+
+		auto isAttachment = [&attachmentResources](uint64_t resource) {
+			return std::find(attachmentResources.begin(), attachmentResources.end(), resource) !=
+				   attachmentResources.end();
+		};
+		std::copy_if(usage.readResources.begin(), usage.readResources.end(),
+					 std::back_inserter(rasterUsage.readResources), std::not_fn(isAttachment));
+		std::copy_if(usage.writtenResources.begin(), usage.writtenResources.end(),
+					 std::back_inserter(rasterUsage.writtenResources), std::not_fn(isAttachment));
+		return rasterUsage;
+	}
+
+	// Images are identified like in the resource usages of the barrier generator
+	uint64_t FramegraphContext::rasterAttachmentResource(const FramegraphRasterAttachment& attachment) const {
+		return attachment.image.has_value() ? (1ULL << 32) | attachment.image.value() : ~0ULL;
+	}
+
+	VkImageView FramegraphContext::rasterAttachmentView(size_t nodeIndex, const FramegraphRasterAttachment& attachment,
+														uint32_t targetImageIndex) {
+		auto& node = m_nodes[nodeIndex];
+		if (!attachment.image.has_value()) {
+			auto& viewInfo = node.swapchainResourceViewInfos[attachment.viewIndex];
+			m_context.targetSurface->addRequestedView(viewInfo);
+			return m_context.targetSurface->targetView(targetImageIndex, viewInfo);
+		}
+		return m_context.resourceAllocator->requestImageView(
+			m_images[attachment.image.value()].resourceHandle,
+			node.resourceViewInfos[attachment.image.value()][attachment.viewIndex]);
+	}
+
+	void FramegraphContext::createRenderPasses() {
+		auto& retiredRenderPasses = m_retiredRenderPasses[m_recordingFrameIndex];
+		retiredRenderPasses.insert(retiredRenderPasses.end(), m_renderPasses.begin(), m_renderPasses.end());
+		m_renderPasses.clear();
+
+		for (auto& plan : m_renderPassPlans) {
+			m_renderPasses.push_back(createRenderPass(plan));
+			createFramebuffers(m_renderPasses.back(), plan);
+		}
+	}
+
+	void FramegraphContext::resizeRenderPasses(std::vector<FramegraphRenderPass>& appliedRenderPasses,
+											   const FramegraphResizeActions& actions) {
+		auto& retiredRenderPasses = m_retiredRenderPasses[m_recordingFrameIndex];
+		std::vector<bool> isKept(appliedRenderPasses.size(), false);
+		m_renderPasses.clear();
+		for (size_t i = 0; i < m_renderPassPlans.size(); ++i) {
+			auto& plan = m_renderPassPlans[i];
+			if (actions.recreatesRenderPass[i]) {
+				m_renderPasses.push_back(createRenderPass(plan));
+				createFramebuffers(m_renderPasses.back(), plan);
+				continue;
+			}
+
+			isKept[i] = true;
+			auto& renderPass = m_renderPasses.emplace_back(std::move(appliedRenderPasses[i]));
+			if (actions.recreatesFramebuffers[i]) {
+				retiredRenderPasses.push_back({ .framebuffers = std::move(renderPass.framebuffers) });
+				renderPass.framebuffers.clear();
+				renderPass.extent = { .width = plan.width, .height = plan.height };
+				createFramebuffers(renderPass, plan);
+			}
+		}
+		for (size_t i = 0; i < appliedRenderPasses.size(); ++i) {
+			if (!isKept[i]) {
+				retiredRenderPasses.push_back(std::move(appliedRenderPasses[i]));
+			}
+		}
+	}
+
+	std::vector<std::pair<size_t, FramegraphRasterAttachment>> FramegraphContext::attachmentSources(
+		const MergedRenderPass& plan) const {
+		// Views and clear values come from the first node using the attachment
+		std::vector<std::pair<size_t, FramegraphRasterAttachment>> sources(plan.attachments.size());
+		std::vector<bool> hasSource(plan.attachments.size(), false);
+		for (auto& subpass : plan.subpasses) {
+			auto& rasterPass = m_nodes[subpass.nodeIndex].rasterPass.value();
+			auto addSource = [&](const FramegraphRasterAttachment& attachment) {
+				uint64_t resource = rasterAttachmentResource(attachment);
+				for (size_t i = 0; i < plan.attachments.size(); ++i) {
+					if (plan.attachments[i].resource == resource && !hasSource[i]) {
+						sources[i] = { subpass.nodeIndex, attachment };
+						hasSource[i] = true;
+					}
+				}
+			};
+			std::for_each(rasterPass.colorAttachments.begin(), rasterPass.colorAttachments.end(), addSource);
+			if (rasterPass.depthStencilAttachment.has_value()) {
+				addSource(rasterPass.depthStencilAttachment.value());
+			}
+			std::for_each(rasterPass.inputAttachments.begin(), rasterPass.inputAttachments.end(), addSource);
+		}
+		return sources;
+	}
+
+	bool FramegraphContext::usesTargetExtent(const MergedRenderPass& plan) const {
+		return std::any_of(plan.attachments.begin(), plan.attachments.end(), [this](const auto& attachment) {
+			// Other attachments are images, identified like in rasterAttachmentResource
+			return attachment.resource == ~0ULL ||
+				   m_images[static_cast<FramegraphImageHandle>(attachment.resource & 0xFFFFFFFFULL)]
+					   .creationParameters.useTargetImageExtent;
+		});
+	}
+
+	FramegraphRenderPass FramegraphContext::createRenderPass(const MergedRenderPass& plan) {
+		FramegraphRenderPass renderPass = { .extent = { .width = plan.width, .height = plan.height },
+											.lastNodeIndex = plan.subpasses.back().nodeIndex };
+		auto sources = attachmentSources(plan);
+
+		std::vector<VkAttachmentDescription> attachmentDescriptions;
+		attachmentDescriptions.reserve(plan.attachments.size());
+		for (size_t i = 0; i < plan.attachments.size(); ++i) {
+			auto& attachment = plan.attachments[i];
+			// Stencil aspects are loaded and stored like depth aspects
+			bool hasStencil = hasStencilAspect(attachment.format);
+			attachmentDescriptions.push_back(
+				{ .format = attachment.format,
+				  .samples = attachment.sampleCount,
+				  .loadOp = attachment.loadOp,
+				  .storeOp = attachment.storeOp,
+				  .stencilLoadOp = hasStencil ? attachment.loadOp : VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+				  .stencilStoreOp = hasStencil ? attachment.storeOp : VK_ATTACHMENT_STORE_OP_DONT_CARE,
+				  .initialLayout = attachment.initialLayout,
+				  .finalLayout = attachment.finalLayout });
+			renderPass.signature.attachmentDescriptionSignatures.push_back(
+				{ .isUsed = true, .format = attachment.format, .sampleCount = attachment.sampleCount });
+			renderPass.clearValues.push_back(sources[i].second.clearValue);
+			renderPass.usesTarget |= !sources[i].second.image.has_value();
+		}
+
+		auto attachmentSignature = [&plan](uint32_t attachmentIndex) -> AttachmentPassSignature {
+			if (attachmentIndex == VK_ATTACHMENT_UNUSED) {
+				return { .isUsed = false };
+			}
+			auto& attachment = plan.attachments[attachmentIndex];
+			return { .isUsed = true, .format = attachment.format, .sampleCount = attachment.sampleCount };
+		};
+		std::vector<VkSubpassDescription> subpassDescriptions;
+		for (uint32_t subpassIndex = 0; subpassIndex < plan.subpasses.size(); ++subpassIndex) {
+			auto& subpass = plan.subpasses[subpassIndex];
+			bool hasDepthStencil = subpass.depthStencilAttachment.attachment != VK_ATTACHMENT_UNUSED;
+			subpassDescriptions.push_back(
+				{ .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+				  .inputAttachmentCount = static_cast<uint32_t>(subpass.inputAttachments.size()),
+				  .pInputAttachments = subpass.inputAttachments.data(),
+				  .colorAttachmentCount = static_cast<uint32_t>(subpass.colorAttachments.size()),
+				  .pColorAttachments = subpass.colorAttachments.data(),
+				  .pDepthStencilAttachment = hasDepthStencil ? &subpass.depthStencilAttachment : nullptr,
+				  .preserveAttachmentCount = static_cast<uint32_t>(subpass.preserveAttachments.size()),
+				  .pPreserveAttachments = subpass.preserveAttachments.data() });
+
+			SubpassSignature subpassSignature = { .depthStencilAttachment = attachmentSignature(
+													  subpass.depthStencilAttachment.attachment) };
+			for (auto& reference : subpass.colorAttachments) {
+				subpassSignature.outputAttachments.push_back(attachmentSignature(reference.attachment));
+			}
+			for (auto& reference : subpass.inputAttachments) {
+				subpassSignature.inputAttachments.push_back(attachmentSignature(reference.attachment));
+			}
+			for (auto attachmentIndex : subpass.preserveAttachments) {
+				subpassSignature.preserveAttachments.push_back(attachmentSignature(attachmentIndex));
+			}
+			renderPass.signature.subpassSignatures.push_back(std::move(subpassSignature));
+
+			// Subpasses can use the attachments of any earlier subpass. Barriers between the merged nodes were
+			// removed, so these dependencies replace them.
+			for (uint32_t srcSubpassIndex = 0; srcSubpassIndex < subpassIndex; ++srcSubpassIndex) {
+				renderPass.signature.subpassDependencies.push_back(
+					{ .srcSubpass = srcSubpassIndex,
+					  .dstSubpass = subpassIndex,
+					  .srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+									  VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+									  VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT |
+									  VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+					  .dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+									  VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+									  VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT |
+									  VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+					  .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+									   VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+					  .dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+									   VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+									   VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+									   VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+					  .dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT });
+			}
+		}
+
+		auto& dependencies = renderPass.signature.subpassDependencies;
+		VkRenderPassCreateInfo createInfo = {
+			.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+			.attachmentCount = static_cast<uint32_t>(attachmentDescriptions.size()),
+			.pAttachments = attachmentDescriptions.data(),
+			.subpassCount = static_cast<uint32_t>(subpassDescriptions.size()),
+			.pSubpasses = subpassDescriptions.data(),
+			.dependencyCount = static_cast<uint32_t>(dependencies.size()),
+			.pDependencies = dependencies.data()
+		};
+		verifyResult(
+			vkCreateRenderPass(m_context.deviceContext->device(), &createInfo, nullptr, &renderPass.renderPass));
+		return renderPass;
+	}
+
+	void FramegraphContext::createFramebuffers(FramegraphRenderPass& renderPass, const MergedRenderPass& plan) {
+		auto sources = attachmentSources(plan);
+		uint32_t framebufferCount = renderPass.usesTarget ? m_context.targetSurface->currentImageCount() : 1;
+		for (uint32_t imageIndex = 0; imageIndex < framebufferCount; ++imageIndex) {
+			std::vector<VkImageView> attachmentViews;
+			attachmentViews.reserve(sources.size());
+			for (auto& [nodeIndex, attachment] : sources) {
+				attachmentViews.push_back(rasterAttachmentView(nodeIndex, attachment, imageIndex));
+			}
+			VkFramebufferCreateInfo framebufferCreateInfo = {
+				.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+				.renderPass = renderPass.renderPass,
+				.attachmentCount = static_cast<uint32_t>(attachmentViews.size()),
+				.pAttachments = attachmentViews.data(),
+				.width = plan.width,
+				.height = plan.height,
+				.layers = 1
+			};
+			VkFramebuffer framebuffer;
+			verifyResult(vkCreateFramebuffer(m_context.deviceContext->device(), &framebufferCreateInfo, nullptr,
+											 &framebuffer));
+			renderPass.framebuffers.push_back(framebuffer);
+		}
+	}
+
+	void FramegraphContext::destroyRenderPasses(std::vector<FramegraphRenderPass>& renderPasses) {
+		for (auto& renderPass : renderPasses) {
+			for (auto& framebuffer : renderPass.framebuffers) {
+				vkDestroyFramebuffer(m_context.deviceContext->device(), framebuffer, nullptr);
+			}
+			if (renderPass.renderPass == VK_NULL_HANDLE) {
+				continue;
+			}
+			// Nodes may have registered the pass for pipeline creation in afterResourceInit
+			m_context.pipelineLibrary->removePass(renderPass.renderPass);
+			vkDestroyRenderPass(m_context.deviceContext->device(), renderPass.renderPass, nullptr);
+		}
+		renderPasses.clear();
 	}
 
 	void FramegraphContext::updateDependencyInfo() {
 		m_barrierGenerator.create(m_nodes.size());
+		m_hasReleasedOwnership = false;
+
+		// Culling and queue assignment are cheap and derived from the key, so only the results depending on them
+		// are cached
+		m_compilationKey = compilationKey();
+		if (auto compilation = m_compilationCache.find(m_compilationKey); compilation.has_value()) {
+			m_barrierGenerator.restoreDependencyInfo(compilation->dependencyInfo);
+			m_recordingSegments = std::move(compilation->recordingSegments);
+			m_segmentBatchIndices = std::move(compilation->segmentBatchIndices);
+			m_firstQueueSegmentIndices = compilation->firstQueueSegmentIndices;
+			m_lastGraphicsSegmentIndex = compilation->lastGraphicsSegmentIndex;
+			m_parallelSegmentIndices = std::move(compilation->parallelSegmentIndices);
+			return;
+		}
+
 		m_barrierGenerator.generateDependencyInfo();
+
+		auto& schedule = m_barrierGenerator.queueSchedule();
+		m_recordingSegments.clear();
+		m_segmentBatchIndices.clear();
+		m_firstQueueSegmentIndices.fill(~0ULL);
+		for (size_t batchIndex = 0; batchIndex < schedule.batches.size(); ++batchIndex) {
+			auto& batch = schedule.batches[batchIndex];
+			std::vector<bool> recordsInParallel;
+			recordsInParallel.reserve(batch.nodeCount);
+			for (size_t nodeIndex = batch.firstNodeIndex; nodeIndex < batch.firstNodeIndex + batch.nodeCount;
+				 ++nodeIndex) {
+				recordsInParallel.push_back(!isNodeCulled(nodeIndex) &&
+											m_nodes[nodeIndex].node->recordsInParallel());
+			}
+
+			auto& firstQueueSegmentIndex = m_firstQueueSegmentIndices[static_cast<size_t>(batch.queue)];
+			if (firstQueueSegmentIndex == ~0ULL) {
+				firstQueueSegmentIndex = m_recordingSegments.size();
+			}
+			for (auto segment : planRecordingSegments(recordsInParallel)) {
+				segment.firstNodeIndex += batch.firstNodeIndex;
+				m_recordingSegments.push_back(segment);
+				m_segmentBatchIndices.push_back(batchIndex);
+			}
+			if (batch.queue == FramegraphQueue::Graphics) {
+				m_lastGraphicsSegmentIndex = m_recordingSegments.size() - 1;
+			}
+		}
+		m_parallelSegmentIndices.clear();
+		for (size_t i = 0; i < m_recordingSegments.size(); ++i) {
+			if (m_recordingSegments[i].isParallel) {
+				m_parallelSegmentIndices.push_back(i);
+			}
+		}
+
+		m_compilationCache.insert(m_compilationKey, { .dependencyInfo = m_barrierGenerator.dependencyInfo(),
+													  .recordingSegments = m_recordingSegments,
+													  .segmentBatchIndices = m_segmentBatchIndices,
+													  .firstQueueSegmentIndices = m_firstQueueSegmentIndices,
+													  .lastGraphicsSegmentIndex = m_lastGraphicsSegmentIndex,
+													  .parallelSegmentIndices = m_parallelSegmentIndices });
 	}
 
 	void FramegraphContext::updateBarriers() {
 		m_barrierGenerator.generateBarrierInfo(&FramegraphContext::nativeBufferHandle,
 											   &FramegraphContext::nativeImageHandle, this,
-											   m_context.targetSurface->currentTargetImage());
+											   m_context.targetSurface->currentTargetImage(), m_hasReleasedOwnership);
 	}
 } // namespace vanadium::graphics
\ No newline at end of file
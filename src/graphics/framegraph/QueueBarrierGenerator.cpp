@@ -31,6 +31,171 @@ template <typename T, T fullRangeValue> bool isCompletelyContained(T offset1, T
 }
 
 namespace vanadium::graphics {
+	namespace {
+		// Accesses with any of these flags depend on the previous contents of the resource
+		constexpr VkAccessFlags readAccessFlags =
+			VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+			VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_INPUT_ATTACHMENT_READ_BIT | VK_ACCESS_SHADER_READ_BIT |
+			VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+			VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_HOST_READ_BIT | VK_ACCESS_MEMORY_READ_BIT;
+
+		// Setting and waiting for an event costs more than a barrier, a single node in between rarely has enough work
+		// to make up for it
+		constexpr size_t splitBarrierMinIndependentNodeCount = 2;
+
+		struct AliasingSourceScope {
+			// The last node accessing any of the predecessors
+			size_t nodeIndex = 0;
+			VkPipelineStageFlags stageFlags = 0;
+			VkAccessFlags accessFlags = 0;
+		};
+
+		struct NodeAccessScope {
+			VkPipelineStageFlags stageFlags = 0;
+			VkAccessFlags accessFlags = 0;
+		};
+
+		template <typename AccessInfo> bool readsBeforeWriting(const AccessInfo& info) {
+			size_t firstReadIndex = ~0ULL;
+			size_t firstModificationIndex = ~0ULL;
+			for (auto& access : info.reads) {
+				firstReadIndex = std::min(firstReadIndex, access.nodeIndex);
+			}
+			for (auto& access : info.modifications) {
+				firstModificationIndex = std::min(firstModificationIndex, access.nodeIndex);
+			}
+			return firstReadIndex < firstModificationIndex;
+		}
+
+		template <typename AccessInfo>
+		bool isAccessedOutsideGraphicsQueue(const AccessInfo& info, const QueueBarrierGenerator& generator) {
+			auto isOutside = [&generator](const auto& access) {
+				return generator.nodeQueue(access.nodeIndex) != FramegraphQueue::Graphics;
+			};
+			return std::any_of(info.reads.begin(), info.reads.end(), isOutside) ||
+				   std::any_of(info.modifications.begin(), info.modifications.end(), isOutside);
+		}
+
+		// True if the resource is accessed on another queue between the two nodes, or the nodes are on different
+		// queues. Ownership of the resource is transferred then, and the acquiring barrier replaces other barriers.
+		template <typename AccessInfo>
+		bool isSeparatedByQueueTransfer(const AccessInfo& info, const QueueBarrierGenerator& generator,
+										size_t srcNodeIndex, size_t dstNodeIndex) {
+			FramegraphQueue queue = generator.nodeQueue(srcNodeIndex);
+			if (generator.nodeQueue(dstNodeIndex) != queue) {
+				return true;
+			}
+			auto isSeparating = [&generator, queue, srcNodeIndex, dstNodeIndex](const auto& access) {
+				return access.nodeIndex > srcNodeIndex && access.nodeIndex < dstNodeIndex &&
+					   generator.nodeQueue(access.nodeIndex) != queue;
+			};
+			return std::any_of(info.reads.begin(), info.reads.end(), isSeparating) ||
+				   std::any_of(info.modifications.begin(), info.modifications.end(), isSeparating);
+		}
+
+		template <typename AccessInfo> NodeAccessScope nodeAccessScope(const AccessInfo& info, size_t nodeIndex) {
+			NodeAccessScope scope;
+			for (auto& access : info.reads) {
+				if (access.nodeIndex == nodeIndex) {
+					scope.stageFlags |= access.accessingPipelineStages;
+					scope.accessFlags |= access.access;
+				}
+			}
+			for (auto& access : info.modifications) {
+				if (access.nodeIndex == nodeIndex) {
+					scope.stageFlags |= access.accessingPipelineStages;
+					scope.accessFlags |= access.access;
+				}
+			}
+			return scope;
+		}
+
+		template <typename AccessInfo> QueueScheduledResource scheduledResource(const AccessInfo& info,
+																				 bool preservesContents) {
+			QueueScheduledResource resource = { .preservesContents = preservesContents };
+			for (auto& access : info.reads) {
+				resource.accessingNodeIndices.push_back(access.nodeIndex);
+			}
+			for (auto& access : info.modifications) {
+				resource.accessingNodeIndices.push_back(access.nodeIndex);
+			}
+			auto& nodeIndices = resource.accessingNodeIndices;
+			std::sort(nodeIndices.begin(), nodeIndices.end());
+			nodeIndices.erase(std::unique(nodeIndices.begin(), nodeIndices.end()), nodeIndices.end());
+			return resource;
+		}
+
+		bool rangesEqual(const VkImageSubresourceRange& one, const VkImageSubresourceRange& other) {
+			return one.aspectMask == other.aspectMask && one.baseMipLevel == other.baseMipLevel &&
+				   one.levelCount == other.levelCount && one.baseArrayLayer == other.baseArrayLayer &&
+				   one.layerCount == other.layerCount;
+		}
+
+		// Resources whose contents are read before they are written in a frame need to keep them from the previous
+		// frame, so they are in use during the entire frame.
+		template <typename AccessInfo>
+		std::optional<ResourceLifetime> accessLifetime(const AccessInfo& info, size_t nodeCount,
+													   bool preserveAcrossFrames) {
+			if (info.reads.empty() && info.modifications.empty()) {
+				return std::nullopt;
+			}
+			ResourceLifetime lifetime = { .firstNodeIndex = ~0ULL, .lastNodeIndex = 0 };
+			for (auto& access : info.reads) {
+				lifetime.firstNodeIndex = std::min(lifetime.firstNodeIndex, access.nodeIndex);
+				lifetime.lastNodeIndex = std::max(lifetime.lastNodeIndex, access.nodeIndex);
+			}
+			for (auto& access : info.modifications) {
+				lifetime.firstNodeIndex = std::min(lifetime.firstNodeIndex, access.nodeIndex);
+				lifetime.lastNodeIndex = std::max(lifetime.lastNodeIndex, access.nodeIndex);
+			}
+			if (preserveAcrossFrames || readsBeforeWriting(info)) {
+				lifetime = { .firstNodeIndex = 0, .lastNodeIndex = std::max(nodeCount, size_t(1)) - 1 };
+			}
+			return lifetime;
+		}
+
+		// The accesses of the predecessors' last nodes. Writes in earlier nodes were already made available by the
+		// barriers to these accesses, reads only need an execution dependency.
+		template <typename AccessInfoMap>
+		std::optional<AliasingSourceScope> aliasingSourceScope(const std::vector<SlotmapHandle>& predecessors,
+															   const AccessInfoMap& accessInfos) {
+			std::optional<AliasingSourceScope> scope;
+			for (auto predecessor : predecessors) {
+				auto infoIterator = accessInfos.find(predecessor);
+				if (infoIterator == accessInfos.end()) {
+					continue;
+				}
+				auto& info = infoIterator->second;
+				if (info.reads.empty() && info.modifications.empty()) {
+					continue;
+				}
+				if (!scope.has_value()) {
+					scope = AliasingSourceScope();
+				}
+				size_t lastNodeIndex = 0;
+				for (auto& read : info.reads) {
+					lastNodeIndex = std::max(lastNodeIndex, read.nodeIndex);
+				}
+				for (auto& modification : info.modifications) {
+					lastNodeIndex = std::max(lastNodeIndex, modification.nodeIndex);
+				}
+				scope->nodeIndex = std::max(scope->nodeIndex, lastNodeIndex);
+				for (auto& read : info.reads) {
+					if (read.nodeIndex == lastNodeIndex) {
+						scope->stageFlags |= read.accessingPipelineStages;
+					}
+				}
+				for (auto& modification : info.modifications) {
+					if (modification.nodeIndex == lastNodeIndex) {
+						scope->stageFlags |= modification.accessingPipelineStages;
+						scope->accessFlags |= modification.access;
+					}
+				}
+			}
+			return scope;
+		}
+	} // namespace
+
 	void QueueBarrierGenerator::create(size_t nodeCount) { m_nodeBarrierInfos.resize(nodeCount); }
 
 	void QueueBarrierGenerator::addNodeBufferAccess(size_t nodeIndex, const NodeBufferAccess& bufferAccess) {
@@ -231,14 +396,173 @@ namespace vanadium::graphics {
 		return result;
 	}
 
+	std::vector<NodeResourceUsage> QueueBarrierGenerator::nodeResourceUsages(
+		const std::vector<SlotmapHandle>& transientBuffers, const std::vector<SlotmapHandle>& transientImages) const {
+		std::vector<NodeResourceUsage> usages(m_nodeBarrierInfos.size());
+		// Images and buffers use different slotmaps, so image handles are moved out of the range of buffer handles
+		auto imageResource = [](SlotmapHandle image) { return (1ULL << 32) | image; };
+
+		for (auto& [handle, info] : m_bufferAccessInfos) {
+			bool isTransient = std::find(transientBuffers.begin(), transientBuffers.end(), handle) !=
+							   transientBuffers.end();
+			for (auto& read : info.reads) {
+				usages[read.nodeIndex].readResources.push_back(handle);
+			}
+			for (auto& modification : info.modifications) {
+				if (modification.access & readAccessFlags) {
+					usages[modification.nodeIndex].readResources.push_back(handle);
+				}
+				usages[modification.nodeIndex].writtenResources.push_back(handle);
+				usages[modification.nodeIndex].hasExternalEffects |= !isTransient;
+			}
+		}
+		for (auto& [handle, info] : m_imageAccessInfos) {
+			bool isTransient =
+				std::find(transientImages.begin(), transientImages.end(), handle) != transientImages.end();
+			for (auto& read : info.reads) {
+				usages[read.nodeIndex].readResources.push_back(imageResource(handle));
+			}
+			for (auto& modification : info.modifications) {
+				if (modification.access & readAccessFlags) {
+					usages[modification.nodeIndex].readResources.push_back(imageResource(handle));
+				}
+				usages[modification.nodeIndex].writtenResources.push_back(imageResource(handle));
+				usages[modification.nodeIndex].hasExternalEffects |= !isTransient;
+			}
+		}
+		for (auto& modification : m_targetAccessInfo.modifications) {
+			usages[modification.nodeIndex].hasExternalEffects = true;
+		}
+		return usages;
+	}
+
+	bool QueueBarrierGenerator::accessesTarget(size_t nodeIndex) const {
+		auto isNodeAccess = [nodeIndex](const auto& access) { return access.nodeIndex == nodeIndex; };
+		return std::any_of(m_targetAccessInfo.reads.begin(), m_targetAccessInfo.reads.end(), isNodeAccess) ||
+			   std::any_of(m_targetAccessInfo.modifications.begin(), m_targetAccessInfo.modifications.end(),
+						   isNodeAccess);
+	}
+
+	void QueueBarrierGenerator::setCulledNodes(const std::vector<bool>& isNodeCulled) {
+		m_isNodeCulled = isNodeCulled;
+		updateActiveAccessInfos();
+	}
+
+	void QueueBarrierGenerator::updateActiveAccessInfos() {
+		auto isActive = [this](const auto& access) {
+			return access.nodeIndex >= m_isNodeCulled.size() || !m_isNodeCulled[access.nodeIndex];
+		};
+		auto copyActiveAccesses = [&isActive](const auto& accesses, auto& activeAccesses) {
+			activeAccesses.clear();
+			std::copy_if(accesses.begin(), accesses.end(), std::back_inserter(activeAccesses), isActive);
+		};
+
+		m_activeBufferAccessInfos.clear();
+		for (auto& [handle, info] : m_bufferAccessInfos) {
+			BufferAccessInfo activeInfo;
+			copyActiveAccesses(info.reads, activeInfo.reads);
+			copyActiveAccesses(info.modifications, activeInfo.modifications);
+			if (!activeInfo.reads.empty() || !activeInfo.modifications.empty()) {
+				m_activeBufferAccessInfos.insert({ handle, std::move(activeInfo) });
+			}
+		}
+		m_activeImageAccessInfos.clear();
+		for (auto& [handle, info] : m_imageAccessInfos) {
+			ImageAccessInfo activeInfo = { .preserveAcrossFrames = info.preserveAcrossFrames,
+										   .initialLayout = info.initialLayout,
+										   .isNew = info.isNew };
+			copyActiveAccesses(info.reads, activeInfo.reads);
+			copyActiveAccesses(info.modifications, activeInfo.modifications);
+			if (!activeInfo.reads.empty() || !activeInfo.modifications.empty()) {
+				m_activeImageAccessInfos.insert({ handle, std::move(activeInfo) });
+			}
+		}
+		m_activeTargetAccessInfo = { .preserveAcrossFrames = m_targetAccessInfo.preserveAcrossFrames,
+									 .initialLayout = m_targetAccessInfo.initialLayout,
+									 .isNew = m_targetAccessInfo.isNew };
+		copyActiveAccesses(m_targetAccessInfo.reads, m_activeTargetAccessInfo.reads);
+		copyActiveAccesses(m_targetAccessInfo.modifications, m_activeTargetAccessInfo.modifications);
+	}
+
+	std::optional<ResourceLifetime> QueueBarrierGenerator::bufferLifetime(SlotmapHandle buffer) const {
+		auto iterator = m_activeBufferAccessInfos.find(buffer);
+		if (iterator == m_activeBufferAccessInfos.end()) {
+			return std::nullopt;
+		}
+		auto lifetime = accessLifetime(iterator->second, m_nodeBarrierInfos.size(),
+									   isAccessedOutsideGraphicsQueue(iterator->second, *this));
+		return extendOverMergedRanges(lifetime.value());
+	}
+
+	std::optional<ResourceLifetime> QueueBarrierGenerator::imageLifetime(SlotmapHandle image) const {
+		auto iterator = m_activeImageAccessInfos.find(image);
+		if (iterator == m_activeImageAccessInfos.end()) {
+			return std::nullopt;
+		}
+		auto lifetime = accessLifetime(iterator->second, m_nodeBarrierInfos.size(),
+									   iterator->second.preserveAcrossFrames ||
+										   isAccessedOutsideGraphicsQueue(iterator->second, *this));
+		return extendOverMergedRanges(lifetime.value());
+	}
+
+	// Aliasing barriers can't be recorded inside a render pass
+	ResourceLifetime QueueBarrierGenerator::extendOverMergedRanges(ResourceLifetime lifetime) const {
+		for (auto& range : m_mergedNodeRanges) {
+			if (range.firstNodeIndex <= lifetime.lastNodeIndex && range.lastNodeIndex >= lifetime.firstNodeIndex) {
+				lifetime.firstNodeIndex = std::min(lifetime.firstNodeIndex, range.firstNodeIndex);
+				lifetime.lastNodeIndex = std::max(lifetime.lastNodeIndex, range.lastNodeIndex);
+			}
+		}
+		return lifetime;
+	}
+
+	void QueueBarrierGenerator::setNodeQueues(const std::vector<FramegraphQueue>& nodeQueues,
+											  const std::array<uint32_t, framegraphQueueCount>& queueFamilyIndices) {
+		m_nodeQueues = nodeQueues;
+		m_queueFamilyIndices = queueFamilyIndices;
+	}
+
+	bool QueueBarrierGenerator::usesAsyncQueues() const {
+		return std::any_of(m_nodeQueues.begin(), m_nodeQueues.end(),
+						   [](auto queue) { return queue != FramegraphQueue::Graphics; });
+	}
+
+	size_t QueueBarrierGenerator::nextNodeOnQueue(size_t nodeIndex) const {
+		for (size_t nextNodeIndex = nodeIndex + 1; nextNodeIndex < m_nodeBarrierInfos.size(); ++nextNodeIndex) {
+			if (nodeQueue(nextNodeIndex) == nodeQueue(nodeIndex)) {
+				return nextNodeIndex;
+			}
+		}
+		return m_nodeBarrierInfos.size();
+	}
+
+	void QueueBarrierGenerator::setAliases(const std::vector<ResourceAlias>& bufferAliases,
+										   const std::vector<ResourceAlias>& imageAliases) {
+		m_bufferAliasPredecessors.clear();
+		m_imageAliasPredecessors.clear();
+		for (auto& alias : bufferAliases) {
+			m_bufferAliasPredecessors[alias.next].push_back(alias.previous);
+		}
+		for (auto& alias : imageAliases) {
+			m_imageAliasPredecessors[alias.next].push_back(alias.previous);
+		}
+	}
+
 	void QueueBarrierGenerator::generateDependencyInfo() {
 		for (auto& nodeInfo : m_nodeBarrierInfos) {
 			nodeInfo.bufferBarriers.clear();
 			nodeInfo.imageBarriers.clear();
+			nodeInfo.acquireBufferBarriers.clear();
+			nodeInfo.acquireImageBarriers.clear();
+			nodeInfo.setSplitBarrierIndices.clear();
+			nodeInfo.waitSplitBarrierIndices.clear();
 		}
 		m_frameStartImageBarriers.clear();
+		m_splitBarriers.clear();
 
-		for (auto& buffer : m_bufferAccessInfos) {
+		updateActiveAccessInfos();
+
+		for (auto& buffer : m_activeBufferAccessInfos) {
 			std::sort(buffer.second.reads.begin(), buffer.second.reads.end());
 			std::sort(buffer.second.modifications.begin(), buffer.second.modifications.end());
 
@@ -249,7 +573,7 @@ namespace vanadium::graphics {
 				emitBarriersForRead(write.nodeIndex, buffer.first, buffer.second, write);
 			}
 		}
-		for (auto& image : m_imageAccessInfos) {
+		for (auto& image : m_activeImageAccessInfos) {
 			std::sort(image.second.reads.begin(), image.second.reads.end());
 			std::sort(image.second.modifications.begin(), image.second.modifications.end());
 
@@ -261,16 +585,19 @@ namespace vanadium::graphics {
 			}
 		}
 
-		std::sort(m_targetAccessInfo.reads.begin(), m_targetAccessInfo.reads.end());
-		std::sort(m_targetAccessInfo.modifications.begin(), m_targetAccessInfo.modifications.end());
+		std::sort(m_activeTargetAccessInfo.reads.begin(), m_activeTargetAccessInfo.reads.end());
+		std::sort(m_activeTargetAccessInfo.modifications.begin(), m_activeTargetAccessInfo.modifications.end());
 
-		for (auto& read : m_targetAccessInfo.reads) {
-			emitBarriersForRead(read.nodeIndex, std::nullopt, m_targetAccessInfo, read);
+		for (auto& read : m_activeTargetAccessInfo.reads) {
+			emitBarriersForRead(read.nodeIndex, std::nullopt, m_activeTargetAccessInfo, read);
 		}
-		for (auto& write : m_targetAccessInfo.modifications) {
-			emitBarriersForRead(write.nodeIndex, std::nullopt, m_targetAccessInfo, write);
+		for (auto& write : m_activeTargetAccessInfo.modifications) {
+			emitBarriersForRead(write.nodeIndex, std::nullopt, m_activeTargetAccessInfo, write);
 		}
 
+		removeSubpassBarriers();
+		splitDistantBarriers();
+
 		size_t nodeIndex = 0;
 		for (auto& info : m_nodeBarrierInfos) {
 			size_t firstDstNodeIndex = m_nodeBarrierInfos.size();
@@ -280,46 +607,426 @@ namespace vanadium::graphics {
 			for (auto& imageBarrier : info.imageBarriers) {
 				firstDstNodeIndex = std::min(firstDstNodeIndex, imageBarrier.dstNodeIndex);
 			}
-			if (firstDstNodeIndex > nodeIndex + 1) {
+			// Barriers are recorded on the queue of the node they are placed after
+			size_t nextNodeIndex = nextNodeOnQueue(nodeIndex);
+			if (nextNodeIndex < m_nodeBarrierInfos.size() && firstDstNodeIndex > nextNodeIndex) {
 				// move barriers into next node
-				m_nodeBarrierInfos[nodeIndex + 1].bufferBarriers.insert(
-					m_nodeBarrierInfos[nodeIndex + 1].bufferBarriers.end(),
+				m_nodeBarrierInfos[nextNodeIndex].bufferBarriers.insert(
+					m_nodeBarrierInfos[nextNodeIndex].bufferBarriers.end(),
 					std::make_move_iterator(info.bufferBarriers.begin()),
 					std::make_move_iterator(info.bufferBarriers.end()));
 				info.bufferBarriers.clear();
 
-				m_nodeBarrierInfos[nodeIndex + 1].imageBarriers.insert(
-					m_nodeBarrierInfos[nodeIndex + 1].imageBarriers.end(),
+				m_nodeBarrierInfos[nextNodeIndex].imageBarriers.insert(
+					m_nodeBarrierInfos[nextNodeIndex].imageBarriers.end(),
 					std::make_move_iterator(info.imageBarriers.begin()),
 					std::make_move_iterator(info.imageBarriers.end()));
 				info.imageBarriers.clear();
 			}
 			++nodeIndex;
 		}
+
+		generateQueueTransfers();
+		moveTransfersOutOfMergedRanges();
+	}
+
+	void QueueBarrierGenerator::removeSubpassBarriers() {
+		for (auto& range : m_mergedNodeRanges) {
+			auto isInRange = [&range](size_t nodeIndex) {
+				return nodeIndex >= range.firstNodeIndex && nodeIndex <= range.lastNodeIndex;
+			};
+			// Barriers are still placed at their source node. The merging rules only allow attachment dependencies
+			// between subpasses, which the subpass dependencies cover.
+			for (size_t nodeIndex = 0; nodeIndex < m_nodeBarrierInfos.size(); ++nodeIndex) {
+				auto& info = m_nodeBarrierInfos[nodeIndex];
+				auto isSubpassBarrier = [nodeIndex, &isInRange](const auto& barrier) {
+					return isInRange(nodeIndex) && isInRange(barrier.dstNodeIndex);
+				};
+				std::erase_if(info.bufferBarriers, isSubpassBarrier);
+				std::erase_if(info.imageBarriers, isSubpassBarrier);
+
+				auto moveToRangeStart = [&range, &isInRange](auto& barrier) {
+					if (isInRange(barrier.dstNodeIndex)) {
+						barrier.dstNodeIndex = range.firstNodeIndex;
+					}
+				};
+				std::for_each(info.bufferBarriers.begin(), info.bufferBarriers.end(), moveToRangeStart);
+				std::for_each(info.imageBarriers.begin(), info.imageBarriers.end(), moveToRangeStart);
+			}
+
+			// The remaining barriers of nodes in the range have destinations after it
+			auto& lastInfo = m_nodeBarrierInfos[range.lastNodeIndex];
+			for (size_t nodeIndex = range.firstNodeIndex; nodeIndex < range.lastNodeIndex; ++nodeIndex) {
+				auto& info = m_nodeBarrierInfos[nodeIndex];
+				lastInfo.bufferBarriers.insert(lastInfo.bufferBarriers.end(), info.bufferBarriers.begin(),
+											   info.bufferBarriers.end());
+				lastInfo.imageBarriers.insert(lastInfo.imageBarriers.end(), info.imageBarriers.begin(),
+											  info.imageBarriers.end());
+				info.bufferBarriers.clear();
+				info.imageBarriers.clear();
+			}
+		}
+	}
+
+	void QueueBarrierGenerator::moveTransfersOutOfMergedRanges() {
+		for (auto& range : m_mergedNodeRanges) {
+			auto& firstInfo = m_nodeBarrierInfos[range.firstNodeIndex];
+			auto& lastInfo = m_nodeBarrierInfos[range.lastNodeIndex];
+			for (size_t nodeIndex = range.firstNodeIndex + 1; nodeIndex <= range.lastNodeIndex; ++nodeIndex) {
+				auto& info = m_nodeBarrierInfos[nodeIndex];
+				firstInfo.acquireBufferBarriers.insert(firstInfo.acquireBufferBarriers.end(),
+													   info.acquireBufferBarriers.begin(),
+													   info.acquireBufferBarriers.end());
+				firstInfo.acquireImageBarriers.insert(firstInfo.acquireImageBarriers.end(),
+													  info.acquireImageBarriers.begin(),
+													  info.acquireImageBarriers.end());
+				info.acquireBufferBarriers.clear();
+				info.acquireImageBarriers.clear();
+			}
+			for (size_t nodeIndex = range.firstNodeIndex; nodeIndex < range.lastNodeIndex; ++nodeIndex) {
+				auto& info = m_nodeBarrierInfos[nodeIndex];
+				lastInfo.bufferBarriers.insert(lastInfo.bufferBarriers.end(), info.bufferBarriers.begin(),
+											   info.bufferBarriers.end());
+				lastInfo.imageBarriers.insert(lastInfo.imageBarriers.end(), info.imageBarriers.begin(),
+											  info.imageBarriers.end());
+				info.bufferBarriers.clear();
+				info.imageBarriers.clear();
+			}
+		}
+	}
+
+	void QueueBarrierGenerator::splitDistantBarriers() {
+		std::vector<FramegraphQueue> nodeQueues;
+		std::vector<SplitBarrierCandidate> candidates;
+		nodeQueues.reserve(m_nodeBarrierInfos.size());
+		for (size_t nodeIndex = 0; nodeIndex < m_nodeBarrierInfos.size(); ++nodeIndex) {
+			nodeQueues.push_back(nodeQueue(nodeIndex));
+			for (auto& barrier : m_nodeBarrierInfos[nodeIndex].bufferBarriers) {
+				candidates.push_back({ .srcNodeIndex = nodeIndex, .dstNodeIndex = barrier.dstNodeIndex });
+			}
+			for (auto& barrier : m_nodeBarrierInfos[nodeIndex].imageBarriers) {
+				candidates.push_back({ .srcNodeIndex = nodeIndex, .dstNodeIndex = barrier.dstNodeIndex });
+			}
+		}
+		auto isSplit = selectSplitBarriers(candidates, nodeQueues, m_isNodeCulled, splitBarrierMinIndependentNodeCount);
+
+		size_t candidateIndex = 0;
+		for (size_t nodeIndex = 0; nodeIndex < m_nodeBarrierInfos.size(); ++nodeIndex) {
+			auto& info = m_nodeBarrierInfos[nodeIndex];
+			// Barriers to the same destination node share an event
+			auto splitBarrierIndex = [this, &info, nodeIndex](size_t dstNodeIndex) {
+				for (auto index : info.setSplitBarrierIndices) {
+					if (m_splitBarriers[index].dstNodeIndex == dstNodeIndex) {
+						return index;
+					}
+				}
+				size_t index = m_splitBarriers.size();
+				m_splitBarriers.push_back({ .srcNodeIndex = nodeIndex, .dstNodeIndex = dstNodeIndex });
+				info.setSplitBarrierIndices.push_back(index);
+				m_nodeBarrierInfos[dstNodeIndex].waitSplitBarrierIndices.push_back(index);
+				return index;
+			};
+
+			std::vector<BufferFramegraphBarrier> bufferBarriers;
+			for (auto& barrier : info.bufferBarriers) {
+				if (isSplit[candidateIndex++]) {
+					m_splitBarriers[splitBarrierIndex(barrier.dstNodeIndex)].bufferBarriers.push_back(barrier);
+				} else {
+					bufferBarriers.push_back(barrier);
+				}
+			}
+			info.bufferBarriers = std::move(bufferBarriers);
+
+			std::vector<ImageFramegraphBarrier> imageBarriers;
+			for (auto& barrier : info.imageBarriers) {
+				if (isSplit[candidateIndex++]) {
+					m_splitBarriers[splitBarrierIndex(barrier.dstNodeIndex)].imageBarriers.push_back(barrier);
+				} else {
+					imageBarriers.push_back(barrier);
+				}
+			}
+			info.imageBarriers = std::move(imageBarriers);
+		}
+	}
+
+	void QueueBarrierGenerator::generateQueueTransfers() {
+		std::vector<FramegraphQueue> nodeQueues;
+		nodeQueues.reserve(m_nodeBarrierInfos.size());
+		for (size_t nodeIndex = 0; nodeIndex < m_nodeBarrierInfos.size(); ++nodeIndex) {
+			nodeQueues.push_back(nodeQueue(nodeIndex));
+		}
+		if (!usesAsyncQueues()) {
+			m_queueSchedule = planQueueSchedule(nodeQueues, {});
+			return;
+		}
+
+		// Frame start barriers are recorded on the graphics queue, the other queues transition their images before
+		// the first node using them
+		std::vector<ImageFramegraphBarrier> graphicsFrameStartBarriers;
+		for (auto& barrier : m_frameStartImageBarriers) {
+			if (nodeQueue(barrier.dstNodeIndex) == FramegraphQueue::Graphics) {
+				graphicsFrameStartBarriers.push_back(barrier);
+			} else {
+				auto acquireBarrier = barrier;
+				acquireBarrier.isFrameStart = true;
+				m_nodeBarrierInfos[barrier.dstNodeIndex].acquireImageBarriers.push_back(acquireBarrier);
+			}
+		}
+		m_frameStartImageBarriers = std::move(graphicsFrameStartBarriers);
+
+		std::vector<QueueScheduledResource> resources;
+		std::vector<SlotmapHandle> scheduledBuffers;
+		std::vector<SlotmapHandle> scheduledImages;
+		for (auto& [handle, info] : m_activeBufferAccessInfos) {
+			resources.push_back(scheduledResource(info, readsBeforeWriting(info)));
+			scheduledBuffers.push_back(handle);
+		}
+		// Images that don't preserve their contents are transitioned from the undefined layout at frame start
+		for (auto& [handle, info] : m_activeImageAccessInfos) {
+			resources.push_back(scheduledResource(info, info.preserveAcrossFrames));
+			scheduledImages.push_back(handle);
+		}
+
+		m_queueSchedule = planQueueSchedule(nodeQueues, resources);
+		for (auto& transfer : m_queueSchedule.ownershipTransfers) {
+			if (transfer.resourceIndex < scheduledBuffers.size()) {
+				auto buffer = scheduledBuffers[transfer.resourceIndex];
+				emitOwnershipTransfer(buffer, m_activeBufferAccessInfos.find(buffer)->second, transfer);
+			} else {
+				auto image = scheduledImages[transfer.resourceIndex - scheduledBuffers.size()];
+				emitOwnershipTransfer(image, m_activeImageAccessInfos.find(image)->second, transfer);
+			}
+		}
+	}
+
+	void QueueBarrierGenerator::emitOwnershipTransfer(SlotmapHandle buffer, const BufferAccessInfo& info,
+													  const QueueOwnershipTransfer& transfer) {
+		auto srcScope = nodeAccessScope(info, transfer.srcNodeIndex);
+		auto dstScope = nodeAccessScope(info, transfer.dstNodeIndex);
+		FramegraphQueue srcQueue = nodeQueue(transfer.srcNodeIndex);
+		FramegraphQueue dstQueue = nodeQueue(transfer.dstNodeIndex);
+
+		m_nodeBarrierInfos[transfer.srcNodeIndex].bufferBarriers.push_back(
+			{ .dstNodeIndex = transfer.dstNodeIndex,
+			  .srcPipelineStageFlags = srcScope.stageFlags,
+			  .dstPipelineStageFlags = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			  .srcAccessFlags = srcScope.accessFlags,
+			  .dstAccessFlags = 0,
+			  .offset = 0,
+			  .size = VK_WHOLE_SIZE,
+			  .buffer = buffer,
+			  .srcQueue = srcQueue,
+			  .dstQueue = dstQueue,
+			  .crossesFrame = transfer.crossesFrame });
+		m_nodeBarrierInfos[transfer.dstNodeIndex].acquireBufferBarriers.push_back(
+			{ .dstNodeIndex = transfer.dstNodeIndex,
+			  .srcPipelineStageFlags = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			  .dstPipelineStageFlags = dstScope.stageFlags,
+			  .srcAccessFlags = 0,
+			  .dstAccessFlags = dstScope.accessFlags,
+			  .offset = 0,
+			  .size = VK_WHOLE_SIZE,
+			  .buffer = buffer,
+			  .srcQueue = srcQueue,
+			  .dstQueue = dstQueue,
+			  .crossesFrame = transfer.crossesFrame });
+	}
+
+	void QueueBarrierGenerator::emitOwnershipTransfer(SlotmapHandle image, const ImageAccessInfo& info,
+													  const QueueOwnershipTransfer& transfer) {
+		// The acquiring node's frame start transitions either become the acquire of the previous frame's release, or
+		// are replaced by the acquire of this frame's release
+		std::vector<ImageFramegraphBarrier> frameStartBarriers;
+		auto isReplaced = [&image, &transfer](const auto& barrier) {
+			return barrier.image == image && barrier.dstNodeIndex == transfer.dstNodeIndex;
+		};
+		auto& acquireBarriers = m_nodeBarrierInfos[transfer.dstNodeIndex].acquireImageBarriers;
+		std::copy_if(m_frameStartImageBarriers.begin(), m_frameStartImageBarriers.end(),
+					 std::back_inserter(frameStartBarriers), isReplaced);
+		std::copy_if(acquireBarriers.begin(), acquireBarriers.end(), std::back_inserter(frameStartBarriers),
+					 isReplaced);
+		std::erase_if(m_frameStartImageBarriers, isReplaced);
+		std::erase_if(acquireBarriers, isReplaced);
+
+		std::vector<ImageFramegraphBarrier> transferBarriers;
+		if (transfer.crossesFrame) {
+			for (auto& barrier : frameStartBarriers) {
+				transferBarriers.push_back(barrier);
+				transferBarriers.back().crossesFrame = true;
+				transferBarriers.back().isFrameStart = true;
+			}
+		} else {
+			// Assumes the releasing node leaves all subresources it accessed in the same layout
+			VkImageLayout releaseLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			for (auto& access : info.reads) {
+				if (access.nodeIndex == transfer.srcNodeIndex) {
+					releaseLayout = access.finishLayout;
+				}
+			}
+			for (auto& access : info.modifications) {
+				if (access.nodeIndex == transfer.srcNodeIndex) {
+					releaseLayout = access.finishLayout;
+				}
+			}
+
+			auto addAcquire = [&transferBarriers, &image, releaseLayout](const ImageSubresourceAccess& access) {
+				auto barrierIterator = std::find_if(
+					transferBarriers.begin(), transferBarriers.end(), [&access](const auto& barrier) {
+						return rangesEqual(barrier.subresourceRange, access.subresourceRange);
+					});
+				if (barrierIterator != transferBarriers.end()) {
+					barrierIterator->dstPipelineStageFlags |= access.accessingPipelineStages;
+					barrierIterator->dstAccessFlags |= access.access;
+					return;
+				}
+				transferBarriers.push_back({ .dstNodeIndex = access.nodeIndex,
+											 .srcPipelineStageFlags = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+											 .dstPipelineStageFlags = access.accessingPipelineStages,
+											 .srcAccessFlags = 0,
+											 .dstAccessFlags = access.access,
+											 .subresourceRange = access.subresourceRange,
+											 .beforeLayout = releaseLayout,
+											 .afterLayout = access.startLayout,
+											 .image = image });
+			};
+			for (auto& access : info.reads) {
+				if (access.nodeIndex == transfer.dstNodeIndex) {
+					addAcquire(access);
+				}
+			}
+			for (auto& access : info.modifications) {
+				if (access.nodeIndex == transfer.dstNodeIndex) {
+					addAcquire(access);
+				}
+			}
+		}
+
+		auto srcScope = nodeAccessScope(info, transfer.srcNodeIndex);
+		for (auto& barrier : transferBarriers) {
+			barrier.srcQueue = nodeQueue(transfer.srcNodeIndex);
+			barrier.dstQueue = nodeQueue(transfer.dstNodeIndex);
+			acquireBarriers.push_back(barrier);
+
+			auto releaseBarrier = barrier;
+			releaseBarrier.srcPipelineStageFlags = srcScope.stageFlags;
+			releaseBarrier.dstPipelineStageFlags = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+			releaseBarrier.srcAccessFlags = srcScope.accessFlags;
+			releaseBarrier.dstAccessFlags = 0;
+			releaseBarrier.isFrameStart = false;
+			m_nodeBarrierInfos[transfer.srcNodeIndex].imageBarriers.push_back(releaseBarrier);
+		}
+	}
+
+	FramegraphDependencyInfo QueueBarrierGenerator::dependencyInfo() const {
+		return { .nodeBarrierInfos = m_nodeBarrierInfos,
+				 .frameStartImageBarriers = m_frameStartImageBarriers,
+				 .splitBarriers = m_splitBarriers,
+				 .queueSchedule = m_queueSchedule };
+	}
+
+	void QueueBarrierGenerator::restoreDependencyInfo(const FramegraphDependencyInfo& info) {
+		m_nodeBarrierInfos = info.nodeBarrierInfos;
+		m_frameStartImageBarriers = info.frameStartImageBarriers;
+		m_splitBarriers = info.splitBarriers;
+		m_queueSchedule = info.queueSchedule;
+	}
+
+	void QueueBarrierGenerator::addToCompilationKey(CompilationKey& key) const {
+		auto addBufferAccesses = [&key](const std::vector<BufferSubresourceAccess>& accesses) {
+			key.add(accesses.size());
+			for (auto& access : accesses) {
+				key.add(access.nodeIndex);
+				key.add(access.accessingPipelineStages);
+				key.add(access.access);
+				key.add(access.offset);
+				key.add(access.size);
+			}
+		};
+		auto addImageAccesses = [&key](const ImageAccessInfo& info) {
+			key.add(info.preserveAcrossFrames);
+			key.add(info.initialLayout);
+			for (auto* accesses : { &info.reads, &info.modifications }) {
+				key.add(accesses->size());
+				for (auto& access : *accesses) {
+					key.add(access.nodeIndex);
+					key.add(access.accessingPipelineStages);
+					key.add(access.access);
+					key.add(access.subresourceRange.aspectMask);
+					key.add(access.subresourceRange.baseMipLevel);
+					key.add(access.subresourceRange.levelCount);
+					key.add(access.subresourceRange.baseArrayLayer);
+					key.add(access.subresourceRange.layerCount);
+					key.add(access.startLayout);
+					key.add(access.finishLayout);
+				}
+			}
+		};
+
+		// Map iteration order depends on the insertion history
+		std::vector<SlotmapHandle> buffers;
+		buffers.reserve(m_bufferAccessInfos.size());
+		for (auto& info : m_bufferAccessInfos) {
+			buffers.push_back(info.first);
+		}
+		std::sort(buffers.begin(), buffers.end());
+		key.add(buffers.size());
+		for (auto buffer : buffers) {
+			auto& info = m_bufferAccessInfos.at(buffer);
+			key.add(buffer);
+			addBufferAccesses(info.reads);
+			addBufferAccesses(info.modifications);
+		}
+
+		std::vector<SlotmapHandle> images;
+		images.reserve(m_imageAccessInfos.size());
+		for (auto& info : m_imageAccessInfos) {
+			images.push_back(info.first);
+		}
+		std::sort(images.begin(), images.end());
+		key.add(images.size());
+		for (auto image : images) {
+			key.add(image);
+			addImageAccesses(m_imageAccessInfos.at(image));
+		}
+		addImageAccesses(m_targetAccessInfo);
+
+		// Aliases add barriers between resources sharing memory
+		auto addAliasPredecessors = [&key](const auto& predecessorMap) {
+			std::vector<std::pair<SlotmapHandle, std::vector<SlotmapHandle>>> aliases(predecessorMap.begin(),
+																					   predecessorMap.end());
+			std::sort(aliases.begin(), aliases.end());
+			key.add(aliases.size());
+			for (auto& [resource, predecessors] : aliases) {
+				key.add(resource);
+				key.add(predecessors.size());
+				for (auto predecessor : predecessors) {
+					key.add(predecessor);
+				}
+			}
+		};
+		addAliasPredecessors(m_bufferAliasPredecessors);
+		addAliasPredecessors(m_imageAliasPredecessors);
+
+		key.add(m_mergedNodeRanges.size());
+		for (auto& range : m_mergedNodeRanges) {
+			key.add(range.firstNodeIndex);
+			key.add(range.lastNodeIndex);
+		}
 	}
 
 	void QueueBarrierGenerator::generateBarrierInfo(BufferHandleRetriever bufferHandleRetriever,
 													ImageHandleRetriever imageHandleRetriever,
-													FramegraphContext* context, VkImage currentTargetImage) {
+													FramegraphContext* context, VkImage currentTargetImage,
+													bool hasReleasedOwnership) {
 		m_vulkanFrameStartImageBarriers.reserve(m_frameStartImageBarriers.size());
 		m_vulkanFrameStartImageBarriers.clear();
 
 		for (auto& barrier : m_frameStartImageBarriers) {
-			VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-			if (barrier.image.has_value()) {
-				if (m_imageAccessInfos[barrier.image.value()].isNew) {
-					initialLayout = barrier.beforeLayout;
-				} else {
-					initialLayout = m_imageAccessInfos[barrier.image.value()].initialLayout;
-				}
-				m_imageAccessInfos[barrier.image.value()].isNew = false;
-			}
-
 			m_vulkanFrameStartImageBarriers.push_back(
 				{ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
 				  .srcAccessMask = barrier.srcAccessFlags,
 				  .dstAccessMask = barrier.dstAccessFlags,
-				  .oldLayout = initialLayout,
+				  .oldLayout = frameStartLayout(barrier),
 				  .newLayout = barrier.afterLayout,
 				  .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
 				  .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
@@ -329,102 +1036,146 @@ namespace vanadium::graphics {
 		}
 
 		for (auto& info : m_nodeBarrierInfos) {
-			info.vulkanBufferBarriers.reserve(info.bufferBarriers.size());
-			info.vulkanBufferBarriers.clear();
-			info.vulkanImageBarriers.reserve(info.imageBarriers.size());
-			info.vulkanImageBarriers.clear();
-
+			info.vulkanBarriers.reset(m_usesSynchronization2);
+			// Releases are always recorded
 			for (auto& barrier : info.bufferBarriers) {
-				info.vulkanBufferBarriers.push_back(
-					VkBufferMemoryBarrier{ .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
-										   .srcAccessMask = barrier.srcAccessFlags,
-										   .dstAccessMask = barrier.dstAccessFlags,
-										   .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-										   .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-										   .buffer = (context->*(bufferHandleRetriever))(barrier.buffer),
-										   .offset = barrier.offset,
-										   .size = barrier.size });
-				info.srcStages |= barrier.srcPipelineStageFlags;
-				info.dstStages |= barrier.dstPipelineStageFlags;
+				convertBarrier(barrier, bufferHandleRetriever, context, true, info.vulkanBarriers);
 			}
 			for (auto& barrier : info.imageBarriers) {
-				info.vulkanImageBarriers.push_back(
-					{ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-					  .srcAccessMask = barrier.srcAccessFlags,
-					  .dstAccessMask = barrier.dstAccessFlags,
-					  .oldLayout = barrier.beforeLayout,
-					  .newLayout = barrier.afterLayout,
-					  .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-					  .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-					  .image = barrier.image.has_value() ? (context->*(imageHandleRetriever))(barrier.image.value())
-														 : currentTargetImage,
-					  .subresourceRange = barrier.subresourceRange });
-				info.srcStages |= barrier.srcPipelineStageFlags;
-				info.dstStages |= barrier.dstPipelineStageFlags;
+				convertBarrier(barrier, imageHandleRetriever, context, currentTargetImage, true, info.vulkanBarriers);
 			}
-		}
-	}
 
-	size_t QueueBarrierGenerator::bufferBarrierCount(size_t nodeIndex) const {
-		return m_nodeBarrierInfos[nodeIndex].vulkanBufferBarriers.size();
-	}
+			info.vulkanAcquireBarriers.reset(m_usesSynchronization2);
+			for (auto& barrier : info.acquireBufferBarriers) {
+				convertBarrier(barrier, bufferHandleRetriever, context, hasReleasedOwnership,
+							   info.vulkanAcquireBarriers);
+			}
+			for (auto& barrier : info.acquireImageBarriers) {
+				convertBarrier(barrier, imageHandleRetriever, context, currentTargetImage, hasReleasedOwnership,
+							   info.vulkanAcquireBarriers);
+			}
+		}
 
-	const std::vector<VkBufferMemoryBarrier>& QueueBarrierGenerator::bufferBarriers(size_t nodeIndex) const {
-		return m_nodeBarrierInfos[nodeIndex].vulkanBufferBarriers;
+		for (auto& splitBarrier : m_splitBarriers) {
+			splitBarrier.vulkanBarriers.reset(m_usesSynchronization2);
+			for (auto& barrier : splitBarrier.bufferBarriers) {
+				convertBarrier(barrier, bufferHandleRetriever, context, true, splitBarrier.vulkanBarriers);
+			}
+			for (auto& barrier : splitBarrier.imageBarriers) {
+				convertBarrier(barrier, imageHandleRetriever, context, currentTargetImage, true,
+							   splitBarrier.vulkanBarriers);
+			}
+		}
 	}
 
-	size_t QueueBarrierGenerator::imageBarrierCount(size_t nodeIndex) const {
-		return m_nodeBarrierInfos[nodeIndex].vulkanImageBarriers.size();
+	VkImageLayout QueueBarrierGenerator::frameStartLayout(const ImageFramegraphBarrier& barrier) {
+		VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		if (barrier.image.has_value()) {
+			if (m_imageAccessInfos[barrier.image.value()].isNew) {
+				initialLayout = barrier.beforeLayout;
+			} else {
+				initialLayout = m_imageAccessInfos[barrier.image.value()].initialLayout;
+			}
+			m_imageAccessInfos[barrier.image.value()].isNew = false;
+		}
+		return initialLayout;
 	}
 
-	const std::vector<VkImageMemoryBarrier>& QueueBarrierGenerator::imageBarriers(size_t nodeIndex) const {
-		return m_nodeBarrierInfos[nodeIndex].vulkanImageBarriers;
+	// Acquires of ownership released by the previous frame wait for the previous frame's release. If there was no
+	// release, buffers need no barrier and images are transitioned like at frame start.
+	void QueueBarrierGenerator::convertBarrier(const BufferFramegraphBarrier& barrier,
+											   BufferHandleRetriever bufferHandleRetriever,
+											   FramegraphContext* context, bool hasReleasedOwnership,
+											   PipelineBarrierBatch& batch) {
+		bool transfersOwnership = barrier.srcQueue != barrier.dstQueue;
+		if (barrier.crossesFrame && !hasReleasedOwnership) {
+			return;
+		}
+		uint32_t srcQueueFamilyIndex =
+			transfersOwnership ? m_queueFamilyIndices[static_cast<size_t>(barrier.srcQueue)] : VK_QUEUE_FAMILY_IGNORED;
+		uint32_t dstQueueFamilyIndex =
+			transfersOwnership ? m_queueFamilyIndices[static_cast<size_t>(barrier.dstQueue)] : VK_QUEUE_FAMILY_IGNORED;
+		batch.addBufferBarrier({ .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+								 .srcAccessMask = barrier.srcAccessFlags,
+								 .dstAccessMask = barrier.dstAccessFlags,
+								 .srcQueueFamilyIndex = srcQueueFamilyIndex,
+								 .dstQueueFamilyIndex = dstQueueFamilyIndex,
+								 .buffer = (context->*(bufferHandleRetriever))(barrier.buffer),
+								 .offset = barrier.offset,
+								 .size = barrier.size },
+							   barrier.srcPipelineStageFlags, barrier.dstPipelineStageFlags);
 	}
 
-	VkPipelineStageFlags QueueBarrierGenerator::srcStages(size_t nodeIndex) const {
-		return m_nodeBarrierInfos[nodeIndex].srcStages;
-	}
+	void QueueBarrierGenerator::convertBarrier(const ImageFramegraphBarrier& barrier,
+											   ImageHandleRetriever imageHandleRetriever, FramegraphContext* context,
+											   VkImage currentTargetImage, bool hasReleasedOwnership,
+											   PipelineBarrierBatch& batch) {
+		bool transfersOwnership = barrier.srcQueue != barrier.dstQueue;
+		VkPipelineStageFlags srcStageFlags = barrier.srcPipelineStageFlags;
+		VkAccessFlags srcAccessFlags = barrier.srcAccessFlags;
+		VkImageLayout oldLayout = barrier.beforeLayout;
+		if (barrier.isFrameStart && barrier.crossesFrame && hasReleasedOwnership) {
+			srcStageFlags = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+			srcAccessFlags = 0;
+		} else if (barrier.isFrameStart) {
+			transfersOwnership = false;
+			oldLayout = frameStartLayout(barrier);
+		}
 
-	VkPipelineStageFlags QueueBarrierGenerator::dstStages(size_t nodeIndex) const {
-		return m_nodeBarrierInfos[nodeIndex].dstStages;
+		batch.addImageBarrier(
+			{ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			  .srcAccessMask = srcAccessFlags,
+			  .dstAccessMask = barrier.dstAccessFlags,
+			  .oldLayout = oldLayout,
+			  .newLayout = barrier.afterLayout,
+			  .srcQueueFamilyIndex = transfersOwnership ? m_queueFamilyIndices[static_cast<size_t>(barrier.srcQueue)]
+														: VK_QUEUE_FAMILY_IGNORED,
+			  .dstQueueFamilyIndex = transfersOwnership ? m_queueFamilyIndices[static_cast<size_t>(barrier.dstQueue)]
+														: VK_QUEUE_FAMILY_IGNORED,
+			  .image = barrier.image.has_value() ? (context->*(imageHandleRetriever))(barrier.image.value())
+												 : currentTargetImage,
+			  .subresourceRange = barrier.subresourceRange },
+			srcStageFlags, barrier.dstPipelineStageFlags);
 	}
 
 	VkImageLayout QueueBarrierGenerator::lastTargetImageLayout() const {
-		if (m_targetAccessInfo.reads.empty() && m_targetAccessInfo.modifications.empty())
+		if (m_activeTargetAccessInfo.reads.empty() && m_activeTargetAccessInfo.modifications.empty())
 			return VK_IMAGE_LAYOUT_UNDEFINED;
 		bool isLastAccessRead;
-		if (!m_targetAccessInfo.reads.empty() && !m_targetAccessInfo.modifications.empty()) {
-			isLastAccessRead = m_targetAccessInfo.reads.back().nodeIndex > m_targetAccessInfo.reads.back().nodeIndex;
+		if (!m_activeTargetAccessInfo.reads.empty() && !m_activeTargetAccessInfo.modifications.empty()) {
+			isLastAccessRead = m_activeTargetAccessInfo.reads.back().nodeIndex >
+							   m_activeTargetAccessInfo.reads.back().nodeIndex;
 		} else {
-			isLastAccessRead = m_targetAccessInfo.modifications.empty();
+			isLastAccessRead = m_activeTargetAccessInfo.modifications.empty();
 		}
 
 		if (isLastAccessRead) {
-			return m_targetAccessInfo.reads.back().finishLayout;
-		} else if (!m_targetAccessInfo.modifications.empty()) {
-			return m_targetAccessInfo.modifications.back().finishLayout;
+			return m_activeTargetAccessInfo.reads.back().finishLayout;
+		} else if (!m_activeTargetAccessInfo.modifications.empty()) {
+			return m_activeTargetAccessInfo.modifications.back().finishLayout;
 		}
 		return VK_IMAGE_LAYOUT_UNDEFINED;
 	}
 
 	VkImageSubresourceRange QueueBarrierGenerator::lastTargetAccessRange() const {
-		if (m_targetAccessInfo.reads.empty() && m_targetAccessInfo.modifications.empty())
+		if (m_activeTargetAccessInfo.reads.empty() && m_activeTargetAccessInfo.modifications.empty())
 			return { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
 					 .baseMipLevel = 0,
 					 .levelCount = 1,
 					 .baseArrayLayer = 0,
 					 .layerCount = 1 };
 		bool isLastAccessRead;
-		if (!m_targetAccessInfo.reads.empty() && !m_targetAccessInfo.modifications.empty()) {
-			isLastAccessRead = m_targetAccessInfo.reads.back().nodeIndex > m_targetAccessInfo.reads.back().nodeIndex;
+		if (!m_activeTargetAccessInfo.reads.empty() && !m_activeTargetAccessInfo.modifications.empty()) {
+			isLastAccessRead = m_activeTargetAccessInfo.reads.back().nodeIndex >
+							   m_activeTargetAccessInfo.reads.back().nodeIndex;
 		} else {
-			isLastAccessRead = m_targetAccessInfo.modifications.empty();
+			isLastAccessRead = m_activeTargetAccessInfo.modifications.empty();
 		}
 
 		if (isLastAccessRead) {
-			return m_targetAccessInfo.reads.back().subresourceRange;
-		} else if (!m_targetAccessInfo.modifications.empty()) {
-			return m_targetAccessInfo.modifications.back().subresourceRange;
+			return m_activeTargetAccessInfo.reads.back().subresourceRange;
+		} else if (!m_activeTargetAccessInfo.modifications.empty()) {
+			return m_activeTargetAccessInfo.modifications.back().subresourceRange;
 		}
 		return { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
 				 .baseMipLevel = 0,
@@ -436,8 +1187,12 @@ namespace vanadium::graphics {
 	void QueueBarrierGenerator::emitBarriersForRead(size_t nodeIndex, SlotmapHandle buffer,
 													const BufferAccessInfo& info, const BufferSubresourceAccess& read) {
 		auto matchOptional = findLastModification(info.modifications, read);
-		if (!matchOptional.has_value())
+		if (!matchOptional.has_value()) {
+			if (m_bufferAliasPredecessors.contains(buffer)) {
+				emitAliasingBarrier(buffer, read);
+			}
 			return;
+		}
 		auto& match = matchOptional.value();
 
 		if (match.isPartial) {
@@ -459,12 +1214,21 @@ namespace vanadium::graphics {
 			}
 		}
 
+		if (isSeparatedByQueueTransfer(info, *this, match.matchingNodeIndex, nodeIndex)) {
+			return;
+		}
 		emitBarrier(buffer, match, info.modifications[match.accessIndex], read);
 	}
 	void QueueBarrierGenerator::emitBarriersForRead(size_t nodeIndex, std::optional<SlotmapHandle> image,
 													const ImageAccessInfo& info, const ImageSubresourceAccess& read) {
 		auto matchOptional = findLastModification(info.modifications, read);
 		if (!matchOptional.has_value()) {
+			// The memory of aliased images was used by other resources before, the transition from the undefined
+			// layout has to wait for them instead of happening at frame start
+			if (image.has_value() && m_imageAliasPredecessors.contains(image.value()) &&
+				emitAliasingBarrier(image.value(), read)) {
+				return;
+			}
 			auto& lastModification = info.modifications.back();
 			m_frameStartImageBarriers.push_back(
 				{ .dstNodeIndex = nodeIndex,
@@ -531,6 +1295,9 @@ namespace vanadium::graphics {
 			}
 		}
 
+		if (isSeparatedByQueueTransfer(info, *this, match.matchingNodeIndex, nodeIndex)) {
+			return;
+		}
 		emitBarrier(image, match, info.modifications[match.accessIndex], read);
 	}
 
@@ -664,6 +1431,49 @@ namespace vanadium::graphics {
 		return std::nullopt;
 	}
 
+	bool QueueBarrierGenerator::emitAliasingBarrier(SlotmapHandle buffer, const BufferSubresourceAccess& access) {
+		auto scope = aliasingSourceScope(m_bufferAliasPredecessors[buffer], m_activeBufferAccessInfos);
+		if (!scope.has_value()) {
+			return false;
+		}
+		auto& barriers = m_nodeBarrierInfos[scope->nodeIndex].bufferBarriers;
+		auto barrierIterator = std::find_if(barriers.begin(), barriers.end(),
+											[buffer](const auto& barrier) { return barrier.buffer == buffer; });
+		if (barrierIterator == barriers.end()) {
+			barriers.push_back({ .dstNodeIndex = access.nodeIndex,
+								 .srcPipelineStageFlags = scope->stageFlags,
+								 .dstPipelineStageFlags = access.accessingPipelineStages,
+								 .srcAccessFlags = scope->accessFlags,
+								 .dstAccessFlags = access.access,
+								 .offset = 0,
+								 .size = VK_WHOLE_SIZE,
+								 .buffer = buffer });
+		} else {
+			barrierIterator->dstNodeIndex = std::min(barrierIterator->dstNodeIndex, access.nodeIndex);
+			barrierIterator->dstPipelineStageFlags |= access.accessingPipelineStages;
+			barrierIterator->dstAccessFlags |= access.access;
+		}
+		return true;
+	}
+
+	bool QueueBarrierGenerator::emitAliasingBarrier(SlotmapHandle image, const ImageSubresourceAccess& access) {
+		auto scope = aliasingSourceScope(m_imageAliasPredecessors[image], m_activeImageAccessInfos);
+		if (!scope.has_value()) {
+			return false;
+		}
+		m_nodeBarrierInfos[scope->nodeIndex].imageBarriers.push_back(
+			{ .dstNodeIndex = access.nodeIndex,
+			  .srcPipelineStageFlags = scope->stageFlags,
+			  .dstPipelineStageFlags = access.accessingPipelineStages,
+			  .srcAccessFlags = scope->accessFlags,
+			  .dstAccessFlags = access.access,
+			  .subresourceRange = access.subresourceRange,
+			  .beforeLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+			  .afterLayout = access.startLayout,
+			  .image = image });
+		return true;
+	}
+
 	void QueueBarrierGenerator::emitBarrier(SlotmapHandle buffer, const BufferAccessMatch& match,
 											const BufferSubresourceAccess& write, const BufferSubresourceAccess& read) {
 		auto barrierIterator = std::find_if(m_nodeBarrierInfos[write.nodeIndex].bufferBarriers.begin(),
@@ -1,80 +1,345 @@
-#include <execution>
+#include <chrono>
+#include <filesystem>
 #include <fstream>
 #include <graphics/helper/DebugHelper.hpp>
 #include <graphics/helper/ErrorHelper.hpp>
 #include <graphics/pipelines/PipelineLibrary.hpp>
+#include <graphics/util/PipelineObjectKeys.hpp>
+#include <thread>
 #include <util/WholeFileReader.hpp>
 #include <volk.h>
 
 namespace vanadium::graphics {
-	PipelineLibraryGraphicsInstance::PipelineLibraryGraphicsInstance(PipelineLibraryGraphicsInstance&& other)
-		: archetypeID(std::forward<decltype(archetypeID)>(other.archetypeID)),
-		  name(std::forward<decltype(name)>(other.name)),
-		  shaderStageCreateInfos(std::forward<decltype(shaderStageCreateInfos)>(other.shaderStageCreateInfos)),
-		  stageSpecializations(std::forward<decltype(stageSpecializations)>(other.stageSpecializations)),
-		  attribDescriptions(std::forward<decltype(attribDescriptions)>(other.attribDescriptions)),
-		  bindingDescriptions(std::forward<decltype(bindingDescriptions)>(other.bindingDescriptions)),
-		  vertexInputConfig(std::forward<decltype(vertexInputConfig)>(other.vertexInputConfig)),
-		  inputAssemblyConfig(std::forward<decltype(inputAssemblyConfig)>(other.inputAssemblyConfig)),
-		  rasterizationConfig(std::forward<decltype(rasterizationConfig)>(other.rasterizationConfig)),
-		  multisampleConfig(std::forward<decltype(multisampleConfig)>(other.multisampleConfig)),
-		  depthStencilConfig(std::forward<decltype(depthStencilConfig)>(other.depthStencilConfig)),
-		  colorBlendConfig(std::forward<decltype(colorBlendConfig)>(other.colorBlendConfig)),
-		  colorAttachmentBlendConfigs(
-			  std::forward<decltype(colorAttachmentBlendConfigs)>(other.colorAttachmentBlendConfigs)),
-		  dynamicStateConfig(std::forward<decltype(dynamicStateConfig)>(other.dynamicStateConfig)),
-		  dynamicStates(std::forward<decltype(dynamicStates)>(other.dynamicStates)),
-		  viewportConfig(std::forward<decltype(viewportConfig)>(other.viewportConfig)),
-		  viewports(std::forward<decltype(viewports)>(other.viewports)),
-		  scissorRects(std::forward<decltype(scissorRects)>(other.scissorRects)),
-		  pipelineCreateInfo(std::forward<decltype(pipelineCreateInfo)>(other.pipelineCreateInfo)) {
-		vertexInputConfig.pVertexAttributeDescriptions = attribDescriptions.data();
-		vertexInputConfig.pVertexBindingDescriptions = bindingDescriptions.data();
-		colorBlendConfig.pAttachments = colorAttachmentBlendConfigs.data();
-		viewportConfig.pViewports = viewports.data();
-		viewportConfig.pScissors = scissorRects.data();
-		dynamicStateConfig.pDynamicStates = dynamicStates.data();
-		pipelineCreateInfo.pStages = shaderStageCreateInfos.data();
-		pipelineCreateInfo.pVertexInputState = &vertexInputConfig;
-		pipelineCreateInfo.pInputAssemblyState = &inputAssemblyConfig;
-		pipelineCreateInfo.pRasterizationState = &rasterizationConfig;
-		pipelineCreateInfo.pViewportState = &viewportConfig;
-		pipelineCreateInfo.pMultisampleState = &multisampleConfig;
-		pipelineCreateInfo.pViewportState = &viewportConfig;
-		pipelineCreateInfo.pDepthStencilState = &depthStencilConfig;
-		pipelineCreateInfo.pColorBlendState = &colorBlendConfig;
-		pipelineCreateInfo.pDynamicState = &dynamicStateConfig;
-
-		for (auto& specialization : stageSpecializations) {
-			specialization.specializationInfo.pMapEntries = specialization.mapEntries.data();
-			auto stageIterator =
-				std::find_if(shaderStageCreateInfos.begin(), shaderStageCreateInfos.end(),
-							 [&specialization](const auto& stage) { return stage.stage == specialization.stage; });
-			stageIterator->pSpecializationInfo = &specialization.specializationInfo;
+	void PipelineLibrary::create(const std::string_view& libraryFileName, DeviceContext* context,
+								 PipelineCreationMode creationMode, bool recordsUsage,
+								 PipelineObjectCache* objectCache) {
+		auto startTime = std::chrono::steady_clock::now();
+		m_deviceContext = context;
+		if (objectCache) {
+			m_objectCache = objectCache;
+		} else {
+			m_ownedObjectCache.create(context);
+			m_objectCache = &m_ownedObjectCache;
+		}
+		m_creationMode = creationMode;
+		m_pipelineCacheFileName = std::filesystem::path(libraryFileName).replace_extension(".vcpcache").string();
+		std::string usageLogFileName = std::filesystem::path(libraryFileName).replace_extension(".vcpusage").string();
+		if (recordsUsage) {
+			m_usageLogFileName = usageLogFileName;
+		}
+		m_isPipelineCacheWarm = createPipelineCache();
+		uint32_t hardwareThreadCount = std::max(std::thread::hardware_concurrency(), 1U);
+		m_compilationWorkers.create(std::min(hardwareThreadCount, maxCompilationThreadCount));
+
+		std::string fileName = std::string(libraryFileName);
+		m_libraryFile = std::make_shared<MappedFile>();
+		assertFatal(m_libraryFile->open(fileName.c_str()), "PipelineLibrary: Could not open pipeline file!");
+		VCPFileHeader header;
+		assertFatal(m_libraryFile->size() >= sizeof(VCPFileHeader), "PipelineLibrary: Invalid pipeline file!");
+		std::memcpy(&header, m_libraryFile->data(), sizeof(VCPFileHeader));
+		assertFatal(header.magic == vcpMagicNumber, "PipelineLibrary: Invalid pipeline file!");
+
+		if (header.version == vcpLegacyStreamFileVersion) {
+			logWarning("PipelineLibrary: {} uses an outdated format and is converted on every start, rebuild it with "
+					   "vcp to load it in place.",
+					   fileName.c_str());
+			m_libraryFile.reset();
+			auto fileStream = std::ifstream(fileName, std::ios::binary);
+			fileStream.ignore(sizeof(VCPFileHeader));
+			m_convertedLibrary = std::make_shared<std::vector<char>>(convertLegacyVCPLibrary(fileStream));
+			assertFatal(m_libraryView.open(m_convertedLibrary->data(), m_convertedLibrary->size()),
+						"PipelineLibrary: Invalid pipeline file!");
+		} else {
+			assertFatal(header.version == vcpFileVersion, "PipelineLibrary: Invalid pipeline file version!");
+			assertFatal(m_libraryView.open(m_libraryFile->data(), m_libraryFile->size()),
+						"PipelineLibrary: Invalid pipeline file!");
+		}
+
+		createSetLayouts();
+		createArchetypes();
+		createGraphicsInstances();
+		createComputeInstances();
+		createShaderModules();
+		createComputePipelines();
+
+		m_graphicsPipelines.reserve(m_graphicsInstances.size());
+		for (size_t i = 0; i < m_graphicsInstances.size(); ++i) {
+			m_graphicsPipelines.push_back(std::make_unique<GraphicsPipelineTable>());
+		}
+		if (m_creationMode == PipelineCreationMode::Lazy) {
+			loadUsageLog(usageLogFileName);
+			if (!m_loggedUsage.empty()) {
+				m_precompilationThread = std::thread([this]() { precompilationLoop(); });
+			}
 		}
+
+		std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - startTime;
+		logInfo("PipelineLibrary: Created library in {} ms with a {} pipeline cache.", duration.count(),
+				m_isPipelineCacheWarm ? "warm" : "cold");
+		auto objectCounts = m_objectCache->objectCounts();
+		logInfo("PipelineLibrary: {} archetypes share {} pipeline layouts, {} set layouts, {} samplers and {} shader "
+				"modules with other archetypes and libraries using the object cache.",
+				m_archetypes.size(), objectCounts.pipelineLayoutCount, objectCounts.descriptorSetLayoutCount,
+				objectCounts.samplerCount, objectCounts.shaderModuleCount);
 	}
 
-	void PipelineLibrary::create(const std::string_view& libraryFileName, DeviceContext* context) {
-		m_deviceContext = context;
+	bool PipelineLibrary::createPipelineCache() {
+		size_t fileSize;
+		char* fileData = static_cast<char*>(readFile(m_pipelineCacheFileName.c_str(), &fileSize));
+		std::optional<std::vector<char>> initialData;
+		if (fileData) {
+			initialData = deserializePipelineCache(pipelineCacheDeviceInfo(), fileData, fileSize);
+			delete[] fileData;
+			if (!initialData.has_value()) {
+				logWarning("PipelineLibrary: Discarding pipeline cache {} written for another device or driver.",
+						   m_pipelineCacheFileName.c_str());
+			}
+		}
 
-		m_fileStream = std::ifstream(std::string(libraryFileName), std::ios::binary);
-		assertFatal(m_fileStream.is_open(), "PipelineLibrary: Could not open pipeline file!");
+		VkPipelineCacheCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+		if (initialData.has_value()) {
+			createInfo.initialDataSize = initialData->size();
+			createInfo.pInitialData = initialData->data();
+		}
+		verifyResult(vkCreatePipelineCache(m_deviceContext->device(), &createInfo, nullptr, &m_pipelineCache));
+		return initialData.has_value();
+	}
 
-		VCPFileHeader header = deserialize<VCPFileHeader>(m_fileStream);
-		assertFatal(header.magic == vcpMagicNumber, "PipelineLibrary: Invalid pipeline file!");
-		assertFatal(header.version == vcpFileVersion, "PipelineLibrary: Invalid pipeline file version!");
+	PipelineCacheDeviceInfo PipelineLibrary::pipelineCacheDeviceInfo() const {
+		const VkPhysicalDeviceProperties& properties = m_deviceContext->properties();
+		PipelineCacheDeviceInfo info = { .vendorID = properties.vendorID,
+										 .deviceID = properties.deviceID,
+										 .driverVersion = properties.driverVersion };
+		std::memcpy(info.pipelineCacheUUID.data(), properties.pipelineCacheUUID, VK_UUID_SIZE);
+		return info;
+	}
 
-		std::vector<std::vector<DescriptorBindingLayoutInfo>> setLayoutInfos;
-		setLayoutInfos = deserializeVector<std::vector<DescriptorBindingLayoutInfo>>(m_fileStream);
-		m_descriptorSetLayouts.reserve(setLayoutInfos.size());
+	void PipelineLibrary::savePipelineCache() {
+		size_t dataSize;
+		verifyResult(vkGetPipelineCacheData(m_deviceContext->device(), m_pipelineCache, &dataSize, nullptr));
+		std::vector<char> cacheData = std::vector<char>(dataSize);
+		verifyResult(vkGetPipelineCacheData(m_deviceContext->device(), m_pipelineCache, &dataSize, cacheData.data()));
+		cacheData.resize(dataSize);
+
+		std::vector<char> fileData = serializePipelineCache(pipelineCacheDeviceInfo(), cacheData);
+		if (!writeFileAtomically(m_pipelineCacheFileName, fileData)) {
+			logWarning("PipelineLibrary: Couldn't write pipeline cache {}.", m_pipelineCacheFileName.c_str());
+		}
+	}
+
+	void PipelineLibrary::createForPass(const RenderPassSignature& signature, VkRenderPass pass,
+										const std::vector<uint32_t>& pipelineIDs) {
+		auto startTime = std::chrono::steady_clock::now();
+		{
+			auto lock = std::unique_lock<std::shared_mutex>(m_renderPassMutex);
+			m_renderPasses[signature] = pass;
+		}
+
+		if (m_creationMode == PipelineCreationMode::Lazy) {
+			auto usage = m_loggedUsage.find(robin_hood::hash<RenderPassSignature>()(signature));
+			if (usage == m_loggedUsage.end()) {
+				return;
+			}
+			auto lock = std::unique_lock<std::mutex>(m_precompilationMutex);
+			for (auto id : usage->second) {
+				if (m_graphicsPipelines[id]->state(signature) == LazyCreationState::Missing) {
+					m_precompilationQueue.push_back({ .instanceID = id, .signature = signature });
+				}
+			}
+			m_precompilationCondition.notify_one();
+			return;
+		}
+
+		// Pipelines stay valid for compatible render passes, e.g. when merged render passes are recreated
+		std::vector<uint32_t> missingIDs;
+		for (auto id : pipelineIDs) {
+			if (m_graphicsPipelines[id]->state(signature) == LazyCreationState::Missing &&
+				std::find(missingIDs.begin(), missingIDs.end(), id) == missingIDs.end()) {
+				missingIDs.push_back(id);
+			}
+		}
+
+		// Pipeline caches are internally synchronized, so all workers can share the same cache
+		auto createMissingPipeline = [this, &signature, pass, &missingIDs](size_t jobIndex, uint32_t) {
+			uint32_t id = missingIDs[jobIndex];
+			auto lock = std::shared_lock<std::shared_mutex>(m_renderPassMutex);
+			auto create = [this, id, &signature, pass]() { return buildGraphicsPipeline(id, signature, pass); };
+			m_graphicsPipelines[id]->tryCreate(signature, create);
+		};
+		m_compilationWorkers.dispatch(missingIDs.size(), createMissingPipeline);
+		m_compilationWorkers.wait();
+
+		std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - startTime;
+		m_passPipelineCreationMilliseconds += duration.count();
+	}
 
-		uint32_t immutableSamplerOffset = 0;
-		for (auto& set : setLayoutInfos) {
+	VkPipeline PipelineLibrary::graphicsPipeline(uint32_t id, const RenderPassSignature& signature) {
+		return m_graphicsPipelines[id]->getOrCreate(signature, [this, id, &signature]() {
+			++m_onDemandPipelineCount;
+			auto lock = std::shared_lock<std::shared_mutex>(m_renderPassMutex);
+			auto pass = m_renderPasses.find(signature);
+			assertFatal(pass != m_renderPasses.end(),
+						"PipelineLibrary: No render pass was registered with createForPass for the signature!");
+			return buildGraphicsPipeline(id, signature, pass->second);
+		});
+	}
+
+	void PipelineLibrary::removePass(VkRenderPass pass) {
+		std::vector<RenderPassSignature> removedSignatures;
+		{
+			// Waits for all pipelines that are being created, since they hold the lock in shared mode
+			auto lock = std::unique_lock<std::shared_mutex>(m_renderPassMutex);
+			for (auto& [signature, registeredPass] : m_renderPasses) {
+				if (registeredPass == pass) {
+					removedSignatures.push_back(signature);
+				}
+			}
+			for (auto& signature : removedSignatures) {
+				m_renderPasses.erase(signature);
+			}
+		}
+		if (removedSignatures.empty()) {
+			return;
+		}
+
+		auto lock = std::unique_lock<std::mutex>(m_precompilationMutex);
+		auto usesRemovedPass = [&removedSignatures](const GraphicsPipelinePrecompilation& precompilation) {
+			return std::find(removedSignatures.begin(), removedSignatures.end(), precompilation.signature) !=
+				   removedSignatures.end();
+		};
+		std::erase_if(m_precompilationQueue, usesRemovedPass);
+	}
+
+	VkPipeline PipelineLibrary::buildGraphicsPipeline(uint32_t id, const RenderPassSignature& signature,
+													  VkRenderPass pass) {
+		auto& instance = m_graphicsInstances[id];
+		VkGraphicsPipelineCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+													.stageCount =
+														static_cast<uint32_t>(instance.shaderStageCreateInfos.size()),
+													.pStages = instance.shaderStageCreateInfos.data(),
+													.pVertexInputState = &instance.vertexInputConfig,
+													.pInputAssemblyState = &instance.inputAssemblyConfig,
+													.pViewportState = &instance.viewportConfig,
+													.pRasterizationState = &instance.rasterizationConfig,
+													.pMultisampleState = &instance.multisampleConfig,
+													.pDepthStencilState = &instance.depthStencilConfig,
+													.pColorBlendState = &instance.colorBlendConfig,
+													.pDynamicState = &instance.dynamicStateConfig,
+													.layout = m_archetypes[instance.archetypeID].layout,
+													.renderPass = pass,
+													.subpass = signature.subpassIndex };
+		VkPipeline pipeline;
+		verifyResult(
+			vkCreateGraphicsPipelines(m_deviceContext->device(), m_pipelineCache, 1, &createInfo, nullptr, &pipeline));
+
+		if constexpr (vanadiumGPUDebug) {
+			setObjectName(m_deviceContext->device(), VK_OBJECT_TYPE_PIPELINE, pipeline,
+						  std::string(instance.name) + " (Signature hash " +
+							  std::to_string(robin_hood::hash<RenderPassSignature>()(signature)) + ")");
+		}
+		return pipeline;
+	}
+
+	void PipelineLibrary::loadUsageLog(const std::string& fileName) {
+		size_t fileSize;
+		char* fileData = static_cast<char*>(readFile(fileName.c_str(), &fileSize));
+		if (!fileData) {
+			return;
+		}
+		auto entries = parsePipelineUsage(std::string_view(fileData, fileSize));
+		delete[] fileData;
+
+		for (auto& entry : entries) {
+			// Instances may have been removed from the library since the log was written
+			uint32_t id = findGraphicsPipeline(entry.instanceName);
+			if (id != ~0U) {
+				m_loggedUsage[entry.signatureHash].push_back(id);
+			}
+		}
+	}
+
+	void PipelineLibrary::writeUsageLog() {
+		if (m_usageLogFileName.empty()) {
+			return;
+		}
+		std::vector<PipelineUsageEntry> entries;
+		for (uint32_t id = 0; id < m_graphicsPipelines.size(); ++id) {
+			for (auto& signature : m_graphicsPipelines[id]->usedKeys()) {
+				entries.push_back({ .instanceName = std::string(m_graphicsInstances[id].name),
+									.signatureHash = robin_hood::hash<RenderPassSignature>()(signature) });
+			}
+		}
+		std::string text = serializePipelineUsage(entries);
+		if (!writeFileAtomically(m_usageLogFileName, std::vector<char>(text.begin(), text.end()))) {
+			logWarning("PipelineLibrary: Couldn't write pipeline usage log {}.", m_usageLogFileName.c_str());
+		}
+	}
+
+	void PipelineLibrary::precompilationLoop() {
+		while (true) {
+			std::vector<GraphicsPipelinePrecompilation> precompilations;
+			{
+				auto lock = std::unique_lock<std::mutex>(m_precompilationMutex);
+				m_precompilationCondition.wait(lock, [this]() {
+					return m_isStoppingPrecompilation || !m_precompilationQueue.empty();
+				});
+				if (m_isStoppingPrecompilation) {
+					return;
+				}
+				precompilations.swap(m_precompilationQueue);
+			}
+
+			// Pipelines looked up meanwhile are created by the rendering threads, tryCreate skips them
+			m_compilationWorkers.dispatch(precompilations.size(), [this, &precompilations](size_t jobIndex, uint32_t) {
+				auto& precompilation = precompilations[jobIndex];
+				// Render passes removed since the precompilation was queued are skipped, their pipelines are created
+				// on first use if the signature is registered again
+				auto lock = std::shared_lock<std::shared_mutex>(m_renderPassMutex);
+				auto pass = m_renderPasses.find(precompilation.signature);
+				if (pass == m_renderPasses.end()) {
+					return;
+				}
+				auto create = [this, &precompilation, &pass]() {
+					return buildGraphicsPipeline(precompilation.instanceID, precompilation.signature, pass->second);
+				};
+				if (m_graphicsPipelines[precompilation.instanceID]->tryCreate(precompilation.signature, create)) {
+					++m_precompiledPipelineCount;
+				}
+			});
+			m_compilationWorkers.wait();
+		}
+	}
+
+	void PipelineLibrary::stopPrecompilation() {
+		{
+			auto lock = std::unique_lock<std::mutex>(m_precompilationMutex);
+			m_isStoppingPrecompilation = true;
+			m_precompilationCondition.notify_one();
+		}
+		if (m_precompilationThread.joinable()) {
+			m_precompilationThread.join();
+		}
+	}
+
+	void PipelineLibrary::createSetLayouts() {
+		// Bindings point into the sampler array, so it must not be reallocated
+		size_t immutableSamplerCount = 0;
+		for (auto& setLayout : m_libraryView.setLayouts()) {
+			for (auto& binding : m_libraryView.elements(setLayout.bindings)) {
+				immutableSamplerCount += binding.immutableSamplers.count;
+			}
+		}
+		m_immutableSamplers.reserve(immutableSamplerCount);
+		m_descriptorSetLayouts.reserve(m_libraryView.setLayouts().size());
+
+		for (auto& setLayout : m_libraryView.setLayouts()) {
 			std::vector<VkDescriptorSetLayoutBinding> bindings;
-			bindings.reserve(set.size());
-			for (auto& binding : set) {
+			bindings.reserve(setLayout.bindings.count);
+			for (auto& binding : m_libraryView.elements(setLayout.bindings)) {
+				const VkSampler* immutableSamplers = nullptr;
 				if (binding.usesImmutableSamplers) {
-					for (auto& info : binding.immutableSamplerInfos) {
+					immutableSamplers = m_immutableSamplers.data() + m_immutableSamplers.size();
+					for (auto& info : m_libraryView.elements(binding.immutableSamplers)) {
 						VkSamplerCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
 														   .magFilter = info.magFilter,
 														   .minFilter = info.minFilter,
@@ -91,361 +356,269 @@ namespace vanadium::graphics {
 														   .maxLod = info.maxLod,
 														   .borderColor = info.borderColor,
 														   .unnormalizedCoordinates = info.unnormalizedCoordinates };
-						VkSampler immutableSampler;
-						verifyResult(
-							vkCreateSampler(m_deviceContext->device(), &createInfo, nullptr, &immutableSampler));
-						m_immutableSamplers.push_back(immutableSampler);
+						m_immutableSamplers.push_back(m_objectCache->acquireSampler(createInfo));
 					}
-					// dummy value to mark this binding as using immutable samplers
-					binding.binding.pImmutableSamplers = m_immutableSamplers.data();
-				}
-				else {
-					binding.binding.pImmutableSamplers = nullptr;
-				}
-				bindings.push_back(binding.binding);
-			}
-
-			for (auto& binding : bindings) {
-				if (binding.pImmutableSamplers) {
-					binding.pImmutableSamplers = m_immutableSamplers.data() + immutableSamplerOffset;
-					immutableSamplerOffset += binding.descriptorCount;
 				}
+				bindings.push_back({ .binding = binding.binding,
+									 .descriptorType = binding.descriptorType,
+									 .descriptorCount = binding.descriptorCount,
+									 .stageFlags = binding.stageFlags,
+									 .pImmutableSamplers = immutableSamplers });
 			}
 
 			VkDescriptorSetLayoutCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
 														   .bindingCount = static_cast<uint32_t>(bindings.size()),
 														   .pBindings = bindings.data() };
-			VkDescriptorSetLayout layout;
-			verifyResult(vkCreateDescriptorSetLayout(m_deviceContext->device(), &createInfo, nullptr, &layout));
-			m_descriptorSetLayouts.push_back({ .layout = layout, .bindingInfos = std::move(bindings) });
+			m_descriptorSetLayouts.push_back({ .layout = m_objectCache->acquireDescriptorSetLayout(createInfo),
+											   .bindingInfos = std::move(bindings) });
 		}
+	}
 
-		while (true) {
-			PipelineType pipelineType = deserialize<PipelineType>(m_fileStream);
-
-			if (m_fileStream.eof())
-				break;
-
-			assertFatal(m_fileStream.good(), "PipelineLibrary: Error reading pipeline file!");
-
-			switch (pipelineType) {
-				case PipelineType::Graphics:
-					createGraphicsPipeline();
-					break;
-				case PipelineType::Compute:
-					createComputePipeline();
-					break;
-				default:
-					logFatal("PipelineLibrary: Invalid pipeline file!");
+	void PipelineLibrary::createArchetypes() {
+		m_archetypes.reserve(m_libraryView.archetypes().size());
+		// Indices into m_shaderModuleCreations, so that identical code within the library is only created once
+		robin_hood::unordered_map<ShaderModuleKey, uint32_t, ShaderModuleKeyHash> creationIndices;
+		auto codeOwner = m_convertedLibrary ? std::shared_ptr<const void>(m_convertedLibrary)
+											: std::shared_ptr<const void>(m_libraryFile);
+		for (auto& archetype : m_libraryView.archetypes()) {
+			auto archetypeID = static_cast<uint32_t>(m_archetypes.size());
+			auto shaders = m_libraryView.elements(archetype.shaders);
+			std::vector<VkShaderModule> shaderModules = std::vector<VkShaderModule>(shaders.size(), VK_NULL_HANDLE);
+			for (uint32_t i = 0; i < shaders.size(); ++i) {
+				// The code is aligned within the file, so it can be used in place
+				auto code = m_libraryView.elements(shaders[i].code);
+				VkShaderModuleCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+														.codeSize = code.size(),
+														.pCode = reinterpret_cast<const uint32_t*>(code.data()) };
+				ShaderModuleKey key = shaderModuleKey(createInfo, codeOwner);
+				if (auto module = m_objectCache->acquireShaderModule(key)) {
+					shaderModules[i] = *module;
+					continue;
+				}
+
+				auto creationIndex = creationIndices.find(key);
+				if (creationIndex == creationIndices.end()) {
+					creationIndex =
+						creationIndices.emplace(key, static_cast<uint32_t>(m_shaderModuleCreations.size())).first;
+					m_shaderModuleCreations.push_back(
+						{ .key = std::move(key), .createInfo = createInfo, .module = VK_NULL_HANDLE });
+				}
+				m_shaderModuleUses.push_back(
+					{ .archetypeID = archetypeID, .moduleIndex = i, .creationIndex = creationIndex->second });
 			}
-		}
-		m_fileStream.close();
-	}
 
-	void PipelineLibrary::createForPass(const RenderPassSignature& signature, VkRenderPass pass,
-										const std::vector<uint32_t>& pipelineIDs) {
-		std::for_each(std::execution::par_unseq, pipelineIDs.begin(), pipelineIDs.end(),
-					  [this, &signature, pass](const auto& id) {
-						  m_graphicsInstances[id].pipelineCreateInfo.renderPass = pass;
-						  VkPipeline pipeline;
-						  verifyResult(vkCreateGraphicsPipelines(m_deviceContext->device(), VK_NULL_HANDLE, 1,
-																 &m_graphicsInstances[id].pipelineCreateInfo, nullptr,
-																 &pipeline));
-
-						  if constexpr (vanadiumGPUDebug) {
-							  setObjectName(m_deviceContext->device(), VK_OBJECT_TYPE_PIPELINE, pipeline,
-											m_graphicsInstances[id].name + " (Signature hash " +
-												std::to_string(robin_hood::hash<RenderPassSignature>()(signature)) +
-												")");
-						  }
-						  m_graphicsInstances[id].pipelines.insert(
-							  robin_hood::pair<const RenderPassSignature, VkPipeline>(signature, pipeline));
-						  m_graphicsInstances[id].pipelineCreateInfo.renderPass = VK_NULL_HANDLE;
-					  });
+			auto setLayoutIndices = m_libraryView.elements(archetype.setLayoutIndices);
+			auto pushConstantRanges = m_libraryView.elements(archetype.pushConstantRanges);
+			std::vector<VkDescriptorSetLayout> setLayouts;
+			setLayouts.reserve(setLayoutIndices.size());
+			for (auto& index : setLayoutIndices) {
+				setLayouts.push_back(m_descriptorSetLayouts[index].layout);
+			}
+
+			VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+				.setLayoutCount = static_cast<uint32_t>(setLayouts.size()),
+				.pSetLayouts = setLayouts.data(),
+				.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size()),
+				.pPushConstantRanges = pushConstantRanges.data()
+			};
+
+			// Modules without an identical module in the cache are filled in by createShaderModules
+			m_archetypes.push_back(
+				{ .type = archetype.type,
+				  .shaderModules = std::move(shaderModules),
+				  .setLayoutIndices = std::vector<uint32_t>(setLayoutIndices.begin(), setLayoutIndices.end()),
+				  .pushConstantRanges =
+					  std::vector<VkPushConstantRange>(pushConstantRanges.begin(), pushConstantRanges.end()),
+				  .layout = m_objectCache->acquirePipelineLayout(pipelineLayoutCreateInfo) });
+		}
 	}
 
-	void PipelineLibrary::createGraphicsPipeline() {
-		std::vector<CompiledShader> shaders = deserializeVector<CompiledShader>(m_fileStream);
-		std::vector<VkPipelineShaderStageCreateInfo> stageCreateInfos;
-		std::vector<VkShaderModule> shaderModules;
-		stageCreateInfos.reserve(shaders.size());
-		shaderModules.reserve(shaders.size());
-
-		for (auto& shader : shaders) {
-			VkShaderModuleCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-													.codeSize = shader.dataSize,
-													.pCode = reinterpret_cast<uint32_t*>(shader.data) };
-			VkShaderModule shaderModule;
-			verifyResult(vkCreateShaderModule(m_deviceContext->device(), &createInfo, nullptr, &shaderModule));
-			shaderModules.push_back(shaderModule);
-			stageCreateInfos.push_back({ .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-										 .stage = shader.stage,
-										 .module = shaderModule,
-										 .pName = "main" });
-		}
-
-		std::vector<VkDescriptorSetLayout> setLayouts;
-		std::vector<uint32_t> setLayoutIndices = deserializeVector<uint32_t>(m_fileStream);
-		setLayouts.reserve(setLayoutIndices.size());
-
-		for (auto& index : setLayoutIndices) {
-			setLayouts.push_back(m_descriptorSetLayouts[index].layout);
-		}
-
-		std::vector<VkPushConstantRange> pushConstantRanges = deserializeVector<VkPushConstantRange>(m_fileStream);
-
-		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = { .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-																.setLayoutCount =
-																	static_cast<uint32_t>(setLayouts.size()),
-																.pSetLayouts = setLayouts.data(),
-																.pushConstantRangeCount =
-																	static_cast<uint32_t>(pushConstantRanges.size()),
-																.pPushConstantRanges = pushConstantRanges.data() };
-		VkPipelineLayout layout;
-		verifyResult(vkCreatePipelineLayout(m_deviceContext->device(), &pipelineLayoutCreateInfo, nullptr, &layout));
-
-		m_archetypes.push_back({ .type = PipelineType::Graphics,
-								 .shaderModules = std::move(shaderModules),
-								 .setLayoutIndices = std::move(setLayoutIndices),
-								 .pushConstantRanges = std::move(pushConstantRanges) });
-
-		std::vector<PipelineInstanceData> fileInstances = deserializeVector<PipelineInstanceData>(m_fileStream);
-		std::vector<PipelineLibraryGraphicsInstance> instances;
-		instances.reserve(fileInstances.size());
-
-		for (auto& fileInstance : fileInstances) {
+	void PipelineLibrary::createGraphicsInstances() {
+		m_graphicsInstances.reserve(m_libraryView.graphicsInstances().size());
+		for (auto& entry : m_libraryView.graphicsInstances()) {
 			PipelineLibraryGraphicsInstance instance;
-			instance.archetypeID = m_archetypes.size() - 1ULL;
-			instance.name = fileInstance.name;
-			instance.attribDescriptions = fileInstance.instanceVertexInputConfig.attributes;
-			instance.bindingDescriptions = fileInstance.instanceVertexInputConfig.bindings;
+			instance.archetypeID = entry.archetypeIndex;
+			instance.name = m_libraryView.name(entry);
+
+			// Modules are filled in by createShaderModules
+			for (auto& shader : m_libraryView.elements(m_libraryView.archetypes()[entry.archetypeIndex].shaders)) {
+				instance.shaderStageCreateInfos.push_back(
+					{ .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+					  .stage = shader.stage,
+					  .module = VK_NULL_HANDLE,
+					  .pName = "main" });
+			}
+			for (auto& specialization : m_libraryView.elements(entry.specializations)) {
+				instance.stageSpecializations.push_back(stageSpecialization(specialization));
+			}
+			// The library view checked that every specialized stage exists
+			for (auto& specialization : instance.stageSpecializations) {
+				for (auto& stage : instance.shaderStageCreateInfos) {
+					if (stage.stage == specialization.stage) {
+						stage.pSpecializationInfo = &specialization.specializationInfo;
+					}
+				}
+			}
 
+			auto attributes = m_libraryView.elements(entry.attributes);
+			auto bindings = m_libraryView.elements(entry.bindings);
 			instance.vertexInputConfig = { .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-										   .vertexBindingDescriptionCount =
-											   static_cast<uint32_t>(instance.bindingDescriptions.size()),
-										   .pVertexBindingDescriptions = instance.bindingDescriptions.data(),
-										   .vertexAttributeDescriptionCount =
-											   static_cast<uint32_t>(instance.attribDescriptions.size()),
-										   .pVertexAttributeDescriptions = instance.attribDescriptions.data() };
+										   .vertexBindingDescriptionCount = static_cast<uint32_t>(bindings.size()),
+										   .pVertexBindingDescriptions = bindings.data(),
+										   .vertexAttributeDescriptionCount = static_cast<uint32_t>(attributes.size()),
+										   .pVertexAttributeDescriptions = attributes.data() };
 
 			instance.inputAssemblyConfig = { .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
-											 .topology = fileInstance.instanceInputAssemblyConfig.topology,
-											 .primitiveRestartEnable =
-												 fileInstance.instanceInputAssemblyConfig.primitiveRestart };
+											 .topology = entry.inputAssemblyConfig.topology,
+											 .primitiveRestartEnable = entry.inputAssemblyConfig.primitiveRestart };
 
 			instance.rasterizationConfig = {
 				.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
-				.depthClampEnable = fileInstance.instanceRasterizationConfig.depthClampEnable,
-				.rasterizerDiscardEnable = fileInstance.instanceRasterizationConfig.rasterizerDiscardEnable,
-				.polygonMode = fileInstance.instanceRasterizationConfig.polygonMode,
-				.cullMode = fileInstance.instanceRasterizationConfig.cullMode,
-				.frontFace = fileInstance.instanceRasterizationConfig.frontFace,
-				.depthBiasEnable = fileInstance.instanceRasterizationConfig.depthBiasEnable,
-				.depthBiasConstantFactor = fileInstance.instanceRasterizationConfig.depthBiasConstantFactor,
-				.depthBiasClamp = fileInstance.instanceRasterizationConfig.depthBiasClamp,
-				.depthBiasSlopeFactor = fileInstance.instanceRasterizationConfig.depthBiasSlopeFactor,
-				.lineWidth = fileInstance.instanceRasterizationConfig.lineWidth
+				.depthClampEnable = entry.rasterizationConfig.depthClampEnable,
+				.rasterizerDiscardEnable = entry.rasterizationConfig.rasterizerDiscardEnable,
+				.polygonMode = entry.rasterizationConfig.polygonMode,
+				.cullMode = entry.rasterizationConfig.cullMode,
+				.frontFace = entry.rasterizationConfig.frontFace,
+				.depthBiasEnable = entry.rasterizationConfig.depthBiasEnable,
+				.depthBiasConstantFactor = entry.rasterizationConfig.depthBiasConstantFactor,
+				.depthBiasClamp = entry.rasterizationConfig.depthBiasClamp,
+				.depthBiasSlopeFactor = entry.rasterizationConfig.depthBiasSlopeFactor,
+				.lineWidth = entry.rasterizationConfig.lineWidth
 			};
 
-			instance.viewports = fileInstance.instanceViewportScissorConfig.viewports;
-			instance.scissorRects = fileInstance.instanceViewportScissorConfig.scissorRects;
-
 			instance.multisampleConfig = { .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
-										   .rasterizationSamples = fileInstance.instanceMultisampleConfig };
-
-			instance.depthStencilConfig = {
-				.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
-				.depthTestEnable = fileInstance.instanceDepthStencilConfig.depthTestEnable,
-				.depthWriteEnable = fileInstance.instanceDepthStencilConfig.depthWriteEnable,
-				.depthCompareOp = fileInstance.instanceDepthStencilConfig.depthCompareOp,
-				.depthBoundsTestEnable = fileInstance.instanceDepthStencilConfig.depthBoundsTestEnable,
-				.stencilTestEnable = fileInstance.instanceDepthStencilConfig.stencilTestEnable,
-				.front = fileInstance.instanceDepthStencilConfig.front,
-				.back = fileInstance.instanceDepthStencilConfig.back,
-				.minDepthBounds = fileInstance.instanceDepthStencilConfig.minDepthBounds,
-				.maxDepthBounds = fileInstance.instanceDepthStencilConfig.maxDepthBounds
-			};
-
-			instance.dynamicStates = fileInstance.instanceDynamicStateConfig.dynamicStates;
-
+										   .rasterizationSamples = entry.multisampleConfig };
+
+			instance.depthStencilConfig = { .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+											.depthTestEnable = entry.depthStencilConfig.depthTestEnable,
+											.depthWriteEnable = entry.depthStencilConfig.depthWriteEnable,
+											.depthCompareOp = entry.depthStencilConfig.depthCompareOp,
+											.depthBoundsTestEnable = entry.depthStencilConfig.depthBoundsTestEnable,
+											.stencilTestEnable = entry.depthStencilConfig.stencilTestEnable,
+											.front = entry.depthStencilConfig.front,
+											.back = entry.depthStencilConfig.back,
+											.minDepthBounds = entry.depthStencilConfig.minDepthBounds,
+											.maxDepthBounds = entry.depthStencilConfig.maxDepthBounds };
+
+			auto colorAttachmentBlendConfigs = m_libraryView.elements(entry.colorAttachmentBlendConfigs);
 			instance.colorBlendConfig = { .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
-										  .logicOpEnable = fileInstance.instanceColorBlendConfig.logicOpEnable,
-										  .logicOp = fileInstance.instanceColorBlendConfig.logicOp,
-										  .blendConstants = {
-											  fileInstance.instanceColorBlendConfig.blendConstants[0],
-											  fileInstance.instanceColorBlendConfig.blendConstants[1],
-											  fileInstance.instanceColorBlendConfig.blendConstants[2],
-											  fileInstance.instanceColorBlendConfig.blendConstants[3] } };
-
-			instance.colorAttachmentBlendConfigs = fileInstance.instanceColorAttachmentBlendConfigs;
-			instance.colorBlendConfig.attachmentCount =
-				static_cast<uint32_t>(instance.colorAttachmentBlendConfigs.size());
-			instance.colorBlendConfig.pAttachments = instance.colorAttachmentBlendConfigs.data();
-
-			for (auto& specialization : fileInstance.instanceSpecializationConfigs) {
-				PipelineLibraryStageSpecialization stageSpecialization;
-				stageSpecialization.stage = specialization.stage;
-				stageSpecialization.mapEntries.reserve(specialization.configs.size());
-				size_t dataSize = 0;
-				for (auto& config : specialization.configs) {
-					stageSpecialization.mapEntries.push_back(config.mapEntry);
-					dataSize = std::max(dataSize, config.mapEntry.offset + config.mapEntry.size);
-					assertFatal(config.mapEntry.size <= sizeof(float), "PipelineLibrary: Invalid pipeline file!");
-				}
-				uint32_t specializationDataSize = dataSize;
-				stageSpecialization.specializationData = new char[specializationDataSize];
-				for (auto& config : specialization.configs) {
-					std::memcpy(stageSpecialization.specializationData + config.mapEntry.offset, &config.dataUint32,
-								config.mapEntry.size);
-				}
-
-				stageSpecialization.specializationInfo = { .mapEntryCount = static_cast<uint32_t>(
-															   stageSpecialization.mapEntries.size()),
-														   .pMapEntries = stageSpecialization.mapEntries.data(),
-														   .dataSize = specializationDataSize,
-														   .pData = stageSpecialization.specializationData };
-				instance.stageSpecializations.push_back(std::move(stageSpecialization));
-
-				auto stageIterator = std::find_if(
-					instance.shaderStageCreateInfos.begin(), instance.shaderStageCreateInfos.end(),
-					[&stageSpecialization](const auto& stage) { return stage.stage == stageSpecialization.stage; });
-				stageIterator->pSpecializationInfo = &instance.stageSpecializations.back().specializationInfo;
-			}
-
-			instance.shaderStageCreateInfos = stageCreateInfos;
+										  .logicOpEnable = entry.colorBlendConfig.logicOpEnable,
+										  .logicOp = entry.colorBlendConfig.logicOp,
+										  .attachmentCount = static_cast<uint32_t>(colorAttachmentBlendConfigs.size()),
+										  .pAttachments = colorAttachmentBlendConfigs.data(),
+										  .blendConstants = { entry.colorBlendConfig.blendConstants[0],
+															  entry.colorBlendConfig.blendConstants[1],
+															  entry.colorBlendConfig.blendConstants[2],
+															  entry.colorBlendConfig.blendConstants[3] } };
+
+			auto dynamicStates = m_libraryView.elements(entry.dynamicStates);
+			instance.dynamicStateConfig = { .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+											.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size()),
+											.pDynamicStates = dynamicStates.data() };
 
+			auto viewports = m_libraryView.elements(entry.viewports);
+			auto scissorRects = m_libraryView.elements(entry.scissorRects);
 			instance.viewportConfig = { .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
-										.viewportCount = static_cast<uint32_t>(instance.viewports.size()),
-										.pViewports = instance.viewports.data(),
-										.scissorCount = static_cast<uint32_t>(instance.scissorRects.size()),
-										.pScissors = instance.scissorRects.data() };
-
-			instance.dynamicStateConfig = { .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
-											.dynamicStateCount = static_cast<uint32_t>(instance.dynamicStates.size()),
-											.pDynamicStates = instance.dynamicStates.data() };
-
-			instance.pipelineCreateInfo =
-				VkGraphicsPipelineCreateInfo{ .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-											  .stageCount =
-												  static_cast<uint32_t>(instance.shaderStageCreateInfos.size()),
-											  .pStages = instance.shaderStageCreateInfos.data(),
-											  .pVertexInputState = &instance.vertexInputConfig,
-											  .pInputAssemblyState = &instance.inputAssemblyConfig,
-											  .pViewportState = &instance.viewportConfig,
-											  .pRasterizationState = &instance.rasterizationConfig,
-											  .pMultisampleState = &instance.multisampleConfig,
-											  .pDepthStencilState = &instance.depthStencilConfig,
-											  .pColorBlendState = &instance.colorBlendConfig,
-											  .pDynamicState = &instance.dynamicStateConfig,
-											  .layout = layout };
-
-			if constexpr (vanadiumGPUDebug) {
-				setObjectName(m_deviceContext->device(), VK_OBJECT_TYPE_PIPELINE_LAYOUT,
-							  instance.pipelineCreateInfo.layout, instance.name + " Pipeline Layout");
-			}
+										.viewportCount = static_cast<uint32_t>(viewports.size()),
+										.pViewports = viewports.data(),
+										.scissorCount = static_cast<uint32_t>(scissorRects.size()),
+										.pScissors = scissorRects.data() };
 
 			m_graphicsInstances.push_back(std::move(instance));
 		}
 	}
 
-	void PipelineLibrary::createComputePipeline() {
-		std::vector<CompiledShader> shaders = deserializeVector<CompiledShader>(m_fileStream);
-		std::vector<VkShaderModule> shaderModules;
-		shaderModules.reserve(shaders.size());
-
-		for (auto& shader : shaders) {
-			VkShaderModuleCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-													.codeSize = shader.dataSize,
-													.pCode = reinterpret_cast<uint32_t*>(shader.data) };
-			VkShaderModule shaderModule;
-			verifyResult(vkCreateShaderModule(m_deviceContext->device(), &createInfo, nullptr, &shaderModule));
-			shaderModules.push_back(shaderModule);
-		}
-
-		assertFatal(shaders.size() == 1, "PipelineLibrary: Invalid pipeline file!");
-
-		VkPipelineShaderStageCreateInfo stageInfo = { .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-													  .stage = VK_SHADER_STAGE_COMPUTE_BIT,
-													  .module = shaderModules[0],
-													  .pName = "main" };
-
-		std::vector<VkDescriptorSetLayout> setLayouts;
-		std::vector<uint32_t> setLayoutIndices = deserializeVector<uint32_t>(m_fileStream);
-		setLayouts.reserve(setLayoutIndices.size());
-
-		for (auto& index : setLayoutIndices) {
-			setLayouts.push_back(m_descriptorSetLayouts[index].layout);
-		}
-
-		std::vector<VkPushConstantRange> pushConstantRanges = deserializeVector<VkPushConstantRange>(m_fileStream);
-
-		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = { .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-																.setLayoutCount =
-																	static_cast<uint32_t>(setLayouts.size()),
-																.pSetLayouts = setLayouts.data(),
-																.pushConstantRangeCount =
-																	static_cast<uint32_t>(pushConstantRanges.size()),
-																.pPushConstantRanges = pushConstantRanges.data() };
-		VkPipelineLayout layout;
-		verifyResult(vkCreatePipelineLayout(m_deviceContext->device(), &pipelineLayoutCreateInfo, nullptr, &layout));
-
-		m_archetypes.push_back({ .type = PipelineType::Compute,
-								 .shaderModules = {},
-								 .setLayoutIndices = std::move(setLayoutIndices),
-								 .pushConstantRanges = std::move(pushConstantRanges) });
-
-		std::vector<PipelineInstanceData> fileInstances = deserializeVector<PipelineInstanceData>(m_fileStream);
-		std::vector<PipelineLibraryGraphicsInstance> instances;
-		instances.reserve(fileInstances.size());
-		PipelineLibraryStageSpecialization stageSpecialization = {};
-
-		for (auto& fileInstance : fileInstances) {
-			PipelineLibraryComputeInstance instance = { .archetypeID =
-															static_cast<uint32_t>(m_archetypes.size() - 1ULL),
-														.name = fileInstance.name };
-
-			for (auto& specialization : fileInstance.instanceSpecializationConfigs) {
-				stageSpecialization.stage = specialization.stage;
-				stageSpecialization.mapEntries.reserve(specialization.configs.size());
-				size_t dataSize = 0;
-				for (auto& config : specialization.configs) {
-					stageSpecialization.mapEntries.push_back(config.mapEntry);
-					dataSize = std::max(dataSize, config.mapEntry.offset + config.mapEntry.size);
-					assertFatal(config.mapEntry.size <= sizeof(float), "PipelineLibrary: Invalid pipeline file!");
-				}
-				uint32_t specializationDataSize = dataSize;
-				stageSpecialization.specializationData = new char[specializationDataSize];
-				for (auto& config : specialization.configs) {
-					std::memcpy(stageSpecialization.specializationData + config.mapEntry.offset, &config.dataUint32,
-								config.mapEntry.size);
-				}
+	void PipelineLibrary::createComputeInstances() {
+		m_computeInstances.reserve(m_libraryView.computeInstances().size());
+		for (auto& entry : m_libraryView.computeInstances()) {
+			// The module is filled in by createComputePipelines
+			PipelineLibraryComputeCreation creation = {
+				.instanceID = static_cast<uint32_t>(m_computeInstances.size()),
+				.createInfo = { .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+								.stage = { .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+										   .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+										   .module = VK_NULL_HANDLE,
+										   .pName = "main" },
+								.layout = m_archetypes[entry.archetypeIndex].layout }
+			};
+			for (auto& specialization : m_libraryView.elements(entry.specializations)) {
+				creation.specialization = stageSpecialization(specialization);
+			}
+
+			m_computeInstances.push_back({ .archetypeID = entry.archetypeIndex,
+										   .name = m_libraryView.name(entry),
+										   .pipeline = VK_NULL_HANDLE });
+			m_computeCreations.push_back(std::move(creation));
+		}
+	}
 
-				stageSpecialization.specializationInfo = { .mapEntryCount = static_cast<uint32_t>(
-															   stageSpecialization.mapEntries.size()),
-														   .pMapEntries = stageSpecialization.mapEntries.data(),
-														   .dataSize = specializationDataSize,
-														   .pData = stageSpecialization.specializationData };
+	PipelineLibraryStageSpecialization PipelineLibrary::stageSpecialization(
+		const VCPStageSpecializationEntry& entry) const {
+		auto mapEntries = m_libraryView.elements(entry.mapEntries);
+		auto data = m_libraryView.elements(entry.data);
+		return { .stage = entry.stage,
+				 .specializationInfo = { .mapEntryCount = static_cast<uint32_t>(mapEntries.size()),
+										 .pMapEntries = mapEntries.data(),
+										 .dataSize = data.size(),
+										 .pData = data.data() } };
+	}
 
-				stageInfo.pSpecializationInfo = &stageSpecialization.specializationInfo;
+	void PipelineLibrary::createShaderModules() {
+		m_compilationWorkers.dispatch(m_shaderModuleCreations.size(), [this](size_t jobIndex, uint32_t) {
+			auto& creation = m_shaderModuleCreations[jobIndex];
+			verifyResult(
+				vkCreateShaderModule(m_deviceContext->device(), &creation.createInfo, nullptr, &creation.module));
+		});
+		m_compilationWorkers.wait();
+
+		// The first use adds the module to the cache, every further use takes another reference
+		std::vector<bool> isAdded = std::vector<bool>(m_shaderModuleCreations.size(), false);
+		for (auto& use : m_shaderModuleUses) {
+			auto& creation = m_shaderModuleCreations[use.creationIndex];
+			if (!isAdded[use.creationIndex]) {
+				creation.module = m_objectCache->addShaderModule(creation.key, creation.module);
+				isAdded[use.creationIndex] = true;
+			} else {
+				m_objectCache->acquireShaderModule(creation.key);
 			}
+			m_archetypes[use.archetypeID].shaderModules[use.moduleIndex] = creation.module;
+		}
+		m_shaderModuleCreations.clear();
+		m_shaderModuleUses.clear();
 
-			VkComputePipelineCreateInfo computeCreateInfo = { .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
-															  .stage = stageInfo,
-															  .layout = layout };
-			verifyResult(vkCreateComputePipelines(m_deviceContext->device(), VK_NULL_HANDLE, 1, &computeCreateInfo,
-												  nullptr, &instance.pipeline));
-			instance.layout = layout;
-
-			if constexpr (vanadiumGPUDebug) {
-				setObjectName(m_deviceContext->device(), VK_OBJECT_TYPE_PIPELINE, instance.pipeline, instance.name);
-				setObjectName(m_deviceContext->device(), VK_OBJECT_TYPE_PIPELINE_LAYOUT, instance.layout,
-							  instance.name + " Pipeline Layout");
+		for (auto& instance : m_graphicsInstances) {
+			auto& archetype = m_archetypes[instance.archetypeID];
+			for (size_t i = 0; i < instance.shaderStageCreateInfos.size(); ++i) {
+				instance.shaderStageCreateInfos[i].module = archetype.shaderModules[i];
 			}
+		}
+	}
 
-			m_computeInstances.push_back(std::move(instance));
+	void PipelineLibrary::createComputePipelines() {
+		// Pointers into the creations are only stable once all of them were added
+		for (auto& creation : m_computeCreations) {
+			auto& instance = m_computeInstances[creation.instanceID];
+			creation.createInfo.stage.module = m_archetypes[instance.archetypeID].shaderModules[0];
+			if (creation.specialization.has_value()) {
+				creation.createInfo.stage.pSpecializationInfo = &creation.specialization->specializationInfo;
+			}
+		}
 
-			vkDestroyShaderModule(m_deviceContext->device(), shaderModules[0], nullptr);
+		m_compilationWorkers.dispatch(m_computeCreations.size(), [this](size_t jobIndex, uint32_t) {
+			auto& creation = m_computeCreations[jobIndex];
+			verifyResult(vkCreateComputePipelines(m_deviceContext->device(), m_pipelineCache, 1, &creation.createInfo,
+												  nullptr, &m_computeInstances[creation.instanceID].pipeline));
+		});
+		m_compilationWorkers.wait();
+
+		if constexpr (vanadiumGPUDebug) {
+			for (auto& instance : m_computeInstances) {
+				setObjectName(m_deviceContext->device(), VK_OBJECT_TYPE_PIPELINE, instance.pipeline,
+							  std::string(instance.name));
+			}
 		}
+		m_computeCreations.clear();
 	}
 
 	std::vector<DescriptorSetLayoutInfo> PipelineLibrary::graphicsPipelineSets(uint32_t id) {
@@ -466,42 +639,58 @@ namespace vanadium::graphics {
 		return result;
 	}
 
-	uint32_t PipelineLibrary::findGraphicsPipeline(const std::string_view& name) {
-		auto iterator = std::find_if(m_graphicsInstances.begin(), m_graphicsInstances.end(),
-									 [name](const auto& instance) { return instance.name == name; });
-		if (iterator == m_graphicsInstances.end())
-			return ~0U;
-		return iterator - m_graphicsInstances.begin();
+	uint32_t PipelineLibrary::findGraphicsPipeline(const std::string_view& name) const {
+		return m_libraryView.findGraphicsInstance(name);
 	}
-	uint32_t PipelineLibrary::findComputePipeline(const std::string_view& name) {
-		auto iterator = std::find_if(m_computeInstances.begin(), m_computeInstances.end(),
-									 [name](const auto& instance) { return instance.name == name; });
-		if (iterator == m_computeInstances.end())
-			return ~0U;
-		return iterator - m_computeInstances.begin();
+	uint32_t PipelineLibrary::findComputePipeline(const std::string_view& name) const {
+		return m_libraryView.findComputeInstance(name);
 	}
 
 	void PipelineLibrary::destroy() {
-		for (auto& sampler : m_immutableSamplers) {
-			vkDestroySampler(m_deviceContext->device(), sampler, nullptr);
+		stopPrecompilation();
+		m_compilationWorkers.destroy();
+		writeUsageLog();
+		logInfo("PipelineLibrary: Created {} pipelines on first use and {} in the background, spent {} ms in "
+				"createForPass with a {} pipeline cache.",
+				m_onDemandPipelineCount.load(), m_precompiledPipelineCount.load(), m_passPipelineCreationMilliseconds,
+				m_isPipelineCacheWarm ? "warm" : "cold");
+		savePipelineCache();
+		vkDestroyPipelineCache(m_deviceContext->device(), m_pipelineCache, nullptr);
+
+		for (auto& pipelines : m_graphicsPipelines) {
+			pipelines->forEachReady([this](const RenderPassSignature&, VkPipeline pipeline) {
+				vkDestroyPipeline(m_deviceContext->device(), pipeline, nullptr);
+			});
 		}
-		for (auto& layout : m_descriptorSetLayouts) {
-			vkDestroyDescriptorSetLayout(m_deviceContext->device(), layout.layout, nullptr);
+		m_graphicsPipelines.clear();
+		for (auto& instance : m_computeInstances) {
+			vkDestroyPipeline(m_deviceContext->device(), instance.pipeline, nullptr);
 		}
+		// Objects shared with other libraries are destroyed with their last user
 		for (auto& archetype : m_archetypes) {
 			for (auto& shader : archetype.shaderModules) {
-				vkDestroyShaderModule(m_deviceContext->device(), shader, nullptr);
+				m_objectCache->releaseShaderModule(shader);
 			}
+			m_objectCache->releasePipelineLayout(archetype.layout);
 		}
-		for (auto& instance : m_graphicsInstances) {
-			vkDestroyPipelineLayout(m_deviceContext->device(), instance.pipelineCreateInfo.layout, nullptr);
-			for (auto& signaturePair : instance.pipelines) {
-				vkDestroyPipeline(m_deviceContext->device(), signaturePair.second, nullptr);
-			}
+		for (auto& layout : m_descriptorSetLayouts) {
+			m_objectCache->releaseDescriptorSetLayout(layout.layout);
 		}
-		for (auto& instance : m_computeInstances) {
-			vkDestroyPipelineLayout(m_deviceContext->device(), instance.layout, nullptr);
-			vkDestroyPipeline(m_deviceContext->device(), instance.pipeline, nullptr);
+		for (auto& sampler : m_immutableSamplers) {
+			m_objectCache->releaseSampler(sampler);
+		}
+		if (m_objectCache == &m_ownedObjectCache) {
+			m_ownedObjectCache.destroy();
 		}
+		m_archetypes.clear();
+		m_descriptorSetLayouts.clear();
+		m_immutableSamplers.clear();
+
+		// Instance names point into the library file
+		m_graphicsInstances.clear();
+		m_computeInstances.clear();
+		// Shader modules still used by other libraries keep the code alive
+		m_libraryFile.reset();
+		m_convertedLibrary.reset();
 	}
 } // namespace vanadium::graphics
@@ -0,0 +1,111 @@
+#include <graphics/pipelines/PipelineObjectCache.hpp>
+#include <Log.hpp>
+#include <graphics/helper/DebugHelper.hpp>
+#include <graphics/helper/ErrorHelper.hpp>
+#include <graphics/util/PipelineObjectKeys.hpp>
+#include <volk.h>
+
+namespace vanadium::graphics {
+	void PipelineObjectCache::create(DeviceContext* deviceContext) { m_deviceContext = deviceContext; }
+
+	template <typename T> void PipelineObjectCache::nameObject(VkObjectType type, T handle, const char* typeName) {
+		if constexpr (vanadiumGPUDebug) {
+			setObjectName(m_deviceContext->device(), type, handle,
+						  std::string("Shared ") + typeName + " " + std::to_string(m_namedObjectCount++));
+		}
+	}
+
+	VkSampler PipelineObjectCache::acquireSampler(const VkSamplerCreateInfo& createInfo) {
+		return m_samplers.acquireOrCreate(samplerKey(createInfo), [this, &createInfo]() {
+			VkSampler sampler;
+			verifyResult(vkCreateSampler(m_deviceContext->device(), &createInfo, nullptr, &sampler));
+			nameObject(VK_OBJECT_TYPE_SAMPLER, sampler, "Sampler");
+			return sampler;
+		});
+	}
+
+	VkDescriptorSetLayout PipelineObjectCache::acquireDescriptorSetLayout(
+		const VkDescriptorSetLayoutCreateInfo& createInfo) {
+		return m_descriptorSetLayouts.acquireOrCreate(descriptorSetLayoutKey(createInfo), [this, &createInfo]() {
+			VkDescriptorSetLayout layout;
+			verifyResult(vkCreateDescriptorSetLayout(m_deviceContext->device(), &createInfo, nullptr, &layout));
+			nameObject(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, layout, "Descriptor Set Layout");
+			return layout;
+		});
+	}
+
+	VkPipelineLayout PipelineObjectCache::acquirePipelineLayout(const VkPipelineLayoutCreateInfo& createInfo) {
+		return m_pipelineLayouts.acquireOrCreate(pipelineLayoutKey(createInfo), [this, &createInfo]() {
+			VkPipelineLayout layout;
+			verifyResult(vkCreatePipelineLayout(m_deviceContext->device(), &createInfo, nullptr, &layout));
+			nameObject(VK_OBJECT_TYPE_PIPELINE_LAYOUT, layout, "Pipeline Layout");
+			return layout;
+		});
+	}
+
+	std::optional<VkShaderModule> PipelineObjectCache::acquireShaderModule(const ShaderModuleKey& key) {
+		return m_shaderModules.acquire(key);
+	}
+
+	VkShaderModule PipelineObjectCache::addShaderModule(const ShaderModuleKey& key, VkShaderModule module) {
+		VkShaderModule addedModule = m_shaderModules.add(key, module, [this](VkShaderModule duplicateModule) {
+			vkDestroyShaderModule(m_deviceContext->device(), duplicateModule, nullptr);
+		});
+		if (addedModule == module) {
+			nameObject(VK_OBJECT_TYPE_SHADER_MODULE, module, "Shader Module");
+		}
+		return addedModule;
+	}
+
+	void PipelineObjectCache::releaseSampler(VkSampler sampler) {
+		m_samplers.release(sampler, [this](VkSampler unusedSampler) {
+			vkDestroySampler(m_deviceContext->device(), unusedSampler, nullptr);
+		});
+	}
+
+	void PipelineObjectCache::releaseDescriptorSetLayout(VkDescriptorSetLayout layout) {
+		m_descriptorSetLayouts.release(layout, [this](VkDescriptorSetLayout unusedLayout) {
+			vkDestroyDescriptorSetLayout(m_deviceContext->device(), unusedLayout, nullptr);
+		});
+	}
+
+	void PipelineObjectCache::releasePipelineLayout(VkPipelineLayout layout) {
+		m_pipelineLayouts.release(layout, [this](VkPipelineLayout unusedLayout) {
+			vkDestroyPipelineLayout(m_deviceContext->device(), unusedLayout, nullptr);
+		});
+	}
+
+	void PipelineObjectCache::releaseShaderModule(VkShaderModule module) {
+		m_shaderModules.release(module, [this](VkShaderModule unusedModule) {
+			vkDestroyShaderModule(m_deviceContext->device(), unusedModule, nullptr);
+		});
+	}
+
+	PipelineObjectCounts PipelineObjectCache::objectCounts() const {
+		return { .samplerCount = m_samplers.size(),
+				 .descriptorSetLayoutCount = m_descriptorSetLayouts.size(),
+				 .pipelineLayoutCount = m_pipelineLayouts.size(),
+				 .shaderModuleCount = m_shaderModules.size() };
+	}
+
+	void PipelineObjectCache::destroy() {
+		auto counts = objectCounts();
+		size_t remainingCount = counts.samplerCount + counts.descriptorSetLayoutCount + counts.pipelineLayoutCount +
+								counts.shaderModuleCount;
+		if (remainingCount > 0) {
+			logWarning("PipelineObjectCache: {} objects are still referenced on destruction.", remainingCount);
+		}
+
+		// Pipeline layouts reference set layouts, which reference samplers
+		m_pipelineLayouts.clear([this](VkPipelineLayout layout) {
+			vkDestroyPipelineLayout(m_deviceContext->device(), layout, nullptr);
+		});
+		m_descriptorSetLayouts.clear([this](VkDescriptorSetLayout layout) {
+			vkDestroyDescriptorSetLayout(m_deviceContext->device(), layout, nullptr);
+		});
+		m_samplers.clear(
+			[this](VkSampler sampler) { vkDestroySampler(m_deviceContext->device(), sampler, nullptr); });
+		m_shaderModules.clear(
+			[this](VkShaderModule module) { vkDestroyShaderModule(m_deviceContext->device(), module, nullptr); });
+	}
+} // namespace vanadium::graphics
@@ -0,0 +1,23 @@
+#include <algorithm>
+#include <cmath>
+#include <graphics/util/AllocationPlacement.hpp>
+
+namespace vanadium::graphics {
+
+	bool shouldUseDedicatedAllocation(const DedicatedAllocationQuery& query, VkDeviceSize blockSize) {
+		return query.requiresDedicatedAllocation || query.prefersDedicatedAllocation || query.size > blockSize / 2;
+	}
+
+	float quantizeMemoryPriority(float priority) {
+		if (std::isnan(priority)) {
+			return defaultMemoryPriority;
+		}
+		float bestLevel = memoryPriorityLevels[0];
+		for (auto level : memoryPriorityLevels) {
+			if (std::abs(level - priority) < std::abs(bestLevel - priority)) {
+				bestLevel = level;
+			}
+		}
+		return bestLevel;
+	}
+} // namespace vanadium::graphics
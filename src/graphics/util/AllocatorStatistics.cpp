@@ -0,0 +1,94 @@
+#include <fmt/format.h>
+#include <graphics/util/AllocatorStatistics.hpp>
+#include <iterator>
+
+namespace vanadium::graphics {
+
+	float MemoryUsageStatistics::fragmentation() const {
+		VkDeviceSize freeSize = size - usedSize;
+		if (!freeSize)
+			return 0.0f;
+		return 1.0f - static_cast<float>(largestFreeRange) / static_cast<float>(freeSize);
+	}
+
+	MemoryUsageStatistics& MemoryUsageStatistics::operator+=(const MemoryUsageStatistics& other) {
+		blockCount += other.blockCount;
+		allocationCount += other.allocationCount;
+		freeRangeCount += other.freeRangeCount;
+		size += other.size;
+		usedSize += other.usedSize;
+		largestFreeRange = std::max(largestFreeRange, other.largestFreeRange);
+		return *this;
+	}
+
+	MemoryUsageStatistics blockStatistics(const RangeAllocator& freeRanges, VkDeviceSize blockSize,
+										  size_t allocationCount) {
+		return { .blockCount = 1,
+				 .allocationCount = allocationCount,
+				 .freeRangeCount = freeRanges.freeRangeCount(),
+				 .size = blockSize,
+				 .usedSize = blockSize - freeRanges.freeSize(),
+				 .largestFreeRange = freeRanges.maxAllocatableSize() };
+	}
+
+	static void appendUsage(std::string& json, const MemoryUsageStatistics& usage) {
+		fmt::format_to(std::back_inserter(json),
+					   "{{ \"blockCount\": {}, \"allocationCount\": {}, \"freeRangeCount\": {}, \"size\": {}, "
+					   "\"usedSize\": {}, \"largestFreeRange\": {}, \"fragmentation\": {} }}",
+					   usage.blockCount, usage.allocationCount, usage.freeRangeCount, usage.size, usage.usedSize,
+					   usage.largestFreeRange, usage.fragmentation());
+	}
+
+	static void appendBlockList(std::string& json, const std::vector<MemoryUsageStatistics>& blocks,
+								const std::string_view& indentation) {
+		if (blocks.empty()) {
+			json += "[]";
+			return;
+		}
+		json += "[\n";
+		for (size_t i = 0; i < blocks.size(); ++i) {
+			json += indentation;
+			json += '\t';
+			appendUsage(json, blocks[i]);
+			json += i + 1 < blocks.size() ? ",\n" : "\n";
+		}
+		json += indentation;
+		json += ']';
+	}
+
+	std::string statisticsToJSON(const AllocatorStatistics& statistics) {
+		std::string json = "{\n\t\"total\": ";
+		appendUsage(json, statistics.total);
+
+		json += ",\n\t\"heaps\": [\n";
+		for (size_t i = 0; i < statistics.heaps.size(); ++i) {
+			auto& heap = statistics.heaps[i];
+			fmt::format_to(std::back_inserter(json), "\t\t{{ \"index\": {}, \"remainingBudget\": {}, \"usage\": ", i,
+						   heap.remainingBudget);
+			appendUsage(json, heap.usage);
+			json += i + 1 < statistics.heaps.size() ? " },\n" : " }\n";
+		}
+
+		json += "\t],\n\t\"memoryTypes\": [\n";
+		for (size_t i = 0; i < statistics.memoryTypes.size(); ++i) {
+			auto& type = statistics.memoryTypes[i];
+			fmt::format_to(std::back_inserter(json),
+						   "\t\t{{\n\t\t\t\"index\": {},\n\t\t\t\"heapIndex\": {},\n\t\t\t\"properties\": {},\n"
+						   "\t\t\t\"usage\": ",
+						   i, type.heapIndex, type.properties);
+			appendUsage(json, type.usage);
+			json += ",\n\t\t\t\"bufferBlocks\": ";
+			appendBlockList(json, type.bufferBlocks, "\t\t\t");
+			json += ",\n\t\t\t\"imageBlocks\": ";
+			appendBlockList(json, type.imageBlocks, "\t\t\t");
+			json += i + 1 < statistics.memoryTypes.size() ? "\n\t\t},\n" : "\n\t\t}\n";
+		}
+
+		json += "\t],\n\t\"customBufferBlocks\": ";
+		appendBlockList(json, statistics.customBufferBlocks, "\t");
+		json += ",\n\t\"customImageBlocks\": ";
+		appendBlockList(json, statistics.customImageBlocks, "\t");
+		json += "\n}\n";
+		return json;
+	}
+} // namespace vanadium::graphics
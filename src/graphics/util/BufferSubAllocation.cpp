@@ -0,0 +1,27 @@
+#include <algorithm>
+#include <graphics/util/BufferSubAllocation.hpp>
+#include <graphics/util/RangeAllocator.hpp>
+
+namespace vanadium::graphics {
+
+	VkDeviceSize subAllocationAlignment(VkBufferUsageFlags usage, const VkPhysicalDeviceLimits& limits,
+										VkDeviceSize nonCoherentAtomSize) {
+		// Index buffers need offsets aligned to the index size, which is at most 4
+		VkDeviceSize alignment = std::max(nonCoherentAtomSize, VkDeviceSize(4));
+		// All limits are powers of two, so the largest one is a multiple of all others
+		if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) {
+			alignment = std::max(alignment, limits.minUniformBufferOffsetAlignment);
+		}
+		if (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT) {
+			alignment = std::max(alignment, limits.minStorageBufferOffsetAlignment);
+		}
+		if (usage & (VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT)) {
+			alignment = std::max(alignment, limits.minTexelBufferOffsetAlignment);
+		}
+		return alignment;
+	}
+
+	VkDeviceSize subAllocationFrameStride(VkDeviceSize size, VkDeviceSize alignment) {
+		return roundUpAligned(size, alignment);
+	}
+} // namespace vanadium::graphics
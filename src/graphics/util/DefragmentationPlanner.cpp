@@ -0,0 +1,85 @@
+#include <Log.hpp>
+#include <algorithm>
+#include <graphics/util/DefragmentationPlanner.hpp>
+
+namespace vanadium::graphics {
+
+	void DefragmentationPlanner::addBlock(SlotmapHandle blockHandle, RangeAllocator* freeRanges,
+										  VkDeviceSize blockSize) {
+		m_blocks.push_back({ .handle = blockHandle, .freeRanges = freeRanges, .size = blockSize });
+	}
+
+	void DefragmentationPlanner::addAllocation(SlotmapHandle blockHandle, const DefragmentationAllocation& allocation) {
+		auto blockIterator = std::find_if(m_blocks.begin(), m_blocks.end(),
+										  [blockHandle](const auto& block) { return block.handle == blockHandle; });
+		assertFatal(blockIterator != m_blocks.end(), "Defragmentation allocation is in an unknown block!");
+		blockIterator->movableSize += allocation.allocationRange.size;
+		blockIterator->allocations.push_back(allocation);
+	}
+
+	std::vector<DefragmentationMove> DefragmentationPlanner::planMoves(VkDeviceSize maxBytesToMove) {
+		auto usedSize = [](const Block& block) { return block.size - block.freeRanges->freeSize(); };
+		// most used blocks first, these are the preferred destinations
+		std::stable_sort(m_blocks.begin(), m_blocks.end(),
+						 [usedSize](const auto& one, const auto& other) { return usedSize(one) > usedSize(other); });
+
+		std::vector<DefragmentationMove> moves;
+		VkDeviceSize movedBytes = 0;
+
+		// Destinations are only searched in more used blocks, so blocks that allocations were moved out of never
+		// receive allocations
+		for (size_t srcIndex = m_blocks.size() - 1; srcIndex > 0 && srcIndex < m_blocks.size(); --srcIndex) {
+			auto& srcBlock = m_blocks[srcIndex];
+			if (srcBlock.allocations.empty() || srcBlock.movableSize != usedSize(srcBlock)) {
+				continue;
+			}
+
+			// large allocations are the hardest to place, try them while there is the most free space
+			std::sort(srcBlock.allocations.begin(), srcBlock.allocations.end(),
+					  [](const auto& one, const auto& other) { return one.size > other.size; });
+
+			// Moving only some allocations wouldn't free the block, so the block's moves are only kept if all of its
+			// allocations can be placed
+			size_t firstBlockMove = moves.size();
+			for (auto& allocation : srcBlock.allocations) {
+				for (size_t dstIndex = 0; dstIndex < srcIndex; ++dstIndex) {
+					auto result = m_blocks[dstIndex].freeRanges->allocate(allocation.alignment, allocation.size);
+					if (result.has_value()) {
+						moves.push_back({ .resourceHandle = allocation.resourceHandle,
+										  .srcBlockHandle = srcBlock.handle,
+										  .dstBlockHandle = m_blocks[dstIndex].handle,
+										  .srcAllocationRange = allocation.allocationRange,
+										  .dstAllocation = result.value(),
+										  .size = allocation.size });
+						break;
+					}
+				}
+			}
+			if (moves.size() - firstBlockMove != srcBlock.allocations.size()) {
+				releaseDestinations(moves, firstBlockMove);
+				continue;
+			}
+
+			// The remaining moves of a block that exceeds the budget are planned again by the next call
+			for (size_t i = firstBlockMove; i < moves.size(); ++i) {
+				if (movedBytes + moves[i].size > maxBytesToMove) {
+					releaseDestinations(moves, i);
+					return moves;
+				}
+				movedBytes += moves[i].size;
+			}
+		}
+		return moves;
+	}
+
+	void DefragmentationPlanner::releaseDestinations(std::vector<DefragmentationMove>& moves, size_t firstMove) {
+		for (size_t i = firstMove; i < moves.size(); ++i) {
+			auto dstBlock = std::find_if(m_blocks.begin(), m_blocks.end(), [&moves, i](const auto& block) {
+				return block.handle == moves[i].dstBlockHandle;
+			});
+			dstBlock->freeRanges->free(moves[i].dstAllocation.allocationRange.offset,
+									   moves[i].dstAllocation.allocationRange.size);
+		}
+		moves.erase(moves.begin() + firstMove, moves.end());
+	}
+} // namespace vanadium::graphics
@@ -0,0 +1,54 @@
+#include <graphics/util/FramegraphResize.hpp>
+#include <algorithm>
+
+namespace vanadium::graphics {
+	namespace {
+		bool isSameReference(const VkAttachmentReference& first, const VkAttachmentReference& second) {
+			return first.attachment == second.attachment && first.layout == second.layout;
+		}
+
+		bool haveSameReferences(const std::vector<VkAttachmentReference>& first,
+								const std::vector<VkAttachmentReference>& second) {
+			return std::equal(first.begin(), first.end(), second.begin(), second.end(), isSameReference);
+		}
+
+		bool isSameAttachment(const MergedAttachment& first, const MergedAttachment& second) {
+			return first.resource == second.resource && first.format == second.format &&
+				   first.sampleCount == second.sampleCount && first.loadOp == second.loadOp &&
+				   first.storeOp == second.storeOp && first.initialLayout == second.initialLayout &&
+				   first.finalLayout == second.finalLayout;
+		}
+
+		bool isSameSubpass(const MergedSubpass& first, const MergedSubpass& second) {
+			return first.nodeIndex == second.nodeIndex &&
+				   haveSameReferences(first.colorAttachments, second.colorAttachments) &&
+				   isSameReference(first.depthStencilAttachment, second.depthStencilAttachment) &&
+				   haveSameReferences(first.inputAttachments, second.inputAttachments) &&
+				   first.preserveAttachments == second.preserveAttachments;
+		}
+	} // namespace
+
+	bool haveSameRenderPass(const MergedRenderPass& first, const MergedRenderPass& second) {
+		return std::equal(first.attachments.begin(), first.attachments.end(), second.attachments.begin(),
+						  second.attachments.end(), isSameAttachment) &&
+			   std::equal(first.subpasses.begin(), first.subpasses.end(), second.subpasses.begin(),
+						  second.subpasses.end(), isSameSubpass);
+	}
+
+	FramegraphResizeActions planFramegraphResize(const CompilationKey& appliedKey, const CompilationKey& resizedKey,
+												 const std::vector<MergedRenderPass>& appliedPlans,
+												 const std::vector<MergedRenderPass>& resizedPlans,
+												 const std::vector<bool>& usesTargetExtent) {
+		FramegraphResizeActions actions = { .updatesCompilation = appliedKey != resizedKey };
+		actions.recreatesRenderPass.reserve(resizedPlans.size());
+		actions.recreatesFramebuffers.reserve(resizedPlans.size());
+		for (size_t i = 0; i < resizedPlans.size(); ++i) {
+			bool recreatesRenderPass =
+				i >= appliedPlans.size() || !haveSameRenderPass(appliedPlans[i], resizedPlans[i]);
+			actions.recreatesRenderPass.push_back(recreatesRenderPass);
+			actions.recreatesFramebuffers.push_back(recreatesRenderPass || usesTargetExtent[i] ||
+													actions.updatesCompilation);
+		}
+		return actions;
+	}
+} // namespace vanadium::graphics
@@ -1,3 +1,5 @@
+#include <Log.hpp>
+#include <algorithm>
 #include <bit>
 #include <graphics/helper/ErrorHelper.hpp>
 #include <graphics/util/GPUResourceAllocator.hpp>
@@ -6,6 +8,23 @@
 
 namespace vanadium::graphics {
 
+	static VkImageAspectFlags aspectFlagsForFormat(VkFormat format) {
+		switch (format) {
+			case VK_FORMAT_D16_UNORM:
+			case VK_FORMAT_X8_D24_UNORM_PACK32:
+			case VK_FORMAT_D32_SFLOAT:
+				return VK_IMAGE_ASPECT_DEPTH_BIT;
+			case VK_FORMAT_S8_UINT:
+				return VK_IMAGE_ASPECT_STENCIL_BIT;
+			case VK_FORMAT_D16_UNORM_S8_UINT:
+			case VK_FORMAT_D24_UNORM_S8_UINT:
+			case VK_FORMAT_D32_SFLOAT_S8_UINT:
+				return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+			default:
+				return VK_IMAGE_ASPECT_COLOR_BIT;
+		}
+	}
+
 	void GPUResourceAllocator::create(DeviceContext* gpuContext) {
 		m_bufferFreeList.resize(frameInFlightCount);
 		m_imageFreeList.resize(frameInFlightCount);
@@ -84,22 +103,85 @@ namespace vanadium::graphics {
 		return allocateCustomBlock(typeIndex, size, false, true);
 	}
 
-	BufferResourceHandle GPUResourceAllocator::createBuffer(const VkBufferCreateInfo& bufferCreateInfo,
-															MemoryCapabilities required, MemoryCapabilities preferred,
-															bool createMapped) {
+	BlockHandle GPUResourceAllocator::createAliasingBlock(VkDeviceSize size, uint32_t memoryTypeBits,
+														  MemoryCapabilities required, MemoryCapabilities preferred,
+														  bool isImageBlock) {
 		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
 		VkMemoryPropertyFlags requiredFlags = (required.deviceLocal ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : 0) |
 											  (required.hostCoherent ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0) |
-											  (required.hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0);
+											  ((required.hostVisible) ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0);
 		VkMemoryPropertyFlags preferredFlags = (preferred.deviceLocal ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : 0) |
 											   (preferred.hostCoherent ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0) |
 											   (preferred.hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0);
 
+		uint32_t typeIndex =
+			bestTypeIndex(requiredFlags, preferredFlags, { .size = size, .memoryTypeBits = memoryTypeBits }, false);
+		if (typeIndex == ~0U) {
+			return ~0U;
+		}
+		return allocateCustomBlock(typeIndex, size, false, isImageBlock);
+	}
+
+	VkMemoryRequirements GPUResourceAllocator::queryBufferMemoryRequirements(
+		const VkBufferCreateInfo& bufferCreateInfo) {
 		VkBuffer buffer;
 		verifyResult(vkCreateBuffer(m_context->device(), &bufferCreateInfo, nullptr, &buffer));
-
 		VkMemoryRequirements requirements;
 		vkGetBufferMemoryRequirements(m_context->device(), buffer, &requirements);
+		vkDestroyBuffer(m_context->device(), buffer, nullptr);
+		return requirements;
+	}
+
+	VkMemoryRequirements GPUResourceAllocator::queryImageMemoryRequirements(const VkImageCreateInfo& imageCreateInfo) {
+		VkImage image;
+		verifyResult(vkCreateImage(m_context->device(), &imageCreateInfo, nullptr, &image));
+		VkMemoryRequirements requirements;
+		vkGetImageMemoryRequirements(m_context->device(), image, &requirements);
+		vkDestroyImage(m_context->device(), image, nullptr);
+		return requirements;
+	}
+
+	BufferResourceHandle GPUResourceAllocator::createBuffer(const VkBufferCreateInfo& bufferCreateInfo,
+															MemoryCapabilities required, MemoryCapabilities preferred,
+															bool createMapped, float priority) {
+		// Creating the buffer and querying its requirements doesn't touch any allocator state
+		VkBuffer buffer;
+		verifyResult(vkCreateBuffer(m_context->device(), &bufferCreateInfo, nullptr, &buffer));
+		VkMemoryRequirements requirements;
+		bool dedicated = shouldUseDedicatedAllocation(bufferMemoryRequirements(buffer, requirements), m_blockSize);
+
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		return allocateBufferMemoryUnsynchronized(bufferCreateInfo, buffer, requirements, dedicated, required,
+												  preferred, createMapped, quantizeMemoryPriority(priority));
+	}
+
+	BufferResourceHandle GPUResourceAllocator::createBufferUnsynchronized(const VkBufferCreateInfo& bufferCreateInfo,
+																		  MemoryCapabilities required,
+																		  MemoryCapabilities preferred,
+																		  bool createMapped, float priority) {
+		VkBuffer buffer;
+		verifyResult(vkCreateBuffer(m_context->device(), &bufferCreateInfo, nullptr, &buffer));
+		VkMemoryRequirements requirements;
+		bool dedicated = shouldUseDedicatedAllocation(bufferMemoryRequirements(buffer, requirements), m_blockSize);
+		return allocateBufferMemoryUnsynchronized(bufferCreateInfo, buffer, requirements, dedicated, required,
+												  preferred, createMapped, priority);
+	}
+
+	BufferResourceHandle GPUResourceAllocator::allocateBufferMemoryUnsynchronized(
+		const VkBufferCreateInfo& bufferCreateInfo, VkBuffer buffer, const VkMemoryRequirements& requirements,
+		bool dedicated, MemoryCapabilities required, MemoryCapabilities preferred, bool createMapped, float priority) {
+		VkMemoryPropertyFlags requiredFlags = (required.deviceLocal ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : 0) |
+											  (required.hostCoherent ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0) |
+											  (required.hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0);
+		VkMemoryPropertyFlags preferredFlags = (preferred.deviceLocal ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : 0) |
+											   (preferred.hostCoherent ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0) |
+											   (preferred.hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0);
+
+		auto allocateFromType = [&](uint32_t index) {
+			return dedicated
+					   ? allocateDedicated(index, requirements.size, createMapped, priority, buffer, VK_NULL_HANDLE)
+					   : allocate(index, requirements.alignment, requirements.size, createMapped, priority);
+		};
 
 		uint32_t typeIndex = bestTypeIndex(requiredFlags, preferredFlags, requirements, createMapped);
 
@@ -108,7 +190,7 @@ namespace vanadium::graphics {
 			return ~0U;
 		}
 
-		auto result = allocate(typeIndex, requirements.alignment, requirements.size, createMapped);
+		auto result = allocateFromType(typeIndex);
 		if (!result.has_value()) {
 			typeIndex = 0;
 			for (auto& type : m_memoryTypes) {
@@ -116,7 +198,7 @@ namespace vanadium::graphics {
 					++typeIndex;
 					continue;
 				}
-				result = allocate(typeIndex, requirements.alignment, requirements.size, createMapped);
+				result = allocateFromType(typeIndex);
 				if (result.has_value())
 					break;
 				++typeIndex;
@@ -133,6 +215,8 @@ namespace vanadium::graphics {
 										.blockHandle = result.value().blockHandle,
 										.bufferContentRange = result.value().usableRange,
 										.allocationRange = result.value().allocationRange };
+		allocation.createInfo = bufferCreateInfo;
+		allocation.createInfo.pNext = nullptr;
 		verifyResult(vkBindBufferMemory(m_context->device(), buffer,
 										m_memoryTypes[typeIndex].blocks[result.value().blockHandle].memoryHandle,
 										result.value().usableRange.offset));
@@ -152,8 +236,16 @@ namespace vanadium::graphics {
 
 	BufferResourceHandle GPUResourceAllocator::createPerFrameBuffer(const VkBufferCreateInfo& bufferCreateInfo,
 																	MemoryCapabilities required,
-																	MemoryCapabilities preferred, bool createMapped) {
+																	MemoryCapabilities preferred, bool createMapped,
+																	float priority) {
 		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		return createPerFrameBufferUnsynchronized(bufferCreateInfo, required, preferred, createMapped,
+												  quantizeMemoryPriority(priority));
+	}
+
+	BufferResourceHandle GPUResourceAllocator::createPerFrameBufferUnsynchronized(
+		const VkBufferCreateInfo& bufferCreateInfo, MemoryCapabilities required, MemoryCapabilities preferred,
+		bool createMapped, float priority) {
 		VkMemoryPropertyFlags requiredFlags = (required.deviceLocal ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : 0) |
 											  (required.hostCoherent ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0) |
 											  (required.hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0);
@@ -165,12 +257,26 @@ namespace vanadium::graphics {
 		verifyResult(vkCreateBuffer(m_context->device(), &bufferCreateInfo, nullptr, &buffer));
 
 		VkMemoryRequirements requirements;
-		vkGetBufferMemoryRequirements(m_context->device(), buffer, &requirements);
+		auto dedicatedQuery = bufferMemoryRequirements(buffer, requirements);
+		if (dedicatedQuery.requiresDedicatedAllocation || dedicatedQuery.prefersDedicatedAllocation) {
+			vkDestroyBuffer(m_context->device(), buffer, nullptr);
+			return createPerFrameDedicatedBufferUnsynchronized(bufferCreateInfo, required, preferred, createMapped,
+															   priority);
+		}
 
 		VkDeviceSize alignedSize = roundUpAligned(requirements.size, requirements.alignment);
 		VkDeviceSize totalSize = (frameInFlightCount - 1) * alignedSize + requirements.size;
 
 		requirements.size = totalSize;
+		dedicatedQuery.size = totalSize;
+
+		// The driver doesn't ask for dedicated memory, but large buffers still get their own
+		bool dedicated = shouldUseDedicatedAllocation(dedicatedQuery, m_blockSize);
+		auto allocateFromType = [&](uint32_t index) {
+			return dedicated
+					   ? allocateDedicated(index, totalSize, createMapped, priority, VK_NULL_HANDLE, VK_NULL_HANDLE)
+					   : allocate(index, requirements.alignment, totalSize, createMapped, priority);
+		};
 
 		uint32_t typeIndex = bestTypeIndex(requiredFlags, preferredFlags, requirements, createMapped);
 
@@ -179,7 +285,7 @@ namespace vanadium::graphics {
 			return ~0U;
 		}
 
-		auto result = allocate(typeIndex, requirements.alignment, totalSize, createMapped);
+		auto result = allocateFromType(typeIndex);
 		if (!result.has_value()) {
 			typeIndex = 0;
 			for (auto& type : m_memoryTypes) {
@@ -187,7 +293,7 @@ namespace vanadium::graphics {
 					++typeIndex;
 					continue;
 				}
-				result = allocate(typeIndex, requirements.alignment, totalSize, createMapped);
+				result = allocateFromType(typeIndex);
 				if (result.has_value())
 					break;
 				++typeIndex;
@@ -204,6 +310,8 @@ namespace vanadium::graphics {
 										.blockHandle = result.value().blockHandle,
 										.bufferContentRange = result.value().usableRange,
 										.allocationRange = result.value().allocationRange };
+		allocation.createInfo = bufferCreateInfo;
+		allocation.createInfo.pNext = nullptr;
 		allocation.buffers[0] = buffer;
 		for (size_t i = 1; i < frameInFlightCount; ++i) {
 			verifyResult(vkCreateBuffer(m_context->device(), &bufferCreateInfo, nullptr, &allocation.buffers[i]));
@@ -224,6 +332,33 @@ namespace vanadium::graphics {
 		return m_buffers.addElement(allocation);
 	}
 
+	BufferResourceHandle GPUResourceAllocator::createPerFrameDedicatedBufferUnsynchronized(
+		const VkBufferCreateInfo& bufferCreateInfo, MemoryCapabilities required, MemoryCapabilities preferred,
+		bool createMapped, float priority) {
+		// Whether the memory is coherent isn't known yet, so frames always start at atom boundaries
+		auto& limits = m_context->properties().limits;
+		VkDeviceSize frameStride = subAllocationFrameStride(
+			bufferCreateInfo.size, subAllocationAlignment(bufferCreateInfo.usage, limits, limits.nonCoherentAtomSize));
+		VkBufferCreateInfo allFramesCreateInfo = bufferCreateInfo;
+		allFramesCreateInfo.size = (frameInFlightCount - 1) * frameStride + bufferCreateInfo.size;
+
+		// The buffer of all frames makes the same dedicated allocation decision as any other buffer
+		BufferResourceHandle handle =
+			createBufferUnsynchronized(allFramesCreateInfo, required, preferred, createMapped, priority);
+		if (handle == ~0U) {
+			return ~0U;
+		}
+		auto& allocation = m_buffers[handle];
+		auto mappedDataStart = reinterpret_cast<uintptr_t>(allocation.mappedData[0]);
+		for (size_t i = 0; i < frameInFlightCount; ++i) {
+			allocation.bufferOffsets[i] = i * frameStride;
+			if (mappedDataStart) {
+				allocation.mappedData[i] = reinterpret_cast<void*>(mappedDataStart + i * frameStride);
+			}
+		}
+		return handle;
+	}
+
 	BufferResourceHandle GPUResourceAllocator::createBuffer(const VkBufferCreateInfo& bufferCreateInfo,
 															BlockHandle block, bool createMapped) {
 		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
@@ -247,6 +382,8 @@ namespace vanadium::graphics {
 											.blockHandle = result.value().blockHandle,
 											.bufferContentRange = result.value().usableRange,
 											.allocationRange = result.value().allocationRange };
+			allocation.createInfo = bufferCreateInfo;
+			allocation.createInfo.pNext = nullptr;
 			verifyResult(vkBindBufferMemory(m_context->device(), buffer, m_customBufferBlocks[block].memoryHandle,
 											result.value().usableRange.offset));
 			for (size_t i = 0; i < frameInFlightCount; ++i) {
@@ -261,6 +398,147 @@ namespace vanadium::graphics {
 		}
 	}
 
+	BufferResourceHandle GPUResourceAllocator::createAliasedBuffer(const VkBufferCreateInfo& bufferCreateInfo,
+																   BlockHandle block, VkDeviceSize offset) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		VkBuffer buffer;
+		verifyResult(vkCreateBuffer(m_context->device(), &bufferCreateInfo, nullptr, &buffer));
+
+		VkMemoryRequirements requirements;
+		vkGetBufferMemoryRequirements(m_context->device(), buffer, &requirements);
+		auto& memoryBlock = m_customBufferBlocks[block];
+		if (offset % requirements.alignment || offset + requirements.size > memoryBlock.originalSize ||
+			!((1U << memoryBlock.typeIndex) & requirements.memoryTypeBits)) {
+			vkDestroyBuffer(m_context->device(), buffer, nullptr);
+			return ~0U;
+		}
+
+		BufferAllocation allocation = { .isMultipleBuffered = false,
+										.typeIndex = ~0U,
+										.blockHandle = block,
+										.bufferContentRange = { .offset = offset, .size = requirements.size },
+										.allocationRange = { .offset = offset, .size = requirements.size },
+										.isAliased = true };
+		allocation.createInfo = bufferCreateInfo;
+		allocation.createInfo.pNext = nullptr;
+		verifyResult(vkBindBufferMemory(m_context->device(), buffer, memoryBlock.memoryHandle, offset));
+		for (size_t i = 0; i < frameInFlightCount; ++i) {
+			allocation.buffers[i] = buffer;
+		}
+		return m_buffers.addElement(allocation);
+	}
+
+	BufferResourceHandle GPUResourceAllocator::createSubAllocatedBuffer(const VkBufferCreateInfo& bufferCreateInfo,
+																		MemoryCapabilities required,
+																		MemoryCapabilities preferred,
+																		bool createMapped) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		return createSubAllocation(bufferCreateInfo, required, preferred, createMapped, false);
+	}
+
+	BufferResourceHandle GPUResourceAllocator::createPerFrameSubAllocatedBuffer(
+		const VkBufferCreateInfo& bufferCreateInfo, MemoryCapabilities required, MemoryCapabilities preferred,
+		bool createMapped) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		return createSubAllocation(bufferCreateInfo, required, preferred, createMapped, true);
+	}
+
+	BufferResourceHandle GPUResourceAllocator::createSubAllocation(const VkBufferCreateInfo& bufferCreateInfo,
+																   MemoryCapabilities required,
+																   MemoryCapabilities preferred, bool createMapped,
+																   bool perFrame) {
+		if (bufferCreateInfo.size > m_maxSubAllocationSize || bufferCreateInfo.flags ||
+			bufferCreateInfo.sharingMode != VK_SHARING_MODE_EXCLUSIVE) {
+			if (perFrame)
+				return createPerFrameBufferUnsynchronized(bufferCreateInfo, required, preferred, createMapped,
+														  defaultMemoryPriority);
+			else
+				return createBufferUnsynchronized(bufferCreateInfo, required, preferred, createMapped,
+												  defaultMemoryPriority);
+		}
+
+		auto capabilitiesEqual = [](const MemoryCapabilities& one, const MemoryCapabilities& other) {
+			return one.deviceLocal == other.deviceLocal && one.hostVisible == other.hostVisible &&
+				   one.hostCoherent == other.hostCoherent;
+		};
+		VkDeviceSize frameCount = perFrame ? frameInFlightCount : 1;
+
+		std::optional<RangeAllocationResult> result;
+		BufferSubAllocationPoolHandle poolHandle = ~0U;
+		VkDeviceSize frameStride = 0;
+
+		auto poolIterator = m_bufferSubAllocationPools.begin();
+		for (auto& pool : m_bufferSubAllocationPools) {
+			if (pool.usage == bufferCreateInfo.usage && pool.createMapped == createMapped &&
+				capabilitiesEqual(pool.required, required) && capabilitiesEqual(pool.preferred, preferred)) {
+				frameStride = subAllocationFrameStride(bufferCreateInfo.size, pool.alignment);
+				result =
+					pool.freeRanges.allocate(pool.alignment, (frameCount - 1) * frameStride + bufferCreateInfo.size);
+				if (result.has_value()) {
+					poolHandle = m_bufferSubAllocationPools.handle(poolIterator);
+					break;
+				}
+			}
+			++poolIterator;
+		}
+
+		if (!result.has_value()) {
+			VkBufferCreateInfo poolCreateInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+												  .size = m_subAllocationPoolSize,
+												  .usage = bufferCreateInfo.usage,
+												  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+			BufferResourceHandle poolBuffer =
+				createBufferUnsynchronized(poolCreateInfo, required, preferred, createMapped, defaultMemoryPriority);
+			if (poolBuffer == ~0U) {
+				return ~0U;
+			}
+
+			auto& limits = m_context->properties().limits;
+			VkMemoryPropertyFlags poolMemoryProperties = m_memoryTypes[m_buffers[poolBuffer].typeIndex].properties;
+			bool needsFlush = (poolMemoryProperties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) &&
+							  !(poolMemoryProperties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+			BufferSubAllocationPool pool = {
+				.buffer = poolBuffer,
+				.usage = bufferCreateInfo.usage,
+				.required = required,
+				.preferred = preferred,
+				.createMapped = createMapped,
+				.alignment = subAllocationAlignment(bufferCreateInfo.usage, limits,
+													needsFlush ? limits.nonCoherentAtomSize : 1),
+				.freeRanges = RangeAllocator(0, m_subAllocationPoolSize)
+			};
+			frameStride = subAllocationFrameStride(bufferCreateInfo.size, pool.alignment);
+			result = pool.freeRanges.allocate(pool.alignment, (frameCount - 1) * frameStride + bufferCreateInfo.size);
+			assertFatal(result.has_value(), "GPUResourceAllocator: Sub-allocation doesn't fit into an empty pool!");
+			poolHandle = m_bufferSubAllocationPools.addElement(std::move(pool));
+		}
+
+		auto& poolAllocation = m_buffers[m_bufferSubAllocationPools[poolHandle].buffer];
+		BufferAllocation allocation = {
+			.isMultipleBuffered = perFrame,
+			.typeIndex = poolAllocation.typeIndex,
+			.blockHandle = poolAllocation.blockHandle,
+			// Like for other per-frame buffers, the content range covers the data of all frames
+			.bufferContentRange = { .offset = poolAllocation.bufferContentRange.offset +
+											  result.value().usableRange.offset,
+									.size = (frameCount - 1) * frameStride + bufferCreateInfo.size },
+			.allocationRange = result.value().allocationRange
+		};
+		allocation.createInfo = bufferCreateInfo;
+		allocation.createInfo.pNext = nullptr;
+		allocation.subAllocationPool = poolHandle;
+		for (size_t i = 0; i < frameInFlightCount; ++i) {
+			allocation.buffers[i] = poolAllocation.buffers[0];
+			allocation.bufferOffsets[i] = result.value().usableRange.offset + (perFrame ? i * frameStride : 0);
+			if (poolAllocation.mappedData[0]) {
+				allocation.mappedData[i] = reinterpret_cast<void*>(
+					reinterpret_cast<uintptr_t>(poolAllocation.mappedData[0]) + allocation.bufferOffsets[i]);
+			}
+		}
+		return m_buffers.addElement(allocation);
+	}
+
 	MemoryCapabilities GPUResourceAllocator::bufferMemoryCapabilities(BufferResourceHandle handle) {
 		auto lock = SharedLockGuard(m_accessMutex);
 		return m_memoryTypes[m_buffers[handle].typeIndex].blocks[m_buffers[handle].blockHandle].capabilities;
@@ -272,25 +550,24 @@ namespace vanadium::graphics {
 	}
 
 	MemoryRange GPUResourceAllocator::allocationRange(BufferResourceHandle handle) {
-		auto lock = SharedLockGuard(m_accessMutex);
 		return m_buffers[handle].bufferContentRange;
 	}
 
 	VkBuffer GPUResourceAllocator::nativeBufferHandle(BufferResourceHandle handle) {
-		auto lock = SharedLockGuard(m_accessMutex);
-		return m_buffers[handle].buffers[m_currentFrameIndex];
+		return m_buffers[handle].buffers[m_currentFrameIndex.load(std::memory_order_relaxed)];
+	}
+
+	VkDeviceSize GPUResourceAllocator::bufferOffset(BufferResourceHandle handle) {
+		return m_buffers[handle].bufferOffsets[m_currentFrameIndex.load(std::memory_order_relaxed)];
 	}
 
 	void* GPUResourceAllocator::mappedBufferData(BufferResourceHandle handle) {
-		auto lock = SharedLockGuard(m_accessMutex);
-		return m_buffers[handle].mappedData[m_currentFrameIndex];
+		return m_buffers[handle].mappedData[m_currentFrameIndex.load(std::memory_order_relaxed)];
 	}
 
 	void GPUResourceAllocator::destroyBuffer(BufferResourceHandle handle) {
-		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
-		auto& allocation = m_buffers[handle];
-		m_bufferFreeList[m_currentFrameIndex].push_back(allocation);
-		m_buffers.removeElement(handle);
+		auto lock = std::lock_guard<std::mutex>(m_destructionMutex);
+		m_pendingBufferDestructions.push_back(handle);
 	}
 
 	void GPUResourceAllocator::destroyBufferImmediately(BufferResourceHandle handle) {
@@ -301,6 +578,22 @@ namespace vanadium::graphics {
 	}
 
 	void GPUResourceAllocator::destroyBufferImmediatelyUnsynchronized(const BufferAllocation& allocation) {
+		if (allocation.subAllocationPool != ~0U) {
+			// The pool's buffer and memory are shared, only the range in the pool is freed
+			auto& pool = m_bufferSubAllocationPools[allocation.subAllocationPool];
+			pool.freeRanges.free(allocation.allocationRange.offset, allocation.allocationRange.size);
+			// The pool is freed together with its last sub-allocation
+			if (pool.freeRanges.maxAllocatableSize() == m_subAllocationPoolSize) {
+				BufferResourceHandle poolBuffer = pool.buffer;
+				assertFatal(m_buffers.contains(poolBuffer),
+							"GPUResourceAllocator: Pool buffer was destroyed before its sub-allocations!");
+				m_bufferSubAllocationPools.removeElement(allocation.subAllocationPool);
+				destroyBufferImmediatelyUnsynchronized(m_buffers[poolBuffer]);
+				m_buffers.removeElement(poolBuffer);
+			}
+			return;
+		}
+
 		if (allocation.isMultipleBuffered) {
 			for (auto& buffer : allocation.buffers) {
 				vkDestroyBuffer(m_context->device(), buffer, nullptr);
@@ -309,6 +602,9 @@ namespace vanadium::graphics {
 			vkDestroyBuffer(m_context->device(), allocation.buffers[0], nullptr);
 		}
 
+		if (allocation.isAliased) {
+			return;
+		}
 		if (allocation.typeIndex != ~0U) {
 			freeInBlock(m_memoryTypes[allocation.typeIndex].blocks[allocation.blockHandle],
 						allocation.allocationRange.offset, allocation.allocationRange.size);
@@ -319,8 +615,9 @@ namespace vanadium::graphics {
 	}
 
 	ImageResourceHandle GPUResourceAllocator::createImage(const VkImageCreateInfo& imageCreateInfo,
-														  MemoryCapabilities required, MemoryCapabilities preferred) {
-		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+														  MemoryCapabilities required, MemoryCapabilities preferred,
+														  float priority) {
+		priority = quantizeMemoryPriority(priority);
 		// clang-format off
 	VkMemoryPropertyFlags requiredFlags = (required.deviceLocal  ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT  : 0) | 
 										  (required.hostCoherent ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0) |
@@ -330,11 +627,17 @@ namespace vanadium::graphics {
 										   (preferred.hostVisible  ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT  : 0);
 		// clang-format on
 
+		// Creating the image and querying its requirements doesn't touch any allocator state
 		VkImage image;
 		verifyResult(vkCreateImage(m_context->device(), &imageCreateInfo, nullptr, &image));
-
 		VkMemoryRequirements requirements;
-		vkGetImageMemoryRequirements(m_context->device(), image, &requirements);
+		bool dedicated = shouldUseDedicatedAllocation(imageMemoryRequirements(image, requirements), m_blockSize);
+
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		auto allocateFromType = [&](uint32_t index) {
+			return dedicated ? allocateDedicated(index, requirements.size, false, priority, VK_NULL_HANDLE, image)
+							 : allocateImage(index, requirements.alignment, requirements.size, priority);
+		};
 
 		uint32_t typeIndex = bestTypeIndex(requiredFlags, preferredFlags, requirements, false);
 
@@ -343,7 +646,7 @@ namespace vanadium::graphics {
 			return ~0U;
 		}
 
-		auto result = allocateImage(typeIndex, requirements.alignment, requirements.size);
+		auto result = allocateFromType(typeIndex);
 		if (!result.has_value()) {
 			typeIndex = 0;
 			for (auto& type : m_memoryTypes) {
@@ -351,7 +654,7 @@ namespace vanadium::graphics {
 					++typeIndex;
 					continue;
 				}
-				result = allocateImage(typeIndex, requirements.alignment, requirements.size);
+				result = allocateFromType(typeIndex);
 				if (result.has_value())
 					break;
 				++typeIndex;
@@ -373,6 +676,8 @@ namespace vanadium::graphics {
 			.allocationRange = result.value().allocationRange,
 		};
 		allocation.image = image;
+		allocation.createInfo = imageCreateInfo;
+		allocation.createInfo.pNext = nullptr;
 		vkBindImageMemory(m_context->device(), image,
 						  m_memoryTypes[typeIndex].imageBlocks[result.value().blockHandle].memoryHandle,
 						  result.value().usableRange.offset);
@@ -402,19 +707,51 @@ namespace vanadium::graphics {
 				.allocationRange = result.value().allocationRange,
 			};
 			allocation.image = image;
+			allocation.createInfo = imageCreateInfo;
+			allocation.createInfo.pNext = nullptr;
 			vkBindImageMemory(m_context->device(), image, m_customImageBlocks[block].memoryHandle,
 							  result.value().usableRange.offset);
 			return m_images.addElement(allocation);
 		}
 	}
 
+	ImageResourceHandle GPUResourceAllocator::createAliasedImage(const VkImageCreateInfo& imageCreateInfo,
+																 BlockHandle block, VkDeviceSize offset) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		VkImage image;
+		verifyResult(vkCreateImage(m_context->device(), &imageCreateInfo, nullptr, &image));
+
+		VkMemoryRequirements requirements;
+		vkGetImageMemoryRequirements(m_context->device(), image, &requirements);
+		auto& memoryBlock = m_customImageBlocks[block];
+		if (offset % requirements.alignment || offset + requirements.size > memoryBlock.originalSize ||
+			!((1U << memoryBlock.typeIndex) & requirements.memoryTypeBits)) {
+			vkDestroyImage(m_context->device(), image, nullptr);
+			return ~0U;
+		}
+
+		ImageAllocation allocation = {
+			.resourceInfo = { .format = imageCreateInfo.format,
+							  .dimensions = imageCreateInfo.extent,
+							  .mipLevelCount = imageCreateInfo.mipLevels,
+							  .arrayLayerCount = imageCreateInfo.arrayLayers },
+			.typeIndex = ~0U,
+			.blockHandle = block,
+			.allocationRange = { .offset = offset, .size = requirements.size },
+		};
+		allocation.image = image;
+		allocation.createInfo = imageCreateInfo;
+		allocation.createInfo.pNext = nullptr;
+		allocation.isAliased = true;
+		verifyResult(vkBindImageMemory(m_context->device(), image, memoryBlock.memoryHandle, offset));
+		return m_images.addElement(allocation);
+	}
+
 	VkImage GPUResourceAllocator::nativeImageHandle(ImageResourceHandle handle) {
-		auto lock = SharedLockGuard(m_accessMutex);
 		return m_images[handle].image;
 	}
 
 	const ImageResourceInfo& GPUResourceAllocator::imageResourceInfo(ImageResourceHandle handle) {
-		auto lock = SharedLockGuard(m_accessMutex);
 		return m_images[handle].resourceInfo;
 	}
 
@@ -439,10 +776,8 @@ namespace vanadium::graphics {
 	}
 
 	void GPUResourceAllocator::destroyImage(ImageResourceHandle handle) {
-		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
-		auto& allocation = m_images[handle];
-		m_imageFreeList[m_currentFrameIndex].push_back(allocation);
-		m_images.removeElement(handle);
+		auto lock = std::lock_guard<std::mutex>(m_destructionMutex);
+		m_pendingImageDestructions.push_back(handle);
 	}
 
 	void GPUResourceAllocator::destroyImageImmediately(ImageResourceHandle handle) {
@@ -457,6 +792,9 @@ namespace vanadium::graphics {
 		}
 		vkDestroyImage(m_context->device(), allocation.image, nullptr);
 
+		if (allocation.isAliased) {
+			return;
+		}
 		if (allocation.typeIndex != ~0U) {
 			freeInBlock(m_memoryTypes[allocation.typeIndex].imageBlocks[allocation.blockHandle],
 						allocation.allocationRange.offset - allocation.alignmentMargin,
@@ -479,18 +817,31 @@ namespace vanadium::graphics {
 	}
 
 	void GPUResourceAllocator::destroy() {
-		// work around iterator invalidation
-		while (m_buffers.size()) {
-			destroyBuffer(m_buffers.handle(m_buffers.begin()));
+		retirePendingDestructions();
+		applyPendingMoves();
+
+		// Pool buffers are destroyed together with the last sub-allocation of their pool
+		std::vector<BufferResourceHandle> poolBuffers;
+		for (auto& pool : m_bufferSubAllocationPools) {
+			poolBuffers.push_back(pool.buffer);
 		}
-		while (m_images.size()) {
-			destroyImage(m_images.handle(m_images.begin()));
+		for (auto iterator = m_buffers.begin(); iterator != m_buffers.end(); ++iterator) {
+			BufferResourceHandle handle = m_buffers.handle(iterator);
+			if (std::find(poolBuffers.begin(), poolBuffers.end(), handle) == poolBuffers.end()) {
+				m_pendingBufferDestructions.push_back(handle);
+			}
 		}
+		for (auto iterator = m_images.begin(); iterator != m_images.end(); ++iterator) {
+			m_pendingImageDestructions.push_back(m_images.handle(iterator));
+		}
+		retirePendingDestructions();
 
 		for (uint32_t i = 0; i < frameInFlightCount; ++i) {
 			m_currentFrameIndex = i;
 			flushFreeList();
 		}
+		assertFatal(m_bufferSubAllocationPools.size() == 0,
+					"GPUResourceAllocator: Sub-allocation pools weren't freed with their sub-allocations!");
 
 		for (auto& type : m_memoryTypes) {
 			for (auto& block : type.blocks) {
@@ -509,9 +860,142 @@ namespace vanadium::graphics {
 		}
 	}
 
+	void GPUResourceAllocator::setBufferMovable(BufferResourceHandle handle, bool movable) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		auto& allocation = m_buffers[handle];
+		if (movable) {
+			VkBufferUsageFlags transferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			assertFatal(!allocation.isMultipleBuffered && !allocation.mappedData[0] && allocation.typeIndex != ~0U &&
+							allocation.subAllocationPool == ~0U &&
+							allocation.createInfo.sharingMode == VK_SHARING_MODE_EXCLUSIVE &&
+							(allocation.createInfo.usage & transferUsage) == transferUsage,
+						"GPUResourceAllocator: Buffer can't be made movable!");
+		}
+		allocation.isMovable = movable;
+	}
+
+	void GPUResourceAllocator::setImageMovable(ImageResourceHandle handle, bool movable, VkImageLayout frameEndLayout) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		auto& allocation = m_images[handle];
+		if (movable) {
+			VkImageUsageFlags transferUsage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+			assertFatal(allocation.typeIndex != ~0U && allocation.createInfo.sharingMode == VK_SHARING_MODE_EXCLUSIVE &&
+							(allocation.createInfo.usage & transferUsage) == transferUsage,
+						"GPUResourceAllocator: Image can't be made movable!");
+		}
+		allocation.isMovable = movable;
+		allocation.frameEndLayout = frameEndLayout;
+	}
+
+	VkDeviceSize GPUResourceAllocator::recordDefragmentation(VkCommandBuffer commandBuffer,
+															 VkDeviceSize maxBytesToMove) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		// Resources must not be moved again before the handles refer to the new resources
+		if (!m_pendingBufferMoves.empty() || !m_pendingImageMoves.empty()) {
+			return 0;
+		}
+
+		VkDeviceSize movedBytes = 0;
+		for (uint32_t typeIndex = 0; typeIndex < m_memoryTypes.size(); ++typeIndex) {
+			for (auto priority : memoryPriorityLevels) {
+				movedBytes += planBufferMoves(typeIndex, priority, maxBytesToMove - movedBytes);
+				movedBytes += planImageMoves(typeIndex, priority, maxBytesToMove - movedBytes);
+			}
+		}
+		if (!movedBytes) {
+			return 0;
+		}
+		m_defragmentationFrameIndex = m_currentFrameIndex;
+
+		std::vector<VkImageMemoryBarrier> preCopyBarriers;
+		std::vector<VkImageMemoryBarrier> postCopyBarriers;
+		preCopyBarriers.reserve(m_pendingImageMoves.size() * 2);
+		postCopyBarriers.reserve(m_pendingImageMoves.size());
+		for (auto& move : m_pendingImageMoves) {
+			auto& allocation = m_images[move.handle];
+			VkImageSubresourceRange range = { .aspectMask = aspectFlagsForFormat(allocation.resourceInfo.format),
+											  .baseMipLevel = 0,
+											  .levelCount = allocation.resourceInfo.mipLevelCount,
+											  .baseArrayLayer = 0,
+											  .layerCount = allocation.resourceInfo.arrayLayerCount };
+			preCopyBarriers.push_back({ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+										.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+										.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+										.oldLayout = allocation.frameEndLayout,
+										.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+										.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+										.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+										.image = allocation.image,
+										.subresourceRange = range });
+			preCopyBarriers.push_back({ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+										.srcAccessMask = 0,
+										.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+										.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+										.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+										.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+										.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+										.image = move.newAllocation.image,
+										.subresourceRange = range });
+			postCopyBarriers.push_back({ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+										 .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+										 .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT,
+										 .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+										 .newLayout = allocation.frameEndLayout,
+										 .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+										 .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+										 .image = move.newAllocation.image,
+										 .subresourceRange = range });
+		}
+
+		VkMemoryBarrier preCopyMemoryBarrier = { .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+												 .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+												 .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT };
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1,
+							 &preCopyMemoryBarrier, 0, nullptr, static_cast<uint32_t>(preCopyBarriers.size()),
+							 preCopyBarriers.data());
+
+		for (auto& move : m_pendingBufferMoves) {
+			VkBufferCopy copy = { .srcOffset = 0, .dstOffset = 0, .size = move.newAllocation.bufferContentRange.size };
+			vkCmdCopyBuffer(commandBuffer, m_buffers[move.handle].buffers[0], move.newAllocation.buffers[0], 1, &copy);
+		}
+
+		std::vector<VkImageCopy> imageCopies;
+		for (auto& move : m_pendingImageMoves) {
+			auto& allocation = m_images[move.handle];
+			auto& info = allocation.resourceInfo;
+			imageCopies.clear();
+			for (uint32_t i = 0; i < info.mipLevelCount; ++i) {
+				VkImageSubresourceLayers subresource = { .aspectMask = aspectFlagsForFormat(info.format),
+														 .mipLevel = i,
+														 .baseArrayLayer = 0,
+														 .layerCount = info.arrayLayerCount };
+				imageCopies.push_back({ .srcSubresource = subresource,
+										.dstSubresource = subresource,
+										.extent = { .width = std::max(info.dimensions.width >> i, 1U),
+													.height = std::max(info.dimensions.height >> i, 1U),
+													.depth = std::max(info.dimensions.depth >> i, 1U) } });
+			}
+			vkCmdCopyImage(commandBuffer, allocation.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+						   move.newAllocation.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						   static_cast<uint32_t>(imageCopies.size()), imageCopies.data());
+		}
+
+		VkMemoryBarrier postCopyMemoryBarrier = { .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+												  .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+												  .dstAccessMask =
+													  VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT };
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1,
+							 &postCopyMemoryBarrier, 0, nullptr, static_cast<uint32_t>(postCopyBarriers.size()),
+							 postCopyBarriers.data());
+		return movedBytes;
+	}
+
 	void GPUResourceAllocator::setFrameIndex(uint32_t frameIndex) {
 		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		// resources destroyed since the last call belong to the frame that just ended
+		retirePendingDestructions();
 		m_currentFrameIndex = frameIndex;
+		applyPendingMoves();
 		flushFreeList();
 	}
 
@@ -533,6 +1017,56 @@ namespace vanadium::graphics {
 		}
 	}
 
+	void GPUResourceAllocator::statistics(AllocatorStatistics& statistics) {
+		auto lock = SharedLockGuard(m_accessMutex);
+		statistics.total = {};
+
+		statistics.heaps.resize(m_heapBudgets.size());
+		for (size_t i = 0; i < m_heapBudgets.size(); ++i) {
+			statistics.heaps[i] = { .remainingBudget = m_heapBudgets[i], .usage = {} };
+		}
+
+		statistics.memoryTypes.resize(m_memoryTypes.size());
+		for (size_t i = 0; i < m_memoryTypes.size(); ++i) {
+			auto& type = m_memoryTypes[i];
+			auto& typeStatistics = statistics.memoryTypes[i];
+			typeStatistics.heapIndex = type.heapIndex;
+			typeStatistics.properties = type.properties;
+			typeStatistics.usage = {};
+
+			typeStatistics.bufferBlocks.clear();
+			for (auto& block : type.blocks) {
+				typeStatistics.bufferBlocks.push_back(
+					blockStatistics(block.freeRanges, block.originalSize, block.allocationCount));
+				typeStatistics.usage += typeStatistics.bufferBlocks.back();
+			}
+			typeStatistics.imageBlocks.clear();
+			for (auto& block : type.imageBlocks) {
+				typeStatistics.imageBlocks.push_back(
+					blockStatistics(block.freeRanges, block.originalSize, block.allocationCount));
+				typeStatistics.usage += typeStatistics.imageBlocks.back();
+			}
+
+			statistics.heaps[type.heapIndex].usage += typeStatistics.usage;
+			statistics.total += typeStatistics.usage;
+		}
+
+		statistics.customBufferBlocks.clear();
+		for (auto& block : m_customBufferBlocks) {
+			statistics.customBufferBlocks.push_back(
+				blockStatistics(block.freeRanges, block.originalSize, block.allocationCount));
+			statistics.heaps[m_memoryTypes[block.typeIndex].heapIndex].usage += statistics.customBufferBlocks.back();
+			statistics.total += statistics.customBufferBlocks.back();
+		}
+		statistics.customImageBlocks.clear();
+		for (auto& block : m_customImageBlocks) {
+			statistics.customImageBlocks.push_back(
+				blockStatistics(block.freeRanges, block.originalSize, block.allocationCount));
+			statistics.heaps[m_memoryTypes[block.typeIndex].heapIndex].usage += statistics.customImageBlocks.back();
+			statistics.total += statistics.customImageBlocks.back();
+		}
+	}
+
 	void GPUResourceAllocator::flushFreeList() {
 		for (auto& allocation : m_bufferFreeList[m_currentFrameIndex]) {
 			destroyBufferImmediatelyUnsynchronized(allocation);
@@ -551,7 +1085,7 @@ namespace vanadium::graphics {
 			auto iterator = type.blocks.begin();
 			for (auto& block : type.blocks) {
 				if (block.maxAllocatableSize == block.originalSize) {
-					if (block.originalSize > m_blockSize) {
+					if (block.isDedicated || block.originalSize > m_blockSize) {
 						vkFreeMemory(m_context->device(), block.memoryHandle, nullptr);
 						type.blocks.removeElement(type.blocks.handle(iterator));
 						// no way to handle iterator invalidation gracefully, restart loop
@@ -568,7 +1102,7 @@ namespace vanadium::graphics {
 			auto imageIterator = type.imageBlocks.begin();
 			for (auto& block : type.imageBlocks) {
 				if (block.maxAllocatableSize == block.originalSize) {
-					if (block.originalSize > m_blockSize) {
+					if (block.isDedicated || block.originalSize > m_blockSize) {
 						vkFreeMemory(m_context->device(), block.memoryHandle, nullptr);
 						type.imageBlocks.removeElement(type.imageBlocks.handle(imageIterator));
 						// no way to handle iterator invalidation gracefully, restart loop
@@ -589,6 +1123,202 @@ namespace vanadium::graphics {
 		m_blockFreeList[m_currentFrameIndex].clear();
 	}
 
+	void GPUResourceAllocator::retirePendingDestructions() {
+		auto lock = std::lock_guard<std::mutex>(m_destructionMutex);
+		for (auto handle : m_pendingBufferDestructions) {
+			m_bufferFreeList[m_currentFrameIndex].push_back(m_buffers[handle]);
+			m_buffers.removeElement(handle);
+		}
+		m_pendingBufferDestructions.clear();
+
+		for (auto handle : m_pendingImageDestructions) {
+			m_imageFreeList[m_currentFrameIndex].push_back(std::move(m_images[handle]));
+			m_images.removeElement(handle);
+		}
+		m_pendingImageDestructions.clear();
+	}
+
+	void GPUResourceAllocator::applyPendingMoves() {
+		// The old resources are freed together with the resources destroyed in the frame the copies were recorded
+		// in, after that frame has finished executing.
+		for (auto& move : m_pendingBufferMoves) {
+			if (m_buffers.contains(move.handle)) {
+				move.newAllocation.isMovable = m_buffers[move.handle].isMovable;
+				m_bufferFreeList[m_defragmentationFrameIndex].push_back(m_buffers[move.handle]);
+				m_buffers[move.handle] = move.newAllocation;
+			} else {
+				// the buffer was destroyed after recording the copy, which may still be executing
+				m_bufferFreeList[m_defragmentationFrameIndex].push_back(move.newAllocation);
+			}
+		}
+		m_pendingBufferMoves.clear();
+
+		for (auto& move : m_pendingImageMoves) {
+			if (m_images.contains(move.handle)) {
+				move.newAllocation.isMovable = m_images[move.handle].isMovable;
+				move.newAllocation.frameEndLayout = m_images[move.handle].frameEndLayout;
+				m_imageFreeList[m_defragmentationFrameIndex].push_back(std::move(m_images[move.handle]));
+				m_images[move.handle] = std::move(move.newAllocation);
+			} else {
+				m_imageFreeList[m_defragmentationFrameIndex].push_back(std::move(move.newAllocation));
+			}
+		}
+		m_pendingImageMoves.clear();
+	}
+
+	VkDeviceSize GPUResourceAllocator::planBufferMoves(uint32_t typeIndex, float priority,
+													   VkDeviceSize maxBytesToMove) {
+		auto& type = m_memoryTypes[typeIndex];
+		DefragmentationPlanner planner;
+		auto isCandidate = [priority](const MemoryBlock& block) {
+			return !block.isDedicated && block.priority == priority;
+		};
+
+		auto blockIterator = type.blocks.begin();
+		for (auto& block : type.blocks) {
+			if (isCandidate(block)) {
+				planner.addBlock(type.blocks.handle(blockIterator), &block.freeRanges, block.originalSize);
+			}
+			++blockIterator;
+		}
+		auto bufferIterator = m_buffers.begin();
+		for (auto& allocation : m_buffers) {
+			if (allocation.isMovable && allocation.typeIndex == typeIndex &&
+				isCandidate(type.blocks[allocation.blockHandle])) {
+				VkMemoryRequirements requirements;
+				vkGetBufferMemoryRequirements(m_context->device(), allocation.buffers[0], &requirements);
+				planner.addAllocation(allocation.blockHandle, { .resourceHandle = m_buffers.handle(bufferIterator),
+																.allocationRange = allocation.allocationRange,
+																.alignment = requirements.alignment,
+																.size = allocation.bufferContentRange.size });
+			}
+			++bufferIterator;
+		}
+
+		VkDeviceSize movedBytes = 0;
+		for (auto& move : planner.planMoves(maxBytesToMove)) {
+			BufferAllocation newAllocation = m_buffers[move.resourceHandle];
+			newAllocation.blockHandle = move.dstBlockHandle;
+			newAllocation.bufferContentRange = move.dstAllocation.usableRange;
+			newAllocation.allocationRange = move.dstAllocation.allocationRange;
+
+			VkBuffer buffer;
+			verifyResult(vkCreateBuffer(m_context->device(), &newAllocation.createInfo, nullptr, &buffer));
+			verifyResult(vkBindBufferMemory(m_context->device(), buffer, type.blocks[move.dstBlockHandle].memoryHandle,
+											move.dstAllocation.usableRange.offset));
+			for (size_t i = 0; i < frameInFlightCount; ++i) {
+				newAllocation.buffers[i] = buffer;
+			}
+			++type.blocks[move.dstBlockHandle].allocationCount;
+			m_pendingBufferMoves.push_back({ .handle = move.resourceHandle, .newAllocation = newAllocation });
+			movedBytes += move.size;
+		}
+
+		for (auto& block : type.blocks) {
+			block.maxAllocatableSize = block.freeRanges.maxAllocatableSize();
+		}
+		return movedBytes;
+	}
+
+	VkDeviceSize GPUResourceAllocator::planImageMoves(uint32_t typeIndex, float priority,
+													  VkDeviceSize maxBytesToMove) {
+		auto& type = m_memoryTypes[typeIndex];
+		DefragmentationPlanner planner;
+		auto isCandidate = [priority](const MemoryBlock& block) {
+			return !block.isDedicated && block.priority == priority;
+		};
+
+		auto blockIterator = type.imageBlocks.begin();
+		for (auto& block : type.imageBlocks) {
+			if (isCandidate(block)) {
+				planner.addBlock(type.imageBlocks.handle(blockIterator), &block.freeRanges, block.originalSize);
+			}
+			++blockIterator;
+		}
+		auto imageIterator = m_images.begin();
+		for (auto& allocation : m_images) {
+			if (allocation.isMovable && allocation.typeIndex == typeIndex &&
+				isCandidate(type.imageBlocks[allocation.blockHandle])) {
+				VkMemoryRequirements requirements;
+				vkGetImageMemoryRequirements(m_context->device(), allocation.image, &requirements);
+				planner.addAllocation(allocation.blockHandle, { .resourceHandle = m_images.handle(imageIterator),
+																.allocationRange = allocation.allocationRange,
+																.alignment = requirements.alignment,
+																.size = requirements.size });
+			}
+			++imageIterator;
+		}
+
+		VkDeviceSize movedBytes = 0;
+		for (auto& move : planner.planMoves(maxBytesToMove)) {
+			auto& oldAllocation = m_images[move.resourceHandle];
+			ImageAllocation newAllocation = { .resourceInfo = oldAllocation.resourceInfo,
+											  .typeIndex = typeIndex,
+											  .blockHandle = move.dstBlockHandle,
+											  .allocationRange = move.dstAllocation.allocationRange,
+											  .createInfo = oldAllocation.createInfo,
+											  .isMovable = true,
+											  .frameEndLayout = oldAllocation.frameEndLayout };
+
+			verifyResult(vkCreateImage(m_context->device(), &newAllocation.createInfo, nullptr, &newAllocation.image));
+			verifyResult(vkBindImageMemory(m_context->device(), newAllocation.image,
+										   type.imageBlocks[move.dstBlockHandle].memoryHandle,
+										   move.dstAllocation.usableRange.offset));
+			++type.imageBlocks[move.dstBlockHandle].allocationCount;
+			m_pendingImageMoves.push_back({ .handle = move.resourceHandle, .newAllocation = std::move(newAllocation) });
+			movedBytes += move.size;
+		}
+
+		for (auto& block : type.imageBlocks) {
+			block.maxAllocatableSize = block.freeRanges.maxAllocatableSize();
+		}
+		return movedBytes;
+	}
+
+	DedicatedAllocationQuery GPUResourceAllocator::bufferMemoryRequirements(VkBuffer buffer,
+																			VkMemoryRequirements& requirements) {
+		if (!m_context->deviceCapabilities().dedicatedAllocation) {
+			vkGetBufferMemoryRequirements(m_context->device(), buffer, &requirements);
+			return { .size = requirements.size };
+		}
+
+		VkBufferMemoryRequirementsInfo2KHR info = { .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2_KHR,
+													.buffer = buffer };
+		VkMemoryDedicatedRequirementsKHR dedicatedRequirements = {
+			.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS_KHR
+		};
+		VkMemoryRequirements2KHR requirements2 = { .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2_KHR,
+												   .pNext = &dedicatedRequirements };
+		vkGetBufferMemoryRequirements2KHR(m_context->device(), &info, &requirements2);
+
+		requirements = requirements2.memoryRequirements;
+		return { .size = requirements.size,
+				 .prefersDedicatedAllocation = static_cast<bool>(dedicatedRequirements.prefersDedicatedAllocation),
+				 .requiresDedicatedAllocation = static_cast<bool>(dedicatedRequirements.requiresDedicatedAllocation) };
+	}
+
+	DedicatedAllocationQuery GPUResourceAllocator::imageMemoryRequirements(VkImage image,
+																		   VkMemoryRequirements& requirements) {
+		if (!m_context->deviceCapabilities().dedicatedAllocation) {
+			vkGetImageMemoryRequirements(m_context->device(), image, &requirements);
+			return { .size = requirements.size };
+		}
+
+		VkImageMemoryRequirementsInfo2KHR info = { .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2_KHR,
+												   .image = image };
+		VkMemoryDedicatedRequirementsKHR dedicatedRequirements = {
+			.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS_KHR
+		};
+		VkMemoryRequirements2KHR requirements2 = { .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2_KHR,
+												   .pNext = &dedicatedRequirements };
+		vkGetImageMemoryRequirements2KHR(m_context->device(), &info, &requirements2);
+
+		requirements = requirements2.memoryRequirements;
+		return { .size = requirements.size,
+				 .prefersDedicatedAllocation = static_cast<bool>(dedicatedRequirements.prefersDedicatedAllocation),
+				 .requiresDedicatedAllocation = static_cast<bool>(dedicatedRequirements.requiresDedicatedAllocation) };
+	}
+
 	uint32_t GPUResourceAllocator::bestTypeIndex(VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred,
 												 VkMemoryRequirements requirements, bool createMapped) {
 		uint32_t bestMatchingTypeIndex = ~0U;
@@ -634,10 +1364,11 @@ namespace vanadium::graphics {
 	}
 
 	std::optional<AllocationResult> GPUResourceAllocator::allocate(uint32_t typeIndex, VkDeviceSize alignment,
-																   VkDeviceSize size, bool createMapped) {
+																   VkDeviceSize size, bool createMapped,
+																   float priority) {
 		auto blockIterator = m_memoryTypes[typeIndex].blocks.begin();
 		for (auto& block : m_memoryTypes[typeIndex].blocks) {
-			if (block.maxAllocatableSize >= size &&
+			if (!block.isDedicated && block.priority == priority && block.maxAllocatableSize >= size &&
 				(!createMapped || !block.capabilities.hostVisible || block.mappedPointer != nullptr)) {
 				auto result = allocateInBlock(m_memoryTypes[typeIndex].blocks.handle(blockIterator), block, alignment,
 											  size, createMapped);
@@ -647,7 +1378,7 @@ namespace vanadium::graphics {
 			++blockIterator;
 		}
 		if (m_heapBudgets[m_memoryTypes[typeIndex].heapIndex] > size) {
-			if (!allocateBlock(typeIndex, size, createMapped, false)) {
+			if (!allocateBlock(typeIndex, size, createMapped, false, priority)) {
 				return std::nullopt;
 			}
 			auto blockHandle = m_memoryTypes[typeIndex].blocks.handle(--m_memoryTypes[typeIndex].blocks.end());
@@ -658,10 +1389,10 @@ namespace vanadium::graphics {
 	}
 
 	std::optional<AllocationResult> GPUResourceAllocator::allocateImage(uint32_t typeIndex, VkDeviceSize alignment,
-																		VkDeviceSize size) {
+																		VkDeviceSize size, float priority) {
 		auto blockIterator = m_memoryTypes[typeIndex].imageBlocks.begin();
 		for (auto& block : m_memoryTypes[typeIndex].imageBlocks) {
-			if (block.maxAllocatableSize >= size) {
+			if (!block.isDedicated && block.priority == priority && block.maxAllocatableSize >= size) {
 				auto result = allocateInBlock(m_memoryTypes[typeIndex].imageBlocks.handle(blockIterator), block,
 											  alignment, size, false);
 				if (result.has_value())
@@ -670,7 +1401,7 @@ namespace vanadium::graphics {
 			++blockIterator;
 		}
 		if (m_heapBudgets[m_memoryTypes[typeIndex].heapIndex] > size) {
-			if (!allocateBlock(typeIndex, size, false, true)) {
+			if (!allocateBlock(typeIndex, size, false, true, priority)) {
 				return std::nullopt;
 			}
 			auto blockHandle =
@@ -681,17 +1412,76 @@ namespace vanadium::graphics {
 		return std::nullopt;
 	}
 
+	std::optional<AllocationResult> GPUResourceAllocator::allocateDedicated(uint32_t typeIndex, VkDeviceSize size,
+																			bool createMapped, float priority,
+																			VkBuffer buffer, VkImage image) {
+		if (m_heapBudgets[m_memoryTypes[typeIndex].heapIndex] <= size) {
+			return std::nullopt;
+		}
+
+		VkMemoryAllocateInfo info = { .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+									  .allocationSize = size,
+									  .memoryTypeIndex = typeIndex };
+		VkMemoryDedicatedAllocateInfoKHR dedicatedInfo = {
+			.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO_KHR, .image = image, .buffer = buffer
+		};
+		VkMemoryPriorityAllocateInfoEXT priorityInfo = { .sType = VK_STRUCTURE_TYPE_MEMORY_PRIORITY_ALLOCATE_INFO_EXT,
+														 .priority = priority };
+		if (m_context->deviceCapabilities().dedicatedAllocation && (buffer || image)) {
+			dedicatedInfo.pNext = info.pNext;
+			info.pNext = &dedicatedInfo;
+		}
+		if (m_context->deviceCapabilities().memoryPriority) {
+			priorityInfo.pNext = info.pNext;
+			info.pNext = &priorityInfo;
+		}
+
+		VkDeviceMemory newMemory;
+		VkResult result = vkAllocateMemory(m_context->device(), &info, nullptr, &newMemory);
+
+		if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY) {
+			m_heapBudgets[m_memoryTypes[typeIndex].heapIndex] = size - 1;
+			return std::nullopt;
+		}
+		verifyResult(result);
+
+		MemoryCapabilities capabilities = {
+			.deviceLocal = static_cast<bool>(m_memoryTypes[typeIndex].properties & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+			.hostVisible = static_cast<bool>(m_memoryTypes[typeIndex].properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT),
+			.hostCoherent =
+				static_cast<bool>(m_memoryTypes[typeIndex].properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+		};
+
+		void* mappedPointer = nullptr;
+		if (createMapped && capabilities.hostVisible) {
+			verifyResult(vkMapMemory(m_context->device(), newMemory, 0, size, 0, &mappedPointer));
+		}
+
+		MemoryBlock block = { .freeRanges = RangeAllocator(0, size),
+							  .capabilities = capabilities,
+							  .maxAllocatableSize = size,
+							  .originalSize = size,
+							  .memoryHandle = newMemory,
+							  .mappedPointer = mappedPointer,
+							  .typeIndex = typeIndex,
+							  .priority = priority,
+							  .isDedicated = true };
+		auto& blocks = image ? m_memoryTypes[typeIndex].imageBlocks : m_memoryTypes[typeIndex].blocks;
+		BlockHandle blockHandle = blocks.addElement(block);
+
+		m_heapBudgets[m_memoryTypes[typeIndex].heapIndex] -= size;
+
+		return allocateInBlock(blockHandle, blocks[blockHandle], 1, size, createMapped);
+	}
+
 	std::optional<AllocationResult> GPUResourceAllocator::allocateInBlock(BlockHandle blockHandle, MemoryBlock& block,
 																		  VkDeviceSize alignment, VkDeviceSize size,
 																		  bool createMapped) {
-		auto result = allocateFromRanges(block.freeBlocksOffsetSorted, block.freeBlocksSizeSorted, alignment, size);
-		if (block.freeBlocksSizeSorted.empty())
-			block.maxAllocatableSize = 0U;
-		else {
-			block.maxAllocatableSize = block.freeBlocksSizeSorted.back().size;
-		}
+		auto result = block.freeRanges.allocate(alignment, size);
+		block.maxAllocatableSize = block.freeRanges.maxAllocatableSize();
 
 		if (result.has_value()) {
+			++block.allocationCount;
 			return AllocationResult{ .allocationRange = result.value().allocationRange,
 									 .usableRange = result.value().usableRange,
 									 .blockHandle = blockHandle };
@@ -701,17 +1491,23 @@ namespace vanadium::graphics {
 	}
 
 	void GPUResourceAllocator::freeInBlock(MemoryBlock& block, VkDeviceSize offset, VkDeviceSize size) {
-		freeToRanges(block.freeBlocksOffsetSorted, block.freeBlocksSizeSorted, offset, size);
-		block.maxAllocatableSize = block.freeBlocksSizeSorted.back().size;
+		block.freeRanges.free(offset, size);
+		block.maxAllocatableSize = block.freeRanges.maxAllocatableSize();
+		--block.allocationCount;
 	}
 
 	bool GPUResourceAllocator::allocateBlock(uint32_t typeIndex, VkDeviceSize size, bool createMapped,
-											 bool createImageBlock) {
+											 bool createImageBlock, float priority) {
 		size = std::max(m_blockSize, size);
 		VkDeviceMemory newMemory;
 		VkMemoryAllocateInfo info = { .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
 									  .allocationSize = size,
 									  .memoryTypeIndex = typeIndex };
+		VkMemoryPriorityAllocateInfoEXT priorityInfo = { .sType = VK_STRUCTURE_TYPE_MEMORY_PRIORITY_ALLOCATE_INFO_EXT,
+														 .priority = priority };
+		if (m_context->deviceCapabilities().memoryPriority) {
+			info.pNext = &priorityInfo;
+		}
 
 		VkResult result = vkAllocateMemory(m_context->device(), &info, nullptr, &newMemory);
 
@@ -733,13 +1529,14 @@ namespace vanadium::graphics {
 			verifyResult(vkMapMemory(m_context->device(), newMemory, 0, size, 0, &mappedPointer));
 		}
 
-		MemoryBlock block = { .freeBlocksSizeSorted = { { .offset = 0, .size = size } },
-							  .freeBlocksOffsetSorted = { { .offset = 0, .size = size } },
+		MemoryBlock block = { .freeRanges = RangeAllocator(0, size),
 							  .capabilities = capabilities,
 							  .maxAllocatableSize = size,
 							  .originalSize = size,
 							  .memoryHandle = newMemory,
-							  .mappedPointer = mappedPointer };
+							  .mappedPointer = mappedPointer,
+							  .typeIndex = typeIndex,
+							  .priority = priority };
 		if (createImageBlock)
 			m_memoryTypes[typeIndex].imageBlocks.addElement(block);
 		else
@@ -753,8 +1550,8 @@ namespace vanadium::graphics {
 		return true;
 	}
 
-	bool GPUResourceAllocator::allocateCustomBlock(uint32_t typeIndex, VkDeviceSize size, bool createMapped,
-												   bool createImageBlock) {
+	BlockHandle GPUResourceAllocator::allocateCustomBlock(uint32_t typeIndex, VkDeviceSize size, bool createMapped,
+														  bool createImageBlock) {
 		VkDeviceMemory newMemory;
 		VkMemoryAllocateInfo info = { .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
 									  .allocationSize = size,
@@ -764,7 +1561,7 @@ namespace vanadium::graphics {
 
 		if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY) {
 			m_heapBudgets[m_memoryTypes[typeIndex].heapIndex] = size - 1;
-			return false;
+			return ~0U;
 		}
 		verifyResult(result);
 
@@ -780,23 +1577,24 @@ namespace vanadium::graphics {
 			verifyResult(vkMapMemory(m_context->device(), newMemory, 0, size, 0, &mappedPointer));
 		}
 
-		MemoryBlock block = { .freeBlocksSizeSorted = { { .offset = 0, .size = size } },
-							  .freeBlocksOffsetSorted = { { .offset = 0, .size = size } },
+		MemoryBlock block = { .freeRanges = RangeAllocator(0, size),
 							  .capabilities = capabilities,
 							  .maxAllocatableSize = size,
 							  .originalSize = size,
 							  .memoryHandle = newMemory,
-							  .mappedPointer = mappedPointer };
+							  .mappedPointer = mappedPointer,
+							  .typeIndex = typeIndex };
+		BlockHandle handle;
 		if (createImageBlock)
-			m_customImageBlocks.addElement(block);
+			handle = m_customImageBlocks.addElement(block);
 		else
-			m_customBufferBlocks.addElement(block);
+			handle = m_customBufferBlocks.addElement(block);
 
 		if (m_heapBudgets[m_memoryTypes[typeIndex].heapIndex] < size)
 			m_heapBudgets[m_memoryTypes[typeIndex].heapIndex] = size;
 
 		m_heapBudgets[m_memoryTypes[typeIndex].heapIndex] -= size;
 
-		return true;
+		return handle;
 	}
 } // namespace vanadium::graphics
\ No newline at end of file
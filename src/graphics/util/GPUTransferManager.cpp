@@ -9,7 +9,7 @@ namespace vanadium::graphics {
 	void GPUTransferManager::create(DeviceContext* context, GPUResourceAllocator* allocator) {
 		m_context = context;
 		m_resourceAllocator = allocator;
-		m_stagingBufferAllocationFreeList.resize(frameInFlightCount);
+		m_stagingRing = StagingRing(m_stagingRingSegmentSize);
 
 		VkCommandPoolCreateInfo poolCreateInfo = { .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
 												   .queueFamilyIndex = m_context->graphicsQueueFamilyIndex() };
@@ -24,50 +24,97 @@ namespace vanadium::graphics {
 														 .commandBufferCount = 1 };
 			verifyResult(vkAllocateCommandBuffers(m_context->device(), &allocateInfo, &m_transferCommandBuffers[i]));
 		}
+
+		m_transferQueuePolicy =
+			TransferQueuePolicy({ .hasDedicatedTransferQueue = m_context->hasDedicatedTransferQueue(),
+								  .timelineSemaphores = m_context->deviceCapabilities().timelineSemaphore });
+		if (!m_transferQueuePolicy.canUseTransferQueue()) {
+			return;
+		}
+
+		VkCommandPoolCreateInfo transferQueuePoolCreateInfo = {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+			.queueFamilyIndex = m_context->asyncTransferQueueFamilyIndex()
+		};
+		for (size_t i = 0; i < frameInFlightCount; ++i) {
+			verifyResult(vkCreateCommandPool(m_context->device(), &transferQueuePoolCreateInfo, nullptr,
+											 &m_transferQueueCommandPools[i]));
+
+			VkCommandBufferAllocateInfo allocateInfo = { .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+														 .commandPool = m_transferQueueCommandPools[i],
+														 .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+														 .commandBufferCount = 1 };
+			verifyResult(
+				vkAllocateCommandBuffers(m_context->device(), &allocateInfo, &m_transferQueueCommandBuffers[i]));
+		}
+
+		VkSemaphoreTypeCreateInfoKHR semaphoreTypeCreateInfo = { .sType =
+																	 VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR,
+																 .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR,
+																 .initialValue = 0 };
+		VkSemaphoreCreateInfo semaphoreCreateInfo = { .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+													  .pNext = &semaphoreTypeCreateInfo };
+		verifyResult(vkCreateSemaphore(m_context->device(), &semaphoreCreateInfo, nullptr, &m_transferQueueSemaphore));
 	}
 
 	GPUTransferHandle GPUTransferManager::createTransfer(VkDeviceSize transferBufferSize, VkBufferUsageFlags usageFlags,
 														 VkPipelineStageFlags usageStageFlags,
 														 VkAccessFlags usageAccessFlags) {
 		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		return createTransferUnsynchronized(transferBufferSize, usageFlags, usageStageFlags, usageAccessFlags, false);
+	}
+
+	GPUTransferHandle GPUTransferManager::createSubAllocatedTransfer(VkDeviceSize transferBufferSize,
+																	 VkBufferUsageFlags usageFlags,
+																	 VkPipelineStageFlags usageStageFlags,
+																	 VkAccessFlags usageAccessFlags) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		return createTransferUnsynchronized(transferBufferSize, usageFlags, usageStageFlags, usageAccessFlags, true);
+	}
+
+	GPUTransferHandle GPUTransferManager::createTransferUnsynchronized(VkDeviceSize transferBufferSize,
+																	   VkBufferUsageFlags usageFlags,
+																	   VkPipelineStageFlags usageStageFlags,
+																	   VkAccessFlags usageAccessFlags,
+																	   bool subAllocate) {
 		VkBufferCreateInfo transferBufferCreateInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
 														.size = transferBufferSize,
 														.usage = usageFlags | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
 														.sharingMode = VK_SHARING_MODE_EXCLUSIVE };
-		BufferResourceHandle dstBuffer = m_resourceAllocator->createPerFrameBuffer(
-			transferBufferCreateInfo, { .deviceLocal = true, .hostVisible = true }, {}, true);
+		MemoryCapabilities hostVisibleVRAM = { .deviceLocal = true, .hostVisible = true };
+		BufferResourceHandle dstBuffer;
+		if (subAllocate) {
+			dstBuffer = m_resourceAllocator->createPerFrameSubAllocatedBuffer(transferBufferCreateInfo, hostVisibleVRAM,
+																			   {}, true);
+		} else {
+			dstBuffer = m_resourceAllocator->createPerFrameBuffer(transferBufferCreateInfo, hostVisibleVRAM, {}, true);
+		}
 		GPUTransfer transfer = { .dstBuffer = dstBuffer,
 								 .bufferSize = transferBufferSize,
 								 .dstUsageStageFlags = usageStageFlags,
 								 .dstUsageAccessFlags = usageAccessFlags };
-		transfer.stagingBuffers.reserve(frameInFlightCount);
 		if (dstBuffer == ~0U) {
 			// Nothing has used the buffer yet, no need for it to hang around in free lists
-			dstBuffer = m_resourceAllocator->createBuffer(transferBufferCreateInfo, {},
-														  { .deviceLocal = true, .hostVisible = true }, false);
+			if (subAllocate) {
+				dstBuffer =
+					m_resourceAllocator->createSubAllocatedBuffer(transferBufferCreateInfo, {}, hostVisibleVRAM, false);
+			} else {
+				dstBuffer = m_resourceAllocator->createBuffer(transferBufferCreateInfo, {}, hostVisibleVRAM, false);
+			}
 			transfer.dstBuffer = dstBuffer;
 			transfer.needsStagingBuffer = true;
-			for (size_t i = 0; i < frameInFlightCount; ++i) {
-				transfer.stagingBuffers.push_back(allocateStagingBufferArea(transferBufferSize));
-			}
+			transfer.stagingCopies.resize(frameInFlightCount);
+		} else {
+			transfer.dirtyRanges.resize(frameInFlightCount);
+			transfer.hostData.resize(transferBufferSize);
 		}
 
-		transfer.hasNewData = std::vector<bool>(graphics::frameInFlightCount, true);
-
 		return m_continuousTransfers.addElement(transfer);
 	}
 
 	void GPUTransferManager::destroyTransfer(GPUTransferHandle handle) {
 		auto& transfer = m_continuousTransfers[handle];
-		if (transfer.needsStagingBuffer) {
-			for (auto& buffer : transfer.stagingBuffers) {
-				auto bufferHandle = buffer.bufferHandle;
-				auto& allocationRange = buffer.allocationResult.allocationRange;
-				freeToRanges(m_stagingBuffers[bufferHandle].freeRangesOffsetSorted,
-							 m_stagingBuffers[bufferHandle].freeRangesSizeSorted, allocationRange.offset,
-							 allocationRange.size);
-			}
-		}
+		// Staging ring areas are reclaimed with the frame they were allocated in
 		m_resourceAllocator->destroyBuffer(transfer.dstBuffer);
 		m_continuousTransfers.removeElement(handle);
 	}
@@ -178,12 +225,11 @@ namespace vanadium::graphics {
 
 		if (!m_resourceAllocator->bufferMemoryCapabilities(handle).hostVisible) {
 			transfer.needsStagingBuffer = true;
-			transfer.stagingBuffers = { allocateStagingBufferArea(transferBufferSize) };
-			auto mappedDataStart =
-				m_resourceAllocator->mappedBufferData(m_stagingBuffers[transfer.stagingBuffers[0].bufferHandle].buffer);
-			std::memcpy(reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(mappedDataStart) +
-												transfer.stagingBuffers[0].allocationResult.usableRange.offset),
-						data, transferBufferSize);
+			auto allocation = allocateStagingRingArea(transferBufferSize);
+			writeStagingRingArea(allocation, data, transferBufferSize);
+			StagingCopy copy = { .segmentIndex = allocation.segmentIndex,
+								 .region = { .srcOffset = allocation.offset, .size = transferBufferSize } };
+			transfer.stagingCopies = { { copy } };
 		} else {
 			std::memcpy(m_resourceAllocator->mappedBufferData(handle), data, transferBufferSize);
 		}
@@ -218,34 +264,53 @@ namespace vanadium::graphics {
 
 	void GPUTransferManager::updateTransferData(GPUTransferHandle transferHandle, uint32_t frameIndex,
 												const void* data) {
+		VkDeviceSize bufferSize;
+		{
+			auto lock = SharedLockGuard(m_accessMutex);
+			bufferSize = m_continuousTransfers[transferHandle].bufferSize;
+		}
+		updateTransferData(transferHandle, frameIndex, data, 0, bufferSize);
+	}
+
+	void GPUTransferManager::updateTransferData(GPUTransferHandle transferHandle, uint32_t frameIndex,
+												const void* data, VkDeviceSize offset, VkDeviceSize size) {
 		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
 
 		auto& transfer = m_continuousTransfers[transferHandle];
+		auto dataStart = reinterpret_cast<uintptr_t>(data);
 
-		BufferResourceHandle dstWriteBuffer;
-		void* dstData;
 		if (transfer.needsStagingBuffer) {
-			dstWriteBuffer = m_stagingBuffers[transfer.stagingBuffers[frameIndex].bufferHandle].buffer;
-			dstData = reinterpret_cast<void*>(
-				reinterpret_cast<uintptr_t>(m_resourceAllocator->mappedBufferData(
-					m_stagingBuffers[transfer.stagingBuffers[frameIndex].bufferHandle].buffer)) +
-				transfer.stagingBuffers[frameIndex].allocationResult.usableRange.offset);
+			// A new area every time, the area of the last upload may still be read by a frame in flight. There is
+			// only one destination buffer, so only the updated range needs to be copied.
+			auto allocation = allocateStagingRingArea(size);
+			writeStagingRingArea(allocation, reinterpret_cast<const void*>(dataStart + offset), size);
+			transfer.stagingCopies[frameIndex].push_back(
+				{ .segmentIndex = allocation.segmentIndex,
+				  .region = { .srcOffset = allocation.offset, .dstOffset = offset, .size = size } });
 		} else {
-			dstWriteBuffer = transfer.dstBuffer;
-			dstData = m_resourceAllocator->mappedBufferData(dstWriteBuffer);
-		}
-
-		std::memcpy(dstData, data, transfer.bufferSize);
-		if (!m_resourceAllocator->bufferMemoryCapabilities(dstWriteBuffer).hostCoherent) {
-			auto range = m_resourceAllocator->allocationRange(dstWriteBuffer);
-			VkMappedMemoryRange flushRange = { .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
-											   .memory = m_resourceAllocator->nativeMemoryHandle(dstWriteBuffer),
-											   .offset = range.offset,
-											   .size = range.size };
-			vkFlushMappedMemoryRanges(m_context->device(), 1, &flushRange);
+			// Each frame has its own destination buffer, the others get the range when they are updated next
+			std::memcpy(transfer.hostData.data() + offset, reinterpret_cast<const void*>(dataStart + offset), size);
+			for (auto& ranges : transfer.dirtyRanges) {
+				addDirtyRange(ranges, { .offset = offset, .size = size });
+			}
+			auto mappedDataStart =
+				reinterpret_cast<uintptr_t>(m_resourceAllocator->mappedBufferData(transfer.dstBuffer));
+			for (auto& range : transfer.dirtyRanges[frameIndex]) {
+				std::memcpy(reinterpret_cast<void*>(mappedDataStart + range.offset),
+							transfer.hostData.data() + range.offset, range.size);
+			}
+			transfer.dirtyRanges[frameIndex].clear();
+			if (!m_resourceAllocator->bufferMemoryCapabilities(transfer.dstBuffer).hostCoherent) {
+				auto range = m_resourceAllocator->allocationRange(transfer.dstBuffer);
+				VkMappedMemoryRange flushRange = {
+					.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+					.memory = m_resourceAllocator->nativeMemoryHandle(transfer.dstBuffer),
+					.offset = range.offset,
+					.size = range.size
+				};
+				vkFlushMappedMemoryRanges(m_context->device(), 1, &flushRange);
+			}
 		}
-
-		transfer.hasNewData[frameIndex] = true;
 	}
 
 	BufferResourceHandle GPUTransferManager::dstBufferHandle(GPUTransferHandle handle) {
@@ -336,11 +401,13 @@ namespace vanadium::graphics {
 									   m_asyncTransferCommandPools[poolHandle].fence));
 		}
 
-		for (auto& bufferToFree : m_stagingBufferAllocationFreeList[frameIndex]) {
-			freeToRanges(m_stagingBuffers[bufferToFree.bufferHandle].freeRangesOffsetSorted,
-						 m_stagingBuffers[bufferToFree.bufferHandle].freeRangesSizeSorted,
-						 bufferToFree.allocationResult.allocationRange.offset,
-						 bufferToFree.allocationResult.allocationRange.size);
+		// The fence of the last frame recorded with this index was waited on, so its uploads (and the uploads of all
+		// frames before it) have been copied
+		m_stagingRing.reclaim(m_stagingRingFrameValues[frameIndex]);
+		// Segments are only released once all frames using them finished, so the GPU doesn't access them anymore
+		for (uint32_t segmentIndex : m_stagingRing.releaseIdleSegments(m_stagingRingMaxIdleFrames)) {
+			m_resourceAllocator->destroyBufferImmediately(m_stagingRingBuffers[segmentIndex]);
+			m_stagingRingBuffers[segmentIndex] = ~0U;
 		}
 
 		VkCommandBuffer commandBuffer = m_transferCommandBuffers[frameIndex];
@@ -348,46 +415,68 @@ namespace vanadium::graphics {
 										  .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT };
 		verifyResult(vkBeginCommandBuffer(commandBuffer, &info));
 
-		std::vector<VkBufferMemoryBarrier> bufferBarriers;
-		std::vector<VkImageMemoryBarrier> imageBarriers;
-		bufferBarriers.reserve(m_continuousTransfers.size());
-		imageBarriers.reserve(m_imageTransfers.size());
-
-		VkPipelineStageFlags srcStageFlags = 0;
-
+		// Host writes to the staging ring and to host-visible destination buffers are made visible by the queue
+		// submission, so only copy destinations need barriers.
+		std::vector<BufferCopyRequest> copyRequests;
+		std::vector<BufferCopyRequest> transferQueueCopyRequests;
+		auto addCopyRequests = [this, &copyRequests, &transferQueueCopyRequests](
+								   const GPUTransfer& transfer, const std::vector<StagingCopy>& copies,
+								   bool isReadByFramesInFlight) {
+			VkDeviceSize uploadSize = 0;
+			for (auto& copy : copies) {
+				uploadSize += copy.region.size;
+			}
+			auto queue = m_transferQueuePolicy.chooseQueue(
+				{ .size = uploadSize, .isReadByFramesInFlight = isReadByFramesInFlight });
+			auto& requests = queue == UploadQueue::Transfer ? transferQueueCopyRequests : copyRequests;
+			// Sub-allocated destinations start at an offset in the shared buffer
+			VkDeviceSize dstBufferOffset = m_resourceAllocator->bufferOffset(transfer.dstBuffer);
+			for (auto& copy : copies) {
+				VkBufferCopy region = copy.region;
+				region.dstOffset += dstBufferOffset;
+				requests.push_back(
+					{ .srcBuffer = m_resourceAllocator->nativeBufferHandle(m_stagingRingBuffers[copy.segmentIndex]),
+					  .dstBuffer = m_resourceAllocator->nativeBufferHandle(transfer.dstBuffer),
+					  .region = region,
+					  .dstUsageStageFlags = transfer.dstUsageStageFlags,
+					  .dstUsageAccessFlags = transfer.dstUsageAccessFlags });
+			}
+		};
 		for (auto& transfer : m_continuousTransfers) {
-			if (transfer.needsStagingBuffer && transfer.hasNewData[frameIndex]) {
-				bufferBarriers.push_back(
-					{ .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
-					  .srcAccessMask = VK_ACCESS_HOST_WRITE_BIT,
-					  .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
-					  .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-					  .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-					  .buffer = m_resourceAllocator->nativeBufferHandle(
-						  m_stagingBuffers[transfer.stagingBuffers[frameIndex].bufferHandle].buffer),
-					  .offset = 0,
-					  .size = VK_WHOLE_SIZE });
-				srcStageFlags |= VK_PIPELINE_STAGE_HOST_BIT;
+			if (!transfer.needsStagingBuffer) {
+				continue;
 			}
+			// Continuous transfers have only one destination buffer, which earlier frames may still read
+			addCopyRequests(transfer, transfer.stagingCopies[frameIndex], true);
+			transfer.stagingCopies[frameIndex].clear();
 		}
 		for (auto& transfer : m_oneTimeTransfers) {
-			if (transfer.needsStagingBuffer) {
-				bufferBarriers.push_back({ .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
-										   .srcAccessMask = VK_ACCESS_HOST_WRITE_BIT,
-										   .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
-										   .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-										   .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-										   .buffer = m_resourceAllocator->nativeBufferHandle(
-											   m_stagingBuffers[transfer.stagingBuffers[0].bufferHandle].buffer),
-										   .offset = 0,
-										   .size = VK_WHOLE_SIZE });
-				srcStageFlags |= VK_PIPELINE_STAGE_HOST_BIT;
+			if (!transfer.needsStagingBuffer) {
+				continue;
 			}
+			addCopyRequests(transfer, transfer.stagingCopies[0], false);
 		}
+		BufferCopyPlan copyPlan = planBufferCopies(copyRequests);
+
+		m_transferQueueWait = std::nullopt;
+		std::vector<VkBufferMemoryBarrier> acquireBarriers;
+		if (!transferQueueCopyRequests.empty()) {
+			BufferCopyPlan transferQueueCopyPlan = planBufferCopies(transferQueueCopyRequests);
+			acquireBarriers = submitTransferQueueCopies(frameIndex, transferQueueCopyPlan);
+			m_transferQueueWait = TimelineSemaphoreWait{ .semaphore = m_transferQueueSemaphore,
+														 .value = m_transferQueueSemaphoreValue,
+														 .dstStageFlags = transferQueueCopyPlan.dstStageFlags };
+		}
+
+		std::vector<VkImageMemoryBarrier> imageBarriers;
+		imageBarriers.reserve(m_imageTransfers.size());
+		VkPipelineStageFlags srcStageFlags = 0;
+
 		for (auto& transfer : m_imageTransfers) {
+			auto srcScope = imageTransferSourceScope(transfer.srcLayout);
 			imageBarriers.push_back(
 				{ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-				  .srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT,
+				  .srcAccessMask = srcScope.accessFlags,
 				  .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
 				  .oldLayout = transfer.srcLayout,
 				  .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
@@ -399,34 +488,16 @@ namespace vanadium::graphics {
 										.levelCount = 1,
 										.baseArrayLayer = transfer.copy.imageSubresource.baseArrayLayer,
 										.layerCount = transfer.copy.imageSubresource.layerCount } });
-			srcStageFlags |= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+			srcStageFlags |= srcScope.stageFlags;
 		}
-		if (!bufferBarriers.empty() || !imageBarriers.empty()) {
-			vkCmdPipelineBarrier(commandBuffer, srcStageFlags, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr,
-								 static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
-								 static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+		if (!imageBarriers.empty()) {
+			vkCmdPipelineBarrier(commandBuffer, srcStageFlags, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
+								 nullptr, static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
 		}
 
-		for (auto& transfer : m_continuousTransfers) {
-			if (transfer.needsStagingBuffer && transfer.hasNewData[frameIndex]) {
-				VkBufferCopy copy = { .srcOffset =
-										  transfer.stagingBuffers[frameIndex].allocationResult.usableRange.offset,
-									  .size = transfer.bufferSize };
-				vkCmdCopyBuffer(commandBuffer,
-								m_resourceAllocator->nativeBufferHandle(
-									m_stagingBuffers[transfer.stagingBuffers[frameIndex].bufferHandle].buffer),
-								m_resourceAllocator->nativeBufferHandle(transfer.dstBuffer), 1, &copy);
-			}
-		}
-		for (auto& transfer : m_oneTimeTransfers) {
-			if (transfer.needsStagingBuffer) {
-				VkBufferCopy copy = { .srcOffset = transfer.stagingBuffers[0].allocationResult.usableRange.offset,
-									  .size = transfer.bufferSize };
-				vkCmdCopyBuffer(commandBuffer,
-								m_resourceAllocator->nativeBufferHandle(
-									m_stagingBuffers[transfer.stagingBuffers[0].bufferHandle].buffer),
-								m_resourceAllocator->nativeBufferHandle(transfer.dstBuffer), 1, &copy);
-			}
+		for (auto& batch : copyPlan.copies) {
+			vkCmdCopyBuffer(commandBuffer, batch.srcBuffer, batch.dstBuffer,
+							static_cast<uint32_t>(batch.regions.size()), batch.regions.data());
 		}
 		for (auto& transfer : m_imageTransfers) {
 			vkCmdCopyBufferToImage(commandBuffer, m_resourceAllocator->nativeBufferHandle(transfer.stagingBuffer),
@@ -434,51 +505,9 @@ namespace vanadium::graphics {
 								   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &transfer.copy);
 		}
 
-		bufferBarriers.clear();
 		imageBarriers.clear();
-		srcStageFlags = 0;
-		VkPipelineStageFlags dstStageFlags = 0;
+		VkPipelineStageFlags dstStageFlags = copyPlan.dstStageFlags;
 
-		for (auto& transfer : m_continuousTransfers) {
-			if (transfer.hasNewData[frameIndex]) {
-				VkBufferMemoryBarrier barrier = { .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
-												  .srcAccessMask = VK_ACCESS_HOST_WRITE_BIT,
-												  .dstAccessMask = transfer.dstUsageAccessFlags,
-												  .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-												  .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-												  .buffer = m_resourceAllocator->nativeBufferHandle(transfer.dstBuffer),
-												  .offset = 0,
-												  .size = VK_WHOLE_SIZE };
-				if (transfer.needsStagingBuffer) {
-					barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-					srcStageFlags |= VK_PIPELINE_STAGE_TRANSFER_BIT;
-				} else {
-					srcStageFlags |= VK_PIPELINE_STAGE_HOST_BIT;
-				}
-				dstStageFlags |= transfer.dstUsageStageFlags;
-				bufferBarriers.push_back(barrier);
-			}
-			transfer.hasNewData[frameIndex] = false;
-		}
-		for (auto& transfer : m_oneTimeTransfers) {
-			VkBufferMemoryBarrier barrier = { .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
-											  .srcAccessMask = VK_ACCESS_HOST_WRITE_BIT,
-											  .dstAccessMask = transfer.dstUsageAccessFlags,
-											  .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-											  .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-											  .buffer = m_resourceAllocator->nativeBufferHandle(transfer.dstBuffer),
-											  .offset = 0,
-											  .size = VK_WHOLE_SIZE };
-			if (transfer.needsStagingBuffer) {
-				m_stagingBufferAllocationFreeList[frameIndex].push_back(transfer.stagingBuffers[0]);
-				barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-				srcStageFlags |= VK_PIPELINE_STAGE_TRANSFER_BIT;
-			} else {
-				srcStageFlags |= VK_PIPELINE_STAGE_HOST_BIT;
-			}
-			dstStageFlags |= transfer.dstUsageStageFlags;
-			bufferBarriers.push_back(barrier);
-		}
 		for (auto& transfer : m_imageTransfers) {
 			VkImageMemoryBarrier barrier = { .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
 											 .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
@@ -494,27 +523,87 @@ namespace vanadium::graphics {
 												 .levelCount = 1,
 												 .baseArrayLayer = transfer.copy.imageSubresource.baseArrayLayer,
 												 .layerCount = transfer.copy.imageSubresource.layerCount } };
-			srcStageFlags |= VK_PIPELINE_STAGE_TRANSFER_BIT;
 			dstStageFlags |= transfer.dstUsageStageFlags;
 			m_resourceAllocator->destroyBuffer(transfer.stagingBuffer);
 			imageBarriers.push_back(barrier);
 		}
-		if (bufferBarriers.size() > 0 && imageBarriers.size() > 0)
-			vkCmdPipelineBarrier(commandBuffer, srcStageFlags, dstStageFlags, 0, 0, nullptr,
-								 static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+		if (!copyPlan.barriers.empty() || !imageBarriers.empty()) {
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStageFlags, 0, 0, nullptr,
+								 static_cast<uint32_t>(copyPlan.barriers.size()), copyPlan.barriers.data(),
 								 static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+		}
+		if (m_transferQueueWait.has_value()) {
+			// The graphics submission waits for the transfer queue in the usage stages, the acquire barriers are
+			// chained to that wait
+			vkCmdPipelineBarrier(commandBuffer, m_transferQueueWait->dstStageFlags, m_transferQueueWait->dstStageFlags,
+								 0, 0, nullptr, static_cast<uint32_t>(acquireBarriers.size()), acquireBarriers.data(),
+								 0, nullptr);
+		}
 
 		verifyResult(vkEndCommandBuffer(commandBuffer));
 
+		m_stagingRingFrameValues[frameIndex] = ++m_stagingRingFrameValue;
+		m_stagingRing.closeFrame(m_stagingRingFrameValue);
+
 		m_imageTransfers.clear();
 		m_oneTimeTransfers.clear();
 		return commandBuffer;
 	}
 
+	std::vector<VkBufferMemoryBarrier> GPUTransferManager::submitTransferQueueCopies(uint32_t frameIndex,
+																					  BufferCopyPlan& copyPlan) {
+		// The frame's fence was waited on, which also waited for the transfer submission the graphics frame depended on
+		verifyResult(vkResetCommandPool(m_context->device(), m_transferQueueCommandPools[frameIndex], 0));
+		VkCommandBuffer commandBuffer = m_transferQueueCommandBuffers[frameIndex];
+		VkCommandBufferBeginInfo info = { .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+										  .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT };
+		verifyResult(vkBeginCommandBuffer(commandBuffer, &info));
+
+		for (auto& batch : copyPlan.copies) {
+			vkCmdCopyBuffer(commandBuffer, batch.srcBuffer, batch.dstBuffer,
+							static_cast<uint32_t>(batch.regions.size()), batch.regions.data());
+		}
+
+		std::vector<VkBufferMemoryBarrier> acquireBarriers;
+		acquireBarriers.reserve(copyPlan.barriers.size());
+		for (auto& barrier : copyPlan.barriers) {
+			barrier.srcQueueFamilyIndex = m_context->asyncTransferQueueFamilyIndex();
+			barrier.dstQueueFamilyIndex = m_context->graphicsQueueFamilyIndex();
+			acquireBarriers.push_back(barrier);
+			acquireBarriers.back().srcAccessMask = 0;
+			barrier.dstAccessMask = 0;
+		}
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0,
+							 nullptr, static_cast<uint32_t>(copyPlan.barriers.size()), copyPlan.barriers.data(), 0,
+							 nullptr);
+		verifyResult(vkEndCommandBuffer(commandBuffer));
+
+		++m_transferQueueSemaphoreValue;
+		VkTimelineSemaphoreSubmitInfoKHR timelineSubmitInfo = {
+			.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
+			.signalSemaphoreValueCount = 1,
+			.pSignalSemaphoreValues = &m_transferQueueSemaphoreValue
+		};
+		VkSubmitInfo submitInfo = { .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+									.pNext = &timelineSubmitInfo,
+									.commandBufferCount = 1,
+									.pCommandBuffers = &commandBuffer,
+									.signalSemaphoreCount = 1,
+									.pSignalSemaphores = &m_transferQueueSemaphore };
+		verifyResult(vkQueueSubmit(m_context->asyncTransferQueue(), 1, &submitInfo, VK_NULL_HANDLE));
+		return acquireBarriers;
+	}
+
 	void GPUTransferManager::destroy() {
 		for (auto& pool : m_transferCommandPools) {
 			vkDestroyCommandPool(m_context->device(), pool, nullptr);
 		}
+		if (m_transferQueuePolicy.canUseTransferQueue()) {
+			for (auto& pool : m_transferQueueCommandPools) {
+				vkDestroyCommandPool(m_context->device(), pool, nullptr);
+			}
+			vkDestroySemaphore(m_context->device(), m_transferQueueSemaphore, nullptr);
+		}
 	}
 
 	StagingBufferAllocation GPUTransferManager::allocateStagingBufferArea(VkDeviceSize size) {
@@ -522,8 +611,7 @@ namespace vanadium::graphics {
 			auto& block = *iterator;
 			bool isCoherent = m_resourceAllocator->bufferMemoryCapabilities(block.buffer).hostCoherent;
 			auto allocResult =
-				allocateFromRanges(block.freeRangesOffsetSorted, block.freeRangesSizeSorted,
-								   isCoherent ? 0 : m_context->properties().limits.nonCoherentAtomSize, size);
+				block.freeRanges.allocate(isCoherent ? 0 : m_context->properties().limits.nonCoherentAtomSize, size);
 			if (allocResult.has_value()) {
 				return { .bufferHandle = m_stagingBuffers.handle(iterator), .allocationResult = allocResult.value() };
 			}
@@ -535,26 +623,70 @@ namespace vanadium::graphics {
 												   .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
 		StagingBuffer newBuffer = { .buffer = m_resourceAllocator->createBuffer(
 										newBufferCreateInfo, { .hostVisible = true }, { .hostCoherent = true }, true),
-									.maxAllocatableSize = newBufferCreateInfo.size,
 									.originalSize = newBufferCreateInfo.size,
-									.freeRangesOffsetSorted = { { .offset = 0, .size = newBufferCreateInfo.size } },
-									.freeRangesSizeSorted = { { .offset = 0, .size = newBufferCreateInfo.size } } };
+									.freeRanges = RangeAllocator(0, newBufferCreateInfo.size) };
 
 		bool isCoherent = m_resourceAllocator->bufferMemoryCapabilities(newBuffer.buffer).hostCoherent;
 		return { .bufferHandle = m_stagingBuffers.addElement(newBuffer),
 				 .allocationResult =
-					 allocateFromRanges((--m_stagingBuffers.end())->freeRangesOffsetSorted,
-										(--m_stagingBuffers.end())->freeRangesSizeSorted,
-										isCoherent ? 0 : m_context->properties().limits.nonCoherentAtomSize, size)
+					 (--m_stagingBuffers.end())
+						 ->freeRanges.allocate(isCoherent ? 0 : m_context->properties().limits.nonCoherentAtomSize, size)
 						 .value() };
 	}
 
+	StagingRingAllocation GPUTransferManager::allocateStagingRingArea(VkDeviceSize size) {
+		VkDeviceSize nonCoherentAtomSize = m_context->properties().limits.nonCoherentAtomSize;
+		// Whether the memory of new segments is coherent isn't known yet, so always align to the atom size. This also
+		// keeps flushed ranges from overlapping with areas of other frames.
+		auto allocation = m_stagingRing.allocate(roundUpAligned(size, nonCoherentAtomSize),
+												 std::max(nonCoherentAtomSize, VkDeviceSize(4)));
+
+		// Segments are read by both the graphics and the transfer queue
+		uint32_t queueFamilyIndices[2] = { m_context->graphicsQueueFamilyIndex(),
+										   m_context->asyncTransferQueueFamilyIndex() };
+		bool isShared = m_transferQueuePolicy.canUseTransferQueue();
+		m_stagingRingBuffers.resize(m_stagingRing.segmentCount(), ~0U);
+		// New segments either extend the ring or reuse the index of a released segment
+		if (m_stagingRingBuffers[allocation.segmentIndex] == ~0U) {
+			VkBufferCreateInfo segmentCreateInfo = {
+				.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+				.size = m_stagingRing.segmentSize(allocation.segmentIndex),
+				.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				.sharingMode = isShared ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+				.queueFamilyIndexCount = isShared ? 2U : 0U,
+				.pQueueFamilyIndices = isShared ? queueFamilyIndices : nullptr
+			};
+			m_stagingRingBuffers[allocation.segmentIndex] = m_resourceAllocator->createBuffer(
+				segmentCreateInfo, { .hostVisible = true }, { .hostCoherent = true }, true);
+		}
+		return allocation;
+	}
+
+	void GPUTransferManager::writeStagingRingArea(const StagingRingAllocation& allocation, const void* data,
+												  VkDeviceSize size) {
+		BufferResourceHandle segmentBuffer = m_stagingRingBuffers[allocation.segmentIndex];
+		std::memcpy(reinterpret_cast<void*>(
+						reinterpret_cast<uintptr_t>(m_resourceAllocator->mappedBufferData(segmentBuffer)) +
+						allocation.offset),
+					data, size);
+
+		if (!m_resourceAllocator->bufferMemoryCapabilities(segmentBuffer).hostCoherent) {
+			VkDeviceSize nonCoherentAtomSize = m_context->properties().limits.nonCoherentAtomSize;
+			VkMappedMemoryRange flushRange = { .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+											   .memory = m_resourceAllocator->nativeMemoryHandle(segmentBuffer),
+											   .offset = m_resourceAllocator->allocationRange(segmentBuffer).offset +
+														 allocation.offset,
+											   .size = roundUpAligned(size, nonCoherentAtomSize) };
+			vkFlushMappedMemoryRanges(m_context->device(), 1, &flushRange);
+		}
+	}
+
 	void GPUTransferManager::tryCleanupStagingBuffers() {
 		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
 	blockFreeStart:
 		auto blockIterator = m_stagingBuffers.begin();
 		for (auto& block : m_stagingBuffers) {
-			if (block.maxAllocatableSize == block.originalSize) {
+			if (block.freeRanges.maxAllocatableSize() == block.originalSize) {
 				m_resourceAllocator->destroyBufferImmediately(block.buffer);
 				m_stagingBuffers.removeElement(m_stagingBuffers.handle(blockIterator));
 				goto blockFreeStart;
@@ -615,8 +747,7 @@ namespace vanadium::graphics {
 
 		auto bufferHandle = m_asyncBufferTransfers[handle].stagingBufferAllocation.bufferHandle;
 		auto& allocationRange = m_asyncBufferTransfers[handle].stagingBufferAllocation.allocationResult.allocationRange;
-		freeToRanges(m_stagingBuffers[bufferHandle].freeRangesOffsetSorted,
-					 m_stagingBuffers[bufferHandle].freeRangesSizeSorted, allocationRange.offset, allocationRange.size);
+		m_stagingBuffers[bufferHandle].freeRanges.free(allocationRange.offset, allocationRange.size);
 		m_asyncBufferTransfers.removeElement(handle);
 	}
 
@@ -626,8 +757,7 @@ namespace vanadium::graphics {
 
 		auto bufferHandle = m_asyncImageTransfers[handle].stagingBufferAllocation.bufferHandle;
 		auto& allocationRange = m_asyncImageTransfers[handle].stagingBufferAllocation.allocationResult.allocationRange;
-		freeToRanges(m_stagingBuffers[bufferHandle].freeRangesOffsetSorted,
-					 m_stagingBuffers[bufferHandle].freeRangesSizeSorted, allocationRange.offset, allocationRange.size);
+		m_stagingBuffers[bufferHandle].freeRanges.free(allocationRange.offset, allocationRange.size);
 		m_asyncImageTransfers.removeElement(handle);
 	}
 } // namespace vanadium::graphics
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include <graphics/util/NodeCulling.hpp>
+#include <unordered_map>
+
+namespace vanadium::graphics {
+
+	std::vector<bool> findCulledNodes(const std::vector<NodeResourceUsage>& nodes) {
+		std::unordered_map<uint64_t, std::vector<size_t>> resourceWriters;
+		for (size_t nodeIndex = 0; nodeIndex < nodes.size(); ++nodeIndex) {
+			for (auto resource : nodes[nodeIndex].writtenResources) {
+				resourceWriters[resource].push_back(nodeIndex);
+			}
+		}
+
+		std::vector<bool> isCulled(nodes.size(), true);
+		std::vector<size_t> nodeStack;
+		for (size_t nodeIndex = 0; nodeIndex < nodes.size(); ++nodeIndex) {
+			if (nodes[nodeIndex].hasExternalEffects || nodes[nodeIndex].writtenResources.empty()) {
+				isCulled[nodeIndex] = false;
+				nodeStack.push_back(nodeIndex);
+			}
+		}
+
+		while (!nodeStack.empty()) {
+			size_t nodeIndex = nodeStack.back();
+			nodeStack.pop_back();
+			for (auto resource : nodes[nodeIndex].readResources) {
+				auto writerIterator = resourceWriters.find(resource);
+				if (writerIterator == resourceWriters.end()) {
+					continue;
+				}
+				for (auto writerIndex : writerIterator->second) {
+					if (isCulled[writerIndex]) {
+						isCulled[writerIndex] = false;
+						nodeStack.push_back(writerIndex);
+					}
+				}
+			}
+		}
+		return isCulled;
+	}
+} // namespace vanadium::graphics
@@ -0,0 +1,70 @@
+#include <graphics/util/PipelineBarrierBatch.hpp>
+
+namespace vanadium::graphics {
+
+	void PipelineBarrierBatch::reset(bool usesSynchronization2) {
+		m_usesSynchronization2 = usesSynchronization2;
+		m_bufferBarriers.clear();
+		m_imageBarriers.clear();
+		m_srcStageFlags = 0;
+		m_dstStageFlags = 0;
+		m_bufferBarriers2.clear();
+		m_imageBarriers2.clear();
+	}
+
+	// The stage and access bits of synchronization2 have the same values as the legacy ones
+	void PipelineBarrierBatch::addBufferBarrier(const VkBufferMemoryBarrier& barrier,
+												VkPipelineStageFlags srcStageFlags,
+												VkPipelineStageFlags dstStageFlags) {
+		if (!m_usesSynchronization2) {
+			m_bufferBarriers.push_back(barrier);
+			m_srcStageFlags |= srcStageFlags;
+			m_dstStageFlags |= dstStageFlags;
+			return;
+		}
+		m_bufferBarriers2.push_back({ .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR,
+									  .srcStageMask = srcStageFlags,
+									  .srcAccessMask = barrier.srcAccessMask,
+									  .dstStageMask = dstStageFlags,
+									  .dstAccessMask = barrier.dstAccessMask,
+									  .srcQueueFamilyIndex = barrier.srcQueueFamilyIndex,
+									  .dstQueueFamilyIndex = barrier.dstQueueFamilyIndex,
+									  .buffer = barrier.buffer,
+									  .offset = barrier.offset,
+									  .size = barrier.size });
+	}
+
+	void PipelineBarrierBatch::addImageBarrier(const VkImageMemoryBarrier& barrier, VkPipelineStageFlags srcStageFlags,
+											   VkPipelineStageFlags dstStageFlags) {
+		if (!m_usesSynchronization2) {
+			m_imageBarriers.push_back(barrier);
+			m_srcStageFlags |= srcStageFlags;
+			m_dstStageFlags |= dstStageFlags;
+			return;
+		}
+		m_imageBarriers2.push_back({ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR,
+									 .srcStageMask = srcStageFlags,
+									 .srcAccessMask = barrier.srcAccessMask,
+									 .dstStageMask = dstStageFlags,
+									 .dstAccessMask = barrier.dstAccessMask,
+									 .oldLayout = barrier.oldLayout,
+									 .newLayout = barrier.newLayout,
+									 .srcQueueFamilyIndex = barrier.srcQueueFamilyIndex,
+									 .dstQueueFamilyIndex = barrier.dstQueueFamilyIndex,
+									 .image = barrier.image,
+									 .subresourceRange = barrier.subresourceRange });
+	}
+
+	bool PipelineBarrierBatch::empty() const {
+		return m_bufferBarriers.empty() && m_imageBarriers.empty() && m_bufferBarriers2.empty() &&
+			   m_imageBarriers2.empty();
+	}
+
+	VkDependencyInfoKHR PipelineBarrierBatch::dependencyInfo() const {
+		return { .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR,
+				 .bufferMemoryBarrierCount = static_cast<uint32_t>(m_bufferBarriers2.size()),
+				 .pBufferMemoryBarriers = m_bufferBarriers2.data(),
+				 .imageMemoryBarrierCount = static_cast<uint32_t>(m_imageBarriers2.size()),
+				 .pImageMemoryBarriers = m_imageBarriers2.data() };
+	}
+} // namespace vanadium::graphics
@@ -0,0 +1,116 @@
+#include <graphics/util/PipelineCacheFile.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace vanadium::graphics {
+	namespace {
+		struct PipelineCacheFileHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t vendorID;
+			uint32_t deviceID;
+			uint32_t driverVersion;
+			// Keeps the struct free of padding bytes, which would be written uninitialized
+			uint32_t reserved;
+			std::array<uint8_t, 16> pipelineCacheUUID;
+			uint64_t dataSize;
+			uint64_t checksum;
+		};
+		static_assert(sizeof(PipelineCacheFileHeader) == 56);
+
+		// Header every VkPipelineCache's data starts with, see VkPipelineCacheHeaderVersionOne
+		constexpr size_t vulkanCacheHeaderSize = 32;
+		constexpr uint32_t vulkanCacheHeaderVersionOne = 1;
+
+		// FNV-1a
+		uint64_t checksum(const char* data, size_t size) {
+			uint64_t hash = 0xCBF29CE484222325ULL;
+			for (size_t i = 0; i < size; ++i) {
+				hash ^= static_cast<uint8_t>(data[i]);
+				hash *= 0x100000001B3ULL;
+			}
+			return hash;
+		}
+
+		template <typename T> T read(const char* data, size_t offset) {
+			T value;
+			std::memcpy(&value, data + offset, sizeof(T));
+			return value;
+		}
+
+		bool matchesVulkanHeader(const PipelineCacheDeviceInfo& deviceInfo, const char* data, size_t size) {
+			if (size < vulkanCacheHeaderSize) {
+				return false;
+			}
+			uint32_t headerSize = read<uint32_t>(data, 0);
+			uint32_t headerVersion = read<uint32_t>(data, 4);
+			auto pipelineCacheUUID = read<std::array<uint8_t, 16>>(data, 16);
+			return headerSize >= vulkanCacheHeaderSize && headerSize <= size &&
+				   headerVersion == vulkanCacheHeaderVersionOne && read<uint32_t>(data, 8) == deviceInfo.vendorID &&
+				   read<uint32_t>(data, 12) == deviceInfo.deviceID &&
+				   pipelineCacheUUID == deviceInfo.pipelineCacheUUID;
+		}
+	} // namespace
+
+	std::vector<char> serializePipelineCache(const PipelineCacheDeviceInfo& deviceInfo,
+											 const std::vector<char>& cacheData) {
+		PipelineCacheFileHeader header = { .magic = pipelineCacheFileMagic,
+										   .version = pipelineCacheFileVersion,
+										   .vendorID = deviceInfo.vendorID,
+										   .deviceID = deviceInfo.deviceID,
+										   .driverVersion = deviceInfo.driverVersion,
+										   .reserved = 0,
+										   .pipelineCacheUUID = deviceInfo.pipelineCacheUUID,
+										   .dataSize = cacheData.size(),
+										   .checksum = checksum(cacheData.data(), cacheData.size()) };
+		std::vector<char> fileData(sizeof(PipelineCacheFileHeader) + cacheData.size());
+		std::memcpy(fileData.data(), &header, sizeof(PipelineCacheFileHeader));
+		std::memcpy(fileData.data() + sizeof(PipelineCacheFileHeader), cacheData.data(), cacheData.size());
+		return fileData;
+	}
+
+	std::optional<std::vector<char>> deserializePipelineCache(const PipelineCacheDeviceInfo& deviceInfo,
+															  const char* fileData, size_t fileSize) {
+		if (!fileData || fileSize < sizeof(PipelineCacheFileHeader)) {
+			return std::nullopt;
+		}
+		auto header = read<PipelineCacheFileHeader>(fileData, 0);
+		if (header.magic != pipelineCacheFileMagic || header.version != pipelineCacheFileVersion ||
+			header.vendorID != deviceInfo.vendorID || header.deviceID != deviceInfo.deviceID ||
+			header.driverVersion != deviceInfo.driverVersion ||
+			header.pipelineCacheUUID != deviceInfo.pipelineCacheUUID ||
+			header.dataSize != fileSize - sizeof(PipelineCacheFileHeader)) {
+			return std::nullopt;
+		}
+
+		const char* cacheData = fileData + sizeof(PipelineCacheFileHeader);
+		if (header.checksum != checksum(cacheData, header.dataSize) ||
+			!matchesVulkanHeader(deviceInfo, cacheData, header.dataSize)) {
+			return std::nullopt;
+		}
+		return std::vector<char>(cacheData, cacheData + header.dataSize);
+	}
+
+	bool writeFileAtomically(const std::string& fileName, const std::vector<char>& data) {
+		std::string temporaryFileName = fileName + ".tmp";
+		{
+			std::ofstream stream = std::ofstream(temporaryFileName, std::ios::binary | std::ios::trunc);
+			if (!stream.is_open()) {
+				return false;
+			}
+			stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+			if (!stream.good()) {
+				return false;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporaryFileName, fileName, error);
+		if (error) {
+			std::filesystem::remove(temporaryFileName, error);
+			return false;
+		}
+		return true;
+	}
+} // namespace vanadium::graphics
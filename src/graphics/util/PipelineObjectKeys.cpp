@@ -0,0 +1,94 @@
+#include <graphics/util/PipelineObjectKeys.hpp>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace vanadium::graphics {
+	namespace {
+		// Fields are appended one by one, so that padding and pointers don't end up in the key
+		template <typename T> void appendField(std::string& key, const T& field) {
+			key.append(reinterpret_cast<const char*>(&field), sizeof(T));
+		}
+	} // namespace
+
+	std::string samplerKey(const VkSamplerCreateInfo& createInfo) {
+		std::string key;
+		appendField(key, createInfo.flags);
+		appendField(key, createInfo.magFilter);
+		appendField(key, createInfo.minFilter);
+		appendField(key, createInfo.mipmapMode);
+		appendField(key, createInfo.addressModeU);
+		appendField(key, createInfo.addressModeV);
+		appendField(key, createInfo.addressModeW);
+		appendField(key, createInfo.mipLodBias);
+		appendField(key, createInfo.anisotropyEnable);
+		appendField(key, createInfo.maxAnisotropy);
+		appendField(key, createInfo.compareEnable);
+		appendField(key, createInfo.compareOp);
+		appendField(key, createInfo.minLod);
+		appendField(key, createInfo.maxLod);
+		appendField(key, createInfo.borderColor);
+		appendField(key, createInfo.unnormalizedCoordinates);
+		return key;
+	}
+
+	std::string descriptorSetLayoutKey(const VkDescriptorSetLayoutCreateInfo& createInfo) {
+		auto bindings = std::vector<VkDescriptorSetLayoutBinding>(createInfo.pBindings,
+																  createInfo.pBindings + createInfo.bindingCount);
+		std::sort(bindings.begin(), bindings.end(),
+				  [](const auto& first, const auto& second) { return first.binding < second.binding; });
+
+		std::string key;
+		appendField(key, createInfo.flags);
+		appendField(key, createInfo.bindingCount);
+		for (auto& binding : bindings) {
+			appendField(key, binding.binding);
+			appendField(key, binding.descriptorType);
+			appendField(key, binding.descriptorCount);
+			appendField(key, binding.stageFlags);
+			bool usesImmutableSamplers = binding.pImmutableSamplers != nullptr;
+			appendField(key, usesImmutableSamplers);
+			if (usesImmutableSamplers) {
+				key.append(reinterpret_cast<const char*>(binding.pImmutableSamplers),
+						   binding.descriptorCount * sizeof(VkSampler));
+			}
+		}
+		return key;
+	}
+
+	std::string pipelineLayoutKey(const VkPipelineLayoutCreateInfo& createInfo) {
+		std::string key;
+		appendField(key, createInfo.flags);
+		appendField(key, createInfo.setLayoutCount);
+		key.append(reinterpret_cast<const char*>(createInfo.pSetLayouts),
+				   createInfo.setLayoutCount * sizeof(VkDescriptorSetLayout));
+		appendField(key, createInfo.pushConstantRangeCount);
+		for (uint32_t i = 0; i < createInfo.pushConstantRangeCount; ++i) {
+			appendField(key, createInfo.pPushConstantRanges[i].stageFlags);
+			appendField(key, createInfo.pPushConstantRanges[i].offset);
+			appendField(key, createInfo.pPushConstantRanges[i].size);
+		}
+		return key;
+	}
+
+	bool ShaderModuleKey::operator==(const ShaderModuleKey& other) const {
+		if (flags != other.flags || codeSize != other.codeSize || codeHash != other.codeHash) {
+			return false;
+		}
+		return pCode == other.pCode || std::memcmp(pCode, other.pCode, codeSize) == 0;
+	}
+
+	ShaderModuleKey shaderModuleKey(const VkShaderModuleCreateInfo& createInfo, std::shared_ptr<const void> codeOwner) {
+		// FNV-1a over the code words, SPIR-V is a sequence of words
+		uint64_t hash = 0xCBF29CE484222325ULL;
+		for (size_t i = 0; i < createInfo.codeSize / sizeof(uint32_t); ++i) {
+			hash ^= createInfo.pCode[i];
+			hash *= 0x100000001B3ULL;
+		}
+		return { .flags = createInfo.flags,
+				 .codeSize = createInfo.codeSize,
+				 .codeHash = hash,
+				 .pCode = createInfo.pCode,
+				 .codeOwner = std::move(codeOwner) };
+	}
+} // namespace vanadium::graphics
@@ -0,0 +1,51 @@
+#include <graphics/util/PipelineUsageLog.hpp>
+#include <charconv>
+
+namespace vanadium::graphics {
+	std::string serializePipelineUsage(const std::vector<PipelineUsageEntry>& entries) {
+		std::string text = std::string(pipelineUsageLogHeader) + "\n";
+		char hashText[16];
+		for (auto& entry : entries) {
+			auto result = std::to_chars(hashText, hashText + sizeof(hashText), entry.signatureHash, 16);
+			text.append(hashText, result.ptr);
+			text += ' ';
+			text += entry.instanceName;
+			text += '\n';
+		}
+		return text;
+	}
+
+	std::vector<PipelineUsageEntry> parsePipelineUsage(std::string_view text) {
+		std::vector<PipelineUsageEntry> entries;
+		bool isFirstLine = true;
+		while (!text.empty()) {
+			size_t lineEnd = text.find('\n');
+			std::string_view line = text.substr(0, lineEnd);
+			text.remove_prefix(lineEnd == std::string_view::npos ? text.size() : lineEnd + 1);
+			if (!line.empty() && line.back() == '\r') {
+				line.remove_suffix(1);
+			}
+
+			if (isFirstLine) {
+				if (line != pipelineUsageLogHeader) {
+					return {};
+				}
+				isFirstLine = false;
+				continue;
+			}
+
+			size_t separator = line.find(' ');
+			if (separator == std::string_view::npos || separator == 0 || separator + 1 == line.size()) {
+				continue;
+			}
+			uint64_t signatureHash;
+			auto result = std::from_chars(line.data(), line.data() + separator, signatureHash, 16);
+			if (result.ec != std::errc() || result.ptr != line.data() + separator) {
+				continue;
+			}
+			entries.push_back({ .instanceName = std::string(line.substr(separator + 1)),
+								.signatureHash = signatureHash });
+		}
+		return entries;
+	}
+} // namespace vanadium::graphics
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <graphics/util/QueueScheduling.hpp>
+
+namespace vanadium::graphics {
+
+	size_t QueueSchedule::batchIndex(size_t nodeIndex) const {
+		auto batchIterator =
+			std::upper_bound(batches.begin(), batches.end(), nodeIndex,
+							 [](size_t nodeIndex, const auto& batch) { return nodeIndex < batch.firstNodeIndex; });
+		return static_cast<size_t>(batchIterator - batches.begin()) - 1;
+	}
+
+	QueueSchedule planQueueSchedule(const std::vector<FramegraphQueue>& nodeQueues,
+									const std::vector<QueueScheduledResource>& resources) {
+		QueueSchedule schedule;
+		for (size_t nodeIndex = 0; nodeIndex < nodeQueues.size(); ++nodeIndex) {
+			if (!schedule.batches.empty() && schedule.batches.back().queue == nodeQueues[nodeIndex]) {
+				++schedule.batches.back().nodeCount;
+			} else {
+				schedule.batches.push_back(
+					{ .queue = nodeQueues[nodeIndex], .firstNodeIndex = nodeIndex, .nodeCount = 1 });
+			}
+		}
+		// The graphics queue starts and presents the frame
+		if (std::none_of(schedule.batches.begin(), schedule.batches.end(),
+						 [](const auto& batch) { return batch.queue == FramegraphQueue::Graphics; })) {
+			schedule.batches.push_back(
+				{ .queue = FramegraphQueue::Graphics, .firstNodeIndex = nodeQueues.size(), .nodeCount = 0 });
+		}
+
+		auto addDependency = [&schedule](size_t srcNodeIndex, size_t dstNodeIndex, bool crossesFrame) {
+			QueueBatchDependency dependency = { .srcBatchIndex = schedule.batchIndex(srcNodeIndex),
+												.dstBatchIndex = schedule.batchIndex(dstNodeIndex),
+												.crossesFrame = crossesFrame };
+			if (std::find(schedule.dependencies.begin(), schedule.dependencies.end(), dependency) ==
+				schedule.dependencies.end()) {
+				schedule.dependencies.push_back(dependency);
+			}
+		};
+
+		for (size_t resourceIndex = 0; resourceIndex < resources.size(); ++resourceIndex) {
+			auto& nodeIndices = resources[resourceIndex].accessingNodeIndices;
+			if (nodeIndices.empty()) {
+				continue;
+			}
+			for (size_t i = 1; i < nodeIndices.size(); ++i) {
+				size_t srcNodeIndex = nodeIndices[i - 1];
+				size_t dstNodeIndex = nodeIndices[i];
+				if (nodeQueues[srcNodeIndex] == nodeQueues[dstNodeIndex]) {
+					continue;
+				}
+				addDependency(srcNodeIndex, dstNodeIndex, false);
+				schedule.ownershipTransfers.push_back({ .resourceIndex = resourceIndex,
+														.srcNodeIndex = srcNodeIndex,
+														.dstNodeIndex = dstNodeIndex,
+														.crossesFrame = false });
+			}
+
+			// The next frame may only overwrite the resource once this frame is done with it, but ownership only
+			// needs to be transferred if the contents are used
+			size_t lastNodeIndex = nodeIndices.back();
+			size_t firstNodeIndex = nodeIndices.front();
+			if (nodeQueues[lastNodeIndex] == nodeQueues[firstNodeIndex]) {
+				continue;
+			}
+			addDependency(lastNodeIndex, firstNodeIndex, true);
+			if (resources[resourceIndex].preservesContents) {
+				schedule.ownershipTransfers.push_back({ .resourceIndex = resourceIndex,
+														.srcNodeIndex = lastNodeIndex,
+														.dstNodeIndex = firstNodeIndex,
+														.crossesFrame = true });
+			}
+		}
+
+		std::sort(schedule.dependencies.begin(), schedule.dependencies.end(), [](const auto& one, const auto& other) {
+			if (one.dstBatchIndex != other.dstBatchIndex) {
+				return one.dstBatchIndex < other.dstBatchIndex;
+			}
+			if (one.srcBatchIndex != other.srcBatchIndex) {
+				return one.srcBatchIndex < other.srcBatchIndex;
+			}
+			return one.crossesFrame < other.crossesFrame;
+		});
+		return schedule;
+	}
+} // namespace vanadium::graphics
@@ -1,6 +1,5 @@
 #include <Log.hpp>
 #include <graphics/util/RangeAllocator.hpp>
-#include <algorithm>
 
 namespace vanadium::graphics {
 	VkDeviceSize roundUpAligned(VkDeviceSize n, VkDeviceSize alignment) { return n + alignmentMargin(n, alignment); }
@@ -14,113 +13,81 @@ namespace vanadium::graphics {
 		return 0;
 	}
 
-	std::optional<RangeAllocationResult> allocateFromRanges(std::vector<MemoryRange>& gapsOffsetSorted,
-															std::vector<MemoryRange>& gapsSizeSorted,
-															VkDeviceSize alignment, VkDeviceSize size) {
-		auto offsetComparator = [](const MemoryRange& one, const MemoryRange& other) {
-			return one.offset < other.offset;
-		};
-		auto sizeComparator = [](const MemoryRange& one, const MemoryRange& other) { return one.size < other.size; };
+	RangeAllocator::RangeAllocator(VkDeviceSize offset, VkDeviceSize size) {
+		if (size)
+			insertRange(offset, size);
+	}
 
+	std::optional<RangeAllocationResult> RangeAllocator::allocate(VkDeviceSize alignment, VkDeviceSize size) {
 		// seek for smallest available block
-		size_t allocationIndex = gapsSizeSorted.size() - 1;
-		while (allocationIndex < gapsSizeSorted.size() &&
-			   gapsSizeSorted[allocationIndex].size >=
-				   size + alignmentMargin(gapsSizeSorted[allocationIndex].offset, alignment)) {
-			--allocationIndex;
+		auto candidateIterator = m_sizeSortedRanges.lower_bound({ .offset = 0, .size = size });
+		size_t candidateCount = 0;
+		while (candidateIterator != m_sizeSortedRanges.end() &&
+			   candidateIterator->size < size + alignmentMargin(candidateIterator->offset, alignment)) {
+			if (++candidateCount == m_maxBestFitCandidates) {
+				// Any range that can hold the maximum alignment margin is guaranteed to fit
+				VkDeviceSize maxMargin = alignment ? alignment - 1 : 0;
+				candidateIterator = m_sizeSortedRanges.lower_bound({ .offset = 0, .size = size + maxMargin });
+				break;
+			}
+			++candidateIterator;
 		}
-		++allocationIndex;
-		if (allocationIndex == gapsSizeSorted.size()) {
+		if (candidateIterator == m_sizeSortedRanges.end()) {
 			return std::nullopt;
 		}
 
-		VkDeviceSize margin = alignmentMargin(gapsSizeSorted[allocationIndex].offset, alignment);
-		auto& usedRange = gapsSizeSorted[allocationIndex];
+		MemoryRange usedRange = *candidateIterator;
+		VkDeviceSize margin = alignmentMargin(usedRange.offset, alignment);
 
 		RangeAllocationResult result = { .allocationRange = { .offset = usedRange.offset, .size = size + margin },
 										 .usableRange = { .offset = usedRange.offset + margin, .size = size } };
 
-		auto& range = gapsSizeSorted[allocationIndex];
-		auto offsetIterator =
-			std::lower_bound(gapsOffsetSorted.begin(), gapsOffsetSorted.end(), range, offsetComparator);
-
-		if (result.allocationRange.size != range.size) {
+		eraseRange(m_offsetSortedRanges.find(usedRange.offset));
+		if (result.allocationRange.size != usedRange.size) {
 			// make unused part of block another free range
-			range.offset += result.allocationRange.size;
-			range.size -= result.allocationRange.size;
-			offsetIterator->offset += result.allocationRange.size;
-			offsetIterator->size -= result.allocationRange.size;
-			std::sort(gapsOffsetSorted.begin(), gapsOffsetSorted.end(), offsetComparator);
-			std::sort(gapsSizeSorted.begin(), gapsSizeSorted.end(), sizeComparator);
-		} else {
-			gapsOffsetSorted.erase(offsetIterator);
-			auto sizeIterator = std::lower_bound(gapsSizeSorted.begin(), gapsSizeSorted.end(), range, sizeComparator);
-			gapsSizeSorted.erase(sizeIterator);
+			insertRange(usedRange.offset + result.allocationRange.size, usedRange.size - result.allocationRange.size);
 		}
-
 		return result;
 	}
 
-	void freeToRanges(std::vector<MemoryRange>& gapsOffsetSorted, std::vector<MemoryRange>& gapsSizeSorted,
-					  VkDeviceSize offset, VkDeviceSize size) {
-		auto offsetComparator = [](const MemoryRange& one, const MemoryRange& other) {
-			return one.offset < other.offset;
-		};
-		auto sizeComparator = [](const MemoryRange& one, const MemoryRange& other) { return one.size < other.size; };
+	void RangeAllocator::free(VkDeviceSize offset, VkDeviceSize size) {
+		auto nextIterator = m_offsetSortedRanges.lower_bound(offset);
 
-		if (gapsOffsetSorted.empty()) {
-			MemoryRange range = { .offset = offset, .size = size };
-			gapsOffsetSorted.push_back(range);
-			gapsSizeSorted.push_back(range);
+		if (nextIterator != m_offsetSortedRanges.begin()) {
+			auto previousIterator = std::prev(nextIterator);
+			assertFatal(previousIterator->first + previousIterator->second <= offset, "RangeAllocator inconsistency!");
+			if (previousIterator->first + previousIterator->second == offset) {
+				offset = previousIterator->first;
+				size += previousIterator->second;
+				eraseRange(previousIterator);
+			}
 		}
-
-		MemoryRange range = { .offset = offset, .size = size };
-
-		auto offsetInsertIterator =
-			std::lower_bound(gapsOffsetSorted.begin(), gapsOffsetSorted.end(), range, offsetComparator);
-
-		if (offsetInsertIterator == gapsOffsetSorted.end()) {
-			gapsOffsetSorted.push_back(range);
-		} else {
-			gapsOffsetSorted.insert(offsetInsertIterator, range);
+		if (nextIterator != m_offsetSortedRanges.end()) {
+			assertFatal(offset + size <= nextIterator->first, "RangeAllocator inconsistency!");
+			if (offset + size == nextIterator->first) {
+				size += nextIterator->second;
+				eraseRange(nextIterator);
+			}
 		}
 
-		auto sizeInsertIterator = std::lower_bound(gapsSizeSorted.begin(), gapsSizeSorted.end(), range, sizeComparator);
-
-		if (sizeInsertIterator == gapsSizeSorted.end())
-			gapsSizeSorted.push_back(range);
-		else
-			gapsSizeSorted.insert(sizeInsertIterator, range);
-
-		mergeFreeAreas(gapsOffsetSorted, gapsSizeSorted);
+		insertRange(offset, size);
 	}
 
-	void mergeFreeAreas(std::vector<MemoryRange>& gapsOffsetSorted, std::vector<MemoryRange>& gapsSizeSorted) {
-		auto sizeComparator = [](const MemoryRange& one, const MemoryRange& other) { return one.size < other.size; };
-		
-		if (gapsOffsetSorted.empty())
-			return;
-		for (size_t i = 0; i < gapsOffsetSorted.size() - 1; ++i) {
-			auto& area = gapsOffsetSorted[i];
-			auto& nextArea = gapsOffsetSorted[i + 1];
-
-			if (area.offset + area.size == nextArea.offset) {
-				area.size += nextArea.size;
-				auto areaIterator = std::find_if(gapsSizeSorted.begin(), gapsSizeSorted.end(),
-												 [area](const auto& gap) { return area.offset == gap.offset; });
-				assertFatal(areaIterator != gapsSizeSorted.end(), "RangeAllocator inconsistency!");
-				areaIterator->size += nextArea.size;
+	VkDeviceSize RangeAllocator::maxAllocatableSize() const {
+		if (m_sizeSortedRanges.empty())
+			return 0;
+		return m_sizeSortedRanges.rbegin()->size;
+	}
 
-				auto nextAreaIterator =
-					std::find_if(gapsSizeSorted.begin(), gapsSizeSorted.end(),
-								 [nextArea](const auto& gap) { return nextArea.offset == gap.offset; });
-				assertFatal(nextAreaIterator != gapsSizeSorted.end(), "RangeAllocator inconsistency!");
-				gapsOffsetSorted.erase(gapsOffsetSorted.begin() + i + 1);
-				gapsSizeSorted.erase(nextAreaIterator);
+	void RangeAllocator::insertRange(VkDeviceSize offset, VkDeviceSize size) {
+		m_offsetSortedRanges.insert({ offset, size });
+		m_sizeSortedRanges.insert({ .offset = offset, .size = size });
+		m_freeSize += size;
+	}
 
-				std::sort(gapsSizeSorted.begin(), gapsSizeSorted.end(), sizeComparator);
-				--i;
-			}
-		}
+	void RangeAllocator::eraseRange(std::map<VkDeviceSize, VkDeviceSize>::iterator offsetIterator) {
+		m_sizeSortedRanges.erase({ .offset = offsetIterator->first, .size = offsetIterator->second });
+		m_freeSize -= offsetIterator->second;
+		m_offsetSortedRanges.erase(offsetIterator);
 	}
-} // namespace vanadium::graphics
\ No newline at end of file
+} // namespace vanadium::graphics
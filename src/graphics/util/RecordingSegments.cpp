@@ -0,0 +1,21 @@
+#include <graphics/util/RecordingSegments.hpp>
+
+namespace vanadium::graphics {
+
+	std::vector<RecordingSegment> planRecordingSegments(const std::vector<bool>& recordsInParallel) {
+		std::vector<RecordingSegment> segments;
+		for (size_t nodeIndex = 0; nodeIndex < recordsInParallel.size(); ++nodeIndex) {
+			if (recordsInParallel[nodeIndex]) {
+				segments.push_back({ .firstNodeIndex = nodeIndex, .nodeCount = 1, .isParallel = true });
+			} else if (!segments.empty() && !segments.back().isParallel) {
+				++segments.back().nodeCount;
+			} else {
+				segments.push_back({ .firstNodeIndex = nodeIndex, .nodeCount = 1, .isParallel = false });
+			}
+		}
+		if (segments.empty()) {
+			segments.push_back({ .firstNodeIndex = 0, .nodeCount = 0, .isParallel = false });
+		}
+		return segments;
+	}
+} // namespace vanadium::graphics
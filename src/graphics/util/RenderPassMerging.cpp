@@ -0,0 +1,167 @@
+#include <graphics/util/RenderPassMerging.hpp>
+#include <algorithm>
+#include <unordered_set>
+
+namespace vanadium::graphics {
+	namespace {
+		// Resources the nodes of a render pass access other than as attachments
+		struct RenderPassResourceAccesses {
+			std::unordered_set<uint64_t> readResources;
+			std::unordered_set<uint64_t> writtenResources;
+		};
+
+		std::optional<uint32_t> findAttachment(const MergedRenderPass& renderPass, uint64_t resource) {
+			for (uint32_t i = 0; i < renderPass.attachments.size(); ++i) {
+				if (renderPass.attachments[i].resource == resource) {
+					return i;
+				}
+			}
+			return std::nullopt;
+		}
+
+		bool canJoin(const MergedRenderPass& renderPass, const RenderPassResourceAccesses& accesses,
+					 const RasterNodeUsage& node) {
+			if (!node.canMerge || node.width != renderPass.width || node.height != renderPass.height) {
+				return false;
+			}
+
+			bool usesRenderPassAttachment = false;
+			auto canUseAttachment = [&](const RasterAttachmentUsage& attachment) {
+				if (attachment.sampleCount != renderPass.attachments.front().sampleCount) {
+					return false;
+				}
+				if (findAttachment(renderPass, attachment.resource).has_value()) {
+					usesRenderPassAttachment = true;
+					// Clearing in the middle of a render pass needs explicit clear commands
+					return attachment.loadOp != VK_ATTACHMENT_LOAD_OP_CLEAR;
+				}
+				// New attachments are transitioned when the render pass begins, before earlier subpasses use them
+				return !accesses.readResources.contains(attachment.resource) &&
+					   !accesses.writtenResources.contains(attachment.resource);
+			};
+			for (auto& attachment : node.colorAttachments) {
+				if (!canUseAttachment(attachment)) {
+					return false;
+				}
+			}
+			if (node.depthStencilAttachment.has_value() && !canUseAttachment(node.depthStencilAttachment.value())) {
+				return false;
+			}
+			for (auto& attachment : node.inputAttachments) {
+				if (findAttachment(renderPass, attachment.resource).has_value()) {
+					usesRenderPassAttachment = true;
+				} else if (accesses.readResources.contains(attachment.resource) ||
+						   accesses.writtenResources.contains(attachment.resource)) {
+					return false;
+				}
+			}
+
+			// Subpass dependencies only cover attachment accesses
+			for (auto resource : node.readResources) {
+				if (findAttachment(renderPass, resource).has_value() || accesses.writtenResources.contains(resource)) {
+					return false;
+				}
+			}
+			for (auto resource : node.writtenResources) {
+				if (findAttachment(renderPass, resource).has_value() || accesses.readResources.contains(resource) ||
+					accesses.writtenResources.contains(resource)) {
+					return false;
+				}
+			}
+			return usesRenderPassAttachment;
+		}
+
+		VkAttachmentReference useAttachment(MergedRenderPass& renderPass, const RasterAttachmentUsage& attachment) {
+			if (auto index = findAttachment(renderPass, attachment.resource); index.has_value()) {
+				auto& mergedAttachment = renderPass.attachments[index.value()];
+				mergedAttachment.storeOp = attachment.storeOp;
+				mergedAttachment.finalLayout = attachment.layout;
+				return { .attachment = index.value(), .layout = attachment.layout };
+			}
+			renderPass.attachments.push_back({ .resource = attachment.resource,
+											   .format = attachment.format,
+											   .sampleCount = attachment.sampleCount,
+											   .loadOp = attachment.loadOp,
+											   .storeOp = attachment.storeOp,
+											   .initialLayout = attachment.layout,
+											   .finalLayout = attachment.layout });
+			return { .attachment = static_cast<uint32_t>(renderPass.attachments.size() - 1),
+					 .layout = attachment.layout };
+		}
+
+		void addSubpass(MergedRenderPass& renderPass, const RasterNodeUsage& node, size_t nodeIndex) {
+			MergedSubpass subpass = { .nodeIndex = nodeIndex };
+			for (auto& attachment : node.colorAttachments) {
+				subpass.colorAttachments.push_back(useAttachment(renderPass, attachment));
+			}
+			if (node.depthStencilAttachment.has_value()) {
+				subpass.depthStencilAttachment = useAttachment(renderPass, node.depthStencilAttachment.value());
+			}
+			for (auto& attachment : node.inputAttachments) {
+				subpass.inputAttachments.push_back(useAttachment(renderPass, attachment));
+			}
+			renderPass.subpasses.push_back(std::move(subpass));
+		}
+
+		bool usesAttachment(const MergedSubpass& subpass, uint32_t attachmentIndex) {
+			auto isAttachment = [attachmentIndex](const auto& reference) {
+				return reference.attachment == attachmentIndex;
+			};
+			return std::any_of(subpass.colorAttachments.begin(), subpass.colorAttachments.end(), isAttachment) ||
+				   std::any_of(subpass.inputAttachments.begin(), subpass.inputAttachments.end(), isAttachment) ||
+				   isAttachment(subpass.depthStencilAttachment);
+		}
+
+		void addPreserveAttachments(MergedRenderPass& renderPass) {
+			for (uint32_t attachmentIndex = 0; attachmentIndex < renderPass.attachments.size(); ++attachmentIndex) {
+				size_t firstSubpassIndex = renderPass.subpasses.size();
+				size_t lastSubpassIndex = 0;
+				for (size_t i = 0; i < renderPass.subpasses.size(); ++i) {
+					if (usesAttachment(renderPass.subpasses[i], attachmentIndex)) {
+						firstSubpassIndex = std::min(firstSubpassIndex, i);
+						lastSubpassIndex = i;
+					}
+				}
+				for (size_t i = firstSubpassIndex + 1; i < lastSubpassIndex; ++i) {
+					if (!usesAttachment(renderPass.subpasses[i], attachmentIndex)) {
+						renderPass.subpasses[i].preserveAttachments.push_back(attachmentIndex);
+					}
+				}
+			}
+		}
+	} // namespace
+
+	std::vector<MergedRenderPass> planRenderPassMerges(const std::vector<RasterNodeUsage>& nodes,
+													   const std::vector<bool>& isNodeCulled) {
+		std::vector<MergedRenderPass> renderPasses;
+		RenderPassResourceAccesses accesses;
+		// Whether the next node that isn't culled may join the last render pass
+		bool canJoinLastRenderPass = false;
+
+		for (size_t nodeIndex = 0; nodeIndex < nodes.size(); ++nodeIndex) {
+			if (nodeIndex < isNodeCulled.size() && isNodeCulled[nodeIndex]) {
+				continue;
+			}
+			auto& node = nodes[nodeIndex];
+			if (!node.isRaster) {
+				canJoinLastRenderPass = false;
+				continue;
+			}
+
+			if (!canJoinLastRenderPass || renderPasses.back().attachments.empty() ||
+				!canJoin(renderPasses.back(), accesses, node)) {
+				renderPasses.push_back({ .width = node.width, .height = node.height });
+				accesses = {};
+			}
+			addSubpass(renderPasses.back(), node, nodeIndex);
+			accesses.readResources.insert(node.readResources.begin(), node.readResources.end());
+			accesses.writtenResources.insert(node.writtenResources.begin(), node.writtenResources.end());
+			canJoinLastRenderPass = node.canMerge;
+		}
+
+		for (auto& renderPass : renderPasses) {
+			addPreserveAttachments(renderPass);
+		}
+		return renderPasses;
+	}
+} // namespace vanadium::graphics
@@ -0,0 +1,36 @@
+#include <graphics/util/SplitBarriers.hpp>
+
+namespace vanadium::graphics {
+
+	std::vector<bool> selectSplitBarriers(const std::vector<SplitBarrierCandidate>& candidates,
+										  const std::vector<FramegraphQueue>& nodeQueues,
+										  const std::vector<bool>& isNodeCulled, size_t minIndependentNodeCount) {
+		// Nodes before each index that aren't culled, and the first node of the run of same-queue nodes containing
+		// each node
+		std::vector<size_t> activeNodesBefore(nodeQueues.size() + 1, 0);
+		std::vector<size_t> queueRunStarts(nodeQueues.size(), 0);
+		for (size_t nodeIndex = 0; nodeIndex < nodeQueues.size(); ++nodeIndex) {
+			bool isCulled = nodeIndex < isNodeCulled.size() && isNodeCulled[nodeIndex];
+			activeNodesBefore[nodeIndex + 1] = activeNodesBefore[nodeIndex] + (isCulled ? 0 : 1);
+			if (nodeIndex > 0 && nodeQueues[nodeIndex] == nodeQueues[nodeIndex - 1]) {
+				queueRunStarts[nodeIndex] = queueRunStarts[nodeIndex - 1];
+			} else {
+				queueRunStarts[nodeIndex] = nodeIndex;
+			}
+		}
+
+		std::vector<bool> isSplit;
+		isSplit.reserve(candidates.size());
+		for (auto& candidate : candidates) {
+			if (candidate.dstNodeIndex >= nodeQueues.size() || candidate.srcNodeIndex >= candidate.dstNodeIndex ||
+				queueRunStarts[candidate.srcNodeIndex] != queueRunStarts[candidate.dstNodeIndex]) {
+				isSplit.push_back(false);
+				continue;
+			}
+			size_t independentNodeCount =
+				activeNodesBefore[candidate.dstNodeIndex] - activeNodesBefore[candidate.srcNodeIndex + 1];
+			isSplit.push_back(independentNodeCount >= minIndependentNodeCount);
+		}
+		return isSplit;
+	}
+} // namespace vanadium::graphics
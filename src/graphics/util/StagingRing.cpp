@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cassert>
+#include <graphics/util/RangeAllocator.hpp>
+#include <graphics/util/StagingRing.hpp>
+
+namespace vanadium::graphics {
+
+	StagingRing::StagingRing(VkDeviceSize segmentSize) : m_segmentSize(segmentSize) {}
+
+	StagingRingAllocation StagingRing::allocate(VkDeviceSize size, VkDeviceSize alignment) {
+		VkDeviceSize offset;
+		for (uint32_t i = 0; i < m_segments.size(); ++i) {
+			if (tryAllocate(i, size, alignment, offset)) {
+				return { .segmentIndex = i, .offset = offset };
+			}
+		}
+
+		// Spill into a new segment, offset 0 satisfies every alignment
+		Segment newSegment = { .size = std::max(m_segmentSize, size), .lastUsedFrame = m_closedFrameCount };
+		auto releasedSegment =
+			std::find_if(m_segments.begin(), m_segments.end(), [](const auto& segment) { return segment.isReleased; });
+		uint32_t segmentIndex = static_cast<uint32_t>(releasedSegment - m_segments.begin());
+		if (releasedSegment != m_segments.end()) {
+			*releasedSegment = newSegment;
+		} else {
+			m_segments.push_back(newSegment);
+			m_currentFrameUsedSizes.push_back(0);
+		}
+		tryAllocate(segmentIndex, size, alignment, offset);
+		return { .segmentIndex = segmentIndex, .offset = offset };
+	}
+
+	void StagingRing::closeFrame(uint64_t completionValue) {
+		assert(m_pendingFrames.empty() || m_pendingFrames.back().completionValue <= completionValue);
+		PendingFrame frame = { .completionValue = completionValue };
+		++m_closedFrameCount;
+		for (uint32_t i = 0; i < m_segments.size(); ++i) {
+			if (m_currentFrameUsedSizes[i]) {
+				m_segments[i].lastUsedFrame = m_closedFrameCount;
+				frame.segmentUsages.push_back(
+					{ .segmentIndex = i, .usedSize = m_currentFrameUsedSizes[i], .head = m_segments[i].head });
+				m_currentFrameUsedSizes[i] = 0;
+			}
+		}
+		// Frames without allocations have nothing to reclaim
+		if (!frame.segmentUsages.empty()) {
+			m_pendingFrames.push_back(std::move(frame));
+		}
+	}
+
+	void StagingRing::reclaim(uint64_t completedValue) {
+		while (!m_pendingFrames.empty() && m_pendingFrames.front().completionValue <= completedValue) {
+			for (auto& usage : m_pendingFrames.front().segmentUsages) {
+				auto& segment = m_segments[usage.segmentIndex];
+				segment.usedSize -= usage.usedSize;
+				// Frames are reclaimed in allocation order, so everything up to the frame's head is free now
+				segment.tail = usage.head;
+				if (!segment.usedSize) {
+					segment.head = 0;
+					segment.tail = 0;
+				}
+			}
+			m_pendingFrames.pop_front();
+		}
+	}
+
+	std::vector<uint32_t> StagingRing::releaseIdleSegments(uint64_t maxIdleFrames) {
+		auto isKeptRegularSegment = [this](const auto& segment) {
+			return !segment.isReleased && segment.size == m_segmentSize;
+		};
+		size_t keptRegularSegmentCount = std::count_if(m_segments.begin(), m_segments.end(), isKeptRegularSegment);
+
+		std::vector<uint32_t> releasedSegments;
+		for (uint32_t i = 0; i < m_segments.size(); ++i) {
+			auto& segment = m_segments[i];
+			// The allocations of the current frame are part of the used size as well
+			if (segment.isReleased || segment.usedSize) {
+				continue;
+			}
+			bool isOversized = segment.size > m_segmentSize;
+			bool isIdle = m_closedFrameCount - segment.lastUsedFrame >= maxIdleFrames;
+			if (isOversized || (isIdle && keptRegularSegmentCount > 1)) {
+				keptRegularSegmentCount -= !isOversized;
+				segment.isReleased = true;
+				releasedSegments.push_back(i);
+			}
+		}
+		return releasedSegments;
+	}
+
+	bool StagingRing::tryAllocate(uint32_t segmentIndex, VkDeviceSize size, VkDeviceSize alignment,
+								  VkDeviceSize& offset) {
+		auto& segment = m_segments[segmentIndex];
+		// head == tail is ambiguous, it means either an empty or a completely full segment
+		if (segment.isReleased || (segment.usedSize && segment.head == segment.tail)) {
+			return false;
+		}
+
+		VkDeviceSize alignedHead = roundUpAligned(segment.head, alignment);
+		if (segment.head >= segment.tail) {
+			// Free space is [head, size) and [0, tail)
+			if (alignedHead + size <= segment.size) {
+				offset = alignedHead;
+			} else if (size <= segment.tail) {
+				// Wrap around, the space at the end of the segment is wasted until the frame is reclaimed
+				alignedHead = segment.size;
+				offset = 0;
+			} else {
+				return false;
+			}
+		} else if (alignedHead + size <= segment.tail) {
+			offset = alignedHead;
+		} else {
+			return false;
+		}
+
+		VkDeviceSize usedSize = (alignedHead - segment.head) + size;
+		segment.head = offset + size;
+		segment.usedSize += usedSize;
+		m_currentFrameUsedSizes[segmentIndex] += usedSize;
+		return true;
+	}
+} // namespace vanadium::graphics
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <graphics/util/TransferBatching.hpp>
+
+namespace vanadium::graphics {
+
+	namespace {
+		struct CopyPiece {
+			VkBuffer srcBuffer;
+			VkBufferCopy region;
+		};
+
+		struct DstBufferCopies {
+			VkBuffer dstBuffer;
+			std::vector<CopyPiece> pieces;
+			VkPipelineStageFlags usageStageFlags = 0;
+			VkAccessFlags usageAccessFlags = 0;
+		};
+
+		// Removes the part of the destination range of each piece that overlaps with [offset; offset + size).
+		// Pieces that partially overlap are cut, which may split a piece in two.
+		void removeOverlap(std::vector<CopyPiece>& pieces, VkDeviceSize offset, VkDeviceSize size) {
+			VkDeviceSize end = offset + size;
+			std::vector<CopyPiece> remainingPieces;
+			remainingPieces.reserve(pieces.size() + 1);
+			for (auto& piece : pieces) {
+				VkDeviceSize pieceEnd = piece.region.dstOffset + piece.region.size;
+				if (pieceEnd <= offset || end <= piece.region.dstOffset) {
+					remainingPieces.push_back(piece);
+					continue;
+				}
+				if (piece.region.dstOffset < offset) {
+					CopyPiece front = piece;
+					front.region.size = offset - piece.region.dstOffset;
+					remainingPieces.push_back(front);
+				}
+				if (end < pieceEnd) {
+					CopyPiece back = piece;
+					VkDeviceSize cutSize = end - piece.region.dstOffset;
+					back.region.srcOffset += cutSize;
+					back.region.dstOffset += cutSize;
+					back.region.size -= cutSize;
+					remainingPieces.push_back(back);
+				}
+			}
+			pieces = std::move(remainingPieces);
+		}
+	} // namespace
+
+	BufferCopyPlan planBufferCopies(const std::vector<BufferCopyRequest>& requests) {
+		std::vector<DstBufferCopies> dstBufferCopies;
+		for (auto& request : requests) {
+			if (!request.region.size) {
+				continue;
+			}
+			auto dstIterator =
+				std::find_if(dstBufferCopies.begin(), dstBufferCopies.end(),
+							 [&request](const auto& copies) { return copies.dstBuffer == request.dstBuffer; });
+			if (dstIterator == dstBufferCopies.end()) {
+				dstBufferCopies.push_back({ .dstBuffer = request.dstBuffer });
+				dstIterator = dstBufferCopies.end() - 1;
+			}
+			// Copies to the same buffer must not overlap, and later data replaces older data anyway
+			removeOverlap(dstIterator->pieces, request.region.dstOffset, request.region.size);
+			dstIterator->pieces.push_back({ .srcBuffer = request.srcBuffer, .region = request.region });
+			dstIterator->usageStageFlags |= request.dstUsageStageFlags;
+			dstIterator->usageAccessFlags |= request.dstUsageAccessFlags;
+		}
+
+		BufferCopyPlan plan;
+		for (auto& copies : dstBufferCopies) {
+			size_t firstBatchIndex = plan.copies.size();
+			for (auto& piece : copies.pieces) {
+				auto batchIterator =
+					std::find_if(plan.copies.begin() + firstBatchIndex, plan.copies.end(),
+								 [&piece](const auto& batch) { return batch.srcBuffer == piece.srcBuffer; });
+				if (batchIterator == plan.copies.end()) {
+					plan.copies.push_back({ .srcBuffer = piece.srcBuffer, .dstBuffer = copies.dstBuffer });
+					batchIterator = plan.copies.end() - 1;
+				}
+				batchIterator->regions.push_back(piece.region);
+			}
+
+			VkDeviceSize rangeStart = ~0ULL;
+			VkDeviceSize rangeEnd = 0;
+			for (auto batchIterator = plan.copies.begin() + firstBatchIndex; batchIterator != plan.copies.end();
+				 ++batchIterator) {
+				auto& regions = batchIterator->regions;
+				std::sort(regions.begin(), regions.end(),
+						  [](const auto& one, const auto& other) { return one.dstOffset < other.dstOffset; });
+
+				std::vector<VkBufferCopy> mergedRegions = { regions.front() };
+				for (auto regionIterator = regions.begin() + 1; regionIterator != regions.end(); ++regionIterator) {
+					auto& lastRegion = mergedRegions.back();
+					if (lastRegion.srcOffset + lastRegion.size == regionIterator->srcOffset &&
+						lastRegion.dstOffset + lastRegion.size == regionIterator->dstOffset) {
+						lastRegion.size += regionIterator->size;
+					} else {
+						mergedRegions.push_back(*regionIterator);
+					}
+				}
+				regions = std::move(mergedRegions);
+
+				rangeStart = std::min(rangeStart, regions.front().dstOffset);
+				rangeEnd = std::max(rangeEnd, regions.back().dstOffset + regions.back().size);
+			}
+
+			plan.barriers.push_back({ .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+									  .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+									  .dstAccessMask = copies.usageAccessFlags,
+									  .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+									  .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+									  .buffer = copies.dstBuffer,
+									  .offset = rangeStart,
+									  .size = rangeEnd - rangeStart });
+			plan.dstStageFlags |= copies.usageStageFlags;
+		}
+		return plan;
+	}
+
+	void addDirtyRange(std::vector<MemoryRange>& ranges, MemoryRange newRange) {
+		if (!newRange.size) {
+			return;
+		}
+		VkDeviceSize newEnd = newRange.offset + newRange.size;
+		// First range that ends at or after the new range's start, it is the first one that could be merged
+		auto firstIterator = std::lower_bound(ranges.begin(), ranges.end(), newRange.offset,
+											  [](const auto& range, VkDeviceSize offset) {
+												  return range.offset + range.size < offset;
+											  });
+		auto lastIterator = firstIterator;
+		while (lastIterator != ranges.end() && lastIterator->offset <= newEnd) {
+			newRange.offset = std::min(newRange.offset, lastIterator->offset);
+			newEnd = std::max(newEnd, lastIterator->offset + lastIterator->size);
+			++lastIterator;
+		}
+		newRange.size = newEnd - newRange.offset;
+		auto insertIterator = ranges.erase(firstIterator, lastIterator);
+		ranges.insert(insertIterator, newRange);
+	}
+
+	ImageTransferSourceScope imageTransferSourceScope(VkImageLayout srcLayout) {
+		if (srcLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
+			return { .stageFlags = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, .accessFlags = 0 };
+		} else {
+			// The previous users are unknown. Earlier reads only need an execution dependency, writes also need to
+			// be made available before the layout transition.
+			return { .stageFlags = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, .accessFlags = VK_ACCESS_MEMORY_WRITE_BIT };
+		}
+	}
+} // namespace vanadium::graphics
@@ -0,0 +1,15 @@
+#include <graphics/util/TransferQueuePolicy.hpp>
+
+namespace vanadium::graphics {
+
+	TransferQueuePolicy::TransferQueuePolicy(const TransferQueueCapabilities& capabilities,
+											 VkDeviceSize minTransferQueueUploadSize)
+		: m_capabilities(capabilities), m_minTransferQueueUploadSize(minTransferQueueUploadSize) {}
+
+	UploadQueue TransferQueuePolicy::chooseQueue(const UploadDescription& upload) const {
+		if (!canUseTransferQueue() || upload.isReadByFramesInFlight) {
+			return UploadQueue::Graphics;
+		}
+		return upload.size >= m_minTransferQueueUploadSize ? UploadQueue::Transfer : UploadQueue::Graphics;
+	}
+} // namespace vanadium::graphics
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <graphics/util/RangeAllocator.hpp>
+#include <graphics/util/TransientAliasing.hpp>
+#include <numeric>
+
+namespace vanadium::graphics {
+
+	namespace {
+		bool lifetimesOverlap(const TransientResourceRequirements& one, const TransientResourceRequirements& other) {
+			return one.firstNodeIndex <= other.lastNodeIndex && other.firstNodeIndex <= one.lastNodeIndex;
+		}
+	} // namespace
+
+	TransientAliasingPlan planTransientAliasing(const std::vector<TransientResourceRequirements>& resources) {
+		TransientAliasingPlan plan;
+		plan.placements.resize(resources.size());
+
+		std::vector<uint32_t> placementOrder(resources.size());
+		std::iota(placementOrder.begin(), placementOrder.end(), 0U);
+		std::stable_sort(placementOrder.begin(), placementOrder.end(), [&resources](uint32_t one, uint32_t other) {
+			if (resources[one].size != resources[other].size) {
+				return resources[one].size > resources[other].size;
+			}
+			return resources[one].firstNodeIndex < resources[other].firstNodeIndex;
+		});
+
+		// Resources already placed in each block
+		std::vector<std::vector<uint32_t>> blockResources;
+		for (auto resourceIndex : placementOrder) {
+			auto& resource = resources[resourceIndex];
+			plan.unaliasedSize += resource.size;
+
+			bool isPlaced = false;
+			for (uint32_t blockIndex = 0; blockIndex < plan.blocks.size() && !isPlaced; ++blockIndex) {
+				auto& block = plan.blocks[blockIndex];
+				if (!(block.memoryTypeBits & resource.memoryTypeBits)) {
+					continue;
+				}
+
+				std::vector<uint32_t> concurrentResources;
+				for (auto placedIndex : blockResources[blockIndex]) {
+					if (lifetimesOverlap(resources[placedIndex], resource)) {
+						concurrentResources.push_back(placedIndex);
+					}
+				}
+				std::sort(concurrentResources.begin(), concurrentResources.end(),
+						  [&plan](uint32_t one, uint32_t other) {
+							  return plan.placements[one].offset < plan.placements[other].offset;
+						  });
+
+				// Lowest gap between resources in use at the same time that the resource fits in
+				VkDeviceSize offset = 0;
+				for (auto concurrentIndex : concurrentResources) {
+					VkDeviceSize concurrentOffset = plan.placements[concurrentIndex].offset;
+					if (offset + resource.size <= concurrentOffset) {
+						break;
+					}
+					offset = std::max(offset, roundUpAligned(concurrentOffset + resources[concurrentIndex].size,
+															 resource.alignment));
+				}
+				if (offset + resource.size <= block.size) {
+					plan.placements[resourceIndex] = { .blockIndex = blockIndex, .offset = offset };
+					block.memoryTypeBits &= resource.memoryTypeBits;
+					blockResources[blockIndex].push_back(resourceIndex);
+					isPlaced = true;
+				}
+			}
+
+			if (!isPlaced) {
+				plan.placements[resourceIndex] = { .blockIndex = static_cast<uint32_t>(plan.blocks.size()),
+												   .offset = 0 };
+				plan.blocks.push_back({ .size = resource.size, .memoryTypeBits = resource.memoryTypeBits });
+				blockResources.push_back({ resourceIndex });
+				plan.aliasedSize += resource.size;
+			}
+		}
+
+		for (auto& resourceIndices : blockResources) {
+			std::sort(resourceIndices.begin(), resourceIndices.end());
+			for (size_t i = 0; i < resourceIndices.size(); ++i) {
+				for (size_t j = i + 1; j < resourceIndices.size(); ++j) {
+					uint32_t one = resourceIndices[i];
+					uint32_t other = resourceIndices[j];
+					auto& onePlacement = plan.placements[one];
+					auto& otherPlacement = plan.placements[other];
+					bool memoryOverlaps = onePlacement.offset < otherPlacement.offset + resources[other].size &&
+										  otherPlacement.offset < onePlacement.offset + resources[one].size;
+					if (!memoryOverlaps) {
+						continue;
+					}
+					if (resources[one].lastNodeIndex < resources[other].firstNodeIndex) {
+						plan.aliases.push_back({ .previous = one, .next = other });
+					} else {
+						plan.aliases.push_back({ .previous = other, .next = one });
+					}
+				}
+			}
+		}
+		return plan;
+	}
+} // namespace vanadium::graphics
@@ -146,6 +146,7 @@ namespace vanadium::ui {
 		for (auto& framebuffer : m_imageFramebuffers) {
 			vkDestroyFramebuffer(m_renderContext.deviceContext->device(), framebuffer, nullptr);
 		}
+		m_renderContext.pipelineLibrary->removePass(m_uiRenderPass);
 		vkDestroyRenderPass(m_renderContext.deviceContext->device(), m_uiRenderPass, nullptr);
 	}
 } // namespace vanadium::ui
@@ -458,7 +458,7 @@ namespace vanadium::ui::shapes {
 
 			m_fontAtlases[identifier].glyphData.reserve(m_fontAtlases[identifier].transferBufferCapacity);
 
-			m_fontAtlases[identifier].glyphDataTransfer = m_renderContext.transferManager->createTransfer(
+			m_fontAtlases[identifier].glyphDataTransfer = m_renderContext.transferManager->createSubAllocatedTransfer(
 				m_fontAtlases[identifier].transferBufferCapacity,
 				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
 				VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
@@ -471,10 +471,11 @@ namespace vanadium::ui::shapes {
 		if (m_fontAtlases[identifier].glyphData.empty())
 			return;
 
+		auto glyphDataBuffer =
+			m_renderContext.transferManager->dstBufferHandle(m_fontAtlases[identifier].glyphDataTransfer);
 		VkDescriptorBufferInfo bufferInfo = {
-			.buffer = m_renderContext.resourceAllocator->nativeBufferHandle(
-				m_renderContext.transferManager->dstBufferHandle(m_fontAtlases[identifier].glyphDataTransfer)),
-			.offset = 0,
+			.buffer = m_renderContext.resourceAllocator->nativeBufferHandle(glyphDataBuffer),
+			.offset = m_renderContext.resourceAllocator->bufferOffset(glyphDataBuffer),
 			.range = m_fontAtlases[identifier].glyphData.size() * sizeof(RenderedGlyphData)
 		};
 		VkDescriptorImageInfo imageInfo = { .imageView = m_renderContext.resourceAllocator->requestImageView(
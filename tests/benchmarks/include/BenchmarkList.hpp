@@ -0,0 +1,23 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+
+using BenchmarkFunction = void (*)();
+
+struct BenchmarkEntry {
+	std::string_view name;
+	BenchmarkFunction function;
+};
+
+void benchmarkSlotmap();
+void benchmarkRangeAllocator();
+void benchmarkHandleContention();
+void benchmarkVCPLoad();
+
+static constexpr std::array<BenchmarkEntry, 4> benchmarkFunctions = {
+	BenchmarkEntry{ "Slotmap", benchmarkSlotmap },
+	BenchmarkEntry{ "RangeAllocator", benchmarkRangeAllocator },
+	BenchmarkEntry{ "HandleContention", benchmarkHandleContention },
+	BenchmarkEntry{ "VCPLoad", benchmarkVCPLoad }
+};
@@ -0,0 +1,110 @@
+#include <BenchmarkList.hpp>
+#include <BenchmarkUtilCommon.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <util/ConcurrentSlotmap.hpp>
+#include <util/SharedLockGuard.hpp>
+#include <util/Slotmap.hpp>
+#include <vector>
+
+// Mimics the handle resolution and creation paths of GPUResourceAllocator with a mock device: resolving a handle
+// returns a fake native handle, creating and destroying only touches the handle storage. Recording threads resolve
+// many handles per created/destroyed resource, like command recording and streaming do.
+namespace {
+	constexpr size_t initialResourceCount = 4096;
+	constexpr size_t operationsPerThread = 1 << 18;
+	// One create/destroy pair per this many resolves
+	constexpr size_t resolvesPerCreation = 64;
+	constexpr size_t runCount = 4;
+
+	struct MockAllocation {
+		uint64_t nativeHandles[3];
+		void* mappedData[3];
+	};
+
+	// The previous scheme: every lookup takes the shared lock, every creation/destruction the exclusive lock
+	class SharedMutexAllocator {
+	  public:
+		vanadium::SlotmapHandle create(uint64_t nativeHandle) {
+			auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+			return m_allocations.addElement({ { nativeHandle, nativeHandle, nativeHandle } });
+		}
+		void destroy(vanadium::SlotmapHandle handle) {
+			auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+			m_allocations.removeElement(handle);
+		}
+		uint64_t resolve(vanadium::SlotmapHandle handle) {
+			auto lock = vanadium::SharedLockGuard(m_accessMutex);
+			return m_allocations[handle].nativeHandles[1];
+		}
+
+	  private:
+		vanadium::Slotmap<MockAllocation> m_allocations;
+		std::shared_mutex m_accessMutex;
+	};
+
+	// Wait-free lookups, only modifications are serialized
+	class ConcurrentAllocator {
+	  public:
+		vanadium::SlotmapHandle create(uint64_t nativeHandle) {
+			auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+			return m_allocations.addElement({ { nativeHandle, nativeHandle, nativeHandle } });
+		}
+		void destroy(vanadium::SlotmapHandle handle) {
+			auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+			m_allocations.removeElement(handle);
+		}
+		uint64_t resolve(vanadium::SlotmapHandle handle) { return m_allocations[handle].nativeHandles[1]; }
+
+	  private:
+		vanadium::ConcurrentSlotmap<MockAllocation> m_allocations;
+		std::shared_mutex m_accessMutex;
+	};
+
+	template <typename Allocator> double contention(size_t threadCount) {
+		return measureAverageMicroseconds(runCount, [threadCount]() {
+			Allocator allocator;
+			// shared resources are only resolved, each thread creates and destroys its own resources
+			std::vector<vanadium::SlotmapHandle> sharedHandles;
+			for (size_t i = 0; i < initialResourceCount; ++i) {
+				sharedHandles.push_back(allocator.create(i));
+			}
+
+			std::vector<std::thread> threads;
+			for (size_t threadIndex = 0; threadIndex < threadCount; ++threadIndex) {
+				threads.emplace_back([&allocator, &sharedHandles, threadIndex]() {
+					uint64_t sum = 0;
+					std::vector<vanadium::SlotmapHandle> ownHandles;
+					for (size_t i = 0; i < operationsPerThread; ++i) {
+						sum += allocator.resolve(sharedHandles[(i * 7 + threadIndex) % sharedHandles.size()]);
+						if (i % resolvesPerCreation == 0) {
+							ownHandles.push_back(allocator.create(i));
+							if (ownHandles.size() > 16) {
+								allocator.destroy(ownHandles.front());
+								ownHandles.erase(ownHandles.begin());
+							}
+						}
+					}
+					for (auto handle : ownHandles) {
+						allocator.destroy(handle);
+					}
+					doNotOptimize(sum);
+				});
+			}
+			for (auto& thread : threads) {
+				thread.join();
+			}
+		});
+	}
+} // namespace
+
+void benchmarkHandleContention() {
+	size_t maxThreadCount = std::max(4U, std::thread::hardware_concurrency());
+	for (size_t threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2) {
+		reportBenchmarkComparison(std::to_string(threadCount) + " threads",
+								  contention<SharedMutexAllocator>(threadCount),
+								  contention<ConcurrentAllocator>(threadCount));
+	}
+}
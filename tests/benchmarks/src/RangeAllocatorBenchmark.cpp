@@ -0,0 +1,71 @@
+#include <BenchmarkList.hpp>
+#include <BenchmarkUtilCommon.hpp>
+#include <LegacyRangeAllocator.hpp>
+#include <graphics/util/RangeAllocator.hpp>
+#include <random>
+
+using namespace vanadium::graphics;
+
+namespace {
+	// Fragments the block into more than 10k free ranges before measuring.
+	constexpr size_t initialAllocationCount = 24576;
+	constexpr VkDeviceSize blockSize = 1024 * 1024 * 1024;
+	constexpr VkDeviceSize alignment = 256;
+	// The legacy functions re-sort the range lists on every operation, so fewer operations are measured there.
+	constexpr size_t operationCount = 16384;
+	constexpr size_t legacyOperationCount = 256;
+
+	struct LegacyRanges {
+		std::vector<MemoryRange> offsetSorted;
+		std::vector<MemoryRange> sizeSorted;
+
+		std::optional<RangeAllocationResult> allocate(VkDeviceSize alignment, VkDeviceSize size) {
+			return legacy::allocateFromRanges(offsetSorted, sizeSorted, alignment, size);
+		}
+		void free(VkDeviceSize offset, VkDeviceSize size) {
+			legacy::freeToRanges(offsetSorted, sizeSorted, offset, size);
+		}
+		size_t freeRangeCount() const { return offsetSorted.size(); }
+	};
+
+	// Measures the average time of freeing a random live allocation and allocating a new one of random size.
+	template <typename Allocator> double churn(Allocator& allocator, size_t count) {
+		std::mt19937 generator(42);
+		std::uniform_int_distribution<VkDeviceSize> sizeDistribution(64, 16384);
+
+		std::vector<RangeAllocationResult> allocations;
+		for (size_t i = 0; i < initialAllocationCount; ++i) {
+			allocations.push_back(allocator.allocate(alignment, sizeDistribution(generator)).value());
+		}
+		// Freeing every other allocation leaves free ranges that can't be merged
+		std::vector<RangeAllocationResult> liveAllocations;
+		for (size_t i = 0; i < allocations.size(); ++i) {
+			if (i % 2) {
+				liveAllocations.push_back(allocations[i]);
+			} else {
+				allocator.free(allocations[i].allocationRange.offset, allocations[i].allocationRange.size);
+			}
+		}
+		allocations = std::move(liveAllocations);
+		std::cout << "Free ranges before churn: " << allocator.freeRangeCount() << "\n";
+
+		std::uniform_int_distribution<size_t> indexDistribution(0, allocations.size() - 1);
+		double result = measureAverageMicroseconds(count, [&]() {
+			size_t index = indexDistribution(generator);
+			allocator.free(allocations[index].allocationRange.offset, allocations[index].allocationRange.size);
+			allocations[index] = allocator.allocate(alignment, sizeDistribution(generator)).value();
+		});
+		std::cout << "Free ranges after churn: " << allocator.freeRangeCount() << "\n";
+		return result;
+	}
+} // namespace
+
+void benchmarkRangeAllocator() {
+	LegacyRanges legacyRanges = { .offsetSorted = { { .offset = 0, .size = blockSize } },
+								  .sizeSorted = { { .offset = 0, .size = blockSize } } };
+	RangeAllocator allocator = RangeAllocator(0, blockSize);
+
+	double legacyTime = churn(legacyRanges, legacyOperationCount);
+	double time = churn(allocator, operationCount);
+	reportBenchmarkComparison("Free + allocate", legacyTime, time);
+}
@@ -0,0 +1,80 @@
+#include <BenchmarkList.hpp>
+#include <BenchmarkUtilCommon.hpp>
+#include <LegacySlotmap.hpp>
+#include <random>
+#include <util/Slotmap.hpp>
+
+namespace {
+	constexpr size_t elementCount = 16384;
+	constexpr size_t runCount = 64;
+
+	struct Payload {
+		uint64_t data[4];
+	};
+
+	template <typename SlotmapType, typename HandleType> double insertEraseAll() {
+		return measureAverageMicroseconds(runCount, []() {
+			SlotmapType slotmap;
+			std::vector<HandleType> handles;
+			handles.reserve(elementCount);
+			for (size_t i = 0; i < elementCount; ++i) {
+				handles.push_back(slotmap.addElement(Payload{ { i } }));
+			}
+			for (auto handle : handles) {
+				slotmap.removeElement(handle);
+			}
+			doNotOptimize(slotmap);
+		});
+	}
+
+	// Simulates transient per-frame allocations: a steady population where random elements are replaced.
+	template <typename SlotmapType, typename HandleType> double churn() {
+		SlotmapType slotmap;
+		std::vector<HandleType> handles;
+		for (size_t i = 0; i < elementCount; ++i) {
+			handles.push_back(slotmap.addElement(Payload{ { i } }));
+		}
+		std::mt19937 generator(1337);
+		std::uniform_int_distribution<size_t> distribution(0, elementCount - 1);
+		return measureAverageMicroseconds(runCount, [&]() {
+			for (size_t i = 0; i < elementCount; ++i) {
+				size_t index = distribution(generator);
+				slotmap.removeElement(handles[index]);
+				handles[index] = slotmap.addElement(Payload{ { i } });
+			}
+		});
+	}
+
+	template <typename SlotmapType, typename HandleType> double lookupIterate() {
+		SlotmapType slotmap;
+		std::vector<HandleType> handles;
+		for (size_t i = 0; i < elementCount; ++i) {
+			handles.push_back(slotmap.addElement(Payload{ { i } }));
+		}
+		for (size_t i = 0; i < elementCount; i += 3) {
+			slotmap.removeElement(handles[i]);
+		}
+		return measureAverageMicroseconds(runCount, [&]() {
+			uint64_t sum = 0;
+			for (size_t i = 1; i < elementCount; i += 3) {
+				sum += slotmap[handles[i]].data[0];
+			}
+			for (auto& element : slotmap) {
+				sum += element.data[0];
+			}
+			doNotOptimize(sum);
+		});
+	}
+} // namespace
+
+void benchmarkSlotmap() {
+	using NewSlotmap = vanadium::Slotmap<Payload>;
+	using LegacySlotmap = vanadium::legacy::Slotmap<Payload>;
+
+	reportBenchmarkComparison("Insert/erase all", insertEraseAll<LegacySlotmap, vanadium::legacy::SlotmapHandle>(),
+							  insertEraseAll<NewSlotmap, vanadium::SlotmapHandle>());
+	reportBenchmarkComparison("Random churn", churn<LegacySlotmap, vanadium::legacy::SlotmapHandle>(),
+							  churn<NewSlotmap, vanadium::SlotmapHandle>());
+	reportBenchmarkComparison("Lookup/iterate", lookupIterate<LegacySlotmap, vanadium::legacy::SlotmapHandle>(),
+							  lookupIterate<NewSlotmap, vanadium::SlotmapHandle>());
+}
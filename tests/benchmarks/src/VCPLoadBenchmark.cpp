@@ -0,0 +1,186 @@
+#include <BenchmarkList.hpp>
+#include <BenchmarkUtilCommon.hpp>
+#include <Log.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <util/MappedFile.hpp>
+#include <vector>
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+
+#include <VCPFormat.hpp>
+
+// Loads a generated pipeline library the way PipelineLibrary::create did for the stream format, by deserializing
+// every record, and the way it does now, by mapping the file and validating the table of contents. Both loads look
+// up every instance by name afterwards.
+namespace {
+	constexpr size_t archetypeCount = 64;
+	constexpr size_t instancesPerArchetype = 16;
+	constexpr size_t shaderCodeSize = 16384;
+	constexpr size_t runCount = 16;
+
+	struct LegacyArchetype {
+		PipelineType type;
+		std::vector<CompiledShader> shaders;
+		std::vector<uint32_t> setLayoutIndices;
+		std::vector<VkPushConstantRange> pushConstantRanges;
+	};
+
+	struct LegacyLibrary {
+		std::vector<std::vector<DescriptorBindingLayoutInfo>> setLayouts;
+		std::vector<LegacyArchetype> archetypes;
+		std::vector<PipelineInstanceData> instances;
+	};
+
+	std::string instanceName(size_t archetypeID, size_t instanceID) {
+		return "Archetype" + std::to_string(archetypeID) + "/Variant" + std::to_string(instanceID);
+	}
+
+	PipelineInstanceData generateInstance(size_t archetypeID, size_t instanceID) {
+		PipelineInstanceData data = {};
+		data.name = instanceName(archetypeID, instanceID);
+		data.instanceVertexInputConfig.attributes = { { .location = 0, .binding = 0, .offset = 0 },
+													  { .location = 1, .binding = 0, .offset = 12 } };
+		data.instanceVertexInputConfig.bindings = { { .binding = 0, .stride = 24 } };
+		data.instanceDynamicStateConfig.dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+		data.instanceColorAttachmentBlendConfigs.resize(1);
+		data.instanceRasterizationConfig.lineWidth = 1.0f;
+
+		PipelineInstanceStageSpecializationConfig specialization = { .stage = VK_SHADER_STAGE_FRAGMENT_BIT };
+		PipelineInstanceSpecializationConfig config = { .mapEntry = { .constantID = 0, .offset = 0, .size = 4 },
+														.type = SpecializationDataType::UInt32 };
+		config.dataUint32 = static_cast<uint32_t>(instanceID);
+		specialization.configs.push_back(config);
+		data.instanceSpecializationConfigs.push_back(specialization);
+		return data;
+	}
+
+	void writeLibraries(const std::string& legacyFileName, const std::string& fileName) {
+		std::vector<std::vector<DescriptorBindingLayoutInfo>> setLayouts = {
+			{ { .binding = { .binding = 0,
+							 .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+							 .descriptorCount = 1,
+							 .stageFlags = VK_SHADER_STAGE_VERTEX_BIT },
+				.usesImmutableSamplers = false } }
+		};
+		std::vector<char> vertexCode(shaderCodeSize, 'v');
+		std::vector<char> fragmentCode(shaderCodeSize, 'f');
+		std::vector<CompiledShader> shaders = {
+			{ .stage = VK_SHADER_STAGE_VERTEX_BIT, .dataSize = vertexCode.size(), .data = vertexCode.data() },
+			{ .stage = VK_SHADER_STAGE_FRAGMENT_BIT, .dataSize = fragmentCode.size(), .data = fragmentCode.data() }
+		};
+		std::vector<uint32_t> setLayoutIndices = { 0 };
+		std::vector<VkPushConstantRange> pushConstantRanges = {
+			{ .stageFlags = VK_SHADER_STAGE_VERTEX_BIT, .offset = 0, .size = 64 }
+		};
+
+		auto legacyStream = std::ofstream(legacyFileName, std::ios::binary | std::ios::trunc);
+		serialize(VCPFileHeader{ .version = vcpLegacyStreamFileVersion }, legacyStream);
+		serializeVector(setLayouts, legacyStream);
+
+		VCPLibraryWriter writer;
+		writer.addSetLayout(setLayouts[0]);
+		for (size_t archetypeID = 0; archetypeID < archetypeCount; ++archetypeID) {
+			std::vector<PipelineInstanceData> instances;
+			for (size_t instanceID = 0; instanceID < instancesPerArchetype; ++instanceID) {
+				instances.push_back(generateInstance(archetypeID, instanceID));
+			}
+
+			serialize(PipelineType::Graphics, legacyStream);
+			serializeVector(shaders, legacyStream);
+			serializeVector(setLayoutIndices, legacyStream);
+			serializeVector(pushConstantRanges, legacyStream);
+			serializeVector(instances, legacyStream);
+
+			writer.addArchetype(PipelineType::Graphics, shaders, setLayoutIndices, pushConstantRanges);
+			for (auto& instance : instances) {
+				writer.addInstance(instance);
+			}
+		}
+
+		auto fileData = writer.finish();
+		auto outStream = std::ofstream(fileName, std::ios::binary | std::ios::trunc);
+		outStream.write(fileData.data(), static_cast<std::streamsize>(fileData.size()));
+	}
+
+	size_t loadLegacyLibrary(const std::string& fileName, const std::vector<std::string>& names) {
+		LegacyLibrary library;
+		auto inStream = std::ifstream(fileName, std::ios::binary);
+		inStream.ignore(sizeof(VCPFileHeader));
+		library.setLayouts = deserializeVector<std::vector<DescriptorBindingLayoutInfo>>(inStream);
+		while (true) {
+			PipelineType type = deserialize<PipelineType>(inStream);
+			if (inStream.eof()) {
+				break;
+			}
+			library.archetypes.push_back({ .type = type,
+										   .shaders = deserializeVector<CompiledShader>(inStream),
+										   .setLayoutIndices = deserializeVector<uint32_t>(inStream),
+										   .pushConstantRanges = deserializeVector<VkPushConstantRange>(inStream) });
+			auto instances = deserializeVector<PipelineInstanceData>(inStream);
+			std::move(instances.begin(), instances.end(), std::back_inserter(library.instances));
+		}
+
+		size_t foundCount = 0;
+		for (auto& name : names) {
+			auto iterator = std::find_if(library.instances.begin(), library.instances.end(),
+										 [&name](const auto& instance) { return instance.name == name; });
+			foundCount += iterator != library.instances.end();
+		}
+
+		for (auto& archetype : library.archetypes) {
+			for (auto& shader : archetype.shaders) {
+				delete[] static_cast<char*>(shader.data);
+			}
+		}
+		return foundCount;
+	}
+
+	size_t loadMappedLibrary(const std::string& fileName, const std::vector<std::string>& names) {
+		vanadium::MappedFile file;
+		VCPLibraryView view;
+		if (!file.open(fileName.c_str()) || !view.open(file.data(), file.size())) {
+			return 0;
+		}
+
+		size_t foundCount = 0;
+		for (auto& name : names) {
+			foundCount += view.findGraphicsInstance(name) != ~0U;
+		}
+		return foundCount;
+	}
+} // namespace
+
+void benchmarkVCPLoad() {
+	auto directory = std::filesystem::temp_directory_path() / "vanadium-vcp-benchmark";
+	std::filesystem::create_directories(directory);
+	std::string legacyFileName = (directory / "legacy.vcp").string();
+	std::string fileName = (directory / "library.vcp").string();
+	writeLibraries(legacyFileName, fileName);
+
+	std::vector<std::string> names;
+	for (size_t archetypeID = 0; archetypeID < archetypeCount; ++archetypeID) {
+		for (size_t instanceID = 0; instanceID < instancesPerArchetype; ++instanceID) {
+			names.push_back(instanceName(archetypeID, instanceID));
+		}
+	}
+
+	size_t legacyFoundCount = 0;
+	double legacyMicroseconds = measureAverageMicroseconds(
+		runCount, [&]() { legacyFoundCount = loadLegacyLibrary(legacyFileName, names); });
+	size_t foundCount = 0;
+	double mappedMicroseconds =
+		measureAverageMicroseconds(runCount, [&]() { foundCount = loadMappedLibrary(fileName, names); });
+	size_t totalFoundCount = legacyFoundCount + foundCount;
+	doNotOptimize(totalFoundCount);
+
+	reportBenchmarkComparison(std::to_string(names.size()) + " instances, stream parse -> mapped view",
+							  legacyMicroseconds, mappedMicroseconds);
+	std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,20 @@
+#include <BenchmarkList.hpp>
+#include <iostream>
+
+int main(int argc, char** argv) {
+	if (argc == 1) {
+		for (auto& benchmark : benchmarkFunctions) {
+			std::cout << "Running benchmark " << benchmark.name << "...\n";
+			benchmark.function();
+		}
+		return 0;
+	}
+	for (auto& benchmark : benchmarkFunctions) {
+		if (argv[1] == benchmark.name) {
+			benchmark.function();
+			return 0;
+		}
+	}
+	std::cerr << "Benchmark not found.\n";
+	return EXIT_FAILURE;
+}
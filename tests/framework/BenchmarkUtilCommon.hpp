@@ -0,0 +1,30 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <string_view>
+
+// Runs the function the specified number of times and returns the average duration of one run in microseconds.
+template <typename F> double measureAverageMicroseconds(size_t runCount, F&& function) {
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < runCount; ++i) {
+		function();
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::micro>(end - start).count() / static_cast<double>(runCount);
+}
+
+inline void reportBenchmarkResult(const std::string_view& name, double microseconds) {
+	std::cout << name << ": " << microseconds << " us\n";
+}
+
+inline void reportBenchmarkComparison(const std::string_view& name, double baselineMicroseconds,
+									  double microseconds) {
+	std::cout << name << ": " << baselineMicroseconds << " us -> " << microseconds << " us ("
+			  << baselineMicroseconds / microseconds << "x)\n";
+}
+
+inline const void* volatile benchmarkSink;
+
+// Prevents the compiler from optimizing away computations whose results are otherwise unused.
+template <typename T> void doNotOptimize(const T& value) { benchmarkSink = &value; }
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+
+using TestFunction = void (*)();
+
+struct FunctionEntry {
+	std::string_view name;
+	TestFunction function;
+};
+
+void testRangeAllocatorBestFit();
+void testRangeAllocatorCoalescing();
+void testRangeAllocatorAlignment();
+void testRangeAllocatorFuzz();
+void testDefragmentationPlannerEmptiesBlocks();
+void testDefragmentationPlannerBudget();
+void testDefragmentationPlannerUnmovable();
+void testDefragmentationPlannerAlignment();
+void testDefragmentationPlannerPartialBlock();
+void testAllocatorStatisticsBlock();
+void testAllocatorStatisticsAccumulation();
+void testAllocatorStatisticsJSON();
+void testBufferSubAllocationAlignment();
+void testBufferSubAllocationPoolOffsets();
+void testAllocationPlacementDedicated();
+void testAllocationPlacementPriority();
+void testStagingRingReclaim();
+void testStagingRingOverflow();
+void testStagingRingWrapAround();
+void testStagingRingRelease();
+void testTransferBatchingCoalescing();
+void testTransferBatchingOverlap();
+void testTransferBatchingDirtyRanges();
+void testTransferQueuePolicyThreshold();
+void testTransferQueuePolicyAvailability();
+void testTransientAliasingPostProcessChain();
+void testTransientAliasingPacking();
+void testTransientAliasingMemoryTypes();
+void testRecordingSegmentsOrder();
+void testRecordingSegmentsEmpty();
+void testNodeCullingUnusedBranch();
+void testNodeCullingRoots();
+void testNodeCullingFeedback();
+void testQueueSchedulingBatches();
+void testQueueSchedulingDependencies();
+void testQueueSchedulingOwnershipAcrossFrames();
+void testPipelineBarrierBatchLegacy();
+void testPipelineBarrierBatchSynchronization2();
+void testCompilationCacheHits();
+void testCompilationCacheInvalidation();
+void testFramegraphResizeCacheHit();
+void testFramegraphResizeInvalidation();
+void testSplitBarriersDistance();
+void testSplitBarriersQueues();
+void testRenderPassMergingDeferred();
+void testRenderPassMergingBlockers();
+void testRenderPassMergingPreserve();
+void testPipelineCacheRoundTrip();
+void testPipelineCacheInvalidation();
+void testLazyCreationStates();
+void testLazyCreationConcurrent();
+void testPipelineUsageLogRoundTrip();
+void testPipelineUsageLogMalformed();
+void testVCPLibraryRoundTrip();
+void testVCPLibraryNameLookup();
+void testVCPLibraryInvalidRanges();
+void testVCPLibraryLegacyConversion();
+void testShaderCacheReuse();
+void testShaderCacheInvalidation();
+void testShaderCacheFailures();
+void testVCPLibrarySharedShaderCode();
+void testSpirvStripDebugInfo();
+void testSpirvFreezeSpecConstants();
+void testSpirvOptimizeInvalidModules();
+void testSharedObjectTableReferences();
+void testPipelineObjectKeys();
+void testPipelineObjectSharingCounts();
+
+static constexpr std::array<FunctionEntry, 67> testFunctions = {
+	FunctionEntry{ "RangeAllocatorBestFit", testRangeAllocatorBestFit },
+	FunctionEntry{ "RangeAllocatorCoalescing", testRangeAllocatorCoalescing },
+	FunctionEntry{ "RangeAllocatorAlignment", testRangeAllocatorAlignment },
+	FunctionEntry{ "RangeAllocatorFuzz", testRangeAllocatorFuzz },
+	FunctionEntry{ "DefragmentationPlannerEmptiesBlocks", testDefragmentationPlannerEmptiesBlocks },
+	FunctionEntry{ "DefragmentationPlannerBudget", testDefragmentationPlannerBudget },
+	FunctionEntry{ "DefragmentationPlannerUnmovable", testDefragmentationPlannerUnmovable },
+	FunctionEntry{ "DefragmentationPlannerAlignment", testDefragmentationPlannerAlignment },
+	FunctionEntry{ "DefragmentationPlannerPartialBlock", testDefragmentationPlannerPartialBlock },
+	FunctionEntry{ "AllocatorStatisticsBlock", testAllocatorStatisticsBlock },
+	FunctionEntry{ "AllocatorStatisticsAccumulation", testAllocatorStatisticsAccumulation },
+	FunctionEntry{ "AllocatorStatisticsJSON", testAllocatorStatisticsJSON },
+	FunctionEntry{ "BufferSubAllocationAlignment", testBufferSubAllocationAlignment },
+	FunctionEntry{ "BufferSubAllocationPoolOffsets", testBufferSubAllocationPoolOffsets },
+	FunctionEntry{ "AllocationPlacementDedicated", testAllocationPlacementDedicated },
+	FunctionEntry{ "AllocationPlacementPriority", testAllocationPlacementPriority },
+	FunctionEntry{ "StagingRingReclaim", testStagingRingReclaim },
+	FunctionEntry{ "StagingRingOverflow", testStagingRingOverflow },
+	FunctionEntry{ "StagingRingWrapAround", testStagingRingWrapAround },
+	FunctionEntry{ "StagingRingRelease", testStagingRingRelease },
+	FunctionEntry{ "TransferBatchingCoalescing", testTransferBatchingCoalescing },
+	FunctionEntry{ "TransferBatchingOverlap", testTransferBatchingOverlap },
+	FunctionEntry{ "TransferBatchingDirtyRanges", testTransferBatchingDirtyRanges },
+	FunctionEntry{ "TransferQueuePolicyThreshold", testTransferQueuePolicyThreshold },
+	FunctionEntry{ "TransferQueuePolicyAvailability", testTransferQueuePolicyAvailability },
+	FunctionEntry{ "TransientAliasingPostProcessChain", testTransientAliasingPostProcessChain },
+	FunctionEntry{ "TransientAliasingPacking", testTransientAliasingPacking },
+	FunctionEntry{ "TransientAliasingMemoryTypes", testTransientAliasingMemoryTypes },
+	FunctionEntry{ "RecordingSegmentsOrder", testRecordingSegmentsOrder },
+	FunctionEntry{ "RecordingSegmentsEmpty", testRecordingSegmentsEmpty },
+	FunctionEntry{ "NodeCullingUnusedBranch", testNodeCullingUnusedBranch },
+	FunctionEntry{ "NodeCullingRoots", testNodeCullingRoots },
+	FunctionEntry{ "NodeCullingFeedback", testNodeCullingFeedback },
+	FunctionEntry{ "QueueSchedulingBatches", testQueueSchedulingBatches },
+	FunctionEntry{ "QueueSchedulingDependencies", testQueueSchedulingDependencies },
+	FunctionEntry{ "QueueSchedulingOwnershipAcrossFrames", testQueueSchedulingOwnershipAcrossFrames },
+	FunctionEntry{ "PipelineBarrierBatchLegacy", testPipelineBarrierBatchLegacy },
+	FunctionEntry{ "PipelineBarrierBatchSynchronization2", testPipelineBarrierBatchSynchronization2 },
+	FunctionEntry{ "CompilationCacheHits", testCompilationCacheHits },
+	FunctionEntry{ "CompilationCacheInvalidation", testCompilationCacheInvalidation },
+	FunctionEntry{ "FramegraphResizeCacheHit", testFramegraphResizeCacheHit },
+	FunctionEntry{ "FramegraphResizeInvalidation", testFramegraphResizeInvalidation },
+	FunctionEntry{ "SplitBarriersDistance", testSplitBarriersDistance },
+	FunctionEntry{ "SplitBarriersQueues", testSplitBarriersQueues },
+	FunctionEntry{ "RenderPassMergingDeferred", testRenderPassMergingDeferred },
+	FunctionEntry{ "RenderPassMergingBlockers", testRenderPassMergingBlockers },
+	FunctionEntry{ "RenderPassMergingPreserve", testRenderPassMergingPreserve },
+	FunctionEntry{ "PipelineCacheRoundTrip", testPipelineCacheRoundTrip },
+	FunctionEntry{ "PipelineCacheInvalidation", testPipelineCacheInvalidation },
+	FunctionEntry{ "LazyCreationStates", testLazyCreationStates },
+	FunctionEntry{ "LazyCreationConcurrent", testLazyCreationConcurrent },
+	FunctionEntry{ "PipelineUsageLogRoundTrip", testPipelineUsageLogRoundTrip },
+	FunctionEntry{ "PipelineUsageLogMalformed", testPipelineUsageLogMalformed },
+	FunctionEntry{ "VCPLibraryRoundTrip", testVCPLibraryRoundTrip },
+	FunctionEntry{ "VCPLibraryNameLookup", testVCPLibraryNameLookup },
+	FunctionEntry{ "VCPLibraryInvalidRanges", testVCPLibraryInvalidRanges },
+	FunctionEntry{ "VCPLibraryLegacyConversion", testVCPLibraryLegacyConversion },
+	FunctionEntry{ "ShaderCacheReuse", testShaderCacheReuse },
+	FunctionEntry{ "ShaderCacheInvalidation", testShaderCacheInvalidation },
+	FunctionEntry{ "ShaderCacheFailures", testShaderCacheFailures },
+	FunctionEntry{ "VCPLibrarySharedShaderCode", testVCPLibrarySharedShaderCode },
+	FunctionEntry{ "SpirvStripDebugInfo", testSpirvStripDebugInfo },
+	FunctionEntry{ "SpirvFreezeSpecConstants", testSpirvFreezeSpecConstants },
+	FunctionEntry{ "SpirvOptimizeInvalidModules", testSpirvOptimizeInvalidModules },
+	FunctionEntry{ "SharedObjectTableReferences", testSharedObjectTableReferences },
+	FunctionEntry{ "PipelineObjectKeys", testPipelineObjectKeys },
+	FunctionEntry{ "PipelineObjectSharingCounts", testPipelineObjectSharingCounts }
+};
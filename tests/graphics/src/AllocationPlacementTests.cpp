@@ -0,0 +1,38 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <cmath>
+#include <graphics/util/AllocationPlacement.hpp>
+
+using namespace vanadium::graphics;
+
+void testAllocationPlacementDedicated() {
+	constexpr VkDeviceSize blockSize = 32 * 1024 * 1024;
+
+	testEqual(false, shouldUseDedicatedAllocation({ .size = 4096 }, blockSize),
+			  "Small resource got a dedicated allocation!");
+	testEqual(false, shouldUseDedicatedAllocation({ .size = blockSize / 2 }, blockSize),
+			  "Resource of half the block size got a dedicated allocation!");
+	testEqual(true, shouldUseDedicatedAllocation({ .size = blockSize / 2 + 1 }, blockSize),
+			  "Resource larger than half a block didn't get a dedicated allocation!");
+	testEqual(true, shouldUseDedicatedAllocation({ .size = 3 * blockSize }, blockSize),
+			  "Resource larger than a block didn't get a dedicated allocation!");
+	testEqual(true, shouldUseDedicatedAllocation({ .size = 4096, .prefersDedicatedAllocation = true }, blockSize),
+			  "Driver preference for a dedicated allocation was ignored!");
+	testEqual(true, shouldUseDedicatedAllocation({ .size = 4096, .requiresDedicatedAllocation = true }, blockSize),
+			  "Driver requirement for a dedicated allocation was ignored!");
+}
+
+void testAllocationPlacementPriority() {
+	testEqual(0.0f, quantizeMemoryPriority(-3.0f), "Negative priority wasn't clamped!");
+	testEqual(1.0f, quantizeMemoryPriority(7.0f), "Priority above 1 wasn't clamped!");
+	testEqual(defaultMemoryPriority, quantizeMemoryPriority(defaultMemoryPriority),
+			  "Default priority isn't a priority level!");
+	testEqual(0.25f, quantizeMemoryPriority(0.3f), "Priority wasn't rounded to the nearest level!");
+	testEqual(0.75f, quantizeMemoryPriority(0.7f), "Priority wasn't rounded to the nearest level!");
+	testEqual(defaultMemoryPriority, quantizeMemoryPriority(std::nanf("")),
+			  "Invalid priority didn't fall back to the default!");
+
+	for (auto level : memoryPriorityLevels) {
+		testEqual(level, quantizeMemoryPriority(level), "Priority level isn't preserved!");
+	}
+}
@@ -0,0 +1,81 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <fmt/format.h>
+#include <graphics/util/AllocatorStatistics.hpp>
+
+using namespace vanadium::graphics;
+
+void testAllocatorStatisticsBlock() {
+	RangeAllocator allocator = RangeAllocator(0, 1000);
+	allocator.allocate(1, 100);
+	auto middle = allocator.allocate(1, 100).value();
+	allocator.allocate(1, 100);
+	allocator.free(middle.allocationRange.offset, middle.allocationRange.size);
+
+	auto statistics = blockStatistics(allocator, 1000, 2);
+	testEqual(size_t(1), statistics.blockCount, "Block count doesn't match!");
+	testEqual(size_t(2), statistics.allocationCount, "Allocation count doesn't match!");
+	testEqual(size_t(2), statistics.freeRangeCount, "Free range count doesn't match!");
+	testEqual(VkDeviceSize(200), statistics.usedSize, "Used size doesn't match!");
+	testEqual(VkDeviceSize(700), statistics.largestFreeRange, "Largest free range doesn't match!");
+	testFloatEqualWithError(0.125f, statistics.fragmentation(), "Fragmentation doesn't match!");
+
+	auto fullStatistics = blockStatistics(RangeAllocator(), 1000, 1);
+	testEqual(0.0f, fullStatistics.fragmentation(), "Block without free memory is fragmented!");
+}
+
+void testAllocatorStatisticsAccumulation() {
+	MemoryUsageStatistics total;
+	total += blockStatistics(RangeAllocator(0, 1000), 1000, 0);
+
+	RangeAllocator allocator = RangeAllocator(0, 1000);
+	allocator.allocate(1, 500);
+	total += blockStatistics(allocator, 1000, 1);
+
+	testEqual(size_t(2), total.blockCount, "Block count doesn't match!");
+	testEqual(size_t(1), total.allocationCount, "Allocation count doesn't match!");
+	testEqual(VkDeviceSize(2000), total.size, "Size doesn't match!");
+	testEqual(VkDeviceSize(500), total.usedSize, "Used size doesn't match!");
+	testEqual(VkDeviceSize(1000), total.largestFreeRange, "Largest free range doesn't match!");
+	// free memory split between blocks counts as fragmented
+	testFloatEqualWithError(1.0f / 3.0f, total.fragmentation(), "Fragmentation doesn't match!");
+}
+
+void testAllocatorStatisticsJSON() {
+	RangeAllocator allocator = RangeAllocator(0, 1024);
+	allocator.allocate(1, 256);
+	auto block = blockStatistics(allocator, 1024, 1);
+
+	AllocatorStatistics statistics = { .total = block,
+									   .heaps = { { .remainingBudget = 4096, .usage = block } },
+									   .memoryTypes = { { .heapIndex = 0,
+														  .properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+														  .usage = block,
+														  .bufferBlocks = { block },
+														  .imageBlocks = {} } } };
+
+	std::string_view blockJSON = "{ \"blockCount\": 1, \"allocationCount\": 1, \"freeRangeCount\": 1, \"size\": 1024, "
+								 "\"usedSize\": 256, \"largestFreeRange\": 768, \"fragmentation\": 0 }";
+	std::string expected = fmt::format("{{\n"
+									   "\t\"total\": {0},\n"
+									   "\t\"heaps\": [\n"
+									   "\t\t{{ \"index\": 0, \"remainingBudget\": 4096, \"usage\": {0} }}\n"
+									   "\t],\n"
+									   "\t\"memoryTypes\": [\n"
+									   "\t\t{{\n"
+									   "\t\t\t\"index\": 0,\n"
+									   "\t\t\t\"heapIndex\": 0,\n"
+									   "\t\t\t\"properties\": 1,\n"
+									   "\t\t\t\"usage\": {0},\n"
+									   "\t\t\t\"bufferBlocks\": [\n"
+									   "\t\t\t\t{0}\n"
+									   "\t\t\t],\n"
+									   "\t\t\t\"imageBlocks\": []\n"
+									   "\t\t}}\n"
+									   "\t],\n"
+									   "\t\"customBufferBlocks\": [],\n"
+									   "\t\"customImageBlocks\": []\n"
+									   "}}\n",
+									   blockJSON);
+	testEqual(expected, statisticsToJSON(statistics), "JSON output doesn't match!");
+}
@@ -0,0 +1,70 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <graphics/util/BufferSubAllocation.hpp>
+#include <graphics/util/RangeAllocator.hpp>
+
+using namespace vanadium::graphics;
+
+namespace {
+	// Offset alignment limits as reported by lavapipe and by a typical desktop GPU
+	VkPhysicalDeviceLimits lavapipeLimits() {
+		VkPhysicalDeviceLimits limits = {};
+		limits.minTexelBufferOffsetAlignment = 16;
+		limits.minUniformBufferOffsetAlignment = 16;
+		limits.minStorageBufferOffsetAlignment = 16;
+		limits.nonCoherentAtomSize = 64;
+		return limits;
+	}
+
+	VkPhysicalDeviceLimits desktopLimits() {
+		VkPhysicalDeviceLimits limits = {};
+		limits.minTexelBufferOffsetAlignment = 16;
+		limits.minUniformBufferOffsetAlignment = 256;
+		limits.minStorageBufferOffsetAlignment = 32;
+		limits.nonCoherentAtomSize = 128;
+		return limits;
+	}
+} // namespace
+
+void testBufferSubAllocationAlignment() {
+	auto limits = desktopLimits();
+	testEqual(VkDeviceSize(256), subAllocationAlignment(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, limits, 1),
+			  "Uniform buffer offsets aren't aligned to the uniform buffer limit!");
+	testEqual(VkDeviceSize(32), subAllocationAlignment(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, limits, 1),
+			  "Storage buffer offsets aren't aligned to the storage buffer limit!");
+	testEqual(VkDeviceSize(16), subAllocationAlignment(VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT, limits, 1),
+			  "Texel buffer offsets aren't aligned to the texel buffer limit!");
+	VkBufferUsageFlags combinedUsage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	testEqual(VkDeviceSize(256), subAllocationAlignment(combinedUsage, limits, 1),
+			  "Offsets for combined usages don't satisfy all limits!");
+	testEqual(VkDeviceSize(4), subAllocationAlignment(VK_BUFFER_USAGE_INDEX_BUFFER_BIT, limits, 1),
+			  "Index buffer offsets aren't aligned to the index size!");
+	testEqual(VkDeviceSize(128),
+			  subAllocationAlignment(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, limits, limits.nonCoherentAtomSize),
+			  "Offsets in non-coherent memory aren't aligned to the atom size!");
+}
+
+// Places uniform and storage sub-allocations, including per-frame ones, into one pool and checks that every offset a
+// descriptor could refer to satisfies the device limits.
+void testBufferSubAllocationPoolOffsets() {
+	for (auto& limits : { lavapipeLimits(), desktopLimits() }) {
+		for (VkBufferUsageFlags usage : { VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT }) {
+			VkDeviceSize requiredAlignment = usage == VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+												 ? limits.minUniformBufferOffsetAlignment
+												 : limits.minStorageBufferOffsetAlignment;
+			VkDeviceSize alignment = subAllocationAlignment(usage, limits, 1);
+			RangeAllocator pool = RangeAllocator(0, 65536);
+
+			for (VkDeviceSize size : { 4, 100, 16, 333, 64 }) {
+				VkDeviceSize stride = subAllocationFrameStride(size, alignment);
+				testGreaterEqual(stride, size, "Frame data overlaps!");
+
+				auto result = pool.allocate(alignment, 2 * stride + size).value();
+				for (VkDeviceSize frame = 0; frame < 3; ++frame) {
+					VkDeviceSize offset = result.usableRange.offset + frame * stride;
+					testEqual(VkDeviceSize(0), offset % requiredAlignment, "Sub-allocation offset isn't aligned!");
+				}
+			}
+		}
+	}
+}
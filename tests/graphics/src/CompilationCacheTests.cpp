@@ -0,0 +1,74 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <graphics/util/CompilationCache.hpp>
+#include <string>
+
+using namespace vanadium::graphics;
+
+namespace {
+	// Stands in for a graph with a bloom pass that can be toggled
+	CompilationKey graphKey(bool isBloomEnabled, uint32_t targetWidth) {
+		CompilationKey key;
+		key.add(3);
+		key.add(true);
+		key.add(isBloomEnabled);
+		key.add(true);
+		key.add(targetWidth);
+		return key;
+	}
+} // namespace
+
+void testCompilationCacheHits() {
+	CompilationCache<std::string> cache;
+	testEqual(false, cache.find(graphKey(true, 1280)).has_value(), "Empty cache returned a result!");
+	cache.insert(graphKey(true, 1280), "with bloom");
+
+	// Toggling the pass off compiles once, toggling it back and forth afterwards only hits the cache
+	testEqual(false, cache.find(graphKey(false, 1280)).has_value(), "Unknown graph returned a result!");
+	cache.insert(graphKey(false, 1280), "without bloom");
+	for (size_t i = 0; i < 4; ++i) {
+		auto withBloom = cache.find(graphKey(true, 1280));
+		testEqual(true, withBloom.has_value() && withBloom.value() == "with bloom", "Toggled graph wasn't cached!");
+		auto withoutBloom = cache.find(graphKey(false, 1280));
+		testEqual(true, withoutBloom.has_value() && withoutBloom.value() == "without bloom",
+				  "Toggled graph wasn't cached!");
+	}
+	testEqual(size_t(8), cache.hitCount(), "Wrong number of cache hits!");
+	testEqual(size_t(2), cache.missCount(), "Wrong number of cache misses!");
+
+	testEqual(true, graphKey(true, 1280) == graphKey(true, 1280), "Equal inputs give different keys!");
+	testEqual(graphKey(true, 1280).hash(), graphKey(true, 1280).hash(), "Equal inputs give different hashes!");
+}
+
+void testCompilationCacheInvalidation() {
+	CompilationCache<std::string> cache(2);
+	cache.insert(graphKey(true, 1280), "1280");
+
+	// A swapchain resize changes the key, resizing back to the old size hits again
+	testEqual(false, cache.find(graphKey(true, 1920)).has_value(), "Resized graph returned the old result!");
+	cache.insert(graphKey(true, 1920), "1920");
+	testEqual(true, cache.find(graphKey(true, 1280)).has_value(), "Result of the old size was evicted!");
+
+	// Keys differing only in value order are different graphs
+	CompilationKey swappedKey;
+	swappedKey.add(3);
+	swappedKey.add(true);
+	swappedKey.add(true);
+	swappedKey.add(false);
+	swappedKey.add(1280);
+	testEqual(false, swappedKey == graphKey(false, 1280), "Keys with swapped values are equal!");
+
+	// Inserting into a full cache evicts the least recently used entry, which is 1920 after the hit above
+	cache.insert(graphKey(false, 1280), "without bloom");
+	testEqual(size_t(2), cache.size(), "Cache grew over its capacity!");
+	testEqual(false, cache.find(graphKey(true, 1920)).has_value(), "Least recently used entry wasn't evicted!");
+	testEqual(true, cache.find(graphKey(true, 1280)).has_value(), "Recently used entry was evicted!");
+
+	// Compiling a key again replaces its result
+	cache.insert(graphKey(true, 1280), "recompiled");
+	testEqual(size_t(2), cache.size(), "Replacing a result added an entry!");
+	testEqual(std::string("recompiled"), cache.find(graphKey(true, 1280)).value(), "Result wasn't replaced!");
+
+	cache.clear();
+	testEqual(false, cache.find(graphKey(true, 1280)).has_value(), "Cleared cache returned a result!");
+}
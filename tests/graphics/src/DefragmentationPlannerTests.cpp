@@ -0,0 +1,130 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <graphics/util/DefragmentationPlanner.hpp>
+
+using namespace vanadium;
+using namespace vanadium::graphics;
+
+namespace {
+	constexpr VkDeviceSize blockSize = 1024;
+
+	struct TestBlock {
+		RangeAllocator freeRanges = RangeAllocator(0, blockSize);
+		std::vector<DefragmentationAllocation> allocations;
+	};
+
+	void allocate(TestBlock& block, VkDeviceSize alignment, VkDeviceSize size) {
+		auto result = block.freeRanges.allocate(alignment, size).value();
+		block.allocations.push_back({ .resourceHandle = block.allocations.size(),
+									  .allocationRange = result.allocationRange,
+									  .alignment = alignment,
+									  .size = size });
+	}
+
+	void addBlocks(DefragmentationPlanner& planner, std::vector<TestBlock>& blocks, bool addAllocations = true) {
+		for (size_t i = 0; i < blocks.size(); ++i) {
+			planner.addBlock(i, &blocks[i].freeRanges, blockSize);
+			if (addAllocations) {
+				for (auto& allocation : blocks[i].allocations) {
+					planner.addAllocation(i, allocation);
+				}
+			}
+		}
+	}
+} // namespace
+
+void testDefragmentationPlannerEmptiesBlocks() {
+	std::vector<TestBlock> blocks = std::vector<TestBlock>(3);
+	allocate(blocks[0], 1, 100);
+	allocate(blocks[0], 1, 60);
+	allocate(blocks[1], 1, 800);
+	allocate(blocks[2], 1, 50);
+
+	DefragmentationPlanner planner;
+	addBlocks(planner, blocks);
+	auto moves = planner.planMoves(~0U);
+
+	testEqual(size_t(3), moves.size(), "Not all allocations of the sparse blocks were moved!");
+	for (auto& move : moves) {
+		testEqual(SlotmapHandle(1), move.dstBlockHandle, "Allocation wasn't moved to the most used block!");
+		testNotEqual(SlotmapHandle(1), move.srcBlockHandle, "Allocation was moved out of the most used block!");
+	}
+	// the least used block is emptied first, the larger allocation of the other block is moved first
+	testEqual(SlotmapHandle(2), moves[0].srcBlockHandle, "Least used block wasn't emptied first!");
+	testEqual(VkDeviceSize(100), moves[1].size, "Large allocations weren't moved first!");
+	testEqual(blockSize - 1010, blocks[1].freeRanges.freeSize(), "Destination ranges weren't allocated!");
+	// source ranges are freed by the caller
+	testEqual(blockSize - 160, blocks[0].freeRanges.freeSize(), "Source ranges were freed by the planner!");
+}
+
+void testDefragmentationPlannerBudget() {
+	std::vector<TestBlock> blocks = std::vector<TestBlock>(2);
+	allocate(blocks[0], 1, 600);
+	for (size_t i = 0; i < 4; ++i) {
+		allocate(blocks[1], 1, 64);
+	}
+
+	DefragmentationPlanner planner;
+	addBlocks(planner, blocks);
+	auto moves = planner.planMoves(150);
+	testEqual(size_t(2), moves.size(), "Moves exceed the byte budget!");
+	// The other allocations of the block fit as well, but their destinations are released until the next call
+	testEqual(blockSize - 728, blocks[0].freeRanges.freeSize(), "Destinations of moves over the budget were kept!");
+
+	moves = DefragmentationPlanner().planMoves(1024);
+	testEqual(size_t(0), moves.size(), "Moves were planned without blocks!");
+}
+
+void testDefragmentationPlannerUnmovable() {
+	std::vector<TestBlock> blocks = std::vector<TestBlock>(3);
+	allocate(blocks[0], 1, 600);
+	allocate(blocks[1], 1, 100);
+	allocate(blocks[1], 1, 100);
+	allocate(blocks[2], 1, 300);
+
+	DefragmentationPlanner planner;
+	addBlocks(planner, blocks, false);
+	// only one of the allocations in the least used block is movable
+	planner.addAllocation(1, blocks[1].allocations[0]);
+	planner.addAllocation(2, blocks[2].allocations[0]);
+	auto moves = planner.planMoves(~0U);
+
+	testEqual(size_t(1), moves.size(), "Allocations were moved out of a block that can't be emptied!");
+	testEqual(SlotmapHandle(2), moves[0].srcBlockHandle, "Wrong allocation was moved!");
+	// The block with the unmovable allocation is still a valid destination, but the most used block is preferred
+	testEqual(SlotmapHandle(0), moves[0].dstBlockHandle, "Allocation wasn't moved to the most used block!");
+}
+
+void testDefragmentationPlannerAlignment() {
+	std::vector<TestBlock> blocks = std::vector<TestBlock>(2);
+	allocate(blocks[0], 1, 501);
+	allocate(blocks[0], 1, 200);
+	allocate(blocks[1], 256, 256);
+
+	DefragmentationPlanner planner;
+	addBlocks(planner, blocks);
+	auto moves = planner.planMoves(~0U);
+
+	// the allocation only fits into the remaining space with the alignment margin
+	testEqual(size_t(1), moves.size(), "Allocation wasn't moved!");
+	testEqual(VkDeviceSize(0), moves[0].dstAllocation.usableRange.offset % 256, "Moved allocation isn't aligned!");
+	testEqual(VkDeviceSize(256), moves[0].dstAllocation.usableRange.size, "Moved allocation has wrong size!");
+}
+
+void testDefragmentationPlannerPartialBlock() {
+	std::vector<TestBlock> blocks = std::vector<TestBlock>(3);
+	allocate(blocks[0], 1, 600);
+	allocate(blocks[1], 1, 300);
+	allocate(blocks[1], 1, 200);
+	allocate(blocks[2], 1, 100);
+
+	DefragmentationPlanner planner;
+	addBlocks(planner, blocks);
+	auto moves = planner.planMoves(~0U);
+
+	// After the least used block is emptied, only one of the allocations of the other block fits
+	testEqual(size_t(1), moves.size(), "Allocations were moved out of a block that can't be emptied!");
+	testEqual(SlotmapHandle(2), moves[0].srcBlockHandle, "Block that can be emptied wasn't emptied!");
+	testEqual(blockSize - 700, blocks[0].freeRanges.freeSize(),
+			  "Destination of an allocation that isn't moved wasn't released!");
+}
@@ -0,0 +1,96 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <graphics/util/FramegraphResize.hpp>
+#include <algorithm>
+#include <string>
+
+using namespace vanadium::graphics;
+
+namespace {
+	enum Resource : uint64_t { Shadow, Depth, Target };
+
+	RasterAttachmentUsage attachment(uint64_t resource, VkAttachmentLoadOp loadOp) {
+		bool isDepth = resource != Target;
+		return { .resource = resource,
+				 .format = isDepth ? VK_FORMAT_D32_SFLOAT : VK_FORMAT_B8G8R8A8_SRGB,
+				 .sampleCount = VK_SAMPLE_COUNT_1_BIT,
+				 .loadOp = loadOp,
+				 .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+				 .layout = isDepth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+								   : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+	}
+
+	// A fixed-size shadow pass, a forward pass and a UI pass drawing onto the target. The render area of the forward
+	// pass is limited by its depth buffer, so the UI pass only joins it while both render with the same extent.
+	std::vector<MergedRenderPass> plans(uint32_t targetWidth, uint32_t targetHeight, bool isDepthTargetSized) {
+		RasterNodeUsage shadowNode = { .isRaster = true, .width = 2048, .height = 2048 };
+		shadowNode.depthStencilAttachment = attachment(Shadow, VK_ATTACHMENT_LOAD_OP_CLEAR);
+
+		RasterNodeUsage forwardNode = { .isRaster = true,
+										.width = isDepthTargetSized ? targetWidth : std::min(1280U, targetWidth),
+										.height = isDepthTargetSized ? targetHeight : std::min(720U, targetHeight),
+										.colorAttachments = { attachment(Target, VK_ATTACHMENT_LOAD_OP_CLEAR) } };
+		forwardNode.depthStencilAttachment = attachment(Depth, VK_ATTACHMENT_LOAD_OP_CLEAR);
+		forwardNode.readResources = { Shadow };
+
+		RasterNodeUsage uiNode = { .isRaster = true,
+								   .width = targetWidth,
+								   .height = targetHeight,
+								   .colorAttachments = { attachment(Target, VK_ATTACHMENT_LOAD_OP_LOAD) } };
+		return planRenderPassMerges({ shadowNode, forwardNode, uiNode }, {});
+	}
+
+	// Stands in for FramegraphContext::compilationKey, which covers the target extent only if a transient image is
+	// sized like the target
+	CompilationKey graphKey(uint32_t targetWidth, uint32_t targetHeight, bool isDepthTargetSized) {
+		CompilationKey key;
+		key.add(3);
+		key.add(isDepthTargetSized);
+		if (isDepthTargetSized) {
+			key.add(targetWidth);
+			key.add(targetHeight);
+		}
+		return key;
+	}
+
+	size_t count(const std::vector<bool>& values) { return std::count(values.begin(), values.end(), true); }
+} // namespace
+
+// Resizing a graph without transient images sized like the target hits the applied compilation. Only the
+// framebuffers of the passes rendering to the target are rebuilt, no render pass or compilation is.
+void testFramegraphResizeCacheHit() {
+	auto appliedPlans = plans(1920, 1080, false);
+	auto resizedPlans = plans(2560, 1440, false);
+	testEqual(size_t(3), resizedPlans.size(), "Wrong number of render passes!");
+
+	auto actions = planFramegraphResize(graphKey(1920, 1080, false), graphKey(2560, 1440, false), appliedPlans,
+										resizedPlans, { false, true, true });
+	testEqual(false, actions.updatesCompilation, "Resize without target sized images recompiled!");
+	testEqual(size_t(0), count(actions.recreatesRenderPass), "Unchanged render passes were recreated!");
+	testEqual(false, static_cast<bool>(actions.recreatesFramebuffers[0]), "Fixed size framebuffer was rebuilt!");
+	testEqual(size_t(2), count(actions.recreatesFramebuffers), "Target framebuffers weren't rebuilt!");
+
+	// Once the target shrinks to the depth buffer's size, the UI pass becomes a subpass of the forward pass
+	auto mergedPlans = plans(1280, 720, false);
+	testEqual(size_t(2), mergedPlans.size(), "UI pass wasn't merged!");
+	actions = planFramegraphResize(graphKey(1920, 1080, false), graphKey(1280, 720, false), appliedPlans,
+								   mergedPlans, { false, true });
+	testEqual(false, static_cast<bool>(actions.recreatesRenderPass[0]), "Shadow pass was recreated!");
+	testEqual(true, static_cast<bool>(actions.recreatesRenderPass[1]), "Merged render pass wasn't recreated!");
+}
+
+// Target sized images change the key. Render passes are still kept as long as only their extent changes, but
+// framebuffers are rebuilt since transient images may be placed again. Resizing back restores the old compilation.
+void testFramegraphResizeInvalidation() {
+	CompilationCache<std::string> cache;
+	cache.insert(graphKey(1920, 1080, true), "1920x1080");
+
+	auto actions = planFramegraphResize(graphKey(1920, 1080, true), graphKey(2560, 1440, true),
+										plans(1920, 1080, true), plans(2560, 1440, true), { false, true });
+	testEqual(true, actions.updatesCompilation, "Resize with target sized images kept the compilation!");
+	testEqual(size_t(0), count(actions.recreatesRenderPass), "Render passes changing extent were recreated!");
+	testEqual(size_t(2), count(actions.recreatesFramebuffers), "Framebuffers weren't rebuilt!");
+	testEqual(false, cache.find(graphKey(2560, 1440, true)).has_value(), "Resized graph returned the old result!");
+	cache.insert(graphKey(2560, 1440, true), "2560x1440");
+	testEqual(true, cache.find(graphKey(1920, 1080, true)).has_value(), "Resizing back recompiled!");
+}
@@ -0,0 +1,75 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <graphics/util/LazyCreationTable.hpp>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace vanadium::graphics;
+
+void testLazyCreationStates() {
+	LazyCreationTable<uint64_t, int> table;
+	testEqual(LazyCreationState::Missing, table.state(1), "Object exists before it was created!");
+
+	int creationCount = 0;
+	auto create = [&creationCount]() {
+		++creationCount;
+		return 10;
+	};
+	testEqual(10, table.getOrCreate(1, create), "Wrong object returned!");
+	testEqual(10, table.getOrCreate(1, create), "Wrong object returned!");
+	testEqual(1, creationCount, "Object was created more than once!");
+	testEqual(LazyCreationState::Ready, table.state(1), "Created object isn't ready!");
+
+	// Precompiled objects are neither created twice nor counted as used until they are looked up
+	testEqual(true, table.tryCreate(2, []() { return 20; }), "Missing object wasn't created!");
+	testEqual(false, table.tryCreate(2, []() { return 21; }), "Existing object was created again!");
+	testEqual(false, table.tryCreate(1, []() { return 11; }), "Used object was created again!");
+	testEqual(std::vector<uint64_t>{ 1 }, table.usedKeys(), "Precompiled object counts as used!");
+	testEqual(20, table.getOrCreate(2, create), "Precompiled object wasn't returned!");
+	testEqual(1, creationCount, "Precompiled object was created again!");
+
+	auto usedKeys = table.usedKeys();
+	std::sort(usedKeys.begin(), usedKeys.end());
+	testEqual(std::vector<uint64_t>{ 1, 2 }, usedKeys, "Looked up objects aren't used!");
+
+	int readySum = 0;
+	table.forEachReady([&readySum](uint64_t, int value) { readySum += value; });
+	testEqual(30, readySum, "Not all ready objects were visited!");
+}
+
+// Threads looking up an object while another thread creates it wait for that thread instead of creating it again
+void testLazyCreationConcurrent() {
+	constexpr size_t threadCount = 8;
+	constexpr uint64_t keyCount = 64;
+	LazyCreationTable<uint64_t, uint64_t> table;
+	std::atomic<uint32_t> creationCount = 0;
+	std::atomic<bool> allValuesMatch = true;
+
+	std::vector<std::thread> threads;
+	for (size_t threadIndex = 0; threadIndex < threadCount; ++threadIndex) {
+		threads.emplace_back([&table, &creationCount, &allValuesMatch, threadIndex]() {
+			for (uint64_t i = 0; i < keyCount; ++i) {
+				uint64_t key = (i + threadIndex) % keyCount;
+				auto create = [&creationCount, key]() {
+					++creationCount;
+					std::this_thread::yield();
+					return key * 3;
+				};
+				// Half of the threads act like the background thread
+				if (threadIndex % 2) {
+					table.tryCreate(key, create);
+				} else if (table.getOrCreate(key, create) != key * 3) {
+					allValuesMatch = false;
+				}
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	testEqual(keyCount, static_cast<uint64_t>(creationCount.load()), "Objects were created more than once!");
+	testEqual(true, allValuesMatch.load(), "Wrong object returned!");
+	testEqual(static_cast<size_t>(keyCount), table.usedKeys().size(), "Not all looked up objects are used!");
+}
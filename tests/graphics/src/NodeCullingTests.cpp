@@ -0,0 +1,68 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <graphics/util/NodeCulling.hpp>
+
+using namespace vanadium::graphics;
+
+namespace {
+	NodeResourceUsage node(std::vector<uint64_t> reads, std::vector<uint64_t> writes, bool hasExternalEffects = false) {
+		return { .readResources = std::move(reads),
+				 .writtenResources = std::move(writes),
+				 .hasExternalEffects = hasExternalEffects };
+	}
+} // namespace
+
+// A deferred renderer with an unused debug visualization branch
+void testNodeCullingUnusedBranch() {
+	enum Resource : uint64_t { GBuffer, Depth, Lighting, DebugView, DebugOverlay, Shadow };
+	std::vector<NodeResourceUsage> nodes = {
+		node({}, { Shadow }),
+		node({}, { GBuffer, Depth }),
+		node({ GBuffer, Depth, Shadow }, { Lighting }),
+		// Debug branch, nothing reads its output
+		node({ GBuffer }, { DebugView }),
+		node({ DebugView }, { DebugOverlay }),
+		// Writes the swapchain image
+		node({ Lighting }, {}, true),
+	};
+	auto isCulled = findCulledNodes(nodes);
+	testEqual(std::vector<bool>{ false, false, false, true, true, false }, isCulled,
+			  "Unused branch wasn't culled or used nodes were culled!");
+
+	// Displaying the debug overlay makes the branch reachable
+	nodes[5].readResources.push_back(DebugOverlay);
+	isCulled = findCulledNodes(nodes);
+	testEqual(std::vector<bool>(6, false), isCulled, "Reachable debug branch was culled!");
+}
+
+void testNodeCullingRoots() {
+	std::vector<NodeResourceUsage> nodes = {
+		// Writes an imported buffer that is read outside of the graph
+		node({}, { 0 }, true),
+		// Doesn't declare any writes, so its effects are unknown
+		node({ 1 }, {}),
+		node({}, { 1 }),
+		node({}, { 2 }),
+	};
+	auto isCulled = findCulledNodes(nodes);
+	testEqual(std::vector<bool>{ false, false, false, true }, isCulled, "Roots weren't kept!");
+
+	testEqual(size_t(0), findCulledNodes({}).size(), "Culling an empty graph returned nodes!");
+}
+
+// Results written late in a frame and read early in the next one keep their writers alive, cycles terminate
+void testNodeCullingFeedback() {
+	std::vector<NodeResourceUsage> nodes = {
+		// Temporal reprojection reads the previous frame's history
+		node({ 0, 1 }, { 2 }),
+		node({}, { 1 }),
+		node({ 2 }, { 0 }),
+		node({ 2 }, {}, true),
+		// Unused cycle
+		node({ 4 }, { 3 }),
+		node({ 3 }, { 4 }),
+	};
+	auto isCulled = findCulledNodes(nodes);
+	testEqual(std::vector<bool>{ false, false, false, false, true, true }, isCulled,
+			  "Feedback writers weren't kept or unused cycle wasn't culled!");
+}
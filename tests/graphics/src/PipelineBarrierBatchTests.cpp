@@ -0,0 +1,111 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <graphics/util/PipelineBarrierBatch.hpp>
+
+using namespace vanadium::graphics;
+
+namespace {
+	// A compute pass writing a vertex buffer, and a render pass whose color attachment is sampled afterwards
+	const VkBufferMemoryBarrier vertexBufferBarrier = { .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+														.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+														.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+														.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+														.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+														.buffer = reinterpret_cast<VkBuffer>(uintptr_t(1)),
+														.offset = 256,
+														.size = 1024 };
+	const VkPipelineStageFlags vertexBufferSrcStages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	const VkPipelineStageFlags vertexBufferDstStages = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+
+	const VkImageMemoryBarrier colorImageBarrier = { .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+													 .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+													 .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+													 .oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+													 .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+													 .srcQueueFamilyIndex = 0,
+													 .dstQueueFamilyIndex = 1,
+													 .image = reinterpret_cast<VkImage>(uintptr_t(2)),
+													 .subresourceRange = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+																		   .baseMipLevel = 1,
+																		   .levelCount = 2,
+																		   .baseArrayLayer = 0,
+																		   .layerCount = 1 } };
+	const VkPipelineStageFlags colorImageSrcStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	const VkPipelineStageFlags colorImageDstStages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+	void addTestBarriers(PipelineBarrierBatch& batch) {
+		batch.addBufferBarrier(vertexBufferBarrier, vertexBufferSrcStages, vertexBufferDstStages);
+		batch.addImageBarrier(colorImageBarrier, colorImageSrcStages, colorImageDstStages);
+	}
+} // namespace
+
+// Without synchronization2, the barriers are kept as they are and every barrier waits for all stages of the batch
+void testPipelineBarrierBatchLegacy() {
+	PipelineBarrierBatch batch;
+	batch.reset(false);
+	testEqual(true, batch.empty(), "Batch without barriers isn't empty!");
+	addTestBarriers(batch);
+	testEqual(false, batch.empty(), "Batch with barriers is empty!");
+
+	testEqual(size_t(1), batch.bufferBarriers().size(), "Wrong number of buffer barriers!");
+	testEqual(size_t(1), batch.imageBarriers().size(), "Wrong number of image barriers!");
+	testEqual(vertexBufferBarrier.offset, batch.bufferBarriers()[0].offset, "Buffer barrier has the wrong offset!");
+	testEqual(true, batch.imageBarriers()[0].newLayout == colorImageBarrier.newLayout,
+			  "Image barrier has the wrong layout!");
+	testEqual(vertexBufferSrcStages | colorImageSrcStages, batch.srcStageFlags(), "Source stages aren't merged!");
+	testEqual(vertexBufferDstStages | colorImageDstStages, batch.dstStageFlags(),
+			  "Destination stages aren't merged!");
+	testEqual(size_t(0), batch.bufferBarriers2().size() + batch.imageBarriers2().size(),
+			  "Synchronization2 barriers were added!");
+}
+
+// With synchronization2, the vertex buffer barrier doesn't wait for color attachment output and the image barrier
+// doesn't block vertex input
+void testPipelineBarrierBatchSynchronization2() {
+	PipelineBarrierBatch batch;
+	batch.reset(true);
+	addTestBarriers(batch);
+	testEqual(size_t(0), batch.bufferBarriers().size() + batch.imageBarriers().size(), "Legacy barriers were added!");
+	testEqual(VkPipelineStageFlags(0), batch.srcStageFlags() | batch.dstStageFlags(),
+			  "Synchronization2 barriers are merged into batch stages!");
+
+	testEqual(size_t(1), batch.bufferBarriers2().size(), "Wrong number of buffer barriers!");
+	auto& bufferBarrier = batch.bufferBarriers2()[0];
+	testEqual(true, bufferBarrier.sType == VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR,
+			  "Buffer barrier has the wrong structure type!");
+	testEqual(VkPipelineStageFlags2KHR(vertexBufferSrcStages), bufferBarrier.srcStageMask,
+			  "Buffer barrier has the wrong source stages!");
+	testEqual(VkPipelineStageFlags2KHR(vertexBufferDstStages), bufferBarrier.dstStageMask,
+			  "Buffer barrier has the wrong destination stages!");
+	testEqual(VkAccessFlags2KHR(vertexBufferBarrier.dstAccessMask), bufferBarrier.dstAccessMask,
+			  "Buffer barrier has the wrong destination access!");
+	testEqual(true, bufferBarrier.buffer == vertexBufferBarrier.buffer, "Buffer barrier has the wrong buffer!");
+	testEqual(vertexBufferBarrier.offset, bufferBarrier.offset, "Buffer barrier has the wrong offset!");
+	testEqual(vertexBufferBarrier.size, bufferBarrier.size, "Buffer barrier has the wrong size!");
+
+	testEqual(size_t(1), batch.imageBarriers2().size(), "Wrong number of image barriers!");
+	auto& imageBarrier = batch.imageBarriers2()[0];
+	testEqual(VkPipelineStageFlags2KHR(colorImageSrcStages), imageBarrier.srcStageMask,
+			  "Image barrier has the wrong source stages!");
+	testEqual(VkPipelineStageFlags2KHR(colorImageDstStages), imageBarrier.dstStageMask,
+			  "Image barrier has the wrong destination stages!");
+	testEqual(VkAccessFlags2KHR(colorImageBarrier.srcAccessMask), imageBarrier.srcAccessMask,
+			  "Image barrier has the wrong source access!");
+	testEqual(true,
+			  imageBarrier.oldLayout == colorImageBarrier.oldLayout &&
+				  imageBarrier.newLayout == colorImageBarrier.newLayout,
+			  "Image barrier has the wrong layouts!");
+	testEqual(uint32_t(1), imageBarrier.dstQueueFamilyIndex, "Image barrier has the wrong queue family!");
+	testEqual(uint32_t(2), imageBarrier.subresourceRange.levelCount, "Image barrier has the wrong range!");
+
+	auto dependencyInfo = batch.dependencyInfo();
+	testEqual(uint32_t(1), dependencyInfo.bufferMemoryBarrierCount, "Dependency has the wrong buffer barriers!");
+	testEqual(uint32_t(1), dependencyInfo.imageMemoryBarrierCount, "Dependency has the wrong image barriers!");
+	testEqual(true, dependencyInfo.pImageMemoryBarriers == batch.imageBarriers2().data(),
+			  "Dependency doesn't point to the batch!");
+
+	// Batches are reused every frame, resetting switches the form
+	batch.reset(false);
+	testEqual(true, batch.empty(), "Reset batch isn't empty!");
+	testEqual(false, batch.usesSynchronization2(), "Reset batch uses the wrong form!");
+}
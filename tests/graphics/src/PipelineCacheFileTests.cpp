@@ -0,0 +1,90 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <graphics/util/PipelineCacheFile.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+using namespace vanadium::graphics;
+
+namespace {
+	PipelineCacheDeviceInfo deviceInfo() {
+		return { .vendorID = 0x10005,
+				 .deviceID = 0x0000,
+				 .driverVersion = 0x1,
+				 .pipelineCacheUUID = { 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0, 0x0F, 0xED, 0xCB, 0xA9, 0x87,
+										0x65, 0x43, 0x21 } };
+	}
+
+	// What vkGetPipelineCacheData returns: a VkPipelineCacheHeaderVersionOne followed by driver-specific data
+	std::vector<char> vulkanCacheData(const PipelineCacheDeviceInfo& info) {
+		std::vector<char> data(32 + 64);
+		uint32_t headerFields[4] = { 32, 1, info.vendorID, info.deviceID };
+		std::memcpy(data.data(), headerFields, sizeof(headerFields));
+		std::memcpy(data.data() + 16, info.pipelineCacheUUID.data(), info.pipelineCacheUUID.size());
+		for (size_t i = 32; i < data.size(); ++i) {
+			data[i] = static_cast<char>(i * 7);
+		}
+		return data;
+	}
+
+	bool isValid(const PipelineCacheDeviceInfo& info, const std::vector<char>& fileData) {
+		return deserializePipelineCache(info, fileData.data(), fileData.size()).has_value();
+	}
+} // namespace
+
+void testPipelineCacheRoundTrip() {
+	auto info = deviceInfo();
+	auto cacheData = vulkanCacheData(info);
+	auto fileData = serializePipelineCache(info, cacheData);
+
+	auto directory = std::filesystem::temp_directory_path() / "vanadium-pipeline-cache-test";
+	std::filesystem::create_directories(directory);
+	auto fileName = (directory / "pipelines.vcpcache").string();
+	testEqual(true, writeFileAtomically(fileName, serializePipelineCache(info, {})), "Writing the cache failed!");
+	// Replaces the existing file
+	testEqual(true, writeFileAtomically(fileName, fileData), "Overwriting the cache failed!");
+	testEqual(false, std::filesystem::exists(fileName + ".tmp"), "Temporary file wasn't renamed!");
+
+	std::ifstream stream = std::ifstream(fileName, std::ios::binary);
+	std::vector<char> readData = std::vector<char>(std::istreambuf_iterator<char>(stream), {});
+	stream.close();
+	std::filesystem::remove_all(directory);
+
+	auto result = deserializePipelineCache(info, readData.data(), readData.size());
+	testEqual(true, result.has_value(), "Cache written for the same device was discarded!");
+	testEqual(cacheData, result.value(), "Cache data changed!");
+}
+
+void testPipelineCacheInvalidation() {
+	auto info = deviceInfo();
+	auto fileData = serializePipelineCache(info, vulkanCacheData(info));
+	testEqual(true, isValid(info, fileData), "Valid cache was discarded!");
+
+	auto newDriver = info;
+	newDriver.driverVersion = 0x2;
+	testEqual(false, isValid(newDriver, fileData), "Cache of another driver version was used!");
+	auto otherUUID = info;
+	otherUUID.pipelineCacheUUID[0] = 0;
+	testEqual(false, isValid(otherUUID, fileData), "Cache with another UUID was used!");
+	auto otherDevice = info;
+	otherDevice.deviceID = 0x1;
+	testEqual(false, isValid(otherDevice, fileData), "Cache of another device was used!");
+
+	testEqual(false, isValid(info, {}), "Empty file was used!");
+	auto truncatedData = fileData;
+	truncatedData.resize(truncatedData.size() - 1);
+	testEqual(false, isValid(info, truncatedData), "Truncated cache was used!");
+	auto corruptedData = fileData;
+	corruptedData.back() ^= 1;
+	testEqual(false, isValid(info, corruptedData), "Corrupted cache was used!");
+
+	// The Vulkan header inside the data has to match as well, e.g. if the file was written with a wrong device info
+	auto otherInfo = info;
+	otherInfo.vendorID = 0x1002;
+	testEqual(false, isValid(info, serializePipelineCache(info, vulkanCacheData(otherInfo))),
+			  "Cache with a mismatching Vulkan header was used!");
+	testEqual(false, isValid(info, serializePipelineCache(info, std::vector<char>(16))),
+			  "Cache without a Vulkan header was used!");
+}
@@ -0,0 +1,342 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <Log.hpp>
+#include <graphics/util/PipelineObjectKeys.hpp>
+#include <graphics/util/SharedObjectTable.hpp>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <VCPFormat.hpp>
+
+using namespace vanadium::graphics;
+
+namespace {
+	// Non-dispatchable handles are pointers on 64-bit platforms and integers otherwise
+	template <typename T> T fakeHandle(uint64_t value) {
+		if constexpr (std::is_pointer_v<T>) {
+			return reinterpret_cast<T>(static_cast<uintptr_t>(value));
+		} else {
+			return static_cast<T>(value);
+		}
+	}
+
+	// Stands in for a device, handing out a new handle for every created object
+	struct FakeObjectTables {
+		SharedObjectTable<std::string, VkSampler> samplers;
+		SharedObjectTable<std::string, VkDescriptorSetLayout> descriptorSetLayouts;
+		SharedObjectTable<std::string, VkPipelineLayout> pipelineLayouts;
+		SharedObjectTable<ShaderModuleKey, VkShaderModule, ShaderModuleKeyHash> shaderModules;
+		uint64_t createdCount = 0;
+		uint64_t destroyedCount = 0;
+
+		template <typename T> auto creator() {
+			return [this]() { return fakeHandle<T>(++createdCount); };
+		}
+		auto destroyer() {
+			return [this](auto) { ++destroyedCount; };
+		}
+	};
+
+	// The objects of one library, acquired the same way PipelineLibrary acquires them
+	struct FakeLibraryObjects {
+		std::vector<VkSampler> samplers;
+		std::vector<VkDescriptorSetLayout> setLayouts;
+		std::vector<VkPipelineLayout> pipelineLayouts;
+		std::vector<VkShaderModule> shaderModules;
+
+		void create(const VCPLibraryView& view, FakeObjectTables& tables) {
+			// Bindings point into the sampler array, so it must not be reallocated
+			size_t samplerCount = 0;
+			for (auto& setLayout : view.setLayouts()) {
+				for (auto& binding : view.elements(setLayout.bindings)) {
+					samplerCount += binding.immutableSamplers.count;
+				}
+			}
+			samplers.reserve(samplerCount);
+
+			for (auto& setLayout : view.setLayouts()) {
+				std::vector<VkDescriptorSetLayoutBinding> bindings;
+				for (auto& binding : view.elements(setLayout.bindings)) {
+					const VkSampler* immutableSamplers = nullptr;
+					if (binding.usesImmutableSamplers) {
+						immutableSamplers = samplers.data() + samplers.size();
+						for (auto& info : view.elements(binding.immutableSamplers)) {
+							VkSamplerCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+															   .magFilter = info.magFilter,
+															   .minFilter = info.minFilter,
+															   .maxLod = info.maxLod };
+							samplers.push_back(
+								tables.samplers.acquireOrCreate(samplerKey(createInfo), tables.creator<VkSampler>()));
+						}
+					}
+					bindings.push_back({ .binding = binding.binding,
+										 .descriptorType = binding.descriptorType,
+										 .descriptorCount = binding.descriptorCount,
+										 .stageFlags = binding.stageFlags,
+										 .pImmutableSamplers = immutableSamplers });
+				}
+				VkDescriptorSetLayoutCreateInfo createInfo = {
+					.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+					.bindingCount = static_cast<uint32_t>(bindings.size()),
+					.pBindings = bindings.data()
+				};
+				setLayouts.push_back(tables.descriptorSetLayouts.acquireOrCreate(
+					descriptorSetLayoutKey(createInfo), tables.creator<VkDescriptorSetLayout>()));
+			}
+
+			for (auto& archetype : view.archetypes()) {
+				for (auto& shader : view.elements(archetype.shaders)) {
+					auto code = view.elements(shader.code);
+					VkShaderModuleCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+															.codeSize = code.size(),
+															.pCode = reinterpret_cast<const uint32_t*>(code.data()) };
+					shaderModules.push_back(tables.shaderModules.acquireOrCreate(shaderModuleKey(createInfo),
+																				 tables.creator<VkShaderModule>()));
+				}
+
+				std::vector<VkDescriptorSetLayout> archetypeSetLayouts;
+				for (auto& index : view.elements(archetype.setLayoutIndices)) {
+					archetypeSetLayouts.push_back(setLayouts[index]);
+				}
+				auto pushConstantRanges = view.elements(archetype.pushConstantRanges);
+				VkPipelineLayoutCreateInfo createInfo = {
+					.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+					.setLayoutCount = static_cast<uint32_t>(archetypeSetLayouts.size()),
+					.pSetLayouts = archetypeSetLayouts.data(),
+					.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size()),
+					.pPushConstantRanges = pushConstantRanges.data()
+				};
+				pipelineLayouts.push_back(tables.pipelineLayouts.acquireOrCreate(pipelineLayoutKey(createInfo),
+																				 tables.creator<VkPipelineLayout>()));
+			}
+		}
+
+		void destroy(FakeObjectTables& tables) {
+			for (auto& module : shaderModules) {
+				tables.shaderModules.release(module, tables.destroyer());
+			}
+			for (auto& layout : pipelineLayouts) {
+				tables.pipelineLayouts.release(layout, tables.destroyer());
+			}
+			for (auto& layout : setLayouts) {
+				tables.descriptorSetLayouts.release(layout, tables.destroyer());
+			}
+			for (auto& sampler : samplers) {
+				tables.samplers.release(sampler, tables.destroyer());
+			}
+		}
+	};
+
+	DescriptorBindingLayoutInfo samplerBinding(uint32_t binding, VkFilter filter) {
+		return { .binding = { .binding = binding,
+							  .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER,
+							  .descriptorCount = 1,
+							  .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT },
+				 .usesImmutableSamplers = true,
+				 .immutableSamplerInfos = { { .magFilter = filter, .minFilter = filter, .maxLod = 4.0f } } };
+	}
+
+	DescriptorBindingLayoutInfo bufferBinding(uint32_t binding) {
+		return { .binding = { .binding = binding,
+							  .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+							  .descriptorCount = 1,
+							  .stageFlags = VK_SHADER_STAGE_VERTEX_BIT },
+				 .usesImmutableSamplers = false };
+	}
+
+	CompiledShader shader(VkShaderStageFlagBits stage, std::vector<char>& code) {
+		return { .stage = stage, .dataSize = code.size(), .data = code.data() };
+	}
+
+	// Variants of a material as vcp writes them: set layouts 0 and 1 only differ in binding order, set layout 3 uses
+	// another sampler. The first two archetypes only differ in the set layout, the third one has another fragment
+	// shader and the compute archetype has no sets at all.
+	std::vector<char> variantLibrary() {
+		static std::vector<char> vertexCode = std::vector<char>(32, 'v');
+		static std::vector<char> fragmentCode = std::vector<char>(48, 'f');
+		static std::vector<char> otherFragmentCode = std::vector<char>(48, 'g');
+		static std::vector<char> computeCode = std::vector<char>(16, 'c');
+		VkPushConstantRange pushConstantRange = { .stageFlags = VK_SHADER_STAGE_VERTEX_BIT, .offset = 0, .size = 64 };
+
+		VCPLibraryWriter writer;
+		writer.addSetLayout({ samplerBinding(0, VK_FILTER_LINEAR), bufferBinding(1) });
+		writer.addSetLayout({ bufferBinding(1), samplerBinding(0, VK_FILTER_LINEAR) });
+		writer.addSetLayout({ bufferBinding(0) });
+		writer.addSetLayout({ samplerBinding(0, VK_FILTER_NEAREST), bufferBinding(1) });
+		writer.addArchetype(PipelineType::Graphics,
+							{ shader(VK_SHADER_STAGE_VERTEX_BIT, vertexCode),
+							  shader(VK_SHADER_STAGE_FRAGMENT_BIT, fragmentCode) },
+							{ 0 }, { pushConstantRange });
+		writer.addArchetype(PipelineType::Graphics,
+							{ shader(VK_SHADER_STAGE_VERTEX_BIT, vertexCode),
+							  shader(VK_SHADER_STAGE_FRAGMENT_BIT, fragmentCode) },
+							{ 1 }, { pushConstantRange });
+		writer.addArchetype(PipelineType::Graphics,
+							{ shader(VK_SHADER_STAGE_VERTEX_BIT, vertexCode),
+							  shader(VK_SHADER_STAGE_FRAGMENT_BIT, otherFragmentCode) },
+							{ 2, 3 }, { pushConstantRange });
+		writer.addArchetype(PipelineType::Compute, { shader(VK_SHADER_STAGE_COMPUTE_BIT, computeCode) }, {}, {});
+		return writer.finish();
+	}
+} // namespace
+
+void testSharedObjectTableReferences() {
+	SharedObjectTable<std::string, int> table;
+	int creationCount = 0;
+	auto create = [&creationCount]() { return ++creationCount * 10; };
+	std::vector<int> destroyedValues;
+	auto destroy = [&destroyedValues](int value) { destroyedValues.push_back(value); };
+
+	testEqual(false, table.acquire("a").has_value(), "Missing object was acquired!");
+	testEqual(10, table.acquireOrCreate("a", create), "Wrong object created!");
+	testEqual(10, table.acquireOrCreate("a", create), "Identical object was created twice!");
+	testEqual(10, table.acquire("a").value(), "Existing object wasn't acquired!");
+	testEqual(20, table.acquireOrCreate("b", create), "Wrong object created!");
+	testEqual(size_t(2), table.size(), "Wrong object count!");
+	testEqual(3U, table.referenceCount(10), "Wrong reference count!");
+
+	testEqual(false, table.release(10, destroy), "Object was destroyed before its last reference!");
+	testEqual(false, table.release(10, destroy), "Object was destroyed before its last reference!");
+	testEqual(true, table.release(10, destroy), "Object wasn't destroyed with its last reference!");
+	testEqual(std::vector<int>{ 10 }, destroyedValues, "Wrong objects destroyed!");
+	testEqual(false, table.release(10, destroy), "Destroyed object was released again!");
+	testEqual(size_t(1), table.size(), "Destroyed object is still in the table!");
+
+	// An object created meanwhile by another thread wins, the duplicate is destroyed right away
+	testEqual(50, table.add("c", 50, destroy), "Added object wasn't returned!");
+	testEqual(50, table.add("c", 51, destroy), "Duplicate object replaced the existing one!");
+	testEqual(std::vector<int>{ 10, 51 }, destroyedValues, "Duplicate object wasn't destroyed!");
+	testEqual(2U, table.referenceCount(50), "Duplicate didn't reference the existing object!");
+
+	// The key of a destroyed object can be used again
+	testEqual(30, table.acquireOrCreate("a", create), "Object of the same key wasn't created again!");
+	testEqual(1U, table.referenceCount(30), "Wrong reference count!");
+
+	table.clear(destroy);
+	testEqual(size_t(0), table.size(), "Table wasn't cleared!");
+	testEqual(size_t(5), destroyedValues.size(), "Not all objects were destroyed!");
+}
+
+void testPipelineObjectKeys() {
+	VkSamplerCreateInfo samplerCreateInfo = { .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+											  .magFilter = VK_FILTER_LINEAR,
+											  .maxLod = 4.0f };
+	VkSamplerCreateInfo otherSamplerCreateInfo = samplerCreateInfo;
+	testEqual(samplerKey(samplerCreateInfo), samplerKey(otherSamplerCreateInfo), "Identical samplers differ!");
+	otherSamplerCreateInfo.maxLod = 2.0f;
+	testEqual(false, samplerKey(samplerCreateInfo) == samplerKey(otherSamplerCreateInfo), "Different samplers match!");
+
+	VkSampler samplers[2] = { fakeHandle<VkSampler>(1), fakeHandle<VkSampler>(2) };
+	VkDescriptorSetLayoutBinding bindings[2] = { { .binding = 0,
+												   .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER,
+												   .descriptorCount = 1,
+												   .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+												   .pImmutableSamplers = &samplers[0] },
+												 { .binding = 1,
+												   .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+												   .descriptorCount = 1,
+												   .stageFlags = VK_SHADER_STAGE_VERTEX_BIT } };
+	VkDescriptorSetLayoutBinding reversedBindings[2] = { bindings[1], bindings[0] };
+	VkDescriptorSetLayoutCreateInfo setLayoutCreateInfo = { .sType =
+																VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+															.bindingCount = 2,
+															.pBindings = bindings };
+	VkDescriptorSetLayoutCreateInfo reversedSetLayoutCreateInfo = setLayoutCreateInfo;
+	reversedSetLayoutCreateInfo.pBindings = reversedBindings;
+	std::string setLayoutKey = descriptorSetLayoutKey(setLayoutCreateInfo);
+	testEqual(setLayoutKey, descriptorSetLayoutKey(reversedSetLayoutCreateInfo), "Binding order changed the key!");
+
+	bindings[0].pImmutableSamplers = &samplers[1];
+	testEqual(false, setLayoutKey == descriptorSetLayoutKey(setLayoutCreateInfo), "Different samplers match!");
+	bindings[0].pImmutableSamplers = nullptr;
+	testEqual(false, setLayoutKey == descriptorSetLayoutKey(setLayoutCreateInfo), "Missing samplers match!");
+	bindings[0].pImmutableSamplers = &samplers[0];
+	bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+	testEqual(false, setLayoutKey == descriptorSetLayoutKey(setLayoutCreateInfo), "Different stages match!");
+
+	VkDescriptorSetLayout setLayouts[2] = { fakeHandle<VkDescriptorSetLayout>(1),
+											fakeHandle<VkDescriptorSetLayout>(2) };
+	VkPushConstantRange pushConstantRange = { .stageFlags = VK_SHADER_STAGE_VERTEX_BIT, .offset = 0, .size = 64 };
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = { .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+															.setLayoutCount = 2,
+															.pSetLayouts = setLayouts,
+															.pushConstantRangeCount = 1,
+															.pPushConstantRanges = &pushConstantRange };
+	std::string layoutKey = pipelineLayoutKey(pipelineLayoutCreateInfo);
+	pipelineLayoutCreateInfo.setLayoutCount = 1;
+	testEqual(false, layoutKey == pipelineLayoutKey(pipelineLayoutCreateInfo), "Different set counts match!");
+	pipelineLayoutCreateInfo.setLayoutCount = 2;
+	pushConstantRange.size = 128;
+	testEqual(false, layoutKey == pipelineLayoutKey(pipelineLayoutCreateInfo), "Different push constants match!");
+
+	uint32_t code[2] = { 0x07230203, 0x00010000 };
+	uint32_t sameCode[2] = { 0x07230203, 0x00010000 };
+	VkShaderModuleCreateInfo moduleCreateInfo = { .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+												  .codeSize = sizeof(code),
+												  .pCode = code };
+	VkShaderModuleCreateInfo sameModuleCreateInfo = moduleCreateInfo;
+	sameModuleCreateInfo.pCode = sameCode;
+	testEqual(shaderModuleKey(moduleCreateInfo), shaderModuleKey(sameModuleCreateInfo), "Identical code differs!");
+	sameCode[1] = 0x00010300;
+	testEqual(false, shaderModuleKey(moduleCreateInfo) == shaderModuleKey(sameModuleCreateInfo),
+			  "Different code matches!");
+
+	// Keys point to the code instead of copying it, and only compare it if the hashes match
+	auto moduleKey = shaderModuleKey(moduleCreateInfo);
+	testEqual(true, moduleKey.pCode == code, "Key copied the code!");
+	auto collidingKey = shaderModuleKey(sameModuleCreateInfo);
+	collidingKey.codeHash = moduleKey.codeHash;
+	testEqual(false, moduleKey == collidingKey, "Colliding hashes of different code match!");
+
+	// Cached keys keep the code alive after its library is gone
+	auto ownedCode = std::make_shared<std::vector<uint32_t>>(code, code + 2);
+	VkShaderModuleCreateInfo ownedModuleCreateInfo = moduleCreateInfo;
+	ownedModuleCreateInfo.pCode = ownedCode->data();
+	auto ownedKey = shaderModuleKey(ownedModuleCreateInfo, ownedCode);
+	ownedCode.reset();
+	testEqual(true, moduleKey == ownedKey, "Owned code was released!");
+}
+
+void testPipelineObjectSharingCounts() {
+	auto fileData = variantLibrary();
+	VCPLibraryView view;
+	testEqual(true, view.open(fileData.data(), fileData.size()), "Library wasn't opened!");
+
+	FakeObjectTables tables;
+	FakeLibraryObjects firstLibrary;
+	firstLibrary.create(view, tables);
+	testEqual(size_t(3), firstLibrary.samplers.size(), "Wrong number of sampler references!");
+	testEqual(size_t(2), tables.samplers.size(), "Identical samplers weren't shared!");
+	testEqual(size_t(3), tables.descriptorSetLayouts.size(), "Identical set layouts weren't shared!");
+	testEqual(firstLibrary.setLayouts[0], firstLibrary.setLayouts[1], "Reordered set layout wasn't shared!");
+	testEqual(size_t(3), tables.pipelineLayouts.size(), "Identical pipeline layouts weren't shared!");
+	testEqual(firstLibrary.pipelineLayouts[0], firstLibrary.pipelineLayouts[1],
+			  "Archetypes with identical layouts use different layouts!");
+	testEqual(size_t(7), firstLibrary.shaderModules.size(), "Wrong number of shader module references!");
+	testEqual(size_t(4), tables.shaderModules.size(), "Identical shader modules weren't shared!");
+	testEqual(uint64_t(12), tables.createdCount, "Wrong number of created objects!");
+
+	// A second library with the same objects doesn't create any, and keeps them alive when the first one is destroyed
+	FakeLibraryObjects secondLibrary;
+	secondLibrary.create(view, tables);
+	testEqual(uint64_t(12), tables.createdCount, "Objects of the second library weren't shared!");
+	testEqual(firstLibrary.pipelineLayouts, secondLibrary.pipelineLayouts, "Libraries use different layouts!");
+	testEqual(6U, tables.shaderModules.referenceCount(firstLibrary.shaderModules[0]), "Wrong reference count!");
+
+	firstLibrary.destroy(tables);
+	testEqual(uint64_t(0), tables.destroyedCount, "Objects were destroyed while they were still used!");
+	testEqual(3U, tables.shaderModules.referenceCount(firstLibrary.shaderModules[0]), "Wrong reference count!");
+
+	secondLibrary.destroy(tables);
+	testEqual(uint64_t(12), tables.destroyedCount, "Not all objects were destroyed with their last user!");
+	testEqual(size_t(0), tables.samplers.size() + tables.descriptorSetLayouts.size() + tables.pipelineLayouts.size() +
+							 tables.shaderModules.size(),
+			  "Destroyed objects are still in the tables!");
+}
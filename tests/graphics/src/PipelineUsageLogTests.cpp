@@ -0,0 +1,33 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <graphics/util/PipelineUsageLog.hpp>
+
+using namespace vanadium::graphics;
+
+void testPipelineUsageLogRoundTrip() {
+	std::vector<PipelineUsageEntry> entries = { { .instanceName = "UI Rect", .signatureHash = 0x1234ABCD5678EF90ULL },
+												{ .instanceName = "Tonemap", .signatureHash = 0 },
+												{ .instanceName = "UI Rect", .signatureHash = ~0ULL } };
+	auto text = serializePipelineUsage(entries);
+	testEqual(entries, parsePipelineUsage(text), "Entries changed!");
+	testEqual(true, parsePipelineUsage(serializePipelineUsage({})).empty(), "Empty log has entries!");
+}
+
+void testPipelineUsageLogMalformed() {
+	std::string text = std::string(pipelineUsageLogHeader) + "\r\n"
+															 "ff UI Text\r\n"
+															 "\n"
+															 "nothex Skipped\n"
+															 "12\n"
+															 "1ffffffffffffffff Overflow\n"
+															 " Missing hash\n"
+															 "a Last line without newline";
+	std::vector<PipelineUsageEntry> expected = { { .instanceName = "UI Text", .signatureHash = 0xFF },
+												 { .instanceName = "Last line without newline",
+												   .signatureHash = 0xA } };
+	testEqual(expected, parsePipelineUsage(text), "Malformed lines weren't skipped!");
+
+	testEqual(true, parsePipelineUsage("vanadium-pipeline-usage 2\nff UI Text\n").empty(),
+			  "Log of another version was used!");
+	testEqual(true, parsePipelineUsage("").empty(), "Empty file has entries!");
+}
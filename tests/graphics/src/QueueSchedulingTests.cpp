@@ -0,0 +1,112 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <algorithm>
+#include <graphics/util/QueueScheduling.hpp>
+
+using namespace vanadium::graphics;
+
+namespace {
+	constexpr FramegraphQueue graphics = FramegraphQueue::Graphics;
+	constexpr FramegraphQueue compute = FramegraphQueue::AsyncCompute;
+
+	bool hasDependency(const QueueSchedule& schedule, size_t srcBatchIndex, size_t dstBatchIndex, bool crossesFrame) {
+		QueueBatchDependency dependency = { .srcBatchIndex = srcBatchIndex,
+											.dstBatchIndex = dstBatchIndex,
+											.crossesFrame = crossesFrame };
+		return std::find(schedule.dependencies.begin(), schedule.dependencies.end(), dependency) !=
+			   schedule.dependencies.end();
+	}
+
+	bool hasTransfer(const QueueSchedule& schedule, size_t resourceIndex, size_t srcNodeIndex, size_t dstNodeIndex,
+					 bool crossesFrame) {
+		return std::any_of(schedule.ownershipTransfers.begin(), schedule.ownershipTransfers.end(),
+						   [=](const auto& transfer) {
+							   return transfer.resourceIndex == resourceIndex &&
+									  transfer.srcNodeIndex == srcNodeIndex && transfer.dstNodeIndex == dstNodeIndex &&
+									  transfer.crossesFrame == crossesFrame;
+						   });
+	}
+} // namespace
+
+void testQueueSchedulingBatches() {
+	auto schedule = planQueueSchedule({ graphics, compute, compute, graphics, graphics, compute }, {});
+	testEqual(size_t(4), schedule.batches.size(), "Wrong number of batches!");
+	size_t expectedFirstNodeIndices[] = { 0, 1, 3, 5 };
+	size_t expectedNodeCounts[] = { 1, 2, 2, 1 };
+	FramegraphQueue expectedQueues[] = { graphics, compute, graphics, compute };
+	for (size_t i = 0; i < 4; ++i) {
+		testEqual(expectedFirstNodeIndices[i], schedule.batches[i].firstNodeIndex, "Batch starts at the wrong node!");
+		testEqual(expectedNodeCounts[i], schedule.batches[i].nodeCount, "Batch has the wrong number of nodes!");
+		testEqual(true, expectedQueues[i] == schedule.batches[i].queue, "Batch runs on the wrong queue!");
+	}
+	testEqual(size_t(1), schedule.batchIndex(2), "Node is in the wrong batch!");
+	testEqual(size_t(3), schedule.batchIndex(5), "Node is in the wrong batch!");
+	testEqual(size_t(0), schedule.dependencies.size(), "Batches without shared resources depend on each other!");
+
+	// The graphics queue always gets a batch to start and present the frame
+	auto computeSchedule = planQueueSchedule({ compute, compute }, {});
+	testEqual(size_t(2), computeSchedule.batches.size(), "No graphics batch was added!");
+	testEqual(true, computeSchedule.batches[1].queue == graphics, "Added batch doesn't run on the graphics queue!");
+	testEqual(size_t(2), computeSchedule.batches[1].firstNodeIndex, "Added batch isn't at the end of the frame!");
+	testEqual(size_t(0), computeSchedule.batches[1].nodeCount, "Added batch contains nodes!");
+
+	auto emptySchedule = planQueueSchedule({}, {});
+	testEqual(size_t(1), emptySchedule.batches.size(), "Frame without nodes has no graphics batch!");
+}
+
+// A compute pass producing a LUT that is read by a later graphics pass, while an unrelated graphics pass in between
+// overlaps with it
+void testQueueSchedulingDependencies() {
+	std::vector<FramegraphQueue> nodeQueues = { graphics, compute, graphics, graphics };
+	std::vector<QueueScheduledResource> resources = {
+		// Written by the compute node, read by the last graphics node
+		{ .accessingNodeIndices = { 1, 3 }, .preservesContents = false },
+		// Only used on the graphics queue
+		{ .accessingNodeIndices = { 0, 2, 3 }, .preservesContents = true },
+		// Read by the compute node, written by the first graphics node
+		{ .accessingNodeIndices = { 0, 1 }, .preservesContents = false },
+	};
+	auto schedule = planQueueSchedule(nodeQueues, resources);
+	testEqual(size_t(3), schedule.batches.size(), "Wrong number of batches!");
+
+	testEqual(true, hasDependency(schedule, 1, 2, false), "Graphics batch doesn't wait for the compute batch!");
+	testEqual(true, hasDependency(schedule, 0, 1, false), "Compute batch doesn't wait for its input!");
+	// Both resources used on two queues have to be done with the previous frame before the next frame uses them
+	testEqual(true, hasDependency(schedule, 2, 1, true), "Compute batch doesn't wait for the previous frame!");
+	testEqual(true, hasDependency(schedule, 1, 0, true), "Graphics batch doesn't wait for the previous frame!");
+	testEqual(size_t(4), schedule.dependencies.size(), "Unneeded dependencies were added!");
+
+	testEqual(true, hasTransfer(schedule, 0, 1, 3, false), "Ownership of the LUT isn't transferred!");
+	testEqual(true, hasTransfer(schedule, 2, 0, 1, false), "Ownership of the compute input isn't transferred!");
+	testEqual(size_t(2), schedule.ownershipTransfers.size(), "Unneeded ownership transfers were added!");
+
+	for (size_t i = 1; i < schedule.dependencies.size(); ++i) {
+		testLessEqual(schedule.dependencies[i - 1].dstBatchIndex, schedule.dependencies[i].dstBatchIndex,
+					  "Dependencies aren't sorted by the waiting batch!");
+	}
+}
+
+// Resources keeping their contents across frames are handed back to the queue using them first
+void testQueueSchedulingOwnershipAcrossFrames() {
+	std::vector<FramegraphQueue> nodeQueues = { compute, graphics, compute, graphics };
+	std::vector<QueueScheduledResource> resources = {
+		{ .accessingNodeIndices = { 0, 1, 3 }, .preservesContents = true },
+		{ .accessingNodeIndices = { 2, 3 }, .preservesContents = false },
+		// Only accessed by one node, there is nothing to transfer
+		{ .accessingNodeIndices = { 2 }, .preservesContents = true },
+		{ .accessingNodeIndices = {}, .preservesContents = true },
+	};
+	auto schedule = planQueueSchedule(nodeQueues, resources);
+
+	testEqual(true, hasTransfer(schedule, 0, 0, 1, false), "Ownership isn't transferred to the graphics queue!");
+	testEqual(true, hasTransfer(schedule, 0, 3, 0, true), "Ownership isn't returned for the next frame!");
+	testEqual(true, hasTransfer(schedule, 1, 2, 3, false), "Ownership isn't transferred to the graphics queue!");
+	testEqual(false, hasTransfer(schedule, 1, 3, 2, true), "Discarded contents were transferred to the next frame!");
+	testEqual(size_t(3), schedule.ownershipTransfers.size(), "Unneeded ownership transfers were added!");
+
+	testEqual(true, hasDependency(schedule, 3, 0, true), "First batch doesn't wait for the previous frame!");
+	testEqual(true, hasDependency(schedule, 3, 2, true), "Overwriting batch doesn't wait for the previous frame!");
+	testEqual(true, hasDependency(schedule, 0, 1, false), "Graphics batch doesn't wait for the compute batch!");
+	testEqual(true, hasDependency(schedule, 2, 3, false), "Graphics batch doesn't wait for the compute batch!");
+	testEqual(size_t(4), schedule.dependencies.size(), "Unneeded dependencies were added!");
+}
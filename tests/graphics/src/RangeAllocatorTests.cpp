@@ -0,0 +1,190 @@
+#include <LegacyRangeAllocator.hpp>
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <graphics/util/RangeAllocator.hpp>
+#include <random>
+
+using namespace vanadium::graphics;
+
+namespace {
+	constexpr VkDeviceSize fuzzBlockSize = 4 * 1024 * 1024;
+	constexpr size_t fuzzOperationCount = 20000;
+
+	// Checks that free ranges and live allocations exactly cover the block without overlapping, and that no two free
+	// ranges are adjacent.
+	void validateRanges(const std::vector<MemoryRange>& freeRanges, std::vector<MemoryRange> liveAllocations) {
+		std::vector<MemoryRange> ranges = std::move(liveAllocations);
+		ranges.insert(ranges.end(), freeRanges.begin(), freeRanges.end());
+		std::sort(ranges.begin(), ranges.end(),
+				  [](const auto& one, const auto& other) { return one.offset < other.offset; });
+
+		VkDeviceSize expectedOffset = 0;
+		for (auto& range : ranges) {
+			testEqual(expectedOffset, range.offset, "Ranges overlap or leave a gap!");
+			expectedOffset += range.size;
+		}
+		testEqual(fuzzBlockSize, expectedOffset, "Ranges don't cover the whole block!");
+
+		for (size_t i = 1; i < freeRanges.size(); ++i) {
+			testNotEqual(freeRanges[i - 1].offset + freeRanges[i - 1].size, freeRanges[i].offset,
+						 "Adjacent free ranges weren't merged!");
+		}
+	}
+
+	std::vector<MemoryRange> freeRanges(const RangeAllocator& allocator) {
+		std::vector<MemoryRange> ranges;
+		for (auto& [offset, size] : allocator.offsetSortedRanges()) {
+			ranges.push_back({ .offset = offset, .size = size });
+		}
+		return ranges;
+	}
+} // namespace
+
+void testRangeAllocatorBestFit() {
+	RangeAllocator allocator = RangeAllocator(0, 1000);
+	// Carve out free ranges of size 100, 50 and 200 separated by live allocations
+	std::vector<RangeAllocationResult> allocations;
+	for (VkDeviceSize size : { 100, 10, 50, 10, 200, 10 }) {
+		allocations.push_back(allocator.allocate(1, size).value());
+	}
+	allocator.free(allocations[0].allocationRange.offset, allocations[0].allocationRange.size);
+	allocator.free(allocations[2].allocationRange.offset, allocations[2].allocationRange.size);
+	allocator.free(allocations[4].allocationRange.offset, allocations[4].allocationRange.size);
+	testEqual(size_t(4), allocator.freeRangeCount(), "Free range count doesn't match!");
+
+	auto result = allocator.allocate(1, 40);
+	testEqual(true, result.has_value(), "Allocation failed!");
+	testEqual(VkDeviceSize(110), result->usableRange.offset, "Allocation didn't use the best-fitting range!");
+
+	result = allocator.allocate(1, 60);
+	testEqual(true, result.has_value(), "Allocation failed!");
+	testEqual(VkDeviceSize(0), result->usableRange.offset, "Allocation didn't use the best-fitting range!");
+
+	testEqual(VkDeviceSize(620), allocator.maxAllocatableSize(), "Largest free range doesn't match!");
+	testEqual(false, allocator.allocate(1, 621).has_value(), "Allocation larger than any free range succeeded!");
+}
+
+void testRangeAllocatorCoalescing() {
+	RangeAllocator allocator = RangeAllocator(0, 300);
+	auto first = allocator.allocate(1, 100).value();
+	auto second = allocator.allocate(1, 100).value();
+	auto third = allocator.allocate(1, 100).value();
+	testEqual(size_t(0), allocator.freeRangeCount(), "Fully allocated block has free ranges!");
+
+	allocator.free(first.allocationRange.offset, first.allocationRange.size);
+	allocator.free(third.allocationRange.offset, third.allocationRange.size);
+	testEqual(size_t(2), allocator.freeRangeCount(), "Non-adjacent free ranges were merged!");
+
+	// merges with both neighbours
+	allocator.free(second.allocationRange.offset, second.allocationRange.size);
+	testEqual(size_t(1), allocator.freeRangeCount(), "Free ranges weren't merged!");
+	testEqual(VkDeviceSize(300), allocator.maxAllocatableSize(), "Merged free range has wrong size!");
+	testEqual(VkDeviceSize(300), allocator.freeSize(), "Free size doesn't match!");
+}
+
+void testRangeAllocatorAlignment() {
+	RangeAllocator allocator = RangeAllocator(0, 1024);
+	allocator.allocate(1, 1);
+	auto unaligned = allocator.allocate(1, 3).value();
+
+	auto result = allocator.allocate(256, 16).value();
+	testEqual(VkDeviceSize(256), result.usableRange.offset, "Usable range isn't aligned!");
+	testEqual(VkDeviceSize(4), result.allocationRange.offset, "Allocation range doesn't include the margin!");
+	testEqual(VkDeviceSize(268), result.allocationRange.size, "Allocation range doesn't include the margin!");
+
+	// The 3-byte range at offset 1 would be the best fit without alignment
+	allocator.free(unaligned.allocationRange.offset, unaligned.allocationRange.size);
+	result = allocator.allocate(4, 3).value();
+	testEqual(VkDeviceSize(272), result.usableRange.offset, "Allocation used a range that's too small to align!");
+}
+
+// Runs the same random sequence of allocations and frees through RangeAllocator and the old sorted-vector functions.
+// Tie-breaking between equally sized ranges differs, so the layouts diverge; instead of comparing offsets, both
+// implementations have to keep the same invariants after every operation and return to a single free range once
+// everything is freed.
+void testRangeAllocatorFuzz() {
+	std::mt19937_64 generator(0xBADC0FFEE);
+	std::uniform_int_distribution<VkDeviceSize> sizeDistribution(1, 8192);
+	std::uniform_int_distribution<size_t> alignmentIndexDistribution(0, 4);
+	std::uniform_int_distribution<int> operationDistribution(0, 99);
+	constexpr VkDeviceSize alignments[] = { 0, 1, 4, 64, 256 };
+
+	RangeAllocator allocator = RangeAllocator(0, fuzzBlockSize);
+	std::vector<RangeAllocationResult> allocations;
+
+	std::vector<MemoryRange> legacyOffsetSorted = { { .offset = 0, .size = fuzzBlockSize } };
+	std::vector<MemoryRange> legacySizeSorted = legacyOffsetSorted;
+	std::vector<RangeAllocationResult> legacyAllocations;
+
+	size_t successfulAllocationCount = 0;
+	for (size_t i = 0; i < fuzzOperationCount; ++i) {
+		// Slightly favour allocations so the block fills up and failing allocations are exercised
+		bool allocate = operationDistribution(generator) < 55 || allocations.empty() || legacyAllocations.empty();
+		if (allocate) {
+			VkDeviceSize alignment = alignments[alignmentIndexDistribution(generator)];
+			VkDeviceSize size = sizeDistribution(generator);
+
+			auto result = allocator.allocate(alignment, size);
+			if (result.has_value()) {
+				testEqual(VkDeviceSize(0), alignmentMargin(result->usableRange.offset, alignment),
+						  "Usable range isn't aligned!");
+				testEqual(size, result->usableRange.size, "Usable range has wrong size!");
+				allocations.push_back(*result);
+				++successfulAllocationCount;
+			} else {
+				// Failing is only allowed if no free range is guaranteed to fit
+				VkDeviceSize maxMargin = alignment ? alignment - 1 : 0;
+				testLess(allocator.maxAllocatableSize(), size + maxMargin,
+						 "Allocation failed even though a free range fits!");
+			}
+
+			auto legacyResult =
+				legacy::allocateFromRanges(legacyOffsetSorted, legacySizeSorted, alignment, size);
+			if (legacyResult.has_value()) {
+				legacyAllocations.push_back(*legacyResult);
+			}
+		} else {
+			std::uniform_int_distribution<size_t> indexDistribution(0, allocations.size() - 1);
+			size_t index = indexDistribution(generator);
+			allocator.free(allocations[index].allocationRange.offset, allocations[index].allocationRange.size);
+			allocations.erase(allocations.begin() + index);
+
+			std::uniform_int_distribution<size_t> legacyIndexDistribution(0, legacyAllocations.size() - 1);
+			size_t legacyIndex = legacyIndexDistribution(generator);
+			legacy::freeToRanges(legacyOffsetSorted, legacySizeSorted,
+								 legacyAllocations[legacyIndex].allocationRange.offset,
+								 legacyAllocations[legacyIndex].allocationRange.size);
+			legacyAllocations.erase(legacyAllocations.begin() + legacyIndex);
+		}
+
+		std::vector<MemoryRange> liveRanges;
+		for (auto& allocation : allocations) {
+			liveRanges.push_back(allocation.allocationRange);
+		}
+		validateRanges(freeRanges(allocator), liveRanges);
+
+		VkDeviceSize liveSize = 0;
+		for (auto& range : liveRanges) {
+			liveSize += range.size;
+		}
+		testEqual(fuzzBlockSize - liveSize, allocator.freeSize(), "Free size doesn't match live allocations!");
+
+		std::vector<MemoryRange> legacyLiveRanges;
+		for (auto& allocation : legacyAllocations) {
+			legacyLiveRanges.push_back(allocation.allocationRange);
+		}
+		validateRanges(legacyOffsetSorted, legacyLiveRanges);
+	}
+	testGreater(successfulAllocationCount, fuzzOperationCount / 4, "Too few allocations succeeded to be meaningful!");
+
+	for (auto& allocation : allocations) {
+		allocator.free(allocation.allocationRange.offset, allocation.allocationRange.size);
+	}
+	for (auto& allocation : legacyAllocations) {
+		legacy::freeToRanges(legacyOffsetSorted, legacySizeSorted, allocation.allocationRange.offset,
+							 allocation.allocationRange.size);
+	}
+	testEqual(size_t(1), allocator.freeRangeCount(), "Freeing everything didn't merge all ranges!");
+	testEqual(legacyOffsetSorted.size(), allocator.freeRangeCount(), "Final range count differs from legacy!");
+	testEqual(legacyOffsetSorted[0].size, allocator.maxAllocatableSize(), "Final range size differs from legacy!");
+}
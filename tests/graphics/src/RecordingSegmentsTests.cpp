@@ -0,0 +1,41 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <graphics/util/RecordingSegments.hpp>
+
+using namespace vanadium::graphics;
+
+namespace {
+	void testSegment(const RecordingSegment& segment, size_t firstNodeIndex, size_t nodeCount, bool isParallel) {
+		testEqual(firstNodeIndex, segment.firstNodeIndex, "Segment starts at the wrong node!");
+		testEqual(nodeCount, segment.nodeCount, "Segment has the wrong number of nodes!");
+		testEqual(isParallel, segment.isParallel, "Segment is recorded on the wrong thread!");
+	}
+} // namespace
+
+void testRecordingSegmentsOrder() {
+	auto segments = planRecordingSegments({ false, false, true, true, false, true });
+	testEqual(size_t(5), segments.size(), "Wrong number of segments!");
+	testSegment(segments[0], 0, 2, false);
+	testSegment(segments[1], 2, 1, true);
+	testSegment(segments[2], 3, 1, true);
+	testSegment(segments[3], 4, 1, false);
+	testSegment(segments[4], 5, 1, true);
+
+	// Segments cover every node exactly once, in execution order
+	size_t nextNodeIndex = 0;
+	for (auto& segment : segments) {
+		testEqual(nextNodeIndex, segment.firstNodeIndex, "Segments don't cover the nodes in order!");
+		nextNodeIndex += segment.nodeCount;
+	}
+	testEqual(size_t(6), nextNodeIndex, "Segments don't cover all nodes!");
+
+	auto serialSegments = planRecordingSegments({ false, false, false });
+	testEqual(size_t(1), serialSegments.size(), "Serial nodes don't share a segment!");
+	testSegment(serialSegments[0], 0, 3, false);
+}
+
+void testRecordingSegmentsEmpty() {
+	auto segments = planRecordingSegments({});
+	testEqual(size_t(1), segments.size(), "Frame without nodes has no command buffer!");
+	testSegment(segments[0], 0, 0, false);
+}
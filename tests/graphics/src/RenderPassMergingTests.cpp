@@ -0,0 +1,156 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <graphics/util/RenderPassMerging.hpp>
+#include <algorithm>
+
+using namespace vanadium::graphics;
+
+namespace {
+	enum Resource : uint64_t { Albedo, Normal, Depth, HDR, Target, Shadow, Histogram };
+
+	RasterAttachmentUsage attachment(uint64_t resource, VkAttachmentLoadOp loadOp, VkAttachmentStoreOp storeOp,
+									 VkImageLayout layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL) {
+		return { .resource = resource,
+				 .format = resource == Depth ? VK_FORMAT_D32_SFLOAT : VK_FORMAT_R16G16B16A16_SFLOAT,
+				 .sampleCount = VK_SAMPLE_COUNT_1_BIT,
+				 .loadOp = loadOp,
+				 .storeOp = storeOp,
+				 .layout = layout };
+	}
+
+	RasterNodeUsage rasterNode(std::vector<RasterAttachmentUsage> colorAttachments) {
+		return { .isRaster = true, .width = 1280, .height = 720, .colorAttachments = std::move(colorAttachments) };
+	}
+
+	bool referencesAttachment(const std::vector<VkAttachmentReference>& references, uint32_t attachmentIndex,
+							  VkImageLayout layout) {
+		return std::any_of(references.begin(), references.end(), [attachmentIndex, layout](const auto& reference) {
+			return reference.attachment == attachmentIndex && reference.layout == layout;
+		});
+	}
+} // namespace
+
+// A G-buffer pass whose attachments are read as input attachments by the lighting pass stays in tile memory. The
+// tonemapping pass samples the lighting result, so it needs a render pass of its own.
+void testRenderPassMergingDeferred() {
+	auto gBufferNode = rasterNode({ attachment(Albedo, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE),
+									attachment(Normal, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE) });
+	gBufferNode.depthStencilAttachment = attachment(Depth, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE,
+													VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+	gBufferNode.readResources = { Shadow };
+
+	auto lightingNode = rasterNode({ attachment(HDR, VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_ATTACHMENT_STORE_OP_STORE) });
+	lightingNode.inputAttachments = {
+		attachment(Albedo, VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_DONT_CARE,
+				   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+		attachment(Normal, VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_DONT_CARE,
+				   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+		attachment(Depth, VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_DONT_CARE,
+				   VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL),
+	};
+	// Reading the shadow map like the G-buffer pass doesn't conflict
+	lightingNode.readResources = { Shadow };
+
+	auto tonemappingNode = rasterNode({ attachment(Target, VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+												   VK_ATTACHMENT_STORE_OP_STORE) });
+	tonemappingNode.readResources = { HDR };
+
+	auto renderPasses = planRenderPassMerges({ gBufferNode, lightingNode, tonemappingNode }, {});
+	testEqual(size_t(2), renderPasses.size(), "Wrong number of render passes!");
+
+	auto& mergedPass = renderPasses[0];
+	testEqual(size_t(2), mergedPass.subpasses.size(), "Lighting wasn't merged into the G-buffer render pass!");
+	testEqual(size_t(4), mergedPass.attachments.size(), "Wrong number of merged attachments!");
+	testEqual(size_t(1), mergedPass.subpasses[1].nodeIndex, "Subpass has the wrong node!");
+
+	auto& albedo = mergedPass.attachments[0];
+	testEqual(true,
+			  albedo.loadOp == VK_ATTACHMENT_LOAD_OP_CLEAR && albedo.storeOp == VK_ATTACHMENT_STORE_OP_DONT_CARE,
+			  "Attachment doesn't use the first load and last store operation!");
+	testEqual(true,
+			  albedo.initialLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL &&
+				  albedo.finalLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			  "Attachment doesn't use the first and last layout!");
+	testEqual(uint32_t(2), mergedPass.subpasses[0].depthStencilAttachment.attachment,
+			  "Depth attachment has the wrong index!");
+
+	auto& lightingSubpass = mergedPass.subpasses[1];
+	testEqual(size_t(3), lightingSubpass.inputAttachments.size(), "Wrong number of input attachments!");
+	testEqual(true, referencesAttachment(lightingSubpass.inputAttachments, 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+			  "Input attachment has the wrong index or layout!");
+	testEqual(true,
+			  referencesAttachment(lightingSubpass.colorAttachments, 3, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL),
+			  "Color attachment has the wrong index or layout!");
+	testEqual(VK_ATTACHMENT_UNUSED, lightingSubpass.depthStencilAttachment.attachment,
+			  "Subpass without depth attachment has one!");
+
+	testEqual(size_t(1), renderPasses[1].subpasses.size(), "Tonemapping was merged!");
+	testEqual(size_t(2), renderPasses[1].subpasses[0].nodeIndex, "Render pass has the wrong node!");
+}
+
+void testRenderPassMergingBlockers() {
+	auto baseNode = rasterNode({ attachment(HDR, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE) });
+	auto blendNode = rasterNode({ attachment(HDR, VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_STORE) });
+	auto subpassCount = [](const std::vector<MergedRenderPass>& renderPasses) {
+		std::vector<size_t> counts;
+		for (auto& renderPass : renderPasses) {
+			counts.push_back(renderPass.subpasses.size());
+		}
+		return counts;
+	};
+
+	testEqual(std::vector<size_t>{ 2 }, subpassCount(planRenderPassMerges({ baseNode, blendNode }, {})),
+			  "Nodes blending into the same attachment weren't merged!");
+
+	// A compute pass in between can only be skipped if it is culled
+	RasterNodeUsage computeNode = { .writtenResources = { Histogram } };
+	testEqual(std::vector<size_t>{ 1, 1 },
+			  subpassCount(planRenderPassMerges({ baseNode, computeNode, blendNode }, {})),
+			  "Nodes were merged across a compute node!");
+	testEqual(std::vector<size_t>{ 2 },
+			  subpassCount(planRenderPassMerges({ baseNode, computeNode, blendNode }, { false, true, false })),
+			  "Nodes weren't merged across a culled node!");
+
+	auto clearingNode = rasterNode({ attachment(HDR, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE) });
+	testEqual(std::vector<size_t>{ 1, 1 }, subpassCount(planRenderPassMerges({ baseNode, clearingNode }, {})),
+			  "Node clearing a merged attachment was merged!");
+
+	auto smallerNode = blendNode;
+	smallerNode.width = 640;
+	testEqual(std::vector<size_t>{ 1, 1 }, subpassCount(planRenderPassMerges({ baseNode, smallerNode }, {})),
+			  "Nodes with different extents were merged!");
+
+	auto parallelNode = blendNode;
+	parallelNode.canMerge = false;
+	testEqual(std::vector<size_t>{ 1, 1 }, subpassCount(planRenderPassMerges({ baseNode, parallelNode }, {})),
+			  "Node recording in parallel was merged!");
+
+	auto unrelatedNode = rasterNode({ attachment(Target, VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_STORE) });
+	testEqual(std::vector<size_t>{ 1, 1 }, subpassCount(planRenderPassMerges({ baseNode, unrelatedNode }, {})),
+			  "Nodes without shared attachments were merged!");
+
+	// Rendering into an image that an earlier subpass samples would transition it too early
+	auto samplingNode = baseNode;
+	samplingNode.readResources = { Target };
+	auto targetNode = rasterNode({ attachment(HDR, VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_STORE),
+								   attachment(Target, VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_STORE) });
+	testEqual(std::vector<size_t>{ 1, 1 }, subpassCount(planRenderPassMerges({ samplingNode, targetNode }, {})),
+			  "Node rendering into a sampled image was merged!");
+}
+
+// Attachments used before and after a subpass that doesn't use them have to be preserved
+void testRenderPassMergingPreserve() {
+	auto firstNode = rasterNode({ attachment(HDR, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE),
+								  attachment(Normal, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE) });
+	auto secondNode = rasterNode({ attachment(HDR, VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_STORE) });
+	auto thirdNode = rasterNode({ attachment(HDR, VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_STORE) });
+	thirdNode.inputAttachments = { attachment(Normal, VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_DONT_CARE,
+											  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) };
+
+	auto renderPasses = planRenderPassMerges({ firstNode, secondNode, thirdNode }, {});
+	testEqual(size_t(1), renderPasses.size(), "Nodes weren't merged!");
+	auto& subpasses = renderPasses[0].subpasses;
+	testEqual(true, subpasses[0].preserveAttachments.empty() && subpasses[2].preserveAttachments.empty(),
+			  "Subpasses using all attachments preserve attachments!");
+	testEqual(std::vector<uint32_t>{ 1 }, subpasses[1].preserveAttachments, "Unused attachment isn't preserved!");
+}
@@ -0,0 +1,135 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <ShaderCache.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+	// Shaders, cache and invocation log of the fake compiler in a fresh directory, removed again at the end of the test
+	struct ShaderCacheTestDirectory {
+		ShaderCacheTestDirectory(const std::string& name)
+			: root(std::filesystem::temp_directory_path() / ("vanadium-shader-cache-" + name)) {
+			std::filesystem::remove_all(root);
+			std::filesystem::create_directories(root);
+		}
+		~ShaderCacheTestDirectory() { std::filesystem::remove_all(root); }
+
+		std::string write(const std::string& name, const std::string& text) {
+			auto filePath = root / name;
+			std::filesystem::create_directories(filePath.parent_path());
+			auto stream = std::ofstream(filePath, std::ios::binary | std::ios::trunc);
+			stream << text;
+			return filePath.string();
+		}
+
+		ShaderCache cache(std::vector<std::string> args = {}) {
+			args.push_back("--invocation-log");
+			args.push_back((root / "invocations.log").string());
+			return ShaderCache(root / "cache", FAKE_SHADER_COMPILER_PATH, args);
+		}
+
+		size_t invocationCount() {
+			auto stream = std::ifstream(root / "invocations.log");
+			return std::count(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>(), '\n');
+		}
+
+		size_t entryCount() {
+			return std::distance(std::filesystem::directory_iterator(root / "cache"),
+								 std::filesystem::directory_iterator());
+		}
+
+		std::filesystem::path root;
+	};
+} // namespace
+
+void testShaderCacheReuse() {
+	ShaderCacheTestDirectory directory = ShaderCacheTestDirectory("reuse");
+	directory.write("common.glsl", "float common;\n");
+	std::vector<std::string> sources = { directory.write("a.vert", "#include \"common.glsl\"\nvoid main() {}\n"),
+										 directory.write("b.frag", "void main() {}\n") };
+
+	auto results = directory.cache().compile(sources, 4);
+	testEqual(size_t(2), directory.invocationCount(), "Wrong number of compilations!");
+	testEqual(true, results[0].succeeded && results[1].succeeded, "Compilation failed!");
+	testEqual(false, results[0].wasCached || results[1].wasCached, "Result of the first run was cached!");
+	testEqual(std::string("void main() {}\n"), std::string(results[1].code.begin(), results[1].code.end()),
+			  "Compiled code is wrong!");
+
+	// A new cache object stands in for the next run of vcp
+	auto cache = directory.cache();
+	auto cachedResults = cache.compile(sources, 4);
+	testEqual(size_t(2), directory.invocationCount(), "Unchanged shaders were compiled again!");
+	testEqual(size_t(2), cache.hitCount(), "Wrong number of cache hits!");
+	testEqual(size_t(0), cache.missCount(), "Wrong number of cache misses!");
+	testEqual(true, cachedResults[0].wasCached && cachedResults[1].wasCached, "Results weren't cached!");
+	testEqual(results[0].code, cachedResults[0].code, "Cached code differs!");
+	testEqual(results[1].code, cachedResults[1].code, "Cached code differs!");
+}
+
+void testShaderCacheInvalidation() {
+	ShaderCacheTestDirectory directory = ShaderCacheTestDirectory("invalidation");
+	directory.write("common.glsl", "float common;\n");
+	directory.write("lib/lighting.glsl", "#include \"../common.glsl\"\nfloat lighting;\n");
+	std::vector<std::string> sources = {
+		directory.write("a.vert", "#include \"common.glsl\"\nvoid main() {}\n"),
+		directory.write("b.frag", "  #  include <lighting.glsl>\nvoid main() {}\n"),
+		directory.write("c.comp", "#include \"generated.glsl\"\nvoid main() {}\n")
+	};
+	std::vector<std::string> args = { "-I", (directory.root / "lib").string() };
+
+	directory.cache(args).compile(sources, 4);
+	testEqual(size_t(3), directory.invocationCount(), "Wrong number of compilations!");
+
+	// Reached from a.vert directly and from b.frag through the include directory and a nested include
+	directory.write("common.glsl", "float common = 1.0;\n");
+	directory.cache(args).compile(sources, 4);
+	testEqual(size_t(5), directory.invocationCount(), "Changed include didn't invalidate its includers!");
+
+	// Creating a file that couldn't be included before can change the result as well
+	directory.write("generated.glsl", "float generated;\n");
+	directory.cache(args).compile(sources, 4);
+	testEqual(size_t(6), directory.invocationCount(), "Resolving an include didn't invalidate the shader!");
+
+	directory.write("a.vert", "#include \"common.glsl\"\nvoid main() { }\n");
+	directory.cache(args).compile(sources, 4);
+	testEqual(size_t(7), directory.invocationCount(), "Changed source didn't invalidate only itself!");
+
+	args.push_back("-DSHADOWS=1");
+	auto results = directory.cache(args).compile(sources, 4);
+	testEqual(size_t(10), directory.invocationCount(), "Changed defines didn't invalidate all shaders!");
+	std::string code = std::string(results[0].code.begin(), results[0].code.end());
+	testEqual(true, code.ends_with("-DSHADOWS=1"), "Compiler arguments weren't passed!");
+}
+
+void testShaderCacheFailures() {
+	ShaderCacheTestDirectory directory = ShaderCacheTestDirectory("failures");
+	std::string validSource = directory.write("valid.vert", "void main() {}\n");
+	std::string invalidSource = directory.write("invalid.frag", "#error\n");
+
+	// The same source twice is only compiled once
+	auto cache = directory.cache();
+	auto results = cache.compile({ validSource, invalidSource, validSource }, 4);
+	testEqual(size_t(2), directory.invocationCount(), "Duplicate source was compiled twice!");
+	testEqual(true, results[0].succeeded && results[2].succeeded, "Valid shader failed to compile!");
+	testEqual(results[0].code, results[2].code, "Duplicate source has different results!");
+	testEqual(false, results[1].succeeded, "Invalid shader compiled!");
+	testEqual(size_t(1), directory.entryCount(), "Failed compilation left an entry behind!");
+
+	auto retriedResults = directory.cache().compile({ invalidSource }, 0);
+	testEqual(size_t(3), directory.invocationCount(), "Failed compilation was cached!");
+	testEqual(false, retriedResults[0].succeeded, "Invalid shader compiled!");
+
+	// Only entries used by this cache object are kept
+	std::string otherSource = directory.write("other.comp", "void main() {}\n");
+	directory.cache().compile({ otherSource }, 1);
+	testEqual(size_t(2), directory.entryCount(), "Wrong number of cache entries!");
+	auto pruningCache = directory.cache();
+	pruningCache.compile({ otherSource }, 1);
+	pruningCache.removeUnusedEntries();
+	testEqual(size_t(1), directory.entryCount(), "Unused entries weren't removed!");
+	testEqual(true, pruningCache.compile({ otherSource }, 1)[0].wasCached, "Used entry was removed!");
+}
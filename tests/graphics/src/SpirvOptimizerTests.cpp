@@ -0,0 +1,151 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <SpirvOptimizer.hpp>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+	void addInstruction(std::vector<uint32_t>& code, uint32_t opcode, std::vector<uint32_t> operands) {
+		code.push_back(static_cast<uint32_t>(operands.size() + 1) << 16 | opcode);
+		code.insert(code.end(), operands.begin(), operands.end());
+	}
+
+	// NUL-terminated and padded to whole words
+	std::vector<uint32_t> stringWords(const std::string& string) {
+		std::vector<uint32_t> words = std::vector<uint32_t>(string.size() / sizeof(uint32_t) + 1, 0);
+		std::memcpy(words.data(), string.data(), string.size());
+		return words;
+	}
+
+	std::vector<uint32_t> concat(std::vector<uint32_t> first, const std::vector<uint32_t>& second) {
+		first.insert(first.end(), second.begin(), second.end());
+		return first;
+	}
+
+	// A compute shader like glslc -g writes it, with three specialization constants (IDs 0 and 1 are integers, 2 is
+	// a boolean), source information and a non-semantic debug instruction
+	std::vector<uint32_t> testModule() {
+		std::vector<uint32_t> code = { 0x07230203, 0x00010000, 0, 14, 0 };
+		addInstruction(code, 17, { 1 });
+		addInstruction(code, 10, stringWords("SPV_KHR_non_semantic_info"));
+		addInstruction(code, 11, concat({ 1 }, stringWords("GLSL.std.450")));
+		addInstruction(code, 11, concat({ 2 }, stringWords("NonSemantic.Shader.DebugInfo.100")));
+		addInstruction(code, 14, { 0, 1 });
+		addInstruction(code, 15, concat({ 5, 10 }, stringWords("main")));
+		addInstruction(code, 7, concat({ 3 }, stringWords("shader.comp")));
+		addInstruction(code, 3, { 2, 450, 3 });
+		addInstruction(code, 5, concat({ 10 }, stringWords("main")));
+		addInstruction(code, 330, stringWords("client vulkan100"));
+		addInstruction(code, 71, { 6, 1, 0 });
+		addInstruction(code, 71, { 7, 1, 1 });
+		addInstruction(code, 71, { 8, 1, 2 });
+		addInstruction(code, 21, { 4, 32, 0 });
+		addInstruction(code, 20, { 5 });
+		addInstruction(code, 50, { 4, 6, 16 });
+		addInstruction(code, 50, { 4, 7, 32 });
+		addInstruction(code, 48, { 5, 8 });
+		addInstruction(code, 19, { 9 });
+		addInstruction(code, 33, { 11, 9 });
+		addInstruction(code, 12, { 9, 12, 2, 0 });
+		addInstruction(code, 54, { 9, 10, 0, 11 });
+		addInstruction(code, 248, { 13 });
+		addInstruction(code, 8, { 3, 4, 0 });
+		addInstruction(code, 253, {});
+		addInstruction(code, 56, {});
+		return code;
+	}
+
+	// The instructions without the header, as opcode followed by the operands
+	std::vector<std::vector<uint32_t>> instructions(const std::vector<uint32_t>& code) {
+		std::vector<std::vector<uint32_t>> result;
+		for (size_t offset = 5; offset < code.size(); offset += code[offset] >> 16) {
+			std::vector<uint32_t> instruction = { code[offset] & 0xFFFF };
+			size_t wordCount = code[offset] >> 16;
+			instruction.insert(instruction.end(), code.begin() + offset + 1, code.begin() + offset + wordCount);
+			result.push_back(instruction);
+		}
+		return result;
+	}
+
+	bool containsInstruction(const std::vector<uint32_t>& code, const std::vector<uint32_t>& instruction) {
+		auto moduleInstructions = instructions(code);
+		return std::find(moduleInstructions.begin(), moduleInstructions.end(), instruction) != moduleInstructions.end();
+	}
+
+	size_t opcodeCount(const std::vector<uint32_t>& code, uint32_t opcode) {
+		auto moduleInstructions = instructions(code);
+		return std::count_if(moduleInstructions.begin(), moduleInstructions.end(),
+							 [opcode](const auto& instruction) { return instruction[0] == opcode; });
+	}
+} // namespace
+
+void testSpirvStripDebugInfo() {
+	std::vector<uint32_t> code = testModule();
+	testEqual(true, stripSpirvDebugInfo(code), "Valid module was rejected!");
+
+	for (uint32_t opcode : { 3U, 5U, 7U, 8U, 10U, 330U }) {
+		testEqual(size_t(0), opcodeCount(code, opcode), "Debug instruction wasn't stripped!");
+	}
+	testEqual(false, containsInstruction(code, concat({ 11, 2 }, stringWords("NonSemantic.Shader.DebugInfo.100"))),
+			  "Non-semantic instruction set wasn't stripped!");
+	testEqual(false, containsInstruction(code, { 12, 9, 12, 2, 0 }), "Non-semantic instruction wasn't stripped!");
+	testEqual(true, containsInstruction(code, concat({ 11, 1 }, stringWords("GLSL.std.450"))),
+			  "Semantic instruction set was stripped!");
+	testEqual(true, containsInstruction(code, concat({ 15, 5, 10 }, stringWords("main"))), "Entry point was stripped!");
+	testEqual(size_t(18), instructions(code).size(), "Wrong number of remaining instructions!");
+	testEqual(testModule()[3], code[3], "Header changed!");
+
+	auto strippedCode = code;
+	testEqual(true, stripSpirvDebugInfo(strippedCode), "Stripped module was rejected!");
+	testEqual(code, strippedCode, "Stripping twice changed the module!");
+}
+
+void testSpirvFreezeSpecConstants() {
+	std::vector<uint32_t> code = testModule();
+	std::vector<uint32_t> specializedConstantIDs = { 1 };
+	testEqual(true, freezeSpirvSpecConstants(code, specializedConstantIDs), "Valid module was rejected!");
+
+	testEqual(true, containsInstruction(code, { 43, 4, 6, 16 }), "Unspecialized constant wasn't frozen!");
+	testEqual(false, containsInstruction(code, { 71, 6, 1, 0 }), "SpecId of frozen constant wasn't removed!");
+	testEqual(true, containsInstruction(code, { 41, 5, 8 }), "Unspecialized boolean wasn't frozen!");
+	testEqual(false, containsInstruction(code, { 71, 8, 1, 2 }), "SpecId of frozen boolean wasn't removed!");
+
+	testEqual(true, containsInstruction(code, { 50, 4, 7, 32 }), "Specialized constant was frozen!");
+	testEqual(true, containsInstruction(code, { 71, 7, 1, 1 }), "SpecId of specialized constant was removed!");
+}
+
+void testSpirvOptimizeInvalidModules() {
+	std::vector<uint32_t> truncatedCode = testModule();
+	truncatedCode.pop_back();
+	truncatedCode.back() = 5U << 16 | 253;
+	auto originalCode = truncatedCode;
+	testEqual(false, stripSpirvDebugInfo(truncatedCode), "Truncated module was accepted!");
+	testEqual(false, freezeSpirvSpecConstants(truncatedCode, {}), "Truncated module was accepted!");
+	testEqual(originalCode, truncatedCode, "Rejected module was changed!");
+
+	std::vector<uint32_t> zeroLengthCode = testModule();
+	zeroLengthCode[5] = 0;
+	testEqual(false, stripSpirvDebugInfo(zeroLengthCode), "Instruction without words was accepted!");
+
+	// Failing passes keep the module and report why
+	std::vector<std::string> warnings;
+	auto optimizedCode = optimizeSpirv(
+		truncatedCode, {}, { .freezeUnspecializedConstants = true, .stripDebugInfo = true }, warnings);
+	testEqual(originalCode, optimizedCode, "Invalid module was changed!");
+	testEqual(size_t(2), warnings.size(), "Wrong number of warnings!");
+
+	// Passes are applied in order, without SPIRV-Tools the optimizer is skipped with a warning
+	warnings.clear();
+	auto expectedCode = testModule();
+	freezeSpirvSpecConstants(expectedCode, {});
+	stripSpirvDebugInfo(expectedCode);
+	optimizedCode = optimizeSpirv(testModule(), {},
+								  { .freezeUnspecializedConstants = true,
+									.runOptimizer = !spirvOptimizerAvailable(),
+									.stripDebugInfo = true },
+								  warnings);
+	testEqual(expectedCode, optimizedCode, "Combined passes differ from the single passes!");
+	testEqual(spirvOptimizerAvailable() ? size_t(0) : size_t(1), warnings.size(), "Wrong number of warnings!");
+}
@@ -0,0 +1,51 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <graphics/util/SplitBarriers.hpp>
+
+using namespace vanadium::graphics;
+
+// A shadow map rendered first and sampled by the lighting pass after the geometry passes
+void testSplitBarriersDistance() {
+	std::vector<FramegraphQueue> nodeQueues(6, FramegraphQueue::Graphics);
+	std::vector<bool> isNodeCulled(6, false);
+	std::vector<SplitBarrierCandidate> candidates = {
+		// Shadow map -> lighting, the depth prepass and G-buffer pass run in between
+		{ .srcNodeIndex = 0, .dstNodeIndex = 3 },
+		// Depth prepass -> G-buffer pass, nothing can overlap
+		{ .srcNodeIndex = 1, .dstNodeIndex = 2 },
+		// G-buffer -> tonemapping, only the lighting pass runs in between
+		{ .srcNodeIndex = 2, .dstNodeIndex = 4 },
+	};
+	testEqual(std::vector<bool>{ true, false, false }, selectSplitBarriers(candidates, nodeQueues, isNodeCulled, 2),
+			  "Wrong barriers were split!");
+	testEqual(std::vector<bool>{ true, false, true }, selectSplitBarriers(candidates, nodeQueues, isNodeCulled, 1),
+			  "Wrong barriers were split with a lower distance!");
+
+	// Culled nodes don't record anything, so they don't hide any latency
+	isNodeCulled[1] = true;
+	testEqual(std::vector<bool>{ false, false, false }, selectSplitBarriers(candidates, nodeQueues, isNodeCulled, 2),
+			  "Barrier over culled nodes was split!");
+}
+
+// Events only work within one queue, nodes on another queue in between split the submission
+void testSplitBarriersQueues() {
+	std::vector<FramegraphQueue> nodeQueues = { FramegraphQueue::Graphics,	   FramegraphQueue::Graphics,
+												FramegraphQueue::Graphics,	   FramegraphQueue::AsyncCompute,
+												FramegraphQueue::AsyncCompute, FramegraphQueue::Graphics };
+	std::vector<bool> isNodeCulled(6, false);
+	std::vector<SplitBarrierCandidate> candidates = {
+		{ .srcNodeIndex = 0, .dstNodeIndex = 2 },
+		// Same queue, but different submissions
+		{ .srcNodeIndex = 1, .dstNodeIndex = 5 },
+		{ .srcNodeIndex = 3, .dstNodeIndex = 4 },
+		// Ownership transfers are never split
+		{ .srcNodeIndex = 2, .dstNodeIndex = 4 },
+		// Invalid candidates
+		{ .srcNodeIndex = 4, .dstNodeIndex = 4 },
+		{ .srcNodeIndex = 0, .dstNodeIndex = 6 },
+	};
+	testEqual(std::vector<bool>{ true, false, false, false, false, false },
+			  selectSplitBarriers(candidates, nodeQueues, isNodeCulled, 1), "Wrong barriers were split!");
+	testEqual(std::vector<bool>{ true, false, true, false, false, false },
+			  selectSplitBarriers(candidates, nodeQueues, isNodeCulled, 0), "Adjacent barrier wasn't split!");
+}
@@ -0,0 +1,210 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <algorithm>
+#include <graphics/util/RangeAllocator.hpp>
+#include <graphics/util/StagingRing.hpp>
+#include <random>
+#include <vector>
+
+using namespace vanadium::graphics;
+
+namespace {
+	constexpr VkDeviceSize segmentSize = 4096;
+	// Large enough for the uploads of all frames in flight in the reclaim test, including alignment padding
+	constexpr VkDeviceSize reclaimSegmentSize = 8192;
+	constexpr uint64_t framesInFlight = 3;
+
+	struct LiveAllocation {
+		uint64_t frame;
+		StagingRingAllocation allocation;
+		VkDeviceSize size;
+	};
+
+	// Stands in for the frame fences: frame n is completed once frame n + framesInFlight starts, like the frames
+	// rendered by GraphicsSubsystem.
+	class FakeFenceTimeline {
+	  public:
+		uint64_t beginFrame() {
+			if (m_currentFrame >= framesInFlight) {
+				m_completedFrame = m_currentFrame - framesInFlight;
+			}
+			return m_currentFrame;
+		}
+		void endFrame() { ++m_currentFrame; }
+
+		uint64_t completedFrame() const { return m_completedFrame; }
+
+	  private:
+		uint64_t m_currentFrame = 1;
+		uint64_t m_completedFrame = 0;
+	};
+
+	void checkNoOverlap(const std::vector<LiveAllocation>& liveAllocations, const LiveAllocation& newAllocation) {
+		for (auto& allocation : liveAllocations) {
+			if (allocation.allocation.segmentIndex != newAllocation.allocation.segmentIndex) {
+				continue;
+			}
+			bool isDisjoint =
+				allocation.allocation.offset + allocation.size <= newAllocation.allocation.offset ||
+				newAllocation.allocation.offset + newAllocation.size <= allocation.allocation.offset;
+			testEqual(true, isDisjoint, "Staging allocation overlaps with an allocation that is still in flight!");
+		}
+	}
+} // namespace
+
+// Simulates frames with random uploads and checks that no allocation overwrites data of a frame that is still in
+// flight, and that the ring doesn't grow if the uploads of all frames in flight fit into one segment.
+void testStagingRingReclaim() {
+	std::mt19937_64 generator(0x57A61E);
+	std::uniform_int_distribution<VkDeviceSize> sizeDistribution(1, 200);
+	std::uniform_int_distribution<size_t> countDistribution(0, 6);
+	constexpr VkDeviceSize alignments[] = { 1, 4, 64 };
+
+	StagingRing ring = StagingRing(reclaimSegmentSize);
+	FakeFenceTimeline timeline;
+	std::vector<LiveAllocation> liveAllocations;
+
+	for (size_t i = 0; i < 1000; ++i) {
+		uint64_t frame = timeline.beginFrame();
+		ring.reclaim(timeline.completedFrame());
+		std::erase_if(liveAllocations, [&timeline](const auto& allocation) {
+			return allocation.frame <= timeline.completedFrame();
+		});
+
+		size_t allocationCount = countDistribution(generator);
+		for (size_t j = 0; j < allocationCount; ++j) {
+			VkDeviceSize size = sizeDistribution(generator);
+			VkDeviceSize alignment = alignments[(i + j) % std::size(alignments)];
+			LiveAllocation allocation = { .frame = frame, .allocation = ring.allocate(size, alignment), .size = size };
+
+			testEqual(VkDeviceSize(0), alignmentMargin(allocation.allocation.offset, alignment),
+					  "Staging allocation isn't aligned!");
+			testLessEqual(allocation.allocation.offset + size, ring.segmentSize(allocation.allocation.segmentIndex),
+						  "Staging allocation exceeds its segment!");
+			checkNoOverlap(liveAllocations, allocation);
+			liveAllocations.push_back(allocation);
+		}
+		ring.closeFrame(frame);
+		timeline.endFrame();
+
+		testLessEqual(ring.pendingFrameCount(), size_t(framesInFlight + 1),
+					  "Frames aren't reclaimed after their fence signalled!");
+	}
+	// At most 3 frames * 6 allocations * (200 bytes + 63 bytes padding) are in use at once, so one of the two free
+	// ranges of the segment always fits another allocation
+	testEqual(size_t(1), ring.segmentCount(), "The ring grew even though all frames in flight fit into one segment!");
+}
+
+// Allocations that don't fit into the free space of existing segments spill into new segments, which are reused once
+// the frames using them are reclaimed.
+void testStagingRingOverflow() {
+	StagingRing ring = StagingRing(segmentSize);
+
+	auto first = ring.allocate(3000, 4);
+	testEqual(0U, first.segmentIndex, "First allocation isn't placed in the first segment!");
+	auto spilled = ring.allocate(3000, 4);
+	testEqual(1U, spilled.segmentIndex, "Allocation that doesn't fit didn't spill into a new segment!");
+	testEqual(VkDeviceSize(0), spilled.offset, "Spilled allocation doesn't start at the segment start!");
+
+	auto oversized = ring.allocate(3 * segmentSize, 4);
+	testEqual(2U, oversized.segmentIndex, "Oversized allocation didn't get its own segment!");
+	testEqual(3 * segmentSize, ring.segmentSize(2), "Oversized segment doesn't fit the allocation!");
+
+	auto small = ring.allocate(500, 4);
+	testEqual(0U, small.segmentIndex, "Small allocation didn't use the free space of the first segment!");
+	testEqual(VkDeviceSize(3000), small.offset, "Small allocation wasn't bump-allocated!");
+	ring.closeFrame(1);
+
+	// Frame 1 is still in flight, the segments stay occupied
+	ring.reclaim(0);
+	auto stillFull = ring.allocate(3000, 4);
+	testEqual(3U, stillFull.segmentIndex, "Allocation reused memory of a frame that is still in flight!");
+	ring.closeFrame(2);
+
+	ring.reclaim(1);
+	testEqual(VkDeviceSize(0), ring.usedSize(0), "Reclaimed segment isn't empty!");
+	testEqual(VkDeviceSize(0), ring.usedSize(2), "Reclaimed oversized segment isn't empty!");
+	testEqual(VkDeviceSize(3000), ring.usedSize(3), "Segment of the in-flight frame was reclaimed!");
+	auto reused = ring.allocate(3000, 4);
+	testEqual(0U, reused.segmentIndex, "Reclaimed segment isn't reused!");
+	testEqual(VkDeviceSize(0), reused.offset, "Empty segment isn't allocated from the start!");
+	testEqual(size_t(4), ring.segmentCount(), "Segments were added although reclaimed ones had space!");
+}
+
+// Allocations continue at the start of a segment once the end is reached and the start was reclaimed.
+void testStagingRingWrapAround() {
+	StagingRing ring = StagingRing(segmentSize);
+
+	ring.allocate(2048, 1);
+	ring.closeFrame(1);
+	ring.allocate(1500, 1);
+	ring.closeFrame(2);
+	ring.reclaim(1);
+
+	// [2048, 3548) is in flight, the end of the segment is too small
+	auto wrapped = ring.allocate(1024, 256);
+	testEqual(0U, wrapped.segmentIndex, "Allocation didn't wrap around in the same segment!");
+	testEqual(VkDeviceSize(0), wrapped.offset, "Allocation didn't wrap around to the segment start!");
+	testEqual(VkDeviceSize(segmentSize - 2048 + 1024), ring.usedSize(0),
+			  "Wasted space at the end isn't accounted for!");
+
+	// Only [1024, 2048) is free, the allocation must not overwrite frame 2 at 2048
+	auto beforeTail = ring.allocate(1024, 256);
+	testEqual(0U, beforeTail.segmentIndex, "Allocation that fits before the tail spilled!");
+	testEqual(VkDeviceSize(1024), beforeTail.offset, "Allocation before the tail has the wrong offset!");
+	auto full = ring.allocate(1, 1);
+	testEqual(1U, full.segmentIndex, "Allocation in a full segment didn't spill!");
+	ring.closeFrame(3);
+
+	ring.reclaim(2);
+	// The padding at the end of the segment belongs to frame 3, which wrapped around
+	testEqual(VkDeviceSize(segmentSize - 1500), ring.usedSize(0), "Reclaiming frame 2 didn't free its range!");
+	ring.reclaim(3);
+	testEqual(VkDeviceSize(0), ring.usedSize(0), "Segment isn't empty after reclaiming all frames!");
+}
+
+// Oversized segments are released as soon as their frames are reclaimed, spilled segments once they were idle for a
+// while. Their indices are reused by the next segments.
+void testStagingRingRelease() {
+	constexpr uint64_t maxIdleFrames = 4;
+	StagingRing ring = StagingRing(segmentSize);
+
+	ring.allocate(3000, 4);
+	auto spilled = ring.allocate(3000, 4);
+	auto oversized = ring.allocate(3 * segmentSize, 4);
+	ring.closeFrame(1);
+
+	testEqual(size_t(0), ring.releaseIdleSegments(maxIdleFrames).size(), "Segments in flight were released!");
+	ring.reclaim(1);
+	auto releasedSegments = ring.releaseIdleSegments(maxIdleFrames);
+	testEqual(size_t(1), releasedSegments.size(), "Reclaimed oversized segment wasn't released!");
+	testEqual(oversized.segmentIndex, releasedSegments[0], "Wrong segment was released!");
+	testEqual(true, ring.isSegmentReleased(oversized.segmentIndex), "Oversized segment isn't marked as released!");
+
+	// Only the first segment is used from now on, the spilled one becomes idle
+	for (uint64_t frame = 2; frame < 1 + maxIdleFrames; ++frame) {
+		testEqual(0U, ring.allocate(1000, 4).segmentIndex, "Allocation didn't use the first segment!");
+		ring.closeFrame(frame);
+		ring.reclaim(frame);
+		ring.releaseIdleSegments(maxIdleFrames);
+		testEqual(false, ring.isSegmentReleased(spilled.segmentIndex), "Spilled segment was released too early!");
+	}
+	ring.allocate(1000, 4);
+	ring.closeFrame(1 + maxIdleFrames);
+	ring.reclaim(1 + maxIdleFrames);
+	releasedSegments = ring.releaseIdleSegments(maxIdleFrames);
+	testEqual(size_t(1), releasedSegments.size(), "Idle spilled segment wasn't released!");
+	testEqual(spilled.segmentIndex, releasedSegments[0], "Wrong segment was released!");
+
+	// The last segment of the regular size is kept, even if it's idle
+	for (uint64_t frame = 2 + maxIdleFrames; frame < 2 + 2 * maxIdleFrames; ++frame) {
+		ring.closeFrame(frame);
+	}
+	testEqual(size_t(0), ring.releaseIdleSegments(maxIdleFrames).size(), "Last segment was released!");
+
+	auto reused = ring.allocate(2 * segmentSize, 4);
+	testEqual(spilled.segmentIndex, reused.segmentIndex, "Released index wasn't reused!");
+	testEqual(false, ring.isSegmentReleased(reused.segmentIndex), "Reused segment is still marked as released!");
+	testEqual(2 * segmentSize, ring.segmentSize(reused.segmentIndex), "Reused segment has the old size!");
+	testEqual(size_t(3), ring.segmentCount(), "Segments were added although released indices were free!");
+}
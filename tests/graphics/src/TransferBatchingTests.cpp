@@ -0,0 +1,135 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <graphics/util/TransferBatching.hpp>
+
+using namespace vanadium::graphics;
+
+namespace {
+	VkBuffer fakeBuffer(uintptr_t id) { return reinterpret_cast<VkBuffer>(id); }
+
+	const VkBuffer stagingSegment0 = fakeBuffer(1);
+	const VkBuffer stagingSegment1 = fakeBuffer(2);
+	const VkBuffer shapeBuffer = fakeBuffer(3);
+	const VkBuffer vertexBuffer = fakeBuffer(4);
+
+	BufferCopyRequest shapeUpdate(VkBuffer srcBuffer, VkDeviceSize srcOffset, VkDeviceSize dstOffset,
+								  VkDeviceSize size) {
+		return { .srcBuffer = srcBuffer,
+				 .dstBuffer = shapeBuffer,
+				 .region = { .srcOffset = srcOffset, .dstOffset = dstOffset, .size = size },
+				 .dstUsageStageFlags = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+				 .dstUsageAccessFlags = VK_ACCESS_SHADER_READ_BIT };
+	}
+
+	void testRegion(const VkBufferCopy& region, VkDeviceSize srcOffset, VkDeviceSize dstOffset, VkDeviceSize size) {
+		testEqual(srcOffset, region.srcOffset, "Copy region has the wrong source offset!");
+		testEqual(dstOffset, region.dstOffset, "Copy region has the wrong destination offset!");
+		testEqual(size, region.size, "Copy region has the wrong size!");
+	}
+} // namespace
+
+// Hundreds of small updates, like UI shapes uploaded through the staging ring one after another, collapse into one
+// copy command per buffer pair and one barrier per destination buffer.
+void testTransferBatchingCoalescing() {
+	std::vector<BufferCopyRequest> requests;
+	// 200 shapes with 64 bytes each, staged back to back
+	for (VkDeviceSize i = 0; i < 200; ++i) {
+		requests.push_back(shapeUpdate(stagingSegment0, 4096 + i * 64, i * 64, 64));
+	}
+	// Two vertex updates, the second one from a spilled ring segment
+	requests.push_back({ .srcBuffer = stagingSegment0,
+						 .dstBuffer = vertexBuffer,
+						 .region = { .srcOffset = 20000, .dstOffset = 1024, .size = 512 },
+						 .dstUsageStageFlags = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+						 .dstUsageAccessFlags = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT });
+	requests.push_back({ .srcBuffer = stagingSegment1,
+						 .dstBuffer = vertexBuffer,
+						 .region = { .srcOffset = 0, .dstOffset = 0, .size = 256 },
+						 .dstUsageStageFlags = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+						 .dstUsageAccessFlags = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT });
+	// A shape that was staged out of order isn't contiguous in the source and stays a separate region
+	requests.push_back(shapeUpdate(stagingSegment0, 0, 200 * 64, 128));
+
+	auto plan = planBufferCopies(requests);
+
+	testEqual(size_t(3), plan.copies.size(), "Copies weren't merged per buffer pair!");
+	testEqual(stagingSegment0, plan.copies[0].srcBuffer, "First batch has the wrong source!");
+	testEqual(shapeBuffer, plan.copies[0].dstBuffer, "First batch has the wrong destination!");
+	testEqual(size_t(2), plan.copies[0].regions.size(), "Contiguous shape regions weren't merged!");
+	testRegion(plan.copies[0].regions[0], 4096, 0, 200 * 64);
+	testRegion(plan.copies[0].regions[1], 0, 200 * 64, 128);
+
+	testEqual(stagingSegment0, plan.copies[1].srcBuffer, "Second batch has the wrong source!");
+	testEqual(vertexBuffer, plan.copies[1].dstBuffer, "Second batch has the wrong destination!");
+	testEqual(size_t(1), plan.copies[1].regions.size(), "Vertex copy from segment 0 has the wrong region count!");
+	testRegion(plan.copies[1].regions[0], 20000, 1024, 512);
+	testEqual(stagingSegment1, plan.copies[2].srcBuffer, "Third batch has the wrong source!");
+	testRegion(plan.copies[2].regions[0], 0, 0, 256);
+
+	testEqual(size_t(2), plan.barriers.size(), "There isn't exactly one barrier per destination buffer!");
+	testEqual(shapeBuffer, plan.barriers[0].buffer, "First barrier has the wrong buffer!");
+	testEqual(VkDeviceSize(0), plan.barriers[0].offset, "Shape barrier doesn't start at the first copied byte!");
+	testEqual(VkDeviceSize(200 * 64 + 128), plan.barriers[0].size, "Shape barrier doesn't cover all copied bytes!");
+	testEqual(VkAccessFlags(VK_ACCESS_TRANSFER_WRITE_BIT), plan.barriers[0].srcAccessMask,
+			  "Barrier doesn't wait for transfer writes!");
+	testEqual(VkAccessFlags(VK_ACCESS_SHADER_READ_BIT), plan.barriers[0].dstAccessMask,
+			  "Shape barrier has the wrong access mask!");
+	testEqual(vertexBuffer, plan.barriers[1].buffer, "Second barrier has the wrong buffer!");
+	testEqual(VkDeviceSize(0), plan.barriers[1].offset, "Vertex barrier doesn't start at the first copied byte!");
+	testEqual(VkDeviceSize(1536), plan.barriers[1].size, "Vertex barrier doesn't cover all copied bytes!");
+	testEqual(VkAccessFlags(VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT), plan.barriers[1].dstAccessMask,
+			  "Vertex barrier has the wrong access mask!");
+	testEqual(VkPipelineStageFlags(VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT),
+			  plan.dstStageFlags, "Destination stages aren't exactly the usage stages!");
+
+	testEqual(size_t(0), planBufferCopies({}).copies.size(), "Copies were planned without requests!");
+}
+
+// Copy regions to the same buffer must not overlap, so data that is replaced in the same frame is cut out of the
+// older copies.
+void testTransferBatchingOverlap() {
+	std::vector<BufferCopyRequest> requests = { shapeUpdate(stagingSegment0, 0, 0, 1024),
+												shapeUpdate(stagingSegment1, 0, 256, 256),
+												shapeUpdate(stagingSegment0, 2048, 896, 256) };
+	auto plan = planBufferCopies(requests);
+
+	testEqual(size_t(2), plan.copies.size(), "Overlapping copies have the wrong batch count!");
+	// The first upload is split by the second one and cut off by the third one, which isn't contiguous in the source
+	testEqual(size_t(3), plan.copies[0].regions.size(), "Overwritten region wasn't split!");
+	testRegion(plan.copies[0].regions[0], 0, 0, 256);
+	testRegion(plan.copies[0].regions[1], 512, 512, 384);
+	testRegion(plan.copies[0].regions[2], 2048, 896, 256);
+	testEqual(size_t(1), plan.copies[1].regions.size(), "Second batch has the wrong region count!");
+	testRegion(plan.copies[1].regions[0], 0, 256, 256);
+
+	testEqual(size_t(1), plan.barriers.size(), "Overlapping copies to one buffer need more than one barrier!");
+	testEqual(VkDeviceSize(1152), plan.barriers[0].size, "Barrier doesn't cover the union of all copies!");
+}
+
+void testTransferBatchingDirtyRanges() {
+	std::vector<MemoryRange> ranges;
+	addDirtyRange(ranges, { .offset = 100, .size = 50 });
+	addDirtyRange(ranges, { .offset = 0, .size = 10 });
+	addDirtyRange(ranges, { .offset = 300, .size = 100 });
+	addDirtyRange(ranges, { .offset = 200, .size = 0 });
+	testEqual(size_t(3), ranges.size(), "Disjoint dirty ranges were merged!");
+	testEqual(VkDeviceSize(0), ranges[0].offset, "Dirty ranges aren't sorted!");
+
+	// Touches the end of the first range and overlaps the second one
+	addDirtyRange(ranges, { .offset = 10, .size = 120 });
+	testEqual(size_t(2), ranges.size(), "Adjacent and overlapping dirty ranges weren't merged!");
+	testEqual(VkDeviceSize(0), ranges[0].offset, "Merged range has the wrong offset!");
+	testEqual(VkDeviceSize(150), ranges[0].size, "Merged range has the wrong size!");
+
+	addDirtyRange(ranges, { .offset = 50, .size = 500 });
+	testEqual(size_t(1), ranges.size(), "Range covering all others wasn't merged!");
+	testEqual(VkDeviceSize(550), ranges[0].size, "Covering range has the wrong size!");
+
+	auto undefinedScope = imageTransferSourceScope(VK_IMAGE_LAYOUT_UNDEFINED);
+	testEqual(VkPipelineStageFlags(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT), undefinedScope.stageFlags,
+			  "Transitions from the undefined layout wait for previous commands!");
+	testEqual(VkAccessFlags(0), undefinedScope.accessFlags, "Transitions from the undefined layout wait for writes!");
+	auto shaderReadScope = imageTransferSourceScope(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	testEqual(VkPipelineStageFlags(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT), shaderReadScope.stageFlags,
+			  "Transitions of initialized images don't wait for previous commands!");
+}
@@ -0,0 +1,56 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <graphics/util/TransferQueuePolicy.hpp>
+
+using namespace vanadium::graphics;
+
+namespace {
+	constexpr TransferQueueCapabilities dedicatedQueueCapabilities = { .hasDedicatedTransferQueue = true,
+																	   .timelineSemaphores = true };
+
+	bool usesTransferQueue(const TransferQueuePolicy& policy, VkDeviceSize size, bool isReadByFramesInFlight) {
+		return policy.chooseQueue({ .size = size, .isReadByFramesInFlight = isReadByFramesInFlight }) ==
+			   UploadQueue::Transfer;
+	}
+} // namespace
+
+void testTransferQueuePolicyThreshold() {
+	auto policy = TransferQueuePolicy(dedicatedQueueCapabilities, 256_KiB);
+	testEqual(true, policy.canUseTransferQueue(), "Dedicated transfer queue isn't usable!");
+
+	testEqual(false, usesTransferQueue(policy, 4_KiB, false), "Small upload was moved to the transfer queue!");
+	testEqual(false, usesTransferQueue(policy, 256_KiB - 1, false),
+			  "Upload below the threshold was moved to the transfer queue!");
+	testEqual(true, usesTransferQueue(policy, 256_KiB, false), "Upload at the threshold stayed on the graphics queue!");
+	testEqual(true, usesTransferQueue(policy, 64_MiB, false), "Large upload stayed on the graphics queue!");
+
+	auto defaultPolicy = TransferQueuePolicy(dedicatedQueueCapabilities);
+	testEqual(false, usesTransferQueue(defaultPolicy, 512_KiB, false),
+			  "Upload below the default threshold was moved to the transfer queue!");
+	testEqual(true, usesTransferQueue(defaultPolicy, TransferQueuePolicy::defaultMinTransferQueueUploadSize, false),
+			  "Upload at the default threshold stayed on the graphics queue!");
+}
+
+// Without a separate queue family or timeline semaphores, or if in-flight frames read the destination, every upload
+// has to stay on the graphics queue.
+void testTransferQueuePolicyAvailability() {
+	auto sharedFamilyPolicy =
+		TransferQueuePolicy({ .hasDedicatedTransferQueue = false, .timelineSemaphores = true }, 256_KiB);
+	testEqual(false, sharedFamilyPolicy.canUseTransferQueue(), "Transfer queue of the graphics family is usable!");
+	testEqual(false, usesTransferQueue(sharedFamilyPolicy, 64_MiB, false),
+			  "Upload was moved to a queue of the graphics queue family!");
+
+	auto noTimelinePolicy =
+		TransferQueuePolicy({ .hasDedicatedTransferQueue = true, .timelineSemaphores = false }, 256_KiB);
+	testEqual(false, noTimelinePolicy.canUseTransferQueue(), "Transfer queue is usable without timeline semaphores!");
+	testEqual(false, usesTransferQueue(noTimelinePolicy, 64_MiB, false),
+			  "Upload was moved to the transfer queue without a way to wait for it!");
+
+	auto policy = TransferQueuePolicy(dedicatedQueueCapabilities, 256_KiB);
+	testEqual(false, usesTransferQueue(policy, 64_MiB, true),
+			  "Upload to a buffer read by frames in flight was moved to the transfer queue!");
+
+	auto defaultConstructedPolicy = TransferQueuePolicy();
+	testEqual(false, usesTransferQueue(defaultConstructedPolicy, 64_MiB, false),
+			  "Policy without capabilities uses the transfer queue!");
+}
@@ -0,0 +1,130 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <graphics/util/TransientAliasing.hpp>
+#include <util/MemoryLiterals.hpp>
+
+using namespace vanadium::graphics;
+
+namespace {
+	TransientResourceRequirements transientResource(size_t firstNodeIndex, size_t lastNodeIndex, VkDeviceSize size,
+													VkDeviceSize alignment = 256, uint32_t memoryTypeBits = 0xFF) {
+		return { .firstNodeIndex = firstNodeIndex,
+				 .lastNodeIndex = lastNodeIndex,
+				 .size = size,
+				 .alignment = alignment,
+				 .memoryTypeBits = memoryTypeBits };
+	}
+
+	bool hasAlias(const TransientAliasingPlan& plan, uint32_t previous, uint32_t next) {
+		for (auto& alias : plan.aliases) {
+			if (alias.previous == previous && alias.next == next) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// No two resources that are in use at the same time may share memory
+	void testPlacementsDisjoint(const std::vector<TransientResourceRequirements>& resources,
+								const TransientAliasingPlan& plan) {
+		for (size_t i = 0; i < resources.size(); ++i) {
+			auto& placement = plan.placements[i];
+			testLessEqual(placement.offset + resources[i].size, plan.blocks[placement.blockIndex].size,
+						  "Resource exceeds its block!");
+			testEqual(VkDeviceSize(0), placement.offset % resources[i].alignment, "Resource isn't aligned!");
+			for (size_t j = i + 1; j < resources.size(); ++j) {
+				auto& otherPlacement = plan.placements[j];
+				bool lifetimesOverlap = resources[i].firstNodeIndex <= resources[j].lastNodeIndex &&
+										resources[j].firstNodeIndex <= resources[i].lastNodeIndex;
+				bool memoryOverlaps = placement.blockIndex == otherPlacement.blockIndex &&
+									  placement.offset < otherPlacement.offset + resources[j].size &&
+									  otherPlacement.offset < placement.offset + resources[i].size;
+				testEqual(false, lifetimesOverlap && memoryOverlaps, "Resources in use at the same time alias!");
+			}
+		}
+	}
+} // namespace
+
+// A post-processing chain where each pass reads the previous pass' output only needs two targets of memory
+void testTransientAliasingPostProcessChain() {
+	std::vector<TransientResourceRequirements> resources;
+	for (size_t i = 0; i < 6; ++i) {
+		resources.push_back(transientResource(i, i + 1, 8_MiB));
+	}
+	auto plan = planTransientAliasing(resources);
+	testPlacementsDisjoint(resources, plan);
+
+	testEqual(size_t(2), plan.blocks.size(), "Ping-pong chain doesn't use exactly two blocks!");
+	testEqual(VkDeviceSize(48_MiB), plan.unaliasedSize, "Unaliased size isn't the sum of all resources!");
+	testEqual(VkDeviceSize(16_MiB), plan.aliasedSize, "Aliased size isn't the size of two targets!");
+	testEqual(VkDeviceSize(32_MiB), plan.savedSize(), "Saved size is wrong!");
+	for (uint32_t i = 0; i < 6; ++i) {
+		testEqual(i % 2, plan.placements[i].blockIndex, "Chain resource was placed in the wrong block!");
+	}
+	testEqual(true, hasAlias(plan, 0, 2), "Aliasing of the first and third target wasn't reported!");
+	testEqual(true, hasAlias(plan, 0, 4), "Aliasing of the first and fifth target wasn't reported!");
+	testEqual(true, hasAlias(plan, 3, 5), "Aliasing of the fourth and sixth target wasn't reported!");
+	testEqual(size_t(6), plan.aliases.size(), "Resources in different blocks were reported as aliasing!");
+
+	// Resources used by all nodes can't share memory with anything
+	std::vector<TransientResourceRequirements> persistentResources = { transientResource(0, 5, 4_MiB),
+																	   transientResource(0, 5, 4_MiB) };
+	auto persistentPlan = planTransientAliasing(persistentResources);
+	testPlacementsDisjoint(persistentResources, persistentPlan);
+	testEqual(VkDeviceSize(0), persistentPlan.savedSize(), "Resources in use at the same time saved memory!");
+	testEqual(size_t(0), persistentPlan.aliases.size(), "Resources in use at the same time alias!");
+
+	testEqual(size_t(0), planTransientAliasing({}).blocks.size(), "Blocks were planned without resources!");
+}
+
+// Smaller resources are packed next to each other into the memory of a larger resource that isn't in use anymore
+void testTransientAliasingPacking() {
+	std::vector<TransientResourceRequirements> resources = {
+		transientResource(0, 1, 10000),
+		transientResource(2, 4, 4000, 1024),
+		transientResource(2, 3, 3000, 1024),
+		// Too large for the remaining space while the other two are in use
+		transientResource(3, 4, 3000, 1024),
+		transientResource(5, 5, 2000, 1024),
+	};
+	auto plan = planTransientAliasing(resources);
+	testPlacementsDisjoint(resources, plan);
+
+	testEqual(size_t(2), plan.blocks.size(), "Resources weren't packed into the large block!");
+	testEqual(VkDeviceSize(10000), plan.blocks[0].size, "Block has the wrong size!");
+	testEqual(uint32_t(0), plan.placements[1].blockIndex, "Resource wasn't placed in the free block!");
+	testEqual(VkDeviceSize(0), plan.placements[1].offset, "Resource wasn't placed at the lowest offset!");
+	testEqual(VkDeviceSize(4096), plan.placements[2].offset, "Resource wasn't placed at the next aligned offset!");
+	testEqual(uint32_t(1), plan.placements[3].blockIndex, "Resource was placed over resources in use!");
+	testEqual(VkDeviceSize(0), plan.placements[4].offset, "Resource wasn't placed at the lowest offset!");
+	testEqual(VkDeviceSize(13000), plan.aliasedSize, "Aliased size is wrong!");
+	testEqual(VkDeviceSize(9000), plan.savedSize(), "Saved size is wrong!");
+
+	testEqual(true, hasAlias(plan, 0, 1), "Aliasing of the large resource wasn't reported!");
+	testEqual(true, hasAlias(plan, 0, 2), "Aliasing of the large resource wasn't reported!");
+	testEqual(true, hasAlias(plan, 1, 4), "Aliasing of the last resource wasn't reported!");
+	testEqual(false, hasAlias(plan, 2, 4), "Resources without overlapping memory were reported as aliasing!");
+}
+
+void testTransientAliasingMemoryTypes() {
+	std::vector<TransientResourceRequirements> resources = {
+		transientResource(0, 0, 4096, 256, 0b0011),
+		// Can't share memory with the first resource
+		transientResource(1, 1, 4096, 256, 0b0100),
+		transientResource(2, 2, 4096, 256, 0b0010),
+		// Would fit into the first block, but not into its memory type after the third resource was placed
+		transientResource(3, 3, 1024, 256, 0b0001),
+	};
+	auto plan = planTransientAliasing(resources);
+	testPlacementsDisjoint(resources, plan);
+
+	testEqual(size_t(3), plan.blocks.size(), "Resources with incompatible memory types share a block!");
+	testEqual(plan.placements[0].blockIndex, plan.placements[2].blockIndex,
+			  "Resources with compatible memory types don't share a block!");
+	testEqual(uint32_t(0b0010), plan.blocks[plan.placements[0].blockIndex].memoryTypeBits,
+			  "Block memory types aren't restricted to the types of all its resources!");
+	testEqual(uint32_t(0b0100), plan.blocks[plan.placements[1].blockIndex].memoryTypeBits,
+			  "Block has the wrong memory types!");
+	testEqual(uint32_t(0b0001), plan.blocks[plan.placements[3].blockIndex].memoryTypeBits,
+			  "Block has the wrong memory types!");
+}
@@ -0,0 +1,319 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <Log.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+
+#include <VCPFormat.hpp>
+
+namespace {
+	struct TestShader {
+		VkShaderStageFlagBits stage;
+		std::vector<char> code;
+
+		CompiledShader compiledShader() {
+			return { .stage = stage, .dataSize = code.size(), .data = code.data() };
+		}
+	};
+
+	// Shader code lengths that aren't a multiple of the alignment, so the code of the next shader has to be padded
+	std::vector<TestShader> testShaders(PipelineType type) {
+		std::vector<TestShader> shaders;
+		if (type == PipelineType::Compute) {
+			shaders.push_back({ .stage = VK_SHADER_STAGE_COMPUTE_BIT, .code = std::vector<char>(36, 'c') });
+		} else {
+			shaders.push_back({ .stage = VK_SHADER_STAGE_VERTEX_BIT, .code = std::vector<char>(20, 'v') });
+			shaders.push_back({ .stage = VK_SHADER_STAGE_FRAGMENT_BIT, .code = std::vector<char>(44, 'f') });
+		}
+		return shaders;
+	}
+
+	PipelineInstanceData testInstance(const std::string& name, VkShaderStageFlagBits specializedStage) {
+		PipelineInstanceData data = {};
+		data.name = name;
+		data.instanceVertexInputConfig.attributes = { { .location = 0, .binding = 0, .offset = 0 },
+													  { .location = 1, .binding = 0, .offset = 8 } };
+		data.instanceVertexInputConfig.bindings = { { .binding = 0, .stride = 16 } };
+		data.instanceViewportScissorConfig.viewports = { { .width = 1280.0f, .height = 720.0f, .maxDepth = 1.0f } };
+		data.instanceDynamicStateConfig.dynamicStates = { VK_DYNAMIC_STATE_SCISSOR };
+		data.instanceRasterizationConfig.lineWidth = 1.0f;
+		data.instanceColorBlendConfig.blendConstants[2] = 0.5f;
+
+		PipelineInstanceStageSpecializationConfig specialization = { .stage = specializedStage };
+		PipelineInstanceSpecializationConfig config = { .mapEntry = { .constantID = 0, .offset = 4, .size = 4 },
+														.type = SpecializationDataType::UInt32 };
+		config.dataUint32 = 0xC0FFEE;
+		specialization.configs.push_back(config);
+		data.instanceSpecializationConfigs.push_back(specialization);
+		return data;
+	}
+
+	// One set layout with an immutable sampler, a graphics archetype with two instances and a compute archetype
+	std::vector<char> testLibrary() {
+		VCPLibraryWriter writer;
+		DescriptorBindingLayoutInfo samplerBinding = { .binding = { .binding = 0,
+																	.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER,
+																	.descriptorCount = 1,
+																	.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT },
+													   .usesImmutableSamplers = true,
+													   .immutableSamplerInfos = { { .magFilter = VK_FILTER_LINEAR,
+																					.maxLod = 4.0f } } };
+		DescriptorBindingLayoutInfo bufferBinding = { .binding = { .binding = 1,
+																   .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+																   .descriptorCount = 1,
+																   .stageFlags = VK_SHADER_STAGE_VERTEX_BIT },
+													  .usesImmutableSamplers = false };
+		writer.addSetLayout({ samplerBinding, bufferBinding });
+
+		auto graphicsShaders = testShaders(PipelineType::Graphics);
+		writer.addArchetype(PipelineType::Graphics,
+							{ graphicsShaders[0].compiledShader(), graphicsShaders[1].compiledShader() }, { 0 },
+							{ { .stageFlags = VK_SHADER_STAGE_VERTEX_BIT, .offset = 0, .size = 64 } });
+		writer.addInstance(testInstance("Opaque", VK_SHADER_STAGE_FRAGMENT_BIT));
+		writer.addInstance(testInstance("Transparent", VK_SHADER_STAGE_VERTEX_BIT));
+
+		auto computeShaders = testShaders(PipelineType::Compute);
+		writer.addArchetype(PipelineType::Compute, { computeShaders[0].compiledShader() }, {}, {});
+		writer.addInstance(testInstance("Cull", VK_SHADER_STAGE_COMPUTE_BIT));
+		return writer.finish();
+	}
+
+	bool isValid(const std::vector<char>& fileData) {
+		VCPLibraryView view;
+		return view.open(fileData.data(), fileData.size());
+	}
+
+	VCPTableOfContents tableOfContents(const std::vector<char>& fileData) {
+		VCPTableOfContents contents;
+		std::memcpy(&contents, fileData.data() + sizeof(VCPFileHeader), sizeof(VCPTableOfContents));
+		return contents;
+	}
+} // namespace
+
+void testVCPLibraryRoundTrip() {
+	auto fileData = testLibrary();
+	VCPLibraryView view;
+	testEqual(true, view.open(fileData.data(), fileData.size()), "Library wasn't opened!");
+
+	testEqual(static_cast<size_t>(1), view.setLayouts().size(), "Wrong set layout count!");
+	auto bindings = view.elements(view.setLayouts()[0].bindings);
+	testEqual(static_cast<size_t>(2), bindings.size(), "Wrong binding count!");
+	testEqual(static_cast<size_t>(1), view.elements(bindings[0].immutableSamplers).size(), "Sampler is missing!");
+	testEqual(4.0f, view.elements(bindings[0].immutableSamplers)[0].maxLod, "Sampler changed!");
+	testEqual(static_cast<size_t>(0), view.elements(bindings[1].immutableSamplers).size(),
+			  "Binding without immutable samplers has samplers!");
+
+	testEqual(static_cast<size_t>(2), view.archetypes().size(), "Wrong archetype count!");
+	for (auto& archetype : view.archetypes()) {
+		auto expectedShaders = testShaders(archetype.type);
+		auto shaders = view.elements(archetype.shaders);
+		testEqual(expectedShaders.size(), shaders.size(), "Wrong shader count!");
+		for (size_t i = 0; i < shaders.size(); ++i) {
+			auto code = view.elements(shaders[i].code);
+			testEqual(expectedShaders[i].stage, shaders[i].stage, "Shader stage changed!");
+			testEqual(expectedShaders[i].code, std::vector<char>(code.begin(), code.end()), "Shader code changed!");
+			testEqual(static_cast<uintptr_t>(0), reinterpret_cast<uintptr_t>(code.data()) % vcpShaderCodeAlignment,
+					  "Shader code isn't aligned!");
+		}
+	}
+	testEqual(std::vector<uint32_t>{ 0 },
+			  std::vector<uint32_t>(view.elements(view.archetypes()[0].setLayoutIndices).begin(),
+									view.elements(view.archetypes()[0].setLayoutIndices).end()),
+			  "Set layout indices changed!");
+
+	testEqual(static_cast<size_t>(2), view.graphicsInstances().size(), "Wrong graphics instance count!");
+	testEqual(static_cast<size_t>(1), view.computeInstances().size(), "Wrong compute instance count!");
+	auto& instance = view.graphicsInstances()[1];
+	testEqual(std::string_view("Transparent"), view.name(instance), "Name changed!");
+	testEqual('\0', view.name(instance).data()[view.name(instance).size()], "Name isn't null-terminated!");
+	testEqual(1U, view.computeInstances()[0].archetypeIndex, "Compute instance has the wrong archetype!");
+	testEqual(8U, view.elements(instance.attributes)[1].offset, "Vertex attribute changed!");
+	testEqual(16U, view.elements(instance.bindings)[0].stride, "Vertex binding changed!");
+	testEqual(720.0f, view.elements(instance.viewports)[0].height, "Viewport changed!");
+	testEqual(VK_DYNAMIC_STATE_SCISSOR, view.elements(instance.dynamicStates)[0], "Dynamic state changed!");
+	testEqual(1.0f, instance.rasterizationConfig.lineWidth, "Rasterization state changed!");
+	testEqual(0.5f, instance.colorBlendConfig.blendConstants[2], "Color blend state changed!");
+
+	// The specialization data is laid out as VkSpecializationInfo expects it
+	auto specializations = view.elements(instance.specializations);
+	testEqual(static_cast<size_t>(1), specializations.size(), "Wrong specialization count!");
+	testEqual(VK_SHADER_STAGE_VERTEX_BIT, specializations[0].stage, "Specialized stage changed!");
+	auto data = view.elements(specializations[0].data);
+	testEqual(static_cast<size_t>(8), data.size(), "Wrong specialization data size!");
+	uint32_t value;
+	std::memcpy(&value, data.data() + view.elements(specializations[0].mapEntries)[0].offset, sizeof(uint32_t));
+	testEqual(0xC0FFEEU, value, "Specialization data changed!");
+}
+
+void testVCPLibraryNameLookup() {
+	constexpr uint32_t instanceCount = 300;
+	VCPLibraryWriter writer;
+	auto shaders = testShaders(PipelineType::Graphics);
+	writer.addArchetype(PipelineType::Graphics, { shaders[0].compiledShader(), shaders[1].compiledShader() }, {}, {});
+	for (uint32_t i = 0; i < instanceCount; ++i) {
+		writer.addInstance(testInstance("Instance " + std::to_string(i), VK_SHADER_STAGE_VERTEX_BIT));
+	}
+	// Duplicate names resolve to the first instance, like a linear search
+	writer.addInstance(testInstance("Instance 7", VK_SHADER_STAGE_VERTEX_BIT));
+	auto fileData = writer.finish();
+
+	VCPLibraryView view;
+	testEqual(true, view.open(fileData.data(), fileData.size()), "Library wasn't opened!");
+	for (uint32_t i = 0; i < instanceCount; ++i) {
+		testEqual(i, view.findGraphicsInstance("Instance " + std::to_string(i)), "Wrong instance found!");
+	}
+	testEqual(~0U, view.findGraphicsInstance("Instance 300"), "Missing instance was found!");
+	testEqual(~0U, view.findGraphicsInstance(""), "Missing instance was found!");
+	testEqual(~0U, view.findComputeInstance("Instance 0"), "Graphics instance was found as compute instance!");
+}
+
+// Archetypes with byte-identical shaders, like variants that only differ in their set layouts, store the code once
+void testVCPLibrarySharedShaderCode() {
+	VCPLibraryWriter writer;
+	auto shaders = testShaders(PipelineType::Graphics);
+	auto otherFragmentShader = TestShader{ .stage = VK_SHADER_STAGE_FRAGMENT_BIT, .code = std::vector<char>(44, 'g') };
+	writer.addArchetype(PipelineType::Graphics, { shaders[0].compiledShader(), shaders[1].compiledShader() }, {}, {});
+	writer.addArchetype(PipelineType::Graphics, { shaders[0].compiledShader(), otherFragmentShader.compiledShader() },
+						{}, {});
+	writer.addArchetype(PipelineType::Graphics, { shaders[0].compiledShader(), shaders[1].compiledShader() }, {}, {});
+	testEqual(size_t(3), writer.sharedShaderCount(), "Wrong number of shared shaders!");
+	testEqual(shaders[0].code.size() + shaders[1].code.size() + otherFragmentShader.code.size(),
+			  writer.storedShaderCodeSize(), "Shared shader code was stored again!");
+	auto fileData = writer.finish();
+
+	VCPLibraryView view;
+	testEqual(true, view.open(fileData.data(), fileData.size()), "Library wasn't opened!");
+	auto firstShaders = view.elements(view.archetypes()[0].shaders);
+	auto secondShaders = view.elements(view.archetypes()[1].shaders);
+	auto thirdShaders = view.elements(view.archetypes()[2].shaders);
+	testEqual(firstShaders[0].code.offset, secondShaders[0].code.offset, "Identical shader isn't shared!");
+	testEqual(firstShaders[1].code.offset, thirdShaders[1].code.offset, "Identical shader isn't shared!");
+	testEqual(false, firstShaders[1].code.offset == secondShaders[1].code.offset, "Different shaders are shared!");
+	auto code = view.elements(secondShaders[1].code);
+	testEqual(otherFragmentShader.code, std::vector<char>(code.begin(), code.end()), "Shader code changed!");
+}
+
+void testVCPLibraryInvalidRanges() {
+	auto fileData = testLibrary();
+	testEqual(true, isValid(fileData), "Valid library was rejected!");
+
+	auto truncated = fileData;
+	truncated.resize(fileData.size() - 4);
+	testEqual(false, isValid(truncated), "Truncated library was accepted!");
+	testEqual(false, isValid(std::vector<char>(fileData.begin(), fileData.begin() + 4)), "Header was accepted!");
+
+	auto otherVersion = fileData;
+	uint32_t version = vcpLegacyStreamFileVersion;
+	std::memcpy(otherVersion.data() + sizeof(uint32_t), &version, sizeof(uint32_t));
+	testEqual(false, isValid(otherVersion), "Library of another version was accepted!");
+
+	auto contents = tableOfContents(fileData);
+	auto patchInstance = [&fileData, &contents](auto patch) {
+		auto patched = fileData;
+		VCPInstanceEntry instance;
+		std::memcpy(&instance, patched.data() + contents.graphicsInstances.offset, sizeof(VCPInstanceEntry));
+		patch(instance);
+		std::memcpy(patched.data() + contents.graphicsInstances.offset, &instance, sizeof(VCPInstanceEntry));
+		return patched;
+	};
+	testEqual(false,
+			  isValid(patchInstance([&fileData](auto& instance) { instance.attributes.offset = fileData.size(); })),
+			  "Range past the end was accepted!");
+	testEqual(false, isValid(patchInstance([](auto& instance) { instance.viewports.count = ~0ULL / 2; })),
+			  "Overflowing range was accepted!");
+	testEqual(false, isValid(patchInstance([](auto& instance) { instance.bindings.offset += 1; })),
+			  "Misaligned range was accepted!");
+	testEqual(false, isValid(patchInstance([](auto& instance) { instance.name.count -= 1; })),
+			  "Name without null terminator was accepted!");
+	testEqual(false, isValid(patchInstance([](auto& instance) { instance.archetypeIndex = 1; })),
+			  "Graphics instance of a compute archetype was accepted!");
+
+	auto misalignedCode = fileData;
+	VCPArchetypeEntry archetype;
+	std::memcpy(&archetype, fileData.data() + contents.archetypes.offset, sizeof(VCPArchetypeEntry));
+	VCPShaderEntry shader;
+	std::memcpy(&shader, fileData.data() + archetype.shaders.offset, sizeof(VCPShaderEntry));
+	shader.code.offset += sizeof(uint32_t);
+	std::memcpy(misalignedCode.data() + archetype.shaders.offset, &shader, sizeof(VCPShaderEntry));
+	testEqual(false, isValid(misalignedCode), "Misaligned shader code was accepted!");
+
+	auto invalidNameTable = fileData;
+	uint32_t bucketValue = 3;
+	std::memcpy(invalidNameTable.data() + contents.graphicsNameTable.offset, &bucketValue, sizeof(uint32_t));
+	testEqual(false, isValid(invalidNameTable), "Name table pointing past the instances was accepted!");
+}
+
+// Version 5 files are converted to the same layout the writer produces from the same data. The bytes can differ in
+// the padding of copied structs.
+void testVCPLibraryLegacyConversion() {
+	auto directory = std::filesystem::temp_directory_path() / "vanadium-vcp-test";
+	std::filesystem::create_directories(directory);
+	std::string fileName = (directory / "legacy.vcp").string();
+
+	auto graphicsShaders = testShaders(PipelineType::Graphics);
+	std::vector<CompiledShader> compiledShaders = { graphicsShaders[0].compiledShader(),
+													graphicsShaders[1].compiledShader() };
+	std::vector<uint32_t> setLayoutIndices = { 0 };
+	std::vector<VkPushConstantRange> pushConstantRanges = {
+		{ .stageFlags = VK_SHADER_STAGE_VERTEX_BIT, .offset = 0, .size = 64 }
+	};
+	std::vector<PipelineInstanceData> instances = { testInstance("Opaque", VK_SHADER_STAGE_FRAGMENT_BIT),
+													testInstance("Transparent", VK_SHADER_STAGE_VERTEX_BIT) };
+	std::vector<std::vector<DescriptorBindingLayoutInfo>> setLayouts = {
+		{ { .binding = { .binding = 0,
+						 .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+						 .descriptorCount = 1,
+						 .stageFlags = VK_SHADER_STAGE_VERTEX_BIT },
+			.usesImmutableSamplers = false } }
+	};
+	{
+		auto outStream = std::ofstream(fileName, std::ios::binary | std::ios::trunc);
+		serialize(VCPFileHeader{ .version = vcpLegacyStreamFileVersion }, outStream);
+		serializeVector(setLayouts, outStream);
+		serialize(PipelineType::Graphics, outStream);
+		serializeVector(compiledShaders, outStream);
+		serializeVector(setLayoutIndices, outStream);
+		serializeVector(pushConstantRanges, outStream);
+		serializeVector(instances, outStream);
+	}
+
+	VCPLibraryWriter writer;
+	writer.addSetLayout(setLayouts[0]);
+	writer.addArchetype(PipelineType::Graphics, compiledShaders, setLayoutIndices, pushConstantRanges);
+	for (auto& instance : instances) {
+		writer.addInstance(instance);
+	}
+
+	auto inStream = std::ifstream(fileName, std::ios::binary);
+	inStream.ignore(sizeof(VCPFileHeader));
+	auto convertedData = convertLegacyVCPLibrary(inStream);
+	inStream.close();
+	std::filesystem::remove_all(directory);
+
+	auto expectedData = writer.finish();
+	testEqual(expectedData.size(), convertedData.size(), "Converted library has a different size!");
+	testEqual(0,
+			  std::memcmp(expectedData.data(), convertedData.data(),
+						  sizeof(VCPFileHeader) + sizeof(VCPTableOfContents)),
+			  "Converted library has a different layout!");
+
+	VCPLibraryView view;
+	testEqual(true, view.open(convertedData.data(), convertedData.size()), "Converted library is invalid!");
+	testEqual(1U, view.findGraphicsInstance("Transparent"), "Converted instance wasn't found!");
+	auto shaders = view.elements(view.archetypes()[0].shaders);
+	auto code = view.elements(shaders[1].code);
+	testEqual(graphicsShaders[1].code, std::vector<char>(code.begin(), code.end()), "Shader code changed!");
+	auto data = view.elements(view.elements(view.graphicsInstances()[0].specializations)[0].data);
+	uint32_t value;
+	std::memcpy(&value, data.data() + 4, sizeof(uint32_t));
+	testEqual(0xC0FFEEU, value, "Specialization data changed!");
+}
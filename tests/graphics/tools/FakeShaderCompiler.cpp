@@ -0,0 +1,41 @@
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+// Stands in for glslc in the shader cache tests, with the same command line: <source> -o <output> [args...]. The
+// output is the source followed by the arguments, so that changing either changes the compiled code. Every invocation
+// is appended to the file given with --invocation-log, sources containing "#error" fail to compile.
+int main(int argc, char** argv) {
+	if (argc < 4 || argv[2] != std::string_view("-o")) {
+		return 2;
+	}
+
+	auto sourceStream = std::ifstream(argv[1], std::ios::binary);
+	if (!sourceStream.is_open()) {
+		return 1;
+	}
+	std::string output = std::string(std::istreambuf_iterator<char>(sourceStream), std::istreambuf_iterator<char>());
+
+	std::string invocationLogName;
+	for (int i = 4; i < argc; ++i) {
+		if (argv[i] == std::string_view("--invocation-log") && i + 1 < argc) {
+			invocationLogName = argv[++i];
+		} else {
+			output += ' ';
+			output += argv[i];
+		}
+	}
+
+	if (!invocationLogName.empty()) {
+		auto logStream = std::ofstream(invocationLogName, std::ios::binary | std::ios::app);
+		logStream << argv[1] << '\n';
+	}
+	if (output.find("#error") != std::string::npos) {
+		return 1;
+	}
+
+	auto outStream = std::ofstream(argv[3], std::ios::binary | std::ios::trunc);
+	outStream << output;
+	return outStream.good() ? 0 : 1;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+
+using TestFunction = void (*)();
+
+struct FunctionEntry {
+	std::string_view name;
+	TestFunction function;
+};
+
+void testSlotmapInsertLookup();
+void testSlotmapErase();
+void testSlotmapStaleHandles();
+void testSlotmapReserveShrink();
+void testConcurrentSlotmapInsertLookup();
+void testConcurrentSlotmapEraseIterate();
+void testConcurrentSlotmapConcurrentLookup();
+void testWorkerPoolRunsAllJobs();
+void testWorkerPoolDeterministicOrder();
+
+static constexpr std::array<FunctionEntry, 9> testFunctions = {
+	FunctionEntry{ "SlotmapInsertLookup", testSlotmapInsertLookup },
+	FunctionEntry{ "SlotmapErase", testSlotmapErase },
+	FunctionEntry{ "SlotmapStaleHandles", testSlotmapStaleHandles },
+	FunctionEntry{ "SlotmapReserveShrink", testSlotmapReserveShrink },
+	FunctionEntry{ "ConcurrentSlotmapInsertLookup", testConcurrentSlotmapInsertLookup },
+	FunctionEntry{ "ConcurrentSlotmapEraseIterate", testConcurrentSlotmapEraseIterate },
+	FunctionEntry{ "ConcurrentSlotmapConcurrentLookup", testConcurrentSlotmapConcurrentLookup },
+	FunctionEntry{ "WorkerPoolRunsAllJobs", testWorkerPoolRunsAllJobs },
+	FunctionEntry{ "WorkerPoolDeterministicOrder", testWorkerPoolDeterministicOrder }
+};
@@ -0,0 +1,108 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <util/ConcurrentSlotmap.hpp>
+#include <vector>
+
+using namespace vanadium;
+
+void testConcurrentSlotmapInsertLookup() {
+	// small chunks so that the elements span several chunks
+	ConcurrentSlotmap<int, 16> slotmap;
+	std::vector<SlotmapHandle> handles;
+	for (int i = 0; i < 100; ++i) {
+		handles.push_back(slotmap.addElement(i));
+	}
+	testEqual(size_t(100), slotmap.size(), "Slotmap size doesn't match!");
+	for (int i = 0; i < 100; ++i) {
+		testEqual(i, slotmap[handles[i]], "Element doesn't match its handle!");
+		testEqual(true, slotmap.contains(handles[i]), "Slotmap doesn't contain added element!");
+	}
+	testEqual(false, slotmap.contains(~0U), "Slotmap contains invalid handle!");
+
+	// addresses stay stable when more chunks are added
+	int* firstElement = &slotmap[handles[0]];
+	for (int i = 0; i < 100; ++i) {
+		slotmap.addElement(i);
+	}
+	testEqual(firstElement, &slotmap[handles[0]], "Element moved when adding elements!");
+}
+
+void testConcurrentSlotmapEraseIterate() {
+	ConcurrentSlotmap<int, 16> slotmap;
+	std::vector<SlotmapHandle> handles;
+	for (int i = 0; i < 100; ++i) {
+		handles.push_back(slotmap.addElement(i));
+	}
+	for (int i = 0; i < 100; i += 2) {
+		slotmap.removeElement(handles[i]);
+	}
+	testEqual(size_t(50), slotmap.size(), "Slotmap size after removal doesn't match!");
+
+	int sum = 0;
+	for (auto& element : slotmap) {
+		sum += element;
+	}
+	testEqual(2500, sum, "Iterating remaining elements yields wrong elements!");
+	for (auto iterator = slotmap.begin(); iterator != slotmap.end(); ++iterator) {
+		testEqual(*iterator, slotmap[slotmap.handle(iterator)], "Iterator handle doesn't refer to its element!");
+	}
+
+	SlotmapHandle newHandle = slotmap.addElement(1000);
+	testEqual(false, slotmap.contains(handles[0]), "Stale handle refers to a new element!");
+	testEqual(1000, slotmap[newHandle], "New element doesn't match its handle!");
+
+	slotmap.clear();
+	testEqual(size_t(0), slotmap.size(), "Slotmap isn't empty after clearing!");
+	testEqual(false, slotmap.contains(newHandle), "Handle is valid after clearing!");
+	testEqual(true, slotmap.begin() == slotmap.end(), "Iterating an empty slotmap yields elements!");
+}
+
+// Readers look up elements that stay alive while one writer keeps adding and removing other elements, which also
+// allocates new chunks. Readers must always see their elements unchanged.
+void testConcurrentSlotmapConcurrentLookup() {
+	constexpr int stableElementCount = 64;
+	constexpr int readerCount = 4;
+	ConcurrentSlotmap<int, 32> slotmap;
+
+	std::vector<SlotmapHandle> stableHandles;
+	for (int i = 0; i < stableElementCount; ++i) {
+		stableHandles.push_back(slotmap.addElement(i));
+	}
+
+	std::atomic<bool> writerFinished = false;
+	std::atomic<int> mismatchCount = 0;
+	std::vector<std::thread> readers;
+	for (int i = 0; i < readerCount; ++i) {
+		readers.emplace_back([&]() {
+			while (!writerFinished.load(std::memory_order_acquire)) {
+				for (int j = 0; j < stableElementCount; ++j) {
+					if (!slotmap.contains(stableHandles[j]) || slotmap[stableHandles[j]] != j) {
+						mismatchCount.fetch_add(1, std::memory_order_relaxed);
+					}
+				}
+			}
+		});
+	}
+
+	std::vector<SlotmapHandle> transientHandles;
+	for (int round = 0; round < 200; ++round) {
+		for (int i = 0; i < 50; ++i) {
+			transientHandles.push_back(slotmap.addElement(-1));
+		}
+		for (size_t i = 0; i < transientHandles.size(); i += 2) {
+			slotmap.removeElement(transientHandles[i]);
+		}
+		transientHandles.erase(std::remove_if(transientHandles.begin(), transientHandles.end(),
+											  [&](auto handle) { return !slotmap.contains(handle); }),
+							   transientHandles.end());
+	}
+	writerFinished.store(true, std::memory_order_release);
+	for (auto& reader : readers) {
+		reader.join();
+	}
+
+	testEqual(0, mismatchCount.load(), "Readers saw wrong elements while the slotmap was modified!");
+}
@@ -0,0 +1,98 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <util/Slotmap.hpp>
+
+using namespace vanadium;
+
+void testSlotmapInsertLookup() {
+	Slotmap<int> slotmap;
+	std::vector<SlotmapHandle> handles;
+	for (int i = 0; i < 100; ++i) {
+		handles.push_back(slotmap.addElement(i));
+	}
+	testEqual(size_t(100), slotmap.size(), "Slotmap size doesn't match!");
+	for (int i = 0; i < 100; ++i) {
+		testEqual(i, slotmap[handles[i]], "Element doesn't match its handle!");
+		testEqual(true, slotmap.contains(handles[i]), "Slotmap doesn't contain added element!");
+		testEqual(handles[i], slotmap.handle(slotmap.find(handles[i])), "Handle of found iterator doesn't match!");
+	}
+}
+
+void testSlotmapErase() {
+	Slotmap<int> slotmap;
+	std::vector<SlotmapHandle> handles;
+	for (int i = 0; i < 100; ++i) {
+		handles.push_back(slotmap.addElement(i));
+	}
+	for (int i = 0; i < 100; i += 2) {
+		slotmap.removeElement(handles[i]);
+	}
+	testEqual(size_t(50), slotmap.size(), "Slotmap size after removal doesn't match!");
+	for (int i = 1; i < 100; i += 2) {
+		testEqual(i, slotmap[handles[i]], "Element doesn't match its handle after removal!");
+	}
+
+	int sum = 0;
+	for (auto& element : slotmap) {
+		sum += element;
+	}
+	testEqual(2500, sum, "Iterating remaining elements yields wrong elements!");
+
+	for (auto iterator = slotmap.begin(); iterator != slotmap.end(); ++iterator) {
+		testEqual(*iterator, slotmap[slotmap.handle(iterator)], "Iterator handle doesn't refer to its element!");
+	}
+
+	// removing twice must not remove anything else
+	slotmap.removeElement(handles[0]);
+	testEqual(size_t(50), slotmap.size(), "Removing a removed element changed the slotmap!");
+
+	for (int i = 1; i < 100; i += 2) {
+		slotmap.removeElement(handles[i]);
+	}
+	testEqual(size_t(0), slotmap.size(), "Slotmap isn't empty after removing all elements!");
+}
+
+void testSlotmapStaleHandles() {
+	Slotmap<int> slotmap;
+	SlotmapHandle oldHandle = slotmap.addElement(1);
+	slotmap.removeElement(oldHandle);
+	SlotmapHandle newHandle = slotmap.addElement(2);
+
+	testNotEqual(oldHandle, newHandle, "Reused slot hands out the same handle!");
+	testEqual(false, slotmap.contains(oldHandle), "Stale handle is still valid!");
+	testEqual(true, slotmap.find(oldHandle) == slotmap.end(), "Stale handle can be found!");
+	testEqual(2, slotmap[newHandle], "New element doesn't match!");
+
+	slotmap.removeElement(oldHandle);
+	testEqual(size_t(1), slotmap.size(), "Removing a stale handle removed an element!");
+
+	slotmap.clear();
+	testEqual(false, slotmap.contains(newHandle), "Handle is still valid after clearing!");
+	SlotmapHandle clearedHandle = slotmap.addElement(3);
+	testEqual(true, slotmap.contains(clearedHandle), "Handle after clearing is invalid!");
+	testEqual(3, slotmap[clearedHandle], "Element after clearing doesn't match!");
+
+	testEqual(false, slotmap.contains(~0U), "Invalid handle is contained!");
+}
+
+void testSlotmapReserveShrink() {
+	Slotmap<int> slotmap;
+	slotmap.reserve(256);
+	testGreaterEqual(slotmap.capacity(), size_t(256), "Reserving didn't increase capacity!");
+
+	std::vector<SlotmapHandle> handles;
+	for (int i = 0; i < 256; ++i) {
+		handles.push_back(slotmap.addElement(i));
+	}
+	for (int i = 0; i < 192; ++i) {
+		slotmap.removeElement(handles[i]);
+	}
+	slotmap.shrinkToFit();
+	testEqual(size_t(64), slotmap.size(), "Shrinking changed the slotmap size!");
+	for (int i = 192; i < 256; ++i) {
+		testEqual(i, slotmap[handles[i]], "Element doesn't match its handle after shrinking!");
+	}
+	for (int i = 0; i < 192; ++i) {
+		testEqual(false, slotmap.contains(handles[i]), "Removed handle became valid after shrinking!");
+	}
+}
@@ -0,0 +1,77 @@
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <atomic>
+#include <util/WorkerPool.hpp>
+#include <vector>
+
+using namespace vanadium;
+
+void testWorkerPoolRunsAllJobs() {
+	WorkerPool pool;
+	pool.create(4);
+	testEqual(uint32_t(4), pool.threadCount(), "Pool has the wrong number of threads!");
+
+	for (size_t batch = 0; batch < 100; ++batch) {
+		size_t jobCount = batch % 17;
+		std::vector<std::atomic<uint32_t>> runCounts(jobCount);
+		std::atomic<bool> hasInvalidThreadIndex = false;
+		pool.dispatch(jobCount, [&runCounts, &hasInvalidThreadIndex](size_t jobIndex, uint32_t threadIndex) {
+			runCounts[jobIndex].fetch_add(1);
+			if (threadIndex >= 4) {
+				hasInvalidThreadIndex = true;
+			}
+		});
+		pool.wait();
+		for (auto& count : runCounts) {
+			testEqual(uint32_t(1), count.load(), "Job didn't run exactly once!");
+		}
+		testEqual(false, hasInvalidThreadIndex.load(), "Job ran with an invalid thread index!");
+	}
+
+	// Without threads, jobs run on the calling thread before dispatch returns
+	WorkerPool inlinePool;
+	size_t jobSum = 0;
+	inlinePool.dispatch(10, [&jobSum](size_t jobIndex, uint32_t threadIndex) { jobSum += jobIndex + threadIndex; });
+	testEqual(size_t(45), jobSum, "Jobs didn't run inline!");
+	inlinePool.wait();
+}
+
+// Mimics parallel command recording: each job records into a buffer owned by its thread and hands out a reference
+// to what it recorded. Putting the results together in job order has to yield the serially recorded sequence,
+// regardless of which thread ran which job.
+void testWorkerPoolDeterministicOrder() {
+	constexpr size_t jobCount = 64;
+	constexpr uint32_t threadCount = 3;
+	WorkerPool pool;
+	pool.create(threadCount);
+
+	std::vector<std::vector<uint32_t>> threadBuffers[threadCount];
+	std::vector<std::pair<uint32_t, size_t>> recordedBuffers(jobCount);
+	for (size_t frame = 0; frame < 8; ++frame) {
+		for (auto& buffers : threadBuffers) {
+			buffers.clear();
+		}
+		pool.dispatch(jobCount, [&threadBuffers, &recordedBuffers](size_t jobIndex, uint32_t threadIndex) {
+			auto& buffer = threadBuffers[threadIndex].emplace_back();
+			for (uint32_t command = 0; command < jobIndex % 5 + 1; ++command) {
+				buffer.push_back(static_cast<uint32_t>(jobIndex * 16 + command));
+			}
+			recordedBuffers[jobIndex] = { threadIndex, threadBuffers[threadIndex].size() - 1 };
+		});
+		pool.wait();
+
+		std::vector<uint32_t> submittedCommands;
+		for (auto& [threadIndex, bufferIndex] : recordedBuffers) {
+			auto& buffer = threadBuffers[threadIndex][bufferIndex];
+			submittedCommands.insert(submittedCommands.end(), buffer.begin(), buffer.end());
+		}
+
+		std::vector<uint32_t> serialCommands;
+		for (size_t jobIndex = 0; jobIndex < jobCount; ++jobIndex) {
+			for (uint32_t command = 0; command < jobIndex % 5 + 1; ++command) {
+				serialCommands.push_back(static_cast<uint32_t>(jobIndex * 16 + command));
+			}
+		}
+		testEqual(true, submittedCommands == serialCommands, "Commands aren't submitted in job order!");
+	}
+}
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <span>
 #include <string_view>
 #include <fstream>
 #include <Log.hpp>
@@ -14,7 +18,8 @@
 #include <string>
 #include <vector>
 
-#include <SysUtils.hpp>
+#include <ShaderCache.hpp>
+#include <SpirvOptimizer.hpp>
 #include <spirv_reflect.h>
 
 #include <json/json.h>
@@ -29,22 +34,29 @@ struct ReflectedShader {
 	SpvReflectShaderModule shader;
 };
 
+class PipelineInstanceRecord;
+
 class PipelineArchetypeRecord {
   public:
 	PipelineArchetypeRecord(const std::string_view& srcPath, const std::string& projectDir,
 							std::vector<std::vector<DescriptorBindingLayoutInfo>>& setLayoutInfos,
 							const Json::Value& archetypeRoot);
 
-	void compileShaders(const std::string& tempDir, const std::string& compilerCommand,
-						const std::vector<std::string>& additionalArgs);
+	const std::vector<ShaderSourceFile>& sourceFiles() const { return m_files; }
+	// Takes one compile result for each source file, in the order of sourceFiles()
 	std::vector<ReflectedShader> retrieveCompileResults(const std::string_view& srcPath,
-																   const std::string& tempDir);
+														std::span<const ShaderCompileResult> results);
 
 	void verifyArchetype(const std::string_view& srcPath,
 						 std::vector<std::vector<DescriptorBindingLayoutInfo>>& setLayoutInfos,
 						 const std::vector<ReflectedShader>& shaders);
 
-	void serialize(std::ofstream& outStream);
+	// Specialization constants set by any of the instances stay specialization constants
+	void optimizeShaders(const std::string_view& srcPath, const std::vector<PipelineInstanceRecord>& instanceRecords,
+						 const SpirvOptimizationOptions& options);
+	size_t shaderCodeSize() const;
+
+	void write(VCPLibraryWriter& writer) const;
 
 	bool isValid() const { return m_isValid; }
 
@@ -58,7 +70,6 @@ class PipelineArchetypeRecord {
 	PipelineType m_pipelineType;
 
 	std::vector<ShaderSourceFile> m_files;
-	std::vector<SubprocessID> m_compilerSubprocessIDs;
 	std::vector<CompiledShader> m_compiledShaders;
 
 	std::vector<uint32_t> m_setLayoutIndices;
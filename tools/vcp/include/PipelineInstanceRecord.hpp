@@ -20,12 +20,14 @@ class PipelineInstanceRecord {
   	PipelineInstanceRecord();
 	PipelineInstanceRecord(PipelineType type, const std::string_view& srcPath, const Json::Value& instanceNode);
 
-	void serialize(std::ofstream& outStream) const;
+	void write(VCPLibraryWriter& writer) const;
 
 	void verifyInstance(const std::string_view& srcPath, const std::vector<ReflectedShader>& shaderModules);
 
 	bool isValid() const { return m_isValid; }
 
+	const PipelineInstanceData& data() const { return m_data; }
+
   private:
 	bool m_isValid = true;
 
@@ -47,7 +49,3 @@ class PipelineInstanceRecord {
 	PipelineType m_type;
 	PipelineInstanceData m_data;
 };
-
-template<> inline void serialize(const PipelineInstanceRecord& record, std::ofstream& outStream) {
-	record.serialize(outStream);
-}
\ No newline at end of file
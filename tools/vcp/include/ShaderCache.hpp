@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+struct ShaderCompileResult {
+	bool succeeded;
+	bool wasCached;
+	std::vector<char> code;
+};
+
+// Content-addressed cache of compiled shaders. Entries are keyed on the contents of the source file and every file it
+// includes, the compiler command and the compiler arguments (which contain defines and include directories), so an
+// entry is reused only if compiling again would give the same result.
+class ShaderCache {
+  public:
+	// The cache directory is created if it doesn't exist
+	ShaderCache(const std::filesystem::path& cacheDir, const std::string& compilerCommand,
+				const std::vector<std::string>& compilerArgs);
+
+	// Compiles all sources missing from the cache, running up to threadCount compiler processes at once. Sources with
+	// the same key are only compiled once. Results are in the order of sourcePaths.
+	std::vector<ShaderCompileResult> compile(const std::vector<std::string>& sourcePaths, uint32_t threadCount);
+
+	uint64_t cacheKey(const std::string& sourcePath) const;
+
+	// Removes all entries that weren't used by any compile call on this object
+	void removeUnusedEntries();
+
+	size_t hitCount() const { return m_hitCount; }
+	size_t missCount() const { return m_missCount; }
+
+  private:
+	std::filesystem::path entryPath(uint64_t key) const;
+	ShaderCompileResult compileEntry(const std::string& sourcePath, uint64_t key) const;
+
+	std::filesystem::path m_cacheDir;
+	std::string m_compilerCommand;
+	std::vector<std::string> m_compilerArgs;
+	std::vector<std::filesystem::path> m_includeDirs;
+
+	std::unordered_set<uint64_t> m_usedKeys;
+	size_t m_hitCount = 0;
+	size_t m_missCount = 0;
+};
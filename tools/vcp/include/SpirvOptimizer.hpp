@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+struct SpirvOptimizationOptions {
+	// Turns specialization constants that no instance sets into regular constants with their default value, so that
+	// the optimizer and the driver can fold them
+	bool freezeUnspecializedConstants = false;
+	// Runs the SPIRV-Tools performance passes (dead code elimination, constant folding, ...). Only available if vcp is
+	// built with SPIRV-Tools, see spirvOptimizerAvailable.
+	bool runOptimizer = false;
+	// Removes names, source text, line information and non-semantic instructions
+	bool stripDebugInfo = false;
+};
+
+bool spirvOptimizerAvailable();
+
+// Applies the enabled passes in the order of the option fields. Passes that fail leave the module unchanged and add
+// a message to warnings.
+std::vector<uint32_t> optimizeSpirv(std::span<const uint32_t> code, std::span<const uint32_t> specializedConstantIDs,
+									const SpirvOptimizationOptions& options, std::vector<std::string>& warnings);
+
+// The passes return false and leave the module unchanged if it isn't valid SPIR-V
+bool freezeSpirvSpecConstants(std::vector<uint32_t>& code, std::span<const uint32_t> specializedConstantIDs);
+bool stripSpirvDebugInfo(std::vector<uint32_t>& code);
@@ -19,4 +19,5 @@ struct SubprocessID {
 #endif
 
 SubprocessID startSubprocess(const char* processName, const std::vector<const char*>& arguments);
-void waitForSubprocess(const SubprocessID& id);
\ No newline at end of file
+// Returns whether the subprocess exited successfully
+bool waitForSubprocess(const SubprocessID& id);
\ No newline at end of file
@@ -2,8 +2,13 @@
 
 // This header doesn't include its dependencies itself, so that it can also be #include-d inside a namespace.
 // This header needs:
-// #include <vector>
+// #include <algorithm>
+// #include <cstdint>
+// #include <cstring>
 // #include <fstream>
+// #include <span>
+// #include <string_view>
+// #include <vector>
 // #define VK_NO_PROTOTYPES
 // #include <vulkan/vulkan.h>
 
@@ -69,7 +74,9 @@ template <typename T> inline std::vector<T> deserializeVector(std::ifstream& inS
 	return result;
 }
 
-constexpr uint32_t vcpFileVersion = 5;
+constexpr uint32_t vcpFileVersion = 6;
+// Version 5 files are a stream of length-prefixed arrays. They can still be read with convertLegacyVCPLibrary.
+constexpr uint32_t vcpLegacyStreamFileVersion = 5;
 constexpr uint32_t vcpMagicNumber = 0x115CDBEF;
 
 struct VCPFileHeader {
@@ -351,3 +358,475 @@ template <> inline PipelineInstanceData deserialize<PipelineInstanceData>(std::i
 				 deserializeVector<PipelineInstanceColorAttachmentBlendConfig>(inStream),
 			 .instanceSpecializationConfigs = deserializeVector<PipelineInstanceStageSpecializationConfig>(inStream) };
 }
+
+// Version 6 files are meant to be memory-mapped and used in place. The header is followed by a table of contents, and
+// all other data is stored in flat arrays referenced by offset. Arrays are aligned for their element type and shader
+// code is aligned to vcpShaderCodeAlignment, so pointers into the file can be passed to Vulkan directly.
+
+constexpr uint64_t vcpShaderCodeAlignment = 16;
+
+// Element count of an array and its offset from the start of the file
+template <typename T> struct VCPRange {
+	uint64_t offset;
+	uint64_t count;
+};
+
+struct VCPBindingEntry {
+	uint32_t binding;
+	VkDescriptorType descriptorType;
+	uint32_t descriptorCount;
+	VkShaderStageFlags stageFlags;
+	uint32_t usesImmutableSamplers;
+	uint32_t padding;
+	// Contains descriptorCount samplers if usesImmutableSamplers is set, otherwise it's empty
+	VCPRange<SamplerInfo> immutableSamplers;
+};
+
+struct VCPSetLayoutEntry {
+	VCPRange<VCPBindingEntry> bindings;
+};
+
+struct VCPShaderEntry {
+	VkShaderStageFlagBits stage;
+	uint32_t padding;
+	VCPRange<char> code;
+};
+
+struct VCPArchetypeEntry {
+	PipelineType type;
+	uint32_t padding;
+	VCPRange<VCPShaderEntry> shaders;
+	VCPRange<uint32_t> setLayoutIndices;
+	VCPRange<VkPushConstantRange> pushConstantRanges;
+};
+
+// Map entries and data in the form expected by VkSpecializationInfo
+struct VCPStageSpecializationEntry {
+	VkShaderStageFlagBits stage;
+	uint32_t padding;
+	VCPRange<VkSpecializationMapEntry> mapEntries;
+	VCPRange<char> data;
+};
+
+struct VCPInstanceEntry {
+	uint32_t archetypeIndex;
+	uint32_t padding;
+	// The name is followed by a null terminator that isn't part of the range
+	VCPRange<char> name;
+	VCPRange<VkVertexInputAttributeDescription> attributes;
+	VCPRange<VkVertexInputBindingDescription> bindings;
+	VCPRange<VkViewport> viewports;
+	VCPRange<VkRect2D> scissorRects;
+	VCPRange<VkDynamicState> dynamicStates;
+	VCPRange<PipelineInstanceColorAttachmentBlendConfig> colorAttachmentBlendConfigs;
+	VCPRange<VCPStageSpecializationEntry> specializations;
+	PipelineInstanceInputAssemblyConfig inputAssemblyConfig;
+	PipelineInstanceRasterizationConfig rasterizationConfig;
+	PipelineInstanceMultisampleConfig multisampleConfig;
+	PipelineInstanceDepthStencilConfig depthStencilConfig;
+	PipelineInstanceColorBlendConfig colorBlendConfig;
+};
+
+struct VCPTableOfContents {
+	uint64_t fileSize;
+	VCPRange<VCPSetLayoutEntry> setLayouts;
+	VCPRange<VCPArchetypeEntry> archetypes;
+	VCPRange<VCPInstanceEntry> graphicsInstances;
+	VCPRange<VCPInstanceEntry> computeInstances;
+	// Linear probing hash tables indexed by vcpNameHash, with a power of two bucket count. Buckets store the instance
+	// index + 1, 0 marks empty buckets.
+	VCPRange<uint32_t> graphicsNameTable;
+	VCPRange<uint32_t> computeNameTable;
+};
+
+// FNV-1a
+inline uint64_t vcpNameHash(std::string_view name) {
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	for (char character : name) {
+		hash ^= static_cast<uint8_t>(character);
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+// Entries start out zeroed, so that their padding isn't filled with uninitialized memory
+template <typename T> inline T vcpZeroedEntry() {
+	T entry;
+	std::memset(&entry, 0, sizeof(T));
+	return entry;
+}
+
+// Builds a version 6 file. Each archetype is added before its instances.
+class VCPLibraryWriter {
+  public:
+	VCPLibraryWriter() : m_data(sizeof(VCPFileHeader) + sizeof(VCPTableOfContents)) {}
+
+	void addSetLayout(const std::vector<DescriptorBindingLayoutInfo>& bindings) {
+		std::vector<VCPBindingEntry> bindingEntries;
+		bindingEntries.reserve(bindings.size());
+		for (auto& binding : bindings) {
+			auto entry = vcpZeroedEntry<VCPBindingEntry>();
+			entry.binding = binding.binding.binding;
+			entry.descriptorType = binding.binding.descriptorType;
+			entry.descriptorCount = binding.binding.descriptorCount;
+			entry.stageFlags = binding.binding.stageFlags;
+			entry.usesImmutableSamplers = binding.usesImmutableSamplers;
+			if (binding.usesImmutableSamplers) {
+				entry.immutableSamplers =
+					append(binding.immutableSamplerInfos.data(), binding.immutableSamplerInfos.size());
+			}
+			bindingEntries.push_back(entry);
+		}
+		m_setLayouts.push_back({ .bindings = append(bindingEntries.data(), bindingEntries.size()) });
+	}
+
+	void addArchetype(PipelineType type, const std::vector<CompiledShader>& shaders,
+					  const std::vector<uint32_t>& setLayoutIndices,
+					  const std::vector<VkPushConstantRange>& pushConstantRanges) {
+		std::vector<VCPShaderEntry> shaderEntries;
+		shaderEntries.reserve(shaders.size());
+		for (auto& shader : shaders) {
+			auto entry = vcpZeroedEntry<VCPShaderEntry>();
+			entry.stage = shader.stage;
+			entry.code = appendShaderCode(static_cast<const char*>(shader.data), shader.dataSize);
+			shaderEntries.push_back(entry);
+		}
+
+		auto entry = vcpZeroedEntry<VCPArchetypeEntry>();
+		entry.type = type;
+		entry.shaders = append(shaderEntries.data(), shaderEntries.size());
+		entry.setLayoutIndices = append(setLayoutIndices.data(), setLayoutIndices.size());
+		entry.pushConstantRanges = append(pushConstantRanges.data(), pushConstantRanges.size());
+		m_archetypes.push_back(entry);
+	}
+
+	// Adds an instance of the last added archetype
+	void addInstance(const PipelineInstanceData& data) {
+		auto entry = vcpZeroedEntry<VCPInstanceEntry>();
+		entry.archetypeIndex = static_cast<uint32_t>(m_archetypes.size() - 1);
+		entry.name = append(data.name.c_str(), data.name.size() + 1);
+		entry.name.count = data.name.size();
+		entry.attributes = append(data.instanceVertexInputConfig.attributes.data(),
+								  data.instanceVertexInputConfig.attributes.size());
+		entry.bindings =
+			append(data.instanceVertexInputConfig.bindings.data(), data.instanceVertexInputConfig.bindings.size());
+		entry.viewports = append(data.instanceViewportScissorConfig.viewports.data(),
+								 data.instanceViewportScissorConfig.viewports.size());
+		entry.scissorRects = append(data.instanceViewportScissorConfig.scissorRects.data(),
+									data.instanceViewportScissorConfig.scissorRects.size());
+		entry.dynamicStates = append(data.instanceDynamicStateConfig.dynamicStates.data(),
+									 data.instanceDynamicStateConfig.dynamicStates.size());
+		entry.colorAttachmentBlendConfigs =
+			append(data.instanceColorAttachmentBlendConfigs.data(), data.instanceColorAttachmentBlendConfigs.size());
+
+		std::vector<VCPStageSpecializationEntry> specializationEntries;
+		specializationEntries.reserve(data.instanceSpecializationConfigs.size());
+		for (auto& specialization : data.instanceSpecializationConfigs) {
+			std::vector<VkSpecializationMapEntry> mapEntries;
+			mapEntries.reserve(specialization.configs.size());
+			size_t dataSize = 0;
+			for (auto& config : specialization.configs) {
+				vanadium::assertFatal(config.mapEntry.size <= sizeof(config.dataUint32),
+									  "Invalid specialization constant size!\n");
+				mapEntries.push_back(config.mapEntry);
+				dataSize = std::max(dataSize, config.mapEntry.offset + config.mapEntry.size);
+			}
+			std::vector<char> specializationData = std::vector<char>(dataSize);
+			for (auto& config : specialization.configs) {
+				std::memcpy(specializationData.data() + config.mapEntry.offset, &config.dataUint32,
+							config.mapEntry.size);
+			}
+
+			auto specializationEntry = vcpZeroedEntry<VCPStageSpecializationEntry>();
+			specializationEntry.stage = specialization.stage;
+			specializationEntry.mapEntries = append(mapEntries.data(), mapEntries.size());
+			specializationEntry.data = append(specializationData.data(), specializationData.size());
+			specializationEntries.push_back(specializationEntry);
+		}
+		entry.specializations = append(specializationEntries.data(), specializationEntries.size());
+
+		entry.inputAssemblyConfig = data.instanceInputAssemblyConfig;
+		entry.rasterizationConfig = data.instanceRasterizationConfig;
+		entry.multisampleConfig = data.instanceMultisampleConfig;
+		entry.depthStencilConfig = data.instanceDepthStencilConfig;
+		entry.colorBlendConfig = data.instanceColorBlendConfig;
+
+		if (m_archetypes.back().type == PipelineType::Compute) {
+			m_computeInstances.push_back(entry);
+			m_computeNameHashes.push_back(vcpNameHash(data.name));
+		} else {
+			m_graphicsInstances.push_back(entry);
+			m_graphicsNameHashes.push_back(vcpNameHash(data.name));
+		}
+	}
+
+	// Appends the tables and returns the file contents. The writer can't be used afterwards.
+	std::vector<char> finish() {
+		auto contents = vcpZeroedEntry<VCPTableOfContents>();
+		contents.setLayouts = append(m_setLayouts.data(), m_setLayouts.size());
+		contents.archetypes = append(m_archetypes.data(), m_archetypes.size());
+		contents.graphicsInstances = append(m_graphicsInstances.data(), m_graphicsInstances.size());
+		contents.computeInstances = append(m_computeInstances.data(), m_computeInstances.size());
+		contents.graphicsNameTable = appendNameTable(m_graphicsNameHashes);
+		contents.computeNameTable = appendNameTable(m_computeNameHashes);
+		contents.fileSize = m_data.size();
+
+		VCPFileHeader header;
+		std::memcpy(m_data.data(), &header, sizeof(VCPFileHeader));
+		std::memcpy(m_data.data() + sizeof(VCPFileHeader), &contents, sizeof(VCPTableOfContents));
+		return std::move(m_data);
+	}
+
+	// Number of shaders that reused the code of a byte-identical shader added before
+	size_t sharedShaderCount() const { return m_sharedShaderCount; }
+	size_t storedShaderCodeSize() const { return m_storedShaderCodeSize; }
+
+  private:
+	template <typename T> VCPRange<T> append(const T* elements, size_t count, size_t alignment = alignof(T)) {
+		size_t offset = (m_data.size() + alignment - 1) / alignment * alignment;
+		m_data.resize(offset + count * sizeof(T));
+		if (count) {
+			std::memcpy(m_data.data() + offset, elements, count * sizeof(T));
+		}
+		return { .offset = offset, .count = count };
+	}
+
+	// Shader code is only stored once, archetypes with byte-identical modules point to the same range. Libraries
+	// contain few enough shaders that comparing hashes linearly doesn't show up next to compilation.
+	VCPRange<char> appendShaderCode(const char* code, size_t size) {
+		uint64_t hash = vcpNameHash(std::string_view(code, size));
+		for (size_t i = 0; i < m_shaderCodeHashes.size(); ++i) {
+			auto& range = m_shaderCodeRanges[i];
+			if (m_shaderCodeHashes[i] == hash && range.count == size &&
+				(!size || std::memcmp(m_data.data() + range.offset, code, size) == 0)) {
+				++m_sharedShaderCount;
+				return range;
+			}
+		}
+		auto range = append(code, size, vcpShaderCodeAlignment);
+		m_shaderCodeHashes.push_back(hash);
+		m_shaderCodeRanges.push_back(range);
+		m_storedShaderCodeSize += size;
+		return range;
+	}
+
+	// Instances with the same name are found in the order they were added, like with a linear search
+	VCPRange<uint32_t> appendNameTable(const std::vector<uint64_t>& nameHashes) {
+		size_t bucketCount = 1;
+		while (bucketCount < nameHashes.size() * 2) {
+			bucketCount *= 2;
+		}
+		std::vector<uint32_t> buckets = std::vector<uint32_t>(bucketCount, 0);
+		for (size_t i = 0; i < nameHashes.size(); ++i) {
+			size_t bucket = nameHashes[i] & (bucketCount - 1);
+			while (buckets[bucket]) {
+				bucket = (bucket + 1) & (bucketCount - 1);
+			}
+			buckets[bucket] = static_cast<uint32_t>(i + 1);
+		}
+		return append(buckets.data(), buckets.size());
+	}
+
+	std::vector<char> m_data;
+	std::vector<VCPSetLayoutEntry> m_setLayouts;
+	std::vector<VCPArchetypeEntry> m_archetypes;
+	std::vector<VCPInstanceEntry> m_graphicsInstances;
+	std::vector<VCPInstanceEntry> m_computeInstances;
+	std::vector<uint64_t> m_graphicsNameHashes;
+	std::vector<uint64_t> m_computeNameHashes;
+	std::vector<uint64_t> m_shaderCodeHashes;
+	std::vector<VCPRange<char>> m_shaderCodeRanges;
+	size_t m_sharedShaderCount = 0;
+	size_t m_storedShaderCodeSize = 0;
+};
+
+// Reads a version 5 file after its header and converts it to the current version
+inline std::vector<char> convertLegacyVCPLibrary(std::ifstream& inStream) {
+	VCPLibraryWriter writer;
+	for (auto& setLayout : deserializeVector<std::vector<DescriptorBindingLayoutInfo>>(inStream)) {
+		writer.addSetLayout(setLayout);
+	}
+
+	while (true) {
+		PipelineType type = deserialize<PipelineType>(inStream);
+		if (inStream.eof()) {
+			break;
+		}
+		std::vector<CompiledShader> shaders = deserializeVector<CompiledShader>(inStream);
+		std::vector<uint32_t> setLayoutIndices = deserializeVector<uint32_t>(inStream);
+		std::vector<VkPushConstantRange> pushConstantRanges = deserializeVector<VkPushConstantRange>(inStream);
+		writer.addArchetype(type, shaders, setLayoutIndices, pushConstantRanges);
+		for (auto& shader : shaders) {
+			delete[] static_cast<char*>(shader.data);
+		}
+
+		for (auto& instance : deserializeVector<PipelineInstanceData>(inStream)) {
+			writer.addInstance(instance);
+		}
+	}
+	return writer.finish();
+}
+
+// Checks all ranges of a version 6 file once, so that they can be used without checks afterwards. The data must be
+// aligned to vcpShaderCodeAlignment and outlive the view.
+class VCPLibraryView {
+  public:
+	bool open(const char* data, size_t size) {
+		m_data = data;
+		m_size = size;
+		if (reinterpret_cast<uintptr_t>(data) % vcpShaderCodeAlignment ||
+			size < sizeof(VCPFileHeader) + sizeof(VCPTableOfContents)) {
+			return false;
+		}
+		VCPFileHeader header;
+		std::memcpy(&header, data, sizeof(VCPFileHeader));
+		if (header.magic != vcpMagicNumber || header.version != vcpFileVersion) {
+			return false;
+		}
+		std::memcpy(&m_contents, data + sizeof(VCPFileHeader), sizeof(VCPTableOfContents));
+		if (m_contents.fileSize != size || !isValid(m_contents.setLayouts) || !isValid(m_contents.archetypes) ||
+			!isValid(m_contents.graphicsInstances) || !isValid(m_contents.computeInstances) ||
+			!isValid(m_contents.graphicsNameTable) || !isValid(m_contents.computeNameTable)) {
+			return false;
+		}
+
+		for (auto& setLayout : setLayouts()) {
+			if (!isValid(setLayout.bindings)) {
+				return false;
+			}
+			for (auto& binding : elements(setLayout.bindings)) {
+				if (!isValid(binding.immutableSamplers) ||
+					binding.immutableSamplers.count != (binding.usesImmutableSamplers ? binding.descriptorCount : 0)) {
+					return false;
+				}
+			}
+		}
+
+		for (auto& archetype : archetypes()) {
+			if ((archetype.type != PipelineType::Graphics && archetype.type != PipelineType::Compute) ||
+				!isValid(archetype.shaders) || !isValid(archetype.setLayoutIndices) ||
+				!isValid(archetype.pushConstantRanges)) {
+				return false;
+			}
+			if (archetype.type == PipelineType::Compute && archetype.shaders.count != 1) {
+				return false;
+			}
+			for (auto& shader : elements(archetype.shaders)) {
+				if (!isValid(shader.code, vcpShaderCodeAlignment)) {
+					return false;
+				}
+			}
+			for (auto index : elements(archetype.setLayoutIndices)) {
+				if (index >= m_contents.setLayouts.count) {
+					return false;
+				}
+			}
+		}
+
+		return areInstancesValid(graphicsInstances(), PipelineType::Graphics) &&
+			   areInstancesValid(computeInstances(), PipelineType::Compute) &&
+			   isNameTableValid(m_contents.graphicsNameTable, m_contents.graphicsInstances.count) &&
+			   isNameTableValid(m_contents.computeNameTable, m_contents.computeInstances.count);
+	}
+
+	template <typename T> std::span<const T> elements(VCPRange<T> range) const {
+		return { reinterpret_cast<const T*>(m_data + range.offset), static_cast<size_t>(range.count) };
+	}
+
+	std::span<const VCPSetLayoutEntry> setLayouts() const { return elements(m_contents.setLayouts); }
+	std::span<const VCPArchetypeEntry> archetypes() const { return elements(m_contents.archetypes); }
+	std::span<const VCPInstanceEntry> graphicsInstances() const { return elements(m_contents.graphicsInstances); }
+	std::span<const VCPInstanceEntry> computeInstances() const { return elements(m_contents.computeInstances); }
+
+	// Null-terminated, so it can also be used as a C string
+	std::string_view name(const VCPInstanceEntry& instance) const {
+		return { m_data + instance.name.offset, static_cast<size_t>(instance.name.count) };
+	}
+
+	// Returns ~0U if there is no instance with the name
+	uint32_t findGraphicsInstance(std::string_view name) const {
+		return findInstance(m_contents.graphicsNameTable, graphicsInstances(), name);
+	}
+	uint32_t findComputeInstance(std::string_view name) const {
+		return findInstance(m_contents.computeNameTable, computeInstances(), name);
+	}
+
+  private:
+	template <typename T> bool isValid(VCPRange<T> range, uint64_t alignment = alignof(T)) const {
+		return range.offset % alignment == 0 && range.offset <= m_size &&
+			   range.count <= (m_size - range.offset) / sizeof(T);
+	}
+
+	bool areInstancesValid(std::span<const VCPInstanceEntry> instances, PipelineType type) const {
+		for (auto& instance : instances) {
+			if (instance.archetypeIndex >= m_contents.archetypes.count ||
+				archetypes()[instance.archetypeIndex].type != type) {
+				return false;
+			}
+			if (instance.name.count >= m_size ||
+				!isValid(VCPRange<char>{ .offset = instance.name.offset, .count = instance.name.count + 1 }) ||
+				m_data[instance.name.offset + instance.name.count] != '\0') {
+				return false;
+			}
+			if (!isValid(instance.attributes) || !isValid(instance.bindings) || !isValid(instance.viewports) ||
+				!isValid(instance.scissorRects) || !isValid(instance.dynamicStates) ||
+				!isValid(instance.colorAttachmentBlendConfigs) || !isValid(instance.specializations)) {
+				return false;
+			}
+
+			auto shaders = elements(archetypes()[instance.archetypeIndex].shaders);
+			for (auto& specialization : elements(instance.specializations)) {
+				if (!isValid(specialization.mapEntries) || !isValid(specialization.data)) {
+					return false;
+				}
+				bool hasStage = false;
+				for (auto& shader : shaders) {
+					hasStage |= shader.stage == specialization.stage;
+				}
+				if (!hasStage) {
+					return false;
+				}
+				for (auto& mapEntry : elements(specialization.mapEntries)) {
+					if (mapEntry.offset > specialization.data.count ||
+						mapEntry.size > specialization.data.count - mapEntry.offset) {
+						return false;
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	bool isNameTableValid(VCPRange<uint32_t> table, uint64_t instanceCount) const {
+		if (table.count == 0 || (table.count & (table.count - 1))) {
+			return false;
+		}
+		for (auto value : elements(table)) {
+			if (value > instanceCount) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	uint32_t findInstance(VCPRange<uint32_t> table, std::span<const VCPInstanceEntry> instances,
+						  std::string_view name) const {
+		auto buckets = elements(table);
+		size_t bucket = vcpNameHash(name) & (buckets.size() - 1);
+		for (size_t i = 0; i < buckets.size(); ++i) {
+			uint32_t value = buckets[bucket];
+			if (!value) {
+				return ~0U;
+			}
+			if (this->name(instances[value - 1]) == name) {
+				return value - 1;
+			}
+			bucket = (bucket + 1) & (buckets.size() - 1);
+		}
+		return ~0U;
+	}
+
+	const char* m_data = nullptr;
+	size_t m_size = 0;
+	VCPTableOfContents m_contents;
+};
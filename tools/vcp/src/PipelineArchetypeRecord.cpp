@@ -1,6 +1,7 @@
 #include <EnumMatchTable.hpp>
 #include <ParsingUtils.hpp>
 #include <PipelineArchetypeRecord.hpp>
+#include <PipelineInstanceRecord.hpp>
 #include <algorithm>
 #include <iostream>
 #include <optional>
@@ -297,75 +298,24 @@ PipelineArchetypeRecord::PipelineArchetypeRecord(
 	m_isValid = true;
 }
 
-void PipelineArchetypeRecord::compileShaders(const std::string& tempDir, const std::string& compilerCommand,
-											 const std::vector<std::string>& additionalArgs) {
-	m_compilerSubprocessIDs.clear();
-	m_compilerSubprocessIDs.reserve(m_files.size());
-	for (auto& file : m_files) {
-		std::string dstFile;
-		switch (file.stage) {
-			case VK_SHADER_STAGE_VERTEX_BIT:
-				dstFile = tempDir + "/vert.bin";
-				break;
-			case VK_SHADER_STAGE_FRAGMENT_BIT:
-				dstFile = tempDir + "/frag.bin";
-				break;
-			case VK_SHADER_STAGE_COMPUTE_BIT:
-				dstFile = tempDir + "/comp.bin";
-				break;
-			default:
-				break;
-		}
-
-		std::vector<const char*> args = { file.path.c_str(), "-o", dstFile.c_str() };
-		// source file, -o, dst file + command + additional args
-		args.reserve(3 + additionalArgs.size());
-		for (auto& arg : additionalArgs) {
-			args.push_back(arg.c_str());
-		}
-
-		m_compilerSubprocessIDs.push_back(startSubprocess(compilerCommand.c_str(), args));
-	}
-}
-
-std::vector<ReflectedShader> PipelineArchetypeRecord::retrieveCompileResults(const std::string_view& srcPath,
-																						const std::string& tempDir) {
-	size_t subprocessIDIndex = 0;
-
+std::vector<ReflectedShader> PipelineArchetypeRecord::retrieveCompileResults(
+	const std::string_view& srcPath, std::span<const ShaderCompileResult> results) {
 	std::vector<ReflectedShader> shaderModules;
 	shaderModules.reserve(m_files.size());
 
-	for (auto& file : m_files) {
-		std::string srcFile;
-		switch (file.stage) {
-			case VK_SHADER_STAGE_VERTEX_BIT:
-				srcFile = tempDir + "/vert.bin";
-				break;
-			case VK_SHADER_STAGE_FRAGMENT_BIT:
-				srcFile = tempDir + "/frag.bin";
-				break;
-			case VK_SHADER_STAGE_COMPUTE_BIT:
-				srcFile = tempDir + "/comp.bin";
-				break;
-			default:
-				break;
-		}
-
-		waitForSubprocess(m_compilerSubprocessIDs[subprocessIDIndex]);
-
-		size_t fileSize;
-		void* data = readFile(srcFile.c_str(), &fileSize);
-
-		if (data) {
-			m_compiledShaders.push_back({ .stage = file.stage, .dataSize = fileSize, .data = data });
+	for (size_t i = 0; i < m_files.size(); ++i) {
+		if (results[i].succeeded) {
+			char* data = new char[results[i].code.size()];
+			std::memcpy(data, results[i].code.data(), results[i].code.size());
+			m_compiledShaders.push_back(
+				{ .stage = m_files[i].stage, .dataSize = results[i].code.size(), .data = data });
 
 			SpvReflectShaderModule shaderModule;
-			spvReflectCreateShaderModule(fileSize, data, &shaderModule);
-			shaderModules.push_back({ .stage = file.stage, .shader = shaderModule });
+			spvReflectCreateShaderModule(results[i].code.size(), data, &shaderModule);
+			shaderModules.push_back({ .stage = m_files[i].stage, .shader = shaderModule });
 		} else {
-			std::cout << srcPath << ": Warning: Compiled file expected but could not be read, did compilation fail?\n";
+			std::cout << srcPath << ": Warning: Compiling " << m_files[i].path << " failed.\n";
 		}
-		++subprocessIDIndex;
 	}
 
 	return shaderModules;
@@ -455,11 +405,52 @@ void PipelineArchetypeRecord::verifyArchetype(
 	}
 }
 
-void PipelineArchetypeRecord::serialize(std::ofstream& outStream) {
-	::serialize(m_pipelineType, outStream);
-	serializeVector(m_compiledShaders, outStream);
-	serializeVector(m_setLayoutIndices, outStream);
-	serializeVector(m_pushConstantRanges, outStream);
+void PipelineArchetypeRecord::optimizeShaders(const std::string_view& srcPath,
+											  const std::vector<PipelineInstanceRecord>& instanceRecords,
+											  const SpirvOptimizationOptions& options) {
+	for (auto& shader : m_compiledShaders) {
+		if (shader.dataSize % sizeof(uint32_t)) {
+			std::cout << srcPath << ": Warning: Shader code size isn't a multiple of 4, skipping optimization.\n";
+			continue;
+		}
+
+		std::vector<uint32_t> specializedConstantIDs;
+		for (auto& instanceRecord : instanceRecords) {
+			for (auto& stageConfig : instanceRecord.data().instanceSpecializationConfigs) {
+				if (stageConfig.stage != shader.stage) {
+					continue;
+				}
+				for (auto& config : stageConfig.configs) {
+					specializedConstantIDs.push_back(config.mapEntry.constantID);
+				}
+			}
+		}
+
+		std::vector<uint32_t> code = std::vector<uint32_t>(shader.dataSize / sizeof(uint32_t));
+		std::memcpy(code.data(), shader.data, shader.dataSize);
+		std::vector<std::string> warnings;
+		std::vector<uint32_t> optimizedCode = optimizeSpirv(code, specializedConstantIDs, options, warnings);
+		for (auto& warning : warnings) {
+			std::cout << srcPath << ": Warning: " << warning << "\n";
+		}
+
+		delete[] static_cast<char*>(shader.data);
+		shader.dataSize = optimizedCode.size() * sizeof(uint32_t);
+		shader.data = new char[shader.dataSize];
+		std::memcpy(shader.data, optimizedCode.data(), shader.dataSize);
+	}
+}
+
+size_t PipelineArchetypeRecord::shaderCodeSize() const {
+	size_t size = 0;
+	for (auto& shader : m_compiledShaders) {
+		size += shader.dataSize;
+	}
+	return size;
+}
+
+void PipelineArchetypeRecord::write(VCPLibraryWriter& writer) const {
+	writer.addArchetype(m_pipelineType, m_compiledShaders, m_setLayoutIndices, m_pushConstantRanges);
 }
 
 void PipelineArchetypeRecord::freeShaders() {
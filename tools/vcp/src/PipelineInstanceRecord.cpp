@@ -91,7 +91,7 @@ void PipelineInstanceRecord::verifyFragmentShader(const std::string_view& srcPat
 	}
 }
 
-void PipelineInstanceRecord::serialize(std::ofstream& outStream) const { ::serialize(m_data, outStream); }
+void PipelineInstanceRecord::write(VCPLibraryWriter& writer) const { writer.addInstance(m_data); }
 
 void PipelineInstanceRecord::deserializeVertexInput(const std::string_view& srcPath, const Json::Value& config) {
 	if (config.type() != Json::objectValue) {
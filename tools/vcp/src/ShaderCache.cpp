@@ -0,0 +1,255 @@
+#include <ShaderCache.hpp>
+#include <SysUtils.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <util/WorkerPool.hpp>
+
+using namespace std::filesystem;
+
+namespace {
+	// Changing how keys are computed must change this, so that old entries aren't matched by accident
+	constexpr uint64_t cacheKeyVersion = 1;
+
+	void hashBytes(uint64_t& hash, const void* data, size_t size) {
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < size; ++i) {
+			hash ^= bytes[i];
+			hash *= 0x100000001B3ULL;
+		}
+	}
+
+	// The length is hashed as well, so that the boundaries between strings are part of the key
+	void hashString(uint64_t& hash, const std::string& string) {
+		size_t size = string.size();
+		hashBytes(hash, &size, sizeof(size_t));
+		hashBytes(hash, string.data(), string.size());
+	}
+
+	std::optional<std::vector<char>> readFileData(const path& filePath) {
+		auto stream = std::ifstream(filePath, std::ios::binary);
+		if (!stream.is_open()) {
+			return std::nullopt;
+		}
+		return std::vector<char>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	}
+
+	struct IncludeDirective {
+		std::string name;
+		// Quoted includes are searched relative to the including file first
+		bool isQuoted;
+	};
+
+	// Finds #include lines the way the GL_GOOGLE_include_directive extension does. Includes inside comments or
+	// disabled preprocessor blocks are reported as well, which only makes the key depend on more files than needed.
+	std::vector<IncludeDirective> findIncludes(const std::vector<char>& source) {
+		std::vector<IncludeDirective> includes;
+		auto skipSpaces = [&source](size_t index) {
+			while (index < source.size() && (source[index] == ' ' || source[index] == '\t')) {
+				++index;
+			}
+			return index;
+		};
+
+		size_t lineStart = 0;
+		while (lineStart < source.size()) {
+			size_t lineEnd = lineStart;
+			while (lineEnd < source.size() && source[lineEnd] != '\n') {
+				++lineEnd;
+			}
+
+			constexpr std::string_view includeKeyword = "include";
+			size_t index = skipSpaces(lineStart);
+			if (index < lineEnd && source[index] == '#') {
+				index = skipSpaces(index + 1);
+				if (lineEnd - index > includeKeyword.size() &&
+					std::string_view(source.data() + index, includeKeyword.size()) == includeKeyword) {
+					index = skipSpaces(index + includeKeyword.size());
+					char closingChar = '\0';
+					if (index < lineEnd) {
+						closingChar = source[index] == '"' ? '"' : (source[index] == '<' ? '>' : '\0');
+					}
+					size_t nameEnd = index + 1;
+					while (closingChar && nameEnd < lineEnd && source[nameEnd] != closingChar) {
+						++nameEnd;
+					}
+					if (closingChar && nameEnd < lineEnd) {
+						includes.push_back({ .name = std::string(source.data() + index + 1, nameEnd - index - 1),
+											 .isQuoted = closingChar == '"' });
+					}
+				}
+			}
+			lineStart = lineEnd + 1;
+		}
+		return includes;
+	}
+} // namespace
+
+ShaderCache::ShaderCache(const path& cacheDir, const std::string& compilerCommand,
+						 const std::vector<std::string>& compilerArgs)
+	: m_cacheDir(cacheDir), m_compilerCommand(compilerCommand), m_compilerArgs(compilerArgs) {
+	std::error_code error;
+	create_directories(m_cacheDir, error);
+
+	// Include directories can be given as "-Idir" or as "-I dir"
+	for (size_t i = 0; i < m_compilerArgs.size(); ++i) {
+		if (m_compilerArgs[i] == "-I" && i + 1 < m_compilerArgs.size()) {
+			m_includeDirs.push_back(m_compilerArgs[++i]);
+		} else if (m_compilerArgs[i].starts_with("-I")) {
+			m_includeDirs.push_back(m_compilerArgs[i].substr(2));
+		}
+	}
+}
+
+std::vector<ShaderCompileResult> ShaderCache::compile(const std::vector<std::string>& sourcePaths,
+													  uint32_t threadCount) {
+	std::vector<uint64_t> keys;
+	std::vector<size_t> sourceJobIndices;
+	// Index of the first source with the key, for every job
+	std::vector<size_t> jobSourceIndices;
+	std::unordered_map<uint64_t, size_t> jobIndices;
+	keys.reserve(sourcePaths.size());
+	sourceJobIndices.reserve(sourcePaths.size());
+	for (size_t i = 0; i < sourcePaths.size(); ++i) {
+		uint64_t key = cacheKey(sourcePaths[i]);
+		auto [iterator, isNewKey] = jobIndices.try_emplace(key, jobSourceIndices.size());
+		if (isNewKey) {
+			jobSourceIndices.push_back(i);
+		}
+		keys.push_back(key);
+		sourceJobIndices.push_back(iterator->second);
+		m_usedKeys.insert(key);
+	}
+
+	// The workers spend nearly all of their time waiting for compiler processes
+	std::vector<ShaderCompileResult> jobResults(jobSourceIndices.size());
+	vanadium::WorkerPool pool;
+	pool.create(static_cast<uint32_t>(std::min(static_cast<size_t>(threadCount), jobSourceIndices.size())));
+	pool.dispatch(jobSourceIndices.size(), [this, &sourcePaths, &keys, &jobSourceIndices,
+											&jobResults](size_t jobIndex, uint32_t) {
+		size_t sourceIndex = jobSourceIndices[jobIndex];
+		jobResults[jobIndex] = compileEntry(sourcePaths[sourceIndex], keys[sourceIndex]);
+	});
+	pool.wait();
+
+	for (auto& result : jobResults) {
+		if (result.wasCached) {
+			++m_hitCount;
+		} else {
+			++m_missCount;
+		}
+	}
+
+	std::vector<ShaderCompileResult> results;
+	results.reserve(sourcePaths.size());
+	for (auto jobIndex : sourceJobIndices) {
+		results.push_back(jobResults[jobIndex]);
+	}
+	return results;
+}
+
+uint64_t ShaderCache::cacheKey(const std::string& sourcePath) const {
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	hashBytes(hash, &cacheKeyVersion, sizeof(uint64_t));
+	hashString(hash, m_compilerCommand);
+	for (auto& arg : m_compilerArgs) {
+		hashString(hash, arg);
+	}
+	// glslc derives the shader stage from the file extension
+	hashString(hash, path(sourcePath).extension().string());
+
+	// Files are hashed in the order they are first included in, each file only once
+	std::vector<path> pendingFiles = { path(sourcePath) };
+	std::unordered_set<std::string> visitedFiles = { absolute(sourcePath).lexically_normal().string() };
+	while (!pendingFiles.empty()) {
+		path filePath = std::move(pendingFiles.back());
+		pendingFiles.pop_back();
+
+		auto data = readFileData(filePath);
+		if (!data) {
+			hashString(hash, "<missing>");
+			continue;
+		}
+		hashString(hash, std::string(data->begin(), data->end()));
+
+		auto includes = findIncludes(*data);
+		// Reversed, so that the first include is hashed next
+		for (auto iterator = includes.rbegin(); iterator != includes.rend(); ++iterator) {
+			std::vector<path> candidates;
+			if (iterator->isQuoted) {
+				candidates.push_back(filePath.parent_path() / iterator->name);
+			}
+			for (auto& includeDir : m_includeDirs) {
+				candidates.push_back(includeDir / iterator->name);
+			}
+
+			auto includedPath = std::find_if(candidates.begin(), candidates.end(), [](const path& candidate) {
+				std::error_code error;
+				return is_regular_file(candidate, error);
+			});
+			// An include that can't be resolved now can start resolving once the file is created
+			hashString(hash, iterator->name);
+			if (includedPath == candidates.end()) {
+				hashString(hash, "<unresolved>");
+				continue;
+			}
+			if (visitedFiles.insert(absolute(*includedPath).lexically_normal().string()).second) {
+				pendingFiles.push_back(*includedPath);
+			}
+		}
+	}
+	return hash;
+}
+
+void ShaderCache::removeUnusedEntries() {
+	std::error_code error;
+	for (auto& entry : directory_iterator(m_cacheDir, error)) {
+		auto extension = entry.path().extension();
+		bool isUsed = false;
+		if (extension == ".spv") {
+			std::string stem = entry.path().stem().string();
+			char* stemEnd;
+			uint64_t key = std::strtoull(stem.c_str(), &stemEnd, 16);
+			isUsed = stem.size() == 16 && *stemEnd == '\0' && m_usedKeys.contains(key);
+		}
+		// Also removes temporary files left behind by interrupted compilations
+		if (!isUsed) {
+			remove(entry.path(), error);
+		}
+	}
+}
+
+path ShaderCache::entryPath(uint64_t key) const { return m_cacheDir / fmt::format("{:016x}.spv", key); }
+
+ShaderCompileResult ShaderCache::compileEntry(const std::string& sourcePath, uint64_t key) const {
+	path cachedPath = entryPath(key);
+	if (auto code = readFileData(cachedPath)) {
+		return { .succeeded = true, .wasCached = true, .code = std::move(*code) };
+	}
+
+	// The compiler writes to a temporary file, so that interrupted compilations don't leave broken entries behind
+	path tempPath = cachedPath;
+	tempPath += ".tmp";
+	std::string tempPathString = tempPath.string();
+	std::vector<const char*> args = { sourcePath.c_str(), "-o", tempPathString.c_str() };
+	// source file, -o, dst file + additional args
+	args.reserve(3 + m_compilerArgs.size());
+	for (auto& arg : m_compilerArgs) {
+		args.push_back(arg.c_str());
+	}
+
+	std::error_code error;
+	bool succeeded = waitForSubprocess(startSubprocess(m_compilerCommand.c_str(), args));
+	std::optional<std::vector<char>> code = succeeded ? readFileData(tempPath) : std::nullopt;
+	if (!code) {
+		remove(tempPath, error);
+		return { .succeeded = false, .wasCached = false, .code = {} };
+	}
+	rename(tempPath, cachedPath, error);
+	return { .succeeded = true, .wasCached = false, .code = std::move(*code) };
+}
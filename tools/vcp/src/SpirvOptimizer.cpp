@@ -0,0 +1,247 @@
+#include <SpirvOptimizer.hpp>
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef VCP_SPIRV_TOOLS
+#include <spirv-tools/optimizer.hpp>
+#endif
+
+namespace {
+	constexpr uint32_t spirvMagicNumber = 0x07230203;
+	constexpr size_t spirvHeaderWordCount = 5;
+
+	// Opcodes from the SPIR-V specification
+	enum SpirvOpcode : uint32_t {
+		OpSourceContinued = 2,
+		OpSource = 3,
+		OpSourceExtension = 4,
+		OpName = 5,
+		OpMemberName = 6,
+		OpString = 7,
+		OpLine = 8,
+		OpExtension = 10,
+		OpExtInstImport = 11,
+		OpExtInst = 12,
+		OpConstantTrue = 41,
+		OpConstantFalse = 42,
+		OpConstant = 43,
+		OpSpecConstantTrue = 48,
+		OpSpecConstantFalse = 49,
+		OpSpecConstant = 50,
+		OpDecorate = 71,
+		OpNoLine = 317,
+		OpModuleProcessed = 330
+	};
+	constexpr uint32_t spirvDecorationSpecId = 1;
+
+	struct SpirvInstruction {
+		size_t offset;
+		uint32_t opcode;
+		uint32_t wordCount;
+	};
+
+	// Returns false if the module has no valid header, is truncated or contains an instruction with a word count of 0.
+	// Modules in the other byte order aren't supported, compilers write them in the byte order of the host.
+	bool parseInstructions(const std::vector<uint32_t>& code, std::vector<SpirvInstruction>& instructions) {
+		if (code.size() < spirvHeaderWordCount || code[0] != spirvMagicNumber) {
+			return false;
+		}
+		size_t offset = spirvHeaderWordCount;
+		while (offset < code.size()) {
+			uint32_t wordCount = code[offset] >> 16;
+			if (wordCount == 0 || offset + wordCount > code.size()) {
+				return false;
+			}
+			instructions.push_back({ .offset = offset, .opcode = code[offset] & 0xFFFF, .wordCount = wordCount });
+			offset += wordCount;
+		}
+		return true;
+	}
+
+	// Literal strings are NUL-terminated and padded to whole words
+	std::string_view literalString(const std::vector<uint32_t>& code, size_t wordOffset, size_t wordEnd) {
+		const char* characters = reinterpret_cast<const char*>(code.data() + wordOffset);
+		return std::string_view(characters, strnlen(characters, (wordEnd - wordOffset) * sizeof(uint32_t)));
+	}
+
+	void removeInstructions(std::vector<uint32_t>& code, const std::vector<SpirvInstruction>& instructions,
+							const std::vector<bool>& isRemoved) {
+		std::vector<uint32_t> result(code.begin(), code.begin() + spirvHeaderWordCount);
+		result.reserve(code.size());
+		for (size_t i = 0; i < instructions.size(); ++i) {
+			if (!isRemoved[i]) {
+				result.insert(result.end(), code.begin() + instructions[i].offset,
+							  code.begin() + instructions[i].offset + instructions[i].wordCount);
+			}
+		}
+		code = std::move(result);
+	}
+
+#ifdef VCP_SPIRV_TOOLS
+	// The optimizer rejects modules of a newer SPIR-V version than its environment allows
+	spv_target_env optimizerEnvironment(uint32_t spirvVersion) {
+		uint32_t minorVersion = (spirvVersion >> 8) & 0xFF;
+		if (minorVersion == 0) {
+			return SPV_ENV_VULKAN_1_0;
+		} else if (minorVersion <= 3) {
+			return SPV_ENV_VULKAN_1_1;
+		} else if (minorVersion == 4) {
+			return SPV_ENV_VULKAN_1_1_SPIRV_1_4;
+		} else if (minorVersion == 5) {
+			return SPV_ENV_VULKAN_1_2;
+		}
+		return SPV_ENV_VULKAN_1_3;
+	}
+#endif
+} // namespace
+
+bool spirvOptimizerAvailable() {
+#ifdef VCP_SPIRV_TOOLS
+	return true;
+#else
+	return false;
+#endif
+}
+
+std::vector<uint32_t> optimizeSpirv(std::span<const uint32_t> code, std::span<const uint32_t> specializedConstantIDs,
+									const SpirvOptimizationOptions& options, std::vector<std::string>& warnings) {
+	std::vector<uint32_t> result = std::vector<uint32_t>(code.begin(), code.end());
+	if (options.freezeUnspecializedConstants && !freezeSpirvSpecConstants(result, specializedConstantIDs)) {
+		warnings.push_back("Specialization constants couldn't be frozen, the module is invalid.");
+	}
+
+	if (options.runOptimizer) {
+#ifdef VCP_SPIRV_TOOLS
+		spvtools::Optimizer optimizer = spvtools::Optimizer(optimizerEnvironment(result.size() > 1 ? result[1] : 0));
+		optimizer.SetMessageConsumer(
+			[&warnings](spv_message_level_t level, const char*, const spv_position_t&, const char* message) {
+				if (level <= SPV_MSG_WARNING) {
+					warnings.push_back(message);
+				}
+			});
+		optimizer.RegisterPerformancePasses();
+		std::vector<uint32_t> optimizedResult;
+		if (optimizer.Run(result.data(), result.size(), &optimizedResult)) {
+			result = std::move(optimizedResult);
+		} else {
+			warnings.push_back("Optimization failed, the module is stored without it.");
+		}
+#else
+		warnings.push_back("vcp was built without SPIRV-Tools, the module is stored without optimization.");
+#endif
+	}
+
+	if (options.stripDebugInfo && !stripSpirvDebugInfo(result)) {
+		warnings.push_back("Debug information couldn't be stripped, the module is invalid.");
+	}
+	return result;
+}
+
+bool freezeSpirvSpecConstants(std::vector<uint32_t>& code, std::span<const uint32_t> specializedConstantIDs) {
+	std::vector<SpirvInstruction> instructions;
+	if (!parseInstructions(code, instructions)) {
+		return false;
+	}
+
+	// Decorations precede the constants they decorate
+	std::unordered_map<uint32_t, size_t> specIDDecorationIndices;
+	std::vector<bool> isRemoved = std::vector<bool>(instructions.size(), false);
+	for (size_t i = 0; i < instructions.size(); ++i) {
+		auto& instruction = instructions[i];
+		if (instruction.opcode == OpDecorate && instruction.wordCount >= 4 &&
+			code[instruction.offset + 2] == spirvDecorationSpecId) {
+			specIDDecorationIndices[code[instruction.offset + 1]] = i;
+			continue;
+		}
+
+		uint32_t frozenOpcode;
+		switch (instruction.opcode) {
+			case OpSpecConstantTrue:
+				frozenOpcode = OpConstantTrue;
+				break;
+			case OpSpecConstantFalse:
+				frozenOpcode = OpConstantFalse;
+				break;
+			case OpSpecConstant:
+				frozenOpcode = OpConstant;
+				break;
+			default:
+				continue;
+		}
+		if (instruction.wordCount < 3) {
+			return false;
+		}
+
+		// Constants without a SpecId can't be set by pipelines, so they are always frozen
+		auto decoration = specIDDecorationIndices.find(code[instruction.offset + 2]);
+		if (decoration != specIDDecorationIndices.end()) {
+			uint32_t specID = code[instructions[decoration->second].offset + 3];
+			if (std::find(specializedConstantIDs.begin(), specializedConstantIDs.end(), specID) !=
+				specializedConstantIDs.end()) {
+				continue;
+			}
+			isRemoved[decoration->second] = true;
+		}
+		code[instruction.offset] = (instruction.wordCount << 16) | frozenOpcode;
+	}
+
+	removeInstructions(code, instructions, isRemoved);
+	return true;
+}
+
+bool stripSpirvDebugInfo(std::vector<uint32_t>& code) {
+	std::vector<SpirvInstruction> instructions;
+	if (!parseInstructions(code, instructions)) {
+		return false;
+	}
+
+	// Extended instruction sets starting with "NonSemantic." can be removed without changing the meaning of the
+	// module, like NonSemantic.Shader.DebugInfo.100 written by glslc -g
+	std::unordered_set<uint32_t> nonSemanticSetIDs;
+	for (auto& instruction : instructions) {
+		if (instruction.opcode == OpExtInstImport && instruction.wordCount >= 3 &&
+			literalString(code, instruction.offset + 2, instruction.offset + instruction.wordCount)
+				.starts_with("NonSemantic.")) {
+			nonSemanticSetIDs.insert(code[instruction.offset + 1]);
+		}
+	}
+
+	std::vector<bool> isRemoved = std::vector<bool>(instructions.size(), false);
+	for (size_t i = 0; i < instructions.size(); ++i) {
+		auto& instruction = instructions[i];
+		switch (instruction.opcode) {
+			case OpSourceContinued:
+			case OpSource:
+			case OpSourceExtension:
+			case OpName:
+			case OpMemberName:
+			case OpString:
+			case OpLine:
+			case OpNoLine:
+			case OpModuleProcessed:
+				isRemoved[i] = true;
+				break;
+			case OpExtension:
+				// All non-semantic instructions are removed, so the extension allowing them isn't needed anymore
+				isRemoved[i] =
+					instruction.wordCount >= 2 &&
+					literalString(code, instruction.offset + 1, instruction.offset + instruction.wordCount) ==
+						"SPV_KHR_non_semantic_info";
+				break;
+			case OpExtInstImport:
+				isRemoved[i] = instruction.wordCount >= 2 && nonSemanticSetIDs.contains(code[instruction.offset + 1]);
+				break;
+			case OpExtInst:
+				isRemoved[i] = instruction.wordCount >= 4 && nonSemanticSetIDs.contains(code[instruction.offset + 3]);
+				break;
+			default:
+				break;
+		}
+	}
+
+	removeInstructions(code, instructions, isRemoved);
+	return true;
+}
@@ -35,7 +35,8 @@ SubprocessID startSubprocess(const char* processName, const std::vector<const ch
 	switch (childPID) {
 		case 0:
 			execvp(processName, argArray);
-			break;
+			// Only reached if the executable couldn't be started, the child must not continue running vcp
+			_exit(127);
 		case -1:
 			std::cout << "Error: Failed to open subprocess, exiting!" << std::endl;
 			std::exit(EXIT_FAILURE);
@@ -48,9 +49,12 @@ SubprocessID startSubprocess(const char* processName, const std::vector<const ch
 	return { -1 }; // unreachable but silences compiler warning
 }
 
-void waitForSubprocess(const SubprocessID& id) { 
+bool waitForSubprocess(const SubprocessID& id) {
 	int status;
-	waitpid(id.childPID, &status, 0);
+	if (waitpid(id.childPID, &status, 0) == -1) {
+		return false;
+	}
+	return WIFEXITED(status) && WEXITSTATUS(status) == 0;
 }
 
 #elif defined(_WIN32)
@@ -93,10 +97,13 @@ SubprocessID startSubprocess(const char* processName, const std::vector<const ch
 	return { .processHandle = processInfo.hProcess, .threadHandle = processInfo.hThread };
 }
 
-void waitForSubprocess(const SubprocessID& id) { 
+bool waitForSubprocess(const SubprocessID& id) {
 	WaitForSingleObject(id.processHandle, INFINITE);
+	DWORD exitCode;
+	bool succeeded = GetExitCodeProcess(id.processHandle, &exitCode) && exitCode == 0;
 	CloseHandle(id.processHandle);
 	CloseHandle(id.threadHandle);
+	return succeeded;
 }
 #else
 #error Unsupported platform encountered, currently only supporting Windows and Linux.
@@ -1,16 +1,20 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <limits>
+#include <span>
 #include <string_view>
+#include <thread>
 #include <vector>
-#include <ctime>
 
 #include <filesystem>
 
 #include <ParsingUtils.hpp>
 #include <PipelineArchetypeRecord.hpp>
 #include <PipelineInstanceRecord.hpp>
-#include <SysUtils.hpp>
+#include <ShaderCache.hpp>
 
 #include <unordered_map>
 
@@ -21,6 +25,10 @@ struct Options {
 	std::vector<std::string> fileNames;
 	std::string compilerCommand = "glslc";
 	std::vector<std::string> additionalCommandArgs;
+	// Defaults to a directory next to the output file
+	std::string cacheDir;
+	uint32_t compilerThreadCount = std::max(std::thread::hardware_concurrency(), 1U);
+	SpirvOptimizationOptions optimizationOptions;
 };
 
 bool checkOption(int argc, char** argv, size_t index, const std::string_view& argName) {
@@ -45,6 +53,21 @@ size_t parseOption(int argc, char** argv, size_t index, Options& options) {
 			options.additionalCommandArgs = splitString(std::string(argv[index + 1]), ' ', false);
 			return index + 1;
 		}
+	} else if (argv[index] == std::string_view("--cache-dir")) {
+		if (checkOption(argc, argv, index, "--cache-dir")) {
+			options.cacheDir = argv[index + 1];
+			return index + 1;
+		}
+	} else if (argv[index] == std::string_view("-j")) {
+		if (checkOption(argc, argv, index, "-j")) {
+			options.compilerThreadCount = std::max(std::atoi(argv[index + 1]), 1);
+			return index + 1;
+		}
+	} else if (argv[index] == std::string_view("--optimize")) {
+		options.optimizationOptions.freezeUnspecializedConstants = true;
+		options.optimizationOptions.runOptimizer = true;
+	} else if (argv[index] == std::string_view("--strip-debug-info")) {
+		options.optimizationOptions.stripDebugInfo = true;
 	} else if (argv[index] == std::string_view("-o")) {
 		if (checkOption(argc, argv, index, "-o")) {
 			options.outFile = argv[index + 1];
@@ -59,6 +82,10 @@ size_t parseOption(int argc, char** argv, size_t index, Options& options) {
 Options parseArguments(int argc, char** argv) {
 	Options options;
 	for (size_t i = 1; i < static_cast<size_t>(argc); ++i) {
+		// Generator expressions in the CMake functions can evaluate to empty arguments
+		if (*argv[i] == '\0') {
+			continue;
+		}
 		if (*argv[i] == '-') {
 			i = parseOption(argc, argv, i, options);
 			continue;
@@ -83,42 +110,19 @@ int main(int argc, char** argv) {
 		return EXIT_FAILURE;
 	}
 
-	std::srand(std::clock());
-	path tempDirPath = path("./vcptemp-" + std::to_string(std::rand()));
-	std::error_code error;
-	if (exists(tempDirPath)) {
-		remove_all(tempDirPath);
-	}
-	if (!create_directory(tempDirPath, error)) {
-		std::cout << "Error: Could not create temporary shader output directory inside the project directory."
-				  << std::endl;
-		return EXIT_FAILURE;
-	}
-
 	std::ofstream outStream = std::ofstream(options.outFile, std::ios::trunc | std::ios::binary);
 	if (!outStream.is_open()) {
 		std::cout << "Error: Output file could not be opened for writing." << std::endl;
-		remove_all(tempDirPath);
 		return EXIT_FAILURE;
 	}
 
 	auto records = std::vector<PipelineRecord>();
-	std::vector<path> localRecordPaths;
 	std::vector<std::vector<DescriptorBindingLayoutInfo>> setLayoutInfos;
 
 	records.reserve(options.fileNames.size());
-	localRecordPaths.reserve(options.fileNames.size());
 
 	size_t recordIndex = 0;
 	for (auto& name : options.fileNames) {
-		path localRecordPath = tempDirPath;
-		if (!create_directory(localRecordPath.append(std::to_string(recordIndex)))) {
-			std::cout << "Error: Could not create temporary shader output directory inside the project directory."
-					  << std::endl;
-			remove_all(tempDirPath);
-			return EXIT_FAILURE;
-		}
-
 		path filePath = absolute(name);
 		size_t fileSize;
 		char* data = reinterpret_cast<char*>(readFile(name.c_str(), &fileSize));
@@ -126,7 +130,6 @@ int main(int argc, char** argv) {
 			std::cout << "Error: Pipeline file not found in the working directory." << std::endl;
 			outStream.close();
 			remove(options.outFile);
-			remove_all(tempDirPath);
 			return EXIT_FAILURE;
 		}
 
@@ -141,14 +144,12 @@ int main(int argc, char** argv) {
 			std::cout << "Error: JSON archetype is invalid." << std::endl;
 			outStream.close();
 			remove(options.outFile);
-			remove_all(tempDirPath);
 			return EXIT_FAILURE;
 		}
 		if (!rootValue["instances"].isArray()) {
 			std::cout << "Error: JSON instance array is invalid." << std::endl;
 			outStream.close();
 			remove(options.outFile);
-			remove_all(tempDirPath);
 			return EXIT_FAILURE;
 		}
 
@@ -159,13 +160,9 @@ int main(int argc, char** argv) {
 		if (!records[recordIndex].archetypeRecord.isValid()) {
 			outStream.close();
 			remove(options.outFile);
-			remove_all(tempDirPath);
 			return EXIT_FAILURE;
 		}
 
-		records[recordIndex].archetypeRecord.compileShaders(localRecordPath.string(), options.compilerCommand,
-															options.additionalCommandArgs);
-
 		std::vector<PipelineInstanceRecord> instanceRecords;
 		instanceRecords.reserve(rootValue["instances"].size());
 		for (auto& instance : rootValue["instances"]) {
@@ -173,15 +170,34 @@ int main(int argc, char** argv) {
 				PipelineInstanceRecord(records[recordIndex].archetypeRecord.type(), filePath.string(), instance));
 		}
 		records[recordIndex].instanceRecords = std::move(instanceRecords);
-		localRecordPaths.push_back(localRecordPath);
 		++recordIndex;
 	}
 
+	// Shaders of all archetypes are compiled in one batch, so that compilation isn't limited by the number of stages
+	// in a single archetype
+	std::vector<std::string> shaderSourcePaths;
+	for (auto& record : records) {
+		for (auto& file : record.archetypeRecord.sourceFiles()) {
+			shaderSourcePaths.push_back(file.path);
+		}
+	}
+
+	path cacheDirPath = options.cacheDir.empty() ? path(options.outFile + ".cache") : path(options.cacheDir);
+	ShaderCache shaderCache = ShaderCache(cacheDirPath, options.compilerCommand, options.additionalCommandArgs);
+	std::vector<ShaderCompileResult> compileResults =
+		shaderCache.compile(shaderSourcePaths, options.compilerThreadCount);
+	std::cout << "Compiled " << shaderCache.missCount() << " shaders, reused " << shaderCache.hitCount()
+			  << " from the cache.\n";
+
 	uint32_t fileNameIndex = 0;
+	size_t compileResultOffset = 0;
 	for (auto& record : records) {
 		path filePath = absolute(options.fileNames[fileNameIndex]);
-		auto shaders =
-			record.archetypeRecord.retrieveCompileResults(filePath.string(), localRecordPaths[fileNameIndex].string());
+		size_t sourceFileCount = record.archetypeRecord.sourceFiles().size();
+		auto shaders = record.archetypeRecord.retrieveCompileResults(
+			filePath.string(),
+			std::span<const ShaderCompileResult>(compileResults).subspan(compileResultOffset, sourceFileCount));
+		compileResultOffset += sourceFileCount;
 
 		record.archetypeRecord.verifyArchetype(filePath.string(), setLayoutInfos, shaders);
 
@@ -194,7 +210,6 @@ int main(int argc, char** argv) {
 		if (!isValid) {
 			outStream.close();
 			remove(options.outFile);
-			remove_all(tempDirPath);
 			for (auto& shader : shaders) {
 				spvReflectDestroyShaderModule(&shader.shader);
 			}
@@ -206,19 +221,56 @@ int main(int argc, char** argv) {
 		++fileNameIndex;
 	}
 
+	// Optimize after reflection, so that verification sees the names and bindings as written in the shader
+
+	size_t compiledShaderCodeSize = 0;
+	size_t optimizedShaderCodeSize = 0;
+	auto optimizationStartTime = std::chrono::steady_clock::now();
+	SpirvOptimizationOptions& optimizationOptions = options.optimizationOptions;
+	if (optimizationOptions.runOptimizer && !spirvOptimizerAvailable()) {
+		std::cout << "Warning: vcp was built without SPIRV-Tools, --optimize only freezes specialization constants.\n";
+		optimizationOptions.runOptimizer = false;
+	}
+	fileNameIndex = 0;
+	for (auto& record : records) {
+		compiledShaderCodeSize += record.archetypeRecord.shaderCodeSize();
+		if (optimizationOptions.freezeUnspecializedConstants || optimizationOptions.runOptimizer ||
+			optimizationOptions.stripDebugInfo) {
+			record.archetypeRecord.optimizeShaders(absolute(options.fileNames[fileNameIndex]).string(),
+												   record.instanceRecords, optimizationOptions);
+		}
+		optimizedShaderCodeSize += record.archetypeRecord.shaderCodeSize();
+		++fileNameIndex;
+	}
+	std::chrono::duration<double, std::milli> optimizationDuration =
+		std::chrono::steady_clock::now() - optimizationStartTime;
+
 	// Construct VCP file
 
-	serialize(VCPFileHeader{}, outStream);
-	serializeVector(setLayoutInfos, outStream);
+	VCPLibraryWriter writer;
+	for (auto& setLayoutInfo : setLayoutInfos) {
+		writer.addSetLayout(setLayoutInfo);
+	}
 
 	for (auto& record : records) {
-		record.archetypeRecord.serialize(outStream);
-		serializeVector(record.instanceRecords, outStream);
+		record.archetypeRecord.write(writer);
+		for (auto& instanceRecord : record.instanceRecords) {
+			instanceRecord.write(writer);
+		}
 
 		record.archetypeRecord.freeShaders();
 	}
 
-	remove_all(tempDirPath);
+	std::vector<char> fileData = writer.finish();
+	outStream.write(fileData.data(), fileData.size());
+
+	std::cout << "Shader code: " << compiledShaderCodeSize << " bytes compiled, " << optimizedShaderCodeSize
+			  << " bytes after optimization (" << optimizationDuration.count() << " ms), "
+			  << writer.storedShaderCodeSize() << " bytes stored after sharing " << writer.sharedShaderCount()
+			  << " identical modules. Library size: " << fileData.size() << " bytes.\n";
+
+	// Entries of shaders that were changed or removed are never used again
+	shaderCache.removeUnusedEntries();
 
 	return 0;
 }
\ No newline at end of file